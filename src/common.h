@@ -36,8 +36,8 @@
 
 // Define to include maintaining the patch history changes for the
 // current layer
+// Note: Defined by the INCLUDE_PATCH_HISTORY CMake option
 // Default: Not defined
-//#define INCLUDE_PATCH_HISTORY                   1
 
 // Define to not build in Xenomai RT support
 // Default: Defined
@@ -68,6 +68,10 @@ constexpr int DEFAULT_LAYERS_NUM = 1;
 constexpr int DEFAULT_BANK_NUM  = 1;
 constexpr int DEFAULT_PATCH_NUM = 1;
 constexpr int DEFAULT_MOD_SRC_NUM = 1;
+constexpr uint DEFAULT_SURFACE_POLL_MIN_INTERVAL_MS = 4;
+constexpr uint DEFAULT_SURFACE_POLL_MAX_INTERVAL_MS = 60;
+constexpr uint DEFAULT_LATENCY_TRACE_SAMPLE_INTERVAL = 0;
+constexpr uint DEFAULT_MIDI_EVENT_QUEUE_MIN_INTERVAL_MS = 2;
 constexpr uint NUM_LAYER_CONFIG_FILES = 127;
 constexpr uint NUM_BANKS = 127;
 constexpr uint NUM_BANK_PATCH_FILES = 127;
@@ -107,6 +111,7 @@ enum NinaModule : int
     GUI,
     SOFTWARE
 };
+constexpr uint NUM_NINA_MODULES = NinaModule::SOFTWARE + 1;
 
 // Multi-function switches mode
 enum class MultifnSwitchesMode {
@@ -104,6 +104,11 @@ constexpr int NUM_SWITCH_BYTES = 5;
 constexpr int NUM_LED_BYTES    = NUM_SWITCH_BYTES;
 constexpr int NUM_BITS_IN_BYTE = 8;
 
+// LED commit constants
+// The LED states are re-written after this many skipped commits, even if unchanged, in
+// case the Panel Controller has lost them
+constexpr uint LED_STATES_REFRESH_COMMIT_COUNT = 100;
+
 // I2C slave addresses
 constexpr uint8_t MOTOR_CONTROLLER_DEFAULT_I2C_SLAVE_ADDR = 8;
 constexpr uint8_t MOTOR_CONTROLLER_BASE_I2C_SLAVE_ADDR    = 50;
@@ -126,6 +131,12 @@ constexpr uint I2C_READ_RETRY_COUNT         = 5;
 constexpr uint I2C_ROBUST_WRITE_RETRY_COUNT = 5;
 constexpr uint I2C_WRITE_RETRY_COUNT        = 5;
 
+// I2C combined transfer constants
+// Each Motor Controller knob state read needs a request and a read message, and
+// the I2C driver limits the number of messages in a single transfer
+constexpr uint I2C_TRANSFER_MAX_NUM_MSGS       = I2C_RDWR_IOCTL_MAX_MSGS;
+constexpr uint I2C_TRANSFER_MAX_NUM_KNOB_READS = (I2C_TRANSFER_MAX_NUM_MSGS / 2);
+
 
 //----------------------------------------------------------------------------
 // ControlTypeFromString
@@ -140,6 +151,110 @@ SurfaceControlType SurfaceControl::ControlTypeFromString(const char *type)
     return SurfaceControlType::UNKNOWN;
 }
 
+//----------------------------------------------------------------------------
+// CompileHapticMode
+//----------------------------------------------------------------------------
+void SurfaceControl::CompileHapticMode(HapticMode& haptic_mode)
+{
+    // Switch haptic modes are not written to the hardware
+    haptic_mode.knob_cmd_image.clear();
+    if (haptic_mode.type == SurfaceControlType::SWITCH)
+        return;
+
+    // If knob haptics are switched on
+    if (haptic_mode.knob_haptics_on())
+    {
+        auto knob_width = haptic_mode.knob_width;
+        uint8_t detent_strength = 0x00;            
+        uint16_t start_pos;
+        uint16_t width;
+        uint8_t num_indents = 0;
+
+        // Calculate the number of indents to set in hardware
+        for (uint i=0; i<haptic_mode.knob_indents.size(); i++)
+        {
+            // If this indent is active in hardware
+            if (haptic_mode.knob_indents[i].first) {
+                num_indents++;
+            }
+        }
+
+        // Has the width benn specified?
+        if (knob_width < 360)
+        {
+            // The width must be within the specified haptic range
+            // Clip to these values                
+            if (knob_width < HAPTIC_KNOB_MIN_WIDTH)
+                knob_width = HAPTIC_KNOB_MIN_WIDTH;
+            else if (knob_width > HAPTIC_KNOB_MAX_WIDTH)
+                knob_width = HAPTIC_KNOB_MAX_WIDTH;
+        }
+
+        // Have detents been specified?
+        if (haptic_mode.knob_num_detents)
+        {
+            // Set the detent strength
+            detent_strength = haptic_mode.knob_detent_strength;
+        }
+
+        // Has the knob start pos been specified?
+        if (haptic_mode.knob_start_pos != -1)
+        {
+            // Make sure the start pos and width do not exceed the knob limits
+            if ((haptic_mode.knob_start_pos + knob_width) > 360)
+            {
+                // Truncate the knob width
+                knob_width = 360 - haptic_mode.knob_start_pos;
+            }
+
+            // Calculate the start position
+            start_pos = (haptic_mode.knob_start_pos / 360.0f) * FLOAT_TO_KNOB_HW_VALUE_SCALING_FACTOR;
+        }
+        else
+        {
+            // Calculate the start position
+            start_pos = (((360.0f - knob_width) / 2) / 360.0f) * FLOAT_TO_KNOB_HW_VALUE_SCALING_FACTOR;
+        }
+
+        // Calculate the width
+        width = (knob_width / 360.0f) * FLOAT_TO_KNOB_HW_VALUE_SCALING_FACTOR;
+
+        // Clip the number of indents if needed
+        if (num_indents > HAPTIC_KNOB_MAX_NUM_INDENTS)
+            num_indents = HAPTIC_KNOB_MAX_NUM_INDENTS;
+
+        // Setup the haptic config command
+        auto& cmd = haptic_mode.knob_cmd_image;
+        cmd.reserve(HAPTIC_CONFIG_MIN_NUM_BYTES + (num_indents * sizeof(uint16_t)));
+        cmd.push_back(MotorControllerRegMap::MOTION_HAPTIC_CONFIG);
+        cmd.push_back((uint8_t)haptic_mode.knob_friction);      // Friction
+        cmd.push_back((uint8_t)haptic_mode.knob_num_detents);   // Number of detents
+        cmd.push_back(detent_strength);                         // Detent strength
+        cmd.push_back((uint8_t)(start_pos & 0xFF));             // Start pos (LSB)
+        cmd.push_back((uint8_t)(start_pos >> 8));               // Start pos (MSB)
+        cmd.push_back((uint8_t)(width & 0xFF));                 // Width (LSB)
+        cmd.push_back((uint8_t)(width >> 8));                   // Width (MSB)
+        cmd.push_back(num_indents);                             // Number of indents
+
+        // Copy the indents active in hardware, if any
+        for (uint i=0; (i<haptic_mode.knob_indents.size()) && (num_indents > 0); i++)
+        {
+            // If this indent is active in hardware
+            if (haptic_mode.knob_indents[i].first) {
+                // Set the indent in the command data
+                cmd.push_back((uint8_t)(haptic_mode.knob_indents[i].second & 0xFF));
+                cmd.push_back((uint8_t)(haptic_mode.knob_indents[i].second >> 8));
+                num_indents--;
+            }
+        }
+    }
+    else
+    {
+        // Setup the disable haptic mode command
+        haptic_mode.knob_cmd_image = { MotorControllerRegMap::MOTION_MODE_HAPTIC, 0x00 };
+    }
+}
+
 //----------------------------------------------------------------------------
 // SurfaceControl
 //----------------------------------------------------------------------------
@@ -150,10 +265,21 @@ SurfaceControl::SurfaceControl()
     _panel_controller_active = false;
     std::memset(_motor_controller_active, false, sizeof(_motor_controller_active));
     std::memset(_motor_controller_knob_state_requested, false, sizeof(_motor_controller_knob_state_requested));
+    std::fill(std::begin(_motor_controller_knob_state_result), std::end(_motor_controller_knob_state_result), -ENODEV);
     std::memset(_motor_controller_haptic_set, false, sizeof(_motor_controller_haptic_set));
+    std::memset(_motor_controller_haptic_mode_id, 0, sizeof(_motor_controller_haptic_mode_id));
     _led_states = new uint8_t[NUM_LED_BYTES];
     std::memset(_led_states, 0, sizeof(uint8_t[NUM_LED_BYTES]));
+    _committed_led_states = new uint8_t[NUM_LED_BYTES];
+    std::memset(_committed_led_states, 0, sizeof(uint8_t[NUM_LED_BYTES]));
+    _committed_led_states_valid = false;
+    _num_led_commits_skipped = 0;
     _selected_controller_addr = -1;
+    _i2c_combined_transfers = false;
+    _bus_thread = nullptr;
+    _run_bus_thread = false;
+    _num_bus_reads_pending = 0;
+    _clear_bus_commands();
 #ifdef SURFACE_HW_I2C_INTERFACE_STATS
     num_i2c_writes = 0;
     num_i2c_write_nacks = 0;
@@ -163,6 +289,12 @@ SurfaceControl::SurfaceControl()
     num_i2c_read_nacks = 0;
     num_i2c_read_timeouts = 0;
     num_i2c_read_errors = 0;
+    num_i2c_transfers = 0;
+    num_i2c_transfer_errors = 0;
+    num_led_commits = 0;
+    num_led_commits_skipped = 0;
+    num_knob_positions_collapsed = 0;
+    num_haptic_mode_batches = 0;
 #endif
 
 #ifdef SURFACE_HW_LOG_MC_CAL_RESULTS
@@ -195,6 +327,8 @@ SurfaceControl::~SurfaceControl()
     // Clean up any allocated memory
     if (_led_states)
         delete [] _led_states;     
+    if (_committed_led_states)
+        delete [] _committed_led_states;
 }
 
 //----------------------------------------------------------------------------
@@ -222,6 +356,12 @@ int SurfaceControl::open()
     // Save the device handle
     _dev_handle = handle;
 
+    // Check if the I2C bus supports combined transfers, if so the knob states are read
+    // from all Motor Controllers with a single transfer
+    unsigned long funcs = 0;
+    _i2c_combined_transfers = (ioctl(_dev_handle, I2C_FUNCS, &funcs) == 0) && (funcs & I2C_FUNC_I2C);
+    NINA_LOG_INFO(NinaModule::SURFACE_CONTROL, "I2C combined transfers: {}", (_i2c_combined_transfers ? "ON": "OFF"));
+
     // Initialise the Panel and Motor Controllers
     _init_controllers();
 
@@ -246,6 +386,10 @@ int SurfaceControl::open()
         NINA_LOG_WARNING(NinaModule::SURFACE_CONTROL, "Less Motor Controllers found than expected ({})", NUM_PHYSICAL_KNOBS);
     }
     NINA_LOG_FLUSH();
+
+    // Start the bus worker thread, to write the queued commands
+    _run_bus_thread = true;
+    _bus_thread = new std::thread(&SurfaceControl::_process_bus_commands, this);
     return 0;
 }
 
@@ -254,18 +398,25 @@ int SurfaceControl::open()
 //----------------------------------------------------------------------------
 int SurfaceControl::close()
 {
+    // Stop the bus worker thread - any queued commands not yet written are discarded
+    _stop_bus_thread();
+
     // Before we close the surface control device, disable haptics for all knobs
+    // Note: The default haptic mode class has disabled haptics
+    uint8_t mc_nums[NUM_PHYSICAL_KNOBS];
+    std::vector<HapticMode> haptic_modes;
+    auto haptic_mode = HapticMode();
+    CompileHapticMode(haptic_mode);
     for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
     {
         // Is this Motor Controller active?
         if (_motor_controller_active[i])
         {        
-            // Disable haptic mode (ignore the return value)
-            // Note: The default haptic mode class has disabled haptics
-            auto haptic_mode = HapticMode();
-            (void)_motor_controller_set_haptic_mode(i, haptic_mode);
+            mc_nums[haptic_modes.size()] = i;
+            haptic_modes.push_back(haptic_mode);
         }
-    }    
+    }
+    _motor_controller_set_haptic_modes(mc_nums, haptic_modes.data(), haptic_modes.size());
 
 
 #ifdef SURFACE_HW_I2C_INTERFACE_STATS
@@ -278,6 +429,12 @@ int SurfaceControl::close()
     NINA_LOG_INFO(NinaModule::SURFACE_CONTROL, "Number of I2C read NACKS: {}", num_i2c_read_nacks);
     NINA_LOG_INFO(NinaModule::SURFACE_CONTROL, "Number of I2C read timeouts: {}", num_i2c_read_timeouts);
     NINA_LOG_INFO(NinaModule::SURFACE_CONTROL, "Number of I2C read errors: {}", num_i2c_read_errors);
+    NINA_LOG_INFO(NinaModule::SURFACE_CONTROL, "Number of I2C transfers: {}", num_i2c_transfers);
+    NINA_LOG_INFO(NinaModule::SURFACE_CONTROL, "Number of I2C transfer errors: {}", num_i2c_transfer_errors);
+    NINA_LOG_INFO(NinaModule::SURFACE_CONTROL, "Number of LED commits: {}", num_led_commits);
+    NINA_LOG_INFO(NinaModule::SURFACE_CONTROL, "Number of LED commits skipped: {}", num_led_commits_skipped);
+    NINA_LOG_INFO(NinaModule::SURFACE_CONTROL, "Number of knob positions collapsed: {}", num_knob_positions_collapsed);
+    NINA_LOG_INFO(NinaModule::SURFACE_CONTROL, "Number of haptic mode batches: {}", num_haptic_mode_batches);
 #endif
     
     // If the device is open
@@ -300,6 +457,14 @@ int SurfaceControl::close()
 //----------------------------------------------------------------------------
 void SurfaceControl::lock()
 {
+    // Indicate a read is pending, so that the bus worker does not start any further
+    // queued commands
+    // Note: The read therefore waits for at most one queued command to be written
+    {
+        std::lock_guard<std::mutex> lk(_bus_queue_mutex);
+        _num_bus_reads_pending++;
+    }
+
     // Lock the controller mutex
     _controller_mutex.lock();
 }
@@ -311,6 +476,13 @@ void SurfaceControl::unlock()
 {
     // Unlock the controller mutex
     _controller_mutex.unlock();
+
+    // The read is complete, wake the bus worker if there are no other reads pending
+    {
+        std::lock_guard<std::mutex> lk(_bus_queue_mutex);
+        _num_bus_reads_pending--;
+    }
+    _bus_queue_cv.notify_one();
 }
 
 //----------------------------------------------------------------------------
@@ -330,7 +502,7 @@ bool SurfaceControl::knob_is_active(uint num)
 //----------------------------------------------------------------------------
 // request_knob_states
 //----------------------------------------------------------------------------
-int SurfaceControl::request_knob_states()
+int SurfaceControl::request_knob_states(const bool *poll_knobs)
 {
     int ret;
 
@@ -343,13 +515,21 @@ int SurfaceControl::request_knob_states()
         return -EPERM;
     }
 
-    // Request the state of each knob
+    // Request the state of each knob (or just the specified knobs)
     std::memset(_motor_controller_knob_state_requested, false, sizeof(_motor_controller_knob_state_requested));
     for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
     {
-        // Is this Motor Controller active?
-        if (_motor_controller_active[i])
+        // Is this Motor Controller active and should it be polled?
+        if (_motor_controller_active[i] && (!poll_knobs || poll_knobs[i]))
         {
+            // If combined transfers are supported, the knob state is requested and read
+            // in the same transfer when the knob states are read
+            if (_i2c_combined_transfers)
+            {
+                _motor_controller_knob_state_requested[i] = true;
+                continue;
+            }
+
             // Request the knob state
             ret = _motor_controller_request_knob_state(i);
             if (ret == 0)
@@ -359,6 +539,9 @@ int SurfaceControl::request_knob_states()
             }
             else
             {
+                // Save the result for this controller
+                _motor_controller_knob_state_result[i] = ret;
+
                 // Request knob state FAILED
                 // Note: Ignore the error as it is possible from time to time
                 // that the knob is not responsive due to it being busy with
@@ -375,8 +558,7 @@ int SurfaceControl::request_knob_states()
 //----------------------------------------------------------------------------
 int SurfaceControl::read_knob_states(KnobState *states)
 {
-    KnobState state = {};
-    int ret;
+    KnobState knob_states[NUM_PHYSICAL_KNOBS] = {};
 
     // NOTE: Controller Mutex must be locked before calling this function
 
@@ -387,18 +569,30 @@ int SurfaceControl::read_knob_states(KnobState *states)
         return -EPERM;
     }
 
+    // If combined transfers are supported, request and read all the knob states in
+    // as few transfers as possible
+    if (_i2c_combined_transfers)
+    {
+        _motor_controller_transfer_knob_states(knob_states);
+    }
+
     // Read the state of each knob
     for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
     {
         // Is this Motor Controller active and has the knob state been requested?
         if (_motor_controller_active[i] && _motor_controller_knob_state_requested[i])
         {        
-            // Read the knob state
-            ret = _motor_controller_read_knob_state(i, &state);
-            if (ret == 0)
+            // Read the knob state (if not already read)
+            if (!_i2c_combined_transfers)
+            {
+                _motor_controller_knob_state_result[i] = _motor_controller_read_knob_state(i, &knob_states[i]);
+            }
+            if (_motor_controller_knob_state_result[i] == 0)
             {
                 // Return the knob state
-                *states++ = state;
+                // Note: The states are indexed by knob number, the state of any knob not
+                // read is left unchanged
+                states[i] = knob_states[i];
             }
             else
             {
@@ -406,13 +600,30 @@ int SurfaceControl::read_knob_states(KnobState *states)
                 // Note: Ignore the error as it is possible from time to time
                 // that the knob is not responsive due to it being busy with
                 // other motion tasks
-                //DEBUG_MSG("Read knob state: FAILED: " << ret);
+                //DEBUG_MSG("Read knob state: FAILED: " << _motor_controller_knob_state_result[i]);
             }
         }
     }
     return 0;
 }
 
+//----------------------------------------------------------------------------
+// knob_state_result
+//----------------------------------------------------------------------------
+int SurfaceControl::knob_state_result(uint num)
+{
+    // NOTE: Controller Mutex must be locked before calling this function
+
+    // If knob number is valid
+    if (num < NUM_PHYSICAL_KNOBS)
+    {
+        // Return the result of the last knob state read for this knob - zero if the
+        // read succeeded, otherwise the error
+        return _motor_controller_knob_state_result[num];
+    }
+    return -EINVAL;
+}
+
 //----------------------------------------------------------------------------
 // read_switch_states
 //----------------------------------------------------------------------------
@@ -492,8 +703,8 @@ int SurfaceControl::set_switch_led_state(unsigned int switch_num, bool led_on)
         return -EINVAL;
     }
 
-    // Get the controller mutex
-    std::lock_guard<std::mutex> lock(_controller_mutex);
+    // Get the LED states mutex
+    std::lock_guard<std::mutex> lock(_led_states_mutex);
     
     // Cache the LED state, we only commit it to hardware with the specific
     // commit function
@@ -532,8 +743,8 @@ void SurfaceControl::set_all_switch_led_states(bool leds_on)
     // Is the Panel Controller active?
     if (_panel_controller_active)
     {    
-        // Get the controller mutex
-        std::lock_guard<std::mutex> lock(_controller_mutex);
+        // Get the LED states mutex
+        std::lock_guard<std::mutex> lock(_led_states_mutex);
 
         // Switching all LEDs on?
         if (leds_on)
@@ -556,30 +767,15 @@ void SurfaceControl::set_all_switch_led_states(bool leds_on)
 //----------------------------------------------------------------------------
 int SurfaceControl::commit_led_states()
 {
-    uint8_t led_states[NUM_LED_BYTES];
-    int ret;
-
     // Is the Panel Controller active?
     if (_panel_controller_active)
     {
-        // Get the controller mutex
-        std::lock_guard<std::mutex> lock(_controller_mutex);
-
-        // Byte swap the LEDs array
-        led_states[0] = _led_states[4];
-        led_states[1] = _led_states[3];
-        led_states[2] = _led_states[2];
-        led_states[3] = _led_states[1];
-        led_states[4] = _led_states[0];
-
-        // Set the LED States
-        ret = _panel_controller_set_led_states(led_states);
-        if (ret < 0)
+        // Queue the LED commit, it is written by the bus worker
         {
-            // Set the LED States failed
-            //DEBUG_MSG("Set Panel Controller LED states: FAILED");
-            return ret;
+            std::lock_guard<std::mutex> lk(_bus_queue_mutex);
+            _led_commit_pending = true;
         }
+        _bus_queue_cv.notify_one();
     }
     return 0;
 }
@@ -589,22 +785,25 @@ int SurfaceControl::commit_led_states()
 //----------------------------------------------------------------------------
 int SurfaceControl::set_knob_haptic_mode(unsigned int knob_num, const HapticMode& haptic_mode)
 {
+    int ret = 0;
+
     // Is this Motor Controller active?
     if (_motor_controller_active[knob_num])
     {
-        // Get the controller mutex
-        std::lock_guard<std::mutex> lock(_controller_mutex);
-
-        // Set the haptic mode (if any)
-        int ret = _motor_controller_set_haptic_mode(knob_num, haptic_mode);
-        if (ret < 0)
+        // Queue the haptic mode, it is written by the bus worker
+        // Note: Any haptic mode already queued for this knob is replaced
+        // As the haptic mode is written asynchronously, the result of the last haptic
+        // mode written to this knob is returned
         {
-            // Set Motor Controller haptic mode failed
-            DEBUG_MSG("Motor Controller " << knob_num << " set haptic mode: FAILED");
-            return ret;
+            std::lock_guard<std::mutex> lk(_bus_queue_mutex);
+            _knob_bus_commands[knob_num].haptic_mode_pending = true;
+            _knob_bus_commands[knob_num].haptic_mode = haptic_mode;
+            ret = _knob_bus_commands[knob_num].haptic_mode_result;
+            _knob_bus_commands[knob_num].haptic_mode_result = 0;
         }
+        _bus_queue_cv.notify_one();
     }
-    return 0;
+    return ret;
 }
 
 //----------------------------------------------------------------------------
@@ -620,21 +819,63 @@ int SurfaceControl::set_knob_position(unsigned int knob_num, uint16_t position,
     }
 
     // Check the Motor Controller is active
+    int ret = 0;
     if (_motor_controller_active[knob_num])
     {
-        // Get the controller mutex
-        std::lock_guard<std::mutex> lock(_controller_mutex);
-
-        // Set the knob position
-        int ret = _motor_controller_set_position(knob_num, position, robust);
-        if (ret < 0)
+        // Queue the knob position, it is written by the bus worker
+        // Note: Any position already queued for this knob is replaced, so only the
+        // latest target is written - it is written robustly if any of the replaced
+        // positions were
+        // As the position is written asynchronously, the result of the last position
+        // written to this knob is returned
         {
-            // Set Motor Controller position failed
-            DEBUG_MSG("Set Motor Controller position: FAILED");
-            return ret;
+            std::lock_guard<std::mutex> lk(_bus_queue_mutex);
+            auto& cmds = _knob_bus_commands[knob_num];
+            if (cmds.position_pending)
+            {
+                cmds.robust |= robust;
+#ifdef SURFACE_HW_I2C_INTERFACE_STATS
+                num_knob_positions_collapsed++;
+#endif
+            }
+            else
+            {
+                cmds.robust = robust;
+            }
+            cmds.position_pending = true;
+            cmds.position = position;
+            ret = cmds.position_result;
+            cmds.position_result = 0;
         }
+        _bus_queue_cv.notify_one();
     }
-    return 0;   
+    return ret;
+}
+
+//----------------------------------------------------------------------------
+// knob_position_result
+//----------------------------------------------------------------------------
+int SurfaceControl::knob_position_result(unsigned int num, uint16_t position)
+{
+    // NOTE: Controller Mutex need not be locked before calling this function
+
+    // If knob number is valid
+    if (num < NUM_PHYSICAL_KNOBS)
+    {
+        // Return the result of writing this position to the knob - -EINPROGRESS if a
+        // position is still queued or being written, zero if this position was the last
+        // written and the write succeeded, otherwise the error
+        // If this position was not the last written (e.g. the queued commands were
+        // discarded), -ENODATA is returned
+        std::lock_guard<std::mutex> lk(_bus_queue_mutex);
+        auto& cmds = _knob_bus_commands[num];
+        if (cmds.position_pending || cmds.position_writing)
+            return -EINPROGRESS;
+        if (!cmds.position_written || (cmds.written_position != position))
+            return -ENODATA;
+        return (cmds.written_position_result < 0) ? cmds.written_position_result : 0;
+    }
+    return -EINVAL;
 }
 
 //----------------------------------------------------------------------------
@@ -642,14 +883,26 @@ int SurfaceControl::set_knob_position(unsigned int knob_num, uint16_t position,
 //----------------------------------------------------------------------------
 void SurfaceControl::reinit()
 {
+    // Discard any queued bus commands, they are not valid for the re-initialised
+    // controllers
+    {
+        std::lock_guard<std::mutex> lk(_bus_queue_mutex);
+        _clear_bus_commands();
+    }
+
+    // Get the controller mutex, so the bus worker does not access the controllers
+    // while they are re-initialised
+    std::lock_guard<std::mutex> lock(_controller_mutex);
+
     // Initialise the Panel and Motor Controllers
+    // Note: The LED states in the Panel Controller are not known until next committed
     _panel_controller_active = false;
+    _committed_led_states_valid = false;
     std::memset(_motor_controller_active, false, sizeof(_motor_controller_active));
     std::memset(_motor_controller_knob_state_requested, false, sizeof(_motor_controller_knob_state_requested));
+    std::fill(std::begin(_motor_controller_knob_state_result), std::end(_motor_controller_knob_state_result), -ENODEV);
     std::memset(_motor_controller_haptic_set, false, sizeof(_motor_controller_haptic_set));
-    for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++) {
-        _motor_controller_haptic_mode[i] = "";
-    } 
+    std::memset(_motor_controller_haptic_mode_id, 0, sizeof(_motor_controller_haptic_mode_id));
     _init_controllers();
 
     // Indicate the controllers were initialised OK, and show the number of knobs
@@ -675,6 +928,217 @@ void SurfaceControl::reinit()
     NINA_LOG_FLUSH();
 }
 
+//----------------------------------------------------------------------------
+// _process_bus_commands
+//----------------------------------------------------------------------------
+void SurfaceControl::_process_bus_commands()
+{
+    std::unique_lock<std::mutex> lk(_bus_queue_mutex);
+
+    // Do forever until stopped
+    while (true)
+    {
+        // Wait for a queued command, and for any pending reads to complete
+        _bus_queue_cv.wait(lk, [this]() { return !_run_bus_thread || ((_num_bus_reads_pending == 0) && _bus_commands_pending()); });
+        if (!_run_bus_thread)
+            break;
+
+        // Get the next command to write, in priority order - knob positions, then haptic
+        // modes (all queued haptic modes are written together), then the LED commit
+        // The knobs are checked in turn from the last knob written, so that each knob
+        // queued in a sweep is written in order
+        // Note: If a knob has a haptic mode queued as well as a position, the haptic
+        // mode is written first as it may set the knob position limits
+        int knob_num = -1;
+        bool set_haptic_mode = false;
+        for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+        {
+            uint num = (_next_bus_knob_num + i) % NUM_PHYSICAL_KNOBS;
+            if (_knob_bus_commands[num].position_pending)
+            {
+                knob_num = num;
+                set_haptic_mode = _knob_bus_commands[num].haptic_mode_pending;
+                break;
+            }
+        }
+        if (knob_num == -1)
+        {
+            for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+            {
+                if (_knob_bus_commands[i].haptic_mode_pending)
+                {
+                    knob_num = i;
+                    set_haptic_mode = true;
+                    break;
+                }
+            }
+        }
+
+        // Is there a knob command to write?
+        if (knob_num >= 0)
+        {
+            auto& cmds = _knob_bus_commands[knob_num];
+            if (set_haptic_mode)
+            {
+                uint8_t mc_nums[NUM_PHYSICAL_KNOBS];
+                std::vector<HapticMode> haptic_modes;
+
+                // Take all the queued haptic modes, so that they are written together
+                for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+                {
+                    if (_knob_bus_commands[i].haptic_mode_pending)
+                    {
+                        mc_nums[haptic_modes.size()] = i;
+                        haptic_modes.push_back(_knob_bus_commands[i].haptic_mode);
+                        _knob_bus_commands[i].haptic_mode_pending = false;
+                    }
+                }
+                lk.unlock();
+
+                // Set the haptic modes of the Motor Controllers that are still active
+                int results[NUM_PHYSICAL_KNOBS];
+                uint num_modes = 0;
+                {
+                    std::lock_guard<std::mutex> lock(_controller_mutex);
+                    for (uint i=0; i<haptic_modes.size(); i++)
+                    {
+                        if (_motor_controller_active[mc_nums[i]])
+                        {
+                            mc_nums[num_modes] = mc_nums[i];
+                            haptic_modes[num_modes++] = haptic_modes[i];
+                        }
+                    }
+                    _motor_controller_set_haptic_modes(mc_nums, haptic_modes.data(), num_modes, results);
+                }
+
+                // Save the results, to return when the next haptic mode is queued
+                lk.lock();
+                for (uint i=0; i<num_modes; i++)
+                {
+                    if (results[i] < 0)
+                        _knob_bus_commands[mc_nums[i]].haptic_mode_result = results[i];
+                }
+                continue;
+            }
+            else
+            {
+                // Take the queued knob position
+                uint16_t position = cmds.position;
+                bool robust = cmds.robust;
+                cmds.position_pending = false;
+                cmds.position_writing = true;
+                _next_bus_knob_num = (knob_num + 1) % NUM_PHYSICAL_KNOBS;
+                lk.unlock();
+
+                // Set the knob position, if the Motor Controller is still active
+                int ret = 0;
+                int written_ret = -ENODEV;
+                {
+                    std::lock_guard<std::mutex> lock(_controller_mutex);
+                    if (_motor_controller_active[knob_num])
+                    {
+                        ret = _motor_controller_set_position(knob_num, position, robust);
+                        written_ret = ret;
+                        if (ret < 0)
+                        {
+                            // Set Motor Controller position failed
+                            DEBUG_MSG("Set Motor Controller position: FAILED");
+                        }
+                    }
+                }
+
+                // Save the result, to return when the next position is queued, and
+                // the position written and its result, so it can be confirmed
+                lk.lock();
+                if (ret < 0)
+                    cmds.position_result = ret;
+                cmds.position_writing = false;
+                cmds.position_written = true;
+                cmds.written_position = position;
+                cmds.written_position_result = written_ret;
+                continue;
+            }
+        }
+        else
+        {
+            // Take the queued LED commit
+            _led_commit_pending = false;
+            lk.unlock();
+
+            // Commit the LED states
+            {
+                std::lock_guard<std::mutex> lock(_controller_mutex);
+                (void)_commit_led_states();
+            }
+        }
+        lk.lock();
+    }
+}
+
+//----------------------------------------------------------------------------
+// _bus_commands_pending
+// Note: The bus queue mutex must be held by the caller
+//----------------------------------------------------------------------------
+bool SurfaceControl::_bus_commands_pending()
+{
+    // Check if the LED commit or any knob command is queued
+    if (_led_commit_pending)
+        return true;
+    for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+    {
+        if (_knob_bus_commands[i].position_pending || _knob_bus_commands[i].haptic_mode_pending)
+            return true;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// _clear_bus_commands
+// Note: The bus queue mutex must be held by the caller
+//----------------------------------------------------------------------------
+void SurfaceControl::_clear_bus_commands()
+{
+    // Clear all queued commands
+    for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+    {
+        _knob_bus_commands[i].position_pending = false;
+        _knob_bus_commands[i].position = 0;
+        _knob_bus_commands[i].robust = false;
+        _knob_bus_commands[i].position_result = 0;
+        _knob_bus_commands[i].position_writing = false;
+        _knob_bus_commands[i].position_written = false;
+        _knob_bus_commands[i].written_position = 0;
+        _knob_bus_commands[i].written_position_result = 0;
+        _knob_bus_commands[i].haptic_mode_pending = false;
+        _knob_bus_commands[i].haptic_mode = HapticMode();
+        _knob_bus_commands[i].haptic_mode_result = 0;
+    }
+    _next_bus_knob_num = 0;
+    _led_commit_pending = false;
+}
+
+//----------------------------------------------------------------------------
+// _stop_bus_thread
+//----------------------------------------------------------------------------
+void SurfaceControl::_stop_bus_thread()
+{
+    // Is the bus worker thread running?
+    if (_bus_thread)
+    {
+        // Stop the bus worker thread, and discard any queued commands
+        {
+            std::lock_guard<std::mutex> lk(_bus_queue_mutex);
+            _run_bus_thread = false;
+            _clear_bus_commands();
+        }
+        _bus_queue_cv.notify_all();
+        if (_bus_thread->joinable())
+            _bus_thread->join();
+        delete _bus_thread;
+        _bus_thread = nullptr;
+    }
+}
+
 //----------------------------------------------------------------------------
 // _init_controllers
 //----------------------------------------------------------------------------
@@ -1003,6 +1467,72 @@ void SurfaceControl::_init_controllers()
     }
 }
 
+//----------------------------------------------------------------------------
+// _commit_led_states
+// Note: The controller mutex must be held by the caller
+//----------------------------------------------------------------------------
+int SurfaceControl::_commit_led_states()
+{
+    uint8_t current_led_states[NUM_LED_BYTES];
+    uint8_t led_states[NUM_LED_BYTES];
+    int ret;
+
+    // Is the Panel Controller active?
+    if (_panel_controller_active)
+    {
+        // Get the current LED states
+        {
+            std::lock_guard<std::mutex> lock(_led_states_mutex);
+            std::memcpy(current_led_states, _led_states, NUM_LED_BYTES);
+        }
+
+        // If the LED states have not changed since they were last written to the Panel
+        // Controller, there is no need to write them again
+        // Note: This means commits made from several places in one poll cycle result in
+        // a single write, but the LED states are still re-written periodically
+        if (_committed_led_states_valid &&
+            (std::memcmp(current_led_states, _committed_led_states, NUM_LED_BYTES) == 0) &&
+            (_num_led_commits_skipped < LED_STATES_REFRESH_COMMIT_COUNT))
+        {
+            // Skip this commit
+            _num_led_commits_skipped++;
+#ifdef SURFACE_HW_I2C_INTERFACE_STATS
+            num_led_commits_skipped++;
+#endif
+            return 0;
+        }
+
+        // Byte swap the LEDs array
+        led_states[0] = current_led_states[4];
+        led_states[1] = current_led_states[3];
+        led_states[2] = current_led_states[2];
+        led_states[3] = current_led_states[1];
+        led_states[4] = current_led_states[0];
+
+        // Set the LED States
+        // Note: The Panel Controller LED state register must be written in full, so all
+        // LED states are written even if only one has changed
+        ret = _panel_controller_set_led_states(led_states);
+        if (ret < 0)
+        {
+            // Set the LED States failed
+            // The LED states in the Panel Controller are no longer known
+            //DEBUG_MSG("Set Panel Controller LED states: FAILED");
+            _committed_led_states_valid = false;
+            return ret;
+        }
+
+        // Save the LED states written
+        std::memcpy(_committed_led_states, current_led_states, NUM_LED_BYTES);
+        _committed_led_states_valid = true;
+        _num_led_commits_skipped = 0;
+#ifdef SURFACE_HW_I2C_INTERFACE_STATS
+        num_led_commits++;
+#endif
+    }
+    return 0;
+}
+
 //----------------------------------------------------------------------------
 // _motor_controller_request_status
 //----------------------------------------------------------------------------
@@ -1196,141 +1726,172 @@ int SurfaceControl::_motor_controller_set_haptic_mode(uint8_t mc_num, const Hapt
     if (ret == 0)
     {
         // Are we actually changing the haptic mode?
-        if (haptic_mode.name != _motor_controller_haptic_mode[mc_num])
-        {        
-            // If knob haptics are switched on
-            if (haptic_mode.knob_haptics_on())
+        // Note: A haptic mode with no ID has not been added to the haptic modes, and is
+        // always written
+        if ((haptic_mode.id == 0) || (haptic_mode.id != _motor_controller_haptic_mode_id[mc_num]))
+        {
+            // Get the compiled haptic mode, compiling it now if needed
+            const HapticMode *mode = &haptic_mode;
+            HapticMode compiled_mode;
+            if (haptic_mode.knob_cmd_image.empty())
             {
-                auto knob_width = haptic_mode.knob_width;
-                uint8_t config_cmd[HAPTIC_CONFIG_MIN_NUM_BYTES + (HAPTIC_KNOB_MAX_NUM_INDENTS * sizeof(uint16_t))] = {};
-                uint8_t config_cmd_len = HAPTIC_CONFIG_MIN_NUM_BYTES;
-                uint8_t mode_cmd[] = { MotorControllerRegMap::MOTION_MODE_HAPTIC, 0x01};                      
-                uint8_t *cmd_ptr = &config_cmd[sizeof(uint8_t)];
-                uint8_t detent_strength = 0x00;            
-                uint16_t start_pos;
-                uint16_t width;
-                uint8_t num_indents = 0;
-
-                // Calculate the number of indents to set in hardware
-                if (haptic_mode.knob_indents.size()) {
-                    for (uint i=0; i<haptic_mode.knob_indents.size(); i++)
-                    {
-                        // If this indent is active in hardware
-                        if (haptic_mode.knob_indents[i].first) {
-                            num_indents++;
-                        }
-                    }
-                }               
-
-                // Setup the config command byte
-                config_cmd[0] = MotorControllerRegMap::MOTION_HAPTIC_CONFIG;
-
-                // Has the width benn specified?
-                if (knob_width < 360)
-                {
-                    // The width must be within the specified haptic range
-                    // Clip to these values                
-                    if (knob_width < HAPTIC_KNOB_MIN_WIDTH)
-                        knob_width = HAPTIC_KNOB_MIN_WIDTH;
-                    else if (knob_width > HAPTIC_KNOB_MAX_WIDTH)
-                        knob_width = HAPTIC_KNOB_MAX_WIDTH;
-                }
-
-                // Have detents been specified?
-                if (haptic_mode.knob_num_detents)
-                {
-                    // Set the detent strength
-                    detent_strength = haptic_mode.knob_detent_strength;
-                }
+                compiled_mode = haptic_mode;
+                CompileHapticMode(compiled_mode);
+                mode = &compiled_mode;
+            }
 
-                // Has the knob start pos been specified?
-                if (haptic_mode.knob_start_pos != -1)
-                {
-                    // Make sure the start pos and width do not exceed the knob limits
-                    if ((haptic_mode.knob_start_pos + knob_width) > 360)
-                    {
-                        // Truncate the knob width
-                        knob_width = 360 - haptic_mode.knob_start_pos;
-                    }
+            // Write the haptic mode command - robust write
+            auto& cmd = mode->knob_cmd_image;
+            ret = _i2c_robust_write(cmd.data(), cmd.size(), true, cmd[sizeof(uint8_t)]);
+            if (ret == 0)
+            {
+                // Enable the haptic mode if required
+                ret = _motor_controller_enable_haptic_mode(mc_num, *mode);
+            }
+        }
+    }
+    return ret;
+}
 
-                    // Calculate the start position
-                    start_pos = (haptic_mode.knob_start_pos / 360.0f) * FLOAT_TO_KNOB_HW_VALUE_SCALING_FACTOR;
-                }
-                else
-                {
-                    // Calculate the start position
-                    start_pos = (((360.0f - knob_width) / 2) / 360.0f) * FLOAT_TO_KNOB_HW_VALUE_SCALING_FACTOR;
-                }
+//----------------------------------------------------------------------------
+// _motor_controller_set_haptic_modes
+//----------------------------------------------------------------------------
+void SurfaceControl::_motor_controller_set_haptic_modes(const uint8_t *mc_nums, const HapticMode *haptic_modes, uint num_modes, int *results)
+{
+    struct i2c_msg msgs[I2C_TRANSFER_MAX_NUM_MSGS];
+    uint8_t resps[I2C_TRANSFER_MAX_NUM_KNOB_READS];
+    uint batch[I2C_TRANSFER_MAX_NUM_KNOB_READS];
+    uint index = 0;
 
-                // Calculate the width
-                width = (knob_width / 360.0f) * FLOAT_TO_KNOB_HW_VALUE_SCALING_FACTOR;
-
-                // Clip the number of indents if needed
-                if (num_indents > HAPTIC_KNOB_MAX_NUM_INDENTS)
-                    num_indents = HAPTIC_KNOB_MAX_NUM_INDENTS;
-
-                // Setup the command data
-                *cmd_ptr++ = (uint8_t)haptic_mode.knob_friction;        // Friction
-                *cmd_ptr++ = (uint8_t)haptic_mode.knob_num_detents;     // Number of detents
-                *cmd_ptr++ = detent_strength;                           // Detent strength
-                *cmd_ptr++ = (uint8_t)(start_pos & 0xFF);               // Start pos (LSB)
-                *cmd_ptr++ = (uint8_t)(start_pos >> 8);                 // Start pos (MSB)
-                *cmd_ptr++ = (uint8_t)(width & 0xFF);                   // Width (LSB)
-                *cmd_ptr++ = (uint8_t)(width >> 8);                     // Width (MSB)
-                *cmd_ptr++ = num_indents;                               // Number of indents
-
-                // Copy the indents, if any
-                if (num_indents)
+    // Write the haptic modes for each set of Motor Controllers
+    while (index < num_modes)
+    {
+        // Get the next set of compiled haptic modes that change the Motor Controller
+        // haptic mode
+        // If the I2C bus does not support combined transfers, or the mode has not been
+        // compiled, each mode is written separately
+        uint num_mcs = 0;
+        for (; (index < num_modes) && (num_mcs < I2C_TRANSFER_MAX_NUM_KNOB_READS); index++)
+        {
+            uint8_t mc_num = mc_nums[index];
+            auto& haptic_mode = haptic_modes[index];
+            if (!_i2c_combined_transfers || haptic_mode.knob_cmd_image.empty())
+            {
+                // Set the haptic mode separately
+                int ret = _motor_controller_set_haptic_mode(mc_num, haptic_mode);
+                if (ret < 0)
                 {
-                    // Process each indent
-                    for (uint i=0; i<num_indents; i++)
-                    {
-                        // If this indent is active in hardware
-                        if (haptic_mode.knob_indents[i].first) {
-                            // Set the indent in the command data
-                            *cmd_ptr++ = (uint8_t)(haptic_mode.knob_indents[i].second & 0xFF);
-                            *cmd_ptr++ = (uint8_t)(haptic_mode.knob_indents[i].second >> 8);
-                            config_cmd_len += sizeof(uint16_t);
-                        }
-                    }
+                    // Set Motor Controller haptic mode failed
+                    DEBUG_MSG("Motor Controller " << (int)mc_num << " set haptic mode: FAILED");
                 }
+                if (results)
+                    results[index] = ret;
+            }
+            else if ((haptic_mode.id == 0) || (haptic_mode.id != _motor_controller_haptic_mode_id[mc_num]))
+            {
+                batch[num_mcs++] = index;
+            }
+            else if (results)
+            {
+                // The haptic mode is already set
+                results[index] = 0;
+            }
+        }
+        if (num_mcs == 0)
+        {
+            continue;
+        }
 
-                // Set the haptic config - robust write
-                ret = _i2c_robust_write(config_cmd, config_cmd_len, true, config_cmd[sizeof(uint8_t)]);
-
-                // Was the haptic config successfully set?
-                if (!_motor_controller_haptic_set[mc_num] && ret == 0)
-                {
-                    // Once the config has been set, enable haptic mode in the Motor Controller
-                    // Use a robust write
-                    ret = _i2c_robust_write(mode_cmd, sizeof(mode_cmd), true, mode_cmd[sizeof(uint8_t)]);
-                    _motor_controller_haptic_set[mc_num] = true;
-                }
+        // Add the haptic mode command message for each controller, followed by the
+        // read-back message for each controller
+        // Note: The Motor Controller returns the first byte of the command data when read
+        for (uint i=0; i<num_mcs; i++)
+        {
+            auto& cmd = haptic_modes[batch[i]].knob_cmd_image;
+            uint16_t addr = MOTOR_CONTROLLER_BASE_I2C_SLAVE_ADDR + mc_nums[batch[i]];
+            msgs[i].addr = addr;
+            msgs[i].flags = 0;
+            msgs[i].len = cmd.size();
+            msgs[i].buf = const_cast<uint8_t *>(cmd.data());
+            msgs[num_mcs + i].addr = addr;
+            msgs[num_mcs + i].flags = I2C_M_RD;
+            msgs[num_mcs + i].len = sizeof(resps[0]);
+            msgs[num_mcs + i].buf = &resps[i];
+        }
 
-                // Was the haptic mode correctly set and enabled if required?
+        // Perform the transfer
+        // Any haptic mode not read-back as expected is written again separately, with
+        // a robust write
+        // Note: If any message fails the whole transfer fails, and none of the read-backs
+        // can be relied on
+        int ret = _i2c_transfer(msgs, (num_mcs * 2));
+        bool transferred = (ret == (int)(num_mcs * 2));
+#ifdef SURFACE_HW_I2C_INTERFACE_STATS
+        num_haptic_mode_batches++;
+#endif
+        for (uint i=0; i<num_mcs; i++)
+        {
+            uint8_t mc_num = mc_nums[batch[i]];
+            auto& haptic_mode = haptic_modes[batch[i]];
+            if (transferred && (resps[i] == haptic_mode.knob_cmd_image[sizeof(uint8_t)]))
+            {
+                // The haptic mode command was written, enable the haptic mode if required
+                ret = _select_motor_controller(mc_num);
                 if (ret == 0)
                 {
-                    // Save the haptic details
-                    _motor_controller_haptic_mode[mc_num] = haptic_mode.name;
-                    _motor_controller_haptic_set[mc_num] = true;
+                    ret = _motor_controller_enable_haptic_mode(mc_num, haptic_mode);
                 }
             }
             else
             {
-                // Disable the haptic mode
-                uint8_t mode_cmd[] = { MotorControllerRegMap::MOTION_MODE_HAPTIC, 0x00};
-                ret = _i2c_robust_write(mode_cmd, sizeof(mode_cmd), true, mode_cmd[sizeof(uint8_t)]);
-
-                // Was the haptic mode correctly disabled?
-                if (ret == 0)
-                {
-                    // Save the haptic details
-                    _motor_controller_haptic_mode[mc_num] = haptic_mode.name;
-                    _motor_controller_haptic_set[mc_num] = false;
-                }
+                // Set the haptic mode separately
+                ret = _motor_controller_set_haptic_mode(mc_num, haptic_mode);
             }
+            if (ret < 0)
+            {
+                // Set Motor Controller haptic mode failed
+                DEBUG_MSG("Motor Controller " << (int)mc_num << " set haptic mode: FAILED");
+            }
+            if (results)
+                results[batch[i]] = ret;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _motor_controller_enable_haptic_mode
+// Note: The Motor Controller must be selected by the caller
+//----------------------------------------------------------------------------
+int SurfaceControl::_motor_controller_enable_haptic_mode(uint8_t mc_num, const HapticMode& haptic_mode)
+{
+    int ret = 0;
+
+    // If knob haptics are switched on
+    if (haptic_mode.knob_haptics_on())
+    {
+        // Once the config has been set, enable haptic mode in the Motor Controller if
+        // not already enabled
+        // Use a robust write
+        if (!_motor_controller_haptic_set[mc_num])
+        {
+            uint8_t mode_cmd[] = { MotorControllerRegMap::MOTION_MODE_HAPTIC, 0x01};
+            ret = _i2c_robust_write(mode_cmd, sizeof(mode_cmd), true, mode_cmd[sizeof(uint8_t)]);
+        }
+
+        // Was the haptic mode enabled if required?
+        if (ret == 0)
+        {
+            // Save the haptic details
+            _motor_controller_haptic_mode_id[mc_num] = haptic_mode.id;
+            _motor_controller_haptic_set[mc_num] = true;
         }
     }
+    else
+    {
+        // The haptic mode was disabled, save the haptic details
+        _motor_controller_haptic_mode_id[mc_num] = haptic_mode.id;
+        _motor_controller_haptic_set[mc_num] = false;
+    }
     return ret;
 }
 
@@ -1366,25 +1927,108 @@ int SurfaceControl::_motor_controller_read_knob_state(uint8_t mc_num, KnobState
         ret = _i2c_read(resp, sizeof(resp));
         if (ret == 0)
         {
-#ifdef SURFACE_HW_LOG_MC_CAL_RESULTS            
-            // Log if the status is non-zero
-            if (resp[1])
-                _motor_status_file << "Motor Status: " << std::hex << resp[1] <<  '\n';
-#endif
+            // Return the position and state
+            ret = _motor_controller_parse_knob_state(resp, state);
+        }
+    }
+    return ret;
+}
 
-            // Make sure the response is valid
-            if (resp[0] > FLOAT_TO_KNOB_HW_VALUE_SCALING_FACTOR)
+//----------------------------------------------------------------------------
+// _motor_controller_transfer_knob_states
+//----------------------------------------------------------------------------
+void SurfaceControl::_motor_controller_transfer_knob_states(KnobState *states)
+{
+    struct i2c_msg msgs[I2C_TRANSFER_MAX_NUM_MSGS];
+    uint16_t resps[NUM_PHYSICAL_KNOBS][MOTOR_STATUS_RESP_NUM_WORDS];
+    uint8_t mc_nums[I2C_TRANSFER_MAX_NUM_KNOB_READS];
+    uint8_t cmd = MotorControllerRegMap::MOTOR_STATUS;
+    uint mc_num = 0;
+
+    // Transfer the knob states for each set of requested Motor Controllers
+    while (mc_num < NUM_PHYSICAL_KNOBS)
+    {
+        // Get the next set of requested Motor Controllers
+        uint num_mcs = 0;
+        for (; (mc_num < NUM_PHYSICAL_KNOBS) && (num_mcs < I2C_TRANSFER_MAX_NUM_KNOB_READS); mc_num++)
+        {
+            if (_motor_controller_knob_state_requested[mc_num])
             {
-                // The response is not valid
-                return -EIO;
+                mc_nums[num_mcs++] = mc_num;
             }
+        }
+        if (num_mcs == 0)
+        {
+            break;
+        }
 
-            // Return the position and state
-            state->position = resp[0];
-            state->state = resp[1] & (KnobState::STATE_MOVING_TO_TARGET+KnobState::STATE_TAP_DETECTED);
+        // Add the request message for each controller, followed by the read message
+        // for each controller
+        // Note: This is the same order as requesting and then reading each knob state
+        // separately, so that each controller has the same time to process the request
+        for (uint i=0; i<num_mcs; i++)
+        {
+            uint16_t addr = MOTOR_CONTROLLER_BASE_I2C_SLAVE_ADDR + mc_nums[i];
+            msgs[i].addr = addr;
+            msgs[i].flags = 0;
+            msgs[i].len = sizeof(cmd);
+            msgs[i].buf = &cmd;
+            msgs[num_mcs + i].addr = addr;
+            msgs[num_mcs + i].flags = I2C_M_RD;
+            msgs[num_mcs + i].len = sizeof(resps[0]);
+            msgs[num_mcs + i].buf = reinterpret_cast<uint8_t *>(resps[mc_nums[i]]);
+        }
+
+        // Perform the transfer
+        // Note: If any message fails the whole transfer fails, and none of the reads
+        // can be relied on
+        int ret = _i2c_transfer(msgs, (num_mcs * 2));
+        bool transferred = (ret == (int)(num_mcs * 2));
+        for (uint i=0; i<num_mcs; i++)
+        {
+            uint8_t num = mc_nums[i];
+            if (transferred)
+            {
+                // Return the position and state
+                _motor_controller_knob_state_result[num] = _motor_controller_parse_knob_state(resps[num], &states[num]);
+            }
+            else
+            {
+                // The knob state was not read in the transfer, so request and read
+                // it separately (with retries)
+                int res = _motor_controller_request_knob_state(num);
+                if (res == 0)
+                {
+                    res = _motor_controller_read_knob_state(num, &states[num]);
+                }
+                _motor_controller_knob_state_result[num] = res;
+            }
         }
     }
-    return ret;
+}
+
+//----------------------------------------------------------------------------
+// _motor_controller_parse_knob_state
+//----------------------------------------------------------------------------
+int SurfaceControl::_motor_controller_parse_knob_state(const uint16_t *resp, KnobState *state)
+{
+#ifdef SURFACE_HW_LOG_MC_CAL_RESULTS            
+    // Log if the status is non-zero
+    if (resp[1])
+        _motor_status_file << "Motor Status: " << std::hex << resp[1] <<  '\n';
+#endif
+
+    // Make sure the response is valid
+    if (resp[0] > FLOAT_TO_KNOB_HW_VALUE_SCALING_FACTOR)
+    {
+        // The response is not valid
+        return -EIO;
+    }
+
+    // Return the position and state
+    state->position = resp[0];
+    state->state = resp[1] & (KnobState::STATE_MOVING_TO_TARGET+KnobState::STATE_TAP_DETECTED);
+    return 0;
 }
 
 //----------------------------------------------------------------------------
@@ -1781,6 +2425,33 @@ int SurfaceControl::_i2c_write(const void *buf, size_t buf_len)
     return ret; 
 }
 
+//----------------------------------------------------------------------------
+// _i2c_transfer
+//----------------------------------------------------------------------------
+int SurfaceControl::_i2c_transfer(struct i2c_msg *msgs, uint num_msgs)
+{
+    struct i2c_rdwr_ioctl_data data;
+
+    // Perform the combined transfer
+    // Note: No retries are performed - if the transfer fails, no messages can be
+    // assumed transferred, and the caller retries each separately
+    data.msgs = msgs;
+    data.nmsgs = num_msgs;
+    int ret = ioctl(_dev_handle, I2C_RDWR, &data);
+    if (ret < 0)
+    {
+        // The transfer failed
+#ifdef SURFACE_HW_I2C_INTERFACE_STATS
+        num_i2c_transfer_errors++;
+#endif
+        return -errno;
+    }
+#ifdef SURFACE_HW_I2C_INTERFACE_STATS
+    num_i2c_transfers++;
+#endif
+    return ret;
+}
+
 #ifdef SURFACE_HW_LOG_MC_CAL_RESULTS
 //----------------------------------------------------------------------------
 // _log_mc_calibration_results
@@ -10,8 +10,11 @@
 #define _SURFACE_CONTROL_H
 
 #include <mutex>
+#include <thread>
+#include <condition_variable>
 #include <vector>
 #include <fstream>
+#include <linux/i2c.h>
 #include "common.h"
 
 // Surface Control types
@@ -59,6 +62,7 @@ struct HapticMode
 {
     SurfaceControlType type;
     std::string name;
+    uint id;
     bool default_mode;
 
     // Knob related params
@@ -74,11 +78,16 @@ struct HapticMode
     // Switch related params
     SwitchMode switch_mode;
 
+    // Compiled knob haptic mode - the Motor Controller command written to apply the
+    // mode, set when the mode is added to the haptic modes
+    std::vector<uint8_t> knob_cmd_image;
+
     // Constructor
     HapticMode()
     {
         type = SurfaceControlType::UNKNOWN;
         name = "";
+        id = 0;
         default_mode = false;
         knob_start_pos = -1;
         knob_width = 360;
@@ -89,6 +98,7 @@ struct HapticMode
         knob_detent_strength = 0;
         knob_indents.clear();
         switch_mode = SwitchMode::PUSH;
+        knob_cmd_image.clear();
     }
 
     // Public functions
@@ -103,11 +113,16 @@ struct HapticMode
 };
 
 // Surface Control class
+// Knob position, haptic mode, and LED commit requests are queued and written by a
+// bus worker thread, so that callers are never blocked by the I2C bus
+// Reads always have priority over the queued commands - the bus worker does not
+// start a queued command while a read is pending
 class SurfaceControl
 {
 public:
     // Helper functions
     static SurfaceControlType ControlTypeFromString(const char *type);
+    static void CompileHapticMode(HapticMode& haptic_mode);
 
     // Constructor
     SurfaceControl();
@@ -121,27 +136,62 @@ public:
     void lock();
     void unlock();
     bool knob_is_active(uint num);
-    int request_knob_states();
+    int request_knob_states(const bool *poll_knobs=nullptr);
     int read_knob_states(KnobState *states);
+    int knob_state_result(uint num);
     int read_switch_states(bool *states);
     int set_knob_haptic_mode(unsigned int num, const HapticMode& haptic_mode);
     int set_knob_position(unsigned int num, uint16_t position, bool robust=true);
+    int knob_position_result(unsigned int num, uint16_t position);
     int set_switch_led_state(unsigned int num, bool led_on);
     void set_all_switch_led_states(bool leds_on);
     int commit_led_states();
     void reinit();
 
 private:
+    // Queued bus commands for a knob
+    // Only the latest position and haptic mode queued for a knob are written to it
+    // The result of the last position and haptic mode written is returned when the
+    // next is queued
+    struct KnobBusCommands
+    {
+        bool position_pending;
+        uint16_t position;
+        bool robust;
+        int position_result;
+        bool position_writing;
+        bool position_written;
+        uint16_t written_position;
+        int written_position_result;
+        bool haptic_mode_pending;
+        HapticMode haptic_mode;
+        int haptic_mode_result;
+    };
+
     // Private data
     int _dev_handle;
     bool _panel_controller_active;
     bool _motor_controller_active[NUM_PHYSICAL_KNOBS];
     bool _motor_controller_knob_state_requested[NUM_PHYSICAL_KNOBS];
+    int _motor_controller_knob_state_result[NUM_PHYSICAL_KNOBS];
     bool _motor_controller_haptic_set[NUM_PHYSICAL_KNOBS];
-    std::string _motor_controller_haptic_mode[NUM_PHYSICAL_KNOBS];
+    uint _motor_controller_haptic_mode_id[NUM_PHYSICAL_KNOBS];
     uint8_t *_led_states;
+    uint8_t *_committed_led_states;
+    bool _committed_led_states_valid;
+    uint _num_led_commits_skipped;
     std::mutex _controller_mutex;
+    std::mutex _led_states_mutex;
+    std::mutex _bus_queue_mutex;
+    std::condition_variable _bus_queue_cv;
+    std::thread *_bus_thread;
+    bool _run_bus_thread;
+    uint _num_bus_reads_pending;
+    KnobBusCommands _knob_bus_commands[NUM_PHYSICAL_KNOBS];
+    uint _next_bus_knob_num;
+    bool _led_commit_pending;
     int _selected_controller_addr;
+    bool _i2c_combined_transfers;
 #ifdef SURFACE_HW_I2C_INTERFACE_STATS
     uint num_i2c_writes;
     uint num_i2c_write_nacks;
@@ -151,6 +201,12 @@ private:
     uint num_i2c_read_nacks;
     uint num_i2c_read_timeouts;
     uint num_i2c_read_errors;
+    uint num_i2c_transfers;
+    uint num_i2c_transfer_errors;
+    uint num_led_commits;
+    uint num_led_commits_skipped;
+    uint num_knob_positions_collapsed;
+    uint num_haptic_mode_batches;
 #endif
 #ifdef SURFACE_HW_LOG_MC_CAL_RESULTS
     std::ofstream _motor_status_file;
@@ -158,6 +214,11 @@ private:
 
     // Private functuions
     void _init_controllers();
+    void _process_bus_commands();
+    bool _bus_commands_pending();
+    void _clear_bus_commands();
+    void _stop_bus_thread();
+    int _commit_led_states();
     int _motor_controller_request_status(uint8_t mc_num);
     int _motor_controller_reboot(uint8_t mc_num);    
     int _motor_controller_set_addr(uint8_t mc_num);
@@ -169,8 +230,12 @@ private:
     int _motor_controller_request_find_datum(uint8_t mc_num);
     int _motor_controller_read_find_datum_status(uint8_t mc_num, uint8_t *status);
     int _motor_controller_set_haptic_mode(uint8_t mc_num, const HapticMode& haptic_mode);
+    void _motor_controller_set_haptic_modes(const uint8_t *mc_nums, const HapticMode *haptic_modes, uint num_modes, int *results=nullptr);
+    int _motor_controller_enable_haptic_mode(uint8_t mc_num, const HapticMode& haptic_mode);
     int _motor_controller_request_knob_state(uint8_t mc_num);
     int _motor_controller_read_knob_state(uint8_t mc_num, KnobState *states);
+    void _motor_controller_transfer_knob_states(KnobState *states);
+    int _motor_controller_parse_knob_state(const uint16_t *resp, KnobState *state);
     int _motor_controller_set_position(uint8_t mc_num, uint16_t position, bool robust);
     int _panel_controller_read_switch_states(uint8_t *switch_states);
     int _panel_controller_set_led_states(uint8_t *led_states);
@@ -183,6 +248,7 @@ private:
     int _i2c_read(void *buf, size_t buf_len);
     int _i2c_robust_write(const void *buf, size_t buf_len, bool readback, uint8_t readback_value=0);
     int _i2c_write(const void *buf, size_t buf_len);
+    int _i2c_transfer(struct i2c_msg *msgs, uint num_msgs);
 #ifdef SURFACE_HW_LOG_MC_CAL_RESULTS
     void _log_mc_calibration_results(uint8_t mc_num, bool mc_ok, std::string datetime);
 #endif
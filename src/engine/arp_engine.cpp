@@ -0,0 +1,408 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  arp_engine.cpp
+ * @brief Arpeggiator Engine implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "arp_engine.h"
+
+//----------------------------------------------------------------------------
+// ArpNoteSet
+//----------------------------------------------------------------------------
+ArpNoteSet::ArpNoteSet()
+{
+    // Initialise class data
+    clear();
+}
+
+//----------------------------------------------------------------------------
+// set
+//----------------------------------------------------------------------------
+void ArpNoteSet::set(uint8_t note)
+{
+    if (note < ARP_ENGINE_NUM_MIDI_NOTES)
+        _bits[note >> 6] |= (1ULL << (note & 63));
+}
+
+//----------------------------------------------------------------------------
+// reset
+//----------------------------------------------------------------------------
+void ArpNoteSet::reset(uint8_t note)
+{
+    if (note < ARP_ENGINE_NUM_MIDI_NOTES)
+        _bits[note >> 6] &= ~(1ULL << (note & 63));
+}
+
+//----------------------------------------------------------------------------
+// test
+//----------------------------------------------------------------------------
+bool ArpNoteSet::test(uint8_t note) const
+{
+    return (note < ARP_ENGINE_NUM_MIDI_NOTES) && (_bits[note >> 6] & (1ULL << (note & 63)));
+}
+
+//----------------------------------------------------------------------------
+// clear
+//----------------------------------------------------------------------------
+void ArpNoteSet::clear()
+{
+    std::memset(_bits, 0, sizeof(_bits));
+}
+
+//----------------------------------------------------------------------------
+// empty
+//----------------------------------------------------------------------------
+bool ArpNoteSet::empty() const
+{
+    return (_bits[0] | _bits[1]) == 0;
+}
+
+//----------------------------------------------------------------------------
+// count
+//----------------------------------------------------------------------------
+uint ArpNoteSet::count() const
+{
+    return __builtin_popcountll(_bits[0]) + __builtin_popcountll(_bits[1]);
+}
+
+//----------------------------------------------------------------------------
+// next
+//----------------------------------------------------------------------------
+int ArpNoteSet::next(int note) const
+{
+    // Return the lowest note in the set at or above the specified note, or -1 if
+    // there is none
+    for (uint i=std::max(note, 0); i<ARP_ENGINE_NUM_MIDI_NOTES; i=(i | 63) + 1)
+    {
+        uint64_t bits = _bits[i >> 6] & (~0ULL << (i & 63));
+        if (bits)
+            return (i & ~63U) + __builtin_ctzll(bits);
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------------
+// ArpEngine
+//----------------------------------------------------------------------------
+ArpEngine::ArpEngine()
+{
+    // Initialise class data
+    std::memset(_notes, 0, sizeof(_notes));
+    _assigned_notes.reserve(ARP_ENGINE_MAX_NOTES);
+    _play_order.reserve(ARP_ENGINE_MAX_NOTES * 2);
+    _num_ascending = 0;
+    _cursor = 0;
+    _last_index = 0;
+    _play_order_valid = false;
+    _dir_mode = ArpDirMode::UP;
+    _last_note = -1;
+    _last_descending = false;
+}
+
+//----------------------------------------------------------------------------
+// set_dir_mode
+//----------------------------------------------------------------------------
+void ArpEngine::set_dir_mode(ArpDirMode dir_mode)
+{
+    // Set the direction mode, the play order is recomputed from the last note
+    // played
+    if (dir_mode != _dir_mode)
+    {
+        _dir_mode = dir_mode;
+        _play_order_valid = false;
+    }
+}
+
+//----------------------------------------------------------------------------
+// dir_mode
+//----------------------------------------------------------------------------
+ArpDirMode ArpEngine::dir_mode() const
+{
+    return _dir_mode;
+}
+
+//----------------------------------------------------------------------------
+// add
+//----------------------------------------------------------------------------
+bool ArpEngine::add(const ArpNote &note)
+{
+    // Make sure the note is valid, and the capacity is not exceeded
+    if ((note.note >= ARP_ENGINE_NUM_MIDI_NOTES) ||
+        (!_note_set.test(note.note) && (_assigned_notes.size() >= ARP_ENGINE_MAX_NOTES)))
+        return false;
+
+    // Add the note, or update it if already added
+    if (!_note_set.test(note.note))
+    {
+        _note_set.set(note.note);
+        _assigned_notes.push_back(note.note);
+        _play_order_valid = false;
+    }
+    _notes[note.note] = note;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// remove
+//----------------------------------------------------------------------------
+bool ArpEngine::remove(uint8_t note)
+{
+    // Is the note in the set?
+    if (!_note_set.test(note))
+        return false;
+
+    // Remove the note
+    _note_set.reset(note);
+    _assigned_notes.erase(std::find(_assigned_notes.begin(), _assigned_notes.end(), note));
+    _play_order_valid = false;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// contains
+//----------------------------------------------------------------------------
+bool ArpEngine::contains(uint8_t note) const
+{
+    return _note_set.test(note);
+}
+
+//----------------------------------------------------------------------------
+// clear
+//----------------------------------------------------------------------------
+void ArpEngine::clear()
+{
+    // Remove all notes
+    _note_set.clear();
+    _assigned_notes.clear();
+    _play_order_valid = false;
+}
+
+//----------------------------------------------------------------------------
+// size
+//----------------------------------------------------------------------------
+uint ArpEngine::size() const
+{
+    return _assigned_notes.size();
+}
+
+//----------------------------------------------------------------------------
+// empty
+//----------------------------------------------------------------------------
+bool ArpEngine::empty() const
+{
+    return _assigned_notes.empty();
+}
+
+//----------------------------------------------------------------------------
+// get_notes
+//----------------------------------------------------------------------------
+void ArpEngine::get_notes(std::vector<ArpNote> &notes) const
+{
+    // Return the notes in the order they were added
+    notes.clear();
+    for (uint8_t note : _assigned_notes)
+    {
+        notes.push_back(_notes[note]);
+    }
+}
+
+//----------------------------------------------------------------------------
+// reset
+//----------------------------------------------------------------------------
+void ArpEngine::reset()
+{
+    // Start again from the beginning of the play order
+    _last_note = -1;
+    _last_descending = false;
+    _cursor = 0;
+    _last_index = 0;
+    _play_order_valid = false;
+}
+
+//----------------------------------------------------------------------------
+// next
+//----------------------------------------------------------------------------
+ArpNote ArpEngine::next()
+{
+    // Recompute the play order if needed
+    if (!_play_order_valid)
+        _build_play_order();
+    if (_play_order.empty())
+        return ArpNote();
+
+    // Get the note at the cursor, and advance the cursor
+    uint index = _cursor;
+    auto& note = _notes[_play_order[index]];
+    if (++_cursor >= _play_order.size())
+    {
+        // Wrap-around to the start of the play order - in RANDOM mode the notes are
+        // re-shuffled for the next pass
+        _cursor = 0;
+        if (_dir_mode == ArpDirMode::RANDOM)
+            _play_order_valid = false;
+    }
+    _last_note = note.note;
+    _last_index = index;
+    _last_descending = (_dir_mode == ArpDirMode::UPDOWN) && (index >= _num_ascending);
+    return note;
+}
+
+//----------------------------------------------------------------------------
+// peek
+//----------------------------------------------------------------------------
+ArpNote ArpEngine::peek(uint offset)
+{
+    // Recompute the play order if needed
+    if (!_play_order_valid)
+        _build_play_order();
+    if (_play_order.empty())
+        return ArpNote();
+
+    // Return the note the specified number of notes ahead of the cursor, without
+    // advancing it
+    // Note: In RANDOM mode, notes beyond the current pass are from the current shuffle
+    return _notes[_play_order[(_cursor + offset) % _play_order.size()]];
+}
+
+//----------------------------------------------------------------------------
+// play_order
+//----------------------------------------------------------------------------
+const std::vector<uint8_t> &ArpEngine::play_order()
+{
+    // Recompute the play order if needed
+    if (!_play_order_valid)
+        _build_play_order();
+    return _play_order;
+}
+
+//----------------------------------------------------------------------------
+// seed
+//----------------------------------------------------------------------------
+void ArpEngine::seed(uint seed)
+{
+    // Seed the RANDOM mode shuffle
+    _rng.seed(seed);
+}
+
+//----------------------------------------------------------------------------
+// _build_play_order
+//----------------------------------------------------------------------------
+void ArpEngine::_build_play_order()
+{
+    // Get the notes in ascending pitch order
+    _play_order.clear();
+    for (int note=_note_set.next(0); note >= 0; note=_note_set.next(note + 1))
+    {
+        _play_order.push_back(note);
+    }
+    uint num_notes = _play_order.size();
+    _num_ascending = num_notes;
+    _play_order_valid = true;
+    if (num_notes == 0)
+    {
+        _cursor = 0;
+        return;
+    }
+
+    // Build the play order for the direction mode, and position the cursor after the
+    // last note played
+    int cursor = -1;
+    switch (_dir_mode)
+    {
+    case ArpDirMode::UP:
+    default:
+        // Low to high pitch, continuing from the next highest note
+        cursor = _find_up(0, num_notes);
+        break;
+
+    case ArpDirMode::DOWN:
+        // High to low pitch, continuing from the next lowest note
+        std::reverse(_play_order.begin(), _play_order.end());
+        _num_ascending = 0;
+        cursor = _find_down(0, num_notes);
+        break;
+
+    case ArpDirMode::UPDOWN:
+        // Low to high pitch, and then back down without repeating the highest and lowest
+        // notes, continuing in the current direction from the last note played - if
+        // there are no more notes in the current direction, the direction changes
+        for (int i=static_cast<int>(num_notes)-2; i>0; i--)
+        {
+            _play_order.push_back(_play_order[i]);
+        }
+        if (_last_descending)
+        {
+            cursor = _find_down(num_notes, _play_order.size());
+            if (cursor < 0)
+                cursor = _find_up(0, num_notes);
+        }
+        else
+        {
+            cursor = _find_up(0, num_notes);
+            if (cursor < 0)
+                cursor = _find_down(num_notes, _play_order.size());
+        }
+        break;
+
+    case ArpDirMode::RANDOM:
+        // A random permutation of the notes, re-shuffled on each pass
+        std::shuffle(_play_order.begin(), _play_order.end(), _rng);
+        _num_ascending = 0;
+        cursor = 0;
+        break;
+
+    case ArpDirMode::ASSIGNED:
+        // The order the notes were added, continuing from the note after the last note
+        // played - if the last note played has been removed, from the note now in its
+        // position
+        _play_order = _assigned_notes;
+        _num_ascending = 0;
+        if ((_last_note >= 0) && _note_set.test(_last_note))
+        {
+            cursor = (std::find(_play_order.begin(), _play_order.end(), _last_note) - _play_order.begin()) + 1;
+        }
+        else
+        {
+            cursor = _last_index;
+        }
+        cursor %= num_notes;
+        break;
+    }
+    _cursor = (cursor < 0) ? 0 : cursor;
+}
+
+//----------------------------------------------------------------------------
+// _find_up
+//----------------------------------------------------------------------------
+int ArpEngine::_find_up(uint start, uint end) const
+{
+    // Return the index of the first note higher than the last note played, or -1 if
+    // there is none
+    for (uint i=start; i<end; i++)
+    {
+        if (_play_order[i] > _last_note)
+            return i;
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------------
+// _find_down
+//----------------------------------------------------------------------------
+int ArpEngine::_find_down(uint start, uint end) const
+{
+    // Return the index of the first note lower than the last note played, or -1 if
+    // there is none
+    // Note: If no note has been played, any note is lower
+    for (uint i=start; i<end; i++)
+    {
+        if ((_last_note < 0) || (_play_order[i] < _last_note))
+            return i;
+    }
+    return -1;
+}
@@ -0,0 +1,111 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  arp_engine.h
+ * @brief Arpeggiator Engine class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _ARP_ENGINE_H
+#define _ARP_ENGINE_H
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include "common.h"
+
+// Arpeggiator engine constants
+constexpr uint ARP_ENGINE_NUM_MIDI_NOTES = 128;
+constexpr uint ARP_ENGINE_MAX_NOTES = 100;
+
+// Arpeggiator Direction Mode
+enum ArpDirMode : int
+{
+    UP = 0,
+    DOWN,
+    UPDOWN,
+    RANDOM,
+    ASSIGNED,
+    NUM_DIR_MODES
+};
+
+// Arpeggiator note
+struct ArpNote
+{
+    uint8_t note;
+    uint8_t velocity;
+    uint8_t channel;
+};
+
+// Arpeggiator Note Set class
+// A set of MIDI note numbers held as a 128-bit mask
+class ArpNoteSet
+{
+public:
+    // Constructor
+    ArpNoteSet();
+
+    // Public functions
+    void set(uint8_t note);
+    void reset(uint8_t note);
+    bool test(uint8_t note) const;
+    void clear();
+    bool empty() const;
+    uint count() const;
+    int next(int note) const;
+
+private:
+    // Private variables
+    uint64_t _bits[ARP_ENGINE_NUM_MIDI_NOTES / 64];
+};
+
+// Arpeggiator Engine class
+// Holds the notes being arpeggiated, and the order they are played in for the
+// current direction mode - the play order is only recomputed when the notes or
+// direction mode change, so getting the next note is a cursor advance
+// When the play order is recomputed, the cursor continues from the last note
+// played (for example, in UP mode from the next highest note)
+class ArpEngine
+{
+public:
+    // Constructor
+    ArpEngine();
+
+    // Public functions
+    void set_dir_mode(ArpDirMode dir_mode);
+    ArpDirMode dir_mode() const;
+    bool add(const ArpNote &note);
+    bool remove(uint8_t note);
+    bool contains(uint8_t note) const;
+    void clear();
+    uint size() const;
+    bool empty() const;
+    void get_notes(std::vector<ArpNote> &notes) const;
+    void reset();
+    ArpNote next();
+    ArpNote peek(uint offset=0);
+    const std::vector<uint8_t> &play_order();
+    void seed(uint seed);
+
+private:
+    // Private variables
+    ArpNoteSet _note_set;
+    ArpNote _notes[ARP_ENGINE_NUM_MIDI_NOTES];
+    std::vector<uint8_t> _assigned_notes;
+    std::vector<uint8_t> _play_order;
+    uint _num_ascending;
+    uint _cursor;
+    uint _last_index;
+    bool _play_order_valid;
+    ArpDirMode _dir_mode;
+    int _last_note;
+    bool _last_descending;
+    std::minstd_rand _rng;
+
+    // Private functions
+    void _build_play_order();
+    int _find_up(uint start, uint end) const;
+    int _find_down(uint start, uint end) const;
+};
+
+#endif // _ARP_ENGINE_H
@@ -0,0 +1,349 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  bank_index.cpp
+ * @brief Bank Index implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <cstdlib>
+#include <cerrno>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <unordered_set>
+#include "bank_index.h"
+
+// Constants
+constexpr uint32_t PATCHES_DIR_WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+constexpr uint32_t BANK_DIR_WATCH_MASK    = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+constexpr uint INOTIFY_READ_BUFFER_SIZE   = 4096;
+
+//----------------------------------------------------------------------------
+// BankIndex
+//----------------------------------------------------------------------------
+BankIndex::BankIndex(std::string patches_dir) :
+    _patches_dir(patches_dir)
+{
+    // Initialise class data
+    // Note: The index is not built until it is first used
+    _inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    _patches_dir_wd = -1;
+    _valid = false;
+    _patches_folder_exists = false;
+}
+
+//----------------------------------------------------------------------------
+// ~BankIndex
+//----------------------------------------------------------------------------
+BankIndex::~BankIndex()
+{
+    // Close the inotify instance, this also removes all the watches
+    if (_inotify_fd != -1) {
+        ::close(_inotify_fd);
+    }
+}
+
+//----------------------------------------------------------------------------
+// patches_folder_exists
+//----------------------------------------------------------------------------
+bool BankIndex::patches_folder_exists()
+{
+    // Get the bank index mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Update the index and return if the patches folder exists
+    _update();
+    return _patches_folder_exists;
+}
+
+//----------------------------------------------------------------------------
+// bank_folders
+//----------------------------------------------------------------------------
+std::map<uint, std::string> BankIndex::bank_folders()
+{
+    std::map<uint, std::string> folder_names;
+
+    // Get the bank index mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Update the index and return the bank folder names
+    _update();
+    for (const auto& bank : _banks) {
+        folder_names[bank.first] = bank.second.folder_name;
+    }
+    return folder_names;
+}
+
+//----------------------------------------------------------------------------
+// bank_folder
+//----------------------------------------------------------------------------
+bool BankIndex::bank_folder(uint bank_num, std::string& folder_name)
+{
+    // Get the bank index mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Update the index and find the bank
+    _update();
+    auto itr = _banks.find(bank_num);
+    if (itr != _banks.end()) {
+        folder_name = itr->second.folder_name;
+        return true;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// patch_files
+//----------------------------------------------------------------------------
+bool BankIndex::patch_files(const std::string& bank_folder_path, std::map<uint, std::string>& filenames)
+{
+    // Get the bank folder name from the path
+    // If this path is not in the patches folder, it is not indexed
+    if (bank_folder_path.compare(0, _patches_dir.size(), _patches_dir) != 0) {
+        return false;
+    }
+    auto folder_name = bank_folder_path.substr(_patches_dir.size());
+    while (!folder_name.empty() && (folder_name.back() == '/')) {
+        folder_name.pop_back();
+    }
+
+    // Get the bank index mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Update the index and find the bank
+    _update();
+    for (const auto& bank : _banks) {
+        if (bank.second.folder_name == folder_name) {
+            // Return the patch filenames in this bank
+            filenames = bank.second.patch_files;
+            return true;
+        }
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// _update
+// Note: The bank index mutex must be held by the caller
+//----------------------------------------------------------------------------
+void BankIndex::_update()
+{
+    alignas(struct inotify_event) char buffer[INOTIFY_READ_BUFFER_SIZE];
+    std::unordered_set<int> changed_wds;
+    bool rescan_banks = false;
+
+    // If the index has not been built (or cannot be kept current), rebuild it
+    if (!_valid) {
+        _rebuild();
+        return;
+    }
+
+    // Read all pending inotify events
+    while (true) {
+        auto len = ::read(_inotify_fd, buffer, sizeof(buffer));
+        if (len <= 0) {
+            // No more events
+            break;
+        }
+        const char *ptr = buffer;
+        while (ptr < (buffer + len)) {
+            auto event = reinterpret_cast<const struct inotify_event *>(ptr);
+            if (event->mask & IN_Q_OVERFLOW) {
+                // Events have been lost, so the whole index must be rebuilt
+                _valid = false;
+            }
+            else if (event->wd == _patches_dir_wd) {
+                // If the patches folder itself has been removed or moved, the whole index
+                // must be rebuilt, otherwise a bank folder has been added or removed
+                if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                    _valid = false;
+                }
+                else {
+                    rescan_banks = true;
+                }
+            }
+            else {
+                // A patch file has been added or removed in a bank folder
+                changed_wds.insert(event->wd);
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    // Apply the changes
+    if (!_valid) {
+        _rebuild();
+        return;
+    }
+    if (rescan_banks) {
+        _scan_banks();
+    }
+    for (int wd : changed_wds) {
+        auto itr = _bank_wds.find(wd);
+        if (itr != _bank_wds.end()) {
+            _scan_bank(_banks[itr->second]);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _rebuild
+// Note: The bank index mutex must be held by the caller
+//----------------------------------------------------------------------------
+void BankIndex::_rebuild()
+{
+    // Remove all the existing watches and clear the index
+    for (const auto& bank : _banks) {
+        _remove_bank_watch(bank.second.wd);
+    }
+    _banks.clear();
+    _bank_wds.clear();
+    if (_patches_dir_wd != -1) {
+        (void)::inotify_rm_watch(_inotify_fd, _patches_dir_wd);
+        _patches_dir_wd = -1;
+    }
+
+    // Watch the patches folder for bank folders being added or removed
+    // Note: The watch is added before the folder is scanned, so that no change is missed
+    if (_inotify_fd != -1) {
+        _patches_dir_wd = ::inotify_add_watch(_inotify_fd, _patches_dir.c_str(), PATCHES_DIR_WATCH_MASK);
+    }
+
+    // Scan the bank folders - the index is only valid if it can be kept current
+    _valid = (_patches_dir_wd != -1);
+    _scan_banks();
+}
+
+//----------------------------------------------------------------------------
+// _scan_banks
+// Note: The bank index mutex must be held by the caller
+//----------------------------------------------------------------------------
+void BankIndex::_scan_banks()
+{
+    std::map<uint, Bank> banks;
+    struct dirent **dirent = nullptr;
+    int num_files;
+
+    // Scan the patches folder
+    num_files = ::scandir(_patches_dir.c_str(), &dirent, 0, ::versionsort);
+    _patches_folder_exists = !((num_files == -1) && (errno == ENOENT));
+    if (num_files > 0) {
+        // Process each directory in the folder
+        for (uint i=0; i<(uint)num_files; i++) {
+            // Is this a directory?
+            if (dirent[i]->d_type == DT_DIR)
+            {
+                // Get the bank index from the folder name
+                // Note: If the folder name format is invalid, atoi will return 0 - which is ok
+                // as this is an invalid bank index
+                uint index = std::atoi(dirent[i]->d_name);
+
+                // Are the first four characters the bank index?
+                // We ignore any duplicated folders with the same index
+                if ((index > 0) && (dirent[i]->d_name[3] == '_') && (banks.count(index) == 0))
+                {
+                    // If this bank is already indexed, keep it as is, otherwise add it
+                    auto itr = _banks.find(index);
+                    if ((itr != _banks.end()) && (itr->second.folder_name == dirent[i]->d_name)) {
+                        banks[index] = std::move(itr->second);
+                        _banks.erase(itr);
+                    }
+                    else {
+                        Bank bank;
+                        bank.folder_name = dirent[i]->d_name;
+                        bank.wd = -1;
+                        banks[index] = bank;
+                    }
+                }
+            }
+            ::free(dirent[i]);
+        }
+    }
+    if (dirent) {
+        ::free(dirent);
+    }
+
+    // Remove the watches for any banks that no longer exist
+    // Note: This is done before any new banks are scanned, as a renamed bank folder
+    // would otherwise be given the same watch
+    for (const auto& bank : _banks) {
+        _remove_bank_watch(bank.second.wd);
+    }
+
+    // Update the index, and scan any new banks
+    _banks = std::move(banks);
+    _bank_wds.clear();
+    for (auto& bank : _banks) {
+        if (bank.second.wd == -1) {
+            _scan_bank(bank.second);
+        }
+        if (bank.second.wd != -1) {
+            _bank_wds[bank.second.wd] = bank.first;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _scan_bank
+// Note: The bank index mutex must be held by the caller
+//----------------------------------------------------------------------------
+void BankIndex::_scan_bank(Bank& bank)
+{
+    auto bank_folder_path = _patches_dir + bank.folder_name;
+    struct dirent **dirent = nullptr;
+    int num_files;
+
+    // Watch the bank folder for patch files being added or removed, if not already
+    // If the watch cannot be added, the index cannot be kept current and so is
+    // rebuilt on the next lookup
+    if ((bank.wd == -1) && (_inotify_fd != -1)) {
+        bank.wd = ::inotify_add_watch(_inotify_fd, bank_folder_path.c_str(), BANK_DIR_WATCH_MASK);
+    }
+    if (bank.wd == -1) {
+        _valid = false;
+    }
+
+    // Scan the patches bank folder
+    bank.patch_files.clear();
+    num_files = ::scandir(bank_folder_path.c_str(), &dirent, 0, ::versionsort);
+    if (num_files > 0) {
+        // Process each file in the folder
+        for (uint i=0; i<(uint)num_files; i++) {
+            // Is this a normal file?
+            if (dirent[i]->d_type == DT_REG)
+            {
+                // Get the patch index from the filename
+                // Note: If the filename format is invalid, atoi will return 0 - which is ok
+                // as this is an invalid patch index
+                uint index = std::atoi(dirent[i]->d_name);
+
+                // Are the first four characters the patch number?
+                // We ignore any duplicated patches with the same index
+                if ((index > 0) && (dirent[i]->d_name[3] == '_') && (bank.patch_files.count(index) == 0))
+                {
+                    // Add the patch filename
+                    bank.patch_files[index] = dirent[i]->d_name;
+                }
+            }
+            ::free(dirent[i]);
+        }
+    }
+    if (dirent) {
+        ::free(dirent);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _remove_bank_watch
+// Note: The bank index mutex must be held by the caller
+//----------------------------------------------------------------------------
+void BankIndex::_remove_bank_watch(int wd)
+{
+    // Remove the watch, if any
+    // Note: This fails if the bank folder has already been removed, which is ok
+    if ((wd != -1) && (_inotify_fd != -1)) {
+        (void)::inotify_rm_watch(_inotify_fd, wd);
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  bank_index.h
+ * @brief Bank Index class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _BANK_INDEX_H
+#define _BANK_INDEX_H
+
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+
+// Bank Index class
+// An in-memory index of the patch bank folders and the patch files in each bank,
+// so that the bank and patch lists can be shown without scanning the patches
+// folder each time
+// The index is built on first use, and kept current with inotify - any pending
+// inotify events are applied before each lookup, so a change made just before a
+// lookup (for example by a bank import script) is always seen
+class BankIndex
+{
+public:
+    // Constructor
+    BankIndex(std::string patches_dir);
+
+    // Destructor
+    virtual ~BankIndex();
+
+    // Public functions
+    bool patches_folder_exists();
+    std::map<uint, std::string> bank_folders();
+    bool bank_folder(uint bank_num, std::string& folder_name);
+    bool patch_files(const std::string& bank_folder_path, std::map<uint, std::string>& filenames);
+
+private:
+    // Indexed bank - the patch filenames include the file extension
+    struct Bank
+    {
+        std::string folder_name;
+        int wd;
+        std::map<uint, std::string> patch_files;
+    };
+
+    // Private variables
+    std::mutex _mutex;
+    std::string _patches_dir;
+    int _inotify_fd;
+    int _patches_dir_wd;
+    bool _valid;
+    bool _patches_folder_exists;
+    std::map<uint, Bank> _banks;
+    std::unordered_map<int, uint> _bank_wds;
+
+    void _update();
+    void _rebuild();
+    void _scan_banks();
+    void _scan_bank(Bank& bank);
+    void _remove_bank_watch(int wd);
+};
+
+#endif // _BANK_INDEX_H
@@ -0,0 +1,369 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  clock_engine.cpp
+ * @brief Clock Engine implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <time.h>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+#include "clock_engine.h"
+#include "tempo.h"
+#include "utils.h"
+#include "logger.h"
+
+// Static functions
+static void *_process_clock(void* data);
+
+// Private variables
+// Note: There is only one clock engine, so the tick count is shared
+std::atomic<uint64_t> _clock_engine_tick_count{0};
+
+//----------------------------------------------------------------------------
+// TickCount
+//----------------------------------------------------------------------------
+uint64_t ClockEngine::TickCount()
+{
+    // Return the number of clock ticks generated
+    return _clock_engine_tick_count.load(std::memory_order_acquire);
+}
+
+//----------------------------------------------------------------------------
+// ClockEngine
+//----------------------------------------------------------------------------
+ClockEngine::ClockEngine()
+{
+    // Initialise class data
+    _tick_fn = 0;
+    _external_sync_fn = 0;
+    _clock_thread = 0;
+    _run = false;
+    _internal_period_ns = _period_ns(MIN_TEMPO_BPM);
+    _pll_locked = false;
+    _pll_count = 0;
+    _pll_time_ns = 0;
+    _pll_period_ns = 0;
+    _pll_prev_input_ns = 0;
+    _pll_epoch = 0;
+    _pll_seq = 0;
+    _pll_published_epoch = 0;
+    _pll_published_count = 0;
+    _pll_published_time_ns = 0;
+    _pll_published_period_ns = 0;
+}
+
+//----------------------------------------------------------------------------
+// ~ClockEngine
+//----------------------------------------------------------------------------
+ClockEngine::~ClockEngine()
+{
+    // Make sure the clock thread is stopped
+    stop();
+}
+
+//----------------------------------------------------------------------------
+// start
+//----------------------------------------------------------------------------
+bool ClockEngine::start(std::function<void(void)> tick_fn, std::function<bool(void)> external_sync_fn)
+{
+    // Set the tick and clock source callback functions
+    _tick_fn = tick_fn;
+    _external_sync_fn = external_sync_fn;
+    _run = true;
+
+#ifndef NO_XENOMAI
+    // Create the real-time task to generate the clock ticks
+    // Note: The task sleeps in primary mode, and switches to secondary mode to call
+    // the tick callback
+    int res = utils::create_rt_task(&_clock_thread, _process_clock, this, SCHED_FIFO);
+    if (res < 0)
+    {
+        // Error creating the RT thread, show the error
+        NINA_LOG_ERROR(NinaModule::MIDI_DEVICE, "Could not start the clock engine thread: {}", errno);
+        _run = false;
+        return false;
+    }
+#else
+    // Create a normal thread to generate the clock ticks
+    _clock_thread = new std::thread(_process_clock, this);
+#endif
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// stop
+//----------------------------------------------------------------------------
+void ClockEngine::stop()
+{
+    // Clock thread running?
+    if (_clock_thread != 0)
+    {
+        // Stop the clock thread - it exits after at most one tick period
+        _run = false;
+#ifndef NO_XENOMAI
+        utils::stop_rt_task(&_clock_thread);
+#else
+        if (_clock_thread->joinable())
+            _clock_thread->join();
+        delete _clock_thread;
+#endif
+        _clock_thread = 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+// set_tempo
+//----------------------------------------------------------------------------
+void ClockEngine::set_tempo(float bpm)
+{
+    // Set the internal tick period, used from the next tick
+    _internal_period_ns = _period_ns(bpm);
+}
+
+//----------------------------------------------------------------------------
+// external_clock_start
+// Note: Must be called from the same thread as external_clock_tick
+//----------------------------------------------------------------------------
+void ClockEngine::external_clock_start()
+{
+    // The next external clock pulse re-aligns the generated ticks
+    _pll_locked = false;
+}
+
+//----------------------------------------------------------------------------
+// external_clock_tick
+// Note: Must be called from the same thread as external_clock_start
+//----------------------------------------------------------------------------
+void ClockEngine::external_clock_tick()
+{
+    int64_t now_ns = _now_ns();
+
+    // Is the PLL not locked, or has the external clock paused for longer than the
+    // slowest tempo?
+    if (!_pll_locked || ((now_ns - _pll_prev_input_ns) > (2 * _period_ns(MIN_TEMPO_BPM))))
+    {
+        // Re-align the PLL to this pulse, starting a new epoch so that the clock
+        // thread re-aligns its tick count
+        // The period is measured from the next pulse
+        _pll_locked = true;
+        _pll_count = 1;
+        _pll_time_ns = now_ns;
+        if (_pll_period_ns == 0)
+            _pll_period_ns = _internal_period_ns;
+        _pll_epoch++;
+    }
+    else
+    {
+        int64_t interval_ns = now_ns - _pll_prev_input_ns;
+        int64_t predicted_ns = _pll_time_ns + _pll_period_ns;
+        int64_t error_ns = now_ns - predicted_ns;
+        _pll_count++;
+
+        // Is this the first measured period, or is the phase error more than half a
+        // period (a large tempo change)? If so lock directly to the measured period
+        if ((_pll_count == 2) || (std::llabs(error_ns) > (_pll_period_ns / 2)))
+        {
+            _pll_time_ns = now_ns;
+            _pll_period_ns = interval_ns;
+        }
+        else
+        {
+            // Update the PLL phase and period from the phase error
+            _pll_time_ns = predicted_ns + static_cast<int64_t>(error_ns * CLOCK_ENGINE_PLL_PHASE_GAIN);
+            _pll_period_ns += static_cast<int64_t>(error_ns * CLOCK_ENGINE_PLL_PERIOD_GAIN);
+        }
+
+        // Clamp the period to the supported tempo range
+        _pll_period_ns = std::clamp(_pll_period_ns, _period_ns(MAX_TEMPO_BPM), _period_ns(MIN_TEMPO_BPM));
+    }
+    _pll_prev_input_ns = now_ns;
+
+    // Publish the PLL state to the clock thread
+    _publish_pll();
+}
+
+//----------------------------------------------------------------------------
+// external_tempo
+//----------------------------------------------------------------------------
+float ClockEngine::external_tempo()
+{
+    // Return the tempo being followed, or zero if no external clock has been received
+    int64_t period_ns = _pll_published_period_ns.load(std::memory_order_relaxed);
+    return period_ns ?
+            (CLOCK_ENGINE_NS_PER_MINUTE / (static_cast<float>(period_ns) * NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT)) :
+            0.0f;
+}
+
+//----------------------------------------------------------------------------
+// process_clock
+//----------------------------------------------------------------------------
+void ClockEngine::process_clock()
+{
+    int64_t deadline_ns = _now_ns();
+    bool external_sync = false;
+    uint64_t epoch = 0;
+    uint64_t tick_count = 0;
+
+    // Loop forever until exited
+    while (_run)
+    {
+        // Has the clock source changed? If so, re-start from now
+        if (_external_sync_fn() != external_sync)
+        {
+            external_sync = !external_sync;
+            deadline_ns = _now_ns();
+            epoch = 0;
+        }
+
+        // Generating the ticks from the internal tempo?
+        if (!external_sync)
+        {
+            // Get the next tick deadline - if the deadline is overrun by more than a period,
+            // re-start from now rather than generating a burst of ticks
+            int64_t period_ns = _internal_period_ns;
+            int64_t now_ns = _now_ns();
+            deadline_ns += period_ns;
+            if ((now_ns - deadline_ns) > period_ns)
+                deadline_ns = now_ns;
+
+            // Sleep until the deadline and generate the tick
+            _sleep_until(deadline_ns);
+            if (_run && !_external_sync_fn())
+                _tick();
+            continue;
+        }
+
+        // Get the PLL state
+        uint64_t pll_epoch;
+        uint64_t pll_count;
+        int64_t pll_time_ns;
+        int64_t pll_period_ns;
+        _read_pll(pll_epoch, pll_count, pll_time_ns, pll_period_ns);
+
+        // If the PLL has been re-aligned, the next tick is the pulse that aligned it
+        if ((pll_epoch != 0) && (pll_epoch != epoch))
+        {
+            epoch = pll_epoch;
+            tick_count = pll_count - 1;
+        }
+
+        // Wait if no external clock has been received, or the generated ticks are
+        // already one tick ahead of the received pulses
+        if ((epoch == 0) || (tick_count > pll_count))
+        {
+            _sleep_until(_now_ns() + CLOCK_ENGINE_EXTERNAL_POLL_NS);
+            continue;
+        }
+
+        // Sleep until the predicted time of the next tick - if this is in the past (the
+        // ticks are behind the received pulses) the tick is generated immediately
+        deadline_ns = pll_time_ns + (static_cast<int64_t>(tick_count + 1 - pll_count) * pll_period_ns);
+        _sleep_until(deadline_ns);
+        if (_run && _external_sync_fn())
+        {
+            tick_count++;
+            _tick();
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _publish_pll
+//----------------------------------------------------------------------------
+void ClockEngine::_publish_pll()
+{
+    // Write the PLL state, marking the sequence number as odd until complete
+    uint64_t seq = _pll_seq.load(std::memory_order_relaxed);
+    _pll_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _pll_published_epoch.store(_pll_epoch, std::memory_order_relaxed);
+    _pll_published_count.store(_pll_count, std::memory_order_relaxed);
+    _pll_published_time_ns.store(_pll_time_ns, std::memory_order_relaxed);
+    _pll_published_period_ns.store(_pll_period_ns, std::memory_order_relaxed);
+    _pll_seq.store(seq + 2, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------
+// _read_pll
+//----------------------------------------------------------------------------
+void ClockEngine::_read_pll(uint64_t& epoch, uint64_t& count, int64_t& time_ns, int64_t& period_ns)
+{
+    uint64_t seq;
+
+    // Read the PLL state, retrying if it was being written
+    do
+    {
+        seq = _pll_seq.load(std::memory_order_acquire);
+        epoch = _pll_published_epoch.load(std::memory_order_relaxed);
+        count = _pll_published_count.load(std::memory_order_relaxed);
+        time_ns = _pll_published_time_ns.load(std::memory_order_relaxed);
+        period_ns = _pll_published_period_ns.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || (seq != _pll_seq.load(std::memory_order_relaxed)));
+}
+
+//----------------------------------------------------------------------------
+// _tick
+//----------------------------------------------------------------------------
+void ClockEngine::_tick()
+{
+    // Increment the tick count, and call the tick callback
+    _clock_engine_tick_count.fetch_add(1, std::memory_order_release);
+    if (_tick_fn)
+        _tick_fn();
+}
+
+//----------------------------------------------------------------------------
+// _period_ns
+//----------------------------------------------------------------------------
+int64_t ClockEngine::_period_ns(float bpm)
+{
+    // Return the tick period for the tempo, clamped to the supported tempo range
+    bpm = std::clamp(bpm, static_cast<float>(MIN_TEMPO_BPM), static_cast<float>(MAX_TEMPO_BPM));
+    return static_cast<int64_t>(CLOCK_ENGINE_NS_PER_MINUTE / (bpm * NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT));
+}
+
+//----------------------------------------------------------------------------
+// _now_ns
+//----------------------------------------------------------------------------
+int64_t ClockEngine::_now_ns()
+{
+    struct timespec now;
+
+    // Return the monotonic time in nanoseconds
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    return (static_cast<int64_t>(now.tv_sec) * 1000000000) + now.tv_nsec;
+}
+
+//----------------------------------------------------------------------------
+// _sleep_until
+//----------------------------------------------------------------------------
+void ClockEngine::_sleep_until(int64_t deadline_ns)
+{
+    struct timespec deadline;
+
+    // Block the thread until the absolute deadline
+    deadline.tv_sec = deadline_ns / 1000000000;
+    deadline.tv_nsec = deadline_ns % 1000000000;
+#ifndef NO_XENOMAI
+    utils::rt_task_nanosleep_until(&deadline);
+#else
+    while (::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR);
+#endif
+}
+
+//----------------------------------------------------------------------------
+// _process_clock
+//----------------------------------------------------------------------------
+static void *_process_clock(void* data)
+{
+    auto clock_engine = static_cast<ClockEngine*>(data);
+    clock_engine->process_clock();
+
+    // To suppress warnings
+    return nullptr;
+}
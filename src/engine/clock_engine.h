@@ -0,0 +1,89 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  clock_engine.h
+ * @brief Clock Engine class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _CLOCK_ENGINE_H
+#define _CLOCK_ENGINE_H
+
+#include <functional>
+#include <atomic>
+#include <thread>
+#include "common.h"
+
+// Clock engine constants
+constexpr int64_t CLOCK_ENGINE_NS_PER_MINUTE = 60000000000;
+constexpr int64_t CLOCK_ENGINE_EXTERNAL_POLL_NS = 1000000;
+constexpr float CLOCK_ENGINE_PLL_PHASE_GAIN = 0.2f;
+constexpr float CLOCK_ENGINE_PLL_PERIOD_GAIN = 0.01f;
+
+// Clock Engine class
+// Generates the 24 PPQN tempo ticks for the sequencer and arpeggiator by sleeping
+// until each absolute tick deadline, so that ticks do not drift or accumulate the
+// scheduling jitter of a relative timer
+// When following an external MIDI clock, the tick deadlines are predicted by a
+// second-order PLL (phase and period) which is updated from each received clock
+// pulse - the generated ticks never lead the received pulses by more than one tick
+// The clock source (internal or external) is checked before each tick
+// Each tick increments a monotonic tick count, which can be read without a lock
+class ClockEngine
+{
+public:
+    // Helper functions
+    static uint64_t TickCount();
+
+    // Constructor
+    ClockEngine();
+
+    // Destructor
+    virtual ~ClockEngine();
+
+    // Public functions
+    bool start(std::function<void(void)> tick_fn, std::function<bool(void)> external_sync_fn);
+    void stop();
+    void set_tempo(float bpm);
+    void external_clock_start();
+    void external_clock_tick();
+    float external_tempo();
+    void process_clock();
+
+private:
+    // Private variables
+    std::function<void(void)> _tick_fn;
+    std::function<bool(void)> _external_sync_fn;
+#ifndef NO_XENOMAI
+    pthread_t _clock_thread;
+#else
+    std::thread *_clock_thread;
+#endif
+    std::atomic<bool> _run;
+    std::atomic<int64_t> _internal_period_ns;
+
+    // PLL state - updated by the MIDI thread only
+    bool _pll_locked;
+    uint64_t _pll_count;
+    int64_t _pll_time_ns;
+    int64_t _pll_period_ns;
+    int64_t _pll_prev_input_ns;
+    uint64_t _pll_epoch;
+
+    // PLL state published to the clock thread, protected by a sequence lock
+    std::atomic<uint64_t> _pll_seq;
+    std::atomic<uint64_t> _pll_published_epoch;
+    std::atomic<uint64_t> _pll_published_count;
+    std::atomic<int64_t> _pll_published_time_ns;
+    std::atomic<int64_t> _pll_published_period_ns;
+
+    // Private functions
+    void _publish_pll();
+    void _read_pll(uint64_t& epoch, uint64_t& count, int64_t& time_ns, int64_t& period_ns);
+    void _tick();
+    int64_t _period_ns(float bpm);
+    int64_t _now_ns();
+    void _sleep_until(int64_t deadline_ns);
+};
+
+#endif // _CLOCK_ENGINE_H
@@ -7,8 +7,32 @@
  *-----------------------------------------------------------------------------
  */
 
+#include <chrono>
+#include <cstddef>
+#include <new>
 #include "event.h"
 
+// Event pool constants
+constexpr uint EVENT_POOL_BLOCK_SIZE = 256;
+constexpr uint EVENT_POOL_CHUNK_NUM_BLOCKS = 128;
+
+// Event pool block
+union EventPoolBlock
+{
+    EventPoolBlock *next;
+    alignas(std::max_align_t) char data[EVENT_POOL_BLOCK_SIZE];
+};
+
+// Static variables
+// Note: The event pool is a free list of fixed size blocks, which grows in chunks
+// and is never released
+static std::atomic_flag _event_pool_lock = ATOMIC_FLAG_INIT;
+static EventPoolBlock *_event_pool_free_list = nullptr;
+
+// Static functions
+static void _lock_event_pool();
+static void _unlock_event_pool();
+
 //----------------------------------------------------------------------------
 // BaseEvent
 //----------------------------------------------------------------------------
@@ -17,6 +41,20 @@ BaseEvent::BaseEvent(NinaModule source_id, EventType type)
     // Initialise class data
     _source_id = source_id;
     _type = type;
+    _timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    _ref_count = 1;
+}
+
+//----------------------------------------------------------------------------
+// BaseEvent
+//----------------------------------------------------------------------------
+BaseEvent::BaseEvent(const BaseEvent &event)
+{
+    // Copy the event data, the copy has its own reference count
+    _source_id = event._source_id;
+    _type = event._type;
+    _timestamp = event._timestamp;
+    _ref_count = 1;
 }
 
 //----------------------------------------------------------------------------
@@ -45,6 +83,96 @@ EventType BaseEvent::type() const
     return _type; 
 }
 
+//----------------------------------------------------------------------------
+// timestamp
+//----------------------------------------------------------------------------
+uint64_t BaseEvent::timestamp() const
+{
+    // Return the monotonic (steady clock) creation time in nanoseconds
+    return _timestamp;
+}
+
+//----------------------------------------------------------------------------
+// add_ref
+//----------------------------------------------------------------------------
+void BaseEvent::add_ref() const
+{
+    // Add a reference to this event
+    _ref_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// release
+//----------------------------------------------------------------------------
+void BaseEvent::release() const
+{
+    // Release a reference to this event, and delete it if this was the last
+    if (_ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        delete this;
+    }
+}
+
+//----------------------------------------------------------------------------
+// operator new
+//----------------------------------------------------------------------------
+void *BaseEvent::operator new(std::size_t size)
+{
+    // If the event is too big for a pool block, allocate it normally
+    if (size > EVENT_POOL_BLOCK_SIZE)
+    {
+        return ::operator new(size);
+    }
+
+    // Get a free block from the pool
+    _lock_event_pool();
+    auto block = _event_pool_free_list;
+    if (block)
+    {
+        _event_pool_free_list = block->next;
+    }
+    _unlock_event_pool();
+
+    // If there were no free blocks, grow the pool
+    if (!block)
+    {
+        // Allocate a new chunk of blocks and link them together, keeping the
+        // first block for this event
+        block = new EventPoolBlock[EVENT_POOL_CHUNK_NUM_BLOCKS];
+        for (uint i=1; i<(EVENT_POOL_CHUNK_NUM_BLOCKS - 1); i++)
+        {
+            block[i].next = &block[i + 1];
+        }
+
+        // Add the new blocks to the free list
+        _lock_event_pool();
+        block[EVENT_POOL_CHUNK_NUM_BLOCKS - 1].next = _event_pool_free_list;
+        _event_pool_free_list = &block[1];
+        _unlock_event_pool();
+    }
+    return block;
+}
+
+//----------------------------------------------------------------------------
+// operator delete
+//----------------------------------------------------------------------------
+void BaseEvent::operator delete(void *ptr, std::size_t size)
+{
+    // If the event was not allocated from the pool, delete it normally
+    if (size > EVENT_POOL_BLOCK_SIZE)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    // Return the block to the pool
+    auto block = static_cast<EventPoolBlock *>(ptr);
+    _lock_event_pool();
+    block->next = _event_pool_free_list;
+    _event_pool_free_list = block;
+    _unlock_event_pool();
+}
+
 //----------------------------------------------------------------------------
 // MidiEvent
 //----------------------------------------------------------------------------
@@ -93,7 +221,7 @@ ParamChangedEvent::~ParamChangedEvent()
 //----------------------------------------------------------------------------
 // param_change
 //----------------------------------------------------------------------------
-ParamChange ParamChangedEvent::param_change() const
+const ParamChange& ParamChangedEvent::param_change() const
 {
     // Return the param change event
     return _param_change;
@@ -120,7 +248,7 @@ SystemFuncEvent::~SystemFuncEvent()
 //----------------------------------------------------------------------------
 // system_func
 //----------------------------------------------------------------------------
-SystemFunc SystemFuncEvent::system_func() const
+const SystemFunc& SystemFuncEvent::system_func() const
 {
     // Return the ssytem function event
     return _system_func;
@@ -174,8 +302,27 @@ SurfaceControlFuncEvent::~SurfaceControlFuncEvent()
 //----------------------------------------------------------------------------
 // sfc_func
 //----------------------------------------------------------------------------
-SurfaceControlFunc SurfaceControlFuncEvent::sfc_func() const
+const SurfaceControlFunc& SurfaceControlFuncEvent::sfc_func() const
 {
     // Return the Surface Control function
     return _sfc_func;
 }
+
+//----------------------------------------------------------------------------
+// _lock_event_pool
+//----------------------------------------------------------------------------
+static void _lock_event_pool()
+{
+    // Spin until the event pool lock is acquired
+    // Note: The lock is only ever held for a few instructions
+    while (_event_pool_lock.test_and_set(std::memory_order_acquire));
+}
+
+//----------------------------------------------------------------------------
+// _unlock_event_pool
+//----------------------------------------------------------------------------
+static void _unlock_event_pool()
+{
+    // Release the event pool lock
+    _event_pool_lock.clear(std::memory_order_release);
+}
@@ -9,6 +9,7 @@
 #ifndef _EVENT_H
 #define _EVENT_H
 
+#include <atomic>
 #include "alsa/asoundlib.h"
 #include "param.h"
 #include "system_func.h"
@@ -23,6 +24,7 @@ enum class EventType
 	RELOAD_PRESETS,
 	SURFACE_CONTROL_FUNC
 };
+constexpr uint NUM_EVENT_TYPES = static_cast<uint>(EventType::SURFACE_CONTROL_FUNC) + 1;
 
 // Surface Control Function types
 enum class SurfaceControlFuncType
@@ -74,6 +76,7 @@ class BaseEvent
 public:
 	// Constructor
 	BaseEvent(NinaModule source_id, EventType type);
+	BaseEvent(const BaseEvent &event);
 
 	// Destructor
 	virtual ~BaseEvent() = 0;
@@ -81,11 +84,24 @@ public:
 	// Public functions
 	NinaModule source_id() const;
 	EventType type() const;
+	uint64_t timestamp() const;
+
+	// Reference counting
+	// Events are shared read-only by all listeners they are posted to, and
+	// are deleted when the last reference is released
+	void add_ref() const;
+	void release() const;
+
+	// Events are allocated from the event pool
+	static void *operator new(std::size_t size);
+	static void operator delete(void *ptr, std::size_t size);
 
 private:
 	// Private data
     NinaModule _source_id;
     EventType _type;
+	uint64_t _timestamp;
+	mutable std::atomic<uint> _ref_count;
 };
 
 // MIDI Event class
@@ -113,7 +129,7 @@ public:
 	~ParamChangedEvent();
 
 	// Public functions
-    ParamChange param_change() const;
+    const ParamChange& param_change() const;
 
 private:
 	// Private data
@@ -129,7 +145,7 @@ public:
 	~SystemFuncEvent();
 
 	// Public functions
-    SystemFunc system_func() const;
+    const SystemFunc& system_func() const;
 
 private:
 	// Private data
@@ -161,7 +177,7 @@ public:
 	~SurfaceControlFuncEvent();
 
 	// Public functions
-    SurfaceControlFunc sfc_func() const;
+    const SurfaceControlFunc& sfc_func() const;
 
 private:
 	// Private data
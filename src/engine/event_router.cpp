@@ -10,6 +10,7 @@
 #include "event_router.h"
 #include "event.h"
 #include "base_manager.h"
+#include <algorithm>
 #include <iostream>
 #include <unistd.h>
 
@@ -19,7 +20,11 @@
 //----------------------------------------------------------------------------
 EventRouter::EventRouter()
 {
-    // Nothing specific to do
+    // Create the initial (empty) dispatch table
+    auto table = new EventDispatchTable();
+    _dispatch_tables.push_back(table);
+    _dispatch_table = table;
+    _frozen = false;
 }
 
 //----------------------------------------------------------------------------
@@ -27,7 +32,11 @@ EventRouter::EventRouter()
 //----------------------------------------------------------------------------
 EventRouter::~EventRouter()
 {
-    // Nothing specific to do
+    // Delete all the dispatch tables
+    for (auto table : _dispatch_tables)
+    {
+        delete table;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -35,45 +44,52 @@ EventRouter::~EventRouter()
 //----------------------------------------------------------------------------
 void EventRouter::register_event_listener(EventListener *listener)
 {
-    std::vector<EventListener *> *event_listeners = nullptr;
+    // Get the register mutex
+    std::lock_guard<std::mutex> lock(_register_mutex);
 
-    // Get the event listeners to modify
-    switch(listener->event_type())
+    // Check the dispatch table can still be modified
+    if (_frozen)
     {
-    case EventType::MIDI:
-        event_listeners = &_midi_event_listeners;
-        break;
-
-    case EventType::PARAM_CHANGED:
-        event_listeners = &_param_changed_event_listeners;
-        break;
-
-    case EventType::SYSTEM_FUNC:
-        event_listeners = &_system_func_event_listeners;
-        break;
-
-    case EventType::RELOAD_PRESETS:
-        event_listeners = &_reload_presets_event_listeners;
-        break;
-
-    case EventType::SURFACE_CONTROL_FUNC:
-        event_listeners = &_sfc_event_listeners;
-        break;   
+        DEBUG_MSG("EventRouter: Cannot register event listener, the dispatch table is frozen");
+        return;
     }
 
-    // The event listeners were found?
-    if (event_listeners)
+    // Check the listener source and type are valid
+    uint source = static_cast<uint>(listener->source_id());
+    uint type = static_cast<uint>(listener->event_type());
+    if ((source >= NUM_NINA_MODULES) || (type >= NUM_EVENT_TYPES))
     {
-        // Check if this listener is already registered
-        for(auto el : *event_listeners)
-        {
-            // If already registered simply return with no
-            // further action
-            if (el == listener)
-                return;
-        }
-        event_listeners->push_back(listener);
+        DEBUG_MSG("EventRouter: Invalid event listener");
+        return;
     }
+
+    // Check if this manager is already registered for this event source and type
+    // If already registered simply return with no further action
+    auto current_table = _dispatch_table.load(std::memory_order_relaxed);
+    auto &managers = current_table->managers[source][type];
+    if (std::find(managers.begin(), managers.end(), listener->mgr()) != managers.end())
+        return;
+
+    // Create a new dispatch table with this manager added, and make it the current
+    // dispatch table
+    // Note: Events may be being posted using the current table, so it is not modified.
+    // Tables are only deleted when the router is destroyed
+    auto table = new EventDispatchTable(*current_table);
+    table->managers[source][type].push_back(listener->mgr());
+    _dispatch_tables.push_back(table);
+    _dispatch_table.store(table, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------
+// freeze
+//----------------------------------------------------------------------------
+void EventRouter::freeze()
+{
+    // Get the register mutex
+    std::lock_guard<std::mutex> lock(_register_mutex);
+
+    // Freeze the dispatch table, no more listeners can be registered
+    _frozen = true;
 }
 
 //----------------------------------------------------------------------------
@@ -81,21 +97,8 @@ void EventRouter::register_event_listener(EventListener *listener)
 //----------------------------------------------------------------------------
 void EventRouter::post_midi_event(const MidiEvent *event)
 {
-    // Go through all of the registered MIDI listeners, and check if they
-    // are registered for this event
-    for(auto el : _midi_event_listeners)
-    {
-        // Is the event listener listening for this event source?
-        if(el->source_id() == event->source_id())
-        {
-            // Listener is registered for this event, post to that manager
-            // Note we need to take a copy of the event, so each manager gets its own copy
-            el->mgr()->post_msg(new MidiEvent(*event));
-        }
-    }
-
-    // Delete the passed event - this is no longer needed as a copy is passed to each listener
-    delete event;
+    // Post the event to the registered MIDI listeners
+    _post_event(event);
 }
 
 //----------------------------------------------------------------------------
@@ -103,21 +106,11 @@ void EventRouter::post_midi_event(const MidiEvent *event)
 //----------------------------------------------------------------------------
 void EventRouter::post_param_changed_event(const ParamChangedEvent *event)
 {
-    // Go through all of the registered Param Changed listeners, and check if they
-    // are registered for this event
-    for(auto el : _param_changed_event_listeners)
-    {
-        // Is the event listener listening for this event source?
-        if(el->source_id() == event->source_id())
-        {
-            // Listener is registered for this event, post to that manager
-            // Note we need to take a copy of the event, so each manager gets its own copy
-            el->mgr()->post_msg(new ParamChangedEvent(*event));
-        }
-    }
+    // If this param change is being traced, record that it has been routed
+    LatencyTrace::Record(event->param_change().trace_id, LatencyTraceStage::EVENT_ROUTED);
 
-    // Delete the passed event - this is no longer needed as a copy is passed to each listener
-    delete event;
+    // Post the event to the registered Param Changed listeners
+    _post_event(event);
 }
 
 //----------------------------------------------------------------------------
@@ -125,21 +118,8 @@ void EventRouter::post_param_changed_event(const ParamChangedEvent *event)
 //----------------------------------------------------------------------------
 void EventRouter::post_system_func_event(const SystemFuncEvent *event)
 {
-    // Go through all of the registered System Func listeners, and check if they
-    // are registered for this event
-    for(auto el : _system_func_event_listeners)
-    {
-        // Is the event listener listening for this event source?
-        if(el->source_id() == event->source_id())
-        {
-            // Listener is registered for this event, post to that manager
-            // Note we need to take a copy of the event, so each manager gets its own copy
-            el->mgr()->post_msg(new SystemFuncEvent(*event));
-        }
-    }
-
-    // Delete the passed event - this is no longer needed as a copy is passed to each listener
-    delete event;
+    // Post the event to the registered System Func listeners
+    _post_event(event);
 }
 
 //----------------------------------------------------------------------------
@@ -147,21 +127,8 @@ void EventRouter::post_system_func_event(const SystemFuncEvent *event)
 //----------------------------------------------------------------------------
 void EventRouter::post_reload_presets_event(const ReloadPresetsEvent *event)
 {
-    // Go through all of the registered Reload Presets listeners, and check if they
-    // are registered for this event
-    for(auto el : _reload_presets_event_listeners)
-    {
-        // Is the event listener listening for this event source?
-        if(el->source_id() == event->source_id())
-        {
-            // Listener is registered for this event, post to that manager
-            // Note we need to take a copy of the event, so each manager gets its own copy
-            el->mgr()->post_msg(new ReloadPresetsEvent(*event));
-        }
-    }
-
-    // Delete the passed event - this is no longer needed as a copy is passed to each listener
-    delete event;
+    // Post the event to the registered Reload Presets listeners
+    _post_event(event);
 }
 
 //----------------------------------------------------------------------------
@@ -169,19 +136,31 @@ void EventRouter::post_reload_presets_event(const ReloadPresetsEvent *event)
 //----------------------------------------------------------------------------
 void EventRouter::post_sfc_func_event(const SurfaceControlFuncEvent *event)
 {
-    // Go through all of the registered Surface Control listeners, and check if they
-    // are registered for this event
-    for(auto el : _sfc_event_listeners)
+    // Post the event to the registered Surface Control listeners
+    _post_event(event);
+}
+
+//----------------------------------------------------------------------------
+// _post_event
+//----------------------------------------------------------------------------
+void EventRouter::_post_event(const BaseEvent *event)
+{
+    // Check the event source is valid
+    uint source = static_cast<uint>(event->source_id());
+    if (source < NUM_NINA_MODULES)
     {
-        // Is the event listener listening for this event source?
-        if(el->source_id() == event->source_id())
+        // Go through all of the managers registered for this event source and
+        // type, and post the event to that manager
+        // Note the event is shared by all listeners, so add a reference for each manager
+        auto table = _dispatch_table.load(std::memory_order_acquire);
+        for (auto mgr : table->managers[source][static_cast<uint>(event->type())])
         {
-            // Listener is registered for this event, post to that manager
-            // Note we need to take a copy of the event, so each manager gets its own copy
-            el->mgr()->post_msg(new SurfaceControlFuncEvent(*event));
+            event->add_ref();
+            mgr->post_msg(event);
         }
     }
 
-    // Delete the passed event - this is no longer needed as a copy is passed to each listener
-    delete event;
+    // Release the passed event reference - the event is deleted here if there were
+    // no listeners
+    event->release();
 }
@@ -9,9 +9,19 @@
 #ifndef _EVENT_ROUTER_H
 #define _EVENT_ROUTER_H
 
+#include <atomic>
+#include <mutex>
+#include <vector>
 #include "event.h"
 #include "base_manager.h"
 
+// Event Dispatch Table
+// The managers to post each event to, indexed by event source and type
+struct EventDispatchTable
+{
+	std::vector<BaseManager *> managers[NUM_NINA_MODULES][NUM_EVENT_TYPES];
+};
+
 // Event Listener class
 class EventListener
 {
@@ -47,6 +57,7 @@ public:
 
 	// Public functions
 	void register_event_listener(EventListener *listener);
+	void freeze();
 	void post_midi_event(const MidiEvent *event);
 	void post_param_changed_event(const ParamChangedEvent *event);
 	void post_system_func_event(const SystemFuncEvent *event);
@@ -55,11 +66,13 @@ public:
 
 private:
 	// Private variables
-	std::vector<EventListener *> _midi_event_listeners;
-	std::vector<EventListener *> _param_changed_event_listeners;
-	std::vector<EventListener *> _system_func_event_listeners;
-	std::vector<EventListener *> _reload_presets_event_listeners;
-	std::vector<EventListener *> _sfc_event_listeners;
+	std::mutex _register_mutex;
+	std::atomic<const EventDispatchTable *> _dispatch_table;
+	std::vector<const EventDispatchTable *> _dispatch_tables;
+	bool _frozen;
+
+	// Private functions
+	void _post_event(const BaseEvent *event);
 };
 
 #endif  // _EVENT_ROUTER_H
@@ -0,0 +1,105 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  json_path_index.cpp
+ * @brief JSON Path Index implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <cstring>
+#include "json_path_index.h"
+
+//----------------------------------------------------------------------------
+// JsonPathIndex
+//----------------------------------------------------------------------------
+JsonPathIndex::JsonPathIndex()
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// ~JsonPathIndex
+//----------------------------------------------------------------------------
+JsonPathIndex::~JsonPathIndex()
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// find
+//----------------------------------------------------------------------------
+rapidjson::Value::ValueIterator JsonPathIndex::find(rapidjson::Value& json_data, const char *path)
+{
+    // Get the JSON path index mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Get the index for this JSON array, and (re)build it if the array has
+    // changed since it was indexed
+    auto& index = _indexes[&json_data];
+    if ((index.size != json_data.Size()) || ((index.size > 0) && (index.begin != json_data.Begin()))) {
+        _build_index(json_data, index);
+    }
+
+    // Find the path in the index
+    // Note: A path not in the index is not searched for, the entries are only ever
+    // appended to or replaced as a whole (which is detected above, or invalidated)
+    auto itr = index.positions.find(path);
+    if (itr != index.positions.end()) {
+        // Check the entry still matches, as the array could have been modified in-place
+        auto entry = json_data.Begin() + itr->second;
+        if (_entry_matches(*entry, path)) {
+            return entry;
+        }
+
+        // The index is stale, rebuild it and try again
+        _build_index(json_data, index);
+        itr = index.positions.find(path);
+        if (itr != index.positions.end()) {
+            return json_data.Begin() + itr->second;
+        }
+    }
+    return nullptr;
+}
+
+//----------------------------------------------------------------------------
+// invalidate
+//----------------------------------------------------------------------------
+void JsonPathIndex::invalidate()
+{
+    // Get the JSON path index mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Clear all indexes, they are rebuilt when next used
+    _indexes.clear();
+}
+
+//----------------------------------------------------------------------------
+// _build_index
+// Note: The JSON path index mutex must be held by the caller
+//----------------------------------------------------------------------------
+void JsonPathIndex::_build_index(rapidjson::Value& json_data, ArrayIndex& index)
+{
+    // Index the position of each entry by path
+    // Note: If a path is specified more than once, the first entry is used
+    index.positions.clear();
+    index.positions.reserve(json_data.Size());
+    for (rapidjson::SizeType i=0; i<json_data.Size(); i++) {
+        auto& entry = json_data[i];
+        if (entry.IsObject() && entry.HasMember("path") && entry["path"].IsString()) {
+            index.positions.emplace(entry["path"].GetString(), i);
+        }
+    }
+    index.begin = json_data.Begin();
+    index.size = json_data.Size();
+}
+
+//----------------------------------------------------------------------------
+// _entry_matches
+//----------------------------------------------------------------------------
+bool JsonPathIndex::_entry_matches(const rapidjson::Value& entry, const char *path)
+{
+    // Check the entry is still an object with this path
+    return entry.IsObject() && entry.HasMember("path") && entry["path"].IsString() &&
+           (std::strcmp(entry["path"].GetString(), path) == 0);
+}
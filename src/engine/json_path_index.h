@@ -0,0 +1,52 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  json_path_index.h
+ * @brief JSON Path Index class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _JSON_PATH_INDEX_H
+#define _JSON_PATH_INDEX_H
+
+#define RAPIDJSON_HAS_STDSTRING 1
+#include "rapidjson/document.h"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// JSON Path Index class
+// Finds the entry with a given path in JSON array sections (arrays of objects
+// with a "path" member), through a path-to-position hash index for each array
+class JsonPathIndex
+{
+public:
+    // Constructor/destructor
+    JsonPathIndex();
+    ~JsonPathIndex();
+
+    // Public functions
+    rapidjson::Value::ValueIterator find(rapidjson::Value& json_data, const char *path);
+    void invalidate();
+
+private:
+    // Array index - the position of each entry in a JSON array section, by path
+    // The array size and data pointer are used to detect if the array has changed
+    // (for example, an entry appended) since the index was built
+    struct ArrayIndex
+    {
+        const rapidjson::Value *begin;
+        rapidjson::SizeType size;
+        std::unordered_map<std::string, rapidjson::SizeType> positions;
+    };
+
+    // Private variables
+    std::mutex _mutex;
+    std::unordered_map<const rapidjson::Value *, ArrayIndex> _indexes;
+
+    // Private functions
+    void _build_index(rapidjson::Value& json_data, ArrayIndex& index);
+    bool _entry_matches(const rapidjson::Value& entry, const char *path);
+};
+
+#endif // _JSON_PATH_INDEX_H
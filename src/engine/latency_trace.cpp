@@ -0,0 +1,216 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  latency_trace.cpp
+ * @brief Latency Trace implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cerrno>
+#include <vector>
+#include <algorithm>
+#include "rapidjson/writer.h"
+#include "rapidjson/filewritestream.h"
+#include "latency_trace.h"
+#include "logger.h"
+
+// Latency trace record
+// Each field is atomic so that the ring buffer can be exported while it is being
+// written - the sequence number is zero while the record is being written, and is
+// checked before and after the record is read
+struct LatencyTraceRecord
+{
+    std::atomic<uint64_t> seq;
+    std::atomic<uint32_t> trace_id;
+    std::atomic<uint32_t> stage;
+    std::atomic<int64_t> time_ns;
+};
+
+// Exported latency trace record
+struct LatencyTraceEntry
+{
+    LatencyTraceId trace_id;
+    LatencyTraceStage stage;
+    int64_t time_ns;
+};
+
+// Constants
+constexpr char LATENCY_TRACE_CATEGORY[] = "latency";
+const char *_latency_trace_stage_names[] = {
+    "KNOB_READ",
+    "KNOB_DETECTED",
+    "EVENT_ROUTED",
+    "DAW_RECEIVED",
+    "SUSHI_WRITE",
+    "SUSHI_ECHO",
+    "GUI_RECEIVED",
+    "GUI_MQ_POST"
+};
+static_assert((LATENCY_TRACE_RING_BUFFER_SIZE & (LATENCY_TRACE_RING_BUFFER_SIZE - 1)) == 0,
+              "The latency trace ring buffer size must be a power of 2");
+static_assert((sizeof(_latency_trace_stage_names) / sizeof(_latency_trace_stage_names[0])) == static_cast<uint>(LatencyTraceStage::NUM_STAGES),
+              "A name must be specified for each latency trace stage");
+
+// Private variables
+static LatencyTraceRecord _latency_trace_records[LATENCY_TRACE_RING_BUFFER_SIZE];
+static std::atomic<uint64_t> _latency_trace_write_index{0};
+static std::atomic<uint> _latency_trace_sample_interval{0};
+static std::atomic<uint> _latency_trace_sample_count{0};
+static std::atomic<LatencyTraceId> _latency_trace_next_id{1};
+
+//----------------------------------------------------------------------------
+// SetSampleInterval
+//----------------------------------------------------------------------------
+void LatencyTrace::SetSampleInterval(uint sample_interval)
+{
+    // Set the sample interval - one in every N control changes is traced, or
+    // tracing is disabled if zero
+    _latency_trace_sample_interval = sample_interval;
+    if (sample_interval)
+    {
+        NINA_LOG_INFO(NinaModule::ANY, "Latency tracing enabled, sample interval: {}", sample_interval);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Enabled
+//----------------------------------------------------------------------------
+bool LatencyTrace::Enabled()
+{
+    return _latency_trace_sample_interval > 0;
+}
+
+//----------------------------------------------------------------------------
+// Begin
+//----------------------------------------------------------------------------
+LatencyTraceId LatencyTrace::Begin()
+{
+    // Is tracing enabled, and should this control change be traced?
+    uint sample_interval = _latency_trace_sample_interval;
+    if ((sample_interval == 0) || ((_latency_trace_sample_count++ % sample_interval) != 0))
+        return NO_LATENCY_TRACE_ID;
+
+    // Allocate the trace ID, skipping the invalid ID if it wraps
+    LatencyTraceId trace_id = _latency_trace_next_id++;
+    if (trace_id == NO_LATENCY_TRACE_ID)
+        trace_id = _latency_trace_next_id++;
+    return trace_id;
+}
+
+//----------------------------------------------------------------------------
+// Record
+//----------------------------------------------------------------------------
+void LatencyTrace::Record(LatencyTraceId trace_id, LatencyTraceStage stage)
+{
+    // Record the stage at the current time
+    if (trace_id != NO_LATENCY_TRACE_ID)
+        Record(trace_id, stage, std::chrono::steady_clock::now());
+}
+
+//----------------------------------------------------------------------------
+// Record
+//----------------------------------------------------------------------------
+void LatencyTrace::Record(LatencyTraceId trace_id, LatencyTraceStage stage, std::chrono::steady_clock::time_point time)
+{
+    // Ignore untraced events
+    if (trace_id == NO_LATENCY_TRACE_ID)
+        return;
+
+    // Claim the next record in the ring buffer, overwriting the oldest record
+    uint64_t index = _latency_trace_write_index.fetch_add(1, std::memory_order_relaxed);
+    auto& record = _latency_trace_records[index & (LATENCY_TRACE_RING_BUFFER_SIZE - 1)];
+
+    // Write the record, marking it as being written until complete
+    record.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record.trace_id.store(trace_id, std::memory_order_relaxed);
+    record.stage.store(static_cast<uint32_t>(stage), std::memory_order_relaxed);
+    record.time_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count(), std::memory_order_relaxed);
+    record.seq.store(index + 1, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------
+// Export
+//----------------------------------------------------------------------------
+bool LatencyTrace::Export(const std::string& file_path)
+{
+    std::vector<LatencyTraceEntry> entries;
+    char write_buffer[65536];
+
+    // Take a snapshot of the ring buffer, ignoring any records being written
+    entries.reserve(LATENCY_TRACE_RING_BUFFER_SIZE);
+    for (auto& record : _latency_trace_records)
+    {
+        uint64_t seq = record.seq.load(std::memory_order_acquire);
+        LatencyTraceEntry entry;
+        entry.trace_id = record.trace_id.load(std::memory_order_relaxed);
+        entry.stage = static_cast<LatencyTraceStage>(record.stage.load(std::memory_order_relaxed));
+        entry.time_ns = record.time_ns.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((seq != 0) && (seq == record.seq.load(std::memory_order_relaxed)) && (entry.stage < LatencyTraceStage::NUM_STAGES))
+            entries.push_back(entry);
+    }
+
+    // Sort the entries by trace, and then by time
+    std::sort(entries.begin(), entries.end(), [](const LatencyTraceEntry& a, const LatencyTraceEntry& b) {
+        return (a.trace_id != b.trace_id) ? (a.trace_id < b.trace_id) : (a.time_ns < b.time_ns);
+    });
+
+    // Open the export file
+    FILE *fp = ::fopen(file_path.c_str(), "w");
+    if (fp == nullptr)
+    {
+        NINA_LOG_ERROR(NinaModule::ANY, "An error occurred ({}) writing the file: {}", errno, file_path);
+        return false;
+    }
+
+    // Write the trace events
+    // Each stage of a trace is written as a complete event lasting until the next
+    // stage, and the last stage as an instant event - each trace is shown as a
+    // separate thread
+    rapidjson::FileWriteStream os(fp, write_buffer, sizeof(write_buffer));
+    rapidjson::Writer<rapidjson::FileWriteStream> writer(os);
+    writer.StartObject();
+    writer.Key("displayTimeUnit");
+    writer.String("ms");
+    writer.Key("traceEvents");
+    writer.StartArray();
+    for (uint i=0; i<entries.size(); i++)
+    {
+        auto& entry = entries[i];
+        bool last_stage = ((i + 1) == entries.size()) || (entries[i + 1].trace_id != entry.trace_id);
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(_latency_trace_stage_names[static_cast<uint>(entry.stage)]);
+        writer.Key("cat");
+        writer.String(LATENCY_TRACE_CATEGORY);
+        writer.Key("ph");
+        writer.String(last_stage ? "i" : "X");
+        writer.Key("ts");
+        writer.Double(entry.time_ns / 1000.0);
+        if (last_stage)
+        {
+            writer.Key("s");
+            writer.String("t");
+        }
+        else
+        {
+            writer.Key("dur");
+            writer.Double((entries[i + 1].time_ns - entry.time_ns) / 1000.0);
+        }
+        writer.Key("pid");
+        writer.Uint(1);
+        writer.Key("tid");
+        writer.Uint(entry.trace_id);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    os.Flush();
+    fclose(fp);
+    NINA_LOG_INFO(NinaModule::ANY, "Latency trace exported: {} records", entries.size());
+    return true;
+}
@@ -0,0 +1,56 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  latency_trace.h
+ * @brief Latency Trace class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _LATENCY_TRACE_H
+#define _LATENCY_TRACE_H
+
+#include <string>
+#include <chrono>
+#include "common.h"
+
+// Latency trace constants
+constexpr uint LATENCY_TRACE_RING_BUFFER_SIZE = 8192;
+constexpr char LATENCY_TRACE_FILE[] = "latency_trace.json";
+
+// Latency trace ID - zero if the event is not traced
+typedef uint32_t LatencyTraceId;
+constexpr LatencyTraceId NO_LATENCY_TRACE_ID = 0;
+
+// Latency trace stages
+// The stages a traced control change passes through, in order
+enum class LatencyTraceStage : uint32_t
+{
+    KNOB_READ,
+    KNOB_DETECTED,
+    EVENT_ROUTED,
+    DAW_RECEIVED,
+    SUSHI_WRITE,
+    SUSHI_ECHO,
+    GUI_RECEIVED,
+    GUI_MQ_POST,
+    NUM_STAGES
+};
+
+// Latency Trace class
+// When enabled, a sampled subset of physical control changes are given a trace
+// ID, which is passed with the resulting param change events - the time each
+// stage is reached is recorded in a lock-free ring buffer, which can be exported
+// as a Chrome trace (Perfetto) JSON file
+class LatencyTrace
+{
+public:
+    // Public functions
+    static void SetSampleInterval(uint sample_interval);
+    static bool Enabled();
+    static LatencyTraceId Begin();
+    static void Record(LatencyTraceId trace_id, LatencyTraceStage stage);
+    static void Record(LatencyTraceId trace_id, LatencyTraceStage stage, std::chrono::steady_clock::time_point time);
+    static bool Export(const std::string& file_path);
+};
+
+#endif // _LATENCY_TRACE_H
@@ -9,6 +9,7 @@
 
 #include <assert.h>
 #include "layer_info.h"
+#include "utils.h"
 
 //----------------------------------------------------------------------------
 // LayerInfo
@@ -143,6 +144,7 @@ void LayerInfo::set_midi_channel_filter(uint midi_channel_filter)
 {
     // Set the layer MIDI channel filter
     _midi_channel_filter = midi_channel_filter;
+    utils::midi_channel_config_changed();
 }
 
 //----------------------------------------------------------------------------
@@ -161,6 +163,7 @@ void LayerInfo::set_mpe_mode(MpeMode mode)
 {
     // Set the MPE mode
     _mpe_mode = mode;
+    utils::midi_channel_config_changed();
 }
 
 //----------------------------------------------------------------------------
@@ -10,6 +10,8 @@
 #include <unistd.h>
 #include "arpeggiator_manager.h"
 #include "daw_manager.h"
+#include "clock_engine.h"
+#include "scheduled_note_queue.h"
 #include "utils.h"
 
 // Constants
@@ -23,7 +25,6 @@ constexpr char HOLD_PARAM_NAME[]       = "hold";
 constexpr char RUN_NAME[]              = "Run";
 constexpr char RUN_PARAM_NAME[]        = "run";
 constexpr uint HOLD_TIMEOUT            = 1000;
-constexpr uint MAX_ARP_NOTES		   = 100;
 
 //----------------------------------------------------------------------------
 // ArpeggiatorManager
@@ -43,15 +44,13 @@ ArpeggiatorManager::ArpeggiatorManager(EventRouter *event_router) :
     _tempo_pulse_count = utils::tempo_pulse_count(TempoNoteValue::QUARTER);
     _note_duration_pulse_count = _tempo_pulse_count >> 1;
     _pulse_count = 0;
+    _schedule_tick = 0;
     _enable = false;
     _hold = false;
     _dir_mode = ArpDirMode::UP;
-    _updown_dir_mode = ArpDirMode::UP;
     _started = false;
     _prev_enable = false;
     _arp_state = ArpState::DISABLED;
-    _arp_notes.reserve(MAX_ARP_NOTES);
-    _step = 0;
     _hold_timeout = true;
     _midi_clk_in = false;
 
@@ -60,6 +59,7 @@ ArpeggiatorManager::ArpeggiatorManager(EventRouter *event_router) :
 
     // Seed the random number generator
     std::srand(std::time(nullptr));    
+    _arp_engine.seed(std::rand());
 }
 
 //----------------------------------------------------------------------------
@@ -172,10 +172,36 @@ void ArpeggiatorManager::process_event(const BaseEvent *event)
 //----------------------------------------------------------------------------
 void ArpeggiatorManager::process_midi_event_direct(const snd_seq_event_t *event)
 {
-    auto data = *event;
-
     // Get the Arpeggiator mutex
-    std::unique_lock<std::mutex> lock(utils::arp_mutex());
+    std::lock_guard<std::mutex> lock(utils::arp_mutex());
+
+    // Process any Sequencer notes received before this note, and then the note
+    _process_due_notes();
+    _process_note(*event);
+}
+
+//----------------------------------------------------------------------------
+// _process_due_notes
+// Note: The Arpeggiator mutex must be held by the caller
+//----------------------------------------------------------------------------
+void ArpeggiatorManager::_process_due_notes()
+{
+    snd_seq_event_t note;
+
+    // Process the Sequencer notes due, in order
+    while (ScheduledNoteQueue::Receive(ScheduledNoteSource::SEQUENCER, note))
+    {
+        _process_note(note);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _process_note
+// Note: The Arpeggiator mutex must be held by the caller
+//----------------------------------------------------------------------------
+void ArpeggiatorManager::_process_note(const snd_seq_event_t &note)
+{
+    auto data = note;
 
     // If the note channel doesn't match layer 1 filter, then pass it on
     if (!utils::get_layer_info(0).check_midi_channel_filter(data.data.note.channel)) {
@@ -201,7 +227,7 @@ void ArpeggiatorManager::process_midi_event_direct(const snd_seq_event_t *event)
             }
             else
             {
-                _remove_arp_note(data);
+                _arp_engine.remove(data.data.note.note);
             }
         }
     }
@@ -213,23 +239,14 @@ void ArpeggiatorManager::process_midi_event_direct(const snd_seq_event_t *event)
             (data.type == snd_seq_event_type::SND_SEQ_EVENT_NOTEON && data.data.note.velocity == 0))
         {
            //erase notes that arn't held anymore. then reevalute hold reset.  
-            for (auto i = _held_notes.begin(); i < _held_notes.end(); i++)
-            {
-                // Does this note match the passed note?
-                if (data.data.note.note == i->data.note.note)
-                {
-                    // Matches - remove it
-                    _held_notes.erase(i);
-
-                }
-            }
-            _hold_reset = _held_notes.size() ==0;
+            _held_notes.reset(data.data.note.note);
+            _hold_reset = _held_notes.empty();
 
             // Are we in hold mode? If so, don't remove the notes from the Arpeggiator notes array
             if (!_hold)
             {
                 // Try to remove the note from the array of Arpeggiator notes
-                if (!_remove_arp_note(data))
+                if (!_arp_engine.remove(data.data.note.note))
                 {
                     // If it can't be removed (isn't known) then just forward to the DAW
                     // We do this as it could be a note-off from a keypress before the Arpeggiator
@@ -238,7 +255,7 @@ void ArpeggiatorManager::process_midi_event_direct(const snd_seq_event_t *event)
                 }
 
                 // If there are no more notes left to play
-                if (_arp_notes.size() == 0) {
+                if (_arp_engine.empty()) {
                     // Process the FSM immediately (don't reset the pulse count)
                     _process_fsm_async_event(false);
                 }           
@@ -246,7 +263,7 @@ void ArpeggiatorManager::process_midi_event_direct(const snd_seq_event_t *event)
             else
             {
                 // In hold mode - does the note exist in the array of Arpeggiator notes?
-                if (!_find_arp_note(data))
+                if (!_arp_engine.contains(data.data.note.note))
                 {
                     // If the note isn't known, then just forward to the DAW
                     // We do this as it could be a note-off from a keypress before the Arpeggiator
@@ -258,7 +275,7 @@ void ArpeggiatorManager::process_midi_event_direct(const snd_seq_event_t *event)
         // Is this a note-on?
         else if (data.type == snd_seq_event_type::SND_SEQ_EVENT_NOTEON)
         {
-            _held_notes.push_back(data);
+            _held_notes.set(data.data.note.note);
             // Are we in hold mode?
             if (_hold)
             {
@@ -266,7 +283,7 @@ void ArpeggiatorManager::process_midi_event_direct(const snd_seq_event_t *event)
                 if (_hold_reset)
                 {
                     // Clear the array of Arpeggiator notes
-                    _arp_notes.clear();
+                    _arp_engine.clear();
                 }
             }
 
@@ -283,15 +300,11 @@ void ArpeggiatorManager::process_midi_event_direct(const snd_seq_event_t *event)
             // Are we in hold mode?
             if (_hold)
             {
-                // We need to re-start the hold timer
-                // However, we don't want to do this with the mutex held for performance reasons
-                lock.unlock();
-
                 // Stop the hold timer (if not already stopped), and re-start it
                 _hold_timeout = false;
             }
             //if there is a note on now, then we wont reset hold anymore
-            _hold_reset = _held_notes.size() ==0;
+            _hold_reset = _held_notes.empty();
         }
     }
 }
@@ -302,7 +315,7 @@ void ArpeggiatorManager::process_midi_event_direct(const snd_seq_event_t *event)
 void ArpeggiatorManager::_process_param_changed_event(const ParamChange &data)
 {
     // Get the param
-    const Param *param = utils::get_param(data.path.c_str());
+    const Param *param = utils::get_param_from_handle(data.handle);
     if (param) {
         // Get the mutex lock
         std::lock_guard<std::mutex> lk(utils::arp_mutex());
@@ -384,6 +397,7 @@ void ArpeggiatorManager::_process_param_value(const Param &param, float value, u
                     if (mode != _dir_mode)
                     {
                         _dir_mode = mode;
+                        _arp_engine.set_dir_mode(mode);
                     }
                 }
             }
@@ -405,7 +419,7 @@ void ArpeggiatorManager::_process_param_value(const Param &param, float value, u
 
                 // If we are coming out of hold mode, clear all Arpeggiator notes in the array
                 if (prev_hold && !_hold)
-                    _arp_notes.clear();
+                    _arp_engine.clear();
                 else
                     _hold_timeout = false;
             }
@@ -428,7 +442,7 @@ void ArpeggiatorManager::_process_param_value(const Param &param, float value, u
     else if ((param.get_path() == utils::get_param_from_ref(utils::ParamRef::ALL_NOTES_OFF)->get_path()) &&
              ((layers_mask & LayerInfo::GetLayerMaskBit(0)) == LayerInfo::GetLayerMaskBit(0))) {
         // Clear all Arpeggiator notes (this effectively will stop the Arpeggiator)
-        _arp_notes.clear();
+        _arp_engine.clear();
     }
 }
 
@@ -437,6 +451,8 @@ void ArpeggiatorManager::_process_param_value(const Param &param, float value, u
 //----------------------------------------------------------------------------
 void ArpeggiatorManager::_process_fsm_tempo_event()
 {
+    uint64_t tick_count = ClockEngine::TickCount();
+
 	// Do forever until stopped
 	while (true) {
         // Get the mutex lock
@@ -447,14 +463,29 @@ void ArpeggiatorManager::_process_fsm_tempo_event()
 
         // If the FSM is running
         if (_fsm_running) {
-            // Has the required number of tempo pulses reached?
-            if (++_pulse_count >= _note_duration_pulse_count) {
-                // Process the FSM
+            // Process any Sequencer notes due since the last wake, before processing the
+            // FSM
+            _process_due_notes();
+
+            // Count the clock ticks since the last wake - this includes any ticks signalled
+            // while the FSM was being processed, and excludes any wakes that were not ticks
+            uint64_t ticks = ClockEngine::TickCount();
+            _pulse_count += ticks - tick_count;
+            tick_count = ticks;
+
+            // Has the required number of tempo pulses reached within the lookahead?
+            int note_duration_pulse_count = _note_duration_pulse_count;
+            if ((_pulse_count + (int)SCHEDULED_NOTE_LOOKAHEAD_TICKS) >= note_duration_pulse_count) {
+                // Process the FSM, scheduling the notes sent for the tick they are due
+                _schedule_tick = (_pulse_count < note_duration_pulse_count) ?
+                                    (ticks + (note_duration_pulse_count - _pulse_count)) : 0;
                 _process_fsm();
+                _schedule_tick = 0;
 
-                // Set the next note duration pulse count to check
+                // Set the next note duration pulse count to check, counting from the tick the
+                // notes are due
                 _note_duration_pulse_count = _tempo_pulse_count - _note_duration_pulse_count;
-                _pulse_count = 0;
+                _pulse_count -= note_duration_pulse_count;
             }
         }
         else {
@@ -541,7 +572,7 @@ void ArpeggiatorManager::_process_fsm()
             }
 
             // Clear the Arpeggiator array of notes
-            _arp_notes.clear();
+            _arp_engine.clear();
         }
         break;
 
@@ -549,10 +580,10 @@ void ArpeggiatorManager::_process_fsm()
         // In this state, the Arpeggiator is enabled, and waiting for the first note to be
         // received
         // Are there any notes to play?
-        if (_arp_notes.size() > 0)
+        if (!_arp_engine.empty())
         {
-            // Reset the Up/Down Direction Mode direction
-            _updown_dir_mode = ArpDirMode::UP;
+            // Start from the beginning of the play order
+            _arp_engine.reset();
 
             // Get the next Arpeggiator note to play and play it
             _send_arp_note();
@@ -568,7 +599,7 @@ void ArpeggiatorManager::_process_fsm()
         _stop_arp_note();
 
         // If there are notes to play
-        if (_arp_notes.size() > 0){
+        if (!_arp_engine.empty()){
             // Change the state to indicate we are now playing a note-on
             _arp_state = ArpState::PLAYING_NOTEOFF;
         }
@@ -583,7 +614,7 @@ void ArpeggiatorManager::_process_fsm()
         // In this state, we have just played a note-off, and now need to
         // play the next note
         // First check there are notes to play
-        if (_arp_notes.size() > 0)
+        if (!_arp_engine.empty())
         {
             // Get the next Arpeggiator note to play and play it
             _send_arp_note();
@@ -605,192 +636,12 @@ void ArpeggiatorManager::_process_fsm()
 //----------------------------------------------------------------------------
 snd_seq_event_t ArpeggiatorManager::_get_next_arp_note()
 {
-    ArpDirMode dir_mode = _dir_mode;
-
-    // If there is only one note in the notes array, just return that
-    if (_arp_notes.size() == 1)
-    {
-        return _arp_notes.at(0);
-    }
-
-    // More than one note - parse the direction mode
-    // Up/Down Direction Mode?
-    if (dir_mode == ArpDirMode::UPDOWN)
-    {
-        // Check the current Up/Down direction
-        if (_updown_dir_mode == ArpDirMode::UP)
-        {
-            // Process in UP mode
-            dir_mode = ArpDirMode::UP;
-        }
-        else
-        {
-            // Process in DOWN mode
-            dir_mode = ArpDirMode::DOWN;
-        }
-    }
-
-    // Assigned Direction Mode?
-    if (dir_mode == ArpDirMode::ASSIGNED)
-    {
-        // This mode gets the notes in the order they were added into the list
-        // Increment the step for the next note, and check for wrap-around
-        _step++;
-        if (_step >= _arp_notes.size())
-        {
-            // Wrap-around the step to the start of the notes array
-            _step = 0;
-        }
-
-        // Return the next note to play
-        return _arp_notes.at(_step);
-    }
-
-    // Up Direction Mode?
-    if (dir_mode == ArpDirMode::UP)
-    {
-        // This mode gets the notes in sequence from pitch low to high
-        snd_seq_event_t note_out;
-        bool note_out_set = false;
-        snd_seq_event_t lowest_note = _arp_notes.at(0);
-
-        // We need to search for the next highest pitch note to play, if any
-        // If there is no next highest pitch note, we return to the lowest
-        // pitch note to play
-        for (snd_seq_event_t note : _arp_notes)
-        {
-            // Is this note higher in pitch than the previously played note?
-            if (note.data.note.note > _note_on.data.note.note)
-            {
-                // Has either a note out candidate not been set, or if set is this
-                // note less than the current candidate for note out?
-                if (!note_out_set || (note.data.note.note < note_out.data.note.note))  
-                {
-                    // This note is a candidate for the next note to play
-                    note_out = note;
-                    note_out_set = true;
-                }
-            }
-
-            // We also need to save the lowest pitch note so that we can send this if there
-            // is no higher pitch note to send
-            if (note.data.note.note < lowest_note.data.note.note)
-            {
-                // This note is a candidate for the lowest pitch note
-                lowest_note = note;
-            }
-        }
-
-        // Was the next highest pitch note found? If so, return it
-        if (note_out_set)
-        {
-            // Save the previous note for Up/Down Direction processing
-            _prev_note_on = _note_on;
-            return note_out;
-        }
-
-        // The next highest pitch note was not found
-        // If we are really in UP Direction Mode, return the lowest note to wrap-around
-        if (_dir_mode == ArpDirMode::UP)
-            return lowest_note;
-
-        // If we get here we must be in Up/Down Direction Mode, currently going UP, and
-        // the highest pitch note has been played
-        // In this case, we play the *previous note*, which will be the next lowest note,
-        // and switch the Up/Down Mode to DOWN
-        _updown_dir_mode = ArpDirMode::DOWN;
-        note_out = _prev_note_on;
-        _prev_note_on = _note_on;
-        return note_out;
-    }
-    
-    // Down Direction Mode?
-    if (dir_mode == ArpDirMode::DOWN)
-    {
-        // This mode gets the notes in sequence from pitch high to low
-        snd_seq_event_t note_out;
-        bool note_out_set = false;
-        snd_seq_event_t highest_note = _arp_notes.at(0);
-
-        // We need to search for the next lowest pitch note to play, if any
-        // If there is no next lowest pitch note, we return to the highest
-        // pitch note to play
-        for (snd_seq_event_t note : _arp_notes)
-        {
-            // Is this note lower in pitch than the previously played note? 
-            if (note.data.note.note < _note_on.data.note.note)
-            {
-                // Has either a note out candidate not been set, or if set is this
-                // note greater than the current candidate for note out?
-                if (!note_out_set || (note.data.note.note > note_out.data.note.note))  
-                {
-                    // This note is a candidate for the next note to play
-                    note_out = note;
-                    note_out_set = true;
-                }
-            }
-
-            // We also need to save the highest pitch note so that we can send this if there
-            // is no lower pitch note to send
-            if (note.data.note.note > highest_note.data.note.note)
-            {
-                // This note is a candidate for the highest pitch note
-                highest_note = note;
-            }
-        }
-
-        // Was the next lowest pitch note found? If so, return it
-        if (note_out_set)
-        {
-            // Save the previous note for Up/Down Direction processing
-            _prev_note_on = _note_on;
-            return note_out;
-        }
-        
-        // The next lowest pitch note was not found
-        // If we are really in DOWN Direction Mode, return the highest note to wrap-around
-        if (_dir_mode == ArpDirMode::DOWN)
-            return highest_note;
-
-        // If we get here we must be in Up/Down Direction Mode, currently going DOWN, and
-        // the lowest pitch note has been played
-        // In this case, we play the *previous note*, which will be the next highest note,
-        // and switch the Up/Down Mode to UP
-        _updown_dir_mode = ArpDirMode::UP;
-        note_out = _prev_note_on;
-        _prev_note_on = _note_on;
-        return note_out;
-    }
-
-    // If we get here, the Direction Mode must be random
-    _step++;
-
-    // If we have gone though all the notes, then reshuffle the array and start from note 0
-    if (_step >= _arp_notes.size())
-    {
-        _arp_notes_shuffle.clear();
-        _arp_notes_shuffle.reserve(_arp_notes.size());
-        for(uint i = 0; i < _arp_notes.size(); i++)
-        {
-            _arp_notes_shuffle.push_back(i);
-        }
-        std::shuffle(_arp_notes_shuffle.begin(), _arp_notes_shuffle.end(), std::default_random_engine(std::rand()));
-        _step = 0;
-    }
-    
-    // If the size of the arp notes array has changed, then we have to also change the shuffle array, could consider 
-    // nicer behaviour here, rather than just reshuffling the whole array
-    if(_arp_notes.size() != _arp_notes_shuffle.size())
-    {
-        _arp_notes_shuffle.clear();
-        for(uint i = 0; i < _arp_notes.size(); i++)
-        {
-            _arp_notes_shuffle.push_back(i);
-        }
-        std::shuffle(_arp_notes_shuffle.begin(), _arp_notes_shuffle.end(), std::default_random_engine(std::rand()));
-        _step = 0;
-    }
-    return _arp_notes.at(_arp_notes_shuffle.at(_step));
+    // Get the next note in the Arpeggiator play order
+    auto note = _arp_engine.next();
+    snd_seq_event_t note_on;
+    snd_seq_ev_clear(&note_on);
+    snd_seq_ev_set_noteon(&note_on, note.channel, note.note, note.velocity);
+    return note_on;
 }
 
 //----------------------------------------------------------------------------
@@ -798,51 +649,8 @@ snd_seq_event_t ArpeggiatorManager::_get_next_arp_note()
 //----------------------------------------------------------------------------
 void ArpeggiatorManager::_add_arp_note(const snd_seq_event_t &note)
 {
-    // Make sure the capacity is not exceeded
-    if (_arp_notes.size() < MAX_ARP_NOTES)
-    {
-        // Add the note
-        _arp_notes.push_back(note);
-    }
-}
-
-//----------------------------------------------------------------------------
-// _find_arp_note
-//----------------------------------------------------------------------------
-bool ArpeggiatorManager::_find_arp_note(const snd_seq_event_t &note)
-{
-    // Find the note in the Arpeggiator notes array list which matches the one to remove
-    for (auto i = _arp_notes.begin(); i < _arp_notes.end(); i++)
-    {
-        // Does this note match the passed note?
-        if (note.data.note.note == i->data.note.note)
-        {
-            // Note found
-            return true;
-        }
-    }
-    return false;
-}
-
-//----------------------------------------------------------------------------
-// _remove_arp_note
-//----------------------------------------------------------------------------
-bool ArpeggiatorManager::_remove_arp_note(const snd_seq_event_t &note)
-{
-    // Find the note in the Arpeggiator notes array list which matches the one to remove
-
-    for (auto i = _arp_notes.begin(); i < _arp_notes.end(); i++)
-    {
-        // Does this note match the passed note?
-        if (note.data.note.note == i->data.note.note)
-        {
-            // Matches - remove it
-            _arp_notes.erase(i);
-            return true;
-
-        }
-    }
-    return false;
+    // Add the note - if the capacity is exceeded, the note is ignored
+    _arp_engine.add({note.data.note.note, note.data.note.velocity, note.data.note.channel});
 }
 
 //----------------------------------------------------------------------------
@@ -874,12 +682,14 @@ void ArpeggiatorManager::_stop_arp_note()
 void ArpeggiatorManager::_stop_arp_notes()
 {
     // If there are played arp notes
-    if (_arp_notes.size() > 0) {
+    if (!_arp_engine.empty()) {
         // Play each note-off
-        for (uint i=0; i<_arp_notes.size(); i++) {
-            auto note_off = _arp_notes[i];
-            note_off.type = snd_seq_event_type::SND_SEQ_EVENT_NOTEOFF;
-            note_off.data.note.velocity = 0;
+        std::vector<ArpNote> notes;
+        _arp_engine.get_notes(notes);
+        for (const ArpNote &note : notes) {
+            snd_seq_event_t note_off;
+            snd_seq_ev_clear(&note_off);
+            snd_seq_ev_set_noteoff(&note_off, note.channel, note.note, 0);
             _send_note(note_off);
         }
     }
@@ -890,8 +700,9 @@ void ArpeggiatorManager::_stop_arp_notes()
 //----------------------------------------------------------------------------
 void ArpeggiatorManager::_send_note(const snd_seq_event_t &note)
 {
-    // Send the note directly to the DAW
-    utils::get_manager(NinaModule::DAW)->process_midi_event_direct(&note);
+    // Send the note to the DAW, either now or scheduled for the tick it is due if being
+    // sent ahead by the FSM
+    ScheduledNoteQueue::Send(ScheduledNoteSource::ARPEGGIATOR, _schedule_tick, note);
 }
 
 //----------------------------------------------------------------------------
@@ -21,6 +21,7 @@
 #include "utils.h"
 #include "layer_info.h"
 #include "timer.h"
+#include "arp_engine.h"
 
 // Arpeggiator Param IDs
 enum ArpeggiatorParamId : int
@@ -32,17 +33,6 @@ enum ArpeggiatorParamId : int
     ARP_RUN_PARAM_ID
 };
 
-// Arpeggiator Direction Mode
-enum ArpDirMode : int
-{
-    UP = 0,
-    DOWN,
-    UPDOWN,
-    RANDOM,
-    ASSIGNED,
-    NUM_DIR_MODES
-};
-
 // Arpeggiator State
 enum class ArpState
 {
@@ -80,21 +70,18 @@ private:
     bool _fsm_running;
     uint _tempo_pulse_count;
     uint _note_duration_pulse_count;
-    uint _pulse_count;
+    int _pulse_count;
+    uint64_t _schedule_tick;
     std::atomic<bool> _enable;
     std::atomic<bool> _hold;
     std::atomic<ArpDirMode> _dir_mode;
-    ArpDirMode _updown_dir_mode;
     std::atomic<bool> _started;
     bool _prev_enable;
     bool _prev_started;
     ArpState _arp_state;
-    std::vector<snd_seq_event_t> _arp_notes;
-    std::vector<snd_seq_event_t> _held_notes;
-    std::vector<uint> _arp_notes_shuffle;
+    ArpEngine _arp_engine;
+    ArpNoteSet _held_notes;
     snd_seq_event_t _note_on;
-    snd_seq_event_t _prev_note_on;
-    uint _step;
     bool _hold_timeout;
     bool _hold_reset  = true;
     bool _midi_clk_in;
@@ -106,10 +93,10 @@ private:
     void _process_fsm_tempo_event();
     void _process_fsm_async_event(bool reset);
     void _process_fsm();
+    void _process_due_notes();
+    void _process_note(const snd_seq_event_t &note);
     snd_seq_event_t _get_next_arp_note();
     void _add_arp_note(const snd_seq_event_t &note);
-    bool _find_arp_note(const snd_seq_event_t &note);
-    bool _remove_arp_note(const snd_seq_event_t &note);
     void _send_arp_note();
     void _stop_arp_note();
     void _stop_arp_notes();
@@ -7,35 +7,72 @@
  *-----------------------------------------------------------------------------
  */
 #include <iostream>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #include "base_manager.h"
 #include "utils.h"
-
-// Base Message Type
-enum class BaseMsgType
-{
-    POST_EVENT,
-    EXIT_THREAD
+#include "logger.h"
+
+// Lock-free mailbox constants
+constexpr uint MAILBOX_NUM_SLOTS = 1024;    // Must be a power of 2
+constexpr uint MAILBOX_SLOT_MASK = (MAILBOX_NUM_SLOTS - 1);
+constexpr uint MAILBOX_MAX_BATCH_SIZE = 64;
+
+// Event type names (for logging)
+constexpr const char *EVENT_TYPE_NAMES[NUM_EVENT_TYPES] = {
+    "MIDI",
+    "PARAM_CHANGED",
+    "SYSTEM_FUNC",
+    "RELOAD_PRESETS",
+    "SURFACE_CONTROL_FUNC"
 };
 
-// Base message
-struct BaseManagerMsg
+// Lock-free MPSC mailbox
+// This is a bounded queue of pre-allocated slots, where each slot has a
+// sequence number used to pass ownership of the slot between the producers
+// and the single consumer
+// The consumer blocks on an eventfd when the mailbox is empty, and producers
+// only signal the eventfd if the consumer is waiting
+class MpscMailbox
 {
-    BaseManagerMsg(BaseMsgType a, const BaseEvent *b) 
+public:
+    // Constructor/destructor
+    MpscMailbox();
+    ~MpscMailbox();
+
+    // Public functions
+    bool init();
+    bool push(const BaseManagerMsg& msg);
+    bool pop(BaseManagerMsg& msg);
+    void wait();
+    void wake();
+
+private:
+    struct Slot
     {
-        base_msg_type = a;
-        event = b;
-    }
-    BaseMsgType base_msg_type;
-    const BaseEvent *event;
+        std::atomic<uint> seq;
+        BaseManagerMsg msg;
+    };
+    Slot _slots[MAILBOX_NUM_SLOTS];
+    alignas(64) std::atomic<uint> _head;
+    alignas(64) uint _tail;
+    std::atomic<bool> _waiting;
+    int _event_fd;
+
+    bool _empty() const;
 };
 
 // Static functions
 static void* _rt_process(void* data);
+static inline uint64_t _monotonic_time_ns();
 
 //----------------------------------------------------------------------------
 // BaseManager
 //----------------------------------------------------------------------------
-BaseManager::BaseManager(NinaModule module, const char* thread_name, EventRouter *event_router, bool real_time) : _nrt_thread(0), _THREAD_NAME(thread_name)
+BaseManager::BaseManager(NinaModule module, const char* thread_name, EventRouter *event_router, bool real_time, bool lock_free_mailbox) : _nrt_thread(0), _THREAD_NAME(thread_name)
 {
     // Initialise private data
     _module = module;
@@ -43,6 +80,23 @@ BaseManager::BaseManager(NinaModule module, const char* thread_name, EventRouter
     _nrt_thread = 0;
     _rt_thread = 0;
     _real_time = real_time;
+    _mailbox = nullptr;
+    _msg_queue_head_seq = 0;
+    _ready = false;
+
+    // Should this manager use a lock-free mailbox?
+    if (lock_free_mailbox)
+    {
+        // Create the mailbox
+        _mailbox = new MpscMailbox();
+        if (!_mailbox->init())
+        {
+            // The mailbox could not be created, fall back to the message queue
+            DEBUG_BASEMGR_MSG("Could not create the lock-free mailbox " << errno);
+            delete _mailbox;
+            _mailbox = nullptr;
+        }
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -52,6 +106,11 @@ BaseManager::~BaseManager()
 {
     // Make sure any threads are tidied up
     stop();
+
+    // Delete any messages still pending and the mailbox (if any)
+    _clear_msgs();
+    if (_mailbox)
+        delete _mailbox;
 }
 
 //----------------------------------------------------------------------------
@@ -108,15 +167,8 @@ void BaseManager::stop()
     if (!_nrt_thread && !_rt_thread)
         return;
 
-    // Create a new BaseManagerMsg
-    BaseManagerMsg* msg = new BaseManagerMsg(BaseMsgType::EXIT_THREAD, nullptr);
-
     // Put exit thread message into the queue
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _msg_queue.push_back(msg);
-        _cv.notify_one();
-    }
+    _post_msg(BaseManagerMsg(BaseMsgType::EXIT_THREAD, nullptr));
     if (!_real_time)
     {
         if (_nrt_thread->joinable())
@@ -128,6 +180,99 @@ void BaseManager::stop()
     {	
         utils::stop_rt_task(&_rt_thread);
     }
+    _set_ready(false);
+}
+
+//----------------------------------------------------------------------------
+// ready
+//----------------------------------------------------------------------------
+bool BaseManager::ready()
+{
+    // Return if this manager is processing events
+    std::lock_guard<std::mutex> lock(_ready_mutex);
+    return _ready;
+}
+
+//----------------------------------------------------------------------------
+// wait_ready
+//----------------------------------------------------------------------------
+bool BaseManager::wait_ready(std::chrono::milliseconds timeout)
+{
+    // Wait for this manager to be processing events, or the timeout
+    std::unique_lock<std::mutex> lock(_ready_mutex);
+    return _ready_cv.wait_for(lock, timeout, [this]{ return _ready; });
+}
+
+//----------------------------------------------------------------------------
+// num_posted_msgs
+//----------------------------------------------------------------------------
+uint64_t BaseManager::num_posted_msgs() const
+{
+    // Return the number of messages posted to this manager
+    return _num_posted_msgs.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// num_coalesced_msgs
+//----------------------------------------------------------------------------
+uint64_t BaseManager::num_coalesced_msgs() const
+{
+    // Return the number of posted messages merged into an already queued message
+    return _num_coalesced_msgs.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// peak_queue_depth
+//----------------------------------------------------------------------------
+uint BaseManager::peak_queue_depth() const
+{
+    // Return the peak message queue depth
+    return _peak_queue_depth.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// event_stats
+//----------------------------------------------------------------------------
+const EventStats& BaseManager::event_stats(EventType type) const
+{
+    // Return the event stats for this event type
+    return _event_stats[static_cast<uint>(type)];
+}
+
+//----------------------------------------------------------------------------
+// log_event_stats
+//----------------------------------------------------------------------------
+void BaseManager::log_event_stats(bool reset)
+{
+    // Log the stats for each event type processed
+    for (uint i=0; i<NUM_EVENT_TYPES; i++)
+    {
+        auto& wait = _event_stats[i].queue_wait;
+        auto& proc = _event_stats[i].process_time;
+        if (wait.count() > 0)
+        {
+            NINA_LOG_INFO(module(), "{}: {} events, queue wait (us) mean {} p50 {} p99 {} max {}, process (us) mean {} p50 {} p99 {} max {}",
+                          EVENT_TYPE_NAMES[i], wait.count(),
+                          wait.mean_us(), wait.percentile_us(50.0f), wait.percentile_us(99.0f), wait.max_us(),
+                          proc.mean_us(), proc.percentile_us(50.0f), proc.percentile_us(99.0f), proc.max_us());
+        }
+        if (reset)
+        {
+            wait.reset();
+            proc.reset();
+        }
+    }
+    NINA_LOG_INFO(module(), "Peak queue depth {}, {} messages posted, {} coalesced",
+                  peak_queue_depth(), num_posted_msgs(), num_coalesced_msgs());
+    if (_mailbox)
+    {
+        NINA_LOG_INFO(module(), "Mailbox full {} times", _num_mailbox_overflows.load(std::memory_order_relaxed));
+    }
+    if (reset)
+    {
+        _peak_queue_depth.store(0, std::memory_order_relaxed);
+        _num_mailbox_overflows.store(0, std::memory_order_relaxed);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -135,47 +280,149 @@ void BaseManager::stop()
 //----------------------------------------------------------------------------
 void BaseManager::post_msg(const BaseEvent *event)
 {
-    BaseManagerMsg* new_msg = new BaseManagerMsg(BaseMsgType::POST_EVENT, event);
-    bool push_msg = true;
+    // Post the event message
+    _post_msg(BaseManagerMsg(BaseMsgType::POST_EVENT, event));
+}
+
+//----------------------------------------------------------------------------
+// Process
+//----------------------------------------------------------------------------
+void BaseManager::process()
+{
+    // The manager is now ready - any listeners were registered by the derived manager
+    // before calling this function
+    _set_ready(true);
+
+    // Process either the lock-free mailbox or the message queue
+    _mailbox ? _process_mailbox() : _process_msg_queue();
+}
+
+//----------------------------------------------------------------------------
+// ProcessEvent
+//----------------------------------------------------------------------------
+void BaseManager::process_event([[maybe_unused]] const BaseEvent *event)
+{
+    // Virtual so always overriden
+}
+
+//----------------------------------------------------------------------------
+// process_midi_event_direct
+//----------------------------------------------------------------------------
+void BaseManager::process_midi_event_direct([[maybe_unused]] const snd_seq_event_t *event)
+{
+    // Overriden as necessary
+}
+
+//----------------------------------------------------------------------------
+// _set_ready
+//----------------------------------------------------------------------------
+void BaseManager::_set_ready(bool ready)
+{
+    // Set the ready state and notify any waiters
+    {
+        std::lock_guard<std::mutex> lock(_ready_mutex);
+        _ready = ready;
+    }
+    _ready_cv.notify_all();
+}
+
+//----------------------------------------------------------------------------
+// _post_msg
+//----------------------------------------------------------------------------
+void BaseManager::_post_msg(const BaseManagerMsg& msg)
+{
+    // Is this manager using the lock-free mailbox?
+    if (_mailbox)
+    {
+        // Push the message into the mailbox, unless it has overflowed
+        if (!_mailbox_overflowed && _mailbox->push(msg))
+            return;
+
+        // The mailbox is full (or has overflowed), so add the message to the overflow
+        // queue rather than waiting for the worker thread to make space
+        // Note: Once the mailbox has overflowed, messages are added to the overflow
+        // queue until the worker thread has emptied it, so that they are processed
+        // in the order posted
+        std::lock_guard<std::mutex> lk(_mutex);
+        if (!_mailbox_overflowed && _mailbox->push(msg))
+            return;
+        if (!_mailbox_overflowed)
+        {
+            _num_mailbox_overflows.fetch_add(1, std::memory_order_relaxed);
+            _mailbox_overflowed = true;
+        }
+        _mailbox_overflow.push_back(msg);
+        _mailbox->wake();
+        return;
+    }
+
+    // Add the message to the queue and notify the worker thread
+    std::lock_guard<std::mutex> lk(_mutex);
+    _queue_msg(msg);
+    _cv.notify_one();
+}
+
+//----------------------------------------------------------------------------
+// _queue_msg
+//----------------------------------------------------------------------------
+void BaseManager::_queue_msg(const BaseManagerMsg& msg)
+{
+    // Count the posted event messages
+    if (msg.base_msg_type == BaseMsgType::POST_EVENT)
+        _num_posted_msgs.fetch_add(1, std::memory_order_relaxed);
+
+    // Is this a param change event?
+    // If so then we don't want to spam the queue with lots of param change messages
+    // from the same param (and layers), so if there is already a param change
+    // message queued for this param, overwrite it (last value wins) and don't add
+    // a new one
+    // Note: Param changes without a handle (unregistered params) are never coalesced,
+    // as they would all have the same key
+    auto event = msg.event;
+    if ((msg.base_msg_type == BaseMsgType::POST_EVENT) && (event->type() == EventType::PARAM_CHANGED) &&
+        (static_cast<const ParamChangedEvent *>(event)->param_change().handle != INVALID_PARAM_HANDLE))
+    {
+        // Is there a param change pending for this param?
+        auto key = _param_change_key(static_cast<const ParamChangedEvent *>(event)->param_change());
+        auto itr = _pending_param_changes.find(key);
+        if ((itr != _pending_param_changes.end()) && (itr->second >= _msg_queue_head_seq))
+        {
+            // Overwrite this event
+            auto& pending_msg = _msg_queue[itr->second - _msg_queue_head_seq];
+            pending_msg.event->release();
+            pending_msg = msg;
+            _num_coalesced_msgs.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // Add the message, and index it so later param changes can be coalesced
+        _pending_param_changes[key] = _msg_queue_head_seq + _msg_queue.size();
+        _msg_queue.push_back(msg);
+        _update_peak_queue_depth();
+        return;
+    }
+
+    // This message cannot be coalesced with param changes already queued, as it must be
+    // processed after them
+    // Clear the pending param changes so that later param changes are queued after
+    // this message
+    if (!_pending_param_changes.empty())
+        _pending_param_changes.clear();
 
     // Firstly get the last event in the queue (if any) and check if it is
     // the same as this event
     // If this is the case then for some events we do not push this event
     // and instead overwrite the last to avoid spamming the event queue
-    std::unique_lock<std::mutex> lk(_mutex);
-    if (!_msg_queue.empty())
+    if (!_msg_queue.empty() && (msg.base_msg_type == BaseMsgType::POST_EVENT) &&
+        (_msg_queue.back().base_msg_type == BaseMsgType::POST_EVENT))
     {
         // Get the last message and check if it is the same
-        auto msg = _msg_queue.back();
-        if (msg->event->type() == event->type())
+        auto& last_msg = _msg_queue.back();
+        if (last_msg.event->type() == event->type())
         {
             // For some events overwrite the last event
             switch (event->type())
             {
-                case EventType::PARAM_CHANGED:
-                {
-                    // We don't want to spam the queue with lots of param change messages from the
-                    // same param
-                    // Reverse iterate the message queue checking for existing param change messages
-                    auto new_pc = static_cast<const ParamChangedEvent *>(event)->param_change();
-                    for (auto itr=_msg_queue.rbegin(); itr != _msg_queue.rend(); ++itr) {
-                        // If this is a param change evert
-                        if ((*itr)->event->type() == EventType::PARAM_CHANGED) {
-                            auto cur_pc = static_cast<const ParamChangedEvent *>((*itr)->event)->param_change();
-
-                            // If this param change matches, overwrite it and don't add a new one
-                            if ((cur_pc.path == new_pc.path) && (cur_pc.layers_mask == new_pc.layers_mask))
-                            {
-                                // Overwrite this event
-                                *itr = new_msg;
-                                push_msg = false;
-                                break;
-                            }
-                        }
-                    }
-                    break;
-                }
-
                 case EventType::SYSTEM_FUNC:
                 {
                     // Nothing to do for now
@@ -190,7 +437,10 @@ void BaseManager::post_msg(const BaseEvent *event)
                     {
                         // Reverse iterate the message queue checking for pending push/pop events
                         for (auto itr=_msg_queue.rbegin(); itr != _msg_queue.rend(); ++itr) {
-                            auto sfc_event = static_cast<const SurfaceControlFuncEvent *>((*itr)->event)->sfc_func();
+                            // If this is not a surface control event then stop processing the queue
+                            if (!itr->event || (itr->event->type() != EventType::SURFACE_CONTROL_FUNC))
+                                break;
+                            auto sfc_event = static_cast<const SurfaceControlFuncEvent *>(itr->event)->sfc_func();
 
                             // If this is not a push/pop event then stop processing the queue
                             if (sfc_event.type != SurfaceControlFuncType::PUSH_POP_CONTROLS_STATE)
@@ -206,8 +456,9 @@ void BaseManager::post_msg(const BaseEvent *event)
 
                 case EventType::RELOAD_PRESETS:
                     // Just overwrite the last event
-                    _msg_queue.back() = new_msg;
-                    push_msg = false;
+                    last_msg.event->release();
+                    last_msg = msg;
+                    _num_coalesced_msgs.fetch_add(1, std::memory_order_relaxed);
                     return;
 
                 default:
@@ -216,86 +467,202 @@ void BaseManager::post_msg(const BaseEvent *event)
         }
     }
 
-    // Add the message if needed and notify the worker thread
-    if (push_msg)
-        _msg_queue.push_back(new_msg);
-    _cv.notify_one();
+    // Add the message
+    _msg_queue.push_back(msg);
+    _update_peak_queue_depth();
 }
 
 //----------------------------------------------------------------------------
-// Process
+// _update_peak_queue_depth
 //----------------------------------------------------------------------------
-void BaseManager::process()
+inline void BaseManager::_update_peak_queue_depth()
+{
+    // Update the peak queue depth if needed
+    // Note: Only ever called with the queue locked or from the manager thread
+    // (mailbox), so there is a single writer
+    uint depth = _msg_queue.size();
+    if (depth > _peak_queue_depth.load(std::memory_order_relaxed))
+        _peak_queue_depth.store(depth, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// _pop_msg
+//----------------------------------------------------------------------------
+BaseManagerMsg BaseManager::_pop_msg()
+{
+    // Get the message at the front of the queue
+    auto msg = _msg_queue.front();
+
+    // If this is an indexed param change, remove it from the pending param changes
+    if ((msg.base_msg_type == BaseMsgType::POST_EVENT) && (msg.event->type() == EventType::PARAM_CHANGED))
+    {
+        auto itr = _pending_param_changes.find(_param_change_key(static_cast<const ParamChangedEvent *>(msg.event)->param_change()));
+        if ((itr != _pending_param_changes.end()) && (itr->second == _msg_queue_head_seq))
+            _pending_param_changes.erase(itr);
+    }
+
+    // Remove the message from the queue
+    _msg_queue.pop_front();
+    _msg_queue_head_seq++;
+    return msg;
+}
+
+//----------------------------------------------------------------------------
+// _param_change_key
+//----------------------------------------------------------------------------
+uint64_t BaseManager::_param_change_key(const ParamChange& param_change) const
+{
+    // The key is the param handle and layers mask
+    return (static_cast<uint64_t>(param_change.handle) << 32) | param_change.layers_mask;
+}
+
+//----------------------------------------------------------------------------
+// _process_msg_queue
+//----------------------------------------------------------------------------
+void BaseManager::_process_msg_queue()
 {
     while (1)
     {
-        BaseManagerMsg* msg = 0;
+        BaseManagerMsg msg;
         {
             // Wait for a message to be added to the queue
             std::unique_lock<std::mutex> lk(_mutex);
             while (_msg_queue.empty())
                 _cv.wait(lk);
 
-            if (_msg_queue.empty())
-                continue;
-
-            msg = _msg_queue.front();
-            _msg_queue.pop_front();
+            msg = _pop_msg();
         }
 
-        // Parse the Base Message Type
-        switch (msg->base_msg_type)
+        // Process the message, and exit the thread if requested
+        if (!_process_msg(msg))
         {
-            case BaseMsgType::POST_EVENT:
-            {
-                // Process the event
-                process_event(msg->event);
+            // Delete any remaining messages
+            std::unique_lock<std::mutex> lk(_mutex);
+            _clear_msgs();
+            return;
+        }
+    }
+}
 
-                // Delete dynamic data passed through message queue
-                if (msg->event)
-                    delete msg->event;
-                delete msg;
-                break;
-            }
+//----------------------------------------------------------------------------
+// _process_mailbox
+//----------------------------------------------------------------------------
+void BaseManager::_process_mailbox()
+{
+    while (1)
+    {
+        // Move any pending messages from the mailbox into the message queue
+        // Note: The message queue is only accessed by this thread when using
+        // the mailbox, so no lock is needed, and messages are still coalesced
+        // as they are added to the queue
+        BaseManagerMsg msg;
+        while ((_msg_queue.size() < MAILBOX_MAX_BATCH_SIZE) && _mailbox->pop(msg))
+            _queue_msg(msg);
+
+        // If the mailbox has overflowed and is now empty, move the overflowed messages
+        // into the message queue - these were posted after the messages in the mailbox
+        if (_mailbox_overflowed && (_msg_queue.size() < MAILBOX_MAX_BATCH_SIZE))
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            while (_mailbox->pop(msg))
+                _queue_msg(msg);
+            for (auto& overflow_msg : _mailbox_overflow)
+                _queue_msg(overflow_msg);
+            _mailbox_overflow.clear();
+            _mailbox_overflowed = false;
+        }
 
-            case BaseMsgType::EXIT_THREAD:
-            {
-                if (msg->event)
-                    delete msg->event;
-                delete msg;
-                std::unique_lock<std::mutex> lk(_mutex);
-                while (!_msg_queue.empty())
-                {
-                    msg = _msg_queue.front();
-                    _msg_queue.pop_front();
-                    if (msg->event)
-                        delete msg->event;					
-                    delete msg;
-                }
-                return;
-            }
+        // If there are no messages, wait for a message to be posted
+        if (_msg_queue.empty())
+        {
+            _mailbox->wait();
+            continue;
+        }
+        msg = _pop_msg();
 
-            default:
-                DEBUG_BASEMGR_MSG("Unknown message");
-                //ASSERT();
+        // Process the message, and exit the thread if requested
+        if (!_process_msg(msg))
+        {
+            // Delete any remaining messages
+            _clear_msgs();
+            return;
         }
     }
 }
 
 //----------------------------------------------------------------------------
-// ProcessEvent
+// _process_msg
 //----------------------------------------------------------------------------
-void BaseManager::process_event([[maybe_unused]] const BaseEvent *event)
+bool BaseManager::_process_msg(const BaseManagerMsg& msg)
 {
-    // Virtual so always overriden
+    // Parse the Base Message Type
+    switch (msg.base_msg_type)
+    {
+        case BaseMsgType::POST_EVENT:
+        {
+            // Process the event, and record how long it waited before processing and
+            // how long it took to process
+            auto& stats = _event_stats[static_cast<uint>(msg.event->type())];
+            uint64_t start = _monotonic_time_ns();
+            process_event(msg.event);
+            uint64_t end = _monotonic_time_ns();
+            stats.queue_wait.record((start > msg.event->timestamp()) ? ((start - msg.event->timestamp()) / 1000) : 0);
+            stats.process_time.record((end - start) / 1000);
+
+            // Release the event passed through the message queue
+            if (msg.event)
+                msg.event->release();
+            break;
+        }
+
+        case BaseMsgType::EXIT_THREAD:
+        {
+            // Exit the thread
+            if (msg.event)
+                msg.event->release();
+            return false;
+        }
+
+        default:
+            DEBUG_BASEMGR_MSG("Unknown message");
+            //ASSERT();
+    }
+    return true;
 }
 
 //----------------------------------------------------------------------------
-// process_midi_event_direct
+// _clear_msgs
 //----------------------------------------------------------------------------
-void BaseManager::process_midi_event_direct([[maybe_unused]] const snd_seq_event_t *event)
+void BaseManager::_clear_msgs()
 {
-    // Overriden as necessary
+    // Delete any messages in the message queue
+    for (auto& msg : _msg_queue)
+    {
+        if (msg.event)
+            msg.event->release();
+    }
+    _msg_queue.clear();
+    _pending_param_changes.clear();
+
+    // Delete any messages in the mailbox (if any), and any messages that overflowed
+    // the mailbox
+    if (_mailbox)
+    {
+        BaseManagerMsg msg;
+        while (_mailbox->pop(msg))
+        {
+            if (msg.event)
+                msg.event->release();
+        }
+        std::lock_guard<std::mutex> lk(_mutex);
+        for (auto& overflow_msg : _mailbox_overflow)
+        {
+            if (overflow_msg.event)
+                overflow_msg.event->release();
+        }
+        _mailbox_overflow.clear();
+        _mailbox_overflowed = false;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -309,3 +676,246 @@ static void* _rt_process(void* data)
     // To suppress warnings
     return nullptr;
 }
+
+//----------------------------------------------------------------------------
+// _monotonic_time_ns
+//----------------------------------------------------------------------------
+static inline uint64_t _monotonic_time_ns()
+{
+    // Return the monotonic (steady clock) time in nanoseconds
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//----------------------------------------------------------------------------
+// MpscMailbox
+//----------------------------------------------------------------------------
+MpscMailbox::MpscMailbox()
+{
+    // Initialise the slots, each slot sequence number is its index
+    for (uint i=0; i<MAILBOX_NUM_SLOTS; i++)
+    {
+        _slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+    _head.store(0, std::memory_order_relaxed);
+    _tail = 0;
+    _waiting.store(false);
+    _event_fd = -1;
+}
+
+//----------------------------------------------------------------------------
+// ~MpscMailbox
+//----------------------------------------------------------------------------
+MpscMailbox::~MpscMailbox()
+{
+    // Close the eventfd
+    if (_event_fd >= 0)
+        ::close(_event_fd);
+}
+
+//----------------------------------------------------------------------------
+// init
+//----------------------------------------------------------------------------
+bool MpscMailbox::init()
+{
+    // Create the eventfd used to wake the consumer
+    _event_fd = ::eventfd(0, EFD_CLOEXEC);
+    return _event_fd >= 0;
+}
+
+//----------------------------------------------------------------------------
+// push
+// Note: Can be called from multiple threads
+//----------------------------------------------------------------------------
+bool MpscMailbox::push(const BaseManagerMsg& msg)
+{
+    Slot *slot;
+    uint pos = _head.load(std::memory_order_relaxed);
+
+    // Claim the next free slot
+    while (true)
+    {
+        slot = &_slots[pos & MAILBOX_SLOT_MASK];
+        uint seq = slot->seq.load(std::memory_order_acquire);
+        int diff = static_cast<int>(seq - pos);
+        if (diff == 0)
+        {
+            // The slot is free, try and claim it
+            if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // The mailbox is full
+            return false;
+        }
+        else
+        {
+            // Another producer claimed this slot, try again
+            pos = _head.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Write the message and pass the slot to the consumer
+    slot->msg = msg;
+    slot->seq.store(pos + 1, std::memory_order_release);
+
+    // Wake the consumer if it is waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waiting.exchange(false))
+    {
+        uint64_t val = 1;
+        [[maybe_unused]] auto res = ::write(_event_fd, &val, sizeof(val));
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// pop
+// Note: Must only be called from the consumer thread
+//----------------------------------------------------------------------------
+bool MpscMailbox::pop(BaseManagerMsg& msg)
+{
+    // Is there a message in the next slot?
+    if (_empty())
+        return false;
+
+    // Read the message and pass the slot back to the producers
+    Slot& slot = _slots[_tail & MAILBOX_SLOT_MASK];
+    msg = slot.msg;
+    slot.seq.store(_tail + MAILBOX_NUM_SLOTS, std::memory_order_release);
+    _tail++;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// wait
+// Note: Must only be called from the consumer thread
+//----------------------------------------------------------------------------
+void MpscMailbox::wait()
+{
+    // Indicate the consumer is waiting, and check the mailbox is still empty
+    // before blocking
+    _waiting.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!_empty())
+    {
+        _waiting.store(false);
+        return;
+    }
+
+    // Block until a producer signals the eventfd
+    uint64_t val;
+    [[maybe_unused]] auto res = ::read(_event_fd, &val, sizeof(val));
+}
+
+//----------------------------------------------------------------------------
+// wake
+// Note: Can be called from multiple threads
+//----------------------------------------------------------------------------
+void MpscMailbox::wake()
+{
+    // Signal the eventfd, even if the consumer is not waiting yet, so that its next
+    // wait returns immediately
+    _waiting.store(false);
+    uint64_t val = 1;
+    [[maybe_unused]] auto res = ::write(_event_fd, &val, sizeof(val));
+}
+
+//----------------------------------------------------------------------------
+// _empty
+//----------------------------------------------------------------------------
+bool MpscMailbox::_empty() const
+{
+    // The slot is empty if its sequence number has not been set by a producer
+    uint seq = _slots[_tail & MAILBOX_SLOT_MASK].seq.load(std::memory_order_acquire);
+    return static_cast<int>(seq - (_tail + 1)) < 0;
+}
+
+//----------------------------------------------------------------------------
+// EventLatencyHistogram
+//----------------------------------------------------------------------------
+EventLatencyHistogram::EventLatencyHistogram()
+{
+    // Initialise the histogram
+    reset();
+}
+
+//----------------------------------------------------------------------------
+// record
+//----------------------------------------------------------------------------
+void EventLatencyHistogram::record(uint64_t duration_us)
+{
+    // Get the bucket for this duration
+    // Bucket 0 is < 1us, and bucket N is [2^(N-1), 2^N) us
+    uint bucket = (duration_us == 0) ? 0 : (64 - __builtin_clzll(duration_us));
+    if (bucket >= EVENT_HISTOGRAM_NUM_BUCKETS)
+        bucket = EVENT_HISTOGRAM_NUM_BUCKETS - 1;
+
+    // Update the histogram
+    // Note: The histogram is only updated by the manager thread, so the
+    // max does not need a compare-exchange
+    _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _total_us.fetch_add(duration_us, std::memory_order_relaxed);
+    if (duration_us > _max_us.load(std::memory_order_relaxed))
+        _max_us.store(duration_us, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// reset
+//----------------------------------------------------------------------------
+void EventLatencyHistogram::reset()
+{
+    // Clear the histogram
+    for (auto& b : _buckets)
+    {
+        b.store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _total_us.store(0, std::memory_order_relaxed);
+    _max_us.store(0, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// count
+//----------------------------------------------------------------------------
+uint64_t EventLatencyHistogram::count() const
+{
+    return _count.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// mean_us
+//----------------------------------------------------------------------------
+uint64_t EventLatencyHistogram::mean_us() const
+{
+    auto count = _count.load(std::memory_order_relaxed);
+    return (count > 0) ? (_total_us.load(std::memory_order_relaxed) / count) : 0;
+}
+
+//----------------------------------------------------------------------------
+// max_us
+//----------------------------------------------------------------------------
+uint64_t EventLatencyHistogram::max_us() const
+{
+    return _max_us.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// percentile_us
+//----------------------------------------------------------------------------
+uint64_t EventLatencyHistogram::percentile_us(float percentile) const
+{
+    // Find the bucket containing this percentile, and return the upper bound
+    // of that bucket (limited to the max recorded)
+    auto target = static_cast<uint64_t>(std::ceil((_count.load(std::memory_order_relaxed) * percentile) / 100.0f));
+    auto max = _max_us.load(std::memory_order_relaxed);
+    uint64_t total = 0;
+    for (uint i=0; i<EVENT_HISTOGRAM_NUM_BUCKETS; i++)
+    {
+        total += _buckets[i].load(std::memory_order_relaxed);
+        if ((total > 0) && (total >= target))
+            return std::min(static_cast<uint64_t>(1ULL << i), max);
+    }
+    return max;
+}
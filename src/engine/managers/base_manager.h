@@ -16,19 +16,78 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <unordered_map>
 
 // Debug message MACRO
 #define BASEMGR_MSG(str)        MSG(this->name() << ": " << str)
 #define DEBUG_BASEMGR_MSG(str)  DEBUG_MSG(this->name() << ": " << str)
 
-struct BaseManagerMsg;
+// Base Message Type
+enum class BaseMsgType
+{
+    POST_EVENT,
+    EXIT_THREAD
+};
+
+// Base message
+struct BaseManagerMsg
+{
+    BaseManagerMsg() {}
+    BaseManagerMsg(BaseMsgType a, const BaseEvent *b) 
+    {
+        base_msg_type = a;
+        event = b;
+    }
+    BaseMsgType base_msg_type;
+    const BaseEvent *event;
+};
+
+// Event Latency Histogram
+// Durations are counted in power of 2 microsecond buckets. The histogram is
+// only updated by the manager thread, and can be read from any thread
+constexpr uint EVENT_HISTOGRAM_NUM_BUCKETS = 24;
+class EventLatencyHistogram
+{
+public:
+    // Constructor
+    EventLatencyHistogram();
+
+    // Public functions
+    void record(uint64_t duration_us);
+    void reset();
+    uint64_t count() const;
+    uint64_t mean_us() const;
+    uint64_t max_us() const;
+    uint64_t percentile_us(float percentile) const;
+
+private:
+    // Private variables
+    std::atomic<uint64_t> _buckets[EVENT_HISTOGRAM_NUM_BUCKETS];
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _total_us;
+    std::atomic<uint64_t> _max_us;
+};
+
+// Event Stats
+// The time an event waited in the queue (from creation) and the time taken
+// to process it
+struct EventStats
+{
+    EventLatencyHistogram queue_wait;
+    EventLatencyHistogram process_time;
+};
+
+class MpscMailbox;
 class EventRouter;
 
 class BaseManager
 {
 public:
     // Constructor
-    BaseManager(NinaModule module, const char* thread_name, EventRouter *event_router, bool real_time=false);
+    // Note: If lock_free_mailbox is set, messages are posted to this manager via a
+    // lock-free MPSC mailbox rather than the mutex protected message queue
+    BaseManager(NinaModule module, const char* thread_name, EventRouter *event_router, bool real_time=false, bool lock_free_mailbox=false);
 
     // Destructor
     virtual ~BaseManager();
@@ -40,6 +99,12 @@ public:
     // Called once a program exit to exit the thread
     virtual void stop();
 
+    // Ready state
+    // A manager is ready once its thread is processing events - its listeners have been
+    // registered, so events posted by other managers are not missed
+    bool ready();
+    bool wait_ready(std::chrono::milliseconds timeout);
+
     // Get the module of this manager
     NinaModule module() const;
 
@@ -49,6 +114,16 @@ public:
     // Add a message to thread queue.
     void post_msg(const BaseEvent *event);
 
+    // Message queue counters
+    // Note: Posted messages include those coalesced into an already queued message
+    uint64_t num_posted_msgs() const;
+    uint64_t num_coalesced_msgs() const;
+
+    // Event stats
+    uint peak_queue_depth() const;
+    const EventStats& event_stats(EventType type) const;
+    virtual void log_event_stats(bool reset=true);
+
     // Entry point for the thread
     virtual void process();
     virtual void process_event(const BaseEvent *event);
@@ -62,13 +137,37 @@ protected:
 private:
     std::thread* _nrt_thread;
     pthread_t _rt_thread;
-    std::deque<BaseManagerMsg*> _msg_queue;
+    std::deque<BaseManagerMsg> _msg_queue;
+    uint64_t _msg_queue_head_seq;
+    std::unordered_map<uint64_t, uint64_t> _pending_param_changes;
+    std::atomic<uint64_t> _num_posted_msgs{0};
+    std::atomic<uint64_t> _num_coalesced_msgs{0};
+    std::atomic<uint> _peak_queue_depth{0};
+    EventStats _event_stats[NUM_EVENT_TYPES];
+    MpscMailbox *_mailbox;
+    std::deque<BaseManagerMsg> _mailbox_overflow;
+    std::atomic<bool> _mailbox_overflowed{false};
+    std::atomic<uint64_t> _num_mailbox_overflows{0};
     std::mutex _mutex;
     std::condition_variable _cv;
     std::atomic<bool> _running{false};
+    bool _ready;
+    std::mutex _ready_mutex;
+    std::condition_variable _ready_cv;
     bool _real_time;
     const char* _THREAD_NAME;
     NinaModule _module;
+
+    void _set_ready(bool ready);
+    void _post_msg(const BaseManagerMsg& msg);
+    void _queue_msg(const BaseManagerMsg& msg);
+    BaseManagerMsg _pop_msg();
+    uint64_t _param_change_key(const ParamChange& param_change) const;
+    void _process_msg_queue();
+    void _process_mailbox();
+    bool _process_msg(const BaseManagerMsg& msg);
+    void _clear_msgs();
+    void _update_peak_queue_depth();
 };
 
 #endif  // _BASE_MGR_H
@@ -9,6 +9,12 @@
 #include <iostream>
 #include <unistd.h>
 #include <regex>
+#include <cstring>
+#include <cstdio>
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/filereadstream.h"
+#include "rapidjson/filewritestream.h"
 #include "daw_manager.h"
 #include "sequencer_manager.h"
 #include "sushi_client.h"
@@ -22,12 +28,21 @@ constexpr uint REGISTER_PARAMS_RETRY_COUNT    = 50;
 constexpr uint PARAM_ID_LAYERS_MASK_BIT_SHIFT = 27;
 constexpr uint PARAM_ID_LAYER_NUM_BIT_MASK    = ~0x78000000;
 constexpr char MAIN_TRACK_NAME[]              = "main";
+constexpr char SUSHI_SCHEMA_CACHE_FILE[]      = "sushi_schema_cache.json";
+constexpr uint SUSHI_SCHEMA_CACHE_VERSION     = 1;
+constexpr auto SUSHI_WRITE_TICK               = std::chrono::milliseconds(5);
+constexpr uint SUSHI_WRITE_RESERVE_SIZE       = 200;
+constexpr char SUSHI_CLIENT_NAME[]            = "Sushi";
+constexpr char NOTE_SEQ_CLIENT_NAME[]         = "Nina_App_Notes:";
+
+// Static functions
+static void *_process_sushi_writes(void* data);
 
 //----------------------------------------------------------------------------
 // DawManager
 //----------------------------------------------------------------------------
 DawManager::DawManager(EventRouter *event_router) : 
-    BaseManager(NinaModule::DAW, MANAGER_NAME, event_router)
+    BaseManager(NinaModule::DAW, MANAGER_NAME, event_router), _pending_sushi_writes(SUSHI_WRITE_RESERVE_SIZE)
 {
     std::vector<std::pair<int,int>> param_blocklist;
 
@@ -39,20 +54,23 @@ DawManager::DawManager(EventRouter *event_router) :
     _osc_listener = 0;
     _gui_listener = 0;
     _main_track_id = -1;
+    std::fill(std::begin(_sushi_layer_state), std::end(_sushi_layer_state), -1);
+    _morphing_param = nullptr;
+    _note_seq_handle = 0;
+    _note_seq_port = -1;
+    _sushi_writer_thread = 0;
+    _run_sushi_writer_thread = true;
+    _sushi_write_batch.reserve(SUSHI_WRITE_RESERVE_SIZE);
+    _sushi_write_batch_trace_ids.reserve(SUSHI_WRITE_RESERVE_SIZE);
+    _patch_batch_active = false;
+    _patch_batch_set_tempo = false;
+    _patch_batch_tempo = 0.0f;
 
     // Register the DAW params
+    // Note: This also retrieves the Sushi build info
+    _sushi_verson.version = "Unknown";
     _register_params();
 
-    // Retrieve the Sushi build info
-    auto build_info = _sushi_controller->system_controller()->get_build_info();
-    if (build_info.first == sushi_controller::ControlStatus::OK) {
-        _sushi_verson.version = build_info.second.version;
-        _sushi_verson.commit_hash = build_info.second.commit_hash;
-    }
-    else {
-        _sushi_verson.version = "Unknown";
-    }    
-
     // Register the param change notification listener
     _sushi_controller->notification_controller()->subscribe_to_parameter_updates(
         std::bind(&DawManager::_param_update_notification,
@@ -60,6 +78,9 @@ DawManager::DawManager(EventRouter *event_router) :
         std::placeholders::_1,
         std::placeholders::_2,
         std::placeholders::_3), param_blocklist);     
+
+    // Create a normal thread to send the queued param writes to Sushi
+    _sushi_writer_thread = new std::thread(_process_sushi_writes, this);
 }
 
 //----------------------------------------------------------------------------
@@ -67,6 +88,21 @@ DawManager::DawManager(EventRouter *event_router) :
 //----------------------------------------------------------------------------
 DawManager::~DawManager()
 {
+    // Sushi writer task running?
+    if (_sushi_writer_thread != 0)
+    {
+        // Stop the Sushi writer task
+        // Note: Any pending writes are sent before the task exits
+        {
+            std::lock_guard<std::mutex> lock(_sushi_write_mutex);
+            _run_sushi_writer_thread = false;
+        }
+        _sushi_write_cv.notify_one();
+		if (_sushi_writer_thread->joinable())
+			_sushi_writer_thread->join(); 
+        _sushi_writer_thread = 0;       
+    }
+
     // Clean up the event listeners
     if (_sfc_param_changed_listener)
         delete _sfc_param_changed_listener;
@@ -80,6 +116,43 @@ DawManager::~DawManager()
         delete _gui_listener;
 }
 
+//----------------------------------------------------------------------------
+// start
+//----------------------------------------------------------------------------
+bool DawManager::start()
+{
+    // Open the ALSA sequencer note transport if configured
+    // If it cannot be opened, notes are sent via gRPC
+    if (utils::system_config()->get_note_transport() == NoteTransport::ALSA_SEQ)
+    {
+        if (_open_note_seq())
+        {
+            MSG("Note transport: ALSA sequencer");
+            NINA_LOG_INFO(module(), "Note transport: ALSA sequencer");
+        }
+        else
+        {
+            MSG("WARNING: Could not open the ALSA sequencer note transport, using gRPC");
+            NINA_LOG_WARNING(module(), "Could not open the ALSA sequencer note transport, using gRPC");
+        }
+    }
+
+    // Call the base manager
+    return BaseManager::start();
+}
+
+//----------------------------------------------------------------------------
+// stop
+//----------------------------------------------------------------------------
+void DawManager::stop()
+{
+    // Call the base manager
+    BaseManager::stop();
+
+    // Close the ALSA sequencer note transport
+    _close_note_seq();
+}
+
 //----------------------------------------------------------------------------
 // process
 //----------------------------------------------------------------------------
@@ -129,6 +202,23 @@ void DawManager::process_midi_event_direct(const snd_seq_event_t *event)
 {
     auto data = *event;
 
+    // If the ALSA sequencer note transport is open, send note events to Sushi directly
+    // If this fails, fall back to sending them via gRPC
+    if (_note_seq_handle) {
+        switch (data.type)
+        {
+            case SND_SEQ_EVENT_NOTEOFF:
+            case SND_SEQ_EVENT_NOTEON:
+            case SND_SEQ_EVENT_KEYPRESS:
+                if (_send_note_seq_event(data))
+                    return;
+                break;
+
+            default:
+                break;
+        }
+    }
+
     // If the main track ID was found
     if (_main_track_id != -1) {
         // Parse the MIDI message type
@@ -169,36 +259,29 @@ bool DawManager::get_patch_state_params()
 {
     bool ret = false;
 
-    // Get the Layer State param - this is used to get the processor ID used to retrieve the
-    // state param values
+    // Get the Layer State param - this is used to get the processor ID of the
+    // state params
     auto param = utils::get_param_from_ref(utils::ParamRef::LAYER_STATE);
     if (param)
     {
-        // Get the patch params
-        auto patch_params = _sushi_controller->parameter_controller()->get_parameter_values(param->processor_id);
-        auto itr = patch_params.second.begin();
+        // Get the Sushi param cache mutex
+        std::lock_guard<std::mutex> lock(_sushi_param_cache_mutex);
 
-        // Parse the available DAW params
-        auto params = utils::get_params(NinaModule::DAW);
-        for (Param *p : params)
+        // Process the params notified by Sushi since the last call
+        // Note: The cache is kept current by the Sushi param update notifications, so
+        // no request to Sushi is needed here
+        for (auto entry : _sushi_param_cache_dirty)
         {
-            // Skip params not for this processor or an alias param
-            if ((p->processor_id != param->processor_id) || p->alias_param)
-                continue;
-            
-            // The parameter IDs are sequential, but some will be blacklisted, so
-            // skip any of these
-            while (p->param_id != itr->parameter_id)
-                itr++;
-
-            // Is this a state param and did the value change?
-            if (p->patch_state_param && (p->get_value() != itr->value)) {
+            // Is this a state param for this processor and did the value change?
+            auto p = entry->param;
+            entry->dirty = false;
+            if ((p->processor_id == param->processor_id) && p->patch_state_param && (p->get_value() != entry->value)) {
                 // Yes, update the param value
-                p->set_value(itr->value);
+                p->set_value(entry->value);
                 ret = true;
             }
-            itr++;
         }
+        _sushi_param_cache_dirty.clear();
     }
     return ret;
 }
@@ -206,7 +289,7 @@ bool DawManager::get_patch_state_params()
 //----------------------------------------------------------------------------
 // set_patch_layer_params
 //----------------------------------------------------------------------------
-void DawManager::set_patch_layer_params(uint layer_num)
+void DawManager::set_patch_layer_params(uint layer_num, bool force_full)
 {
     // Get the Layer State param - this is used to get the processor ID used to retrieve the
     // state param values
@@ -215,24 +298,28 @@ void DawManager::set_patch_layer_params(uint layer_num)
     {
         std::vector<sushi_controller::ParameterValue> param_values;
 
+        // Send any queued writes first so they cannot overwrite these values
+        std::lock_guard<std::mutex> lock(_sushi_rpc_mutex);
+        _flush_sushi_writes_locked();
+
         // Parse the available DAW params
-        auto params = utils::get_params(NinaModule::DAW);
-        for (const Param *p : params)
-        {
-            // If this is a layer param
-            if (p->patch_layer_param) {
-                // Add the value to set to send
-                auto param_value = sushi_controller::ParameterValue();
-                param_value.processor_id = p->processor_id;
-                param_value.parameter_id = _encode_param_id(p->param_id, LayerInfo::GetLayerMaskBit(layer_num));
-                param_value.value = p->get_value();
-                param_values.push_back(param_value);          
+        {
+            // Get the Sushi param cache mutex
+            std::lock_guard<std::mutex> cache_lock(_sushi_param_cache_mutex);
+
+            auto params = utils::get_params_view(NinaModule::DAW);
+            for (const Param *p : *params)
+            {
+                // If this is a layer param, add the value to send (if changed)
+                if (p->patch_layer_param) {
+                    _add_patch_param_value(param_values, p, layer_num, force_full);
+                }
             }
         }
 
         // Send the values to Sushi
         if (param_values.size() > 0) {
-            _sushi_controller->parameter_controller()->set_parameter_values(param_values);
+            _send_patch_param_values(param_values, layer_num);
         }
     }
 }
@@ -240,7 +327,7 @@ void DawManager::set_patch_layer_params(uint layer_num)
 //----------------------------------------------------------------------------
 // set_patch_params
 //----------------------------------------------------------------------------
-void DawManager::set_patch_params(uint layer_num, bool include_cmn_params, PatchState state)
+void DawManager::set_patch_params(uint layer_num, bool include_cmn_params, PatchState state, bool force_full)
 {
     // Get the Layer State param as we need to set this, and the Morph Value param to make
     // sure it is NOT sent with these params
@@ -250,54 +337,134 @@ void DawManager::set_patch_params(uint layer_num, bool include_cmn_params, Patch
     if (layer_state_param && morph_value_param)
     {
         std::vector<sushi_controller::ParameterValue> param_values;
-        uint layer_mask_bit = LayerInfo::GetLayerMaskBit(layer_num);
+
+        // Send any queued writes first so they cannot overwrite the patch values
+        std::lock_guard<std::mutex> lock(_sushi_rpc_mutex);
+        _flush_sushi_writes_locked();
 
         // Set the Layer State param first
         auto value = (state == PatchState::STATE_A) ? 0 : 1;
-        _sushi_controller->parameter_controller()->set_parameter_value(layer_state_param->processor_id, 
-                                                                       _encode_param_id(layer_state_param->param_id, layer_mask_bit),
-                                                                       value);
+        _set_layer_state(layer_state_param, layer_num, value);
 
         // Parse the available DAW params
-        auto params = utils::get_params(NinaModule::DAW);
-        for (Param *p : params)
-        {
-            // Skip params if:
-            // - Common and common should not be included
-            // - The Layer State and Load params (already sent)
-            //   Note: Assume they are sequential params
-            // - If this is an alias param
-            // - If this is a patch layer param
-            // - If this is the Morph Value param
-            if ((!p->patch_state_param && !include_cmn_params) ||
-                (p->param_id == layer_state_param->param_id) ||
-                (p->param_id == (layer_state_param->param_id + 1)) ||
-                p->alias_param ||
-                p->patch_layer_param ||
-                (p->param_id == morph_value_param->param_id)) {
-                continue; 
-            }
+        {
+            // Get the Sushi param cache mutex, and save the state now set for this layer
+            std::lock_guard<std::mutex> cache_lock(_sushi_param_cache_mutex);
+            _sushi_layer_state[layer_num] = value;
+
+            auto params = utils::get_params_view(NinaModule::DAW);
+            for (Param *p : *params)
+            {
+                // Skip params if:
+                // - Common and common should not be included
+                // - The Layer State and Load params (already sent)
+                //   Note: Assume they are sequential params
+                // - If this is an alias param
+                // - If this is a patch layer param
+                // - If this is the Morph Value param
+                if ((!p->patch_state_param && !include_cmn_params) ||
+                    (p->param_id == layer_state_param->param_id) ||
+                    (p->param_id == (layer_state_param->param_id + 1)) ||
+                    p->alias_param ||
+                    p->patch_layer_param ||
+                    (p->param_id == morph_value_param->param_id)) {
+                    continue; 
+                }
 
-            // Add the value to set to send
-            auto param_value = sushi_controller::ParameterValue();
-            param_value.processor_id = p->processor_id;
-            param_value.parameter_id = _encode_param_id(p->param_id, layer_mask_bit);
-            param_value.value = p->get_value();
-            param_values.push_back(param_value);
+                // Add the value to send (if changed)
+                _add_patch_param_value(param_values, p, layer_num, force_full);
+            }
         }
 
         // Send the values to Sushi
-        _sushi_controller->parameter_controller()->set_parameter_values(param_values);
+        if (param_values.size() > 0) {
+            _send_patch_param_values(param_values, layer_num);
+        }
 
         // We also need to set the tempo in Sushi (if we are including the common params)
         auto param = utils::get_param(ParamType::COMMON_PARAM, CommonParamId::TEMPO_BPM_PARAM_ID);
         if (param && include_cmn_params) {
             // Set the tempo in Sushi
-            _sushi_controller->transport_controller()->set_tempo(param->get_value());
+            _set_tempo(param->get_value());
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// begin_patch_batch
+//----------------------------------------------------------------------------
+void DawManager::begin_patch_batch()
+{
+    // Get the Sushi RPC mutex
+    std::lock_guard<std::mutex> lock(_sushi_rpc_mutex);
+
+    // Send any queued writes first, and then start collecting the patch values (and
+    // any further writes) into a single batch, so that multiple patches can be pushed
+    // to Sushi in one transaction
+    _flush_sushi_writes_locked();
+    _patch_batch_active = true;
+    _patch_batch_set_tempo = false;
+}
+
+//----------------------------------------------------------------------------
+// end_patch_batch
+//----------------------------------------------------------------------------
+void DawManager::end_patch_batch()
+{
+    // Get the Sushi RPC mutex
+    std::lock_guard<std::mutex> lock(_sushi_rpc_mutex);
+    if (_patch_batch_active)
+    {
+        // Add any queued writes to the batch, and stop collecting values
+        _flush_sushi_writes_locked();
+        _patch_batch_active = false;
+
+        // Send the batch to Sushi
+        // Note: The values are applied in order, so the Layer State values in the batch
+        // select the state each following patch value is set in
+        if (_patch_batch_values.size() > 0)
+        {
+            auto start_time = std::chrono::steady_clock::now();
+            auto status = _sushi_controller->parameter_controller()->set_parameter_values(_patch_batch_values);
+            auto rpc_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time);
+
+            // If the batch could not be sent, the values in Sushi are no longer known for
+            // any layer
+            if (status != sushi_controller::ControlStatus::OK)
+            {
+                std::lock_guard<std::mutex> cache_lock(_sushi_param_cache_mutex);
+                _invalidate_sent_values((1 << NUM_LAYERS) - 1);
+            }
+            DEBUG_BASEMGR_MSG("Sent patch batch to Sushi: " << _patch_batch_values.size() << " values, " << rpc_time.count() << "us");
+
+            // Update the stats
+            _sushi_write_stats.batch_size.record(_patch_batch_values.size());
+            _sushi_write_stats.rpc_time.record(rpc_time.count());
+            _patch_batch_values.clear();
+        }
+
+        // Set the tempo in Sushi (if set by any of the patches)
+        if (_patch_batch_set_tempo)
+        {
+            _sushi_controller->transport_controller()->set_tempo(_patch_batch_tempo);
+            _patch_batch_set_tempo = false;
         }
     }
 }
 
+//----------------------------------------------------------------------------
+// invalidate_sushi_param_shadow
+//----------------------------------------------------------------------------
+void DawManager::invalidate_sushi_param_shadow()
+{
+    // Get the Sushi param cache mutex
+    std::lock_guard<std::mutex> lock(_sushi_param_cache_mutex);
+
+    // Mark the values sent to Sushi for all layers as not known, so that the next patch
+    // and layer pushes send all values
+    _invalidate_sent_values((1 << NUM_LAYERS) - 1);
+}
+
 //----------------------------------------------------------------------------
 // set_param
 //----------------------------------------------------------------------------
@@ -305,10 +472,8 @@ void DawManager::set_param(uint layer_num, const Param *param)
 {
     // If this is a DAW param
     if (param->module == NinaModule::DAW) {
-        // Send the param change to Sushi
-        _sushi_controller->parameter_controller()->set_parameter_value(param->processor_id, 
-                                                                      _encode_param_id(param->param_id, LayerInfo::GetLayerMaskBit(layer_num)),
-                                                                      param->get_value());
+        // Queue the param change to send to Sushi
+        _queue_sushi_write(param->processor_id, _encode_param_id(param->param_id, LayerInfo::GetLayerMaskBit(layer_num)), param->get_value());
     }   
 }
 
@@ -319,10 +484,8 @@ void DawManager::set_param(uint layer_num, const Param *param, float value)
 {
     // If this is a DAW param
     if (param->module == NinaModule::DAW) {
-        // Send the param change to Sushi
-        _sushi_controller->parameter_controller()->set_parameter_value(param->processor_id, 
-                                                                      _encode_param_id(param->param_id, LayerInfo::GetLayerMaskBit(layer_num)),
-                                                                      value);
+        // Queue the param change to send to Sushi
+        _queue_sushi_write(param->processor_id, _encode_param_id(param->param_id, LayerInfo::GetLayerMaskBit(layer_num)), value);
     }   
 }
 
@@ -333,10 +496,8 @@ void DawManager::set_param_direct(uint layer_mask, const Param *param)
 {
     // If this is a DAW param
     if (param->module == NinaModule::DAW) {
-        // Send the param change to Sushi
-        _sushi_controller->parameter_controller()->set_parameter_value(param->processor_id, 
-                                                                      _encode_param_id(param->param_id, layer_mask),
-                                                                      param->get_value());
+        // Queue the param change to send to Sushi
+        _queue_sushi_write(param->processor_id, _encode_param_id(param->param_id, layer_mask), param->get_value());
     }   
 }
 
@@ -347,14 +508,12 @@ void DawManager::set_param_all_layers(const Param *param)
 {
     // If this is a DAW param
     if (param->module == NinaModule::DAW) {
-        // Send the param change to Sushi - all Layers
+        // Queue the param change to send to Sushi - all Layers
         uint layer_mask = 0;
         for (uint i=0; i<NUM_LAYERS; i++) {
             layer_mask |= LayerInfo::GetLayerMaskBit(i);
         }
-        _sushi_controller->parameter_controller()->set_parameter_value(param->processor_id, 
-                                                                      _encode_param_id(param->param_id, layer_mask),
-                                                                      param->get_value());
+        _queue_sushi_write(param->processor_id, _encode_param_id(param->param_id, layer_mask), param->get_value());
     }   
 }
 
@@ -366,6 +525,75 @@ SushiVersion DawManager::get_sushi_version()
     return _sushi_verson;
 }
 
+//----------------------------------------------------------------------------
+// process_sushi_writes
+//----------------------------------------------------------------------------
+void DawManager::process_sushi_writes()
+{
+    auto last_flush_time = std::chrono::steady_clock::now() - SUSHI_WRITE_TICK;
+
+    // Do forever (until the thread is exited)
+    std::unique_lock<std::mutex> lock(_sushi_write_mutex);
+    while (true)
+    {
+        // Wait for param writes to be queued
+        _sushi_write_cv.wait(lock, [this]{ return !_pending_sushi_writes.empty() || !_run_sushi_writer_thread; });
+
+        // Exit the thread if requested and there are no more writes
+        if (_pending_sushi_writes.empty())
+            break;
+
+        // If the last batch was sent within the tick period, wait for the rest of the
+        // tick so that more writes can be coalesced
+        // If idle, the writes are sent immediately
+        auto next_flush_time = last_flush_time + SUSHI_WRITE_TICK;
+        if (std::chrono::steady_clock::now() < next_flush_time)
+            _sushi_write_cv.wait_until(lock, next_flush_time, [this]{ return !_run_sushi_writer_thread; });
+
+        // Send the pending writes
+        lock.unlock();
+        _flush_sushi_writes();
+        last_flush_time = std::chrono::steady_clock::now();
+        lock.lock();
+    }
+}
+
+//----------------------------------------------------------------------------
+// sushi_write_stats
+//----------------------------------------------------------------------------
+const SushiWriteStats& DawManager::sushi_write_stats() const
+{
+    return _sushi_write_stats;
+}
+
+//----------------------------------------------------------------------------
+// log_event_stats
+//----------------------------------------------------------------------------
+void DawManager::log_event_stats(bool reset)
+{
+    // Log the manager event stats
+    BaseManager::log_event_stats(reset);
+
+    // Log the Sushi write stats
+    auto& batch = _sushi_write_stats.batch_size;
+    auto& rpc = _sushi_write_stats.rpc_time;
+    NINA_LOG_INFO(module(), "Sushi writes: {} queued, {} coalesced, {} batches, batch size mean {} p99 {} max {}, RPC (us) mean {} p50 {} p99 {} max {}",
+                  _sushi_write_stats.num_writes.load(), _sushi_write_stats.num_coalesced.load(),
+                  batch.count(), batch.mean_us(), batch.percentile_us(99.0f), batch.max_us(),
+                  rpc.mean_us(), rpc.percentile_us(50.0f), rpc.percentile_us(99.0f), rpc.max_us());
+    NINA_LOG_INFO(module(), "Sushi patch pushes: {} values sent, {} unchanged values skipped",
+                  _sushi_write_stats.num_patch_values_sent.load(), _sushi_write_stats.num_patch_values_skipped.load());
+    if (reset)
+    {
+        _sushi_write_stats.num_patch_values_sent.store(0);
+        _sushi_write_stats.num_patch_values_skipped.store(0);
+        _sushi_write_stats.num_writes.store(0);
+        _sushi_write_stats.num_coalesced.store(0);
+        batch.reset();
+        rpc.reset();
+    }
+}
+
 #if defined CHECK_LAYERS_LOAD
 //----------------------------------------------------------------------------
 // get_params
@@ -384,8 +612,8 @@ std::vector<std::pair<Param *,float>> DawManager::get_param_values(bool state_on
         auto itr = patch_params.second.begin();
 
         // Parse the available DAW params
-        auto params = utils::get_params(NinaModule::DAW);
-        for (Param *p : params)
+        auto params = utils::get_params_view(NinaModule::DAW);
+        for (Param *p : *params)
         {
             // Skip params not for this processor or an alias param
             if ((p->processor_id != param->processor_id) || p->alias_param)
@@ -413,44 +641,530 @@ std::vector<std::pair<Param *,float>> DawManager::get_param_values(bool state_on
 void DawManager::_process_param_changed_event(const ParamChange &data)
 {
     // Get the param, check if it exists and is for the DAW
-    const Param *param = utils::get_param(data.path.c_str());
+    const Param *param = utils::get_param_from_handle(data.handle);
     if (param && (param->module == NinaModule::DAW))
     {
-        // Send the param change to Sushi
-        _sushi_controller->parameter_controller()->set_parameter_value(param->processor_id, 
-                                                                       _encode_param_id(param->param_id, data.layers_mask),
-                                                                       data.value);
+        // If this param change is being traced, record that it has been received
+        LatencyTrace::Record(data.trace_id, LatencyTraceStage::DAW_RECEIVED);
+
+        // Queue the param change to send to Sushi
+        _queue_sushi_write(param->processor_id, _encode_param_id(param->param_id, data.layers_mask), data.value, data.trace_id);
     }
     // Not for the DAW, is it however the Tempo BPM param (special case for Sushi)
-    else if(data.path == utils::get_param(ParamType::COMMON_PARAM, CommonParamId::TEMPO_BPM_PARAM_ID)->get_path())
+    else if(data.handle == utils::get_param(ParamType::COMMON_PARAM, CommonParamId::TEMPO_BPM_PARAM_ID)->handle)
     {
         // Set the tempo in Sushi
         _sushi_controller->transport_controller()->set_tempo(data.value);
     }
 }
 
+//----------------------------------------------------------------------------
+// _open_note_seq
+//----------------------------------------------------------------------------
+bool DawManager::_open_note_seq()
+{
+    // Open the ALSA Sequencer (output only)
+    if (snd_seq_open(&_note_seq_handle, "hw", SND_SEQ_OPEN_OUTPUT, 0) < 0)
+    {
+        DEBUG_BASEMGR_MSG("Open ALSA Sequencer for notes failed");
+        _note_seq_handle = 0;
+        return false;
+    }
+
+    // Set the client name and create a simple port to send the notes from
+    snd_seq_set_client_name(_note_seq_handle, NOTE_SEQ_CLIENT_NAME);
+    _note_seq_port = snd_seq_create_simple_port(_note_seq_handle, NOTE_SEQ_CLIENT_NAME,
+                                                (SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_SUBS_READ),
+                                                (SND_SEQ_PORT_TYPE_MIDI_GENERIC | SND_SEQ_PORT_TYPE_APPLICATION));
+    if (_note_seq_port < 0)
+    {
+        DEBUG_BASEMGR_MSG("Create ALSA simple port for notes failed");
+        _close_note_seq();
+        return false;
+    }
+
+    // Find the Sushi client, and connect to its first writable port
+    bool connected = false;
+    snd_seq_client_info_t *cinfo;
+    snd_seq_port_info_t *pinfo;
+    snd_seq_client_info_alloca(&cinfo);
+    snd_seq_port_info_alloca(&pinfo);
+    snd_seq_client_info_set_client(cinfo, -1);
+    while (!connected && (snd_seq_query_next_client(_note_seq_handle, cinfo) >= 0))
+    {
+        // Is this the Sushi client?
+        if (std::strcmp(snd_seq_client_info_get_name(cinfo), SUSHI_CLIENT_NAME) == 0)
+        {
+            // Query the Sushi ports
+            snd_seq_port_info_set_client(pinfo, snd_seq_client_info_get_client(cinfo));
+            snd_seq_port_info_set_port(pinfo, -1);
+            while (snd_seq_query_next_port(_note_seq_handle, pinfo) >= 0)
+            {
+                // Can this port support a write subscription?
+                uint seq_port_cap = snd_seq_port_info_get_capability(pinfo);
+                if ((seq_port_cap & SND_SEQ_PORT_CAP_WRITE) && (seq_port_cap & SND_SEQ_PORT_CAP_SUBS_WRITE))
+                {
+                    // Connect TO this port
+                    connected = snd_seq_connect_to(_note_seq_handle, _note_seq_port,
+                                                   snd_seq_port_info_get_client(pinfo),
+                                                   snd_seq_port_info_get_port(pinfo)) == 0;
+                    break;
+                }
+            }
+        }
+    }
+    if (!connected)
+    {
+        DEBUG_BASEMGR_MSG("Connect to the Sushi ALSA Sequencer port failed");
+        _close_note_seq();
+        return false;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _close_note_seq
+//----------------------------------------------------------------------------
+void DawManager::_close_note_seq()
+{
+    // Get the note sequencer mutex
+    std::lock_guard<std::mutex> lock(_note_seq_mutex);
+
+    // ALSA sequencer opened?
+    if (_note_seq_handle)
+    {
+        // Close the ALSA sequencer and free any allocated memory
+        snd_seq_close(_note_seq_handle); 
+        snd_config_update_free_global();
+        _note_seq_handle = 0;
+        _note_seq_port = -1;
+    }
+}
+
+//----------------------------------------------------------------------------
+// _send_note_seq_event
+//----------------------------------------------------------------------------
+bool DawManager::_send_note_seq_event(snd_seq_event_t &event)
+{
+    // Get the note sequencer mutex
+    std::lock_guard<std::mutex> lock(_note_seq_mutex);
+
+    // ALSA sequencer opened?
+    if (_note_seq_handle)
+    {
+        // Send the event directly to the subscribers of the note port (Sushi), bypassing
+        // the output buffer
+        snd_seq_ev_set_source(&event, _note_seq_port);
+        snd_seq_ev_set_subs(&event);
+        snd_seq_ev_set_direct(&event);
+        return snd_seq_event_output_direct(_note_seq_handle, &event) >= 0;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// _queue_sushi_write
+//----------------------------------------------------------------------------
+void DawManager::_queue_sushi_write(int processor_id, int parameter_id, float value, LatencyTraceId trace_id)
+{
+    {
+        // Get the Sushi write mutex
+        std::lock_guard<std::mutex> lock(_sushi_write_mutex);
+
+        // Queue the write, the param is the processor and (decoded) parameter ID
+        // Note: If a write for this param and layers is already queued, it is coalesced
+        // with that write (last value wins), as long as the writes are still applied
+        // in the order they were made
+        uint layers_mask;
+        int param_id = _decode_param_id(parameter_id, layers_mask);
+        uint64_t param_key = (static_cast<uint64_t>(static_cast<uint32_t>(processor_id)) << 32) | static_cast<uint32_t>(param_id);
+        auto param_value = sushi_controller::ParameterValue();
+        param_value.processor_id = processor_id;
+        param_value.parameter_id = parameter_id;
+        param_value.value = value;
+        if (_pending_sushi_writes.push(param_key, layers_mask, param_value, trace_id))
+            _sushi_write_stats.num_coalesced++;
+        _sushi_write_stats.num_writes++;
+    }
+
+    // Signal the writer thread
+    _sushi_write_cv.notify_one();
+}
+
+//----------------------------------------------------------------------------
+// _flush_sushi_writes
+//----------------------------------------------------------------------------
+void DawManager::_flush_sushi_writes()
+{
+    // Get the Sushi RPC mutex
+    std::lock_guard<std::mutex> lock(_sushi_rpc_mutex);
+    _flush_sushi_writes_locked();
+}
+
+//----------------------------------------------------------------------------
+// _flush_sushi_writes_locked
+// Note: The Sushi RPC mutex must be held by the caller
+//----------------------------------------------------------------------------
+void DawManager::_flush_sushi_writes_locked()
+{
+    // Take the pending writes
+    {
+        // Get the Sushi write mutex
+        std::lock_guard<std::mutex> lock(_sushi_write_mutex);
+        _pending_sushi_writes.take(_sushi_write_batch, _sushi_write_batch_trace_ids);
+    }
+
+    // If a patch batch is being collected, add the writes to the batch rather than
+    // sending them now, so that they are applied in order with the patch values
+    if (_patch_batch_active && (_sushi_write_batch.size() > 0))
+    {
+        {
+            // Get the Sushi param cache mutex
+            std::lock_guard<std::mutex> lock(_sushi_param_cache_mutex);
+            for (const auto& pv : _sushi_write_batch)
+            {
+                uint layers_mask;
+                auto entry = _get_sushi_param_entry(pv.processor_id, _decode_param_id(pv.parameter_id, layers_mask));
+                if (entry)
+                {
+                    _set_sent_values(*entry, layers_mask, pv.value);
+                }
+            }
+        }
+        _patch_batch_values.insert(_patch_batch_values.end(), _sushi_write_batch.begin(), _sushi_write_batch.end());
+        _sushi_write_batch.clear();
+        _sushi_write_batch_trace_ids.clear();
+        return;
+    }
+
+    // Any writes to send?
+    if (_sushi_write_batch.size() > 0)
+    {
+        // Send the writes to Sushi, as a single batch if more than one
+        sushi_controller::ControlStatus status;
+        auto start_time = std::chrono::steady_clock::now();
+        if (_sushi_write_batch.size() == 1)
+        {
+            status = _sushi_controller->parameter_controller()->set_parameter_value(_sushi_write_batch[0].processor_id,
+                                                                                    _sushi_write_batch[0].parameter_id,
+                                                                                    _sushi_write_batch[0].value);
+        }
+        else
+        {
+            status = _sushi_controller->parameter_controller()->set_parameter_values(_sushi_write_batch);
+        }
+        auto end_time = std::chrono::steady_clock::now();
+        auto rpc_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+
+        // Update the values last sent to Sushi for these params
+        {
+            // Get the Sushi param cache mutex
+            std::lock_guard<std::mutex> lock(_sushi_param_cache_mutex);
+            for (uint i=0; i<_sushi_write_batch.size(); i++)
+            {
+                const auto& pv = _sushi_write_batch[i];
+                uint layers_mask;
+                auto entry = _get_sushi_param_entry(pv.processor_id, _decode_param_id(pv.parameter_id, layers_mask));
+                if (entry)
+                {
+                    // If the write failed, the value in Sushi is not known
+                    _set_sent_values(*entry, layers_mask, (status == sushi_controller::ControlStatus::OK) ? pv.value : UNKNOWN_SENT_VALUE);
+
+                    // If this write is being traced, record that it has been written, and
+                    // trace the Sushi notification of the new value
+                    LatencyTraceId trace_id = _sushi_write_batch_trace_ids[i];
+                    if (trace_id != NO_LATENCY_TRACE_ID)
+                    {
+                        LatencyTrace::Record(trace_id, LatencyTraceStage::SUSHI_WRITE, end_time);
+                        entry->trace_id = trace_id;
+                    }
+                }
+            }
+        }
+
+        // Update the stats
+        _sushi_write_stats.batch_size.record(_sushi_write_batch.size());
+        _sushi_write_stats.rpc_time.record(rpc_time.count());
+        _sushi_write_batch.clear();
+        _sushi_write_batch_trace_ids.clear();
+    }
+}
+
+//----------------------------------------------------------------------------
+// _add_patch_param_value
+// Note: The Sushi param cache mutex must be held by the caller
+//----------------------------------------------------------------------------
+void DawManager::_add_patch_param_value(std::vector<sushi_controller::ParameterValue>& param_values, const Param *param, uint layer_num, bool force_full)
+{
+    float value = param->get_value();
+
+    // If the value last sent to Sushi for this layer and state is known, only send the
+    // value if it has changed (unless forced)
+    auto entry = _get_sushi_param_entry(param->processor_id, param->param_id);
+    int state = _sushi_layer_state[layer_num];
+    if (entry && (state >= 0))
+    {
+        auto& sent_value = entry->sent_values[layer_num][state];
+        if (!force_full && (sent_value == value))
+        {
+            _sushi_write_stats.num_patch_values_skipped++;
+            return;
+        }
+        sent_value = value;
+    }
+
+    // Add the value to send
+    auto param_value = sushi_controller::ParameterValue();
+    param_value.processor_id = param->processor_id;
+    param_value.parameter_id = _encode_param_id(param->param_id, LayerInfo::GetLayerMaskBit(layer_num));
+    param_value.value = value;
+    param_values.push_back(param_value);
+}
+
+//----------------------------------------------------------------------------
+// _send_patch_param_values
+// Note: The Sushi RPC mutex must be held by the caller
+//----------------------------------------------------------------------------
+void DawManager::_send_patch_param_values(const std::vector<sushi_controller::ParameterValue>& param_values, uint layer_num)
+{
+    // If a patch batch is being collected, add the values to the batch
+    if (_patch_batch_active)
+    {
+        _patch_batch_values.insert(_patch_batch_values.end(), param_values.begin(), param_values.end());
+        _sushi_write_stats.num_patch_values_sent += param_values.size();
+        return;
+    }
+
+    // Send the values to Sushi
+    auto status = _sushi_controller->parameter_controller()->set_parameter_values(param_values);
+    _sushi_write_stats.num_patch_values_sent += param_values.size();
+
+    // If the values could not be sent, the values in Sushi for this layer are no
+    // longer known
+    if (status != sushi_controller::ControlStatus::OK)
+    {
+        std::lock_guard<std::mutex> lock(_sushi_param_cache_mutex);
+        _invalidate_sent_values(LayerInfo::GetLayerMaskBit(layer_num));
+    }
+}
+
+//----------------------------------------------------------------------------
+// _set_layer_state
+// Note: The Sushi RPC mutex must be held by the caller
+//----------------------------------------------------------------------------
+void DawManager::_set_layer_state(const Param *layer_state_param, uint layer_num, int value)
+{
+    // If a patch batch is being collected, add the value to the batch, otherwise send
+    // it to Sushi now
+    int param_id = _encode_param_id(layer_state_param->param_id, LayerInfo::GetLayerMaskBit(layer_num));
+    if (_patch_batch_active)
+    {
+        auto param_value = sushi_controller::ParameterValue();
+        param_value.processor_id = layer_state_param->processor_id;
+        param_value.parameter_id = param_id;
+        param_value.value = value;
+        _patch_batch_values.push_back(param_value);
+    }
+    else
+    {
+        _sushi_controller->parameter_controller()->set_parameter_value(layer_state_param->processor_id, param_id, value);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _set_tempo
+// Note: The Sushi RPC mutex must be held by the caller
+//----------------------------------------------------------------------------
+void DawManager::_set_tempo(float tempo)
+{
+    // If a patch batch is being collected, set the tempo once the batch is sent,
+    // otherwise set it in Sushi now
+    if (_patch_batch_active)
+    {
+        _patch_batch_tempo = tempo;
+        _patch_batch_set_tempo = true;
+    }
+    else
+    {
+        _sushi_controller->transport_controller()->set_tempo(tempo);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _set_sent_values
+// Note: The Sushi param cache mutex must be held by the caller
+//----------------------------------------------------------------------------
+void DawManager::_set_sent_values(SushiParamCacheEntry &entry, uint layers_mask, float value)
+{
+    // Each layer in the mask (all layers if no mask) has this value for its current
+    // state, if known
+    // The values for the other state are no longer known, as the value may have been
+    // applied to both states
+    for (uint i=0; i<NUM_LAYERS; i++)
+    {
+        if ((layers_mask == 0) || (layers_mask & LayerInfo::GetLayerMaskBit(i)))
+        {
+            std::fill(std::begin(entry.sent_values[i]), std::end(entry.sent_values[i]), UNKNOWN_SENT_VALUE);
+            if ((layers_mask != 0) && (_sushi_layer_state[i] >= 0))
+            {
+                entry.sent_values[i][_sushi_layer_state[i]] = value;
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _invalidate_sent_values
+// Note: The Sushi param cache mutex must be held by the caller
+//----------------------------------------------------------------------------
+void DawManager::_invalidate_sent_values(uint layers_mask)
+{
+    // Mark the values sent to Sushi for each layer in the mask as not known
+    for (auto& processor_params : _sushi_param_table)
+    {
+        for (auto& entry : processor_params)
+        {
+            for (uint i=0; i<NUM_LAYERS; i++)
+            {
+                if (layers_mask & LayerInfo::GetLayerMaskBit(i))
+                {
+                    std::fill(std::begin(entry.sent_values[i]), std::end(entry.sent_values[i]), UNKNOWN_SENT_VALUE);
+                }
+            }
+        }
+    }
+}
+
 //----------------------------------------------------------------------------
 // _param_update_notification
 //----------------------------------------------------------------------------
 void DawManager::_param_update_notification(int processor_id, int parameter_id, float value)
 {
-    // Find the param to update
-    auto params = utils::get_params(NinaModule::DAW);
-    for (Param *p : params)
+    uint layers_mask;
+
+    // Decode the layer bits from the parameter ID, and find the param entry
+    parameter_id = _decode_param_id(parameter_id, layers_mask);
+    auto entry = _get_sushi_param_entry(processor_id, parameter_id);
+    if (entry)
     {
-        // Match?
-        if ((p->param_id == parameter_id) && (p->processor_id == processor_id))
+        // If this is the Morphing param, we use this to enable/disable morphing for the system
+        if (entry->param == _morphing_param)
+        {
+            // Enable/disable morphing
+            utils::set_morph_enabled((value == 1.0) ? true : false);
+        }
+
+        // If Sushi has changed this value itself (e.g. morphing), the value last sent to
+        // Sushi for the layer is no longer valid
+        // Note: If no layer is specified, the value applies to the current layer
+        {
+            // Get the Sushi param cache mutex
+            std::lock_guard<std::mutex> lock(_sushi_param_cache_mutex);
+
+            // If a write of this param is being traced, record that Sushi has notified
+            // the new value
+            if (entry->trace_id != NO_LATENCY_TRACE_ID)
+            {
+                LatencyTrace::Record(entry->trace_id, LatencyTraceStage::SUSHI_ECHO);
+                entry->trace_id = NO_LATENCY_TRACE_ID;
+            }
+            uint mask = layers_mask ? layers_mask : LayerInfo::GetLayerMaskBit(utils::get_current_layer_info().layer_num());
+            for (uint i=0; i<NUM_LAYERS; i++)
+            {
+                int state = _sushi_layer_state[i];
+                if ((mask & LayerInfo::GetLayerMaskBit(i)) && ((state < 0) || (entry->sent_values[i][state] != value)))
+                {
+                    std::fill(std::begin(entry->sent_values[i]), std::end(entry->sent_values[i]), UNKNOWN_SENT_VALUE);
+                }
+            }
+        }
+
+        // Update the Sushi param cache, if this value applies to the current layer
+        // Note: Values for other layers are not reflected in the current param values
+        if ((layers_mask == 0) || (layers_mask & LayerInfo::GetLayerMaskBit(utils::get_current_layer_info().layer_num())))
         {
-            // If this is the Morphing param, we use this to enable/disable morphing for the system
-            if (p->get_path() == "/daw/main/ninavst/Morphing") {
-                // Enable/disable morphing
-                utils::set_morph_enabled((value == 1.0) ? true : false);
+            // Get the Sushi param cache mutex
+            std::lock_guard<std::mutex> lock(_sushi_param_cache_mutex);
+
+            // Update the cached value, and add it to the dirty set if not already pending
+            entry->value = value;
+            if (!entry->dirty)
+            {
+                entry->dirty = true;
+                _sushi_param_cache_dirty.push_back(entry);
             }
-            break;          
         }
     }
 }
 
+//----------------------------------------------------------------------------
+// _build_sushi_param_table
+//----------------------------------------------------------------------------
+void DawManager::_build_sushi_param_table()
+{
+    // Get the Sushi param cache mutex
+    std::lock_guard<std::mutex> lock(_sushi_param_cache_mutex);
+
+    // Add each DAW param to the table, indexed by its processor ID and parameter ID,
+    // with its current value
+    auto params = utils::get_params_view(NinaModule::DAW);
+    for (Param *p : *params)
+    {
+        // Skip alias params or params with an invalid ID
+        if (p->alias_param || (p->processor_id < 0) || (p->param_id < 0))
+            continue;
+
+        // Make sure the table is big enough for this processor and parameter ID
+        if (_sushi_param_table.size() <= (uint)p->processor_id)
+            _sushi_param_table.resize(p->processor_id + 1);
+        auto& processor_params = _sushi_param_table[p->processor_id];
+        if (processor_params.size() <= (uint)p->param_id)
+            processor_params.resize(p->param_id + 1, SushiParamCacheEntry());
+
+        // Add the param if not already added
+        auto& entry = processor_params[p->param_id];
+        if (!entry.param)
+        {
+            entry.param = p;
+            entry.value = p->get_value();
+        }
+
+        // Save the Morphing param, we use this to enable/disable morphing for the system
+        if (p->get_path() == "/daw/main/ninavst/Morphing")
+            _morphing_param = p;
+    }
+    _sushi_param_cache_dirty.reserve(params->size());
+}
+
+//----------------------------------------------------------------------------
+// _get_sushi_param_entry
+//----------------------------------------------------------------------------
+inline SushiParamCacheEntry *DawManager::_get_sushi_param_entry(int processor_id, int parameter_id)
+{
+    // Check the processor and parameter ID are in the table
+    if ((processor_id >= 0) && ((uint)processor_id < _sushi_param_table.size()))
+    {
+        auto& processor_params = _sushi_param_table[processor_id];
+        if ((parameter_id >= 0) && ((uint)parameter_id < processor_params.size()) && processor_params[parameter_id].param)
+        {
+            return &processor_params[parameter_id];
+        }
+    }
+    return nullptr;
+}
+
+//----------------------------------------------------------------------------
+// _decode_param_id
+//----------------------------------------------------------------------------
+inline int DawManager::_decode_param_id(int parameter_id, uint& layers_mask)
+{
+    // Get the layer number bits from the Param ID
+    layers_mask = ((uint)parameter_id & ~PARAM_ID_LAYER_NUM_BIT_MASK) >> PARAM_ID_LAYERS_MASK_BIT_SHIFT;
+
+    // Mask off the Param ID layer number bits
+    return parameter_id & PARAM_ID_LAYER_NUM_BIT_MASK;
+}
+
 //----------------------------------------------------------------------------
 // _encode_param_id
 //----------------------------------------------------------------------------
@@ -474,11 +1188,8 @@ void DawManager::_register_params()
     uint num_tracks = 0;
     uint retry_count = REGISTER_PARAMS_RETRY_COUNT;
     std::pair<sushi_controller::ControlStatus, std::vector<sushi_controller::TrackInfo>> tracks;
-    std::pair<sushi_controller::ControlStatus, std::vector<sushi_controller::ParameterInfo>> track_params;
-    std::pair<sushi_controller::ControlStatus, std::vector<sushi_controller::ProcessorInfo>> track_processors;
-    std::pair<sushi_controller::ControlStatus, std::vector<sushi_controller::ParameterInfo>> proc_params;
 
-    // Retry until we get tracks/params from Sushi
+    // Retry until we get tracks from Sushi
     MSG("Registering DAW params from Sushi...");
     while (retry_count--)
     {
@@ -493,47 +1204,69 @@ void DawManager::_register_params()
             continue;
         }
 
-        // One or more tracks reported by Sushi - process each track
+        // One or more tracks reported by Sushi
         MSG("Connected to the Sushi Controller, retry attempts: " << (REGISTER_PARAMS_RETRY_COUNT-retry_count));
         num_tracks = tracks.second.size();
-        for (sushi_controller::TrackInfo ti : tracks.second)
+
+        // Retrieve the Sushi build info, this is used to check the schema cache
+        _retrieve_sushi_version();
+
+        // Get the schema of each track and processor - use the schema cache if it matches
+        // this Sushi build and track layout, otherwise retrieve it from Sushi
+        std::vector<SushiProcessorSchema> schema;
+        std::vector<std::unordered_map<int, float>> values;
+        auto schema_key = _get_sushi_schema_key(tracks.second);
+        bool cached = _load_sushi_schema_cache(schema_key, schema);
+
+        // Bulk retrieve the param values for each track and processor
+        // If the cached schema does not match the values returned by Sushi, retrieve the
+        // schema from Sushi instead
+        if (!_get_sushi_schema_values(schema, values) && cached)
+        {
+            MSG("WARNING: Sushi schema cache does not match Sushi, retrieving from Sushi");
+            NINA_LOG_WARNING(NinaModule::DAW, "Sushi schema cache does not match Sushi, retrieving from Sushi");
+            cached = false;
+        }
+        if (!cached)
         {
-            // Initialise the track path as the track name + delimiter
-            std::string track_path = ti.name + "/";
-            track_params = _sushi_controller->parameter_controller()->get_track_parameters(ti.id);
+            schema = _get_sushi_schema(tracks.second);
+            _get_sushi_schema_values(schema, values);
+            _save_sushi_schema_cache(schema_key, schema);
+        }
+        MSG("Sushi schema " << (cached ? "retrieved from cache" : "retrieved from Sushi"));
 
-            // Get each parameter on the track
-            for (sushi_controller::ParameterInfo param : track_params.second)
+        // Register each param on each track and processor
+        // Note: These are registered as a batch, the params registry is published once
+        // they have all been registered
+        utils::begin_params_registration();
+        for (uint i=0; i<schema.size(); i++)
+        {
+            for (const sushi_controller::ParameterInfo& param : schema[i].params)
             {
-                // Use helper fn to fill out fields in our parameter struct. use track path to complete path
-                auto nina_param = DawManager::_cast_sushi_param(ti.id, param, track_path);
+                // Skip the param if its value was not retrieved
+                auto value = values[i].find(param.id);
+                if (value == values[i].end())
+                    continue;
+
+                // Use helper fn to fill out fields in our parameter struct. use processor path to complete path
+                auto nina_param = DawManager::_cast_sushi_param(schema[i].processor_id, param, schema[i].path_prefix, value->second);
                 if (nina_param)
                     utils::register_param(std::move(nina_param));
             }
-            track_processors = _sushi_controller->audio_graph_controller()->get_track_processors(ti.id);
-
-            // Get each processor on the track
-            for (sushi_controller::ProcessorInfo pi : track_processors.second)
-            {
-                std::string processor_path = track_path + pi.name + "/";
-                proc_params = _sushi_controller->parameter_controller()->get_processor_parameters(pi.id);
-
-                // Get each parameter on the processor
-                for (sushi_controller::ParameterInfo param : proc_params.second)
-                {
-                    // Use helper fn to fill out fields in our parameter struct. use track path to complete path
-                    auto nina_param = DawManager::_cast_sushi_param(pi.id, param, processor_path);
-                    if (nina_param)
-                        utils::register_param(std::move(nina_param));
-                }
-            }
+        }
+        utils::end_params_registration();
 
-            // Save the track ID if this is the main track
+        // Save the track ID if this is the main track
+        for (const sushi_controller::TrackInfo& ti : tracks.second)
+        {
             if (ti.name == MAIN_TRACK_NAME) {
                 _main_track_id = ti.id;
             }
         }
 
+        // Build the Sushi param table from the registered DAW params
+        _build_sushi_param_table();
+
         // Sushi tracks processed, so we can break from the retry loop
         break;        
     }
@@ -559,56 +1292,295 @@ void DawManager::_register_params()
 }
 
 //----------------------------------------------------------------------------
-// _cast_sushi_param
+// _retrieve_sushi_version
+//----------------------------------------------------------------------------
+void DawManager::_retrieve_sushi_version()
+{
+    // Retrieve the Sushi build info
+    auto build_info = _sushi_controller->system_controller()->get_build_info();
+    if (build_info.first == sushi_controller::ControlStatus::OK) {
+        _sushi_verson.version = build_info.second.version;
+        _sushi_verson.commit_hash = build_info.second.commit_hash;
+    }
+    else {
+        _sushi_verson.version = "Unknown";
+        _sushi_verson.commit_hash = "";
+    }    
+}
+
+//----------------------------------------------------------------------------
+// _get_sushi_schema_key
+//----------------------------------------------------------------------------
+std::string DawManager::_get_sushi_schema_key(const std::vector<sushi_controller::TrackInfo>& tracks)
+{
+    // The key is the Sushi version and commit hash, and the track layout (the ID and name
+    // of each track, and the identity of each processor on it)
+    // Note: The processor label and name identify the plugin loaded on the processor, and
+    // the param count changes with the plugin version - Sushi does not report the plugin
+    // version itself
+    std::string key = _sushi_verson.version + ":" + _sushi_verson.commit_hash;
+    for (const sushi_controller::TrackInfo& ti : tracks)
+    {
+        key += "|" + std::to_string(ti.id) + ":" + ti.name + ":";
+        auto track_processors = _sushi_controller->audio_graph_controller()->get_track_processors(ti.id);
+        for (const sushi_controller::ProcessorInfo& pi : track_processors.second)
+        {
+            key += std::to_string(pi.id) + ":" + pi.label + ":" + pi.name + ":" + std::to_string(pi.parameter_count) + ",";
+        }
+    }
+    return key;
+}
+
+//----------------------------------------------------------------------------
+// _get_sushi_schema
 //----------------------------------------------------------------------------
-std::unique_ptr<Param> DawManager::_cast_sushi_param(int processor_id, const sushi_controller::ParameterInfo &sushi_param, std::string path_prefix)
+std::vector<SushiProcessorSchema> DawManager::_get_sushi_schema(const std::vector<sushi_controller::TrackInfo>& tracks)
 {
-    // Get the param default value from the Sushi plugin
-    auto value = _sushi_controller->parameter_controller()->get_parameter_value(processor_id, sushi_param.id);
-    if (value.first == sushi_controller::ControlStatus::OK)
+    std::vector<SushiProcessorSchema> schema;
+
+    // Process each track
+    for (const sushi_controller::TrackInfo& ti : tracks)
     {
-        // Cast the Sushi param to a Nina Param
-        // We also ensure the param is not blacklisted
-        // Note: In the path replace any spaces with underscores
-        auto param = Param::CreateParam(this, std::regex_replace(path_prefix + sushi_param.name, std::regex{" "}, "_"));
-        if (!utils::param_is_blacklisted(param->get_path()))
+        // Initialise the track path as the track name + delimiter, and get each
+        // parameter on the track
+        std::string track_path = ti.name + "/";
+        auto track_params = _sushi_controller->parameter_controller()->get_track_parameters(ti.id);
+        schema.push_back(SushiProcessorSchema{ti.id, track_path, track_params.second});
+
+        // Get each processor on the track, and each parameter on the processor
+        auto track_processors = _sushi_controller->audio_graph_controller()->get_track_processors(ti.id);
+        for (const sushi_controller::ProcessorInfo& pi : track_processors.second)
         {
-            // Create the param
-            param->name = sushi_param.name;
-            param->set_value(value.second);
-            param->processor_id = processor_id;
-            param->param_id = sushi_param.id;
+            auto proc_params = _sushi_controller->parameter_controller()->get_processor_parameters(pi.id);
+            schema.push_back(SushiProcessorSchema{pi.id, track_path + pi.name + "/", proc_params.second});
+        }
+    }
+    return schema;
+}
 
-            // Check if this is a Mod Matrix param
-            if (param->get_path().substr(0, (sizeof("/daw/main/ninavst/Mod_")-1)) == "/daw/main/ninavst/Mod_")
+//----------------------------------------------------------------------------
+// _get_sushi_schema_values
+//----------------------------------------------------------------------------
+bool DawManager::_get_sushi_schema_values(const std::vector<SushiProcessorSchema>& schema, std::vector<std::unordered_map<int, float>>& values)
+{
+    bool ret = true;
+
+    // Bulk retrieve the param values for each track and processor
+    values.clear();
+    values.resize(schema.size());
+    for (uint i=0; i<schema.size(); i++)
+    {
+        auto param_values = _sushi_controller->parameter_controller()->get_parameter_values(schema[i].processor_id);
+        if (param_values.first == sushi_controller::ControlStatus::OK)
+        {
+            for (const sushi_controller::ParameterValue& pv : param_values.second)
             {
-                // Find the modulation src/dst delimiter
-                auto src_dst_str = param->get_path().substr((sizeof("/daw/main/ninavst/Mod_")-1),
-                                                            (param->get_path().size() - (sizeof("/daw/main/ninavst/Mod_")-1)));
-                int pos = src_dst_str.find(':');
-                if (pos != -1)
-                {
-                    // Get the modulation source name
-                    auto src_name = src_dst_str.substr(0, pos);
+                values[i].emplace(pv.parameter_id, pv.value);
+            }
+        }
 
-                    // If the position for the destination is valid
-                    if (((uint)pos + 1) < src_dst_str.size())
-                    {
-                        // Get the modulation destination name
-                        auto dst_name = src_dst_str.substr((pos + 1), (src_dst_str.size() - pos));
+        // Check a value was returned for each param in the schema, and that Sushi did not
+        // return a value for a param not in the schema (a new or renamed param)
+        for (const sushi_controller::ParameterInfo& param : schema[i].params)
+        {
+            if (values[i].count(param.id) == 0)
+            {
+                ret = false;
+                break;
+            }
+        }
+        if (values[i].size() != schema[i].params.size())
+        {
+            ret = false;
+        }
+    }
+    return ret;
+}
 
-                        // Indicate this param is a valid modulation matrix entry
-                        param->mod_matrix_param = true;
-                        param->mod_src_name = std::regex_replace(src_name, std::regex{"_"}, " ");
-                        param->mod_dst_name = std::regex_replace(dst_name, std::regex{"_"}, " ");    
-                    }
-                }
+//----------------------------------------------------------------------------
+// _load_sushi_schema_cache
+//----------------------------------------------------------------------------
+bool DawManager::_load_sushi_schema_cache(const std::string& key, std::vector<SushiProcessorSchema>& schema)
+{
+    char read_buffer[65536];
+    rapidjson::Document json_data;
+
+    // Don't use the cache if the Sushi commit hash is not known
+    if (_sushi_verson.commit_hash.empty())
+        return false;
+
+    // Open and parse the schema cache file
+    FILE *fp = ::fopen(NINA_UDATA_FILE_PATH(SUSHI_SCHEMA_CACHE_FILE).c_str(), "r");
+    if (fp == nullptr)
+        return false;
+    rapidjson::FileReadStream is(fp, read_buffer, sizeof(read_buffer));
+    json_data.ParseStream(is);
+    fclose(fp);
+
+    // Check the cache is valid and for this Sushi build and track layout
+    if (json_data.HasParseError() || !json_data.IsObject() ||
+        !json_data.HasMember("version") || !json_data["version"].IsUint() || (json_data["version"].GetUint() != SUSHI_SCHEMA_CACHE_VERSION) ||
+        !json_data.HasMember("key") || !json_data["key"].IsString() || (key != json_data["key"].GetString()) ||
+        !json_data.HasMember("processors") || !json_data["processors"].IsArray())
+    {
+        return false;
+    }
+
+    // Parse each track and processor
+    schema.clear();
+    for (const rapidjson::Value& processor : json_data["processors"].GetArray())
+    {
+        if (!processor.IsObject() ||
+            !processor.HasMember("id") || !processor["id"].IsInt() ||
+            !processor.HasMember("path") || !processor["path"].IsString() ||
+            !processor.HasMember("params") || !processor["params"].IsArray())
+        {
+            schema.clear();
+            return false;
+        }
+        SushiProcessorSchema processor_schema{processor["id"].GetInt(), processor["path"].GetString(), {}};
+
+        // Parse each param
+        for (const rapidjson::Value& param : processor["params"].GetArray())
+        {
+            if (!param.IsObject() ||
+                !param.HasMember("id") || !param["id"].IsInt() ||
+                !param.HasMember("name") || !param["name"].IsString())
+            {
+                schema.clear();
+                return false;
             }
-            return param;
+            auto param_info = sushi_controller::ParameterInfo();
+            param_info.id = param["id"].GetInt();
+            param_info.name = param["name"].GetString();
+            processor_schema.params.push_back(param_info);
+        }
+        schema.push_back(processor_schema);
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _save_sushi_schema_cache
+//----------------------------------------------------------------------------
+void DawManager::_save_sushi_schema_cache(const std::string& key, const std::vector<SushiProcessorSchema>& schema)
+{
+    char write_buffer[65536];
+
+    // Don't cache the schema if the Sushi commit hash is not known
+    if (_sushi_verson.commit_hash.empty())
+        return;
+
+    // Write the schema cache to a temporary file
+    auto file_path = NINA_UDATA_FILE_PATH(SUSHI_SCHEMA_CACHE_FILE);
+    auto tmp_file_path = file_path + ".tmp";
+    FILE *fp = ::fopen(tmp_file_path.c_str(), "w");
+    if (fp == nullptr)
+    {
+        NINA_LOG_ERROR(module(), "An error occurred ({}) writing the file: {}", errno, tmp_file_path);
+        return;
+    }
+    rapidjson::FileWriteStream os(fp, write_buffer, sizeof(write_buffer));
+    rapidjson::Writer<rapidjson::FileWriteStream> writer(os);
+    writer.StartObject();
+    writer.Key("version");
+    writer.Uint(SUSHI_SCHEMA_CACHE_VERSION);
+    writer.Key("key");
+    writer.String(key.c_str());
+    writer.Key("processors");
+    writer.StartArray();
+    for (const SushiProcessorSchema& processor_schema : schema)
+    {
+        writer.StartObject();
+        writer.Key("id");
+        writer.Int(processor_schema.processor_id);
+        writer.Key("path");
+        writer.String(processor_schema.path_prefix.c_str());
+        writer.Key("params");
+        writer.StartArray();
+        for (const sushi_controller::ParameterInfo& param : processor_schema.params)
+        {
+            writer.StartObject();
+            writer.Key("id");
+            writer.Int(param.id);
+            writer.Key("name");
+            writer.String(param.name.c_str());
+            writer.EndObject();
         }
+        writer.EndArray();
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    os.Flush();
+    fclose(fp);
+
+    // Replace the schema cache file
+    if (std::rename(tmp_file_path.c_str(), file_path.c_str()) != 0)
+    {
+        NINA_LOG_ERROR(module(), "An error occurred ({}) writing the file: {}", errno, file_path);
+        std::remove(tmp_file_path.c_str());
+    }
+}
+
+//----------------------------------------------------------------------------
+// _cast_sushi_param
+//----------------------------------------------------------------------------
+std::unique_ptr<Param> DawManager::_cast_sushi_param(int processor_id, const sushi_controller::ParameterInfo &sushi_param, std::string path_prefix, float value)
+{
+    // Cast the Sushi param to a Nina Param
+    // We also ensure the param is not blacklisted
+    // Note: In the path replace any spaces with underscores
+    auto param = Param::CreateParam(this, std::regex_replace(path_prefix + sushi_param.name, std::regex{" "}, "_"));
+    if (!utils::param_is_blacklisted(param->get_path()))
+    {
+        // Create the param
+        param->name = sushi_param.name;
+        param->set_value(value);
+        param->processor_id = processor_id;
+        param->param_id = sushi_param.id;
+
+        // Check if this is a Mod Matrix param
+        if (param->get_path().substr(0, (sizeof("/daw/main/ninavst/Mod_")-1)) == "/daw/main/ninavst/Mod_")
+        {
+            // Find the modulation src/dst delimiter
+            auto src_dst_str = param->get_path().substr((sizeof("/daw/main/ninavst/Mod_")-1),
+                                                        (param->get_path().size() - (sizeof("/daw/main/ninavst/Mod_")-1)));
+            int pos = src_dst_str.find(':');
+            if (pos != -1)
+            {
+                // Get the modulation source name
+                auto src_name = src_dst_str.substr(0, pos);
+
+                // If the position for the destination is valid
+                if (((uint)pos + 1) < src_dst_str.size())
+                {
+                    // Get the modulation destination name
+                    auto dst_name = src_dst_str.substr((pos + 1), (src_dst_str.size() - pos));
 
-        // If we get here the param is blacklisted
-        NINA_LOG_INFO(NinaModule::DAW, "DAW param blacklisted: {}", param->get_path());
+                    // Indicate this param is a valid modulation matrix entry
+                    param->mod_matrix_param = true;
+                    param->mod_src_name = std::regex_replace(src_name, std::regex{"_"}, " ");
+                    param->mod_dst_name = std::regex_replace(dst_name, std::regex{"_"}, " ");    
+                }
+            }
+        }
+        return param;
     }
+
+    // If we get here the param is blacklisted
+    NINA_LOG_INFO(NinaModule::DAW, "DAW param blacklisted: {}", param->get_path());
+    return nullptr;
+}
+
+//----------------------------------------------------------------------------
+// _process_sushi_writes
+//----------------------------------------------------------------------------
+static void *_process_sushi_writes(void* data)
+{
+    auto daw_manager = static_cast<DawManager*>(data);
+    daw_manager->process_sushi_writes();
+
+    // To suppress warnings
     return nullptr;
 }
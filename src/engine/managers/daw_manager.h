@@ -15,6 +15,7 @@
 #include "param.h"
 #include "event_router.h"
 #include "sushi_client.h"
+#include "sushi_write_queue.h"
 
 // Sushi version
 struct SushiVersion
@@ -23,6 +24,55 @@ struct SushiVersion
     std::string commit_hash;
 };
 
+// Constants
+constexpr uint NUM_SUSHI_PARAM_STATES = 2;
+constexpr float UNKNOWN_SENT_VALUE    = -1.0f;
+
+// Sushi param cache entry
+// The DAW param for a Sushi processor/parameter ID, the last value notified by Sushi, and
+// the last value sent to Sushi for each layer and state (UNKNOWN_SENT_VALUE if not known)
+// Note: Param values are always 0.0 to 1.0, so a negative value is never a sent value - a NaN
+// cannot be used as it never compares as expected when built with -ffast-math
+struct SushiParamCacheEntry
+{
+    SushiParamCacheEntry()
+    {
+        param = nullptr;
+        value = 0.0;
+        dirty = false;
+        trace_id = NO_LATENCY_TRACE_ID;
+        for (auto& layer_values : sent_values)
+            std::fill(std::begin(layer_values), std::end(layer_values), UNKNOWN_SENT_VALUE);
+    }
+    Param *param;
+    float value;
+    bool dirty;
+    LatencyTraceId trace_id;
+    float sent_values[NUM_LAYERS][NUM_SUSHI_PARAM_STATES];
+};
+
+// Sushi processor schema
+// The params of a Sushi track or processor, and the path prefix of those params
+struct SushiProcessorSchema
+{
+    int processor_id;
+    std::string path_prefix;
+    std::vector<sushi_controller::ParameterInfo> params;
+};
+
+// Sushi write stats
+// The number of param writes queued and coalesced, the size and RPC round-trip
+// time of each batch sent to Sushi, and the number of patch values sent and skipped
+struct SushiWriteStats
+{
+    std::atomic<uint64_t> num_writes{0};
+    std::atomic<uint64_t> num_coalesced{0};
+    std::atomic<uint64_t> num_patch_values_sent{0};
+    std::atomic<uint64_t> num_patch_values_skipped{0};
+    EventLatencyHistogram batch_size;   // Note: Records the number of writes, not a duration
+    EventLatencyHistogram rpc_time;
+};
+
 // DAW Manager class
 class DawManager: public BaseManager
 {
@@ -34,17 +84,25 @@ public:
     ~DawManager();
 
     // Public functions
+    bool start();
+    void stop();
     void process();
     void process_event(const BaseEvent *event);
     void process_midi_event_direct(const snd_seq_event_t *event);
     bool get_patch_state_params();
-    void set_patch_layer_params(uint layer_num);
-    void set_patch_params(uint layer_num, bool include_cmn_params, PatchState state);
+    void set_patch_layer_params(uint layer_num, bool force_full=false);
+    void set_patch_params(uint layer_num, bool include_cmn_params, PatchState state, bool force_full=false);
+    void begin_patch_batch();
+    void end_patch_batch();
+    void invalidate_sushi_param_shadow();
     void set_param(uint layer_num, const Param *param);
     void set_param(uint layer_num, const Param *param, float value);
     void set_param_direct(uint layer_mask, const Param *param);
     void set_param_all_layers(const Param *param);
     SushiVersion get_sushi_version();
+    void process_sushi_writes();
+    const SushiWriteStats& sushi_write_stats() const;
+    void log_event_stats(bool reset=true);
 #if defined CHECK_LAYERS_LOAD
     std::vector<std::pair<Param *,float>> get_param_values(bool state_only);
 #endif
@@ -59,14 +117,56 @@ private:
     std::shared_ptr<sushi_controller::SushiController> _sushi_controller;
     int _main_track_id;
     SushiVersion _sushi_verson;
+    Param *_morphing_param;
+    snd_seq_t *_note_seq_handle;
+    int _note_seq_port;
+    std::mutex _note_seq_mutex;
+    std::mutex _sushi_param_cache_mutex;
+    std::vector<std::vector<SushiParamCacheEntry>> _sushi_param_table;
+    std::vector<SushiParamCacheEntry *> _sushi_param_cache_dirty;
+    int _sushi_layer_state[NUM_LAYERS];
+    std::thread *_sushi_writer_thread;
+    bool _run_sushi_writer_thread;
+    std::mutex _sushi_write_mutex;
+    std::mutex _sushi_rpc_mutex;
+    std::condition_variable _sushi_write_cv;
+    SushiWriteQueue _pending_sushi_writes;
+    std::vector<sushi_controller::ParameterValue> _sushi_write_batch;
+    std::vector<LatencyTraceId> _sushi_write_batch_trace_ids;
+    bool _patch_batch_active;
+    std::vector<sushi_controller::ParameterValue> _patch_batch_values;
+    bool _patch_batch_set_tempo;
+    float _patch_batch_tempo;
+    SushiWriteStats _sushi_write_stats;
 
     // Private functions
     void _process_midi_event(const snd_seq_event_t &data);
     void _process_param_changed_event(const ParamChange &data);
+    bool _open_note_seq();
+    void _close_note_seq();
+    bool _send_note_seq_event(snd_seq_event_t &event);
+    void _queue_sushi_write(int processor_id, int parameter_id, float value, LatencyTraceId trace_id=NO_LATENCY_TRACE_ID);
+    void _flush_sushi_writes();
+    void _flush_sushi_writes_locked();
+    void _add_patch_param_value(std::vector<sushi_controller::ParameterValue>& param_values, const Param *param, uint layer_num, bool force_full);
+    void _send_patch_param_values(const std::vector<sushi_controller::ParameterValue>& param_values, uint layer_num);
+    void _set_layer_state(const Param *layer_state_param, uint layer_num, int value);
+    void _set_tempo(float tempo);
+    void _set_sent_values(SushiParamCacheEntry &entry, uint layers_mask, float value);
+    void _invalidate_sent_values(uint layers_mask);
     void _param_update_notification(int processor_id, int parameter_id, float value);
+    void _build_sushi_param_table();
+    inline SushiParamCacheEntry *_get_sushi_param_entry(int processor_id, int parameter_id);
+    inline int _decode_param_id(int parameter_id, uint& layers_mask);
     inline int _encode_param_id(int parameter_id, uint layers_mask);
     void _register_params();
-    std::unique_ptr<Param> _cast_sushi_param(int processor_id, const sushi_controller::ParameterInfo &sushi_param, std::string path_prefix);
+    void _retrieve_sushi_version();
+    std::string _get_sushi_schema_key(const std::vector<sushi_controller::TrackInfo>& tracks);
+    std::vector<SushiProcessorSchema> _get_sushi_schema(const std::vector<sushi_controller::TrackInfo>& tracks);
+    bool _get_sushi_schema_values(const std::vector<SushiProcessorSchema>& schema, std::vector<std::unordered_map<int, float>>& values);
+    bool _load_sushi_schema_cache(const std::string& key, std::vector<SushiProcessorSchema>& schema);
+    void _save_sushi_schema_cache(const std::string& key, const std::vector<SushiProcessorSchema>& schema);
+    std::unique_ptr<Param> _cast_sushi_param(int processor_id, const sushi_controller::ParameterInfo &sushi_param, std::string path_prefix, float value);
 };
 
 #endif  // _DAW_MANAGER_H
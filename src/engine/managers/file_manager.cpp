@@ -13,6 +13,13 @@
 #include <dirent.h>
 #include <sys/stat.h>
 #include <regex>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <future>
+#include <functional>
 #include "file_manager.h"
 #include "midi_device_manager.h"
 #include "arpeggiator_manager.h"
@@ -39,7 +46,7 @@ constexpr char DEFAULT_LAYERS_FILE[]                    = "ONE_LAYER.json";
 constexpr char DEFAULT_PATCH_FILE[]                     = "BASIC_PATCH.json";
 constexpr char INIT_PATCH_FILE[]                        = "INIT_PATCH.json";
 #ifdef INCLUDE_PATCH_HISTORY 
-constexpr char PATCH_HISTORY_FILE[]                     = "patch_history.json";
+constexpr char PATCH_HISTORY_FILE[]                     = "patch_history.bin";
 #endif
 constexpr char GLOBAL_PARAMS_FILE[]                     = "global_params.json";
 #ifdef INCLUDE_PATCH_HISTORY 
@@ -48,20 +55,27 @@ constexpr uint SAVE_PATCH_HISTORY_IDLE_INTERVAL_US      = std::chrono::duration_
 constexpr uint SAVE_CONFIG_FILE_IDLE_INTERVAL_US        = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::seconds(2)).count();
 constexpr uint SAVE_LAYERS_FILE_IDLE_INTERVAL_US        = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::seconds(2)).count();
 constexpr uint SAVE_GLOBAL_PARAMS_FILE_IDLE_INTERVAL_US = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::seconds(2)).count();
-#ifdef INCLUDE_PATCH_HISTORY 
-constexpr uint PATCH_HISTORY_MAX_EVENTS                 = 1000;
-#endif
 constexpr char STATE_PARAM_PATH_PREFIX[]                = "/state/";
 constexpr char MULTIFN_SWITCH_PATH[]                    = "sys/multifn_switch";
 constexpr uint DEFAULT_PATCH_MODIFIED_THRESHOLD         = std::chrono::seconds(120).count();
 constexpr uint DEFAULT_DEMO_MODE_TIMEOUT                = std::chrono::seconds(300).count();
 constexpr char DEFAULT_SYSTEM_COLOUR[]                  = "FF0000";
+constexpr char NOTE_TRANSPORT_GRPC[]                    = "grpc";
+constexpr char NOTE_TRANSPORT_ALSA_SEQ[]                = "alsa_seq";
+constexpr int JSON_SAVE_THREAD_NICE_VALUE               = 10;
+constexpr int PATCH_PREFETCH_THREAD_NICE_VALUE          = 10;
+constexpr uint PATCH_PREFETCH_DISTANCE                  = 2;
+
+// Static functions
+static void *_process_json_saves(void* data);
+static void *_process_patch_prefetches(void* data);
 
 //----------------------------------------------------------------------------
 // FileManager
 //----------------------------------------------------------------------------
 FileManager::FileManager(EventRouter *event_router) : 
-    BaseManager(NinaModule::FILE_MANAGER, MANAGER_NAME, event_router)
+    BaseManager(NinaModule::FILE_MANAGER, MANAGER_NAME, event_router, false, true),
+    _patch_cache(NINA_UDATA_FILE_PATH(PATCH_CACHE_DIR))
 {
     // Initialise class data
     _daw_manager = 0;
@@ -85,9 +99,19 @@ FileManager::FileManager(EventRouter *event_router) :
     _morph_value_param = 0;
     _morph_knob_param = 0;
     _patch_json_doc = nullptr;
+    _json_save_thread = 0;
+    _run_json_save_thread = true;
+    _patch_prefetch_thread = 0;
+    _run_patch_prefetch_thread = true;
 
     // Open the param blacklist file and parse it
     _open_and_parse_param_blacklist_file();
+
+    // Create a low priority thread to write the saved JSON files
+    _json_save_thread = new std::thread(_process_json_saves, this);
+
+    // Create a low priority thread to prefetch patches into the patch cache
+    _patch_prefetch_thread = new std::thread(_process_patch_prefetches, this);
 }
 
 //----------------------------------------------------------------------------
@@ -95,6 +119,35 @@ FileManager::FileManager(EventRouter *event_router) :
 //----------------------------------------------------------------------------
 FileManager::~FileManager()
 {
+    // Patch prefetch task running?
+    if (_patch_prefetch_thread != 0)
+    {
+        // Stop the patch prefetch task
+        {
+            std::lock_guard<std::mutex> lock(_patch_prefetch_mutex);
+            _run_patch_prefetch_thread = false;
+        }
+        _patch_prefetch_cv.notify_one();
+        if (_patch_prefetch_thread->joinable())
+            _patch_prefetch_thread->join();
+        _patch_prefetch_thread = 0;
+    }
+
+    // JSON save task running?
+    if (_json_save_thread != 0)
+    {
+        // Stop the JSON save task
+        // Note: Any pending saves are written before the task exits
+        {
+            std::lock_guard<std::mutex> lock(_json_save_mutex);
+            _run_json_save_thread = false;
+        }
+        _json_save_cv.notify_all();
+        if (_json_save_thread->joinable())
+            _json_save_thread->join();
+        _json_save_thread = 0;
+    }
+
     // Delete the listeners
     if (_arp_listener)
         delete _arp_listener;
@@ -142,9 +195,51 @@ bool FileManager::start()
     {
         // Get the DAW manager
         _daw_manager = static_cast<DawManager *>(utils::get_manager(NinaModule::DAW));
-    
-        // Open the config file and parse it
-        if (!_open_config_file())
+
+        // Read and validate the startup files in parallel
+        // These files are independent of each other, and reading, parsing and validating
+        // them against their schemas is the bulk of the File Manager startup time
+        // Each file is read into its own document, and then applied below in dependency
+        // order, as the param registry is not thread safe
+        // Note: The documents must be declared before the reads, so that if startup fails
+        // each read has completed before its document is destroyed
+        auto startup_time = std::chrono::steady_clock::now();
+        auto step_time = startup_time;
+        rapidjson::Document system_colours_json_data;
+        rapidjson::Document param_aliases_json_data;
+        rapidjson::Document param_attributes_json_data;
+        rapidjson::Document param_lists_json_data;
+        rapidjson::Document haptic_modes_json_data;
+        auto config_read = _read_startup_file(CONFIG_FILE, [this]() {
+            return _open_config_file();
+        });
+        auto system_colours_read = _read_startup_file(SYSTEM_COLOURS_FILE, [this, &system_colours_json_data]() {
+            return _open_system_colours_file(system_colours_json_data);
+        });
+        auto param_aliases_read = _read_startup_file(PARAM_ALIASES_FILE, [this, &param_aliases_json_data]() {
+            return _open_param_aliases_file(param_aliases_json_data);
+        });
+        auto param_map_read = _read_startup_file(PARAM_MAP_FILE, [this]() {
+            return _open_param_map_file();
+        });
+        auto param_attributes_read = _read_startup_file(PARAM_ATTRIBUTES_FILE, [this, &param_attributes_json_data]() {
+            return _open_param_attributes_file(param_attributes_json_data);
+        });
+        auto param_lists_read = _read_startup_file(PARAM_LISTS_FILE, [this, &param_lists_json_data]() {
+            return _open_param_lists_file(param_lists_json_data);
+        });
+        auto global_params_read = _read_startup_file(GLOBAL_PARAMS_FILE, [this]() {
+            return _open_global_params_file();
+        });
+        auto init_patch_read = _read_startup_file(INIT_PATCH_FILE, [this]() {
+            return _open_patch_file(NINA_ROOT_FILE_PATH(INIT_PATCH_FILE), _init_patch_json_data);
+        });
+        auto haptic_modes_read = _read_startup_file(HAPTIC_MODES_FILE, [this, &haptic_modes_json_data]() {
+            return _open_haptic_modes_file(haptic_modes_json_data);
+        });
+
+        // Parse the config file
+        if (!config_read.get())
         {
             // This is a critical error
             MSG("An error occurred opening the config file: " << NINA_UDATA_FILE_PATH(CONFIG_FILE));
@@ -152,15 +247,24 @@ bool FileManager::start()
             return false;
         }
         _parse_config();
+        _log_startup_step(CONFIG_FILE, step_time);
 
-        // Open the psystem colours file and parse it
-        _open_and_parse_system_colours_file();        
+        // Parse the system colours
+        // Note: Needs to be done after the config has been parsed, as it is checked for the
+        // current system colour
+        if (system_colours_read.get()) {
+            _parse_system_colours(system_colours_json_data);
+        }
+        _log_startup_step(SYSTEM_COLOURS_FILE, step_time);
 
-        // Open the param aliases file and parse it
-        _open_and_parse_param_aliases_file();
+        // Parse the param aliases
+        if (param_aliases_read.get()) {
+            _parse_param_aliases(param_aliases_json_data);
+        }
+        _log_startup_step(PARAM_ALIASES_FILE, step_time);
 
-        // Open the param map file and parse it
-        if (!_open_param_map_file())
+        // Parse the param map
+        if (!param_map_read.get())
         {
             // This is a critical error
             MSG("An error occurred opening the param map file: " << NINA_ROOT_FILE_PATH(PARAM_MAP_FILE));
@@ -168,36 +272,41 @@ bool FileManager::start()
             return false;
         }
         _parse_param_map();
+        _log_startup_step(PARAM_MAP_FILE, step_time);
 
-        // Open and parse the param attributes
-        if (!_open_and_parse_param_attributes_file())
+        // Parse the param attributes
+        if (!param_attributes_read.get() || !_parse_param_attributes(param_attributes_json_data))
         {
             // Log the error
             MSG("An error occurred opening param attributes file: " << NINA_ROOT_FILE_PATH(PARAM_ATTRIBUTES_FILE));
             NINA_LOG_ERROR(module(), "An error occurred opening param attributes file: {}", NINA_ROOT_FILE_PATH(PARAM_ATTRIBUTES_FILE));          
-        }        
+        }
+        _log_startup_step(PARAM_ATTRIBUTES_FILE, step_time);
 
-        // Open and parse the param lists
-        if (!_open_and_parse_param_lists_file())
+        // Parse the param lists
+        if (!param_lists_read.get() || !_parse_param_lists(param_lists_json_data))
         {
             // Log the error
             MSG("An error occurred opening param lists file: " << NINA_ROOT_FILE_PATH(PARAM_LISTS_FILE));
             NINA_LOG_ERROR(module(), "An error occurred opening param lists file: {}", NINA_ROOT_FILE_PATH(PARAM_LISTS_FILE));          
         }
+        _log_startup_step(PARAM_LISTS_FILE, step_time);
 
-        // Open and parse the global params
-        if (!_open_and_parse_global_params_file()) {
+        // Parse the global params
+        if (!global_params_read.get() || !_parse_global_params()) {
             // Log the error
             MSG("An error occurred opening global params file: " << NINA_UDATA_FILE_PATH(GLOBAL_PARAMS_FILE));
             NINA_LOG_ERROR(module(), "An error occurred opening global params file: {}", NINA_UDATA_FILE_PATH(GLOBAL_PARAMS_FILE));              
         }
+        _log_startup_step(GLOBAL_PARAMS_FILE, step_time);
 
-        // Open and check the init patch file
-        if (!_open_patch_file(NINA_ROOT_FILE_PATH(INIT_PATCH_FILE), _init_patch_json_data)) {
+        // Check the init patch file
+        if (!init_patch_read.get()) {
             // Log the error
             MSG("An error occurred opening INIT patch file: " << NINA_ROOT_FILE_PATH(INIT_PATCH_FILE));
             NINA_LOG_ERROR(module(), "An error occurred opening INIT patch file: {}", NINA_UDATA_FILE_PATH(GLOBAL_PARAMS_FILE));              
-        }        
+        }
+        _log_startup_step(INIT_PATCH_FILE, step_time);
 
         // Initialise the utils LFO and MPE handling
         // Needs to be done here after the param atttributes have been processed, but before the patch is parsed
@@ -223,6 +332,7 @@ bool FileManager::start()
             _save_current_layers_file();
         }
         MSG("Loaded Layers config: " << _get_layers_filename(utils::system_config()->get_layers_num()));
+        _log_startup_step("layers", step_time);
 
         // Indicate we are now loading Layers with the DAW
         _set_loading_layers_with_daw(true);
@@ -234,6 +344,11 @@ bool FileManager::start()
         // Get the Morph Value param for patch processing
         _morph_value_param = utils::get_param_from_ref(utils::ParamRef::MORPH_VALUE);
 
+        // Open the patch for each layer in parallel, and push the patches to the DAW as
+        // a single batch
+        auto layer_patch_reads = _open_layer_patch_files();
+        _daw_manager->begin_patch_batch();
+
         // Now Parse the patch data for each layer
         for (int i=(NUM_LAYERS-1); i>=0; i--) {
             utils::set_current_layer(i);
@@ -241,7 +356,7 @@ bool FileManager::start()
             utils::get_current_layer_info().set_patch_modified(false);
             utils::get_current_layer_info().set_patch_state(PatchState::STATE_A);           
             _patch_json_doc = &_layer_patch_json_doc[i];
-            if (!_open_patch_file(utils::get_layer_info(i).get_patch_id())) {
+            if (!layer_patch_reads[i].get()) {
                 // This error is typically due to the bank not existing
                 // Set the Patch ID to be BANK 001, PATCH 001 so that the UI will still run
                 MSG("The patch with BANK: " << utils::get_layer_info(i).get_patch_id().bank_num << " PATCH: " << utils::get_layer_info(i).get_patch_id().patch_num << " does not exist");
@@ -252,6 +367,7 @@ bool FileManager::start()
                 if (!_open_patch_file(utils::get_layer_info(i).get_patch_id())) {
                     // This is a critical error that we cannot recover from, the error is logged
                     // in the above call
+                    _daw_manager->end_patch_batch();
                     return false;
                 }
             }
@@ -264,6 +380,8 @@ bool FileManager::start()
                 utils::get_layer_info(i).set_morph_value(0.0f);    
             MSG("Loaded Layer " << (i+1) << " patch: " << _get_patch_filename(utils::get_layer_info(i).get_patch_id()));
         }
+        _daw_manager->end_patch_batch();
+        _log_startup_step("layer patches", step_time);
 
         // Indicate we have finished loading Layers with the DAW
         _set_loading_layers_with_daw(false);
@@ -282,32 +400,46 @@ bool FileManager::start()
         _check_layers_load();
 #endif
 
-        // Open the haptic modes file and parse it
-        if (!_open_and_parse_haptic_modes_file())
+        // Parse the haptic modes
+        if (!haptic_modes_read.get() || !_parse_haptic_modes(haptic_modes_json_data))
         {
             // Log the error
             MSG("An error occurred opening haptic modes file: " << NINA_ROOT_FILE_PATH(HAPTIC_MODES_FILE));
             NINA_LOG_ERROR(module(), "An error occurred opening haptic modes file: {}", NINA_ROOT_FILE_PATH(HAPTIC_MODES_FILE));          
         }
+        _log_startup_step(HAPTIC_MODES_FILE, step_time);
 
 #ifdef INCLUDE_PATCH_HISTORY 
-        // Open (and create if needed) the patch history file
-        if (!_open_patch_history_file())
+        // Open (and create if needed) the patch history journal
+        // If the app did not exit cleanly, any unsaved edits to the loaded patches are
+        // recovered from the journal
+        std::vector<PatchHistoryEntry> recovered_entries;
+        if (!_patch_history.open(NINA_UDATA_FILE_PATH(PATCH_HISTORY_FILE), _get_layer_patch_ids(), recovered_entries))
         {
-            // Delete the file and try again
-            ::unlink(NINA_UDATA_FILE_PATH(PATCH_HISTORY_FILE).c_str());
-            if (!_open_patch_history_file())
-            {            
-                // This is a critical error
-                MSG("An error occurred opening patch history file: " << NINA_UDATA_FILE_PATH(PATCH_HISTORY_FILE));
-                NINA_LOG_CRITICAL(module(), "An error occurred opening patch history file: {}", NINA_UDATA_FILE_PATH(PATCH_HISTORY_FILE));
-                return false;
-            }            
+            // This is a critical error
+            MSG("An error occurred opening patch history file: " << NINA_UDATA_FILE_PATH(PATCH_HISTORY_FILE));
+            NINA_LOG_CRITICAL(module(), "An error occurred opening patch history file: {}", NINA_UDATA_FILE_PATH(PATCH_HISTORY_FILE));
+            return false;
+        }
+        if (recovered_entries.size() > 0)
+        {
+            // Apply the recovered edits
+            std::lock_guard<std::mutex> guard(_patch_mutex);
+            for (const auto& entry : recovered_entries) {
+                _apply_patch_history_value(entry, entry.value);
+            }
+            MSG("Recovered " << recovered_entries.size() << " unsaved param changes");
+            NINA_LOG_INFO(module(), "Recovered {} unsaved param changes", recovered_entries.size());
         }
 #endif
         // Get the morph knob param, if any
         _morph_knob_param = utils::get_morph_knob_param();
         utils::set_morph_on(true);
+
+        // Log the total File Manager startup time
+        auto total_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startup_time);
+        MSG("File Manager startup: " << total_time.count() << "ms");
+        NINA_LOG_INFO(module(), "File Manager startup: {}ms", total_time.count());
     }
     catch(const std::exception& e)
     {
@@ -334,6 +466,17 @@ void FileManager::stop()
     _save_global_params_file_timer->stop();
     _save_layers_file_timer->stop();
 
+#ifdef INCLUDE_PATCH_HISTORY
+    // Close the patch history journal
+    {
+        std::lock_guard<std::mutex> guard(_patch_mutex);
+        _patch_history.close();
+    }
+#endif
+
+    // Make sure all saved files have been written
+    _wait_for_json_saves();
+
     // Call the base manager function
     BaseManager::stop();
 }
@@ -399,13 +542,106 @@ void FileManager::process_event(const BaseEvent *event)
     }
 }
 
+//----------------------------------------------------------------------------
+// process_json_saves
+//----------------------------------------------------------------------------
+void FileManager::process_json_saves()
+{
+    // Lower the priority of this thread so that writing files never competes with
+    // the UI and event processing
+    (void)::setpriority(PRIO_PROCESS, ::syscall(SYS_gettid), JSON_SAVE_THREAD_NICE_VALUE);
+
+    // Do forever (until the thread is exited)
+    std::unique_lock<std::mutex> lock(_json_save_mutex);
+    while (true)
+    {
+        // Wait for a file save to be queued
+        _json_save_cv.wait(lock, [this]{ return !_pending_json_saves.empty() || !_run_json_save_thread; });
+
+        // Exit the thread if requested and there are no more saves
+        if (_pending_json_saves.empty())
+            break;
+
+        // Take the next file to write
+        // Note: Any later save of the same file queued while this one is being written
+        // replaces the pending snapshot, so repeated saves are coalesced
+        auto itr = _pending_json_saves.begin();
+        auto file_path = itr->first;
+        auto json_data = std::move(itr->second.first);
+        bool cache_patch = itr->second.second;
+        _pending_json_saves.erase(itr);
+        _json_save_in_progress = file_path;
+
+        // Write the file, and if this is a patch update the patch cache
+        lock.unlock();
+        if (_write_json_file(file_path, *json_data) && cache_patch) {
+            _patch_cache.save(file_path, *json_data);
+        }
+        json_data.reset();
+        lock.lock();
+
+        // Indicate the file has been written
+        _json_save_in_progress.clear();
+        _json_save_cv.notify_all();
+    }
+}
+
+//----------------------------------------------------------------------------
+// process_patch_prefetches
+//----------------------------------------------------------------------------
+void FileManager::process_patch_prefetches()
+{
+    const char *schema =
+#include "../json_schemas/patch_schema.json"
+;
+    std::vector<PatchId> patch_ids;
+
+    // Lower the priority of this thread so that prefetching never competes with
+    // the UI and event processing
+    (void)::setpriority(PRIO_PROCESS, ::syscall(SYS_gettid), PATCH_PREFETCH_THREAD_NICE_VALUE);
+
+    // Do forever (until the thread is exited)
+    while (true)
+    {
+        // Wait for patches to prefetch
+        {
+            std::unique_lock<std::mutex> lock(_patch_prefetch_mutex);
+            _patch_prefetch_cv.wait(lock, [this]{ return !_pending_patch_prefetches.empty() || !_run_patch_prefetch_thread; });
+            if (!_run_patch_prefetch_thread)
+                break;
+            patch_ids.swap(_pending_patch_prefetches);
+        }
+
+        // Prefetch each patch that is not already held in memory
+        for (const PatchId& id : patch_ids)
+        {
+            auto file_path = _get_patch_filename(id);
+            if (!file_path.empty() && !_patch_cache.in_memory(file_path)) {
+                // Load the patch from the binary cache, or if not cached yet from the
+                // JSON patch file
+                rapidjson::Document json_doc;
+                if (!_patch_cache.load(file_path, json_doc) &&
+                    _open_json_file(file_path, schema, json_doc, false, "{}") && json_doc.IsObject()) {
+                    _patch_cache.save(file_path, json_doc);
+                }
+            }
+
+            // Stop prefetching if a newer selection has been made
+            std::lock_guard<std::mutex> lock(_patch_prefetch_mutex);
+            if (!_pending_patch_prefetches.empty() || !_run_patch_prefetch_thread)
+                break;
+        }
+        patch_ids.clear();
+    }
+}
+
 //----------------------------------------------------------------------------
 // _process_param_changed_event
 //----------------------------------------------------------------------------
 void FileManager::_process_param_changed_event(const ParamChange &param_change)
 {
     // Get the param and make sure it exists
-    const Param *param = utils::get_param(param_change.path.c_str());
+    const Param *param = utils::get_param_from_handle(param_change.handle);
     if (param)
     {
         // If this is an alias param, set it to the actual param
@@ -456,6 +692,7 @@ void FileManager::_process_param_changed_event(const ParamChange &param_change)
                         if (param->str_param) {
                             // Update the parameter value in the patch data
                             itr->GetObject()["str_value"].SetString(param->get_str_value().c_str(), _patch_json_doc->GetAllocator());
+                            _update_value_bank(i, param, param->get_str_value());
                         }
                         else {
         #ifdef INCLUDE_PATCH_HISTORY                     
@@ -464,31 +701,17 @@ void FileManager::_process_param_changed_event(const ParamChange &param_change)
         #endif
                             // Update the parameter value in the patch data
                             itr->GetObject()["value"].SetFloat(param_change.value);
+                            _update_value_bank(i, param, param_change.value);
 
-        #ifdef INCLUDE_PATCH_HISTORY 
-                            // We ned to update the param change history vector with this change
-                            // Firstly check if this parameter is already in the vector
-                            bool found = false;
-                            for (ParamChangeHistory &pch : _param_change_history)
-                            {
-                                if (pch.path == param->get_path())
-                                {
-                                    // If there is actually a change in the value
-                                    if (param_change.value != pch.value)
-                                    {
-                                        // Param already exists and the value has changed; update that change history
-                                        pch.value = param_change.value;
-                                        found = true;
-                                    }
-                                }
+                            // If this is a state param, also update the local morph state value
+                            if (param->patch_state_param) {
+                                utils::morph_engine()->set_state_value(i, utils::get_layer_info(i).get_patch_state(), param, param_change.value);
                             }
-                            if (!found)
-                            {
-                                // If there is actually a change in the value
-                                if (param_change.value != current_value) {
-                                    // Param not found in the history vector, add it
-                                    _param_change_history.push_back(ParamChangeHistory(param->get_path(), param_change.value));
-                                }
+
+        #ifdef INCLUDE_PATCH_HISTORY 
+                            // Add this change to the patch history
+                            if (param_change.value != current_value) {
+                                _patch_history.add(i, param->handle, current_value, param_change.value);
                             }
         #endif
                             // If this is a layer param, restart the save layers config timer to save the file if no param has changed
@@ -519,7 +742,7 @@ void FileManager::_process_param_changed_event(const ParamChange &param_change)
             std::lock_guard<std::mutex> guard(_patch_mutex);
 
             // Find the param in the JSON global params data
-            auto itr = _find_global_param(param_change.path);
+            auto itr = _find_global_param(param_change.path());
             if (itr)
             {
                 // Is this a string value param?
@@ -546,8 +769,8 @@ void FileManager::_process_param_changed_event(const ParamChange &param_change)
 void FileManager::_update_state_params()
 {
     // Parse the available DAW params
-    auto params = utils::get_params(NinaModule::DAW);
-    for (Param *p : params)
+    auto params = utils::get_params_view(NinaModule::DAW);
+    for (Param *p : *params)
     {
         // Skip alias params
         if (p->alias_param)
@@ -581,6 +804,7 @@ void FileManager::_update_state_params()
                     // Did the value change? If so update it
                     if (current_value != p->get_str_value()) {
                         itr->GetObject()["str_value"].SetString(p->get_str_value().c_str(), _patch_json_doc->GetAllocator());
+                        _update_value_bank(utils::get_current_layer_info().layer_num(), p, p->get_str_value());
                     }
                 }
                 else {
@@ -590,6 +814,7 @@ void FileManager::_update_state_params()
                     // Did the value change? If so update it
                     if (current_value != p->get_value()) {
                         itr->GetObject()["value"].SetFloat(p->get_value());
+                        _update_value_bank(utils::get_current_layer_info().layer_num(), p, p->get_value());
                     }
                 }
             }
@@ -597,6 +822,58 @@ void FileManager::_update_state_params()
     }
 }
 
+//----------------------------------------------------------------------------
+// _update_morph_engine_states
+//----------------------------------------------------------------------------
+void FileManager::_update_morph_engine_states(uint layer_num)
+{
+    std::unordered_map<std::string, float> state_a_values;
+    std::unordered_map<std::string, float> state_b_values;
+    std::vector<Param *> params;
+    std::vector<float> state_a;
+    std::vector<float> state_b;
+
+    // Make sure the layer patch has both states - if not, the morph engine
+    // cannot blend this layer
+    auto& doc = _layer_patch_json_doc[layer_num];
+    if (!doc.IsObject() || !doc.HasMember("state_a") || !doc["state_a"].IsArray() ||
+        !doc.HasMember("state_b") || !doc["state_b"].IsArray()) {
+        utils::morph_engine()->clear_layer_states(layer_num);
+        return;
+    }
+
+    // Get the State A and State B values for each numeric param
+    for (auto& v : doc["state_a"].GetArray()) {
+        if (v.HasMember("path") && v.HasMember("value") && v["value"].IsNumber()) {
+            state_a_values[v["path"].GetString()] = v["value"].GetFloat();
+        }
+    }
+    for (auto& v : doc["state_b"].GetArray()) {
+        if (v.HasMember("path") && v.HasMember("value") && v["value"].IsNumber()) {
+            state_b_values[v["path"].GetString()] = v["value"].GetFloat();
+        }
+    }
+
+    // Parse the available DAW params
+    auto view = utils::get_params_view(NinaModule::DAW);
+    for (Param *p : *view)
+    {
+        // Only blend numeric state params that are specified in both states
+        if (p->alias_param || !p->patch_state_param || p->str_param)
+            continue;
+        auto a_itr = state_a_values.find(p->get_path());
+        auto b_itr = state_b_values.find(p->get_path());
+        if ((a_itr != state_a_values.end()) && (b_itr != state_b_values.end())) {
+            params.push_back(p);
+            state_a.push_back(a_itr->second);
+            state_b.push_back(b_itr->second);
+        }
+    }
+
+    // Set the layer states in the morph engine
+    utils::morph_engine()->set_layer_states(layer_num, params, state_a, state_b);
+}
+
 //----------------------------------------------------------------------------
 // _process_system_func_event
 //----------------------------------------------------------------------------
@@ -608,51 +885,33 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
 #ifdef INCLUDE_PATCH_HISTORY        
         case SystemFuncType::UNDO_LAST_PARAM_CHANGE:
         {
+            PatchHistoryEntry entry;
+
             // Get the patch mutex
             std::lock_guard<std::mutex> guard(_patch_mutex);
 
-            // Get the last param change action, if any
-            if (_patch_history_json_data.Size() > 0) {
-                // Get the last param change
-                auto obj = (_patch_history_json_data.End() - 1)->GetObject();
-
-                // Is this a patch history object?
-                if ((obj.HasMember("path") && obj["path"].IsString()) &&
-                    (obj.HasMember("value") && obj["value"].IsFloat()))
-                {
-                    // Get the param and update it
-                    auto path = obj["path"].GetString();
-                    auto param = utils::get_param(path);
-                    if (param)
-                    {
-                        // Update the param value
-                        param->set_value(obj["value"].GetFloat());
+            // Undo the last param change, if any
+            _save_patch_history_timer->stop();
+            if (_patch_history.undo(entry)) {
+                _apply_patch_history_value(entry, entry.prev_value);
+            }
+        }
+        break;
 
-                        // Send the param changed event
-                        auto param_change = ParamChange(path, param->get_value(), module());
-                        _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
+        case SystemFuncType::REDO_LAST_PARAM_CHANGE:
+        {
+            PatchHistoryEntry entry;
 
-                        // Find the param in the JSON patch data
-                        auto itr = _find_patch_param(param_change.path);
-                        if (itr)
-                        {
-                            // Update the parameter value in the patch data
-                            itr->GetObject()["value"].SetFloat(param->get_value());
-                        }
-                    }
-                }
-                // Is this a patch history event?
-                else if (obj.HasMember("event") && obj["event"].IsString())
-                {
-                    // For future use, ignore for now
-                }
+            // Get the patch mutex
+            std::lock_guard<std::mutex> guard(_patch_mutex);
 
-                // Remove the last history entry and save the history file
-                _patch_history_json_data.PopBack();
-                _save_patch_history_file();
+            // Redo the last undone param change, if any
+            _save_patch_history_timer->stop();
+            if (_patch_history.redo(entry)) {
+                _apply_patch_history_value(entry, entry.value);
             }
         }
-        break;   
+        break;
 #endif
 
         case SystemFuncType::TOGGLE_PATCH_STATE:
@@ -685,9 +944,10 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
             auto new_state = (utils::get_current_layer_info().get_patch_state() == PatchState::STATE_A) ? PatchState::STATE_B: PatchState::STATE_A;
             utils::get_current_layer_info().set_patch_state(new_state);
 
-            // Parse the state params and set in the DAW
+            // Load the state params and set in the DAW
+            // Note: Only the params that differ from the previous state are sent to the DAW
             auto params = utils::get_patch_params();
-            _parse_patch_state_params(true, params, new_state);
+            _load_patch_state_params(layer_num, params, new_state);
             _daw_manager->set_patch_params(layer_num, false, new_state);
             MSG("Selected patch State " << ((new_state == PatchState::STATE_A) ? "A" : "B"));              
 
@@ -705,6 +965,7 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                 auto itr = _find_patch_param(_morph_value_param->get_path(), false);
                 if (itr) {
                     itr->GetObject()["value"].SetFloat(morph_value);
+                    _update_value_bank(layer_num, _morph_value_param, morph_value);
                 }                 
             }
             utils::get_layer_info(layer_num).set_morph_value(morph_value);
@@ -767,18 +1028,8 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                 _parse_patch(layer_num, false);
 
 #ifdef INCLUDE_PATCH_HISTORY 
-                // Delete the patch history entries - does the patch history contain entries?
-                if (_patch_history_json_data.HasMember("session_history") && _patch_history_json_data["session_history"].IsArray())
-                {
-                    // Is there a session history?
-                    auto session_history = _patch_history_json_data["session_history"].GetArray();            
-                    if (session_history.Size() > 0)
-                    {
-                        // Clear the patch history               
-                        session_history.Erase(session_history.Begin(), session_history.End());
-                    }
-                }
-                _save_patch_history_file();
+                // Clear the patch history, as the loaded patches have changed
+                _patch_history.clear(_get_layer_patch_ids());
 #endif
                 // Save the patch morph position
                 _morph_value_param ?
@@ -796,8 +1047,8 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                     // Probably should implement better way to handle all of this, seems clunky...
                     _patch_json_doc = &_layer_patch_json_doc[utils::get_current_layer_info().layer_num()];
                     auto params = utils::get_patch_params();
-                    _parse_patch_common_params(utils::get_current_layer_info().layer_num(), true, params);
-                    _parse_patch_state_params(true, params, utils::get_current_layer_info().get_patch_state());
+                    _load_patch_common_params(utils::get_current_layer_info().layer_num(), params);
+                    _load_patch_state_params(utils::get_current_layer_info().layer_num(), params, utils::get_current_layer_info().get_patch_state());
                 }
                 
                 // Save the updated layer info
@@ -822,6 +1073,9 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                 // Unlock the morph
                 utils::set_morph_on(true);
                 utils::morph_unlock();
+
+                // Prefetch the neighbouring patches, as these are likely to be loaded next
+                _prefetch_patches(id);
             }
         }
         break;        
@@ -859,6 +1113,7 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                 // Load the Patch state B params
                 _set_patch_state_b_params(from_patch_json_doc);
                 _daw_manager->set_patch_params(layer_num, false, PatchState::STATE_B);
+                _update_morph_engine_states(layer_num);
                 utils::get_current_layer_info().set_patch_modified(true);
 
                 // Set the Morph value and knob params for STATE B
@@ -875,6 +1130,7 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                     auto itr = _find_patch_param(_morph_value_param->get_path(), false);
                     if (itr) {
                         itr->GetObject()["value"].SetFloat(morph_value);
+                        _update_value_bank(layer_num, _morph_value_param, morph_value);
                     }                    
                 }
                 utils::get_layer_info(layer_num).set_morph_value(morph_value); 
@@ -928,21 +1184,8 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
             MSG("Saved Layer " << (layer_num + 1) << " patch: " << _get_patch_filename(id));
 
 #ifdef INCLUDE_PATCH_HISTORY 
-            // Does the patch history contain entries?
-            if (_patch_history_json_data.HasMember("session_history") && _patch_history_json_data["session_history"].IsArray())
-            {
-                // Is there a session history?
-                auto session_history = _patch_history_json_data["session_history"].GetArray();            
-                if (session_history.Size() > 0)
-                {
-                    // Clear the patch history               
-                    session_history.Erase(session_history.Begin(), session_history.End());
-                }
-            }
-            _save_patch_history_file();
-
-            // Empty the param change history vector
-            _param_change_history.clear();
+            // Clear the patch history, as the loaded patches have changed
+            _patch_history.clear(_get_layer_patch_ids());
 #endif
 
             // Save the updated layer info
@@ -989,7 +1232,7 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                     // Note: Set the Morph knob param and send a param change so that its position
                     // is updated
                     _morph_knob_param->set_value(morph_value);
-                    auto param_change = ParamChange(_morph_knob_param->get_path(), morph_value, module());       
+                    auto param_change = ParamChange(_morph_knob_param->handle, morph_value, module());       
                     _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
                 }
                 
@@ -997,6 +1240,7 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                 auto itr = _find_patch_param(_morph_value_param->get_path(), false);
                 if (itr) {
                     itr->GetObject()["value"].SetFloat(morph_value);
+                    _update_value_bank(layer_num, _morph_value_param, morph_value);
                 }                  
             }
             utils::get_layer_info(layer_num).set_morph_value(morph_value);
@@ -1004,6 +1248,7 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
             // Update the Patch state params
             _update_state_params();
             _daw_manager->set_patch_params(layer_num, false, utils::get_current_layer_info().get_patch_state());
+            _update_morph_engine_states(layer_num);
             utils::get_current_layer_info().set_patch_modified(true);
             MSG("Saved Morph to  " << ((utils::get_current_layer_info().get_patch_state() == PatchState::STATE_A) ? "State A" : "State B"));
             
@@ -1030,6 +1275,7 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
             // Copy the INIT patch data to the current document
             assert(_patch_json_doc);
             (*_patch_json_doc).CopyFrom(_init_patch_json_data, (*_patch_json_doc).GetAllocator());
+            _invalidate_json_path_indexes();
 
             // Indicate we are now processing a patch with the DAW
             _set_loading_patch_with_daw(layer_num, true); 
@@ -1051,18 +1297,8 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
             MSG("Init Layer " << (layer_num + 1) << " patch: " << _get_patch_filename(utils::get_current_layer_info().get_patch_id()));
 
 #ifdef INCLUDE_PATCH_HISTORY 
-            // Delete the patch history entries - does the patch history contain entries?
-            if (_patch_history_json_data.HasMember("session_history") && _patch_history_json_data["session_history"].IsArray())
-            {
-                // Is there a session history?
-                auto session_history = _patch_history_json_data["session_history"].GetArray();            
-                if (session_history.Size() > 0)
-                {
-                    // Clear the patch history               
-                    session_history.Erase(session_history.Begin(), session_history.End());
-                }
-            }
-            _save_patch_history_file();
+            // Clear the patch history, as the loaded patches have changed
+            _patch_history.clear(_get_layer_patch_ids());
 #endif
 
             // Send an event to get the managers to re-load their presets
@@ -1116,11 +1352,11 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                 utils::set_current_layer(layer_num);
                 utils::reset_param_states();
 
-                // Parse the common and layer params for this layer
+                // Load the common params from the layer value bank, and parse the layer params for this layer
                 // Note: Don't load the state params as this layer might be morphed
                 _patch_json_doc = &_layer_patch_json_doc[layer_num];
                 auto params = utils::get_patch_params();
-                _parse_patch_common_params(layer_num, true, params);
+                _load_patch_common_params(layer_num, params);
                 _parse_patch_layer_params(params);
 
                 // Calculate and set the Layer voices
@@ -1137,23 +1373,13 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                     // Note: Set the Morph knob param and send a param change so that its position
                     // is updated
                     _morph_knob_param->set_value(morph_value);
-                    auto param_change = ParamChange(_morph_knob_param->get_path(), morph_value, module());       
+                    auto param_change = ParamChange(_morph_knob_param->handle, morph_value, module());       
                     _event_router->post_param_changed_event(new ParamChangedEvent(param_change));             
                 }
 
 #ifdef INCLUDE_PATCH_HISTORY
-                // Delete the patch history entries - does the patch history contain entries?
-                if (_patch_history_json_data.HasMember("session_history") && _patch_history_json_data["session_history"].IsArray())
-                {
-                    // Is there a session history?
-                    auto session_history = _patch_history_json_data["session_history"].GetArray();            
-                    if (session_history.Size() > 0)
-                    {
-                        // Clear the patch history               
-                        session_history.Erase(session_history.Begin(), session_history.End());
-                    }
-                }
-                _save_patch_history_file();
+                // Clear the patch history, as the loaded patches have changed
+                _patch_history.clear(_get_layer_patch_ids());
 #endif
                 MSG("Switched to Layer " << (utils::get_current_layer_info().layer_num() + 1));
 
@@ -1166,7 +1392,7 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                 }
                 else {
                     // Load the patch params for the current state based on the morph knob
-                    _parse_patch_state_params(true, params, ((morph_value == 1.0) ? PatchState::STATE_B : PatchState::STATE_A));
+                    _load_patch_state_params(layer_num, params, ((morph_value == 1.0) ? PatchState::STATE_B : PatchState::STATE_A));
                 }
 
                 // Send an event to get the managers to re-load their presets
@@ -1217,6 +1443,11 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                 // are missing from the Layers file
                 utils::reset_mpe_params();
 
+                // Open the patch for each layer in parallel, and push the patches to the DAW
+                // as a single batch
+                auto layer_patch_reads = _open_layer_patch_files();
+                _daw_manager->begin_patch_batch();
+
                 // Parse the patch data for each layer
                 for (int i=(NUM_LAYERS-1); i>=0; i--) {
                     bool parse_patch = true;
@@ -1227,8 +1458,8 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                     utils::get_current_layer_info().set_patch_state(PatchState::STATE_A);
                     _select_current_layer(i);
                     _patch_json_doc = &_layer_patch_json_doc[i];
-                    if (!_open_patch_file(utils::get_layer_info(i).get_patch_id())) {
-                        // This is a critical error - note the function above call logs any errors
+                    if (!layer_patch_reads[i].get()) {
+                        // This is a critical error - note the patch open logs any errors
                         parse_patch = false;
                     }
                     _set_current_layer_filename_tag(i);                   
@@ -1243,24 +1474,15 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
                         MSG("Loaded Layer " << (i+1) << " patch: " << _get_patch_filename(utils::get_layer_info(i).get_patch_id()));
                     }
                 }
+                _daw_manager->end_patch_batch();
 
 #if defined CHECK_LAYERS_LOAD
                 _check_layers_load();
 #endif
 
 #ifdef INCLUDE_PATCH_HISTORY
-                // Delete the patch history entries - does the patch history contain entries?
-                if (_patch_history_json_data.HasMember("session_history") && _patch_history_json_data["session_history"].IsArray())
-                {
-                    // Is there a session history?
-                    auto session_history = _patch_history_json_data["session_history"].GetArray();            
-                    if (session_history.Size() > 0)
-                    {
-                        // Clear the patch history               
-                        session_history.Erase(session_history.Begin(), session_history.End());
-                    }
-                }
-                _save_patch_history_file();
+                // Clear the patch history, as the loaded patches have changed
+                _patch_history.clear(_get_layer_patch_ids());
 #endif
 
                 // Send an event to get the managers to re-load their presets
@@ -1425,6 +1647,13 @@ void FileManager::_process_system_func_event(const SystemFunc &system_func)
             break;
         }
 
+        case SystemFuncType::PREFETCH_PATCHES:
+        {
+            // Prefetch the selected patch and its neighbours
+            _prefetch_patches(system_func.patch_id);
+            break;
+        }
+
         default:
             // Ignore all other events
             break;        
@@ -1449,40 +1678,65 @@ void FileManager::_params_changed_timeout_with_lock()
 //----------------------------------------------------------------------------
 void FileManager::_params_changed_timeout()
 {
-    // Are there any param change history entries to process?
-    if (_param_change_history.size() > 0)
+    // Add any pending param changes to the patch history
+    _patch_history.flush();
+}
+
+//----------------------------------------------------------------------------
+// _apply_patch_history_value
+// Note: The patch mutex must be held by the caller
+//----------------------------------------------------------------------------
+void FileManager::_apply_patch_history_value(const PatchHistoryEntry& entry, float value)
+{
+    // Get the param and make sure it exists
+    auto param = utils::get_param_from_handle(entry.handle);
+    if (param && (entry.layer_num < NUM_LAYERS))
     {
-        // Does any patch history exist
-        if (_patch_history_json_data.HasMember("session_history") && _patch_history_json_data["session_history"].IsArray())
+        // Find the param in the layer JSON patch data
+        auto itr = _find_patch_param(entry.layer_num, param->get_path(), param->layer_1_param);
+        if (itr)
         {
-            // Get the session history array
-            auto session_history = _patch_history_json_data["session_history"].GetArray();
-        
-            // Now check if adding these change entries will exceed the history max
-            if ((session_history.Size() + _param_change_history.size()) > PATCH_HISTORY_MAX_EVENTS)
-            {
-                // Erase the oldest entries
-                int num = (session_history.Size() + _param_change_history.size()) - PATCH_HISTORY_MAX_EVENTS;
-                session_history.Erase(session_history.Begin(), session_history.Begin() + num);
+            // Update the parameter value in the patch data
+            itr->GetObject()["value"].SetFloat(value);
+            _update_value_bank(entry.layer_num, param, value);
+            if (param->patch_state_param) {
+                utils::morph_engine()->set_state_value(entry.layer_num, utils::get_layer_info(entry.layer_num).get_patch_state(), param, value);
             }
-
-            // Add the changed param entries to the history file
-            for (const ParamChangeHistory &pch : _param_change_history) {
-                // Add the param change history
-                rapidjson::Value tmp;
-                tmp.SetObject();
-                tmp.AddMember("path", std::string(pch.path), _patch_history_json_data.GetAllocator());
-                tmp.AddMember("value", pch.value, _patch_history_json_data.GetAllocator());
-                session_history.PushBack(tmp, _patch_history_json_data.GetAllocator());
+            if (!param->patch_layer_param) {
+                utils::get_layer_info(entry.layer_num).set_patch_modified(true);
             }
+        }
 
-            // Save the patch history file
-            _save_patch_history_file();
+        // Is this change in the current layer?
+        if (entry.layer_num == utils::get_current_layer_info().layer_num())
+        {
+            // Update the param value
+            param->set_value(value);
+
+            // Send the param changed event
+            auto param_change = ParamChange(param->handle, param->get_value(), module());
+            _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
+        }
+        else if (param->module == NinaModule::DAW)
+        {
+            // Update the param value in the DAW for that layer
+            _daw_manager->set_param(entry.layer_num, param, value);
         }
     }
+}
+
+//----------------------------------------------------------------------------
+// _get_layer_patch_ids
+//----------------------------------------------------------------------------
+std::vector<PatchId> FileManager::_get_layer_patch_ids()
+{
+    std::vector<PatchId> layer_patch_ids;
 
-    // Empty the param change history vector, ready for the next batch of param changes
-    _param_change_history.clear();    
+    // Get the patch loaded in each layer
+    for (uint i=0; i<NUM_LAYERS; i++) {
+        layer_patch_ids.push_back(utils::get_layer_info(i).get_patch_id());
+    }
+    return layer_patch_ids;
 }
 #endif
 
@@ -1534,95 +1788,52 @@ std::string FileManager::_get_layers_filename(uint layers_num)
 //----------------------------------------------------------------------------
 std::string FileManager::_get_patch_filename(PatchId id, bool full_path)
 {
-    char bank_file_prefix[sizeof("000_")];
-    char patch_file_prefix[sizeof("000_")];
-    std::string bank_folder;
-    bool bank_folder_found = false;
+    std::string bank_folder_name;
+    std::map<uint, std::string> patch_files;
     std::string patch_filename;
-    bool patch_filename_found = false;
-
-    // Format the bank and patch file prefixes
-    std::sprintf(bank_file_prefix, "%03d_", id.bank_num);
-    std::sprintf(patch_file_prefix, "%03d_", id.patch_num);
 
     // We need to find the patch bank folder first
-    auto dir = ::opendir(NINA_PATCHES_DIR);
-    if (dir != nullptr)
+    if (!utils::bank_index()->bank_folder(id.bank_num, bank_folder_name))
     {
-        struct dirent *dirent;
+        // This should never happen
+        return "";
+    }
+    auto bank_folder = NINA_PATCHES_DIR + bank_folder_name;
 
-        // Parse each directory, looking for the bank folder
-        while ((dirent = ::readdir(dir)) != nullptr)
+    // Get the patch files in the bank folder
+    if (utils::bank_index()->patch_files(bank_folder, patch_files))
+    {
+        // Is the patch file present?
+        auto itr = patch_files.find(id.patch_num);
+        if (itr != patch_files.end())
         {
-            // Is this a directory?
-            if (dirent->d_type == DT_DIR)
-            {
-                // Is this the bank folder?
-                if (std::strncmp(dirent->d_name, bank_file_prefix, (sizeof(bank_file_prefix)-1)) == 0)
-                {
-                    // Bank folder found
-                    bank_folder = NINA_PATCHES_DIR + std::string(dirent->d_name);
-                    bank_folder_found = true;
-                    break;
-                }
+            // Patch filename found
+            if (full_path) {
+                // Return the full unmodified filename path
+                patch_filename = bank_folder + "/" + itr->second;
+            }
+            else {
+                // Return the formatted filename
+                auto name = itr->second;
+                name = name.substr(0, (name.size() - (sizeof(".json") - 1)));
+                uint index = (name[0] == '0') ? 4 : 3;                        
+                name = name.substr(index, (name.size() - index));
+                std::transform(name.begin(), name.end(), name.begin(), ::toupper); 
+                patch_filename = std::regex_replace(name, std::regex{"_"}, " ");
             }
         }
-        ::closedir(dir);
-        if (!bank_folder_found)
-        {
-            // This should never happen
-            return "";
-        }
-
-        // Open the bank folder
-        dir = ::opendir(bank_folder.c_str());
-        if (dir != nullptr)
+        else
         {
-            struct dirent *dirent;
-
-            // Parse each file, looking for the patch file
-            while ((dirent = ::readdir(dir)) != nullptr)
-            {
-                // Is this a regular file?
-                if (dirent->d_type == DT_REG)
-                {                
-                    // Is this the patch filename?
-                    if (std::strncmp(dirent->d_name, patch_file_prefix, (sizeof(patch_file_prefix)-1)) == 0)
-                    {
-                        // Patch filename found
-                        if (full_path) {
-                            // Return the full unmodified filename path
-                            patch_filename = bank_folder + "/" + std::string(dirent->d_name);
-                        }
-                        else {
-                            // Return the formatted filename
-                            auto name = std::string(dirent->d_name);
-                            name = name.substr(0, (name.size() - (sizeof(".json") - 1)));
-                            uint index = (name[0] == '0') ? 4 : 3;                        
-                            name = name.substr(index, (name.size() - index));
-                            std::transform(name.begin(), name.end(), name.begin(), ::toupper); 
-                            patch_filename = std::regex_replace(name, std::regex{"_"}, " ");
-                        }
-                        patch_filename_found = true;
-                        break;
-                    }
-                }
+            // The patch does not exist - in which case we can safely assume the default is loaded
+            auto name = utils::get_default_patch_filename(id.patch_num, true);
+            if (full_path) {   
+                patch_filename = bank_folder + "/" + name;
             }
-            ::closedir(dir);
-            if (!patch_filename_found)
-            {
-                // The patch does not exist - in which case we can safely assume the default is loaded
-                auto name = utils::get_default_patch_filename(id.patch_num, true);
-                if (full_path) {   
-                    patch_filename = bank_folder + "/" + name;
-                }
-                else {
-                    patch_filename = name;
-                    patch_filename = patch_filename.substr(0, (patch_filename.size() - (sizeof(".json") - 1)));
-                }
-                patch_filename_found = true;
-            }                                                 
-        }
+            else {
+                patch_filename = name;
+                patch_filename = patch_filename.substr(0, (patch_filename.size() - (sizeof(".json") - 1)));
+            }
+        }                                                 
     }
     return patch_filename;
 }
@@ -1648,420 +1859,462 @@ bool FileManager::_open_config_file()
 }
 
 //----------------------------------------------------------------------------
-// _open_and_parse_param_attributes_file
+// _read_startup_file
+//----------------------------------------------------------------------------
+std::future<bool> FileManager::_read_startup_file(const char *name, std::function<bool()> open_func)
+{
+    // Read the file in a separate thread, and log how long the read took
+    return std::async(std::launch::async, [this, name, open_func]() {
+        auto start_time = std::chrono::steady_clock::now();
+        bool ret = open_func();
+        auto read_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time);
+        NINA_LOG_INFO(module(), "Startup read {}: {}us", name, read_time.count());
+        return ret;
+    });
+}
+
+//----------------------------------------------------------------------------
+// _log_startup_step
+//----------------------------------------------------------------------------
+void FileManager::_log_startup_step(const char *name, std::chrono::steady_clock::time_point &start_time)
+{
+    // Log how long this startup step took, including any wait for its file to be read, and
+    // start timing the next step
+    auto now = std::chrono::steady_clock::now();
+    auto step_time = std::chrono::duration_cast<std::chrono::microseconds>(now - start_time);
+    NINA_LOG_INFO(module(), "Startup step {}: {}us", name, step_time.count());
+    start_time = now;
+}
+
+//----------------------------------------------------------------------------
+// _open_param_attributes_file
 //----------------------------------------------------------------------------
-bool FileManager::_open_and_parse_param_attributes_file()
+bool FileManager::_open_param_attributes_file(rapidjson::Document &json_data)
 {
     const char *schema =
 #include "../json_schemas/param_attributes_schema.json"
 ;
-    rapidjson::Document json_data;
 
     // Open the param atttributes file
-    bool ret = _open_json_file(NINA_ROOT_FILE_PATH(PARAM_ATTRIBUTES_FILE), schema, json_data, false);
-    if (ret)
-    {
-        // If the JSON data is empty its an invalid file
-        if (!json_data.IsArray())
-            return false;
+    return _open_json_file(NINA_ROOT_FILE_PATH(PARAM_ATTRIBUTES_FILE), schema, json_data, false);
+}
 
-        // Parse the param attributes file
-        // If the JSON data is not an array don't parse it
-        if (json_data.IsArray())
+//----------------------------------------------------------------------------
+// _parse_param_attributes
+//----------------------------------------------------------------------------
+bool FileManager::_parse_param_attributes(rapidjson::Document &json_data)
+{
+    // If the JSON data is empty its an invalid file
+    if (!json_data.IsArray())
+        return false;
+
+    // Parse the param attributes file
+    // If the JSON data is not an array don't parse it
+    if (json_data.IsArray())
+    {
+        // Iterate through the params
+        for (rapidjson::Value::ValueIterator itr = json_data.Begin(); itr != json_data.End(); ++itr)
         {
-            // Iterate through the params
-            for (rapidjson::Value::ValueIterator itr = json_data.Begin(); itr != json_data.End(); ++itr)
+            // Is the param path present?
+            if (itr->GetObject().HasMember("param_path") && itr->GetObject()["param_path"].IsString())
             {
-                // Is the param path present?
-                if (itr->GetObject().HasMember("param_path") && itr->GetObject()["param_path"].IsString())
+                // Get the param path and find the param(s)
+                auto param_path = itr->GetObject()["param_path"].GetString();
+                auto params = utils::get_params(param_path);
+                for (Param *p : params)
                 {
-                    // Get the param path and find the param(s)
-                    auto param_path = itr->GetObject()["param_path"].GetString();
-                    auto params = utils::get_params(param_path);
-                    for (Param *p : params)
+                    // Check for the various attributes that can be specified
+                    if (itr->GetObject().HasMember("ref") && itr->GetObject()["ref"].IsString())
                     {
-                        // Check for the various attributes that can be specified
-                        if (itr->GetObject().HasMember("ref") && itr->GetObject()["ref"].IsString())
-                        {
-                            // Get the reference for this param
-                            p->ref = itr->GetObject()["ref"].GetString();
-
-                            // Additional processing
-                            // If this param is the morph value param, check the other mapped
-                            // params and if a physical control, set it as the morph knob
-                            // Note: Will set the first mapped physical control to the morph knob
-                            if (utils::param_has_ref(p, utils::ParamRef::MORPH_VALUE)) {
-                                auto mapped_params = p->get_mapped_params();
-                                for (Param *mp : mapped_params)
-                                {
-                                    // Is this a physical param?
-                                    if (mp->physical_control_param) {
-                                        utils::set_morph_knob_num(static_cast<SurfaceControlParam *>(mp)->param_id);
-                                        break;
-                                    }
+                        // Get the reference for this param
+                        p->ref = itr->GetObject()["ref"].GetString();
+
+                        // Additional processing
+                        // If this param is the morph value param, check the other mapped
+                        // params and if a physical control, set it as the morph knob
+                        // Note: Will set the first mapped physical control to the morph knob
+                        if (utils::param_has_ref(p, utils::ParamRef::MORPH_VALUE)) {
+                            auto mapped_params = p->get_mapped_params();
+                            for (Param *mp : mapped_params)
+                            {
+                                // Is this a physical param?
+                                if (mp->physical_control_param) {
+                                    utils::set_morph_knob_num(static_cast<SurfaceControlParam *>(mp)->param_id);
+                                    break;
                                 }
-                            }                             
-                        }
-                        if (itr->GetObject().HasMember("patch") && itr->GetObject()["patch"].IsBool())
-                        {
-                            // Set this as a patch param
-                            p->patch_param = itr->GetObject()["patch"].GetBool();
-                        }
-                        if (itr->GetObject().HasMember("patch_layer_param") && itr->GetObject()["patch_layer_param"].IsBool())
-                        {
-                            // Set this as a layer param
-                            p->patch_layer_param = itr->GetObject()["patch_layer_param"].GetBool();
-                        }                          
-                        if (itr->GetObject().HasMember("patch_common_layer_param") && itr->GetObject()["patch_common_layer_param"].IsBool())
-                        {
-                            // Set this as a common layer param
-                            p->patch_common_layer_param = itr->GetObject()["patch_common_layer_param"].GetBool();
-                        }                         
-                        if (itr->GetObject().HasMember("patch_state_param") && itr->GetObject()["patch_state_param"].IsBool())
-                        {
-                            // Set this as a state param
-                            p->patch_state_param = itr->GetObject()["patch_state_param"].GetBool();
-                        }
-                        if (itr->GetObject().HasMember("global_param") && itr->GetObject()["global_param"].IsBool())
-                        {
-                            // Set this as a global param
-                            p->global_param = itr->GetObject()["global_param"].GetBool();
-                        }
-                        if (itr->GetObject().HasMember("layer_1_param") && itr->GetObject()["layer_1_param"].IsBool())
-                        {
-                            // Set this as a Layer 1 only param
-                            p->layer_1_param = itr->GetObject()["layer_1_param"].GetBool();
-                        }                                                                                            
-                        if (itr->GetObject().HasMember("display_name") && itr->GetObject()["display_name"].IsString())
-                        {
-                            // Set the display name string - if the string is empty, also set
-                            // the param name to an empty string so that it is not shown on the GUI
-                            p->display_name = itr->GetObject()["display_name"].GetString();
-                            if (p->display_name.size() == 0) {
-                                p->name = "";
-                            }
-                        }
-                        if (itr->GetObject().HasMember("display_switch") && itr->GetObject()["display_switch"].IsBool())
-                        {
-                            // Set this as a switch parameter
-                            p->display_switch = itr->GetObject()["display_switch"].GetBool();
-                        }
-                        if (itr->GetObject().HasMember("num_positions") && itr->GetObject()["num_positions"].IsUint())
-                        {
-                            // Set the number of positions
-                            p->set_multi_position_param_num_positions(itr->GetObject()["num_positions"].GetUint());
-                        }                       
-                        if (itr->GetObject().HasMember("display_range_min") && itr->GetObject()["display_range_min"].IsInt())
-                        {
-                            // Set the display range min
-                            p->display_range_min = itr->GetObject()["display_range_min"].GetInt();
-                        }
-                        if (itr->GetObject().HasMember("display_range_max") && itr->GetObject()["display_range_max"].IsInt())
-                        {
-                            // Set the display range max
-                            p->display_range_max = itr->GetObject()["display_range_max"].GetInt();
-                        }
-                        if (itr->GetObject().HasMember("haptic_mode") && itr->GetObject()["haptic_mode"].IsString())
-                        {
-                            // Get the mode
-                            auto mode = itr->GetObject()["haptic_mode"].GetString();
-
-                            // Is the param a hardware param?
-                            if (p->physical_control_param)
-                            {
-                                // Set the mode
-                                static_cast<SurfaceControlParam *>(p)->set_haptic_mode(mode);
                             }
+                        }                             
+                    }
+                    if (itr->GetObject().HasMember("patch") && itr->GetObject()["patch"].IsBool())
+                    {
+                        // Set this as a patch param
+                        p->patch_param = itr->GetObject()["patch"].GetBool();
+                    }
+                    if (itr->GetObject().HasMember("patch_layer_param") && itr->GetObject()["patch_layer_param"].IsBool())
+                    {
+                        // Set this as a layer param
+                        p->patch_layer_param = itr->GetObject()["patch_layer_param"].GetBool();
+                    }                          
+                    if (itr->GetObject().HasMember("patch_common_layer_param") && itr->GetObject()["patch_common_layer_param"].IsBool())
+                    {
+                        // Set this as a common layer param
+                        p->patch_common_layer_param = itr->GetObject()["patch_common_layer_param"].GetBool();
+                    }                         
+                    if (itr->GetObject().HasMember("patch_state_param") && itr->GetObject()["patch_state_param"].IsBool())
+                    {
+                        // Set this as a state param
+                        p->patch_state_param = itr->GetObject()["patch_state_param"].GetBool();
+                    }
+                    if (itr->GetObject().HasMember("global_param") && itr->GetObject()["global_param"].IsBool())
+                    {
+                        // Set this as a global param
+                        p->global_param = itr->GetObject()["global_param"].GetBool();
+                    }
+                    if (itr->GetObject().HasMember("layer_1_param") && itr->GetObject()["layer_1_param"].IsBool())
+                    {
+                        // Set this as a Layer 1 only param
+                        p->layer_1_param = itr->GetObject()["layer_1_param"].GetBool();
+                    }                                                                                            
+                    if (itr->GetObject().HasMember("display_name") && itr->GetObject()["display_name"].IsString())
+                    {
+                        // Set the display name string - if the string is empty, also set
+                        // the param name to an empty string so that it is not shown on the GUI
+                        p->display_name = itr->GetObject()["display_name"].GetString();
+                        if (p->display_name.size() == 0) {
+                            p->name = "";
                         }
-                        if (itr->GetObject().HasMember("display_strings") && itr->GetObject()["display_strings"].IsArray())
+                    }
+                    if (itr->GetObject().HasMember("display_switch") && itr->GetObject()["display_switch"].IsBool())
+                    {
+                        // Set this as a switch parameter
+                        p->display_switch = itr->GetObject()["display_switch"].GetBool();
+                    }
+                    if (itr->GetObject().HasMember("num_positions") && itr->GetObject()["num_positions"].IsUint())
+                    {
+                        // Set the number of positions
+                        p->set_multi_position_param_num_positions(itr->GetObject()["num_positions"].GetUint());
+                    }                       
+                    if (itr->GetObject().HasMember("display_range_min") && itr->GetObject()["display_range_min"].IsInt())
+                    {
+                        // Set the display range min
+                        p->display_range_min = itr->GetObject()["display_range_min"].GetInt();
+                    }
+                    if (itr->GetObject().HasMember("display_range_max") && itr->GetObject()["display_range_max"].IsInt())
+                    {
+                        // Set the display range max
+                        p->display_range_max = itr->GetObject()["display_range_max"].GetInt();
+                    }
+                    if (itr->GetObject().HasMember("haptic_mode") && itr->GetObject()["haptic_mode"].IsString())
+                    {
+                        // Get the mode
+                        auto mode = itr->GetObject()["haptic_mode"].GetString();
+
+                        // Is the param a hardware param?
+                        if (p->physical_control_param)
                         {
-                            // Parse each Display String
-                            auto display_strings = itr->GetObject()["display_strings"].GetArray();
-                            for (auto& ds : display_strings)
-                            {
-                                // If a Display String has been specified
-                                if (ds.HasMember("string") && ds["string"].IsString())
-                                {
-                                    // Add the Diplay String
-                                    p->display_strings.push_back(ds["string"].GetString());
-                                }                                      
-                            }
+                            // Set the mode
+                            static_cast<SurfaceControlParam *>(p)->set_haptic_mode(mode);
                         }
-                        if (itr->GetObject().HasMember("value_tag") && itr->GetObject()["value_tag"].IsString())
-                        {
-                            // Get the Value Tag and set
-                            p->value_tag = itr->GetObject()["value_tag"].GetString();
-                        }                        
-                        if (itr->GetObject().HasMember("value_tags") && itr->GetObject()["value_tags"].IsArray())
+                    }
+                    if (itr->GetObject().HasMember("display_strings") && itr->GetObject()["display_strings"].IsArray())
+                    {
+                        // Parse each Display String
+                        auto display_strings = itr->GetObject()["display_strings"].GetArray();
+                        for (auto& ds : display_strings)
                         {
-                            // Parse each Value Tag
-                            auto value_tags = itr->GetObject()["value_tags"].GetArray();
-                            for (auto& vt : value_tags)
+                            // If a Display String has been specified
+                            if (ds.HasMember("string") && ds["string"].IsString())
                             {
-                                // If a Value Tag has been specified
-                                if (vt.HasMember("string") && vt["string"].IsString())
-                                {
-                                    // Add the Value Tag
-                                    p->value_tags.push_back(vt["string"].GetString());
-                                }                                      
-                            }
-                        }
-                        if (itr->GetObject().HasMember("numeric_enum_param") && itr->GetObject()["numeric_enum_param"].IsBool())
-                        {
-                            // Indicate the param is a numeric enum param
-                            p->numeric_enum_param = itr->GetObject()["numeric_enum_param"].GetBool();
+                                // Add the Diplay String
+                                p->display_strings.push_back(ds["string"].GetString());
+                            }                                      
                         }
-                        if (itr->GetObject().HasMember("always_show") && itr->GetObject()["always_show"].IsBool())
+                    }
+                    if (itr->GetObject().HasMember("value_tag") && itr->GetObject()["value_tag"].IsString())
+                    {
+                        // Get the Value Tag and set
+                        p->value_tag = itr->GetObject()["value_tag"].GetString();
+                    }                        
+                    if (itr->GetObject().HasMember("value_tags") && itr->GetObject()["value_tags"].IsArray())
+                    {
+                        // Parse each Value Tag
+                        auto value_tags = itr->GetObject()["value_tags"].GetArray();
+                        for (auto& vt : value_tags)
                         {
-                            // Indicate this parameter should always be shown
-                            // Note: Applies to Mod Matrix entries, these params should always be shown and
-                            // cannot be deleted
-                            p->always_show = itr->GetObject()["always_show"].GetBool();
+                            // If a Value Tag has been specified
+                            if (vt.HasMember("string") && vt["string"].IsString())
+                            {
+                                // Add the Value Tag
+                                p->value_tags.push_back(vt["string"].GetString());
+                            }                                      
                         }
-                        if (itr->GetObject().HasMember("set_ui_state") && itr->GetObject()["set_ui_state"].IsString())
-                        {
-                            // Indicate the set UI state related to this parameter
-                            p->set_ui_state = itr->GetObject()["set_ui_state"].GetString();
-                        }                       
-                        if (itr->GetObject().HasMember("param_list") && itr->GetObject()["param_list"].IsString())
-                        {
-                            // Set the param list name for this param
-                            p->param_list_name = itr->GetObject()["param_list"].GetString();
-                        }                                              
                     }
+                    if (itr->GetObject().HasMember("numeric_enum_param") && itr->GetObject()["numeric_enum_param"].IsBool())
+                    {
+                        // Indicate the param is a numeric enum param
+                        p->numeric_enum_param = itr->GetObject()["numeric_enum_param"].GetBool();
+                    }
+                    if (itr->GetObject().HasMember("always_show") && itr->GetObject()["always_show"].IsBool())
+                    {
+                        // Indicate this parameter should always be shown
+                        // Note: Applies to Mod Matrix entries, these params should always be shown and
+                        // cannot be deleted
+                        p->always_show = itr->GetObject()["always_show"].GetBool();
+                    }
+                    if (itr->GetObject().HasMember("set_ui_state") && itr->GetObject()["set_ui_state"].IsString())
+                    {
+                        // Indicate the set UI state related to this parameter
+                        p->set_ui_state = itr->GetObject()["set_ui_state"].GetString();
+                    }                       
+                    if (itr->GetObject().HasMember("param_list") && itr->GetObject()["param_list"].IsString())
+                    {
+                        // Set the param list name for this param
+                        p->param_list_name = itr->GetObject()["param_list"].GetString();
+                    }                                              
                 }
             }
         }
+
+        // The param attributes may have changed the param categories, so invalidate
+        // any cached params views
+        utils::invalidate_params_views();
     }
-    return ret;
+    return true;
 }
 
 //----------------------------------------------------------------------------
-// _open_and_parse_param_lists_file
+// _open_param_lists_file
 //----------------------------------------------------------------------------
-bool FileManager::_open_and_parse_param_lists_file()
+bool FileManager::_open_param_lists_file(rapidjson::Document &json_data)
 {
     const char *schema =
 #include "../json_schemas/param_lists_schema.json"
 ;
-    rapidjson::Document json_data;
 
     // Open the param lists file
-    bool ret = _open_json_file(NINA_ROOT_FILE_PATH(PARAM_LISTS_FILE), schema, json_data, false);
-    if (ret)
-    {
-        // If the JSON data is empty its an invalid file
-        if (!json_data.IsArray())
-            return false;
+    return _open_json_file(NINA_ROOT_FILE_PATH(PARAM_LISTS_FILE), schema, json_data, false);
+}
 
-        // Parse the param lists file
-        // If the JSON data is not an array don't parse it
-        if (json_data.IsArray())
+//----------------------------------------------------------------------------
+// _parse_param_lists
+//----------------------------------------------------------------------------
+bool FileManager::_parse_param_lists(rapidjson::Document &json_data)
+{
+    // If the JSON data is empty its an invalid file
+    if (!json_data.IsArray())
+        return false;
+
+    // Parse the param lists file
+    // If the JSON data is not an array don't parse it
+    if (json_data.IsArray())
+    {
+        // Iterate through the params
+        for (rapidjson::Value::ValueIterator itr = json_data.Begin(); itr != json_data.End(); ++itr)
         {
-            // Iterate through the params
-            for (rapidjson::Value::ValueIterator itr = json_data.Begin(); itr != json_data.End(); ++itr)
-            {
-                std::string param_list_name;
-                std::string param_list_display_name;
-                auto param_list = std::vector<Param *>();
-                auto ct_params_list = std::vector<ContextSpecificParams>();
+            std::string param_list_name;
+            std::string param_list_display_name;
+            auto param_list = std::vector<Param *>();
+            auto ct_params_list = std::vector<ContextSpecificParams>();
 
-                // Has the param list name been specified?
-                if (itr->GetObject().HasMember("name") && itr->GetObject()["name"].IsString())
-                {
-                    // Get the param list name
-                    param_list_name = itr->GetObject()["name"].GetString();
-                    param_list_display_name = param_list_name;
-                }
-                if (itr->GetObject().HasMember("display_name") && itr->GetObject()["display_name"].IsString())
-                {
-                    // Get the param list display name
-                    param_list_display_name = itr->GetObject()["display_name"].GetString();
-                }
+            // Has the param list name been specified?
+            if (itr->GetObject().HasMember("name") && itr->GetObject()["name"].IsString())
+            {
+                // Get the param list name
+                param_list_name = itr->GetObject()["name"].GetString();
+                param_list_display_name = param_list_name;
+            }
+            if (itr->GetObject().HasMember("display_name") && itr->GetObject()["display_name"].IsString())
+            {
+                // Get the param list display name
+                param_list_display_name = itr->GetObject()["display_name"].GetString();
+            }
 
-                // Get the param list
-                if (itr->GetObject().HasMember("params") && itr->GetObject()["params"].IsArray())
+            // Get the param list
+            if (itr->GetObject().HasMember("params") && itr->GetObject()["params"].IsArray())
+            {
+                // Parse each param
+                auto params = itr->GetObject()["params"].GetArray();
+                for (auto& p : params)
                 {
-                    // Parse each param
-                    auto params = itr->GetObject()["params"].GetArray();
-                    for (auto& p : params)
+                    // If a param path has been specified
+                    if (p.HasMember("param") && p["param"].IsString())
                     {
-                        // If a param path has been specified
-                        if (p.HasMember("param") && p["param"].IsString())
-                        {
-                            // Get the param path and add the param to the list
-                            auto param = utils::get_param(p["param"].GetString());
-                            if (param) {
-                                // If this param is also a separator
-                                if (p.HasMember("separator") && p["separator"].IsBool())
-                                {
-                                    // Indicate if this param is a separator
-                                    param->separator = p["separator"].GetBool();
-                                }
-
-                                // Add the param to the list                       
-                                param_list.push_back(param);
+                        // Get the param path and add the param to the list
+                        auto param = utils::get_param(p["param"].GetString());
+                        if (param) {
+                            // If this param is also a separator
+                            if (p.HasMember("separator") && p["separator"].IsBool())
+                            {
+                                // Indicate if this param is a separator
+                                param->separator = p["separator"].GetBool();
                             }
+
+                            // Add the param to the list                       
+                            param_list.push_back(param);
                         }
                     }
                 }
+            }
 
-                // Get the context specific params list
-                if (itr->GetObject().HasMember("context_specific_params") && itr->GetObject()["context_specific_params"].IsArray())
+            // Get the context specific params list
+            if (itr->GetObject().HasMember("context_specific_params") && itr->GetObject()["context_specific_params"].IsArray())
+            {
+                // Parse each context specific param list
+                auto ct_params_obj = itr->GetObject()["context_specific_params"].GetArray();
+                for (auto& ct_param_obj : ct_params_obj)
                 {
-                    // Parse each context specific param list
-                    auto ct_params_obj = itr->GetObject()["context_specific_params"].GetArray();
-                    for (auto& ct_param_obj : ct_params_obj)
-                    {
-                        auto ct_params = ContextSpecificParams();
+                    auto ct_params = ContextSpecificParams();
 
+                    // Get the context param
+                    if (ct_param_obj.HasMember("context_param") && ct_param_obj["context_param"].IsString())
+                    {
                         // Get the context param
-                        if (ct_param_obj.HasMember("context_param") && ct_param_obj["context_param"].IsString())
-                        {
-                            // Get the context param
-                            auto param = utils::get_param(ct_param_obj["context_param"].GetString());
-                            if (param) {
-                                ct_params.context_param = param;
-                            }
+                        auto param = utils::get_param(ct_param_obj["context_param"].GetString());
+                        if (param) {
+                            ct_params.context_param = param;
                         }
+                    }
 
-                        // Get the context param value
-                        if (ct_param_obj.HasMember("context_value") && ct_param_obj["context_value"].IsUint())
-                        {
-                            // Get the context value
-                            ct_params.context_value = ct_param_obj["context_value"].GetUint();
-                        }                        
-                        else if (ct_param_obj.HasMember("context_value") && ct_param_obj["context_value"].IsFloat())
-                        {
-                            // Get the context value
-                            ct_params.context_value = ct_param_obj["context_value"].GetFloat();
-                        }
+                    // Get the context param value
+                    if (ct_param_obj.HasMember("context_value") && ct_param_obj["context_value"].IsUint())
+                    {
+                        // Get the context value
+                        ct_params.context_value = ct_param_obj["context_value"].GetUint();
+                    }                        
+                    else if (ct_param_obj.HasMember("context_value") && ct_param_obj["context_value"].IsFloat())
+                    {
+                        // Get the context value
+                        ct_params.context_value = ct_param_obj["context_value"].GetFloat();
+                    }
 
-                        // Get the params list
-                        if (ct_param_obj.HasMember("params") && ct_param_obj["params"].IsArray())
+                    // Get the params list
+                    if (ct_param_obj.HasMember("params") && ct_param_obj["params"].IsArray())
+                    {
+                        // Parse each param
+                        auto params = ct_param_obj["params"].GetArray();
+                        for (auto& p : params)
                         {
-                            // Parse each param
-                            auto params = ct_param_obj["params"].GetArray();
-                            for (auto& p : params)
+                            // If a param path has been specified
+                            if (p.HasMember("param") && p["param"].IsString())
                             {
-                                // If a param path has been specified
-                                if (p.HasMember("param") && p["param"].IsString())
-                                {
-                                    // Get the param path and add the param to the list
-                                    auto param = utils::get_param(p["param"].GetString());
-                                    if (param) {
-                                        // If this param is also a separator
-                                        if (p.HasMember("separator") && p["separator"].IsBool())
-                                        {
-                                            // Indicate if this param is a separator
-                                            param->separator = p["separator"].GetBool();
-                                        }
-
-                                        // Add the param to the list                                         
-                                        ct_params.param_list.push_back(param);
+                                // Get the param path and add the param to the list
+                                auto param = utils::get_param(p["param"].GetString());
+                                if (param) {
+                                    // If this param is also a separator
+                                    if (p.HasMember("separator") && p["separator"].IsBool())
+                                    {
+                                        // Indicate if this param is a separator
+                                        param->separator = p["separator"].GetBool();
                                     }
-                                }                                      
-                            }
-                        }
 
-                        // Add to the list of context specific params
-                        ct_params_list.push_back(ct_params);                                          
-                    }
-                }                
-
-                // If both the name and param list have been specified
-                if ((param_list_name.size() > 0) && ((param_list.size() > 0) || (ct_params_list.size() > 0))) {
-                    // Find each common param that uses this list, and set in the param
-                    auto params = utils::get_params(ParamType::COMMON_PARAM);
-                    for (auto p : params) {
-                        if (p->param_list_name == param_list_name) {
-                            p->param_list_display_name = param_list_display_name;
-                            p->param_list = param_list;
-                            p->context_specific_param_list = ct_params_list;
+                                    // Add the param to the list                                         
+                                    ct_params.param_list.push_back(param);
+                                }
+                            }                                      
                         }
                     }
 
-                    // Find each module param that uses this list, and set in the param
-                    params = utils::get_params(ParamType::MODULE_PARAM);
-                    for (auto p : params) {
-                        if (p->param_list_name == param_list_name) {
-                            p->param_list_display_name = param_list_display_name;
-                            p->param_list = param_list;
-                            p->context_specific_param_list = ct_params_list;
-                        }
-                    }                    
+                    // Add to the list of context specific params
+                    ct_params_list.push_back(ct_params);                                          
                 }
+            }                
+
+            // If both the name and param list have been specified
+            if ((param_list_name.size() > 0) && ((param_list.size() > 0) || (ct_params_list.size() > 0))) {
+                // Find each common param that uses this list, and set in the param
+                auto params = utils::get_params(ParamType::COMMON_PARAM);
+                for (auto p : params) {
+                    if (p->param_list_name == param_list_name) {
+                        p->param_list_display_name = param_list_display_name;
+                        p->param_list = param_list;
+                        p->context_specific_param_list = ct_params_list;
+                    }
+                }
+
+                // Find each module param that uses this list, and set in the param
+                params = utils::get_params(ParamType::MODULE_PARAM);
+                for (auto p : params) {
+                    if (p->param_list_name == param_list_name) {
+                        p->param_list_display_name = param_list_display_name;
+                        p->param_list = param_list;
+                        p->context_specific_param_list = ct_params_list;
+                    }
+                }                    
             }
         }
     }
-    return ret;
+    return true;
 }
 
 //----------------------------------------------------------------------------
-// _open_and_parse_global_params_file
+// _open_global_params_file
 //----------------------------------------------------------------------------
-bool FileManager::_open_and_parse_global_params_file()
+bool FileManager::_open_global_params_file()
 {
     const char *schema =
 #include "../json_schemas/global_params_schema.json"
 ;
 
     // Open the global params file
-    bool ret = _open_json_file(NINA_UDATA_FILE_PATH(GLOBAL_PARAMS_FILE), schema, _global_params_json_data, true);
-    if (ret)
+    return _open_json_file(NINA_UDATA_FILE_PATH(GLOBAL_PARAMS_FILE), schema, _global_params_json_data, true);
+}
+
+//----------------------------------------------------------------------------
+// _parse_global_params
+//----------------------------------------------------------------------------
+bool FileManager::_parse_global_params()
+{
+    // If the JSON data is not an array it is an invalid file
+    if (!_global_params_json_data.IsArray())
+        return false;
+
+    // Get the global params and parse them
+    bool save_file = false;
+    auto params = utils::get_global_params();
+    for (Param *p : params)
     {
-        // If the JSON data is not an array it is an invalid file
-        if (!_global_params_json_data.IsArray())
-            return false;
+        bool param_missed = true;
 
-        // Get the global params and parse them
-        bool save_file = false;
-        auto params = utils::get_global_params();
-        for (Param *p : params)
+        // Check if there is an entry for this param
+        for (rapidjson::Value::ValueIterator itr = _global_params_json_data.Begin(); itr != _global_params_json_data.End(); ++itr)
         {
-            bool param_missed = true;
-
-            // Check if there is an entry for this param
-            for (rapidjson::Value::ValueIterator itr = _global_params_json_data.Begin(); itr != _global_params_json_data.End(); ++itr)
-            {
-                // Does this entry match the param?
-                if (itr->GetObject()["path"].GetString() == p->get_path())
-                {
-                    // Update the parameter value
-                    if (p->str_param) {
-                        p->set_str_value(itr->GetObject()["str_value"].GetString());
-                    }
-                    else {
-                        p->set_value(itr->GetObject()["value"].GetFloat());
-                    }
-                    param_missed = false;
-                    break;
-                }
-            }
-            if (param_missed)
+            // Does this entry match the param?
+            if (itr->GetObject()["path"].GetString() == p->get_path())
             {
-                // Param is not specified in the global params file
-                // We need to add it to the file
-                rapidjson::Value obj;
-                obj.SetObject();
-                obj.AddMember("path", std::string(p->get_path()), _global_params_json_data.GetAllocator());
+                // Update the parameter value
                 if (p->str_param) {
-                    obj.AddMember("str_value", p->get_str_value(), _global_params_json_data.GetAllocator());
+                    p->set_str_value(itr->GetObject()["str_value"].GetString());
                 }
                 else {
-                    obj.AddMember("value", p->get_value(), _global_params_json_data.GetAllocator());
+                    p->set_value(itr->GetObject()["value"].GetFloat());
                 }
-                _global_params_json_data.PushBack(obj, _global_params_json_data.GetAllocator());
-                save_file = true;
+                param_missed = false;
+                break;
             }
         }
-
-        // If we need to save the global params file, do so
-        if (save_file) {
-            _save_global_params_file();
+        if (param_missed)
+        {
+            // Param is not specified in the global params file
+            // We need to add it to the file
+            rapidjson::Value obj;
+            obj.SetObject();
+            obj.AddMember("path", std::string(p->get_path()), _global_params_json_data.GetAllocator());
+            if (p->str_param) {
+                obj.AddMember("str_value", p->get_str_value(), _global_params_json_data.GetAllocator());
+            }
+            else {
+                obj.AddMember("value", p->get_value(), _global_params_json_data.GetAllocator());
+            }
+            _global_params_json_data.PushBack(obj, _global_params_json_data.GetAllocator());
+            save_file = true;
         }
     }
-    return ret;
+
+    // If we need to save the global params file, do so
+    if (save_file) {
+        _save_global_params_file();
+    }
+    return true;
 }
 
 //----------------------------------------------------------------------------
@@ -2212,6 +2465,26 @@ bool FileManager::_open_patch_file(PatchId id, rapidjson::Document &json_doc)
     return _open_patch_file(_get_patch_filename(id), json_doc);
 }
 
+//----------------------------------------------------------------------------
+// _open_layer_patch_files
+//----------------------------------------------------------------------------
+std::vector<std::future<bool>> FileManager::_open_layer_patch_files()
+{
+    std::vector<std::future<bool>> reads;
+
+    // Open the patch file for each layer into its layer patch document, each in a
+    // separate thread
+    // Note: The patch files are only opened here, the patches must still be parsed
+    // in layer order once each read completes
+    for (uint i=0; i<NUM_LAYERS; i++) {
+        auto id = utils::get_layer_info(i).get_patch_id();
+        reads.push_back(std::async(std::launch::async, [this, id, i]() {
+            return _open_patch_file(id, _layer_patch_json_doc[i]);
+        }));
+    }
+    return reads;
+}
+
 //----------------------------------------------------------------------------
 // _open_patch_file
 //----------------------------------------------------------------------------
@@ -2230,8 +2503,24 @@ bool FileManager::_open_patch_file(std::string file_path, rapidjson::Document &j
         return false;
     }
 
+    // Try and load the patch from the patch cache first, this avoids reading, parsing
+    // and validating the JSON patch file
+    // If this patch has just been saved, make sure it has been written first
+    _wait_for_json_save(file_path);
+    _invalidate_json_path_indexes();
+    for (uint i=0; i<NUM_LAYERS; i++) {
+        // If this is a layer patch, invalidate the layer value banks
+        if (&json_doc == &_layer_patch_json_doc[i]) {
+            _invalidate_value_banks(i);
+        }
+    }
+    if (_patch_cache.load(file_path, json_doc)) {
+        return true;
+    }
+
     // Open the param map file
     bool ret = _open_json_file(file_path, schema, json_doc, false);
+    bool cache_patch = ret;
     if (!ret) 
     {
         // The patch could not be opened - most likely as it doesn't exist
@@ -2305,7 +2594,12 @@ bool FileManager::_open_patch_file(std::string file_path, rapidjson::Document &j
         MSG("The patch file format is invalid");
         NINA_LOG_CRITICAL(module(), "The patch file format is invalid");        
         return false;
-    }        
+    }
+
+    // If the patch file was loaded, cache it so it loads quicker next time
+    if (cache_patch) {
+        _patch_cache.save(file_path, json_doc);
+    }
     return ret;
 }
 
@@ -2360,353 +2654,315 @@ void FileManager::_open_and_parse_param_blacklist_file()
 }
 
 //----------------------------------------------------------------------------
-// _open_and_parse_system_colours_file
+// _open_system_colours_file
 //----------------------------------------------------------------------------
-void FileManager::_open_and_parse_system_colours_file()
+bool FileManager::_open_system_colours_file(rapidjson::Document &json_data)
 {
     const char *schema =
 #include "../json_schemas/system_colours_schema.json"
 ;
-    rapidjson::Document json_data;
-    
+
     // Open the system colours file (don't create it if it doesn't exist)
-    if (_open_json_file(NINA_ROOT_FILE_PATH(SYSTEM_COLOURS_FILE), schema, json_data, false))
+    return _open_json_file(NINA_ROOT_FILE_PATH(SYSTEM_COLOURS_FILE), schema, json_data, false);
+}
+
+//----------------------------------------------------------------------------
+// _parse_system_colours
+//----------------------------------------------------------------------------
+void FileManager::_parse_system_colours(rapidjson::Document &json_data)
+{
+    // If the JSON data is empty its an invalid file
+    if (json_data.IsArray())
     {
-        // If the JSON data is empty its an invalid file
-        if (json_data.IsArray())
-        {
-            std::vector<std::string> system_colour_names;
+        std::vector<std::string> system_colour_names;
 
-            // Iterate through the system colours
-            for (rapidjson::Value::ValueIterator itr = json_data.Begin(); itr != json_data.End(); ++itr)
+        // Iterate through the system colours
+        for (rapidjson::Value::ValueIterator itr = json_data.Begin(); itr != json_data.End(); ++itr)
+        {
+            // Is the blacklist param entry valid?
+            if ((itr->GetObject().HasMember("name") && itr->GetObject()["name"].IsString()) &&
+                (itr->GetObject().HasMember("colour") && itr->GetObject()["colour"].IsString()))
             {
-                // Is the blacklist param entry valid?
-                if ((itr->GetObject().HasMember("name") && itr->GetObject()["name"].IsString()) &&
-                    (itr->GetObject().HasMember("colour") && itr->GetObject()["colour"].IsString()))
-                {
-                    utils::SystemColour system_colour;
-
-                    // Get the system colour and add it
-                    system_colour.name = itr->GetObject()["name"].GetString();
-                    system_colour.colour = itr->GetObject()["colour"].GetString();
-                    utils::add_system_colour(system_colour);
-                    system_colour_names.push_back(system_colour.name);
-                }
-            }
-
-            // Is the current system colour any of these colours?
-            if (utils::get_system_colour_from_colour(utils::system_config()->get_system_colour()) == nullptr) {
-                // It doesn't exist, so add it as a custom colour
                 utils::SystemColour system_colour;
-                system_colour.name = "Custom Colour";
-                system_colour.colour = utils::system_config()->get_system_colour();
+
+                // Get the system colour and add it
+                system_colour.name = itr->GetObject()["name"].GetString();
+                system_colour.colour = itr->GetObject()["colour"].GetString();
                 utils::add_system_colour(system_colour);
-                system_colour_names.push_back(system_colour.name);                
+                system_colour_names.push_back(system_colour.name);
             }
+        }
 
-            // Setup the common System Colour param
-            auto param = utils::get_param(ParamType::COMMON_PARAM, CommonParamId::SYSTEM_COLOUR);
-            if (param) {
-                // Add the display strings and select the current system colour
-                param->display_strings = system_colour_names;
-                param->set_multi_position_param_num_positions(system_colour_names.size());
-                param->set_value_from_position(utils::get_system_colour_index(utils::system_config()->get_system_colour()), true);
-            }
+        // Is the current system colour any of these colours?
+        if (utils::get_system_colour_from_colour(utils::system_config()->get_system_colour()) == nullptr) {
+            // It doesn't exist, so add it as a custom colour
+            utils::SystemColour system_colour;
+            system_colour.name = "Custom Colour";
+            system_colour.colour = utils::system_config()->get_system_colour();
+            utils::add_system_colour(system_colour);
+            system_colour_names.push_back(system_colour.name);                
+        }
+
+        // Setup the common System Colour param
+        auto param = utils::get_param(ParamType::COMMON_PARAM, CommonParamId::SYSTEM_COLOUR);
+        if (param) {
+            // Add the display strings and select the current system colour
+            param->display_strings = system_colour_names;
+            param->set_multi_position_param_num_positions(system_colour_names.size());
+            param->set_value_from_position(utils::get_system_colour_index(utils::system_config()->get_system_colour()), true);
         }
     }
 }
 
 //----------------------------------------------------------------------------
-// _open_and_parse_param_aliases_file
+// _open_param_aliases_file
 //----------------------------------------------------------------------------
-void FileManager::_open_and_parse_param_aliases_file()
+bool FileManager::_open_param_aliases_file(rapidjson::Document &json_data)
 {
     const char *schema =
 #include "../json_schemas/param_aliases_schema.json"
 ;
-    rapidjson::Document json_data;
-    
-    // Open the param aliases file (don't create it if it doesn't exist)
-    if (_open_json_file(NINA_ROOT_FILE_PATH(PARAM_ALIASES_FILE), schema, json_data, false))
-    {
-        // If the JSON data is empty its an invalid file
-        if (json_data.IsArray())
-        {
-            // Iterate through the aliases params
-            for (rapidjson::Value::ValueIterator itr = json_data.Begin(); itr != json_data.End(); ++itr)
-            {
-                Param *param = nullptr;
-                std::string alias_path = "";
-
-                // Has a param to alias been specified?
-                if (itr->GetObject().HasMember("param") && itr->GetObject()["param"].IsString())
-                {
-                    // Get this param
-                    param = utils::get_param(itr->GetObject()["param"].GetString());
-                }
-
-                // Has an alias been specified?
-                if (itr->GetObject().HasMember("alias") && itr->GetObject()["alias"].IsString())
-                {
-                    // Get the alias path
-                    alias_path = itr->GetObject()["alias"].GetString();
-                }
 
-                // Alias specified correctly?
-                if (param && (alias_path.size() > 0)) {
-                    // Create the alias param
-                    // Copy the parameter and register it
-                    std::unique_ptr<ParamAlias> alias_param = std::make_unique<ParamAlias>(alias_path, param);
-                    alias_param->clear_mapped_params();
-                    utils::register_param(std::move(alias_param));
-
-                    // Map the alias to the param and vice-versa
-                    auto ap = utils::get_param(alias_path);
-                    if (ap) {
-                        param->add_mapped_param(ap);
-                        ap->add_mapped_param(param);
-                    }                                
-                }                
-            }
-        }
-    }
+    // Open the param aliases file (don't create it if it doesn't exist)
+    return _open_json_file(NINA_ROOT_FILE_PATH(PARAM_ALIASES_FILE), schema, json_data, false);
 }
 
-#ifdef INCLUDE_PATCH_HISTORY
 //----------------------------------------------------------------------------
-// _open_patch_history_file
+// _parse_param_aliases
 //----------------------------------------------------------------------------
-bool FileManager::_open_patch_history_file()
+void FileManager::_parse_param_aliases(rapidjson::Document &json_data)
 {
-    const char *schema =
-#include "../json_schemas/patch_history_schema.json"
-;
-    
-    // Open the patch history file
-    if (_open_json_file(NINA_UDATA_FILE_PATH(PATCH_HISTORY_FILE), schema, _patch_history_json_data, true))
+    // Register the alias params as a batch, the params registry is published once
+    // they have all been registered
+    utils::begin_params_registration();
+
+    // If the JSON data is empty its an invalid file
+    if (json_data.IsArray())
     {
-        // If the JSON data is empty (not an object), make it one!
-        if (!_patch_history_json_data.IsObject())
-            _patch_history_json_data.SetObject();
-        
-        // Has the session UUID been specified?
-        if (_patch_history_json_data.HasMember("session_uuid") && _patch_history_json_data["session_uuid"].IsString())
+        // Iterate through the aliases params
+        for (rapidjson::Value::ValueIterator itr = json_data.Begin(); itr != json_data.End(); ++itr)
         {
-            // Does this session UUID match the current?
-            if (_patch_history_json_data["session_uuid"].GetString() != utils::get_session_uuid())
+            Param *param = nullptr;
+            std::string alias_path = "";
+
+            // Has a param to alias been specified?
+            if (itr->GetObject().HasMember("param") && itr->GetObject()["param"].IsString())
             {
-                // New session - update the session UUID
-                _patch_history_json_data["session_uuid"].SetString(utils::get_session_uuid(), _patch_history_json_data.GetAllocator());
+                // Get this param
+                param = utils::get_param(itr->GetObject()["param"].GetString());
+            }
 
-                // Does any session history exist?
-                if (_patch_history_json_data.HasMember("session_history") && _patch_history_json_data["session_history"].IsArray())
-                {
-                    // Get the session history and erase it
-                    auto session_history = _patch_history_json_data["session_history"].GetArray();
-                    if (session_history.Size() > 0)
-                        session_history.Erase(session_history.Begin(), session_history.End());
-                }
+            // Has an alias been specified?
+            if (itr->GetObject().HasMember("alias") && itr->GetObject()["alias"].IsString())
+            {
+                // Get the alias path
+                alias_path = itr->GetObject()["alias"].GetString();
             }
+
+            // Alias specified correctly?
+            if (param && (alias_path.size() > 0)) {
+                // Create the alias param
+                // Copy the parameter and register it
+                std::unique_ptr<ParamAlias> alias_param = std::make_unique<ParamAlias>(alias_path, param);
+                alias_param->clear_mapped_params();
+                utils::register_param(std::move(alias_param));
+
+                // Map the alias to the param and vice-versa
+                auto ap = utils::get_param(alias_path);
+                if (ap) {
+                    param->add_mapped_param(ap);
+                    ap->add_mapped_param(param);
+                }                                
+            }                
         }
-        else
-        {
-            // Add the session UUID
-            _patch_history_json_data.AddMember("session_uuid", utils::get_session_uuid(), _patch_history_json_data.GetAllocator());
-        }      
-        
-        // Does the session history exist?
-        if (!_patch_history_json_data.HasMember("session_history"))
-        {
-            // Add the session history as an empty array
-            _patch_history_json_data.AddMember("session_history", rapidjson::Value(rapidjson::kArrayType), _patch_history_json_data.GetAllocator());
-        }
-        return true;
     }
-    return false;
+    utils::end_params_registration();
 }
-#endif
 
 //----------------------------------------------------------------------------
-// _open_and_parse_haptic_modes_file
+// _open_haptic_modes_file
 //----------------------------------------------------------------------------
-bool FileManager::_open_and_parse_haptic_modes_file()
+bool FileManager::_open_haptic_modes_file(rapidjson::Document &json_data)
 {
     const char *schema =
 #include "../json_schemas/haptic_modes_schema.json"
 ;
-    rapidjson::Document json_data;
 
     // Open the haptic modes file
-    bool ret = _open_json_file(NINA_ROOT_FILE_PATH(HAPTIC_MODES_FILE), schema, json_data, false);
-    if (ret)
-    {
-        // Initialise the haptic modes
-        utils::init_haptic_modes();
+    return _open_json_file(NINA_ROOT_FILE_PATH(HAPTIC_MODES_FILE), schema, json_data, false);
+}
 
-        // If the JSON data is empty its an invalid file
-        if (!json_data.IsObject())
-            return false;
+//----------------------------------------------------------------------------
+// _parse_haptic_modes
+//----------------------------------------------------------------------------
+bool FileManager::_parse_haptic_modes(rapidjson::Document &json_data)
+{
+    // Initialise the haptic modes
+    utils::init_haptic_modes();
 
-        // Get the default knob and switch haptic modes - these must always be present (schema checks this)
-        auto default_knob_haptic_mode = json_data["default_knob_haptic_mode"].GetString();
-        auto default_switch_haptic_mode = json_data["default_switch_haptic_mode"].GetString();
+    // If the JSON data is empty its an invalid file
+    if (!json_data.IsObject())
+        return false;
 
-        // Have any haptic modes been specified?
-        if (json_data.HasMember("haptic_modes") && json_data["haptic_modes"].IsArray())
+    // Get the default knob and switch haptic modes - these must always be present (schema checks this)
+    auto default_knob_haptic_mode = json_data["default_knob_haptic_mode"].GetString();
+    auto default_switch_haptic_mode = json_data["default_switch_haptic_mode"].GetString();
+
+    // Have any haptic modes been specified?
+    if (json_data.HasMember("haptic_modes") && json_data["haptic_modes"].IsArray())
+    {
+        // Parse each haptic mode
+        auto haptic_modes = json_data["haptic_modes"].GetArray();
+        for (auto& mode : haptic_modes)
         {
-            // Parse each haptic mode
-            auto haptic_modes = json_data["haptic_modes"].GetArray();
-            for (auto& mode : haptic_modes)
+            // Is the haptic mode entry valid?
+            if ((mode.HasMember("control_type") && mode["control_type"].IsString()) &&
+                (mode.HasMember("name") && mode["name"].IsString()))
             {
-                // Is the haptic mode entry valid?
-                if ((mode.HasMember("control_type") && mode["control_type"].IsString()) &&
-                    (mode.HasMember("name") && mode["name"].IsString()))
-                {
-                    auto haptic_mode = HapticMode();
-                    const char *control_type = mode["control_type"].GetString();
-                    const char *name = mode["name"].GetString();
+                auto haptic_mode = HapticMode();
+                const char *control_type = mode["control_type"].GetString();
+                const char *name = mode["name"].GetString();
 
-                    // Get the control type
-                    auto type = SurfaceControl::ControlTypeFromString(control_type);
-                    haptic_mode.type = type;
-                    haptic_mode.name = name;
+                // Get the control type
+                auto type = SurfaceControl::ControlTypeFromString(control_type);
+                haptic_mode.type = type;
+                haptic_mode.name = name;
 
-                    // Is this a knob?
-                    if (type == SurfaceControlType::KNOB)
+                // Is this a knob?
+                if (type == SurfaceControlType::KNOB)
+                {
+                    // Has the knob physical start pos been specified?
+                    if (mode.HasMember("knob_start_pos") && mode["knob_start_pos"].IsUint())
                     {
-                        // Has the knob physical start pos been specified?
-                        if (mode.HasMember("knob_start_pos") && mode["knob_start_pos"].IsUint())
+                        // Get the knob physical start pos and check it is valid
+                        auto start_pos = mode["knob_start_pos"].GetUint();
+                        if (start_pos <= 360)
                         {
-                            // Get the knob physical start pos and check it is valid
-                            auto start_pos = mode["knob_start_pos"].GetUint();
-                            if (start_pos <= 360)
-                            {
-                                // Set the knob physical start pos in the control mode
-                                haptic_mode.knob_start_pos = start_pos;
-                                haptic_mode.knob_actual_start_pos = start_pos;
-                            }
+                            // Set the knob physical start pos in the control mode
+                            haptic_mode.knob_start_pos = start_pos;
+                            haptic_mode.knob_actual_start_pos = start_pos;
                         }
+                    }
 
-                        // Has the knob physical width been specified?
-                        if (mode.HasMember("knob_width") && mode["knob_width"].IsUint())
+                    // Has the knob physical width been specified?
+                    if (mode.HasMember("knob_width") && mode["knob_width"].IsUint())
+                    {
+                        // Get the knob physical width and check it is valid
+                        auto width = mode["knob_width"].GetUint();
+                        if (width <= 360)
                         {
-                            // Get the knob physical width and check it is valid
-                            auto width = mode["knob_width"].GetUint();
-                            if (width <= 360)
-                            {
-                                // Set the knob physical width in the control mode
-                                haptic_mode.knob_width = width;
-                                haptic_mode.knob_actual_width = width;
-                            }
+                            // Set the knob physical width in the control mode
+                            haptic_mode.knob_width = width;
+                            haptic_mode.knob_actual_width = width;
                         }
+                    }
 
-                        // Has the knob actual start pos been specified?
-                        if (mode.HasMember("knob_actual_start_pos") && mode["knob_actual_start_pos"].IsUint())
+                    // Has the knob actual start pos been specified?
+                    if (mode.HasMember("knob_actual_start_pos") && mode["knob_actual_start_pos"].IsUint())
+                    {
+                        // Get the knob actual start pos and check it is valid
+                        auto start_pos = mode["knob_actual_start_pos"].GetUint();
+                        if (start_pos <= 360)
                         {
-                            // Get the knob actual start pos and check it is valid
-                            auto start_pos = mode["knob_actual_start_pos"].GetUint();
-                            if (start_pos <= 360)
-                            {
-                                // Set the knob actual start pos in the control mode
-                                haptic_mode.knob_actual_start_pos = start_pos;
-                            }
+                            // Set the knob actual start pos in the control mode
+                            haptic_mode.knob_actual_start_pos = start_pos;
                         }
+                    }
 
-                        // Has the knob actual width been specified?
-                        if (mode.HasMember("knob_actual_width") && mode["knob_actual_width"].IsUint())
+                    // Has the knob actual width been specified?
+                    if (mode.HasMember("knob_actual_width") && mode["knob_actual_width"].IsUint())
+                    {
+                        // Get the knob actual width and check it is valid
+                        auto width = mode["knob_actual_width"].GetUint();
+                        if (width <= 360)
                         {
-                            // Get the knob actual width and check it is valid
-                            auto width = mode["knob_actual_width"].GetUint();
-                            if (width <= 360)
-                            {
-                                // Set the knob actual width in the control mode
-                                haptic_mode.knob_actual_width = width;
-                            }
+                            // Set the knob actual width in the control mode
+                            haptic_mode.knob_actual_width = width;
                         }
+                    }
 
-                        // Have the number of detents been specified?
-                        if (mode.HasMember("knob_num_detents") && mode["knob_num_detents"].IsUint())
-                        {
-                            // Set the knob number of detents in the control mode
-                            haptic_mode.knob_num_detents = mode["knob_num_detents"].GetUint();
-                        }
+                    // Have the number of detents been specified?
+                    if (mode.HasMember("knob_num_detents") && mode["knob_num_detents"].IsUint())
+                    {
+                        // Set the knob number of detents in the control mode
+                        haptic_mode.knob_num_detents = mode["knob_num_detents"].GetUint();
+                    }
 
-                        // Has the friction been specified?
-                        if (mode.HasMember("knob_friction") && mode["knob_friction"].IsUint())
-                        {
-                            // Set the knob friction in the control mode
-                            haptic_mode.knob_friction = mode["knob_friction"].GetUint();
-                        }
+                    // Has the friction been specified?
+                    if (mode.HasMember("knob_friction") && mode["knob_friction"].IsUint())
+                    {
+                        // Set the knob friction in the control mode
+                        haptic_mode.knob_friction = mode["knob_friction"].GetUint();
+                    }
 
-                        // Has the detent strength been specified?
-                        if (mode.HasMember("knob_detent_strength") && mode["knob_detent_strength"].IsUint())
-                        {
-                            // Set the knob detent strength in the control mode
-                            haptic_mode.knob_detent_strength = mode["knob_detent_strength"].GetUint();
-                        }
+                    // Has the detent strength been specified?
+                    if (mode.HasMember("knob_detent_strength") && mode["knob_detent_strength"].IsUint())
+                    {
+                        // Set the knob detent strength in the control mode
+                        haptic_mode.knob_detent_strength = mode["knob_detent_strength"].GetUint();
+                    }
 
-                        // Have the indents been specified?
-                        if (mode.HasMember("knob_indents") && mode["knob_indents"].IsArray())
+                    // Have the indents been specified?
+                    if (mode.HasMember("knob_indents") && mode["knob_indents"].IsArray())
+                    {
+                        // Parse each indent
+                        auto indents_array = mode["knob_indents"].GetArray();
+                        for (auto& indent : indents_array)
                         {
-                            // Parse each indent
-                            auto indents_array = mode["knob_indents"].GetArray();
-                            for (auto& indent : indents_array)
+                            // Add the indent
+                            if ((indent.HasMember("angle") && indent["angle"].IsUint()) && 
+                                (indent.HasMember("hw_active") && indent["hw_active"].IsBool()))
                             {
-                                // Add the indent
-                                if ((indent.HasMember("angle") && indent["angle"].IsUint()) && 
-                                    (indent.HasMember("hw_active") && indent["hw_active"].IsBool()))
+                                // Check the angle is valid
+                                uint angle = indent["angle"].GetUint();
+                                if (angle <= 360)
                                 {
-                                    // Check the angle is valid
-                                    uint angle = indent["angle"].GetUint();
-                                    if (angle <= 360)
-                                    {
-                                        // Convert the indent to a hardware value and push the indent
-                                        std::pair<bool, uint> knob_indent;
-                                        knob_indent.first = indent["hw_active"].GetBool();
-                                        knob_indent.second = (angle / 360.0f) * FLOAT_TO_KNOB_HW_VALUE_SCALING_FACTOR;
-                                        haptic_mode.knob_indents.push_back(knob_indent);
-                                    }
+                                    // Convert the indent to a hardware value and push the indent
+                                    std::pair<bool, uint> knob_indent;
+                                    knob_indent.first = indent["hw_active"].GetBool();
+                                    knob_indent.second = (angle / 360.0f) * FLOAT_TO_KNOB_HW_VALUE_SCALING_FACTOR;
+                                    haptic_mode.knob_indents.push_back(knob_indent);
                                 }
                             }
                         }
                     }
-                    // Is this a switch?
-                    else if (type == SurfaceControlType::SWITCH)
+                }
+                // Is this a switch?
+                else if (type == SurfaceControlType::SWITCH)
+                {
+                    // Has the switch mode been specified?
+                    if (mode.HasMember("switch_mode") && mode["switch_mode"].IsUint())
                     {
-                        // Has the switch mode been specified?
-                        if (mode.HasMember("switch_mode") && mode["switch_mode"].IsUint())
+                        // Get the switch mode and set in the control
+                        auto switch_mode = mode["switch_mode"].GetUint();
+                        if (switch_mode <= uint(SwitchMode::LATCH_PUSH))
                         {
-                            // Get the switch mode and set in the control
-                            auto switch_mode = mode["switch_mode"].GetUint();
-                            if (switch_mode <= uint(SwitchMode::LATCH_PUSH))
-                            {
-                                // Set the switch mode
-                                haptic_mode.switch_mode = static_cast<SwitchMode>(switch_mode);
-                            }
+                            // Set the switch mode
+                            haptic_mode.switch_mode = static_cast<SwitchMode>(switch_mode);
                         }
                     }
-
-                    // Add the haptic mode
-                    utils::add_haptic_mode(haptic_mode);
                 }
+
+                // Add the haptic mode
+                utils::add_haptic_mode(haptic_mode);
             }
         }
+    }
 
-        // Set the default knob and switch haptic modes
-        if (!utils::set_default_haptic_mode(SurfaceControlType::KNOB, default_knob_haptic_mode))
-        {
-            // Default mode does not exist
-            MSG("The default knob haptic mode " << default_knob_haptic_mode << " does not exist, created a default");
-            NINA_LOG_WARNING(module(), "The default knob haptic mode {} does not exist, created a default", default_knob_haptic_mode);          
-        }
-        if (!utils::set_default_haptic_mode(SurfaceControlType::SWITCH, default_switch_haptic_mode))
-        {
-            // Default mode does not exist
-            MSG("The default switch haptic mode " << default_switch_haptic_mode << " does not exist, created a default");
-            NINA_LOG_WARNING(module(), "The default switch haptic mode {} does not exist, created a default", default_switch_haptic_mode);          
-        }
+    // Set the default knob and switch haptic modes
+    if (!utils::set_default_haptic_mode(SurfaceControlType::KNOB, default_knob_haptic_mode))
+    {
+        // Default mode does not exist
+        MSG("The default knob haptic mode " << default_knob_haptic_mode << " does not exist, created a default");
+        NINA_LOG_WARNING(module(), "The default knob haptic mode {} does not exist, created a default", default_knob_haptic_mode);          
     }
-    return ret;
+    if (!utils::set_default_haptic_mode(SurfaceControlType::SWITCH, default_switch_haptic_mode))
+    {
+        // Default mode does not exist
+        MSG("The default switch haptic mode " << default_switch_haptic_mode << " does not exist, created a default");
+        NINA_LOG_WARNING(module(), "The default switch haptic mode {} does not exist, created a default", default_switch_haptic_mode);          
+    }
+    return true;
 }
 
 //----------------------------------------------------------------------------
@@ -2714,12 +2970,14 @@ bool FileManager::_open_and_parse_haptic_modes_file()
 //----------------------------------------------------------------------------
 bool FileManager::_open_json_file(std::string file_path, const char *schema, rapidjson::Document &json_data, bool create, std::string def_contents)
 {
-    rapidjson::Document schema_data;  
+    // If this file has just been saved, make sure it has been written first
+    _wait_for_json_save(file_path);
     
     // Open the JSON file
     std::fstream json_file;
     json_data.SetNull();
     json_data.GetAllocator().Clear();    
+    _invalidate_json_path_indexes();
     json_file.open(file_path, std::fstream::in);
     if (!json_file.good())
     {
@@ -2765,9 +3023,17 @@ bool FileManager::_open_json_file(std::string file_path, const char *schema, rap
         return false;
     }
 
-    // Get the JSON schema and ensure there are no schema errors
-    schema_data.Parse(schema);
-    if (schema_data.HasParseError())
+    // If this process wrote the file, and it hasn't been changed since, there is no
+    // need to validate it against the schema
+    if (_is_trusted_json_file(file_path, json_file_contents))
+    {
+        json_file.close();
+        return true;
+    }
+
+    // Get the compiled JSON schema and ensure there are no schema errors
+    auto schema_document = _get_json_schema(schema);
+    if (!schema_document)
     {
         DEBUG_BASEMGR_MSG("JSON schema error: " << file_path);
         json_data.Parse(def_contents);
@@ -2776,8 +3042,7 @@ bool FileManager::_open_json_file(std::string file_path, const char *schema, rap
     }
 
     // Now validate the JSON data against the passed schema
-    rapidjson::SchemaDocument schema_document(schema_data);
-    rapidjson::SchemaValidator schema_validator(schema_document);
+    rapidjson::SchemaValidator schema_validator(*schema_document);
     if (!json_data.Accept(schema_validator))
     {
         DEBUG_BASEMGR_MSG("Schema validation failed: " << file_path);
@@ -2791,6 +3056,76 @@ bool FileManager::_open_json_file(std::string file_path, const char *schema, rap
     return true;
 }
 
+//----------------------------------------------------------------------------
+// _get_json_schema
+//----------------------------------------------------------------------------
+const rapidjson::SchemaDocument *FileManager::_get_json_schema(const char *schema)
+{
+    // Has this schema already been compiled?
+    // Note: The schemas are all compiled into the app, so the schema pointer
+    // identifies the schema
+    {
+        std::lock_guard<std::mutex> lock(_json_schema_mutex);
+        auto itr = _json_schemas.find(schema);
+        if (itr != _json_schemas.end())
+            return itr->second->schema_document.get();
+    }
+
+    // Parse and compile the schema
+    // This is done without the mutex held, so that files with different schemas can be
+    // opened in parallel
+    auto compiled_schema = std::make_unique<CompiledJsonSchema>();
+    compiled_schema->schema_data.Parse(schema);
+    if (compiled_schema->schema_data.HasParseError())
+        return nullptr;
+    compiled_schema->schema_document = std::make_unique<rapidjson::SchemaDocument>(compiled_schema->schema_data);
+
+    // Add it to the compiled schemas - if another thread has compiled the same schema
+    // in the meantime, that schema is used
+    std::lock_guard<std::mutex> lock(_json_schema_mutex);
+    auto itr = _json_schemas.emplace(schema, std::move(compiled_schema)).first;
+    return itr->second->schema_document.get();
+}
+
+//----------------------------------------------------------------------------
+// _set_trusted_json_file
+//----------------------------------------------------------------------------
+void FileManager::_set_trusted_json_file(const std::string& file_path, uint64_t hash)
+{
+    // Get the trusted JSON files mutex
+    std::lock_guard<std::mutex> lock(_trusted_json_files_mutex);
+
+    // Record the hash of the file contents written by this process
+    _trusted_json_files[file_path] = hash;
+}
+
+//----------------------------------------------------------------------------
+// _is_trusted_json_file
+//----------------------------------------------------------------------------
+bool FileManager::_is_trusted_json_file(const std::string& file_path, const std::string& contents)
+{
+    // Get the trusted JSON files mutex
+    std::lock_guard<std::mutex> lock(_trusted_json_files_mutex);
+
+    // The file is trusted if this process wrote it, and the contents still match
+    auto itr = _trusted_json_files.find(file_path);
+    return (itr != _trusted_json_files.end()) && (itr->second == _hash_json_file_contents(contents.data(), contents.size()));
+}
+
+//----------------------------------------------------------------------------
+// _hash_json_file_contents
+//----------------------------------------------------------------------------
+uint64_t FileManager::_hash_json_file_contents(const char *data, size_t size)
+{
+    // Calculate the 64-bit FNV-1a hash of the data
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i=0; i<size; i++) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
 //----------------------------------------------------------------------------
 // _parse_config
 //----------------------------------------------------------------------------
@@ -2892,39 +3227,140 @@ void FileManager::_parse_config()
         save_config_file = true;
     }
 
-    // Try and convert the system colour to an integer and set the system colour
-    try {
-        [[maybe_unused]] auto colour = std::stoi(system_colour, nullptr, 16);
+    // Try and convert the system colour to an integer and set the system colour
+    try {
+        [[maybe_unused]] auto colour = std::stoi(system_colour, nullptr, 16);
+    }
+    catch (...) {
+        system_colour = DEFAULT_SYSTEM_COLOUR;
+    }
+    utils::system_config()->set_system_colour(system_colour);
+
+    // Get the OSC config values, if present
+    if ((_config_json_data.HasMember("osc_host_ip") && _config_json_data["osc_host_ip"].IsString()) &&
+        (_config_json_data.HasMember("osc_incoming_port") && _config_json_data["osc_incoming_port"].IsString()) &&
+        (_config_json_data.HasMember("osc_outgoing_port") && _config_json_data["osc_outgoing_port"].IsString()))
+    {
+        // Initialise the OSC config
+        utils::system_config()->init_osc_config(_config_json_data["osc_host_ip"].GetString(),
+                                                    _config_json_data["osc_incoming_port"].GetString(),
+                                                    _config_json_data["osc_outgoing_port"].GetString());
+        
+        // Has an OSC send count been specified?
+        if (_config_json_data.HasMember("osc_send_count") && _config_json_data["osc_send_count"].IsUint())
+        {
+            // Set the OSC send count
+            utils::system_config()->set_osc_send_count(_config_json_data["osc_send_count"].GetUint());
+        }                                             
+    }
+    else
+    {
+        // Set OSC config defaults to empty strings
+        _config_json_data.AddMember("osc_host_ip", "", _config_json_data.GetAllocator());
+        _config_json_data.AddMember("osc_incoming_port", "", _config_json_data.GetAllocator());
+        _config_json_data.AddMember("osc_outgoing_port", "", _config_json_data.GetAllocator());
+        save_config_file = true;        
+    }
+
+    // Has the note transport been specified?
+    if (_config_json_data.HasMember("note_transport") && _config_json_data["note_transport"].IsString())
+    {
+        // Set the note transport, defaulting to gRPC if not recognised
+        std::string note_transport = _config_json_data["note_transport"].GetString();
+        utils::system_config()->set_note_transport((note_transport == NOTE_TRANSPORT_ALSA_SEQ) ? NoteTransport::ALSA_SEQ : NoteTransport::GRPC);
+    }
+    else
+    {
+        // Create the note transport
+        _config_json_data.AddMember("note_transport", NOTE_TRANSPORT_GRPC, _config_json_data.GetAllocator());
+        utils::system_config()->set_note_transport(NoteTransport::GRPC);
+        save_config_file = true;
+    }
+
+    // Has the JSON file format been specified?
+    if (_config_json_data.HasMember("pretty_json_files") && _config_json_data["pretty_json_files"].IsBool())
+    {
+        // Set if JSON files are saved pretty printed or compact
+        utils::system_config()->set_pretty_json_files(_config_json_data["pretty_json_files"].GetBool());
+    }
+    else
+    {
+        // Create the JSON file format
+        _config_json_data.AddMember("pretty_json_files", true, _config_json_data.GetAllocator());
+        utils::system_config()->set_pretty_json_files(true);
+        save_config_file = true;
+    }
+
+    // Has the patch cache memory budget been specified?
+    if (_config_json_data.HasMember("patch_cache_memory_budget_kb") && _config_json_data["patch_cache_memory_budget_kb"].IsUint())
+    {
+        // Set the patch cache memory budget
+        utils::system_config()->set_patch_cache_memory_budget(_config_json_data["patch_cache_memory_budget_kb"].GetUint());
+    }
+    else
+    {
+        // Create the patch cache memory budget
+        _config_json_data.AddMember("patch_cache_memory_budget_kb", DEFAULT_PATCH_CACHE_MEMORY_BUDGET_KB, _config_json_data.GetAllocator());
+        utils::system_config()->set_patch_cache_memory_budget(DEFAULT_PATCH_CACHE_MEMORY_BUDGET_KB);
+        save_config_file = true;
+    }
+    _patch_cache.set_memory_budget(utils::system_config()->get_patch_cache_memory_budget() * 1024);
+
+    // Has the surface poll minimum interval been specified?
+    if (_config_json_data.HasMember("surface_poll_min_interval_ms") && _config_json_data["surface_poll_min_interval_ms"].IsUint())
+    {
+        // Set the surface poll minimum interval
+        utils::system_config()->set_surface_poll_min_interval(_config_json_data["surface_poll_min_interval_ms"].GetUint());
+    }
+    else
+    {
+        // Create the surface poll minimum interval
+        _config_json_data.AddMember("surface_poll_min_interval_ms", DEFAULT_SURFACE_POLL_MIN_INTERVAL_MS, _config_json_data.GetAllocator());
+        utils::system_config()->set_surface_poll_min_interval(DEFAULT_SURFACE_POLL_MIN_INTERVAL_MS);
+        save_config_file = true;
+    }
+
+    // Has the surface poll maximum interval been specified?
+    if (_config_json_data.HasMember("surface_poll_max_interval_ms") && _config_json_data["surface_poll_max_interval_ms"].IsUint())
+    {
+        // Set the surface poll maximum interval
+        utils::system_config()->set_surface_poll_max_interval(_config_json_data["surface_poll_max_interval_ms"].GetUint());
+    }
+    else
+    {
+        // Create the surface poll maximum interval
+        _config_json_data.AddMember("surface_poll_max_interval_ms", DEFAULT_SURFACE_POLL_MAX_INTERVAL_MS, _config_json_data.GetAllocator());
+        utils::system_config()->set_surface_poll_max_interval(DEFAULT_SURFACE_POLL_MAX_INTERVAL_MS);
+        save_config_file = true;
+    }
+
+    // Has the latency trace sample interval been specified?
+    if (_config_json_data.HasMember("latency_trace_sample_interval") && _config_json_data["latency_trace_sample_interval"].IsUint())
+    {
+        // Set the latency trace sample interval
+        utils::system_config()->set_latency_trace_sample_interval(_config_json_data["latency_trace_sample_interval"].GetUint());
     }
-    catch (...) {
-        system_colour = DEFAULT_SYSTEM_COLOUR;
+    else
+    {
+        // Create the latency trace sample interval (disabled)
+        _config_json_data.AddMember("latency_trace_sample_interval", DEFAULT_LATENCY_TRACE_SAMPLE_INTERVAL, _config_json_data.GetAllocator());
+        utils::system_config()->set_latency_trace_sample_interval(DEFAULT_LATENCY_TRACE_SAMPLE_INTERVAL);
+        save_config_file = true;
     }
-    utils::system_config()->set_system_colour(system_colour);
+    LatencyTrace::SetSampleInterval(utils::system_config()->get_latency_trace_sample_interval());
 
-    // Get the OSC config values, if present
-    if ((_config_json_data.HasMember("osc_host_ip") && _config_json_data["osc_host_ip"].IsString()) &&
-        (_config_json_data.HasMember("osc_incoming_port") && _config_json_data["osc_incoming_port"].IsString()) &&
-        (_config_json_data.HasMember("osc_outgoing_port") && _config_json_data["osc_outgoing_port"].IsString()))
+    // Has the MIDI event queue minimum interval been specified?
+    if (_config_json_data.HasMember("midi_event_queue_min_interval_ms") && _config_json_data["midi_event_queue_min_interval_ms"].IsUint())
     {
-        // Initialise the OSC config
-        utils::system_config()->init_osc_config(_config_json_data["osc_host_ip"].GetString(),
-                                                    _config_json_data["osc_incoming_port"].GetString(),
-                                                    _config_json_data["osc_outgoing_port"].GetString());
-        
-        // Has an OSC send count been specified?
-        if (_config_json_data.HasMember("osc_send_count") && _config_json_data["osc_send_count"].IsUint())
-        {
-            // Set the OSC send count
-            utils::system_config()->set_osc_send_count(_config_json_data["osc_send_count"].GetUint());
-        }                                             
+        // Set the MIDI event queue minimum interval
+        utils::system_config()->set_midi_event_queue_min_interval(_config_json_data["midi_event_queue_min_interval_ms"].GetUint());
     }
     else
     {
-        // Set OSC config defaults to empty strings
-        _config_json_data.AddMember("osc_host_ip", "", _config_json_data.GetAllocator());
-        _config_json_data.AddMember("osc_incoming_port", "", _config_json_data.GetAllocator());
-        _config_json_data.AddMember("osc_outgoing_port", "", _config_json_data.GetAllocator());
-        save_config_file = true;        
+        // Create the MIDI event queue minimum interval
+        _config_json_data.AddMember("midi_event_queue_min_interval_ms", DEFAULT_MIDI_EVENT_QUEUE_MIN_INTERVAL_MS, _config_json_data.GetAllocator());
+        utils::system_config()->set_midi_event_queue_min_interval(DEFAULT_MIDI_EVENT_QUEUE_MIN_INTERVAL_MS);
+        save_config_file = true;
     }
 
     // Does the config file need saving?
@@ -2937,6 +3373,10 @@ void FileManager::_parse_config()
 //----------------------------------------------------------------------------
 void FileManager::_parse_param_map()
 {
+    // Register the params created by the param map as a batch, the params registry is
+    // published once they have all been registered
+    utils::begin_params_registration();
+
     // Iterate through the param map
     for (rapidjson::Value::ValueIterator itr = _param_map_json_data.Begin(); itr != _param_map_json_data.End(); ++itr)
     {
@@ -3124,6 +3564,7 @@ void FileManager::_parse_param_map()
             }
         }
     }
+    utils::end_params_registration();
 }
 
 //----------------------------------------------------------------------------
@@ -3144,6 +3585,9 @@ void FileManager::_parse_patch(uint layer_num, bool set_layer_params)
     // Get the patch params and parse them
     auto params = utils::get_patch_params();
 
+    // The layer value banks are captured again as the patch is parsed
+    _invalidate_value_banks(layer_num);
+
     // When loading patches, the param states and params that map to a state
     // change are reset (only do this for the current layer)
     if (current_layer) {
@@ -3170,16 +3614,22 @@ void FileManager::_parse_patch(uint layer_num, bool set_layer_params)
 
     // Process the patch alternate (not default) state params
     _parse_patch_state_params(current_layer, params, alt_state);
+    _capture_value_bank(_get_state_value_bank(layer_num, alt_state), layer_num, params, false);
 
     // Set the patch alternate (not default) params in the DAW
     _daw_manager->set_patch_params(layer_num, false, alt_state);
 
     // Process the patch default state params
     _parse_patch_state_params(current_layer, params, default_state);
+    _capture_value_bank(_get_state_value_bank(layer_num, default_state), layer_num, params, false);
+    _capture_value_bank(_get_common_value_bank(layer_num), layer_num, params, true);
 
     // Set the patch default (common + state) params in the DAW
     _daw_manager->set_patch_params(layer_num, true, default_state);
 
+    // Update the local morph states for this layer
+    _update_morph_engine_states(layer_num);
+
     // Should we process the layer params?
     if (set_layer_params) {
         // Process the patch layer params
@@ -3286,25 +3736,7 @@ void FileManager::_parse_patch_common_params(uint layer_num, bool current_layer,
 
                         // Special case handling if this is the current layer
                         if (current_layer) {
-                            // Special case (yet another one) for Arpeggiator enable (a common patch param)
-                            // The Arpeggiator enable is not mapped to a surface control, instead the ARP system function is
-                            // However, we need to make sure the surface control is set to the Arpeggiator enable value so that it
-                            // shows the correct state when the patch is loaded
-                            if ((p->module == NinaModule::ARPEGGIATOR) && (p->param_id == ArpeggiatorParamId::ARP_ENABLE_PARAM_ID)) {
-                                // We can assume that the ARP system function is mapped to a physical switch
-                                // Hence we need to get the ARP system function and it's (one and only) mapped param which
-                                // is the switch
-                                auto param = utils::get_sys_func_param(SystemFuncType::ARP);
-                                if (param) {
-                                    // Get the mapped params for the ARP system function (there should only be one, 
-                                    // mapped to a surface control)
-                                    auto mapped_params = param->get_mapped_params();
-                                    if ((mapped_params.size() == 1) && (mapped_params.at(0)->module == NinaModule::SURFACE_CONTROL)) {
-                                        // Set the surface control value to the actual ARP enable parameter value
-                                        mapped_params.at(0)->set_value_from_param(*p);
-                                    }
-                                }
-                            }
+                            _sync_arp_enable_surface_control(p);
                         }
                     }
                     param_missed = false;
@@ -3379,37 +3811,11 @@ void FileManager::_parse_patch_common_params(uint layer_num, bool current_layer,
             if (current_layer) {
                 // We need to check for the special case of LFO 1 Tempo Sync if LFO 1 is selected
                 if (p == utils::get_lfo_1_tempo_sync_param()) {
-                    // Clean up the LFO states
-                    utils::pop_all_lfo_states();
-
-                    // If the required and current LFO states do not match
-                    if (utils::get_req_lfo_1_state().state != utils::get_current_lfo_state().state) {
-                        // If LFO 1 is in sync rate mode
-                        if (utils::lfo_1_sync_rate()) {
-                            auto lfo_state = utils::get_req_lfo_1_state();
-
-                            // Push the LFO 1 sync rate state to the relevant controls
-                            auto params = utils::get_params_with_state(lfo_state.state);
-                            for (auto p: params) {
-                                utils::push_param_state(p->get_path(), lfo_state.state);
-                            }
-                            utils::push_lfo_state(lfo_state);                     
-                        }
-                        else {
-                            auto lfo_state = utils::get_current_lfo_state();
-
-                            // Pop the current LFO state from the relevant controls
-                            auto params = utils::get_params_with_state(lfo_state.state);
-                            for (auto p: params) {
-                                utils::pop_param_state(p->get_path(), lfo_state.state);
-                            }
-                            utils::pop_lfo_state();
-                        }
-                    }
+                    _process_lfo_1_tempo_sync_state();
                 }
 
                 // Process the mapped params
-                _process_patch_mapped_params(p, nullptr);
+                _process_patch_mapped_params(p);
             }
         }
     }
@@ -3529,7 +3935,7 @@ void FileManager::_parse_patch_state_params(bool current_layer, std::vector<Para
 
             // Process the mapped params if this is the current layer
             if (current_layer) {
-                _process_patch_mapped_params(p, nullptr);
+                _process_patch_mapped_params(p);
             }
         }
     }
@@ -3538,30 +3944,20 @@ void FileManager::_parse_patch_state_params(bool current_layer, std::vector<Para
 //----------------------------------------------------------------------------
 // _process_patch_mapped_params
 //----------------------------------------------------------------------------
-void FileManager::_process_patch_mapped_params(const Param *param, const Param *skip_param)
+void FileManager::_process_patch_mapped_params(const Param *param)
 {
-    // Get the mapped params
-    auto mapped_params = param->get_mapped_params();
-    for (Param *mp : mapped_params)
+    // Get the compiled mapping graph for this param, and process each mapped param
+    auto mapped_param_graph = param->get_mapped_param_graph();
+    for (const MappedParamDest& dest : *mapped_param_graph)
     {
-        // Because this function is recursive, we need to skip the param that
-        // caused any recursion, so it is not processed twice
-        if (skip_param && (mp == skip_param)) {
-            continue;
-        }
-
         // Set the mapped param?
         // Only process common and module params (except for the MIDI module)
+        Param *mp = dest.param;
         if (((mp->type == ParamType::COMMON_PARAM) || (mp->type == ParamType::MODULE_PARAM)) &&
             (mp->module != NinaModule::MIDI_DEVICE)) {
-            // Set the source param value from this param
-            mp->set_value_from_param(*param);
+            // Set the mapped param value from the param it is mapped from
+            mp->set_value_from_param(*dest.source);
         }
-
-        // We need to recurse each mapped param and process it
-        // Note: We don't recurse system function params as they are a system action to be performed
-        if (mp->type != ParamType::SYSTEM_FUNC)
-            _process_patch_mapped_params(mp, param);        
     }    
 }
 
@@ -3571,6 +3967,9 @@ void FileManager::_process_patch_mapped_params(const Param *param, const Param *
 //----------------------------------------------------------------------------
 void FileManager::_set_patch_state_b_params(rapidjson::Document &from_patch_json_doc)
 {
+    // The State B value bank is captured again when State B is next loaded
+    _get_state_value_bank(utils::get_current_layer_info().layer_num(), PatchState::STATE_B).invalidate();
+
     // Get the patch params and parse them
     auto params = utils::get_patch_params();
     for (Param *p : params)
@@ -3642,6 +4041,232 @@ void FileManager::_set_patch_state_b_params(rapidjson::Document &from_patch_json
     }
 }
 
+//----------------------------------------------------------------------------
+// _sync_arp_enable_surface_control
+//----------------------------------------------------------------------------
+void FileManager::_sync_arp_enable_surface_control(const Param *param)
+{
+    // Special case (yet another one) for Arpeggiator enable (a common patch param)
+    // The Arpeggiator enable is not mapped to a surface control, instead the ARP system function is
+    // However, we need to make sure the surface control is set to the Arpeggiator enable value so that it
+    // shows the correct state when the patch is loaded
+    if ((param->module == NinaModule::ARPEGGIATOR) && (param->param_id == ArpeggiatorParamId::ARP_ENABLE_PARAM_ID)) {
+        // We can assume that the ARP system function is mapped to a physical switch
+        // Hence we need to get the ARP system function and it's (one and only) mapped param which
+        // is the switch
+        auto sys_func_param = utils::get_sys_func_param(SystemFuncType::ARP);
+        if (sys_func_param) {
+            // Get the mapped params for the ARP system function (there should only be one, 
+            // mapped to a surface control)
+            auto mapped_params = sys_func_param->get_mapped_params();
+            if ((mapped_params.size() == 1) && (mapped_params.at(0)->module == NinaModule::SURFACE_CONTROL)) {
+                // Set the surface control value to the actual ARP enable parameter value
+                mapped_params.at(0)->set_value_from_param(*param);
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _process_lfo_1_tempo_sync_state
+//----------------------------------------------------------------------------
+void FileManager::_process_lfo_1_tempo_sync_state()
+{
+    // Clean up the LFO states
+    utils::pop_all_lfo_states();
+
+    // If the required and current LFO states do not match
+    if (utils::get_req_lfo_1_state().state != utils::get_current_lfo_state().state) {
+        // If LFO 1 is in sync rate mode
+        if (utils::lfo_1_sync_rate()) {
+            auto lfo_state = utils::get_req_lfo_1_state();
+
+            // Push the LFO 1 sync rate state to the relevant controls
+            auto params = utils::get_params_with_state(lfo_state.state);
+            for (auto p: params) {
+                utils::push_param_state(p->get_path(), lfo_state.state);
+            }
+            utils::push_lfo_state(lfo_state);                     
+        }
+        else {
+            auto lfo_state = utils::get_current_lfo_state();
+
+            // Pop the current LFO state from the relevant controls
+            auto params = utils::get_params_with_state(lfo_state.state);
+            for (auto p: params) {
+                utils::pop_param_state(p->get_path(), lfo_state.state);
+            }
+            utils::pop_lfo_state();
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _load_patch_common_params
+//----------------------------------------------------------------------------
+void FileManager::_load_patch_common_params(uint layer_num, std::vector<Param *> &params)
+{
+    // Load the current layer common params from the layer value bank - if the bank cannot
+    // be used, parse them from the layer patch instead and capture the bank for the next load
+    auto& bank = _get_common_value_bank(layer_num);
+    if (!_apply_value_bank(bank, layer_num, params, true)) {
+        _parse_patch_common_params(layer_num, true, params);
+        _capture_value_bank(bank, layer_num, params, true);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _load_patch_state_params
+//----------------------------------------------------------------------------
+void FileManager::_load_patch_state_params(uint layer_num, std::vector<Param *> &params, PatchState state)
+{
+    // Load the current layer state params from the layer state value bank - if the bank cannot
+    // be used, parse them from the layer patch instead and capture the bank for the next load
+    auto& bank = _get_state_value_bank(layer_num, state);
+    if (!_apply_value_bank(bank, layer_num, params, false)) {
+        _parse_patch_state_params(true, params, state);
+        _capture_value_bank(bank, layer_num, params, false);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _apply_value_bank
+// Note: The patch mutex must be held by the caller
+//----------------------------------------------------------------------------
+bool FileManager::_apply_value_bank(ParamValueBank &bank, uint layer_num, std::vector<Param *> &params, bool common)
+{
+    // The bank can only be used if it holds a value for every param that would be parsed, and
+    // no string value has changed - loading a string param (for example the wavetable name) has
+    // side effects, so this is left to the patch parse
+    if (!bank.can_apply(params, [this, layer_num, common](const Param *p) { return _is_value_bank_param(layer_num, p, common); })) {
+        return false;
+    }
+
+    // Set each param that differs from the bank value
+    // Note: The mapped params are always processed (as when parsing the patch), as the param
+    // states and therefore the param mappings may have been reset
+    for (Param *p : params)
+    {
+        if (_is_value_bank_param(layer_num, p, common)) {
+            if (!p->str_param && bank.contains(p) && (p->get_value() != bank.get_value(p))) {
+                p->set_value(bank.get_value(p));
+            }
+
+            // Process the common param special cases
+            if (common) {
+                _sync_arp_enable_surface_control(p);
+                if (p == utils::get_lfo_1_tempo_sync_param()) {
+                    _process_lfo_1_tempo_sync_state();
+                }
+            }
+
+            // Process the mapped params
+            _process_patch_mapped_params(p);
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _capture_value_bank
+// Note: The patch mutex must be held by the caller
+//----------------------------------------------------------------------------
+void FileManager::_capture_value_bank(ParamValueBank &bank, uint layer_num, std::vector<Param *> &params, bool common)
+{
+    // Capture the param values just parsed into the bank
+    bank.capture(params, [this, layer_num, common](const Param *p) { return _is_value_bank_param(layer_num, p, common); });
+}
+
+//----------------------------------------------------------------------------
+// _get_common_value_bank
+//----------------------------------------------------------------------------
+ParamValueBank &FileManager::_get_common_value_bank(uint layer_num)
+{
+    // Return the layer common params value bank
+    return _layer_common_value_banks[layer_num];
+}
+
+//----------------------------------------------------------------------------
+// _get_state_value_bank
+//----------------------------------------------------------------------------
+ParamValueBank &FileManager::_get_state_value_bank(uint layer_num, PatchState state)
+{
+    // Return the layer state params value bank
+    return _layer_state_value_banks[layer_num][(state == PatchState::STATE_A) ? 0 : 1];
+}
+
+//----------------------------------------------------------------------------
+// _get_param_value_bank
+//----------------------------------------------------------------------------
+ParamValueBank *FileManager::_get_param_value_bank(uint layer_num, const Param *param)
+{
+    // Layer params are not held in a value bank
+    if (param->patch_layer_param) {
+        return nullptr;
+    }
+
+    // A state param is held in the bank for the layer's current state, and a common param in
+    // the layer common bank (Layer 1 for a Layer 1 only param), as when finding the param in the
+    // layer patch
+    if (param->patch_state_param) {
+        return &_get_state_value_bank(layer_num, utils::get_layer_info(layer_num).get_patch_state());
+    }
+    return &_get_common_value_bank(param->layer_1_param ? 0 : layer_num);
+}
+
+//----------------------------------------------------------------------------
+// _update_value_bank
+// Note: The patch mutex must be held by the caller
+//----------------------------------------------------------------------------
+void FileManager::_update_value_bank(uint layer_num, const Param *param, float value)
+{
+    // Update the param value in its layer value bank, so that the bank is kept the same
+    // as the layer patch
+    auto bank = _get_param_value_bank(layer_num, param);
+    if (bank) {
+        bank->set_value(param, value);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _update_value_bank
+// Note: The patch mutex must be held by the caller
+//----------------------------------------------------------------------------
+void FileManager::_update_value_bank(uint layer_num, const Param *param, const std::string& str_value)
+{
+    // Update the param string value in its layer value bank, so that the bank is kept the
+    // same as the layer patch
+    auto bank = _get_param_value_bank(layer_num, param);
+    if (bank) {
+        bank->set_str_value(param, str_value);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _invalidate_value_banks
+//----------------------------------------------------------------------------
+void FileManager::_invalidate_value_banks(uint layer_num)
+{
+    // Invalidate the layer value banks, they are captured again when the layer patch
+    // is next parsed
+    _layer_common_value_banks[layer_num].invalidate();
+    _layer_state_value_banks[layer_num][0].invalidate();
+    _layer_state_value_banks[layer_num][1].invalidate();
+}
+
+//----------------------------------------------------------------------------
+// _is_value_bank_param
+//----------------------------------------------------------------------------
+bool FileManager::_is_value_bank_param(uint layer_num, const Param *param, bool common)
+{
+    // The common bank holds the same params parsed as the patch common params (a Layer 1 only
+    // param is only held for Layer 1), and the state bank the patch state params
+    if (common) {
+        return !param->patch_state_param && !param->patch_layer_param && (!param->layer_1_param || (layer_num == 0));
+    }
+    return param->patch_state_param;
+}
+
 //----------------------------------------------------------------------------
 // _save_config_file
 //----------------------------------------------------------------------------
@@ -3766,8 +4391,8 @@ void FileManager::_save_patch_file(PatchId id)
         }
     }
 
-    // Save the patch file
-    _save_json_file(_get_patch_filename(id), *_patch_json_doc);
+    // Save the patch file (and update the patch cache)
+    _save_json_file(_get_patch_filename(id), *_patch_json_doc, true);
 }
 
 //----------------------------------------------------------------------------
@@ -3779,43 +4404,152 @@ void FileManager::_save_patch_file()
     _save_patch_file(utils::get_current_layer_info().get_patch_id());
 }
 
-#ifdef INCLUDE_PATCH_HISTORY
 //----------------------------------------------------------------------------
-// _save_patch_history_file
+// _save_json_file
 //----------------------------------------------------------------------------
-void FileManager::_save_patch_history_file()
+void FileManager::_save_json_file(std::string file_path, const rapidjson::Document &json_data, bool cache_patch)
 {
-    DEBUG_BASEMGR_MSG("_save_patch_history_file");
+    // Take a snapshot of the JSON data - this is cheap compared to serialising
+    // and writing the file, which is done by the JSON save thread
+    auto snapshot = std::make_unique<rapidjson::Document>();
+    snapshot->CopyFrom(json_data, snapshot->GetAllocator());
 
-    // Save the patch history file
-    _save_json_file(NINA_UDATA_FILE_PATH(PATCH_HISTORY_FILE), _patch_history_json_data);
+    // Queue the snapshot to be written, replacing any snapshot of this file that
+    // has not yet been written
+    {
+        std::lock_guard<std::mutex> lock(_json_save_mutex);
+        _pending_json_saves[file_path] = std::make_pair(std::move(snapshot), cache_patch);
+    }
+    _json_save_cv.notify_all();
 }
-#endif
 
 //----------------------------------------------------------------------------
-// _save_json_file
+// _write_json_file
 //----------------------------------------------------------------------------
-void FileManager::_save_json_file(std::string file_path, const rapidjson::Document &json_data)
+bool FileManager::_write_json_file(const std::string& file_path, const rapidjson::Document &json_data)
 {
-    char write_buffer[131072];
-
-    // Open the file for writing
-    FILE *fp = ::fopen(file_path.c_str(), "w");
+    // Open a temporary file in the same directory for writing
+    // The target file is only replaced once the new data is on disk, so a power
+    // loss during the save leaves either the old or the new file intact
+    std::string tmp_file_path = file_path + ".tmp";
+    FILE *fp = ::fopen(tmp_file_path.c_str(), "w");
     if (fp == nullptr)
     {
         MSG("An error occurred (" << errno << ") writing the file: " << file_path);
         NINA_LOG_ERROR(module(), "An error occurred ({}) writing the file: {}", errno, file_path);
-        return;
+        return false;
+    }
+
+    // Serialise the JSON data and write it to the file
+    // Note: The data is serialised to a buffer first, so that the hash of the
+    // file contents can be recorded once the file has been written
+    rapidjson::StringBuffer buffer;
+    if (utils::system_config()->get_pretty_json_files()) {
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        (void)json_data.Accept(writer);
     }
+    else {
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        (void)json_data.Accept(writer);
+    }
+    bool file_written = (buffer.GetSize() == 0) || (::fwrite(buffer.GetString(), buffer.GetSize(), 1, fp) == 1);
+
+    // Make sure the file data is on disk - only this file is synced, rather
+    // than every dirty page in the system
+    file_written = (::fflush(fp) == 0) && (::fsync(::fileno(fp)) == 0) && file_written;
+    file_written = (::fclose(fp) == 0) && file_written;
+    if (!file_written)
+    {
+        MSG("An error occurred (" << errno << ") writing the file: " << file_path);
+        NINA_LOG_ERROR(module(), "An error occurred ({}) writing the file: {}", errno, file_path);
+        (void)std::remove(tmp_file_path.c_str());
+        return false;
+    }
+
+    // Replace the target file with the new file
+    if (std::rename(tmp_file_path.c_str(), file_path.c_str()) != 0)
+    {
+        MSG("An error occurred (" << errno << ") renaming the file: " << file_path);
+        NINA_LOG_ERROR(module(), "An error occurred ({}) renaming the file: {}", errno, file_path);
+        (void)std::remove(tmp_file_path.c_str());
+        return false;
+    }
+
+    // This process wrote the file, so it can be trusted when it is next opened
+    _set_trusted_json_file(file_path, _hash_json_file_contents(buffer.GetString(), buffer.GetSize()));
+
+    // Sync the directory so that the rename itself is on disk
+    auto dir_path = std::filesystem::path(file_path).parent_path();
+    int dir_fd = ::open(dir_path.empty() ? "." : dir_path.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir_fd != -1) {
+        (void)::fsync(dir_fd);
+        ::close(dir_fd);
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _prefetch_patches
+//----------------------------------------------------------------------------
+void FileManager::_prefetch_patches(PatchId id)
+{
+    // Get the patch prefetch mutex
+    std::lock_guard<std::mutex> lock(_patch_prefetch_mutex);
+
+    // Replace any pending prefetches with the specified patch and its neighbours,
+    // nearest first
+    _pending_patch_prefetches.clear();
+    _pending_patch_prefetches.push_back(id);
+    for (uint i=1; i<=PATCH_PREFETCH_DISTANCE; i++) {
+        auto next_id = id;
+        next_id.patch_num += i;
+        _pending_patch_prefetches.push_back(next_id);
+        if (id.patch_num > i) {
+            auto prev_id = id;
+            prev_id.patch_num -= i;
+            _pending_patch_prefetches.push_back(prev_id);
+        }
+    }
+    _patch_prefetch_cv.notify_one();
+}
+
+//----------------------------------------------------------------------------
+// _wait_for_json_save
+//----------------------------------------------------------------------------
+void FileManager::_wait_for_json_save(const std::string& file_path)
+{
+    // Wait until any queued or in progress save of this file has been written
+    std::unique_lock<std::mutex> lock(_json_save_mutex);
+    _json_save_cv.wait(lock, [this, &file_path]{
+        return (_pending_json_saves.count(file_path) == 0) && (_json_save_in_progress != file_path); });
+}
+
+//----------------------------------------------------------------------------
+// _wait_for_json_saves
+//----------------------------------------------------------------------------
+void FileManager::_wait_for_json_saves()
+{
+    // Wait until all queued saves have been written
+    std::unique_lock<std::mutex> lock(_json_save_mutex);
+    _json_save_cv.wait(lock, [this]{ return _pending_json_saves.empty() && _json_save_in_progress.empty(); });
+}
+
+//----------------------------------------------------------------------------
+// _find_json_path
+//----------------------------------------------------------------------------
+rapidjson::Value::ValueIterator FileManager::_find_json_path(rapidjson::Value& json_data, const char *path)
+{
+    // Find the path in the JSON array, through its path index
+    return _json_path_index.find(json_data, path);
+}
 
-    // Write the JSON data to the file
-    // Note: If the data is larger than the write buffer then the Accept
-    // function writes it in chunks
-    rapidjson::FileWriteStream os(fp, write_buffer, sizeof(write_buffer));
-    rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer(os);
-    (void)json_data.Accept(writer);
-    fclose(fp);
-    sync();
+//----------------------------------------------------------------------------
+// _invalidate_json_path_indexes
+//----------------------------------------------------------------------------
+void FileManager::_invalidate_json_path_indexes()
+{
+    // Clear all indexes, they are rebuilt when next used
+    _json_path_index.invalidate();
 }
 
 //----------------------------------------------------------------------------
@@ -3868,24 +4602,16 @@ rapidjson::Value::ValueIterator FileManager::_find_patch_param(uint layer_num, s
 
     // Not in the Layer json data, search the Common json data
     rapidjson::Value& common_json_data = _get_layer_patch_common_json_data(layer_1_param ? 0 : layer_num);
-    for (rapidjson::Value::ValueIterator itr = common_json_data.Begin(); itr != common_json_data.End(); ++itr) {
-        // Does this entry match the param?
-        if (itr->GetObject()["path"].GetString() == path) {
-            return itr;
-        }
+    itr = _find_json_path(common_json_data, path.c_str());
+    if (itr) {
+        return itr;
     }
 
     // Not in the Layer or Common json data, search the State json data
     rapidjson::Value& state_json_data = (utils::get_layer_info(layer_num).get_patch_state() == PatchState::STATE_A) ? 
             _get_layer_patch_state_a_json_data(layer_num) :
             _get_layer_patch_state_b_json_data(layer_num);
-    for (rapidjson::Value::ValueIterator itr = state_json_data.Begin(); itr != state_json_data.End(); ++itr) {
-        // Does this entry match the param?
-        if (itr->GetObject()["path"].GetString() == path) {
-            return itr;
-        }
-    }
-    return nullptr;    
+    return _find_json_path(state_json_data, path.c_str());
 }
 
 //----------------------------------------------------------------------------
@@ -3894,46 +4620,28 @@ rapidjson::Value::ValueIterator FileManager::_find_patch_param(uint layer_num, s
 rapidjson::Value::ValueIterator FileManager::_find_patch_param(std::string path, bool layer_1_param)
 {
     // Search the common Layer json data first
-    rapidjson::Value& common_layer_json_data = _get_patch_common_layer_json_data();
-    for (rapidjson::Value::ValueIterator itr = common_layer_json_data.Begin(); itr != common_layer_json_data.End(); ++itr)
-    {
-        // Does this entry match the param?
-        if (itr->GetObject()["path"].GetString() == path) {
-            return itr;
-        }
+    auto itr = _find_json_path(_get_patch_common_layer_json_data(), path.c_str());
+    if (itr) {
+        return itr;
     }
 
     // Not in the common Layer json data, search the Layer json data
-    rapidjson::Value& layer_json_data = _get_patch_layer_json_data();
-    for (rapidjson::Value::ValueIterator itr = layer_json_data.Begin(); itr != layer_json_data.End(); ++itr)
-    {
-        // Does this entry match the param?
-        if (itr->GetObject()["path"].GetString() == path) {
-            return itr;
-        }
+    itr = _find_json_path(_get_patch_layer_json_data(), path.c_str());
+    if (itr) {
+        return itr;
     }
 
     // Not in the Layer json data, search the Common json data
     rapidjson::Value& common_json_data = (layer_1_param ? _get_layer_patch_common_json_data(0) : _get_patch_common_json_data());
-    for (rapidjson::Value::ValueIterator itr = common_json_data.Begin(); itr != common_json_data.End(); ++itr)
-    {
-        // Does this entry match the param?
-        if (itr->GetObject()["path"].GetString() == path) {
-            return itr;
-        }
+    itr = _find_json_path(common_json_data, path.c_str());
+    if (itr) {
+        return itr;
     }
 
     // Not in the Layer or Common json data, search the State json data
     rapidjson::Value& state_json_data = (utils::get_current_layer_info().get_patch_state() == PatchState::STATE_A) ? _get_patch_state_a_json_data() :
                                         _get_patch_state_b_json_data();
-    for (rapidjson::Value::ValueIterator itr = state_json_data.Begin(); itr != state_json_data.End(); ++itr)
-    {
-        // Does this entry match the param?
-        if (itr->GetObject()["path"].GetString() == path) {
-            return itr;
-        }
-    }                                 
-    return nullptr;
+    return _find_json_path(state_json_data, path.c_str());
 }
 
 //----------------------------------------------------------------------------
@@ -3942,14 +4650,7 @@ rapidjson::Value::ValueIterator FileManager::_find_patch_param(std::string path,
 rapidjson::Value::ValueIterator FileManager::_find_global_param(std::string path)
 {
     // Search the global params json data
-    for (rapidjson::Value::ValueIterator itr = _global_params_json_data.Begin(); itr != _global_params_json_data.End(); ++itr)
-    {
-        // Does this entry match the param?
-        if (itr->GetObject()["path"].GetString() == path) {
-            return itr;
-        }
-    }                                 
-    return nullptr;
+    return _find_json_path(_global_params_json_data, path.c_str());
 }
 
 //----------------------------------------------------------------------------
@@ -3959,26 +4660,16 @@ rapidjson::Value::ValueIterator FileManager::_find_init_patch_param(std::string
 {
     // Search the Common json data
     rapidjson::Value& common_json_data = _init_patch_json_data["common"].GetArray();
-    for (rapidjson::Value::ValueIterator itr = common_json_data.Begin(); itr != common_json_data.End(); ++itr)
-    {
-        // Does this entry match the param?
-        if (itr->GetObject()["path"].GetString() == path) {
-            return itr;
-        }
+    auto itr = _find_json_path(common_json_data, path.c_str());
+    if (itr) {
+        return itr;
     }
 
     // Not in the Common json data, search the State json data
     rapidjson::Value& state_json_data = (state == PatchState::STATE_A) ? 
                                             _init_patch_json_data["state_a"].GetArray() :
                                             _init_patch_json_data["state_b"].GetArray();
-    for (rapidjson::Value::ValueIterator itr = state_json_data.Begin(); itr != state_json_data.End(); ++itr)
-    {
-        // Does this entry match the param?
-        if (itr->GetObject()["path"].GetString() == path) {
-            return itr;
-        }
-    }                                 
-    return nullptr;
+    return _find_json_path(state_json_data, path.c_str());
 }
 
 //----------------------------------------------------------------------------
@@ -4300,15 +4991,7 @@ rapidjson::Value::ValueIterator FileManager::_get_layer_mpe_upper_zone_num_chann
 rapidjson::Value::ValueIterator FileManager::_get_common_layer_obj(const char *path)
 {  
     // Sarch the common layer json data
-    rapidjson::Value& json_data = _get_patch_common_layer_json_data();
-    for (rapidjson::Value::ValueIterator itr = json_data.Begin(); itr != json_data.End(); ++itr)
-    {
-        // Does this entry match the param?
-        if (std::strcmp(itr->GetObject()["path"].GetString(), path) == 0) {
-            return itr;
-        }
-    }
-    return nullptr;
+    return _find_json_path(_get_patch_common_layer_json_data(), path);
 }
 
 //----------------------------------------------------------------------------
@@ -4319,14 +5002,7 @@ rapidjson::Value::ValueIterator FileManager::_get_layer_obj(uint layer_num, cons
     // Make sure the layer number is valid
     if (layer_num < NUM_LAYERS) {    
         // Sarch the layer json data
-        rapidjson::Value& json_data = _get_layer_json_data(layer_num)->GetObject()["params"].GetArray();
-        for (rapidjson::Value::ValueIterator itr = json_data.Begin(); itr != json_data.End(); ++itr)
-        {
-            // Does this entry match the param?
-            if (std::strcmp(itr->GetObject()["path"].GetString(), path) == 0) {
-                return itr;
-            }
-        }
+        return _find_json_path(_get_layer_json_data(layer_num)->GetObject()["params"].GetArray(), path);
     }
     return nullptr;
 }
@@ -4452,3 +5128,27 @@ void FileManager::_check_layers_load()
     }
 }
 #endif
+
+//----------------------------------------------------------------------------
+// _process_json_saves
+//----------------------------------------------------------------------------
+static void *_process_json_saves(void* data)
+{
+    auto file_manager = static_cast<FileManager*>(data);
+    file_manager->process_json_saves();
+
+    // To suppress warnings
+    return nullptr;
+}
+
+//----------------------------------------------------------------------------
+// _process_patch_prefetches
+//----------------------------------------------------------------------------
+static void *_process_patch_prefetches(void* data)
+{
+    auto file_manager = static_cast<FileManager*>(data);
+    file_manager->process_patch_prefetches();
+
+    // To suppress warnings
+    return nullptr;
+}
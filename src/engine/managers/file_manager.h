@@ -20,8 +20,27 @@
 #include "event.h"
 #include "event_router.h"
 #include "param.h"
+#include "param_value_bank.h"
+#include "json_path_index.h"
 #include "system_func.h"
 #include "timer.h"
+#include "patch_cache.h"
+#include "patch_history.h"
+#include <map>
+#include <memory>
+#include <future>
+#include <functional>
+#include <chrono>
+#include <unordered_map>
+
+// Compiled JSON schema
+// The schema data is kept with the compiled schema, as the compiled schema
+// references it
+struct CompiledJsonSchema
+{
+    rapidjson::Document schema_data;
+    std::unique_ptr<rapidjson::SchemaDocument> schema_document;
+};
 
 // File Manager class
 class FileManager : public BaseManager
@@ -38,6 +57,8 @@ public:
     void stop();
     void process();
     void process_event(const BaseEvent *event);
+    void process_json_saves();
+    void process_patch_prefetches();
 
 private:
     DawManager *_daw_manager;
@@ -56,9 +77,8 @@ private:
     rapidjson::Document _layers_json_data;
     rapidjson::Document _layer_patch_json_doc[NUM_LAYERS];
     rapidjson::Document *_patch_json_doc;
-#ifdef INCLUDE_PATCH_HISTORY    
-    rapidjson::Document _patch_history_json_data;
-#endif
+    ParamValueBank _layer_common_value_banks[NUM_LAYERS];
+    ParamValueBank _layer_state_value_banks[NUM_LAYERS][2];
     rapidjson::Document _param_map_json_data;
     rapidjson::Document _global_params_json_data;
     rapidjson::Document _init_patch_json_data;
@@ -70,47 +90,89 @@ private:
     Timer *_save_global_params_file_timer;
     Timer *_save_layers_file_timer;
 #ifdef INCLUDE_PATCH_HISTORY    
-    std::vector<ParamChangeHistory> _param_change_history;
+    PatchHistory _patch_history;
 #endif
     Param *_morph_value_param;
     KnobParam *_morph_knob_param;
+    PatchCache _patch_cache;
+    std::thread *_json_save_thread;
+    bool _run_json_save_thread;
+    std::mutex _json_save_mutex;
+    std::condition_variable _json_save_cv;
+    std::map<std::string, std::pair<std::unique_ptr<rapidjson::Document>, bool>> _pending_json_saves;
+    std::string _json_save_in_progress;
+    std::thread *_patch_prefetch_thread;
+    bool _run_patch_prefetch_thread;
+    std::mutex _patch_prefetch_mutex;
+    std::condition_variable _patch_prefetch_cv;
+    std::vector<PatchId> _pending_patch_prefetches;
+    JsonPathIndex _json_path_index;
+    std::mutex _json_schema_mutex;
+    std::unordered_map<const char *, std::unique_ptr<CompiledJsonSchema>> _json_schemas;
+    std::mutex _trusted_json_files_mutex;
+    std::unordered_map<std::string, uint64_t> _trusted_json_files;
 
     void _process_param_changed_event(const ParamChange &param_change);
     void _process_system_func_event(const SystemFunc &system_func);
     void _params_changed_timeout_with_lock();
     void _params_changed_timeout();
     void _update_state_params();
+    void _update_morph_engine_states(uint layer_num);
     std::string _get_layers_filename(uint layers_num);
     std::string _get_patch_filename(PatchId id, bool full_path=true);
 #ifdef INCLUDE_PATCH_HISTORY     
-    std::string _get_patch_history_filename();
+    void _apply_patch_history_value(const PatchHistoryEntry& entry, float value);
+    std::vector<PatchId> _get_layer_patch_ids();
 #endif
     void _open_and_parse_param_blacklist_file();
+    std::future<bool> _read_startup_file(const char *name, std::function<bool()> open_func);
+    void _log_startup_step(const char *name, std::chrono::steady_clock::time_point &start_time);
     bool _open_config_file();
-    void _open_and_parse_system_colours_file();
-    void _open_and_parse_param_aliases_file();
-    bool _open_and_parse_param_attributes_file();
-    bool _open_and_parse_param_lists_file();
-    bool _open_and_parse_global_params_file();
+    bool _open_system_colours_file(rapidjson::Document &json_data);
+    bool _open_param_aliases_file(rapidjson::Document &json_data);
+    bool _open_param_attributes_file(rapidjson::Document &json_data);
+    bool _open_param_lists_file(rapidjson::Document &json_data);
+    bool _open_global_params_file();
     bool _open_param_map_file();
     bool _open_and_parse_layers_file(uint layers_num);
     bool _open_and_parse_layers_file(std::string file_path);
     bool _open_patch_file(PatchId id);
     bool _open_patch_file(PatchId id, rapidjson::Document &json_doc);
     bool _open_patch_file(std::string file_path, rapidjson::Document &json_doc);
-#ifdef INCLUDE_PATCH_HISTORY     
-    bool _open_patch_history_file();
-#endif
-    bool _open_and_parse_haptic_modes_file();
+    std::vector<std::future<bool>> _open_layer_patch_files();
+    bool _open_haptic_modes_file(rapidjson::Document &json_data);
     bool _open_json_file(std::string file_path, const char *schema, rapidjson::Document &json_data, bool create=true, std::string def_contents="[]");
+    const rapidjson::SchemaDocument *_get_json_schema(const char *schema);
+    void _set_trusted_json_file(const std::string& file_path, uint64_t hash);
+    bool _is_trusted_json_file(const std::string& file_path, const std::string& contents);
+    uint64_t _hash_json_file_contents(const char *data, size_t size);
     void _parse_config();
+    void _parse_system_colours(rapidjson::Document &json_data);
+    void _parse_param_aliases(rapidjson::Document &json_data);
     void _parse_param_map();
+    bool _parse_param_attributes(rapidjson::Document &json_data);
+    bool _parse_param_lists(rapidjson::Document &json_data);
+    bool _parse_global_params();
+    bool _parse_haptic_modes(rapidjson::Document &json_data);
     void _parse_patch(uint layer_num, bool set_layer_params=true);
     void _parse_patch_layer_params(std::vector<Param *> &params);
     void _parse_patch_common_params(uint layer_num, bool current_layer, std::vector<Param *> &params);
     void _parse_patch_state_params(bool current_layer, std::vector<Param *> &params, PatchState state);
-    void _process_patch_mapped_params(const Param *param, const Param *skip_param);
+    void _process_patch_mapped_params(const Param *param);
     void _set_patch_state_b_params(rapidjson::Document &from_patch_json_doc);
+    void _load_patch_common_params(uint layer_num, std::vector<Param *> &params);
+    void _load_patch_state_params(uint layer_num, std::vector<Param *> &params, PatchState state);
+    bool _apply_value_bank(ParamValueBank &bank, uint layer_num, std::vector<Param *> &params, bool common);
+    void _capture_value_bank(ParamValueBank &bank, uint layer_num, std::vector<Param *> &params, bool common);
+    ParamValueBank &_get_common_value_bank(uint layer_num);
+    ParamValueBank &_get_state_value_bank(uint layer_num, PatchState state);
+    ParamValueBank *_get_param_value_bank(uint layer_num, const Param *param);
+    void _update_value_bank(uint layer_num, const Param *param, float value);
+    void _update_value_bank(uint layer_num, const Param *param, const std::string& str_value);
+    void _invalidate_value_banks(uint layer_num);
+    bool _is_value_bank_param(uint layer_num, const Param *param, bool common);
+    void _sync_arp_enable_surface_control(const Param *param);
+    void _process_lfo_1_tempo_sync_state();
     void _save_config_file();
     void _save_current_layers_file();
     void _save_layers_file(uint layers_num);
@@ -118,10 +180,13 @@ private:
     void _save_global_params_file();
     void _save_patch_file(PatchId id);
     void _save_patch_file();
-#ifdef INCLUDE_PATCH_HISTORY 
-    void _save_patch_history_file();
-#endif
-    void _save_json_file(std::string file_path, const rapidjson::Document &json_data);
+    void _save_json_file(std::string file_path, const rapidjson::Document &json_data, bool cache_patch=false);
+    bool _write_json_file(const std::string& file_path, const rapidjson::Document &json_data);
+    void _wait_for_json_save(const std::string& file_path);
+    void _wait_for_json_saves();
+    void _prefetch_patches(PatchId id);
+    rapidjson::Value::ValueIterator _find_json_path(rapidjson::Value& json_data, const char *path);
+    void _invalidate_json_path_indexes();
     rapidjson::Value::ValueIterator _get_current_layer_json_data();
     rapidjson::Value::ValueIterator _get_layer_json_data(uint layer_num);
     rapidjson::Value::ValueIterator _find_patch_param(uint layer_num, std::string path, bool layer_1_param);
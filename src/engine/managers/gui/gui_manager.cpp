@@ -10,6 +10,7 @@
 #include <cstring>
 #include <unistd.h>
 #include <cstdlib>
+#include <climits>
 #include <sys/types.h>
 #include <dirent.h>
 #include <sys/stat.h>
@@ -28,12 +29,13 @@
 #include "keyboard_manager.h"
 #include "utils.h"
 #include "logger.h"
+#include "trace_log.h"
 #include "version.h"
 
 // Constants
 constexpr char GUI_MSG_QUEUE_NAME[]            = "/nina_msg_queue";
 constexpr uint GUI_MSG_QUEUE_SIZE              = 50;
-constexpr uint SEND_POLL_TIME                  = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::milliseconds(17)).count();
+constexpr uint GUI_FRAME_PERIOD                = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::seconds(1)).count() / GUI_REFRESH_RATE;
 constexpr uint PARAM_CHANGED_TIMEOUT           = std::chrono::milliseconds(5000).count();
 constexpr uint PARAM_CHANGED_SHOWN_THRESHOLD   = std::chrono::milliseconds(50).count();
 constexpr uint ACTIVITY_TIMER_TIMEOUT          = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::milliseconds(500)).count();
@@ -65,6 +67,7 @@ const char *_system_menu_options_cal[] = {
     "FILTER CALIBRATION",
     "FACTORY SOAK TEST",
     "RUN DIAGNOSTIC SCRIPT",
+    "EXPORT LATENCY TRACE",
     "GLOBAL SETTINGS",
     "BANK/PRESET MANAGEMENT",
     "WAVETABLE MANAGEMENT",
@@ -79,6 +82,7 @@ const char *_system_menu_options_not_cal[] = {
     "FILTER CALIBRATION",
     "FACTORY SOAK TEST",
     "RUN DIAGNOSTIC SCRIPT",
+    "EXPORT LATENCY TRACE",
     "GLOBAL SETTINGS",
     "BANK/PRESET MANAGEMENT",
     "WAVETABLE MANAGEMENT",
@@ -95,7 +99,8 @@ static void *_process_msd_event(void* data);
 // GuiManager
 //----------------------------------------------------------------------------
 GuiManager::GuiManager(EventRouter *event_router) : 
-    BaseManager(NinaModule::GUI, "GuiManager", event_router)
+    BaseManager(NinaModule::GUI, "GuiManager", event_router, false, true),
+    _gui_update_compositor(std::bind(&GuiManager::_send_gui_msg, this, std::placeholders::_1))
 {
     mq_attr attr;
 
@@ -112,6 +117,10 @@ GuiManager::GuiManager(EventRouter *event_router) :
         MSG("ERROR: Could not open the GUI Message Queue: " << errno);
     }
 
+    // Open the GUI Message Ring - once the GUI connects to the ring, the GUI messages
+    // are sent using the ring rather than the GUI Message Queue
+    _gui_msg_ring.open();
+
     // Initialise class data
     _arp_listener = 0;
     _seq_listener = 0;
@@ -249,6 +258,9 @@ GuiManager::~GuiManager()
         _gui_mq_desc = (mqd_t)-1;
     }
 
+    // Close the GUI Message Ring
+    _gui_msg_ring.close();
+
     // Clean up the event listeners
     if (_arp_listener)
         delete _arp_listener;
@@ -285,7 +297,8 @@ bool GuiManager::start()
     _sw_manager = static_cast<SwManager *>(utils::get_manager(NinaModule::SOFTWARE));
 
 	// Start the GUI message send timer periodic thread
-	_gui_msg_send_timer->start(SEND_POLL_TIME, std::bind(&GuiManager::_gui_send_callback, this));
+	// Note: The timer runs once per GUI frame
+	_gui_msg_send_timer->start(GUI_FRAME_PERIOD, std::bind(&GuiManager::_gui_send_callback, this));
 
     // Process the presets
     _process_reload_presets();
@@ -450,8 +463,11 @@ void GuiManager::process_msd_event()
 //----------------------------------------------------------------------------
 void GuiManager::_process_param_changed_event(const ParamChange &data)
 {
+    // If this param change is being traced, record that it has been received
+    LatencyTrace::Record(data.trace_id, LatencyTraceStage::GUI_RECEIVED);
+
     // Check for the special case of Tempo BPM - this is shown in the status bar
-    if (data.path == TempoBpmParam::ParamPath()) {
+    if (data.path() == TempoBpmParam::ParamPath()) {
         // Update the Tempo Status
         _set_tempo_status(static_cast<uint>(data.value));        
     }
@@ -463,7 +479,7 @@ void GuiManager::_process_param_changed_event(const ParamChange &data)
         std::lock_guard<std::mutex> guard(_gui_mutex);
 
         // Get the changed param
-        auto param = utils::get_param(data.path.c_str());
+        auto param = utils::get_param_from_handle(data.handle);
         if (param) {
             // If we are currently showing a param and the param in this change event is different
             if (_param_shown && (_param_shown != param)) {
@@ -651,7 +667,7 @@ void GuiManager::_process_midi_event(const snd_seq_event_t &seq_event)
             _param_shown->set_value_from_position(seq_event.data.note.note);
 
             // Post a param change message
-            auto param_change = ParamChange(_param_shown->get_path(), _param_shown->get_value(), module());
+            auto param_change = ParamChange(_param_shown->handle, _param_shown->get_value(), module());
             _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
 
             // Update the value shown
@@ -663,7 +679,7 @@ void GuiManager::_process_midi_event(const snd_seq_event_t &seq_event)
             _param_shown->set_value_from_position(seq_event.data.note.note);
 
             // Post a param change message
-            auto param_change = ParamChange(_param_shown->get_path(), _param_shown->get_value(), module());
+            auto param_change = ParamChange(_param_shown->handle, _param_shown->get_value(), module());
             _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
 
             // Update the value shown       
@@ -1381,7 +1397,7 @@ void GuiManager::_process_kbd(bool selected, Param *linked_param)
             
             // Set the param to 1.0 and send it to all layers
             param->set_value(1.0);
-            auto param_change = ParamChange(param->get_path(), param->get_value(), module());
+            auto param_change = ParamChange(param->handle, param->get_value(), module());
             for (uint i=0; i<NUM_LAYERS; i++) {
                 param_change.layers_mask |= LayerInfo::GetLayerMaskBit(i);
             }
@@ -2503,9 +2519,9 @@ void GuiManager::_process_mod_matrix_dst_soft_button_3()
         _param_shown->set_value(0.5);
 
         // Post a param change message
-        auto param_change = ParamChange(_param_shown->get_path(), _param_shown->get_value(), module());
+        auto param_change = ParamChange(_param_shown->handle, _param_shown->get_value(), module());
         _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
-        _process_param_changed_mapped_params(_param_shown, _param_shown->get_value(), nullptr);
+        _process_param_changed_mapped_params(_param_shown, _param_shown->get_value());
 
         // Update the list
         _show_param_list = false;
@@ -2562,6 +2578,15 @@ void GuiManager::_process_system_menu_soft_button_3()
                     break;
                 }
 
+                case SystemMenuOption::EXPORT_LATENCY_TRACE:
+                {
+                    // If latency tracing is enabled, export the latency trace
+                    if (LatencyTrace::Enabled()) {
+                        LatencyTrace::Export(NINA_UDATA_FILE_PATH(LATENCY_TRACE_FILE));
+                    }
+                    break;
+                }
+
                 case SystemMenuOption::GLOBAL_SETTINGS:
                     // Show the global settings
                     _show_sys_menu_global_settings_screen();
@@ -3355,10 +3380,10 @@ void GuiManager::_process_manage_layer_multifn_switch(uint switch_index)
             param->set_value_from_position(switch_index);
 
             // Post a param change message
-            auto param_change = ParamChange(param->get_path(), param->get_value(), module());
+            auto param_change = ParamChange(param->handle, param->get_value(), module());
             param_change.display = false;
             _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
-            _process_param_changed_mapped_params(param, param->get_value(), nullptr); 
+            _process_param_changed_mapped_params(param, param->get_value()); 
 
             // Load the new Layer
             auto layer = switch_index;
@@ -3544,9 +3569,9 @@ void GuiManager::_process_shown_param_update_data_knob(KnobParam &data_knob)
                             _post_enum_list_param_update_value(value);
 
                             // Post a param change message
-                            auto param_change = ParamChange(_param_shown->get_path(), _param_shown->get_value(), module());
+                            auto param_change = ParamChange(_param_shown->handle, _param_shown->get_value(), module());
                             _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
-                            _process_param_changed_mapped_params(_param_shown, _param_shown->get_value(), nullptr);
+                            _process_param_changed_mapped_params(_param_shown, _param_shown->get_value());
                         }                       
                     }
                 }                        
@@ -3562,9 +3587,9 @@ void GuiManager::_process_shown_param_update_data_knob(KnobParam &data_knob)
                     _post_param_update_value(false);
 
                      // Send the param change
-                    auto param_change = ParamChange(_param_shown->get_path(), _param_shown->get_value(), module());
+                    auto param_change = ParamChange(_param_shown->handle, _param_shown->get_value(), module());
                     _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
-                    _process_param_changed_mapped_params(_param_shown, _param_shown->get_value(), nullptr);                          
+                    _process_param_changed_mapped_params(_param_shown, _param_shown->get_value());                          
                 }
             }
             else
@@ -3588,9 +3613,9 @@ void GuiManager::_process_shown_param_update_data_knob(KnobParam &data_knob)
                 _post_param_update_value(false);
 
                 // Send the param change
-                auto param_change = ParamChange(_param_shown->get_path(), _param_shown->get_value(), module());
+                auto param_change = ParamChange(_param_shown->handle, _param_shown->get_value(), module());
                 _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
-                _process_param_changed_mapped_params(_param_shown, _param_shown->get_value(), nullptr);
+                _process_param_changed_mapped_params(_param_shown, _param_shown->get_value());
             }
         }
     }
@@ -3679,6 +3704,18 @@ void GuiManager::_process_select_bank_data_knob(KnobParam &data_knob)
 
                 // Update the selected list item
                 _post_update_selected_list_item(_selected_bank_index);
+
+                // If we are in the LOAD PATCH state, prefetch the first patches in the
+                // selected bank
+                if (_manage_patch_state == ManagePatchState::LOAD_PATCH) {
+                    auto bank_item = _list_item_from_index(_selected_bank_index);
+                    if (bank_item.first > 0) {
+                        auto id = PatchId();
+                        id.bank_num = bank_item.first;
+                        id.patch_num = 1;
+                        _event_router->post_system_func_event(new SystemFuncEvent(SystemFunc(SystemFuncType::PREFETCH_PATCHES, id, GUI)));
+                    }
+                }
             }
             break;
         }
@@ -3750,6 +3787,16 @@ void GuiManager::_process_select_patch_data_knob(KnobParam &data_knob)
 
                 // If we are in the LOAD PATCH state
                 if (_manage_patch_state == ManagePatchState::LOAD_PATCH) {
+                    // Prefetch the selected patch and its neighbours, so that the
+                    // patch loads quickly if selected
+                    auto patch_item = _list_item_from_index(_selected_patch_index);
+                    if (patch_item.first > 0) {
+                        auto id = PatchId();
+                        id.bank_num = _selected_bank_num;
+                        id.patch_num = patch_item.first;
+                        _event_router->post_system_func_event(new SystemFuncEvent(SystemFunc(SystemFuncType::PREFETCH_PATCHES, id, GUI)));
+                    }
+
                     // If the index moved from zero
                     if (prev_index == 0) {
                         // Show the standard soft buttons for a patch
@@ -4186,6 +4233,9 @@ void GuiManager::_show_system_menu_screen()
         else if (((i + first_item_index) == SystemMenuOption::RUN_DIAG_SCRIPT) && !_sw_manager->diag_script_present()) {
             msg.list_items.list_item_enabled[i] = false;
         }
+        else if (((i + first_item_index) == SystemMenuOption::EXPORT_LATENCY_TRACE) && !LatencyTrace::Enabled()) {
+            msg.list_items.list_item_enabled[i] = false;
+        }
         else {
             msg.list_items.list_item_enabled[i] = true;
         }
@@ -4232,7 +4282,7 @@ void GuiManager::_show_select_layers_load_screen()
     _list_items = _parse_layers_folder();
     if (_list_items.size() > 0)
     {
-        uint list_size = (_list_items.size() < LIST_MAX_LEN) ? _list_items.size() : LIST_MAX_LEN;          
+        uint list_size = std::min<uint>(_list_items.size(), _max_list_items());
 
         // Is a layers file currently selected?
         _selected_layers_index= -1;
@@ -4250,16 +4300,13 @@ void GuiManager::_show_select_layers_load_screen()
         _post_gui_msg(msg);
 
         // Show the list of patches to choose from
-        msg.type = GuiMsgType::SHOW_LIST_ITEMS;
-        msg.list_items.num_items = list_size;
-        msg.list_items.selected_item = _selected_layers_index;
-        msg.list_items.process_enabled_state = false;
+        std::vector<std::string> list_items;
         auto list_itr = _list_items.begin();
         for (uint i=0; i<list_size; i++) {
-            _strcpy_to_gui_msg(msg.list_items.list_items[i], _format_filename((*list_itr).second.c_str()).c_str());
+            list_items.push_back(_format_filename((*list_itr).second.c_str()));
             list_itr++;
         }
-        _post_gui_msg(msg);
+        _post_list_items(list_items, _selected_layers_index);
 
         // Set the soft buttons text
         msg.type = GuiMsgType::SET_SOFT_BUTTONS;
@@ -4286,7 +4333,7 @@ void GuiManager::_show_select_layers_save_screen()
     _list_items = _parse_layers_folder();
     if (_list_items.size() > 0)
     {
-        uint list_size = (_list_items.size() < LIST_MAX_LEN) ? _list_items.size() : LIST_MAX_LEN;          
+        uint list_size = std::min<uint>(_list_items.size(), _max_list_items());
 
         // Is a layers file currently selected?
         _selected_layers_index= -1;
@@ -4304,16 +4351,13 @@ void GuiManager::_show_select_layers_save_screen()
         _post_gui_msg(msg);
 
         // Show the list of patches to choose from
-        msg.type = GuiMsgType::SHOW_LIST_ITEMS;
-        msg.list_items.num_items = list_size;
-        msg.list_items.selected_item = _selected_layers_index;
-        msg.list_items.process_enabled_state = false;
+        std::vector<std::string> list_items;
         auto list_itr = _list_items.begin();
         for (uint i=0; i<list_size; i++) {
-            _strcpy_to_gui_msg(msg.list_items.list_items[i], _format_filename((*list_itr).second.c_str()).c_str());
+            list_items.push_back(_format_filename((*list_itr).second.c_str()));
             list_itr++;
         }
-        _post_gui_msg(msg);
+        _post_list_items(list_items, _selected_layers_index);
 
         // Set the soft buttons text
         msg.type = GuiMsgType::SET_SOFT_BUTTONS;
@@ -4346,7 +4390,7 @@ void GuiManager::_show_select_bank_screen()
     _list_items = _parse_patches_folder();
     if (_list_items.size() > 0)
     {
-        uint list_size = (_list_items.size() < LIST_MAX_LEN) ? _list_items.size() : LIST_MAX_LEN;
+        uint list_size = std::min<uint>(_list_items.size(), _max_list_items());
 
         // Is the currently selected bank number valid?
         if ((_selected_bank_index == -1) && (_selected_bank_num > 0)) {
@@ -4363,16 +4407,13 @@ void GuiManager::_show_select_bank_screen()
         _post_gui_msg(msg);
 
         // Show the list of banks to choose from
-        msg.type = GuiMsgType::SHOW_LIST_ITEMS;
-        msg.list_items.num_items = list_size;
-        msg.list_items.selected_item = _selected_bank_index;
-        msg.list_items.process_enabled_state = false;
+        std::vector<std::string> list_items;
         auto list_itr = _list_items.begin();
         for (uint i=0; i<list_size; i++) {
-            _strcpy_to_gui_msg(msg.list_items.list_items[i], _format_folder_name((*list_itr).second.c_str()).c_str());
+            list_items.push_back(_format_folder_name((*list_itr).second.c_str()));
             list_itr++;
         }
-        _post_gui_msg(msg);
+        _post_list_items(list_items, _selected_bank_index);
 
         // Set the soft buttons text
         msg.type = GuiMsgType::SET_SOFT_BUTTONS;
@@ -4429,7 +4470,7 @@ void GuiManager::_show_select_patch_load_screen()
             // Get the patches - adding the init patch to the start of the list
             _list_items = _parse_bank_folder(bank_folder_path);
             _list_items[0] = INIT_PATCH_LIST_TEXT;
-            uint list_size = (_list_items.size() < LIST_MAX_LEN) ? _list_items.size() : LIST_MAX_LEN;            
+            uint list_size = std::min<uint>(_list_items.size(), _max_list_items());
 
             // Is a patch currently selected?
             _selected_patch_index = -1;
@@ -4455,16 +4496,13 @@ void GuiManager::_show_select_patch_load_screen()
             _post_gui_msg(msg);
 
             // Show the list of patches to choose from
-            msg.type = GuiMsgType::SHOW_LIST_ITEMS;
-            msg.list_items.num_items = list_size;
-            msg.list_items.selected_item = _selected_patch_index;
-            msg.list_items.process_enabled_state = false;
+            std::vector<std::string> list_items;
             auto list_itr = _list_items.begin();
             for (uint i=0; i<list_size; i++) {
-                _strcpy_to_gui_msg(msg.list_items.list_items[i], _format_filename((*list_itr).second.c_str()).c_str());
+                list_items.push_back(_format_filename((*list_itr).second.c_str()));
                 list_itr++;
             }
-            _post_gui_msg(msg);
+            _post_list_items(list_items, _selected_patch_index);
 
             // Set the soft buttons text
             msg.type = GuiMsgType::SET_SOFT_BUTTONS;
@@ -4526,7 +4564,7 @@ void GuiManager::_show_select_patch_save_screen()
             
             // Get the patches
             _list_items = _parse_bank_folder(bank_folder_path);
-            uint list_size = (_list_items.size() < LIST_MAX_LEN) ? _list_items.size() : LIST_MAX_LEN;            
+            uint list_size = std::min<uint>(_list_items.size(), _max_list_items());
 
             // Is a patch currently selected?
             _selected_patch_index = -1;
@@ -4551,16 +4589,13 @@ void GuiManager::_show_select_patch_save_screen()
             _post_gui_msg(msg);
 
             // Show the list of patches to choose from
-            msg.type = GuiMsgType::SHOW_LIST_ITEMS;
-            msg.list_items.num_items = list_size;
-            msg.list_items.selected_item = _selected_patch_index;
-            msg.list_items.process_enabled_state = false;
+            std::vector<std::string> list_items;
             auto list_itr = _list_items.begin();
             for (uint i=0; i<list_size; i++) {
-                _strcpy_to_gui_msg(msg.list_items.list_items[i], _format_filename((*list_itr).second.c_str()).c_str());
+                list_items.push_back(_format_filename((*list_itr).second.c_str()));
                 list_itr++;
             }
-            _post_gui_msg(msg);
+            _post_list_items(list_items, _selected_patch_index);
 
             // Set the soft buttons text
             msg.type = GuiMsgType::SET_SOFT_BUTTONS;
@@ -5160,18 +5195,15 @@ void GuiManager::_show_sys_menu_select_bank_archive_screen()
     _post_gui_msg(msg);
 
     // Get a list of the available bank archives and show them
-    msg.type = GuiMsgType::SHOW_LIST_ITEMS;
-    msg.list_items.process_enabled_state = false;
+    std::vector<std::string> list_items;
     _list_items.clear();    
     auto banks = _sw_manager->get_bank_archives();
-    for (auto itr=banks.begin(); itr<banks.end(); itr++) {
-        _list_items[item] = *itr;
-        _strcpy_to_gui_msg(msg.list_items.list_items[item++], itr->c_str());
+    for (auto itr=banks.begin(); (itr<banks.end()) && (item < _max_list_items()); itr++) {
+        _list_items[item++] = *itr;
+        list_items.push_back(*itr);
     }
-    msg.list_items.num_items = item;
-    msg.list_items.selected_item = _selected_bank_archive;
     _selected_bank_archive_name = _list_items[_selected_bank_archive];
-    _post_gui_msg(msg);
+    _post_list_items(list_items, _selected_bank_archive);
 
     // Set the soft buttons
     msg.type = GuiMsgType::SET_SOFT_BUTTONS;
@@ -5207,19 +5239,16 @@ void GuiManager::_show_sys_menu_select_dest_bank_screen()
     _list_items = _parse_patches_folder();
     if (_list_items.size() > 0)
     {
-        uint list_size = (_list_items.size() < LIST_MAX_LEN) ? _list_items.size() : LIST_MAX_LEN;
+        uint list_size = std::min<uint>(_list_items.size(), _max_list_items());
 
         // Show the list of banks to choose from
-        msg.type = GuiMsgType::SHOW_LIST_ITEMS;
-        msg.list_items.num_items = list_size;
-        msg.list_items.selected_item = _selected_bank_dest;
-        msg.list_items.process_enabled_state = false;
+        std::vector<std::string> list_items;
         auto list_itr = _list_items.begin();
         for (uint i=0; i<list_size; i++) {
-            _strcpy_to_gui_msg(msg.list_items.list_items[i], _format_folder_name((*list_itr).second.c_str()).c_str());
+            list_items.push_back(_format_folder_name((*list_itr).second.c_str()));
             list_itr++;
         }
-        _post_gui_msg(msg);
+        _post_list_items(list_items, _selected_bank_dest);
 
         // Set the soft buttons
         msg.type = GuiMsgType::SET_SOFT_BUTTONS;
@@ -6574,7 +6603,7 @@ void GuiManager::_post_enum_list_param_update_value(uint value)
         _param_shown->set_value_from_position(value);
         if (_filename_param) {
             _filename_param->set_str_value(_filenames[value]);
-            auto param_change = ParamChange(_filename_param->get_path(), _filename_param->get_value(), module());
+            auto param_change = ParamChange(_filename_param->handle, _filename_param->get_value(), module());
             _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
             wt_list = true;   
         }
@@ -6615,11 +6644,11 @@ void GuiManager::_post_enum_list_param_update_value(uint value)
             // Did the Lower and/or Upper Zone Num Channels change?
             // If so, send a param change event
             if (lower_zone_num_channels_param) {
-                auto param_change = ParamChange(lower_zone_num_channels_param->get_path(), lower_zone_num_channels_param->get_value(), module());
+                auto param_change = ParamChange(lower_zone_num_channels_param->handle, lower_zone_num_channels_param->get_value(), module());
                 _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
             }
             if (upper_zone_num_channels_param) {
-                auto param_change = ParamChange(upper_zone_num_channels_param->get_path(), upper_zone_num_channels_param->get_value(), module());
+                auto param_change = ParamChange(upper_zone_num_channels_param->handle, upper_zone_num_channels_param->get_value(), module());
                 _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
             }            
         }
@@ -6688,9 +6717,9 @@ void GuiManager::_post_file_browser_param_update()
     if (selected_item != (uint)_param_shown->get_position_value()) {
         // Update the param and post a param change message
         _param_shown->set_value_from_position(selected_item);                 
-        auto param_change = ParamChange(_param_shown->get_path(), _param_shown->get_value(), module());
+        auto param_change = ParamChange(_param_shown->handle, _param_shown->get_value(), module());
         _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
-        _process_param_changed_mapped_params(_param_shown, _param_shown->get_value(), nullptr);        
+        _process_param_changed_mapped_params(_param_shown, _param_shown->get_value());        
         
     }
 }
@@ -6721,11 +6750,99 @@ void GuiManager::_clear_warning_screen()
     _post_gui_msg(msg);    
 }
 
+//----------------------------------------------------------------------------
+// _post_list_items
+//----------------------------------------------------------------------------
+void GuiManager::_post_list_items(const std::vector<std::string> &list_items, uint selected_item)
+{
+    // Does the GUI support list windows?
+    if (_gui_msg_ring.gui_capabilities() & GUI_CAP_LIST_WINDOW)
+    {
+        // Show the list as a window of items around the selected item - the rest of the
+        // items are sent as the list is scrolled
+        _list_window_items = list_items;
+        _list_window_sent.assign(list_items.size(), false);
+        _post_list_window(GuiMsgType::SHOW_LIST_WINDOW, selected_item);
+        return;
+    }
+
+    // Show the list in full, up to the maximum list length
+    auto msg = GuiMsg();
+    msg.type = GuiMsgType::SHOW_LIST_ITEMS;
+    msg.list_items.num_items = std::min<uint>(list_items.size(), LIST_MAX_LEN);
+    msg.list_items.selected_item = selected_item;
+    msg.list_items.process_enabled_state = false;
+    for (uint i=0; i<msg.list_items.num_items; i++) {
+        _strcpy_to_gui_msg(msg.list_items.list_items[i], list_items[i].c_str());
+    }
+    _post_gui_msg(msg);
+}
+
+//----------------------------------------------------------------------------
+// _post_list_window
+//----------------------------------------------------------------------------
+void GuiManager::_post_list_window(GuiMsgType type, uint selected_item)
+{
+    // Send the window of list items around the selected item
+    auto msg = GuiMsg();
+    msg.type = type;
+    msg.list_window.num_items = _list_window_items.size();
+    msg.list_window.selected_item = selected_item;
+    msg.list_window.process_enabled_state = false;
+    msg.list_window.first_item = _list_window_first_item(selected_item);
+    msg.list_window.num_window_items = std::min<uint>(LIST_WINDOW_LEN, _list_window_items.size() - msg.list_window.first_item);
+    for (uint i=0; i<msg.list_window.num_window_items; i++) {
+        uint item = msg.list_window.first_item + i;
+        _strcpy_to_gui_msg(msg.list_window.list_items[i], _list_window_items[item].c_str());
+        msg.list_window.list_item_enabled[i] = true;
+        _list_window_sent[item] = true;
+    }
+    _post_gui_msg(msg);
+}
+
+//----------------------------------------------------------------------------
+// _list_window_first_item
+//----------------------------------------------------------------------------
+uint GuiManager::_list_window_first_item(uint selected_item) const
+{
+    // Centre the window on the selected item, keeping it within the list
+    uint num_items = _list_window_items.size();
+    if (num_items <= LIST_WINDOW_LEN)
+        return 0;
+    uint first_item = (selected_item > (LIST_WINDOW_LEN / 2)) ? (selected_item - (LIST_WINDOW_LEN / 2)) : 0;
+    return std::min<uint>(first_item, num_items - LIST_WINDOW_LEN);
+}
+
+//----------------------------------------------------------------------------
+// _max_list_items
+//----------------------------------------------------------------------------
+uint GuiManager::_max_list_items()
+{
+    // If the GUI supports list windows, lists are not limited in length
+    return (_gui_msg_ring.gui_capabilities() & GUI_CAP_LIST_WINDOW) ? UINT_MAX : LIST_MAX_LEN;
+}
+
 //----------------------------------------------------------------------------
 // _post_update_selected_list_item
 //----------------------------------------------------------------------------
 void GuiManager::_post_update_selected_list_item(uint selected_item)
 {
+    // If the list is shown as a window, make sure the GUI has the items around the
+    // selected item
+    // Note: If the GUI no longer supports list windows (for example it has disconnected)
+    // the list window is cleared when the message is posted
+    if (!_list_window_items.empty() && (_gui_msg_ring.gui_capabilities() & GUI_CAP_LIST_WINDOW))
+    {
+        uint first_item = _list_window_first_item(selected_item);
+        uint last_item = std::min<uint>(first_item + LIST_WINDOW_LEN, _list_window_items.size());
+        for (uint i=first_item; i<last_item; i++) {
+            if (!_list_window_sent[i]) {
+                _post_list_window(GuiMsgType::LIST_WINDOW_ITEMS, selected_item);
+                break;
+            }
+        }
+    }
+
     // Update the selected list item
     auto msg = GuiMsg();
     msg.type = GuiMsgType::LIST_SELECT_ITEM;
@@ -6738,6 +6855,28 @@ void GuiManager::_post_update_selected_list_item(uint selected_item)
 //----------------------------------------------------------------------------
 void GuiManager::_post_gui_msg(const GuiMsg &msg)
 {
+    // If a list is shown in full, or the GUI no longer supports list windows (for
+    // example it has disconnected), any list window is no longer shown
+    if (!_list_window_items.empty() &&
+        ((msg.type == GuiMsgType::SHOW_LIST_ITEMS) || !(_gui_msg_ring.gui_capabilities() & GUI_CAP_LIST_WINDOW))) {
+        _list_window_items.clear();
+        _list_window_sent.clear();
+    }
+
+    // Post the message to the GUI update compositor - screen messages are sent now,
+    // and state messages at the next GUI frame (if changed)
+    _gui_update_compositor.post(msg);
+}
+
+//----------------------------------------------------------------------------
+// _send_gui_msg
+//----------------------------------------------------------------------------
+void GuiManager::_send_gui_msg(const GuiMsg &msg)
+{
+    // Send the message to the GUI Message Ring, if the GUI is connected to it
+    if (_gui_msg_ring.post(msg))
+        return;
+
     // If the GUI Message Queue is valid
     if (_gui_mq_desc != (mqd_t)-1)
     {
@@ -6745,7 +6884,7 @@ void GuiManager::_post_gui_msg(const GuiMsg &msg)
         if (::mq_send(_gui_mq_desc, (char *)&msg, sizeof(msg), 0) == -1)
         {
             // An error occured
-            MSG("ERROR: Sending GUI Message: " << errno);
+            NINA_TRACE_ERROR(module(), "Sending GUI Message failed: {}", errno);
         }
     }
 }
@@ -6755,8 +6894,15 @@ void GuiManager::_post_gui_msg(const GuiMsg &msg)
 //----------------------------------------------------------------------------
 void GuiManager::_gui_send_callback()
 {
-	// Get the GUI mutex
-	std::lock_guard<std::mutex> guard(_gui_mutex);
+    LatencyTraceId trace_id = NO_LATENCY_TRACE_ID;
+
+    // Process the GUI Message Ring connection, and send any messages held while the
+    // GUI was catching up - if a GUI has connected, send it all the GUI state again
+    if (_gui_msg_ring.process())
+        _gui_update_compositor.reset();
+
+    // Get the GUI mutex
+    std::lock_guard<std::mutex> guard(_gui_mutex);
 
     // Param change available?
     if (_param_change_available && _param_shown)
@@ -6772,22 +6918,31 @@ void GuiManager::_gui_send_callback()
             _post_param_update_value(true);
         }
         _param_change_available = false;
-    }    
+        trace_id = _param_change.trace_id;
+        _param_change.trace_id = NO_LATENCY_TRACE_ID;
+    }
+
+    // Send the GUI state changed this frame
+    _gui_update_compositor.process_frame();
+
+    // If a param change being traced has been posted, record that it has been posted to
+    // the GUI
+    LatencyTrace::Record(trace_id, LatencyTraceStage::GUI_MQ_POST);
 }
 
 //----------------------------------------------------------------------------
 // _process_param_changed_mapped_params
 //----------------------------------------------------------------------------
-void GuiManager::_process_param_changed_mapped_params(const Param *param, float value, const Param *skip_param)
+void GuiManager::_process_param_changed_mapped_params(const Param *changed_param, float changed_value)
 {
-    // Get the mapped params
-    auto mapped_params = param->get_mapped_params();
-    for (Param *mp : mapped_params)
+    // Get the compiled mapping graph for the changed param, and process each mapped
+    // param from the param it is mapped from
+    auto mapped_param_graph = changed_param->get_mapped_param_graph();
+    for (const MappedParamDest& dest : *mapped_param_graph)
     {
-        // Because this function is recursive, we need to skip the param that
-        // caused any recursion, so it is not processed twice
-        if (skip_param && (mp == skip_param))
-            continue;
+        Param *mp = dest.param;
+        const Param *param = dest.source;
+        float value = changed_value;
 
         // Is this a System Func param?
         if (mp->type == ParamType::SYSTEM_FUNC)
@@ -6834,7 +6989,8 @@ void GuiManager::_process_param_changed_mapped_params(const Param *param, float
                 _event_router->post_system_func_event(new SystemFuncEvent(system_func));
             }
 
-            // Note: We don't recurse system function params as they are a system action to be performed
+            // Note: The params mapped to system function params are not in the mapping graph
+            // as they are a system action to be performed
         }
         else
         {
@@ -6850,9 +7006,6 @@ void GuiManager::_process_param_changed_mapped_params(const Param *param, float
                 param_change.display = false;
                 _event_router->post_param_changed_event(new ParamChangedEvent(param_change));             
             }
-
-            // We need to recurse each mapped param and process it
-            _process_param_changed_mapped_params(mp, value, param);           
         }
     }
 }
@@ -7207,46 +7360,15 @@ std::map<uint, std::string> GuiManager::_parse_layers_folder()
 //----------------------------------------------------------------------------
 std::map<uint, std::string> GuiManager::_parse_patches_folder()
 {
-    std::map<uint, std::string> folder_names;
-    struct dirent **dirent = nullptr;
-    int num_files;
-
-    // Scan the patches folder
-    num_files = ::scandir(NINA_PATCHES_DIR, &dirent, 0, ::versionsort);
-    if (num_files > 0) {
-        // Process each directory in the folder
-        for (uint i=0; i<(uint)num_files; i++) {
-            // Is this a directory?
-            if (dirent[i]->d_type == DT_DIR)
-            {
-                // Get the bank index from the folder name
-                // Note: If the folder name format is invalid, atoi will return 0 - which is ok
-                // as this is an invalid bank index                
-                uint index = std::atoi(dirent[i]->d_name);
-
-                // Are the first four characters the bank index?
-                if ((index > 0) && (dirent[i]->d_name[3] == '_'))
-                {
-                    // Has this folder index already been found?
-                    // We ignore any duplicated folders with the same index
-                    if (folder_names[index].empty()) {
-                        // Add the bank name
-                        folder_names[index] = dirent[i]->d_name;
-                    }
-                }
-            }
-            ::free(dirent[i]);
-        }
-    }
-    else if ((num_files == -1) && (errno == ENOENT)) {
+    // Does the patches folder exist?
+    if (!utils::bank_index()->patches_folder_exists()) {
         // Patches folder does not exist - this is a critical error
         MSG("The patches folder does not exist: " << NINA_PATCHES_DIR);
         NINA_LOG_CRITICAL(module(), "The patches folder does not exist: {}", NINA_PATCHES_DIR);
     }
-    if (dirent) {
-        ::free(dirent);
-    }    
-    return folder_names;
+
+    // Return the bank folders from the bank index
+    return utils::bank_index()->bank_folders();
 }
 
 //----------------------------------------------------------------------------
@@ -7255,38 +7377,16 @@ std::map<uint, std::string> GuiManager::_parse_patches_folder()
 std::map<uint, std::string> GuiManager::_parse_bank_folder(const std::string bank_folder_path)
 {
     std::map<uint, std::string> filenames;
-    struct dirent **dirent = nullptr;
-    int num_files;
+    std::map<uint, std::string> patch_files;
 
-    // Scan the patches bank folder
-    num_files = ::scandir(bank_folder_path.c_str(), &dirent, 0, ::versionsort);
-    if (num_files > 0) {
-        // Process each file in the folder
-        for (uint i=0; i<(uint)num_files; i++) {
-            // Is this a normal file?
-            if (dirent[i]->d_type == DT_REG)
-            {
-                // Get the patch index from the filename
-                // Note: If the filename format is invalid, atoi will return 0 - which is ok
-                // as this is an invalid patch index
-                uint index = std::atoi(dirent[i]->d_name);
-
-                // Are the first two characters the patch number?
-                if ((index > 0) && (dirent[i]->d_name[3] == '_'))
-                {
-                    // Has this patch already been found?
-                    // We ignore any duplicated patches with the same index
-                    if (filenames[index].empty()) {                    
-                        // Add the patch name
-                        auto name = std::string(dirent[i]->d_name);
-                        filenames[index] = name.substr(0, (name.size() - (sizeof(".json") - 1)));
-                    }
-                }
-            }
-            ::free(dirent[i]);
+    // Get the patch files in this bank from the bank index
+    if (utils::bank_index()->patch_files(bank_folder_path, patch_files)) {
+        // Add each patch name
+        for (const auto& pf : patch_files) {
+            filenames[pf.first] = pf.second.substr(0, (pf.second.size() - (sizeof(".json") - 1)));
         }
     }
-    else if ((num_files == -1) && (errno == ENOENT)) {
+    else {
         // The bank folder folder does not exist - show and log the error
         MSG("The patches bank folder does not exist: " << bank_folder_path);
         NINA_LOG_ERROR(module(), "The patches bank folder does not exist: {}", bank_folder_path);
@@ -7301,9 +7401,6 @@ std::map<uint, std::string> GuiManager::_parse_bank_folder(const std::string ban
             filenames[i] = utils::get_default_patch_filename(i, false);
         }
     }
-    if (dirent) {
-        ::free(dirent);
-    }    
     return filenames;
 }
 
@@ -7350,44 +7447,23 @@ std::vector<std::string> GuiManager::_parse_wavetable_folder()
 //----------------------------------------------------------------------------
 bool GuiManager::_open_bank_folder(uint bank_index, std::string& full_path, std::string& folder_name)
 {
-    char bank_file_prefix[5];
-    bool ret = false;
-
-    // Format the bank and patch file prefixes
-    std::sprintf(bank_file_prefix, "%03d_", bank_index);
-
-    // Open the patches folder
-    auto dir = ::opendir(NINA_PATCHES_DIR);
-    if (dir != nullptr)
-    {
-        struct dirent *dirent;
-
-        // Parse each directory, looking for the bank folder
-        while ((dirent = ::readdir(dir)) != nullptr)
-        {
-            // Is this a directory?
-            if (dirent->d_type == DT_DIR)
-            {
-                // Is this the specified bank folder?
-                if (std::strncmp(dirent->d_name, bank_file_prefix, (sizeof(bank_file_prefix)-1)) == 0)
-                {
-                    // Bank folder found
-                    full_path = NINA_PATCHES_DIR + std::string(dirent->d_name);
-                    folder_name = dirent->d_name;
-                    ret = true;
-                    break;
-                }
-            }
-        }
-        ::closedir(dir);
-    }
-    else
+    // Does the patches folder exist?
+    if (!utils::bank_index()->patches_folder_exists())
     {
         // Patches folder does not exist - this is a critical error
         MSG("The patches folder does not exist: " << NINA_PATCHES_DIR);
         NINA_LOG_CRITICAL(module(), "The patches folder does not exist: {}", NINA_PATCHES_DIR);
+        return false;
     }
-    return ret;
+
+    // Find the bank folder in the bank index
+    if (utils::bank_index()->bank_folder(bank_index, folder_name))
+    {
+        // Bank folder found
+        full_path = NINA_PATCHES_DIR + folder_name;
+        return true;
+    }
+    return false;
 }
 
 //----------------------------------------------------------------------------
@@ -7395,53 +7471,30 @@ bool GuiManager::_open_bank_folder(uint bank_index, std::string& full_path, std:
 //----------------------------------------------------------------------------
 bool GuiManager::_get_patch_filename(uint patch_index, std::string bank_folder_path, std::string& filename)
 {
-    bool ret = false;
+    std::map<uint, std::string> patch_files;
 
-    // Open the bank folder
-    auto dir = ::opendir(bank_folder_path.c_str());
-    if (dir != nullptr)
+    // Get the patch files in this bank from the bank index
+    if (!utils::bank_index()->patch_files(bank_folder_path, patch_files))
     {
-        struct dirent *dirent;
-
-        // Parse each directory, looking for the bank folder
-        while ((dirent = ::readdir(dir)) != nullptr)
-        {
-            // Is this a normal file?
-            if (dirent->d_type == DT_REG)
-            {
-                // Get the patch number from the filename
-                // Note: If the filename format is invalid, atoi will return 0 - which is ok
-                // as this is an invalid patch index
-                uint num = std::atoi(dirent->d_name);
-
-                // Are the first two characters the patch number?
-                if ((num == patch_index) && (dirent->d_name[3] == '_'))
-                {
-                    // Set the patch name
-                    auto name = std::string(dirent->d_name);
-                    filename = name.substr(0, (name.size() - (sizeof(".json") - 1)));
-                    ret = true;
-                    break;
-                }
-            }
-        }
-        ::closedir(dir);
+        // The bank folder folder does not exist - show and log the error
+        MSG("The patches bank folder does not exist: " << bank_folder_path);
+        NINA_LOG_ERROR(module(), "The patche bank folder does not exist: {}", bank_folder_path);
+        return false;
+    }
 
-        // Patch found?
-        if (!ret)
-        {
-            // The patch does not exist - in which case we can safely assume the default is loaded           
-            filename = utils::get_default_patch_filename(patch_index, false);
-            ret = true;
-        }        
+    // Patch found?
+    auto itr = patch_files.find(patch_index);
+    if (itr != patch_files.end())
+    {
+        // Set the patch name
+        filename = itr->second.substr(0, (itr->second.size() - (sizeof(".json") - 1)));
     }
     else
     {
-        // The bank folder folder does not exist - show and log the error
-        MSG("The patches bank folder does not exist: " << bank_folder_path);
-        NINA_LOG_ERROR(module(), "The patche bank folder does not exist: {}", bank_folder_path);
+        // The patch does not exist - in which case we can safely assume the default is loaded           
+        filename = utils::get_default_patch_filename(patch_index, false);
     }
-    return ret;    
+    return true;
 }
 
 //----------------------------------------------------------------------------
@@ -7763,7 +7816,7 @@ void GuiManager::_set_eg_2_level_dst_control(const Param *dst_param, bool set_kn
 
             // Should we send a param change to set the knob position?
             if (set_knob_pos) {
-                auto param_change = ParamChange(knob_param->get_path(), value, module());
+                auto param_change = ParamChange(knob_param->handle, value, module());
                 param_change.display = false;
                 _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
             }
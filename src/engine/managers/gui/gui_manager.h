@@ -20,6 +20,8 @@
 #include "event_router.h"
 #include "param.h"
 #include "gui_msg.h"
+#include "gui_msg_ring.h"
+#include "gui_update_compositor.h"
 #include "gui_state.h"
 
 enum class SoftButton {
@@ -76,6 +78,8 @@ private:
     EventListener *_osc_system_func_listener;
     EventListener *_sw_update_system_func_listener;
     mqd_t _gui_mq_desc;
+    GuiMsgRing _gui_msg_ring;
+    GuiUpdateCompositor _gui_update_compositor;
     Timer *_gui_msg_send_timer;
     Timer *_param_changed_timer;    
     Timer *_activity_timer;
@@ -117,6 +121,8 @@ private:
     bool _showing_param_shortcut;
     uint _num_list_items;
     std::map<uint, std::string> _list_items;
+    std::vector<std::string> _list_window_items;
+    std::vector<bool> _list_window_sent;
     std::vector<std::string> _filenames;
     std::string _edit_name;
     std::string _save_edit_name;
@@ -272,11 +278,16 @@ private:
     void _post_enum_list_param_update_value(uint value);
     void _post_file_browser_param_update();
     void _post_soft_button_state_update(uint state, SoftButton soft_button);
+    void _post_list_items(const std::vector<std::string> &list_items, uint selected_item);
+    void _post_list_window(GuiMsgType type, uint selected_item);
+    uint _list_window_first_item(uint selected_item) const;
+    uint _max_list_items();
     void _post_update_selected_list_item(uint selected_item);
     void _clear_warning_screen();
     void _post_gui_msg(const GuiMsg &msg);
+    void _send_gui_msg(const GuiMsg &msg);
     void _gui_send_callback();
-    void _process_param_changed_mapped_params(const Param *param, float value, const Param *skip_param);
+    void _process_param_changed_mapped_params(const Param *changed_param, float changed_value);
     void _activity_timer_callback();
 
     void _config_data_knob(int num_selectable_positions=-1, float pos=-1.0);
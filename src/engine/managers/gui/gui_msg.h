@@ -10,11 +10,15 @@
 #define _GUI_MSG_H
 
 #include <mqueue.h>
+#include <atomic>
+#include <cstdint>
 
 // Constants
 constexpr uint LIST_MAX_LEN      = 128;
+constexpr uint LIST_WINDOW_LEN   = 16;
 constexpr uint STD_STR_LEN       = 40;
 constexpr uint EDIT_NAME_STR_LEN = 20;
+constexpr uint GUI_REFRESH_RATE  = 60;
 
 // GUI message type
 enum GuiMsgType : int
@@ -38,7 +42,9 @@ enum GuiMsgType : int
     SHOW_CONF_SCREEN,
     SHOW_WARNING_SCREEN,
     CLEAR_BOOT_WARNING_SCREEN,
-    SET_SYSTEM_COLOUR
+    SET_SYSTEM_COLOUR,
+    SHOW_LIST_WINDOW,
+    LIST_WINDOW_ITEMS
 };
 
 // GUI scope mode
@@ -85,6 +91,23 @@ struct ListItems
     bool list_item_enabled[LIST_MAX_LEN];
 };
 
+// List window
+// A virtualized list is shown with SHOW_LIST_WINDOW, giving the total number of
+// items in the list and the window of items around the selected item. As the list
+// is scrolled, further windows of items are sent with LIST_WINDOW_ITEMS - the GUI
+// keeps the items it has been sent for the list, until a new list is shown
+// Note: Only sent if the GUI has indicated it supports list windows (GUI_CAP_LIST_WINDOW)
+struct ListWindow
+{
+    uint num_items;
+    uint selected_item;
+    bool process_enabled_state;
+    uint first_item;
+    uint num_window_items;
+    char list_items[LIST_WINDOW_LEN][STD_STR_LEN];
+    bool list_item_enabled[LIST_WINDOW_LEN];
+};
+
 struct ListSelectItem
 {
     uint selected_item;
@@ -181,6 +204,7 @@ struct GuiMsg
         TempoStatus tempo_status;
         HomeScreen home_screen;
         ListItems list_items;
+        ListWindow list_window;
         ListSelectItem list_select_item;
         SoftButtons soft_buttons;
         SoftButtonsState soft_buttons_state;
@@ -201,4 +225,78 @@ struct GuiMsg
     ~GuiMsg() {}
 };
 
+// GUI message payload size
+// The size of the GUI message data used by each message type
+inline uint gui_msg_payload_size(GuiMsgType type)
+{
+    switch (type)
+    {
+        case SET_LEFT_STATUS:           return sizeof(LeftStatus);
+        case SET_LAYER_STATUS:          return sizeof(LayerStatus);
+        case SET_MIDI_STATUS:           return sizeof(MidiStatus);
+        case SET_TEMPO_STATUS:          return sizeof(TempoStatus);
+        case SHOW_HOME_SCREEN:          return sizeof(HomeScreen);
+        case SHOW_LIST_ITEMS:           return sizeof(ListItems);
+        case LIST_SELECT_ITEM:          return sizeof(ListSelectItem);
+        case SET_SOFT_BUTTONS:          return sizeof(SoftButtons);
+        case SET_SOFT_BUTTONS_STATE:    return sizeof(SoftButtonsState);
+        case SHOW_PARAM_UPDATE:         return sizeof(ParamUpdate);
+        case PARAM_UPDATE_VALUE:        return sizeof(ParamUpdateValue);
+        case ENUM_PARAM_UPDATE:         return sizeof(EnumParamUpdate);
+        case ENUM_PARAM_UPDATE_VALUE:   return sizeof(ListSelectItem);
+        case EDIT_NAME:                 return sizeof(EditName);
+        case EDIT_NAME_SELECT_CHAR:     return sizeof(EditNameSelectChar);
+        case EDIT_NAME_CHANGE_CHAR:     return sizeof(EditNameChangeChar);
+        case SHOW_CONF_SCREEN:          return sizeof(ConfirmationScreen);
+        case SHOW_WARNING_SCREEN:       return sizeof(WarningScreen);
+        case SET_SYSTEM_COLOUR:         return sizeof(SetSystemColour);
+        case SHOW_LIST_WINDOW:          return sizeof(ListWindow);
+        case LIST_WINDOW_ITEMS:         return sizeof(ListWindow);
+        case CLEAR_BOOT_WARNING_SCREEN:
+        default:                        return 0;
+    }
+}
+
+// GUI message ring constants
+constexpr char GUI_MSG_RING_NAME[]        = "/nina_gui_ring";
+constexpr char GUI_MSG_RING_SOCKET_PATH[] = "/tmp/nina_gui_ring.sock";
+constexpr uint32_t GUI_MSG_RING_MAGIC     = 0x4E475200;
+constexpr uint32_t GUI_MSG_RING_SIZE      = (256 * 1024);
+constexpr uint32_t GUI_MSG_FRAME_ALIGN    = 8;
+constexpr int32_t GUI_MSG_FRAME_PAD_TYPE  = -1;
+
+// GUI capabilities
+// Sent by the GUI to the UI on the GUI message ring socket, as a uint32_t of flags
+constexpr uint32_t GUI_CAP_LIST_WINDOW    = 0x00000001;
+
+// GUI message ring header
+// The GUI message ring is a single-producer/single-consumer ring in shared memory,
+// written by the UI and read by the GUI. The ring data follows the header, and holds
+// variable length GUI message frames - each frame is a GuiMsgFrame header followed
+// by the message payload (sized by the message type), padded to GUI_MSG_FRAME_ALIGN
+// bytes - the frame size is the payload size. A frame never wraps around the
+// end of the ring, if there is not enough space before the end for the frame, a pad
+// frame is written to fill it
+// The head and tail are free running byte counts, the head is only written by the
+// UI and the tail by the GUI
+// The GUI collects the doorbell eventfd by connecting to the GUI message ring socket,
+// and can then send its capabilities on the socket.
+// Before blocking on the eventfd, the GUI sets consumer_waiting and then re-checks the
+// ring is empty - the UI only signals the eventfd if the GUI is waiting
+struct GuiMsgRingHeader
+{
+    uint32_t magic;
+    uint32_t size;
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    std::atomic<uint32_t> consumer_waiting;
+};
+
+// GUI message frame
+struct GuiMsgFrame
+{
+    uint32_t size;
+    int32_t type;
+};
+
 #endif  // _GUI_MSG_H
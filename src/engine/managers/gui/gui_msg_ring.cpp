@@ -0,0 +1,449 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_msg_ring.cpp
+ * @brief GUI Message Ring implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <new>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "gui_msg_ring.h"
+
+// Constants
+constexpr size_t GUI_MSG_RING_SHM_SIZE = (sizeof(GuiMsgRingHeader) + GUI_MSG_RING_SIZE);
+
+//----------------------------------------------------------------------------
+// GuiMsgRing
+//----------------------------------------------------------------------------
+GuiMsgRing::GuiMsgRing()
+{
+    // Initialise class data
+    _header = nullptr;
+    _data = nullptr;
+    _doorbell_fd = -1;
+    _listen_fd = -1;
+    _gui_fd = -1;
+    _gui_capabilities = 0;
+}
+
+//----------------------------------------------------------------------------
+// ~GuiMsgRing
+//----------------------------------------------------------------------------
+GuiMsgRing::~GuiMsgRing()
+{
+    // Close the ring
+    close();
+}
+
+//----------------------------------------------------------------------------
+// open
+//----------------------------------------------------------------------------
+bool GuiMsgRing::open()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Create the GUI Message Ring shared memory
+    int fd = ::shm_open(GUI_MSG_RING_NAME, (O_CREAT|O_RDWR),
+                        (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH));
+    if (fd < 0)
+    {
+        // Error opening the GUI Message Ring
+        MSG("ERROR: Could not open the GUI Message Ring: " << errno);
+        return false;
+    }
+    void *mem = MAP_FAILED;
+    if (::ftruncate(fd, GUI_MSG_RING_SHM_SIZE) == 0)
+    {
+        mem = ::mmap(nullptr, GUI_MSG_RING_SHM_SIZE, (PROT_READ|PROT_WRITE), MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (mem == MAP_FAILED)
+    {
+        // Error mapping the GUI Message Ring
+        MSG("ERROR: Could not map the GUI Message Ring: " << errno);
+        ::shm_unlink(GUI_MSG_RING_NAME);
+        return false;
+    }
+
+    // Initialise the ring header - the magic number is set last, to indicate the ring
+    // is valid
+    _header = new (mem) GuiMsgRingHeader;
+    _header->size = GUI_MSG_RING_SIZE;
+    _header->head.store(0);
+    _header->tail.store(0);
+    _header->consumer_waiting.store(0);
+    std::atomic_thread_fence(std::memory_order_release);
+    _header->magic = GUI_MSG_RING_MAGIC;
+    _data = static_cast<uint8_t *>(mem) + sizeof(GuiMsgRingHeader);
+
+    // Create the doorbell eventfd, and the socket the GUI connects to to collect it
+    _doorbell_fd = ::eventfd(0, (EFD_CLOEXEC|EFD_NONBLOCK));
+    _listen_fd = ::socket(AF_UNIX, (SOCK_STREAM|SOCK_NONBLOCK|SOCK_CLOEXEC), 0);
+    if ((_doorbell_fd >= 0) && (_listen_fd >= 0))
+    {
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, GUI_MSG_RING_SOCKET_PATH, (sizeof(addr.sun_path) - 1));
+        ::unlink(GUI_MSG_RING_SOCKET_PATH);
+        if ((::bind(_listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0) &&
+            (::chmod(GUI_MSG_RING_SOCKET_PATH, (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH)) == 0) &&
+            (::listen(_listen_fd, 1) == 0))
+        {
+            return true;
+        }
+    }
+
+    // Error creating the GUI Message Ring doorbell
+    MSG("ERROR: Could not create the GUI Message Ring doorbell: " << errno);
+    _close();
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// close
+//----------------------------------------------------------------------------
+void GuiMsgRing::close()
+{
+    // Close the ring
+    std::lock_guard<std::mutex> lock(_mutex);
+    _close();
+}
+
+//----------------------------------------------------------------------------
+// _close
+// Note: The ring mutex must be held by the caller
+//----------------------------------------------------------------------------
+void GuiMsgRing::_close()
+{
+    // Disconnect the GUI, and close the socket and doorbell
+    _disconnect_gui();
+    if (_listen_fd >= 0)
+    {
+        ::close(_listen_fd);
+        ::unlink(GUI_MSG_RING_SOCKET_PATH);
+        _listen_fd = -1;
+    }
+    if (_doorbell_fd >= 0)
+    {
+        ::close(_doorbell_fd);
+        _doorbell_fd = -1;
+    }
+
+    // Unmap and unlink the shared memory - the GUI maps the ring each time it connects,
+    // so any mapping it still holds is released when it disconnects
+    if (_header)
+    {
+        _header->magic = 0;
+        ::munmap(_header, GUI_MSG_RING_SHM_SIZE);
+        ::shm_unlink(GUI_MSG_RING_NAME);
+        _header = nullptr;
+        _data = nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+// post
+//----------------------------------------------------------------------------
+bool GuiMsgRing::post(const GuiMsg &msg)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // The ring is only used once a GUI has connected and collected the doorbell
+    if (_gui_fd < 0)
+        return false;
+
+    // Send any backlog first, so that the messages are always sent in order
+    if (!_backlog.empty())
+        _flush_backlog();
+
+    // Write the message to the ring
+    if (_backlog.empty() && _write(msg))
+    {
+        _ring_doorbell();
+        return true;
+    }
+
+    // There is not enough space in the ring, so the message is held in the backlog (or
+    // supersedes a message of the same type already held)
+    if (!_coalesce(msg))
+    {
+        // If the backlog is full, drop the oldest message
+        if (_backlog.size() >= GUI_MSG_RING_MAX_BACKLOG)
+        {
+            MSG("ERROR: GUI Message Ring backlog full, message dropped");
+            _backlog.pop_front();
+        }
+        _backlog.push_back(msg);
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// process
+//----------------------------------------------------------------------------
+bool GuiMsgRing::process()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Accept any new GUI connection, check the connected GUI is still running, and
+    // send any backlog the GUI now has space for
+    bool connected = _accept_gui();
+    _check_gui();
+    if ((_gui_fd >= 0) && !_backlog.empty())
+        _flush_backlog();
+
+    // Return if a GUI has connected
+    return connected;
+}
+
+//----------------------------------------------------------------------------
+// gui_capabilities
+//----------------------------------------------------------------------------
+uint32_t GuiMsgRing::gui_capabilities()
+{
+    // Return the capabilities sent by the connected GUI
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _gui_capabilities;
+}
+
+//----------------------------------------------------------------------------
+// _accept_gui
+// Note: The ring mutex must be held by the caller
+//----------------------------------------------------------------------------
+bool GuiMsgRing::_accept_gui()
+{
+    // Has a GUI connected?
+    if (_listen_fd < 0)
+        return false;
+    int fd = ::accept4(_listen_fd, nullptr, nullptr, (SOCK_NONBLOCK|SOCK_CLOEXEC));
+    if (fd >= 0)
+    {
+        // Send the GUI the doorbell - this replaces any previous GUI connection
+        if (_send_doorbell(fd))
+        {
+            _disconnect_gui();
+            _gui_fd = fd;
+            MSG("GUI connected to the GUI Message Ring");
+            return true;
+        }
+        ::close(fd);
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// _check_gui
+// Note: The ring mutex must be held by the caller
+//----------------------------------------------------------------------------
+void GuiMsgRing::_check_gui()
+{
+    // Has the GUI sent its capabilities, or closed the connection?
+    if (_gui_fd >= 0)
+    {
+        uint32_t buf[4];
+        auto res = ::recv(_gui_fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (res >= (int)sizeof(uint32_t))
+        {
+            // Use the latest capabilities sent
+            _gui_capabilities = buf[(res / sizeof(uint32_t)) - 1];
+        }
+        else if ((res == 0) || ((res < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)))
+        {
+            MSG("GUI disconnected from the GUI Message Ring");
+            _disconnect_gui();
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _disconnect_gui
+// Note: The ring mutex must be held by the caller
+//----------------------------------------------------------------------------
+void GuiMsgRing::_disconnect_gui()
+{
+    // Close the GUI connection, and discard any backlog
+    if (_gui_fd >= 0)
+    {
+        ::close(_gui_fd);
+        _gui_fd = -1;
+    }
+    _gui_capabilities = 0;
+    _backlog.clear();
+}
+
+//----------------------------------------------------------------------------
+// _send_doorbell
+//----------------------------------------------------------------------------
+bool GuiMsgRing::_send_doorbell(int fd)
+{
+    char data = 0;
+    iovec iov;
+    msghdr msg;
+    union {
+        cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } ctrl;
+
+    // Send the doorbell eventfd to the GUI
+    iov.iov_base = &data;
+    iov.iov_len = sizeof(data);
+    std::memset(&msg, 0, sizeof(msg));
+    std::memset(&ctrl, 0, sizeof(ctrl));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl.buf;
+    msg.msg_controllen = sizeof(ctrl.buf);
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &_doorbell_fd, sizeof(int));
+    return ::sendmsg(fd, &msg, MSG_NOSIGNAL) == sizeof(data);
+}
+
+//----------------------------------------------------------------------------
+// _flush_backlog
+// Note: The ring mutex must be held by the caller
+//----------------------------------------------------------------------------
+void GuiMsgRing::_flush_backlog()
+{
+    // Write as much of the backlog as the ring has space for, and ring the doorbell
+    // once for all the messages written
+    bool written = false;
+    while (!_backlog.empty() && _write(_backlog.front()))
+    {
+        _backlog.pop_front();
+        written = true;
+    }
+    if (written)
+        _ring_doorbell();
+}
+
+//----------------------------------------------------------------------------
+// _write
+// Note: The ring mutex must be held by the caller
+//----------------------------------------------------------------------------
+bool GuiMsgRing::_write(const GuiMsg &msg)
+{
+    // Get the frame size, and the space before the end of the ring
+    uint32_t payload_size = gui_msg_payload_size(msg.type);
+    uint32_t frame_size = (sizeof(GuiMsgFrame) + payload_size + (GUI_MSG_FRAME_ALIGN - 1)) & ~(GUI_MSG_FRAME_ALIGN - 1);
+    uint64_t head = _header->head.load(std::memory_order_relaxed);
+    uint64_t tail = _header->tail.load(std::memory_order_acquire);
+    uint32_t offset = head % GUI_MSG_RING_SIZE;
+    uint32_t space_to_end = GUI_MSG_RING_SIZE - offset;
+    uint32_t pad_size = (space_to_end < frame_size) ? space_to_end : 0;
+
+    // Is there space for the frame (and any pad frame needed before it)?
+    if ((GUI_MSG_RING_SIZE - (head - tail)) < (pad_size + frame_size))
+        return false;
+
+    // If the frame does not fit before the end of the ring, pad the end of the ring and
+    // write the frame at the start
+    if (pad_size)
+    {
+        auto pad_frame = reinterpret_cast<GuiMsgFrame *>(_data + offset);
+        pad_frame->size = pad_size - sizeof(GuiMsgFrame);
+        pad_frame->type = GUI_MSG_FRAME_PAD_TYPE;
+        offset = 0;
+    }
+
+    // Write the frame, and pass it to the GUI
+    auto frame = reinterpret_cast<GuiMsgFrame *>(_data + offset);
+    frame->size = payload_size;
+    frame->type = msg.type;
+    std::memcpy((frame + 1), &msg.left_status, payload_size);
+    _header->head.store((head + pad_size + frame_size), std::memory_order_release);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _ring_doorbell
+// Note: The ring mutex must be held by the caller
+//----------------------------------------------------------------------------
+void GuiMsgRing::_ring_doorbell()
+{
+    // Wake the GUI if it is waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_header->consumer_waiting.exchange(0))
+    {
+        uint64_t val = 1;
+        [[maybe_unused]] auto res = ::write(_doorbell_fd, &val, sizeof(val));
+    }
+}
+
+//----------------------------------------------------------------------------
+// _coalesce
+// Note: The ring mutex must be held by the caller
+//----------------------------------------------------------------------------
+bool GuiMsgRing::_coalesce(const GuiMsg &msg)
+{
+    // Only update messages can be coalesced
+    if (!_is_update_msg(msg.type))
+        return false;
+
+    // Find a held message of the same type this message supersedes - only the update
+    // messages since the last held screen message are checked, so the message is
+    // never moved across a screen change
+    for (auto itr = _backlog.rbegin(); (itr != _backlog.rend()) && _is_update_msg(itr->type); ++itr)
+    {
+        if (itr->type != msg.type)
+            continue;
+        if (msg.type == GuiMsgType::SET_SOFT_BUTTONS_STATE)
+        {
+            // The soft button states are merged, as only the buttons with a state (not -1)
+            // are updated
+            auto& state = itr->soft_buttons_state;
+            if (msg.soft_buttons_state.state_button1 != -1)
+                state.state_button1 = msg.soft_buttons_state.state_button1;
+            if (msg.soft_buttons_state.state_button2 != -1)
+                state.state_button2 = msg.soft_buttons_state.state_button2;
+            if (msg.soft_buttons_state.state_button3 != -1)
+                state.state_button3 = msg.soft_buttons_state.state_button3;
+            return true;
+        }
+        if (((msg.type == GuiMsgType::LIST_SELECT_ITEM) || (msg.type == GuiMsgType::ENUM_PARAM_UPDATE_VALUE)) &&
+            (itr->list_select_item.wt_list != msg.list_select_item.wt_list))
+            continue;
+        *itr = msg;
+        return true;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// _is_update_msg
+//----------------------------------------------------------------------------
+bool GuiMsgRing::_is_update_msg(GuiMsgType type) const
+{
+    // Is this a message that updates a value shown, rather than changing the screen?
+    switch (type)
+    {
+        case GuiMsgType::SET_LEFT_STATUS:
+        case GuiMsgType::SET_LAYER_STATUS:
+        case GuiMsgType::SET_MIDI_STATUS:
+        case GuiMsgType::SET_TEMPO_STATUS:
+        case GuiMsgType::LIST_SELECT_ITEM:
+        case GuiMsgType::SET_SOFT_BUTTONS_STATE:
+        case GuiMsgType::PARAM_UPDATE_VALUE:
+        case GuiMsgType::ENUM_PARAM_UPDATE_VALUE:
+        case GuiMsgType::EDIT_NAME_SELECT_CHAR:
+        case GuiMsgType::EDIT_NAME_CHANGE_CHAR:
+            return true;
+
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,64 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_msg_ring.h
+ * @brief GUI Message Ring class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _GUI_MSG_RING_H
+#define _GUI_MSG_RING_H
+
+#include <mutex>
+#include <deque>
+#include "gui_msg.h"
+#include "common.h"
+
+// GUI message ring constants
+constexpr uint GUI_MSG_RING_MAX_BACKLOG = 64;
+
+// GUI Message Ring class
+// The UI side of the shared memory GUI message ring (see GuiMsgRingHeader). If the
+// ring does not have space for a message, the message is held in a backlog until the
+// GUI catches up - while held, a message that updates a value (for example
+// PARAM_UPDATE_VALUE) is superseded by a later message of the same type, rather
+// than both being sent
+class GuiMsgRing
+{
+public:
+    // Constructor/destructor
+    GuiMsgRing();
+    ~GuiMsgRing();
+
+    // Public functions
+    bool open();
+    void close();
+    bool post(const GuiMsg &msg);
+    bool process();
+    uint32_t gui_capabilities();
+
+private:
+    // Private variables
+    std::mutex _mutex;
+    GuiMsgRingHeader *_header;
+    uint8_t *_data;
+    int _doorbell_fd;
+    int _listen_fd;
+    int _gui_fd;
+    uint32_t _gui_capabilities;
+    std::deque<GuiMsg> _backlog;
+
+    // Private functions
+    void _close();
+    bool _accept_gui();
+    void _check_gui();
+    void _disconnect_gui();
+    bool _send_doorbell(int fd);
+    void _flush_backlog();
+    bool _write(const GuiMsg &msg);
+    void _ring_doorbell();
+    bool _coalesce(const GuiMsg &msg);
+    bool _is_update_msg(GuiMsgType type) const;
+};
+
+#endif // _GUI_MSG_RING_H
@@ -87,6 +87,7 @@ enum SystemMenuOption : int {
     CAL_FILTER,
     FACTORY_CALIBRATE,
     RUN_DIAG_SCRIPT,
+    EXPORT_LATENCY_TRACE,
     GLOBAL_SETTINGS,
     BANK_MANAGMENT,
     WAVETABLE_MANAGEMENT,
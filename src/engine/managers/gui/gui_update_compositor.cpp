@@ -0,0 +1,188 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_update_compositor.cpp
+ * @brief GUI Update Compositor implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "gui_update_compositor.h"
+
+//----------------------------------------------------------------------------
+// GuiUpdateCompositor
+//----------------------------------------------------------------------------
+GuiUpdateCompositor::GuiUpdateCompositor(std::function<void(const GuiMsg &)> send_fn) :
+    _send_fn(send_fn)
+{
+    // Initialise class data
+    _pending.reserve(GUI_NUM_STATE_SLOTS);
+    _sent_valid.fill(false);
+}
+
+//----------------------------------------------------------------------------
+// post
+//----------------------------------------------------------------------------
+void GuiUpdateCompositor::post(const GuiMsg &msg)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Is this a screen message?
+    if (_state_slot(msg.type) < 0)
+    {
+        // Send any pending state first, and then the message - after the screen
+        // message, all state is sent again
+        // Note: The list window items only add items to the list already shown, so the
+        // GUI does not redraw the state
+        _send_pending();
+        _send_fn(msg);
+        if (msg.type != GuiMsgType::LIST_WINDOW_ITEMS)
+            _sent_valid.fill(false);
+        return;
+    }
+
+    // Hold the state until the next frame, superseding any state of the same type
+    // already pending - the state is moved to the end, so the pending state is sent
+    // in the order it was last posted
+    auto itr = std::find_if(_pending.begin(), _pending.end(), [&msg](const GuiMsg &m) {
+        return m.type == msg.type;
+    });
+    if (itr != _pending.end())
+    {
+        // The soft button states are merged, as only the buttons with a state (not -1)
+        // are updated
+        if (msg.type == GuiMsgType::SET_SOFT_BUTTONS_STATE)
+        {
+            GuiMsg merged = *itr;
+            if (msg.soft_buttons_state.state_button1 != -1)
+                merged.soft_buttons_state.state_button1 = msg.soft_buttons_state.state_button1;
+            if (msg.soft_buttons_state.state_button2 != -1)
+                merged.soft_buttons_state.state_button2 = msg.soft_buttons_state.state_button2;
+            if (msg.soft_buttons_state.state_button3 != -1)
+                merged.soft_buttons_state.state_button3 = msg.soft_buttons_state.state_button3;
+            _pending.erase(itr);
+            _pending.push_back(merged);
+            return;
+        }
+        _pending.erase(itr);
+    }
+    _pending.push_back(msg);
+}
+
+//----------------------------------------------------------------------------
+// process_frame
+//----------------------------------------------------------------------------
+void GuiUpdateCompositor::process_frame()
+{
+    // Send the state changed this frame
+    std::lock_guard<std::mutex> lock(_mutex);
+    _send_pending();
+}
+
+//----------------------------------------------------------------------------
+// reset
+//----------------------------------------------------------------------------
+void GuiUpdateCompositor::reset()
+{
+    // Send all state again, for example if the GUI has restarted
+    std::lock_guard<std::mutex> lock(_mutex);
+    _sent_valid.fill(false);
+}
+
+//----------------------------------------------------------------------------
+// _send_pending
+// Note: The compositor mutex must be held by the caller
+//----------------------------------------------------------------------------
+void GuiUpdateCompositor::_send_pending()
+{
+    // Send each pending state that differs from the state last sent
+    for (const GuiMsg &msg : _pending)
+    {
+        // The soft button states are sent per button
+        if (msg.type == GuiMsgType::SET_SOFT_BUTTONS_STATE)
+        {
+            _send_soft_buttons_state(msg);
+            continue;
+        }
+
+        // Has the state changed?
+        uint slot = _state_slot(msg.type);
+        if (_sent_valid[slot] && (std::memcmp(&_sent[slot].left_status, &msg.left_status, gui_msg_payload_size(msg.type)) == 0))
+            continue;
+        _send_fn(msg);
+        _sent[slot] = msg;
+        _sent_valid[slot] = true;
+
+        // The GUI may reset the soft button states when the soft buttons are set, so send
+        // them again
+        if (msg.type == GuiMsgType::SET_SOFT_BUTTONS)
+            _sent_valid[_state_slot(GuiMsgType::SET_SOFT_BUTTONS_STATE)] = false;
+    }
+    _pending.clear();
+}
+
+//----------------------------------------------------------------------------
+// _send_soft_buttons_state
+// Note: The compositor mutex must be held by the caller
+//----------------------------------------------------------------------------
+void GuiUpdateCompositor::_send_soft_buttons_state(const GuiMsg &msg)
+{
+    uint slot = _state_slot(GuiMsgType::SET_SOFT_BUTTONS_STATE);
+    auto& sent = _sent[slot].soft_buttons_state;
+    auto delta = msg;
+    int *delta_states[] = { &delta.soft_buttons_state.state_button1,
+                            &delta.soft_buttons_state.state_button2,
+                            &delta.soft_buttons_state.state_button3 };
+    int *sent_states[] = { &sent.state_button1, &sent.state_button2, &sent.state_button3 };
+    bool changed = false;
+
+    // If no button states have been sent, no state is known for any button
+    if (!_sent_valid[slot])
+    {
+        for (int *state : sent_states)
+            *state = -1;
+        _sent_valid[slot] = true;
+    }
+
+    // Only send the buttons whose state has changed
+    for (uint i=0; i<3; i++)
+    {
+        if (*delta_states[i] == -1)
+            continue;
+        if (*delta_states[i] == *sent_states[i])
+        {
+            *delta_states[i] = -1;
+            continue;
+        }
+        *sent_states[i] = *delta_states[i];
+        changed = true;
+    }
+    if (changed)
+        _send_fn(delta);
+}
+
+//----------------------------------------------------------------------------
+// _state_slot
+//----------------------------------------------------------------------------
+int GuiUpdateCompositor::_state_slot(GuiMsgType type) const
+{
+    // Return the slot for a state message, or -1 if this is a screen message
+    switch (type)
+    {
+        case GuiMsgType::SET_LEFT_STATUS:           return 0;
+        case GuiMsgType::SET_LAYER_STATUS:          return 1;
+        case GuiMsgType::SET_MIDI_STATUS:           return 2;
+        case GuiMsgType::SET_TEMPO_STATUS:          return 3;
+        case GuiMsgType::LIST_SELECT_ITEM:          return 4;
+        case GuiMsgType::SET_SOFT_BUTTONS:          return 5;
+        case GuiMsgType::SET_SOFT_BUTTONS_STATE:    return 6;
+        case GuiMsgType::PARAM_UPDATE_VALUE:        return 7;
+        case GuiMsgType::ENUM_PARAM_UPDATE_VALUE:   return 8;
+        case GuiMsgType::EDIT_NAME_SELECT_CHAR:     return 9;
+        case GuiMsgType::EDIT_NAME_CHANGE_CHAR:     return 10;
+        case GuiMsgType::SET_SYSTEM_COLOUR:         return 11;
+        default:                                    return -1;
+    }
+}
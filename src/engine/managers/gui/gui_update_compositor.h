@@ -0,0 +1,56 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_update_compositor.h
+ * @brief GUI Update Compositor class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _GUI_UPDATE_COMPOSITOR_H
+#define _GUI_UPDATE_COMPOSITOR_H
+
+#include <mutex>
+#include <array>
+#include <vector>
+#include <functional>
+#include "gui_msg.h"
+#include "common.h"
+
+// GUI update compositor constants
+constexpr uint GUI_NUM_STATE_SLOTS = 12;
+
+// GUI Update Compositor class
+// Collects the GUI state messages (status bars, shown param value, soft buttons, list
+// selection, edit name character) posted during a frame, and once per frame sends
+// only the state that has changed since it was last sent to the GUI - a state posted
+// more than once in a frame is only sent once, with its latest value
+// Screen messages are sent immediately, after any pending state, so the message order
+// is kept - as the GUI may redraw the state for a new screen, all state is sent again
+// after a screen message (except the list window items, which only add to the list
+// shown)
+class GuiUpdateCompositor
+{
+public:
+    // Constructor
+    GuiUpdateCompositor(std::function<void(const GuiMsg &)> send_fn);
+
+    // Public functions
+    void post(const GuiMsg &msg);
+    void process_frame();
+    void reset();
+
+private:
+    // Private variables
+    std::mutex _mutex;
+    std::function<void(const GuiMsg &)> _send_fn;
+    std::vector<GuiMsg> _pending;
+    std::array<GuiMsg, GUI_NUM_STATE_SLOTS> _sent;
+    std::array<bool, GUI_NUM_STATE_SLOTS> _sent_valid;
+
+    // Private functions
+    void _send_pending();
+    void _send_soft_buttons_state(const GuiMsg &msg);
+    int _state_slot(GuiMsgType type) const;
+};
+
+#endif // _GUI_UPDATE_COMPOSITOR_H
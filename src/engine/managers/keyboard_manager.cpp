@@ -120,7 +120,7 @@ void KeyboardManager::process_event(const BaseEvent *event)
 void KeyboardManager::_process_param_changed_event(const ParamChange &data)
 {
     // Get the param and make sure it exists
-    const Param *param = utils::get_param(data.path.c_str());
+    const Param *param = utils::get_param_from_handle(data.handle);
     if (param)
     {
         // Process the param value
@@ -10,12 +10,16 @@
 #include <unistd.h>
 #include <cstring>
 #include <cmath>
+#include <climits>
 #include <sys/ioctl.h>
 #include <termios.h>
 #include "daw_manager.h"
 #include "sequencer_manager.h"
 #include "arpeggiator_manager.h"
+#include "scheduled_note_queue.h"
 #include "utils.h"
+#include "logger.h"
+#include "trace_log.h"
 
 // Constants
 #define SERIAL_MIDI_AMA_PORT_NUM              "1"
@@ -32,24 +36,228 @@ constexpr uint MIDI_CHANPRESS_MAX_VALUE       = 127;
 constexpr auto MIDI_POLL_TIMEOUT_MS           = 200;
 constexpr int SERIAL_MIDI_ENCODING_BUF_SIZE   = 300;
 constexpr uint MIDI_DEVICE_POLL_SLEEP_US      = 1*1000*1000;
+constexpr uint MIDI_DEVICE_CONNECT_RETRY_MS   = 250;
+constexpr uint MIDI_DEVICE_CONNECT_MAX_RETRIES = 5;
 constexpr uint SYSTEM_CLIENT_ID               = 0;
 constexpr uint MIDI_THROUGH_CLIENT_ID         = 14;
 constexpr char SUSHI_CLIENT_NAME[]            = "Sushi";
 constexpr char GADGET_CLIENT_NAME[]           = "f_midi";
 constexpr uint NUM_MIDI_CLOCK_PULSES_PER_BEAT = 24;
 constexpr int MIDI_CC_ECHO_TIMEOUT            = 300;
+constexpr uint MIDI_CC_ECHO_RING_BUFFER_SIZE  = 1024;
 constexpr uint MPE_Y_PARAM_MIDI_CC_CHANNEL    = 74;
 constexpr uint MAX_DECODED_MIDI_EVENT_SIZE    = 12;
-constexpr uint MIDI_EVENT_QUEUE_POLL_SEC      = 0;
-constexpr uint MIDI_EVENT_QUEUE_POLL_NSEC     = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(20)).count();
 constexpr uint MIDI_EVENT_QUEUE_RESERVE_SIZE  = 200;
-constexpr uint MAX_TEMPO_DURATION             = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::milliseconds(60000/5)).count();
+constexpr uint MIDI_EVENT_QUEUE_MAX_SIZE      = 4096;
 
 // Static functions
 static void *_process_midi_devices(void* data);
 static void *_process_midi_event(void* data);
 static void *_process_midi_queue_event(void* data);
 
+//----------------------------------------------------------------------------
+// MidiCoalesceTable
+//----------------------------------------------------------------------------
+MidiCoalesceTable::MidiCoalesceTable()
+{
+    // Initialise the private data - all slots are initially invalid
+    std::memset(_slots, 0, sizeof(_slots));
+    _generation = 1;
+}
+
+//----------------------------------------------------------------------------
+// find
+//----------------------------------------------------------------------------
+bool MidiCoalesceTable::find(const snd_seq_event_t &event, uint &index) const
+{
+    // Is there a pending event for this pitchbend, chanpress or CC?
+    int slot_num = _slot_num(event);
+    if ((slot_num >= 0) && (_slots[slot_num].generation == _generation)) {
+        index = _slots[slot_num].index;
+        return true;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// add
+//----------------------------------------------------------------------------
+void MidiCoalesceTable::add(const snd_seq_event_t &event, uint index)
+{
+    // Set the pending event index, if this is a pitchbend, chanpress or CC event
+    int slot_num = _slot_num(event);
+    if (slot_num >= 0) {
+        _slots[slot_num].index = index;
+        _slots[slot_num].generation = _generation;
+    }
+}
+
+//----------------------------------------------------------------------------
+// clear
+//----------------------------------------------------------------------------
+void MidiCoalesceTable::clear()
+{
+    // Invalidate all slots by moving to the next generation - if the generation wraps,
+    // clear the slots so that no old slot is valid again
+    if (++_generation == 0) {
+        std::memset(_slots, 0, sizeof(_slots));
+        _generation = 1;
+    }
+}
+
+//----------------------------------------------------------------------------
+// _slot_num
+//----------------------------------------------------------------------------
+int MidiCoalesceTable::_slot_num(const snd_seq_event_t &event)
+{
+    // Check the channel is valid
+    uint channel = event.data.control.channel;
+    if (channel >= NUM_MIDI_COALESCE_CHANNELS) {
+        return -1;
+    }
+
+    // The CC slots for each channel are first, followed by the pitchbend and then
+    // chanpress slots
+    switch (event.type) {
+        case SND_SEQ_EVENT_CONTROLLER:
+            return (event.data.control.param < NUM_MIDI_COALESCE_CCS) ?
+                        ((channel * NUM_MIDI_COALESCE_CCS) + event.data.control.param) : -1;
+
+        case SND_SEQ_EVENT_PITCHBEND:
+            return (NUM_MIDI_COALESCE_CHANNELS * NUM_MIDI_COALESCE_CCS) + channel;
+
+        case SND_SEQ_EVENT_CHANPRESS:
+            return (NUM_MIDI_COALESCE_CHANNELS * (NUM_MIDI_COALESCE_CCS + 1)) + channel;
+
+        default:
+            return -1;
+    }
+}
+
+//----------------------------------------------------------------------------
+// MidiCcEchoFilter
+//----------------------------------------------------------------------------
+MidiCcEchoFilter::MidiCcEchoFilter()
+{
+    // Initialise the private data
+    _ring_buffer.resize(MIDI_CC_ECHO_RING_BUFFER_SIZE);
+    _tail = 0;
+    _count = 0;
+    _num_dropped = 0;
+    _dropping = false;
+    _num_sent.resize(NUM_MIDI_COALESCE_CHANNELS * NUM_MIDI_COALESCE_CCS * (MIDI_CC_MAX_VALUE + 1), 0);
+}
+
+//----------------------------------------------------------------------------
+// add
+//----------------------------------------------------------------------------
+void MidiCcEchoFilter::add(const snd_seq_event_t &event)
+{
+    // Check the message is valid
+    int index = _index(event);
+    if (index < 0) {
+        return;
+    }
+
+    // Get the echo filter mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Expire any old messages, and if the ring buffer is full drop the oldest
+    // message
+    auto now = std::chrono::steady_clock::now();
+    _expire(now);
+    if (_count == _ring_buffer.size()) {
+        _num_sent[_ring_buffer[_tail].index]--;
+        _tail = (_tail + 1) % _ring_buffer.size();
+        _count--;
+
+        // Log a warning for the first message dropped in this burst
+        if (!_dropping) {
+            NINA_LOG_WARNING(NinaModule::MIDI_DEVICE, "MIDI CC echo filter full, dropping the oldest sent CCs");
+            _dropping = true;
+        }
+        _num_dropped++;
+    }
+    else {
+        _dropping = false;
+    }
+
+    // Add the message at the head of the ring buffer
+    _ring_buffer[(_tail + _count) % _ring_buffer.size()] = { static_cast<uint>(index), now };
+    _num_sent[index]++;
+    _count++;
+}
+
+//----------------------------------------------------------------------------
+// is_echo
+//----------------------------------------------------------------------------
+bool MidiCcEchoFilter::is_echo(const snd_seq_event_t &event)
+{
+    // Check the message is valid
+    int index = _index(event);
+    if (index < 0) {
+        return false;
+    }
+
+    // Get the echo filter mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Expire any old messages, and check if this message has been sent within the
+    // echo timeout
+    _expire(std::chrono::steady_clock::now());
+    return _num_sent[index] > 0;
+}
+
+//----------------------------------------------------------------------------
+// num_dropped
+//----------------------------------------------------------------------------
+uint64_t MidiCcEchoFilter::num_dropped(bool reset)
+{
+    // Get the echo filter mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Return the number of messages dropped as the ring buffer was full
+    uint64_t num_dropped = _num_dropped;
+    if (reset) {
+        _num_dropped = 0;
+    }
+    return num_dropped;
+}
+
+//----------------------------------------------------------------------------
+// _expire
+// Note: The echo filter mutex must be held by the caller
+//----------------------------------------------------------------------------
+void MidiCcEchoFilter::_expire(std::chrono::steady_clock::time_point now)
+{
+    // Remove the messages older than the echo timeout - these are always at the tail
+    // of the ring buffer
+    auto expiry_time = now - std::chrono::milliseconds(MIDI_CC_ECHO_TIMEOUT);
+    while ((_count > 0) && (_ring_buffer[_tail].time < expiry_time)) {
+        _num_sent[_ring_buffer[_tail].index]--;
+        _tail = (_tail + 1) % _ring_buffer.size();
+        _count--;
+    }
+}
+
+//----------------------------------------------------------------------------
+// _index
+//----------------------------------------------------------------------------
+int MidiCcEchoFilter::_index(const snd_seq_event_t &event)
+{
+    // Check the channel, CC and value are valid
+    if ((event.data.control.channel >= NUM_MIDI_COALESCE_CHANNELS) ||
+        (event.data.control.param >= NUM_MIDI_COALESCE_CCS) ||
+        (event.data.control.value < static_cast<int>(MIDI_CC_MIN_VALUE)) ||
+        (event.data.control.value > static_cast<int>(MIDI_CC_MAX_VALUE))) {
+        return -1;
+    }
+
+    // Return the sent count index for the channel, CC and value
+    return (((event.data.control.channel * NUM_MIDI_COALESCE_CCS) + event.data.control.param) * (MIDI_CC_MAX_VALUE + 1)) +
+           event.data.control.value;
+}
+
 //----------------------------------------------------------------------------
 // IsMidiPitchBendParamPath
 //----------------------------------------------------------------------------
@@ -109,12 +317,15 @@ MidiDeviceManager::MidiDeviceManager(EventRouter *event_router) :
     _serial_midi_port_handle = 0;
     _midi_devices_thread = 0;
     _run_midi_devices_thread = true;    
+    _scan_client_info = nullptr;
+    _scan_port_info = nullptr;
+    _scan_subscribe_query = nullptr;
     _midi_event_thread = 0;
     _run_midi_event_thread = true;
     _midi_event_queue_thread = 0;
     _run_midi_event_queue_thread = true;
+    _midi_event_queue_min_interval = std::chrono::milliseconds(DEFAULT_MIDI_EVENT_QUEUE_MIN_INTERVAL_MS);
     std::memset(_bank_select_index, -1, sizeof(_bank_select_index));
-    _tempo_timer = new Timer(TimerType::PERIODIC);
     _midi_clock_count = 0;
     _tempo_param = 0;
     _midi_clk_in_param = 0;
@@ -124,11 +335,47 @@ MidiDeviceManager::MidiDeviceManager(EventRouter *event_router) :
     _mpe_z_param = nullptr;
     _pitch_bend_param = nullptr;
     _chanpress_param = nullptr;
+    std::memset(_cc_params, 0, sizeof(_cc_params));
+    std::memset(_channel_layers_mask, 0, sizeof(_channel_layers_mask));
+    std::memset(_channel_mpe, 0, sizeof(_channel_mpe));
+    _cc_params_generation = 0;
+    _channel_tables_generation = 0;
+    _channel_tables_mpe_zones = std::pair<uint, uint>(0, 0);
     _midi_event_queue_a.reserve(MIDI_EVENT_QUEUE_RESERVE_SIZE);
     _midi_event_queue_b.reserve(MIDI_EVENT_QUEUE_RESERVE_SIZE);
     _push_midi_event_queue = &_midi_event_queue_a;
     _pop_midi_event_queue = &_midi_event_queue_b;
-    _start_time = std::chrono::high_resolution_clock::now();
+}
+
+//----------------------------------------------------------------------------
+// midi_event_queue_stats
+//----------------------------------------------------------------------------
+const MidiEventQueueStats& MidiDeviceManager::midi_event_queue_stats() const
+{
+    return _midi_event_queue_stats;
+}
+
+//----------------------------------------------------------------------------
+// log_event_stats
+//----------------------------------------------------------------------------
+void MidiDeviceManager::log_event_stats(bool reset)
+{
+    // Log the manager event stats
+    BaseManager::log_event_stats(reset);
+
+    // Log the MIDI event queue stats
+    NINA_LOG_INFO(module(), "MIDI event queue: {} queued, {} merged, {} dropped",
+                  _midi_event_queue_stats.num_queued.load(), _midi_event_queue_stats.num_merged.load(),
+                  _midi_event_queue_stats.num_dropped.load());
+    if (reset)
+    {
+        _midi_event_queue_stats.num_queued.store(0);
+        _midi_event_queue_stats.num_merged.store(0);
+        _midi_event_queue_stats.num_dropped.store(0);
+    }
+
+    // Log the MIDI CC echo filter stats
+    NINA_LOG_INFO(module(), "MIDI CC echo filter: {} dropped", _cc_echo_filter.num_dropped(reset));
 }
 
 //----------------------------------------------------------------------------
@@ -136,12 +383,8 @@ MidiDeviceManager::MidiDeviceManager(EventRouter *event_router) :
 //----------------------------------------------------------------------------
 MidiDeviceManager::~MidiDeviceManager()
 {
-    // Stop the tempo timer task
-    if (_tempo_timer) {
-        _tempo_timer->stop();
-        delete _tempo_timer;
-        _tempo_timer = 0;
-    }
+    // Stop the clock engine
+    _clock_engine.stop();
     
     // Delete the listeners
     if (_sfc_listener)
@@ -187,7 +430,9 @@ bool MidiDeviceManager::start()
 	//param.sched_priority = sched_get_priority_min(SCHED_FIFO);
 	//::pthread_setschedparam(_midi_event_thread->native_handle(), SCHED_FIFO, &param);
 
-    // Create a normal thread to listen for MIDI queue events
+    // Create a normal thread to listen for MIDI queue events, which are processed as
+    // soon as they are queued, but no more often than the minimum batching interval
+    _midi_event_queue_min_interval = std::chrono::milliseconds(utils::system_config()->get_midi_event_queue_min_interval());
     _midi_event_queue_thread = new std::thread(_process_midi_queue_event, this);
 
     // Get the various params used in MIDI processing
@@ -201,8 +446,18 @@ bool MidiDeviceManager::start()
     _pitch_bend_param = utils::get_param(Param::ParamPath(this, PITCH_BEND_PARAM_NAME).c_str());
     _chanpress_param = utils::get_param(Param::ParamPath(this, CHANPRESS_PARAM_NAME).c_str());
 
-    // Start the Tempo timer thread
-    _tempo_timer->start((US_PER_MINUTE / (_tempo_param->get_value() * NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT)), std::bind(&MidiDeviceManager::_tempo_timer_callback, this));
+    // Build the MIDI input tables, so that incoming events can be routed without any
+    // param searching
+    {
+        std::lock_guard<std::mutex> lock(_midi_input_tables_mutex);
+        _build_cc_params_table();
+        _build_channel_tables();
+    }
+
+    // Start the clock engine
+    _clock_engine.set_tempo(_tempo_param->get_value());
+    _clock_engine.start(std::bind(&MidiDeviceManager::_clock_tick_callback, this),
+                        std::bind(&MidiDeviceManager::_is_external_clock_sync, this));
 
     // Call the base manager
     return BaseManager::start();		
@@ -230,7 +485,11 @@ void MidiDeviceManager::stop()
     if (_midi_event_queue_thread != 0)
     {
         // Stop the MIDI queue event task
-        _run_midi_event_queue_thread = false;
+        {
+            std::lock_guard<std::mutex> lock(_midi_event_queue_mutex);
+            _run_midi_event_queue_thread = false;
+        }
+        _midi_event_queue_cv.notify_one();
 		if (_midi_event_queue_thread->joinable())
 			_midi_event_queue_thread->join(); 
         _midi_event_queue_thread = 0;       
@@ -299,8 +558,8 @@ void MidiDeviceManager::process_event(const BaseEvent * event)
 //----------------------------------------------------------------------------
 void MidiDeviceManager::_process_reload_presets()
 {
-    // Update the tempo timer
-    _tempo_timer->change_interval((US_PER_MINUTE / (_tempo_param->get_value() * NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT))); 
+    // Update the clock engine tempo
+    _clock_engine.set_tempo(_tempo_param->get_value());
 }
 
 //----------------------------------------------------------------------------
@@ -309,7 +568,7 @@ void MidiDeviceManager::_process_reload_presets()
 void MidiDeviceManager::_process_param_changed_event(const ParamChange &param_change)
 {
     // If this is a MIDI param change
-    Param *param = utils::get_param(param_change.path.c_str());
+    Param *param = utils::get_param_from_handle(param_change.handle);
     if (param && (param->module == NinaModule::MIDI_DEVICE))
     {
         // Process the MIDI param change
@@ -317,8 +576,8 @@ void MidiDeviceManager::_process_param_changed_event(const ParamChange &param_ch
     }
     // If this is a tempo BPM param change
     else if(param == _tempo_param) {
-        // Update the tempo timer
-        _tempo_timer->change_interval((US_PER_MINUTE / (_tempo_param->get_value() * NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT)));            
+        // Update the clock engine tempo
+        _clock_engine.set_tempo(_tempo_param->get_value());
     }    
 }
 
@@ -357,10 +616,8 @@ void MidiDeviceManager::_process_midi_param_changed(Param *param)
             // If the MIDI echo filter is on, then we log the msg
             if (_get_midi_echo_filter() == MidiEchoFilter::ECHO_FILTER)
             { 
-                // Log the MIDI CC message and elapsed time
-                auto end = std::chrono::high_resolution_clock::now();
-                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - _start_time);
-                _cc_prev_messages.push_back({ev, elapsed.count()});
+                // Log the MIDI CC message and time sent
+                _cc_echo_filter.add(ev);
             }
 
             // Send the event to all subscribers of this port
@@ -395,143 +652,252 @@ void MidiDeviceManager::_process_midi_param_changed(Param *param)
 //----------------------------------------------------------------------------
 void MidiDeviceManager::process_midi_devices()
 {
-    snd_seq_client_info_t *cinfo;
-    snd_seq_port_info_t *pinfo;
+    snd_seq_t *announce_seq_handle = nullptr;
+    int announce_npfd = 0;
+    std::unique_ptr<pollfd[]> announce_pfd;
+    uint connect_retries = 0;
+    std::chrono::steady_clock::time_point connect_retry_time;
+
+    // Allocate the client/port info and subscription query structures, used for every
+    // scan of the MIDI devices
+    snd_seq_client_info_malloc(&_scan_client_info);
+    snd_seq_port_info_malloc(&_scan_port_info);
+    snd_seq_query_subscribe_malloc(&_scan_subscribe_query);
+
+    // Open a sequencer client subscribed to the System Announce port, so that the MIDI
+    // devices are only scanned when a client or port changes
+    if (_open_announce_seq(&announce_seq_handle))
+    {
+        // Get the announce sequencer poll descriptors
+        announce_npfd = snd_seq_poll_descriptors_count(announce_seq_handle, POLLIN);
+        announce_pfd = std::make_unique<pollfd[]>(announce_npfd);
+        snd_seq_poll_descriptors(announce_seq_handle, announce_pfd.get(), announce_npfd, POLLIN);
+    }
+    else
+    {
+        // Could not subscribe to announcements, fall back to scanning periodically
+        DEBUG_BASEMGR_MSG("Subscribe to ALSA System Announce failed, polling MIDI devices");
+    }
+
+    // Do an initial scan for all MIDI devices
+    bool connect_failed = !_scan_midi_devices();
 
     // Do forever (until the thread is exited)
     while (_run_midi_devices_thread)
     {
-        // Allocate and set the client/port info structures
-        snd_seq_client_info_malloc(&cinfo);
-        snd_seq_port_info_malloc(&pinfo);
-        snd_seq_client_info_set_client(cinfo, -1);
-
-        // Query and process all clients
-        while (snd_seq_query_next_client(_seq_handle, cinfo) >= 0) 
+        // Are announcements being received?
+        if (announce_seq_handle)
         {
-            uint client_id = snd_seq_client_info_get_client(cinfo);
-
-            // Always ignore the System, MIDI Through, Sushi and Nina clients
-            if ((client_id != SYSTEM_CLIENT_ID) && (client_id != MIDI_THROUGH_CLIENT_ID) &&
-                (client_id != (uint)_seq_client) && 
-                (std::strcmp(snd_seq_client_info_get_name(cinfo), SUSHI_CLIENT_NAME) != 0))
+            // If a connection failed in the last scan, retry the scan with a backoff (up
+            // to a maximum number of retries) - otherwise it is not retried until the next
+            // announcement
+            if (connect_failed)
             {
-                // Got a client, query all ports
-                snd_seq_port_info_set_client(pinfo, snd_seq_client_info_get_client(cinfo));
-                snd_seq_port_info_set_port(pinfo, -1);                
-                while (snd_seq_query_next_port(_seq_handle, pinfo) >= 0)
+                auto now = std::chrono::steady_clock::now();
+                if (connect_retries == 0)
+                {
+                    connect_retry_time = now + std::chrono::milliseconds(MIDI_DEVICE_CONNECT_RETRY_MS);
+                    connect_retries++;
+                }
+                else if (now >= connect_retry_time)
                 {
-                    snd_seq_addr_t src_addr;
-                    snd_seq_addr_t dst_addr;
-
-                    // Set the source and destination address
-                    src_addr.client = snd_seq_client_info_get_client(cinfo);
-                    src_addr.port = snd_seq_port_info_get_port(pinfo);                        
-                    dst_addr.client = _seq_client;
-                    dst_addr.port = _seq_port;                    
-                
-                    // Can this port support a write subscription?
-                    uint seq_port_cap = snd_seq_port_info_get_capability(pinfo);
-                    if (seq_port_cap & SND_SEQ_PORT_CAP_SUBS_WRITE)
+                    connect_failed = !_scan_midi_devices();
+                    if (connect_failed && (connect_retries < MIDI_DEVICE_CONNECT_MAX_RETRIES))
+                    {
+                        connect_retry_time = now + std::chrono::milliseconds(MIDI_DEVICE_CONNECT_RETRY_MS << connect_retries);
+                        connect_retries++;
+                    }
+                    else
                     {
-                        // We can and should be subscribed to this client
-                        // Firstly check if we are already subscribed
-                        bool subscribed = false;
-                        snd_seq_query_subscribe_t *query;
-
-                        // Setup the query
-                        snd_seq_query_subscribe_malloc(&query);
-                        snd_seq_query_subscribe_set_root(query, &dst_addr);
-                        snd_seq_query_subscribe_set_type(query, SND_SEQ_QUERY_SUBS_WRITE);
-                        snd_seq_query_subscribe_set_index(query, 0);
-
-                        // Go through all subscribers
-                        while (snd_seq_query_port_subscribers(_seq_handle, query) >= 0)
+                        // Connected, or the retries have been exhausted
+                        if (connect_failed)
                         {
-                            // Check if we are already subscribed
-                            auto addr = snd_seq_query_subscribe_get_addr(query);
-                            if ((addr->client == src_addr.client) && (addr->port == src_addr.port))
-                            {
-                                // Already subscribed
-                                subscribed = true;
-                                break;
-                            }
-                            snd_seq_query_subscribe_set_index(query, snd_seq_query_subscribe_get_index(query) + 1);
+                            DEBUG_BASEMGR_MSG("Connect to MIDI device failed, retries exhausted");
                         }
-                        snd_seq_query_subscribe_free(query);
-
-                        // Do we need to subscribe to this port?
-                        if (!subscribed)
-                        {
-                            // Connect FROM this port
-                            if (snd_seq_connect_from(_seq_handle, _seq_port, src_addr.client, src_addr.port) == 0)
-                            {
-                                // Successful connection
-                                MSG("Connected from MIDI device: " << snd_seq_client_info_get_name(cinfo));
-                            }
-                            else
-                            {
-                                // Connection failed
-                                //MSG("Connection from MIDI device FAILED: " << snd_seq_client_info_get_client(cinfo));
-                            }
-                        }                    
+                        connect_failed = false;
+                        connect_retries = 0;
                     }
+                }
+            }
+
+            // Wait for an announcement, or a timeout so that the thread exit can be checked
+            if (poll(announce_pfd.get(), announce_npfd, MIDI_POLL_TIMEOUT_MS) > 0)
+            {
+                snd_seq_event_t *ev = nullptr;
+                bool rescan = false;
 
-                    // Can this port support a read subscription AND is this the gadget port?
-                    if ((seq_port_cap & SND_SEQ_PORT_CAP_SUBS_READ) &&
-                        (std::strcmp(snd_seq_client_info_get_name(cinfo), GADGET_CLIENT_NAME) == 0))
+                // Process all announcements - rescan if any client or port has started or changed,
+                // or a subscription has been removed (so that it can be re-subscribed)
+                while (snd_seq_event_input(announce_seq_handle, &ev) > 0)
+                {
+                    switch (ev->type)
                     {
-                        // We can and should be subscribed to this client
-                        // Firstly check if we are already subscribed
-                        bool subscribed = false;
-                        snd_seq_query_subscribe_t *query;
-
-                        // Setup the query
-                        snd_seq_query_subscribe_malloc(&query);
-                        snd_seq_query_subscribe_set_root(query, &dst_addr);
-                        snd_seq_query_subscribe_set_type(query, SND_SEQ_QUERY_SUBS_READ);
-                        snd_seq_query_subscribe_set_index(query, 0);
-
-                        // Go through all subscribers
-                        while (snd_seq_query_port_subscribers(_seq_handle, query) >= 0)
-                        {
-                            // Check if we are already subscribed
-                            auto addr = snd_seq_query_subscribe_get_addr(query);
-                            if ((addr->client == src_addr.client) && (addr->port == src_addr.port))
-                            {
-                                // Already subscribed
-                                subscribed = true;
-                                break;
-                            }
-                            snd_seq_query_subscribe_set_index(query, snd_seq_query_subscribe_get_index(query) + 1);
-                        }
-                        snd_seq_query_subscribe_free(query);
+                        case SND_SEQ_EVENT_CLIENT_START:
+                        case SND_SEQ_EVENT_CLIENT_CHANGE:
+                        case SND_SEQ_EVENT_PORT_START:
+                        case SND_SEQ_EVENT_PORT_CHANGE:
+                        case SND_SEQ_EVENT_PORT_UNSUBSCRIBED:
+                            rescan = true;
+                            break;
+
+                        default:
+                            break;
+                    }
+                }
 
-                        // Do we need to subscribe to this port?
-                        if (!subscribed)
-                        {
-                            // Connect TO this port
-                            if (snd_seq_connect_to(_seq_handle, _seq_port, src_addr.client, src_addr.port) == 0)
-                            {
-                                // Successful connection
-                                MSG("Connected to MIDI device: " << snd_seq_client_info_get_name(cinfo));
-                            }
-                            else
-                            {
-                                // Connection failed
-                                //MSG("Connection to MIDI device FAILED: " << snd_seq_client_info_get_client(cinfo));
-                            }
-                        }                    
-                    }                    
+                // Rescan the MIDI devices if needed
+                // Note: Any connect retries are restarted from this scan
+                if (rescan)
+                {
+                    connect_failed = !_scan_midi_devices();
+                    connect_retries = 0;
+                }
+            }
+        }
+        else
+        {
+            // Sleep before checking all connections again
+            usleep(MIDI_DEVICE_POLL_SLEEP_US);
+            _scan_midi_devices();
+        }
+    }
+
+    // Close the announce sequencer client, and free the scan structures
+    if (announce_seq_handle)
+    {
+        snd_seq_close(announce_seq_handle);
+    }
+    snd_seq_client_info_free(_scan_client_info);
+    snd_seq_port_info_free(_scan_port_info);
+    snd_seq_query_subscribe_free(_scan_subscribe_query);
+    _scan_client_info = nullptr;
+    _scan_port_info = nullptr;
+    _scan_subscribe_query = nullptr;
+}
+
+//----------------------------------------------------------------------------
+// _open_announce_seq
+//----------------------------------------------------------------------------
+bool MidiDeviceManager::_open_announce_seq(snd_seq_t **seq_handle)
+{
+    // Open an ALSA Sequencer client for the announcements
+    if (snd_seq_open(seq_handle, "hw", SND_SEQ_OPEN_INPUT, SND_SEQ_NONBLOCK) < 0)
+    {
+        *seq_handle = nullptr;
+        return false;
+    }
+    snd_seq_set_client_name(*seq_handle, "Nina_App_Announce:");
+
+    // Create a private port, and subscribe it to the System Announce port
+    int port = snd_seq_create_simple_port(*seq_handle, "Nina_App_Announce:",
+                                          (SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_NO_EXPORT),
+                                          SND_SEQ_PORT_TYPE_APPLICATION);
+    if ((port < 0) || (snd_seq_connect_from(*seq_handle, port, SND_SEQ_CLIENT_SYSTEM, SND_SEQ_PORT_SYSTEM_ANNOUNCE) < 0))
+    {
+        snd_seq_close(*seq_handle);
+        *seq_handle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _scan_midi_devices
+//----------------------------------------------------------------------------
+bool MidiDeviceManager::_scan_midi_devices()
+{
+    bool ret = true;
+
+    // Query and process all clients
+    snd_seq_client_info_set_client(_scan_client_info, -1);
+    while (snd_seq_query_next_client(_seq_handle, _scan_client_info) >= 0) 
+    {
+        uint client_id = snd_seq_client_info_get_client(_scan_client_info);
+        const char *client_name = snd_seq_client_info_get_name(_scan_client_info);
+
+        // Always ignore the System, MIDI Through, Sushi and Nina clients
+        if ((client_id != SYSTEM_CLIENT_ID) && (client_id != MIDI_THROUGH_CLIENT_ID) &&
+            (client_id != (uint)_seq_client) && 
+            (std::strcmp(client_name, SUSHI_CLIENT_NAME) != 0))
+        {
+            // Got a client, query all ports
+            snd_seq_port_info_set_client(_scan_port_info, client_id);
+            snd_seq_port_info_set_port(_scan_port_info, -1);                
+            while (snd_seq_query_next_port(_seq_handle, _scan_port_info) >= 0)
+            {
+                snd_seq_addr_t src_addr;
+                snd_seq_addr_t dst_addr;
+
+                // Set the source and destination address
+                src_addr.client = client_id;
+                src_addr.port = snd_seq_port_info_get_port(_scan_port_info);                        
+                dst_addr.client = _seq_client;
+                dst_addr.port = _seq_port;                    
+            
+                // Can this port support a write subscription?
+                // If so, we should be subscribed to this client - do we need to subscribe to this port?
+                uint seq_port_cap = snd_seq_port_info_get_capability(_scan_port_info);
+                if ((seq_port_cap & SND_SEQ_PORT_CAP_SUBS_WRITE) && !_is_subscribed(dst_addr, src_addr, SND_SEQ_QUERY_SUBS_WRITE))
+                {
+                    // Connect FROM this port
+                    if (snd_seq_connect_from(_seq_handle, _seq_port, src_addr.client, src_addr.port) == 0)
+                    {
+                        // Successful connection
+                        MSG("Connected from MIDI device: " << client_name);
+                    }
+                    else
+                    {
+                        // The connection failed, it should be retried
+                        ret = false;
+                    }
                 }
+
+                // Can this port support a read subscription AND is this the gadget port?
+                // If so, we should be subscribed to this client - do we need to subscribe to this port?
+                if ((seq_port_cap & SND_SEQ_PORT_CAP_SUBS_READ) &&
+                    (std::strcmp(client_name, GADGET_CLIENT_NAME) == 0) &&
+                    !_is_subscribed(dst_addr, src_addr, SND_SEQ_QUERY_SUBS_READ))
+                {
+                    // Connect TO this port
+                    if (snd_seq_connect_to(_seq_handle, _seq_port, src_addr.client, src_addr.port) == 0)
+                    {
+                        // Successful connection
+                        MSG("Connected to MIDI device: " << client_name);
+                    }
+                    else
+                    {
+                        // The connection failed, it should be retried
+                        ret = false;
+                    }
+                }                    
             }
         }
-        snd_seq_client_info_free(cinfo);
-        snd_seq_port_info_free(pinfo);
+    }
+    return ret;
+}
+
+//----------------------------------------------------------------------------
+// _is_subscribed
+//----------------------------------------------------------------------------
+bool MidiDeviceManager::_is_subscribed(const snd_seq_addr_t &root_addr, const snd_seq_addr_t &addr, snd_seq_query_subs_type_t type)
+{
+    // Setup the query
+    snd_seq_query_subscribe_set_root(_scan_subscribe_query, &root_addr);
+    snd_seq_query_subscribe_set_type(_scan_subscribe_query, type);
+    snd_seq_query_subscribe_set_index(_scan_subscribe_query, 0);
 
-        // Sleep before checking all connections again
-        usleep(MIDI_DEVICE_POLL_SLEEP_US);
+    // Go through all subscribers, and check if we are already subscribed
+    while (snd_seq_query_port_subscribers(_seq_handle, _scan_subscribe_query) >= 0)
+    {
+        auto subs_addr = snd_seq_query_subscribe_get_addr(_scan_subscribe_query);
+        if ((subs_addr->client == addr.client) && (subs_addr->port == addr.port))
+        {
+            // Already subscribed
+            return true;
+        }
+        snd_seq_query_subscribe_set_index(_scan_subscribe_query, snd_seq_query_subscribe_get_index(_scan_subscribe_query) + 1);
     }
+    return false;
 }
 
 //----------------------------------------------------------------------------
@@ -544,6 +910,7 @@ void MidiDeviceManager::process_midi_event()
     int npfd = 0;
     std::vector<snd_seq_event_t> seq_midi_events;
     std::vector<snd_seq_event_t> serial_midi_events;
+    MidiCoalesceTable serial_coalesce_table;
     seq_midi_events.reserve(MIDI_EVENT_QUEUE_RESERVE_SIZE);
     serial_midi_events.reserve(MIDI_EVENT_QUEUE_RESERVE_SIZE);
 
@@ -596,8 +963,6 @@ void MidiDeviceManager::process_midi_event()
                 // Process all sequencer MIDI events (if any)
                 while (snd_seq_event_input(_seq_handle, &ev) > 0)
                 {
-                    bool push_msg = true;
-
                     // Is this a high priority MIDI event?
                     // We process these immediately, and not via the MIDI event queue
                     if (_is_high_priority_midi_event(ev->type)) {
@@ -609,43 +974,21 @@ void MidiDeviceManager::process_midi_event()
                     }
                     else {
                         // Process the MIDI event via the MIDI queue
-                        // Get the MIDI event queue mutex
-                        std::lock_guard<std::mutex> lock(_midi_event_queue_mutex);
-
-                        // Make sure the MIDI events are optimised - that is, if an event for this MIDI event already
-                        // exists, overwrite it rather than adding it to the queue
-                        // Do this only for pitchbend, chanpress and CC events
-                        for (auto itr=_push_midi_event_queue->rbegin(); itr != _push_midi_event_queue->rend(); ++itr) {
-                            auto oev = *itr;
-                            if (ev->type == SND_SEQ_EVENT_PITCHBEND && oev.type == SND_SEQ_EVENT_PITCHBEND &&
-                                ev->data.control.channel == oev.data.control.channel) {
-                                // Overwrite this event
-                                *itr = *ev;
-                                push_msg = false;
-                                break; 
-                            }
-                            if (ev->type == SND_SEQ_EVENT_CHANPRESS && oev.type == SND_SEQ_EVENT_CHANPRESS &&
-                                ev->data.control.channel == oev.data.control.channel) {
-                                // Overwrite this event
-                                *itr = *ev;
-                                push_msg = false;
-                                break; 
-                            }
-                            if (ev->type == SND_SEQ_EVENT_CONTROLLER && oev.type == SND_SEQ_EVENT_CONTROLLER &&
-                                ev->data.control.param == oev.data.control.param &&
-                                ev->data.control.channel == oev.data.control.channel) {
-                                // Overwrite this event
-                                *itr = *ev;
-                                push_msg = false;
-                                break; 
-                            }                                                 
-                        }
-                        if (push_msg) {
-                            // Push the event to the MIDI event queue
-                            _push_midi_event_queue->push_back(*ev);
+                        bool queued;
+                        {
+                            // Get the MIDI event queue mutex
+                            std::lock_guard<std::mutex> lock(_midi_event_queue_mutex);
 
+                            // Queue the event - if an event for this pitchbend, chanpress or CC is already
+                            // pending, it is overwritten rather than adding it to the queue
+                            queued = _queue_midi_event(*_push_midi_event_queue, _midi_event_queue_coalesce_table, *ev, MIDI_EVENT_QUEUE_MAX_SIZE);
+                        }
+                        if (queued) {
                             // Push the event to the  seq events queue (used by this function only)
                             seq_midi_events.push_back(*ev);
+
+                            // Signal the MIDI event queue thread
+                            _midi_event_queue_cv.notify_one();
                         }
                     }
                 }
@@ -679,39 +1022,11 @@ void MidiDeviceManager::process_midi_event()
                             // process the message, which will be processed on the next poll
                             if (ev.type != SND_SEQ_EVENT_NONE)
                             {
-                                bool push_msg = true;
-
-                                // Make sure the MIDI events are optimised - that is, if an event for this MIDI event already
-                                // exists, overwrite it rather than adding it to the queue
-                                // Do this only for pitchbend, chanpress and CC events
-                                for (auto itr=serial_midi_events.rbegin(); itr != serial_midi_events.rend(); ++itr) {
-                                    auto oev = *itr;
-                                    if (ev.type == SND_SEQ_EVENT_PITCHBEND && oev.type == SND_SEQ_EVENT_PITCHBEND &&
-                                        ev.data.control.channel == oev.data.control.channel) {
-                                        // Overwrite this event
-                                        *itr = ev;
-                                        push_msg = false;
-                                        break; 
-                                    }
-                                    if (ev.type == SND_SEQ_EVENT_CHANPRESS && oev.type == SND_SEQ_EVENT_CHANPRESS &&
-                                        ev.data.control.channel == oev.data.control.channel) {
-                                        // Overwrite this event
-                                        *itr = ev;
-                                        push_msg = false;
-                                        break; 
-                                    }
-                                    if (ev.type == SND_SEQ_EVENT_CONTROLLER && oev.type == SND_SEQ_EVENT_CONTROLLER &&
-                                        ev.data.control.param == oev.data.control.param &&
-                                        ev.data.control.channel == oev.data.control.channel) {
-                                        // Overwrite this event
-                                        *itr = ev;
-                                        push_msg = false;
-                                        break; 
-                                    }                                                 
-                                }
-                                if (push_msg) {
-                                    serial_midi_events.push_back(ev);
-                                }
+                                // Queue the event - if an event for this pitchbend, chanpress or CC is already
+                                // pending, it is overwritten rather than adding it to the queue
+                                // Note: The serial events are rate-limited by the serial port, so are never
+                                // dropped
+                                _queue_midi_event(serial_midi_events, serial_coalesce_table, ev, UINT_MAX);
                             }
 
                             // If a buffer underflow occurs (should never happen)
@@ -775,6 +1090,7 @@ void MidiDeviceManager::process_midi_event()
                     // Make sure the all MIDI events are cleared for the next poll
                     seq_midi_events.clear();
                     serial_midi_events.clear();
+                    serial_coalesce_table.clear();
                 }
             }
         }
@@ -791,21 +1107,30 @@ void MidiDeviceManager::process_midi_event()
 //----------------------------------------------------------------------------
 void MidiDeviceManager::process_midi_event_queue()
 {
-    struct timespec poll_time;
-
-    // Set the thread poll time (in nano-seconds)
-    std::memset(&poll_time, 0, sizeof(poll_time));
-    poll_time.tv_sec = MIDI_EVENT_QUEUE_POLL_SEC;
-    poll_time.tv_nsec = MIDI_EVENT_QUEUE_POLL_NSEC;
+    auto last_process_time = std::chrono::steady_clock::now() - _midi_event_queue_min_interval;
 
     // Do forever (until the thread is exited)
-    while (_run_midi_event_queue_thread) {
-        // Sleep for the poll time
-        ::nanosleep(&poll_time, NULL);
-
-        // Swap the push/pop event queues
+    while (true) {
         {
-            std::lock_guard<std::mutex> lock(_midi_event_queue_mutex);
+            // Get the MIDI event queue mutex
+            std::unique_lock<std::mutex> lock(_midi_event_queue_mutex);
+
+            // Wait for a MIDI event to be queued
+            _midi_event_queue_cv.wait(lock, [this]() { return !_run_midi_event_queue_thread || !_push_midi_event_queue->empty(); });
+            if (!_run_midi_event_queue_thread) {
+                break;
+            }
+
+            // For flood control, wait until the minimum batching interval since the last events
+            // were processed - any events queued meanwhile are added to (or merged into) this batch
+            // Note: The mutex is released while waiting
+            _midi_event_queue_cv.wait_until(lock, last_process_time + _midi_event_queue_min_interval,
+                                            [this]() { return !_run_midi_event_queue_thread; });
+            if (!_run_midi_event_queue_thread) {
+                break;
+            }
+
+            // Swap the push/pop event queues
             if (_pop_midi_event_queue == &_midi_event_queue_a) {
                 _push_midi_event_queue = &_midi_event_queue_a;
                 _pop_midi_event_queue = &_midi_event_queue_b;
@@ -814,7 +1139,9 @@ void MidiDeviceManager::process_midi_event_queue()
                 _push_midi_event_queue = &_midi_event_queue_b;
                 _pop_midi_event_queue = &_midi_event_queue_a;                
             }
+            _midi_event_queue_coalesce_table.clear();
         }
+        last_process_time = std::chrono::steady_clock::now();
 
         // Process each normal MIDI event in the pop queue, and then clear the queue
         for (auto itr=_pop_midi_event_queue->begin(); itr != _pop_midi_event_queue->end(); ++itr) {
@@ -842,10 +1169,9 @@ void MidiDeviceManager::_process_high_priority_midi_event(const snd_seq_event_t
         case SND_SEQ_EVENT_START: {
             // Only process if the MIDI Clock In is enabled (non-zero param value)
             if (_midi_clk_in_param->get_value()) {            
-                // Save the MIDI start time
+                // Reset the MIDI clock, the next clock pulse re-aligns the clock engine
                 _midi_clock_count = 0;
-                _tempo_filter_state = 0;
-                _midi_clock_start = std::chrono::high_resolution_clock::now();
+                _clock_engine.external_clock_start();
 
                 // Start running the sequencer
                 _start_stop_seq_run(true);
@@ -858,7 +1184,7 @@ void MidiDeviceManager::_process_high_priority_midi_event(const snd_seq_event_t
             if (_midi_clk_in_param->get_value()) {            
                 // Reset the MIDI clock
                 _midi_clock_count = 0;
-                _tempo_filter_state = 0;
+                _clock_engine.external_clock_start();
 
                 // Stop running the sequencer
                 _start_stop_seq_run(false);
@@ -869,49 +1195,36 @@ void MidiDeviceManager::_process_high_priority_midi_event(const snd_seq_event_t
         case SND_SEQ_EVENT_CLOCK: {
             // Only process if the MIDI Clock In is enabled (non-zero param value)
             if (_midi_clk_in_param->get_value()) {
-                // Signal the sequencer and arpeggiator
-                utils::seq_signal();
-                utils::arp_signal();
+                // Update the clock engine PLL - the clock engine generates the sequencer and
+                // arpeggiator ticks from the PLL
+                _clock_engine.external_clock_tick();
 
-                // We need to also calculate the tempo and update the tempo param
+                // We need to also update the tempo param from the tempo followed by the PLL
                 // Wait for 24 pulses = 1 beat, normally a quarter note
-                // Waiting reduces the CPU load and helps with calculation stability                
+                // Waiting reduces the CPU load, and the PLL smooths the tempo
                 _midi_clock_count++;
                 if (_midi_clock_count == NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT) {
-                    // Get the time duration in uS
-                    auto end = std::chrono::high_resolution_clock::now();
-                    float duration = std::chrono::duration_cast<std::chrono::microseconds>(end -  _midi_clock_start).count();
-
-                    // Only process durations that are vaguely sensible
-                    if (duration < MAX_TEMPO_DURATION) {
-                        // Filter the duration to try and smooth out the value
-                        (_tempo_filter_state == 0) ?
-                            _tempo_filter_state = duration :
-                            _tempo_filter_state += (duration - _tempo_filter_state) * 0.2;
-
-                        // Calculate the tempo
-                        float tempo = (60000.f / (duration / 1000.f));
-                        tempo = std::roundf(tempo);
-
-                        // If the tempo has changed
-                        if (_tempo_param && (_tempo_param->get_value() != tempo)) {
-                            // Set the new tempo and update the tempo timer
-                            _tempo_param->set_value(tempo);
-                            _tempo_timer->change_interval((US_PER_MINUTE / (tempo * NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT)));                             
-                            
-                            // Send a param change
-                            auto param_change = ParamChange(_tempo_param, module());
-                            param_change.display = false;
-                            _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
-
-                            // We need to recurse each mapped param and process it
-                            _process_param_changed_mapped_params(LayerInfo::GetLayerMaskBit(0), 
-                                                                 _tempo_param, _tempo_param->get_normalised_value(), _tempo_param, true);
-                        }
+                    // Get the tempo
+                    float tempo = std::roundf(_clock_engine.external_tempo());
+
+                    // If the tempo has changed
+                    if (_tempo_param && (tempo > 0) && (_tempo_param->get_value() != tempo)) {
+                        // Set the new tempo, and update the clock engine tempo used if the
+                        // external clock is lost
+                        _tempo_param->set_value(tempo);
+                        _clock_engine.set_tempo(tempo);
+
+                        // Send a param change
+                        auto param_change = ParamChange(_tempo_param, module());
+                        param_change.display = false;
+                        _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
+
+                        // We need to recurse each mapped param and process it
+                        _process_param_changed_mapped_params(LayerInfo::GetLayerMaskBit(0), 
+                                                             _tempo_param, _tempo_param->get_normalised_value());
                     }
 
                     // Reset the MIDI clock count
-                    _midi_clock_start = end;
                     _midi_clock_count = 0;
                 }
             }
@@ -929,6 +1242,9 @@ void MidiDeviceManager::_process_normal_midi_event(const snd_seq_event_t *seq_ev
     switch (seq_event->type) {        
         case SND_SEQ_EVENT_CONTROLLER:
         {
+            // Get the route for this event
+            auto route = _get_midi_input_route(*seq_event);
+
             // If this is controller number 0
             if (seq_event->data.control.param == 0)
             {
@@ -938,7 +1254,7 @@ void MidiDeviceManager::_process_normal_midi_event(const snd_seq_event_t *seq_ev
                     // Process each Layer with a matching MIDI channel filter
                     for (uint i=0; i<NUM_LAYERS; i++) {
                         // If the MIDI channel filter matches
-                        if (utils::get_layer_info(i).check_midi_channel_filter(seq_event->data.control.channel)) {
+                        if (route.layers_mask & LayerInfo::GetLayerMaskBit(i)) {
                             // Set the select bank index for this layer
                             _bank_select_index[i] = seq_event->data.control.value;
                         }
@@ -948,11 +1264,7 @@ void MidiDeviceManager::_process_normal_midi_event(const snd_seq_event_t *seq_ev
             else
             {
                 // MIDI CC events can be mapped to another param
-                // Firstly create the MIDI CC path to check against
-                auto path = Param::ParamPath(this, CC_PARAM_NAME + std::to_string(seq_event->data.control.param));
-                
-                // Get the MIDI param
-                auto param = utils::get_param(path.c_str());
+                auto param = route.param;
                 if (param)
                 {
                     auto &ev = *seq_event;
@@ -962,33 +1274,8 @@ void MidiDeviceManager::_process_normal_midi_event(const snd_seq_event_t *seq_ev
                     // Run the echo filtering algorithm if the MIDI echo filter is enabled 
                     if (mode == MidiEchoFilter::ECHO_FILTER)
                     {
-                        // Process the previous messages in the log, removing old messages and checking
-                        // for duplicate messages
-                        auto end = std::chrono::high_resolution_clock::now();
-                        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - _start_time);
-                        auto it = _cc_prev_messages.begin();
-                        while(it != _cc_prev_messages.end())
-                        {
-                            // Remove this message if is is older than the timeout threshold
-                            uint64_t delta = elapsed.count() - std::get<1>(*it);
-                            if (delta > MIDI_CC_ECHO_TIMEOUT)
-                            {
-                                // Remove the message
-                                _cc_prev_messages.erase(it);
-                            }
-                            else
-                            {
-                                // If the message is an echo of one we have sent, then block the msg
-                                snd_seq_event &old_msg = std::get<0>(*it);
-                                if ((old_msg.data.control.param == ev.data.control.param) &&
-                                    (old_msg.data.control.value == ev.data.control.value) &&
-                                    (old_msg.data.control.channel == ev.data.control.channel)) 
-                                {
-                                    block = true;
-                                }                                 
-                                it++;
-                            }
-                        }
+                        // If the message is an echo of one we have recently sent, then block the msg
+                        block = _cc_echo_filter.is_echo(ev);
                     }
                     // If the MIDI echo filter is filter all - all CC messages are blocked
                     else if (mode == MidiEchoFilter::FILTER_ALL)
@@ -1018,7 +1305,7 @@ void MidiDeviceManager::_process_normal_midi_event(const snd_seq_event_t *seq_ev
                         }
 
                         // Is this MPE Y param and the channel is allocated to MPE?
-                        if ((ev.data.control.param == MPE_Y_PARAM_MIDI_CC_CHANNEL) && utils::is_mpe_channel(seq_event->data.control.channel)) {
+                        if ((ev.data.control.param == MPE_Y_PARAM_MIDI_CC_CHANNEL) && route.mpe_channel) {
                             // Has the MPE Y param changed?
                             if (_mpe_y_param && (_mpe_y_param->get_value() != value)) {
                                 // Update the MPE Y param value to a normalised float
@@ -1029,11 +1316,10 @@ void MidiDeviceManager::_process_normal_midi_event(const snd_seq_event_t *seq_ev
                             }
                         }
                         else {
-                            // Get the layers to process for this event
-                            uint layers_mask = _get_layers_mask(ev.data.control.channel);
-                            if (layers_mask) {
+                            // Process the layers for this event, if any
+                            if (route.layers_mask) {
                                 // Process the mapped params for this param change
-                                _process_param_changed_mapped_params(layers_mask, param, value, nullptr, false);
+                                _process_param_changed_mapped_params(route.layers_mask, param, value);
                             }
                         }
                     }
@@ -1045,7 +1331,8 @@ void MidiDeviceManager::_process_normal_midi_event(const snd_seq_event_t *seq_ev
         case SND_SEQ_EVENT_PITCHBEND:
         {
             // MIDI Pitch Bend events can be mapped to another param
-            if (_pitch_bend_param)
+            auto route = _get_midi_input_route(*seq_event);
+            if (route.param)
             {
                 // Get the Pitch Bend value, clip to min/max, and normalise it
                 float value = seq_event->data.control.value;
@@ -1056,7 +1343,7 @@ void MidiDeviceManager::_process_normal_midi_event(const snd_seq_event_t *seq_ev
                 value = (value - MIDI_PITCH_BEND_MIN_VALUE) / (MIDI_PITCH_BEND_MAX_VALUE - MIDI_PITCH_BEND_MIN_VALUE);
 
                 // Is this channel is allocated to MPE?
-                if (utils::is_mpe_channel(seq_event->data.control.channel)) {
+                if (route.mpe_channel) {
                     // Has the MPE X param changed?
                     if (_mpe_x_param && (_mpe_x_param->get_value() != value)) {            
                         // Update the MPE X param value to a normalised float
@@ -1067,22 +1354,22 @@ void MidiDeviceManager::_process_normal_midi_event(const snd_seq_event_t *seq_ev
                     }
                 }
                 else {
-                    // Get the layers to process for this event
-                    uint layers_mask = _get_layers_mask(seq_event->data.control.channel);
-                    if (layers_mask) {
+                    // Process the layers for this event, if any
+                    if (route.layers_mask) {
                         // Process the mapped params for this param change
-                        _process_param_changed_mapped_params(layers_mask, _pitch_bend_param, value, nullptr, false);
+                        _process_param_changed_mapped_params(route.layers_mask, route.param, value);
                     }
                 }
             }
-            //DEBUG_MSG("Pitch Bend event on Channel " << (int)(seq_event->data.control.channel) << " val " << (int)(seq_event->data.control.value));
+            NINA_TRACE_DEBUG(module(), "Pitch Bend event on Channel {} val {}", seq_event->data.control.channel, seq_event->data.control.value);
             break;
         }
 
         case SND_SEQ_EVENT_CHANPRESS:
         {
             // MIDI Chanpress events can be mapped to another param
-            if (_chanpress_param)
+            auto route = _get_midi_input_route(*seq_event);
+            if (route.param)
             {
                 // Get the Chanpress value, clip to min/max, and normalise it
                 float value = seq_event->data.control.value;
@@ -1093,7 +1380,7 @@ void MidiDeviceManager::_process_normal_midi_event(const snd_seq_event_t *seq_ev
                 value = (value - MIDI_CHANPRESS_MIN_VALUE) / (MIDI_CHANPRESS_MAX_VALUE - MIDI_CHANPRESS_MIN_VALUE);
                                 
                 // Is this channel is allocated to MPE?
-                if (utils::is_mpe_channel(seq_event->data.control.channel)) {
+                if (route.mpe_channel) {
                     // Has the MPE Z param changed?
                     if (_mpe_z_param && (_mpe_y_param->get_value() != value)) { 
                         // Update the MPE Z param value to a normalised float
@@ -1104,15 +1391,14 @@ void MidiDeviceManager::_process_normal_midi_event(const snd_seq_event_t *seq_ev
                     }
                 }
                 else {
-                    // Get the layers to process for this event
-                    uint layers_mask = _get_layers_mask(seq_event->data.control.channel);
-                    if (layers_mask) {                
+                    // Process the layers for this event, if any
+                    if (route.layers_mask) {                
                         // Process the mapped params for this param change
-                        _process_param_changed_mapped_params(layers_mask, _chanpress_param, value, nullptr, false);
+                        _process_param_changed_mapped_params(route.layers_mask, route.param, value);
                     }
                 }
             }
-            //DEBUG_MSG("Chanpress event on Channel " << (int)(seq_event->data.control.channel) << " val " << (int)(seq_event->data.control.value));
+            NINA_TRACE_DEBUG(module(), "Chanpress event on Channel {} val {}", seq_event->data.control.channel, seq_event->data.control.value);
             break;
         }
         
@@ -1166,18 +1452,18 @@ void MidiDeviceManager::_process_normal_midi_event(const snd_seq_event_t *seq_ev
 //----------------------------------------------------------------------------
 // _process_param_changed_mapped_params
 //----------------------------------------------------------------------------
-void MidiDeviceManager::_process_param_changed_mapped_params(uint layers_mask, const Param *param, float value, const Param *skip_param, bool displayed)
+void MidiDeviceManager::_process_param_changed_mapped_params(uint layers_mask, const Param *changed_param, float changed_value)
 {
     bool current_layer_in_mask = LayerInfo::GetLayerMaskBit(utils::get_current_layer_info().layer_num()) & layers_mask;
 
-    // Get the mapped params
-    auto mapped_params = param->get_mapped_params();
-    for (Param *mp : mapped_params)
+    // Get the compiled mapping graph for the changed param, and process each mapped
+    // param from the param it is mapped from
+    auto mapped_param_graph = changed_param->get_mapped_param_graph();
+    for (const MappedParamDest& dest : *mapped_param_graph)
     {
-        // Because this function is recursive, we need to skip the param that
-        // caused any recursion, so it is not processed twice
-        if (skip_param && (mp == skip_param))
-            continue;
+        Param *mp = dest.param;
+        const Param *param = dest.source;
+        float value = changed_value;
 
         // Is this a system function? Only process if the current layer is also being processed
         if ((mp->type == ParamType::SYSTEM_FUNC) && current_layer_in_mask)
@@ -1233,7 +1519,8 @@ void MidiDeviceManager::_process_param_changed_mapped_params(uint layers_mask, c
                 _event_router->post_system_func_event(new SystemFuncEvent(system_func));
             }
 
-            // Note: We don't recurse system function params as they are a system action to be performed
+            // Note: The params mapped to system function params are not in the mapping graph
+            // as they are a system action to be performed
         }
         else
         {
@@ -1255,15 +1542,12 @@ void MidiDeviceManager::_process_param_changed_mapped_params(uint layers_mask, c
                     }
 
                     // Send a param changed event - never show param changes on the GUI that come via a CC message
-                    auto param_change = ParamChange(mp->get_path(), value, module());
+                    auto param_change = ParamChange(mp->handle, value, module());
                     param_change.display = false;
                     param_change.layers_mask = layers_mask;
                     _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
                 }
             }
-
-            // We need to recurse each mapped param and process it
-            _process_param_changed_mapped_params(layers_mask, mp, value, param, displayed);
         }
     }
 }
@@ -1447,16 +1731,25 @@ void MidiDeviceManager::_close_serial_midi()
 }
 
 //----------------------------------------------------------------------------
-// _tempo_timer_callback
+// _clock_tick_callback
 //----------------------------------------------------------------------------
-void MidiDeviceManager::_tempo_timer_callback()
+void MidiDeviceManager::_clock_tick_callback()
 {
-    // If not the MIDI clock source
-    if (_midi_clk_in_param->get_value() == 0) { 
-        // Signal the sequencer and arpeggiator
-        utils::seq_signal();
-        utils::arp_signal();
-    }
+    // Send the sequencer and arpeggiator notes due at this tick
+    ScheduledNoteQueue::Process(ClockEngine::TickCount());
+
+    // Signal the sequencer and arpeggiator
+    utils::seq_signal();
+    utils::arp_signal();
+}
+
+//----------------------------------------------------------------------------
+// _is_external_clock_sync
+//----------------------------------------------------------------------------
+bool MidiDeviceManager::_is_external_clock_sync()
+{
+    // Follow the external MIDI clock if the MIDI Clock In is enabled (non-zero param value)
+    return _midi_clk_in_param->get_value() != 0;
 }
 
 //----------------------------------------------------------------------------
@@ -1471,20 +1764,128 @@ bool MidiDeviceManager::_is_high_priority_midi_event(snd_seq_event_type_t type)
 }
 
 //----------------------------------------------------------------------------
-// _get_layers_mask
+// _queue_midi_event
 //----------------------------------------------------------------------------
-uint MidiDeviceManager::_get_layers_mask(unsigned char channel)
+bool MidiDeviceManager::_queue_midi_event(std::vector<snd_seq_event_t> &queue, MidiCoalesceTable &coalesce_table, const snd_seq_event_t &event, uint max_size)
 {
-    uint layers_mask = 0;
+    uint index;
+
+    // Is an event for this pitchbend, chanpress or CC already pending? If so, overwrite it
+    if (coalesce_table.find(event, index)) {
+        queue[index] = event;
+        _midi_event_queue_stats.num_merged++;
+        return false;
+    }
 
-    // Check each layer and add to the mask if it should be procssed
-    // based on the channel
-    for (uint i=0; i<NUM_LAYERS; i++) {
-        if (utils::get_layer_info(i).check_midi_channel_filter(channel)) {
-            layers_mask |= LayerInfo::GetLayerMaskBit(i);
+    // Drop the event if the queue is full
+    if (queue.size() >= max_size) {
+        _midi_event_queue_stats.num_dropped++;
+        return false;
+    }
+
+    // A note event must be processed after any pending events, and before any events
+    // that follow it - so after a note event no pending event is overwritten
+    if ((event.type == SND_SEQ_EVENT_NOTEON) || (event.type == SND_SEQ_EVENT_NOTEOFF) ||
+        (event.type == SND_SEQ_EVENT_KEYPRESS)) {
+        coalesce_table.clear();
+    }
+
+    // Push the event to the queue
+    coalesce_table.add(event, queue.size());
+    queue.push_back(event);
+    _midi_event_queue_stats.num_queued++;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _get_midi_input_route
+//----------------------------------------------------------------------------
+MidiInputRoute MidiDeviceManager::_get_midi_input_route(const snd_seq_event_t &event)
+{
+    auto route = MidiInputRoute();
+    uint channel = event.data.control.channel;
+
+    // Get the MIDI input tables mutex
+    std::lock_guard<std::mutex> lock(_midi_input_tables_mutex);
+
+    // Rebuild the tables if the params or MIDI channel config have changed since they
+    // were last built
+    // Note: The MPE zone number of channels are checked directly, as the zone params can
+    // be set from any path (GUI, OSC, patch load) without changing the MIDI channel
+    // config generation
+    if (_cc_params_generation != utils::params_generation()) {
+        _build_cc_params_table();
+    }
+    if ((_channel_tables_generation != utils::midi_channel_config_generation()) ||
+        (_channel_tables_mpe_zones != utils::mpe_zone_num_channels())) {
+        _build_channel_tables();
+    }
+
+    // Get the param for this event
+    switch (event.type) {
+        case SND_SEQ_EVENT_CONTROLLER:
+            route.param = (event.data.control.param < NUM_MIDI_COALESCE_CCS) ? _cc_params[event.data.control.param] : nullptr;
+            break;
+
+        case SND_SEQ_EVENT_PITCHBEND:
+            route.param = _pitch_bend_param;
+            break;
+
+        case SND_SEQ_EVENT_CHANPRESS:
+            route.param = _chanpress_param;
+            break;
+
+        default:
+            route.param = nullptr;
+            break;
+    }
+
+    // Get the layers to process for this channel, and if it is allocated to MPE
+    route.layers_mask = (channel < NUM_MIDI_COALESCE_CHANNELS) ? _channel_layers_mask[channel] : 0;
+    route.mpe_channel = (channel < NUM_MIDI_COALESCE_CHANNELS) ? _channel_mpe[channel] : false;
+    return route;
+}
+
+//----------------------------------------------------------------------------
+// _build_cc_params_table
+// Note: The MIDI input tables mutex must be held by the caller
+//----------------------------------------------------------------------------
+void MidiDeviceManager::_build_cc_params_table()
+{
+    // Get the params generation before building, so any change while it is built
+    // causes a rebuild
+    _cc_params_generation = utils::params_generation();
+
+    // Get the MIDI param for each CC number
+    for (uint i=0; i<NUM_MIDI_COALESCE_CCS; i++) {
+        auto path = Param::ParamPath(this, CC_PARAM_NAME + std::to_string(i));
+        _cc_params[i] = utils::get_param(path.c_str());
+    }
+}
+
+//----------------------------------------------------------------------------
+// _build_channel_tables
+// Note: The MIDI input tables mutex must be held by the caller
+//----------------------------------------------------------------------------
+void MidiDeviceManager::_build_channel_tables()
+{
+    // Get the MIDI channel config generation before building, so any change while
+    // they are built causes a rebuild
+    _channel_tables_generation = utils::midi_channel_config_generation();
+    _channel_tables_mpe_zones = utils::mpe_zone_num_channels();
+
+    // Check each channel, and set the layers to be processed for that channel, and if it
+    // is allocated to MPE
+    for (uint channel=0; channel<NUM_MIDI_COALESCE_CHANNELS; channel++) {
+        uint layers_mask = 0;
+        for (uint i=0; i<NUM_LAYERS; i++) {
+            if (utils::get_layer_info(i).check_midi_channel_filter(channel)) {
+                layers_mask |= LayerInfo::GetLayerMaskBit(i);
+            }
         }
+        _channel_layers_mask[channel] = layers_mask;
+        _channel_mpe[channel] = utils::is_mpe_channel(channel);
     }
-    return layers_mask;
 }
 
 //----------------------------------------------------------------------------
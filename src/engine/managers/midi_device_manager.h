@@ -13,14 +13,110 @@
 #include <algorithm>
 #include <vector>
 #include <mutex>
+#include <condition_variable>
 #include <tuple>
 #include "base_manager.h"
 #include "event_router.h"
 #include "event.h"
 #include "timer.h"
+#include "clock_engine.h"
 
 // Constants
-constexpr uint NUM_FILTER_SAMPLES = 5;
+constexpr uint NUM_MIDI_COALESCE_CHANNELS = 16;
+constexpr uint NUM_MIDI_COALESCE_CCS = 128;
+constexpr uint NUM_MIDI_COALESCE_SLOTS = NUM_MIDI_COALESCE_CHANNELS * (NUM_MIDI_COALESCE_CCS + 2);
+
+// MIDI Coalesce Table class
+// The queue index of the pending pitchbend, chanpress or CC event for each type,
+// channel and controller number, so that a new event can overwrite the pending
+// event in O(1)
+// A slot is only valid if its generation matches the table generation, so the table
+// is also cleared in O(1)
+class MidiCoalesceTable
+{
+public:
+    // Constructor
+    MidiCoalesceTable();
+
+    // Public functions
+    bool find(const snd_seq_event_t &event, uint &index) const;
+    void add(const snd_seq_event_t &event, uint index);
+    void clear();
+
+private:
+    // Coalesce table slot
+    struct Slot
+    {
+        uint index;
+        uint generation;
+    };
+
+    // Private variables
+    Slot _slots[NUM_MIDI_COALESCE_SLOTS];
+    uint _generation;
+
+    // Private functions
+    static int _slot_num(const snd_seq_event_t &event);
+};
+
+// MIDI CC Echo Filter class
+// The CC messages sent within the echo timeout, held in a time-ordered ring buffer
+// so that they expire in bulk from the tail, and the number of these messages sent
+// for each channel, CC and value, so that an echo is detected in constant time
+// If the ring buffer is full the oldest message is dropped (and counted), so its
+// echo may no longer be filtered
+class MidiCcEchoFilter
+{
+public:
+    // Constructor
+    MidiCcEchoFilter();
+
+    // Public functions
+    void add(const snd_seq_event_t &event);
+    bool is_echo(const snd_seq_event_t &event);
+    uint64_t num_dropped(bool reset);
+
+private:
+    // Sent CC message
+    struct SentCc
+    {
+        uint index;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    // Private variables
+    std::mutex _mutex;
+    std::vector<SentCc> _ring_buffer;
+    uint _tail;
+    uint _count;
+    std::vector<uint16_t> _num_sent;
+    uint64_t _num_dropped;
+    bool _dropping;
+
+    // Private functions
+    void _expire(std::chrono::steady_clock::time_point now);
+    static int _index(const snd_seq_event_t &event);
+};
+
+// MIDI input route
+// The param, layers and MPE allocation for an incoming CC, pitchbend or chanpress
+// event
+struct MidiInputRoute
+{
+    Param *param;
+    uint layers_mask;
+    bool mpe_channel;
+};
+
+// MIDI event queue stats
+// The number of MIDI events queued, merged into a pending event, and dropped as the
+// queue is full
+struct MidiEventQueueStats
+{
+    std::atomic<uint64_t> num_queued{0};
+    std::atomic<uint64_t> num_merged{0};
+    std::atomic<uint64_t> num_dropped{0};
+};
 
 // MIDI Device Manager class
 class MidiDeviceManager: public BaseManager
@@ -45,6 +141,8 @@ public:
     void process_midi_devices();
     void process_midi_event();
     void process_midi_event_queue();
+    const MidiEventQueueStats& midi_event_queue_stats() const;
+    void log_event_stats(bool reset=true);
 
 private:
     // Private variables
@@ -58,17 +156,16 @@ private:
     int _serial_midi_port_handle;
     std::thread *_midi_devices_thread;
     bool _run_midi_devices_thread;
+    snd_seq_client_info_t *_scan_client_info;
+    snd_seq_port_info_t *_scan_port_info;
+    snd_seq_query_subscribe_t *_scan_subscribe_query;
     std::thread *_midi_event_thread;
     bool _run_midi_event_thread;
     std::thread *_midi_event_queue_thread;
     bool _run_midi_event_queue_thread;
     int _bank_select_index[NUM_LAYERS];
-    Timer *_tempo_timer;
+    ClockEngine _clock_engine;
     uint _midi_clock_count;
-    std::chrono::system_clock::time_point _midi_clock_start;
-    float _tempo_filter_state;
-    uint _mesurement_num;
-    std::array<uint,NUM_FILTER_SAMPLES> _midi_clock_mesurements;
     Param *_tempo_param;
     Param *_midi_clk_in_param;
     Param *_midi_echo_filter_param;
@@ -77,13 +174,23 @@ private:
     Param *_mpe_z_param;
     Param *_pitch_bend_param;
     Param *_chanpress_param;
-    std::vector<std::tuple<snd_seq_event_t, uint64_t>> _cc_prev_messages;
-    std::chrono::_V2::system_clock::time_point _start_time;
+    MidiCcEchoFilter _cc_echo_filter;
+    std::mutex _midi_input_tables_mutex;
+    Param *_cc_params[NUM_MIDI_COALESCE_CCS];
+    uint _channel_layers_mask[NUM_MIDI_COALESCE_CHANNELS];
+    bool _channel_mpe[NUM_MIDI_COALESCE_CHANNELS];
+    uint _cc_params_generation;
+    uint _channel_tables_generation;
+    std::pair<uint, uint> _channel_tables_mpe_zones;
     std::mutex _midi_event_queue_mutex;
+    std::condition_variable _midi_event_queue_cv;
+    std::chrono::milliseconds _midi_event_queue_min_interval;
     std::vector<snd_seq_event_t> _midi_event_queue_a;
     std::vector<snd_seq_event_t> _midi_event_queue_b;
     std::vector<snd_seq_event_t> *_push_midi_event_queue;
     std::vector<snd_seq_event_t> *_pop_midi_event_queue;
+    MidiCoalesceTable _midi_event_queue_coalesce_table;
+    MidiEventQueueStats _midi_event_queue_stats;
     
     // Private functions
     void _process_reload_presets();
@@ -91,15 +198,22 @@ private:
     void _process_midi_param_changed(Param *param);
     void _process_high_priority_midi_event(const snd_seq_event_t *seq_event);
     void _process_normal_midi_event(const snd_seq_event_t *seq_event);
-    void _process_param_changed_mapped_params(uint layers_mask, const Param *param, float value, const Param *skip_param, bool displayed);
+    void _process_param_changed_mapped_params(uint layers_mask, const Param *changed_param, float changed_value);
     void _start_stop_seq_run(bool start);
     void _open_seq_midi();
+    bool _open_announce_seq(snd_seq_t **seq_handle);
+    bool _scan_midi_devices();
+    bool _is_subscribed(const snd_seq_addr_t &root_addr, const snd_seq_addr_t &addr, snd_seq_query_subs_type_t type);
     void _close_seq_midi();
     void _open_serial_midi();
     void _close_serial_midi();
-    void _tempo_timer_callback();
+    void _clock_tick_callback();
+    bool _is_external_clock_sync();
     bool _is_high_priority_midi_event(snd_seq_event_type_t type);
-    uint _get_layers_mask(unsigned char channel);
+    bool _queue_midi_event(std::vector<snd_seq_event_t> &queue, MidiCoalesceTable &coalesce_table, const snd_seq_event_t &event, uint max_size);
+    MidiInputRoute _get_midi_input_route(const snd_seq_event_t &event);
+    void _build_cc_params_table();
+    void _build_channel_tables();
     inline MidiEchoFilter _get_midi_echo_filter();
 };
 
@@ -18,10 +18,12 @@
 #include "utils.h"
 
 // Constants
-constexpr int SEND_POLL_TIME              = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::milliseconds(200)).count();
-constexpr int CHANGE_PARAMS_IDLE_INTERVAL = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::milliseconds(250)).count();
+constexpr auto SEND_RETRY_TIME             = std::chrono::milliseconds(200);
+constexpr auto REDUNDANT_SEND_INTERVAL     = std::chrono::milliseconds(1);
+constexpr auto CHANGE_PARAMS_IDLE_INTERVAL = std::chrono::milliseconds(250);
 
 // Static functions
+static void *_process_osc_sends(void* data);
 static int _osc_receive_control_handler(const char *path, const char *types, lo_arg **argv,
                                         int, void *, void *user_data);
 static void _osc_err_handler(int num, const char *msg, const char *where);
@@ -39,8 +41,9 @@ OscManager::OscManager(EventRouter *event_router) :
     _sfc_listener = 0;
     _fm_reload_presets_listener = 0;
     _fm_param_changed_listener = 0;
-    _send_timer = new Timer(TimerType::PERIODIC);
-    _param_change_timer = new Timer(TimerType::ONE_SHOT);
+    _osc_send_thread = 0;
+    _run_osc_send_thread = true;
+    _send_idle_time = std::chrono::steady_clock::now();
 }
 
 //----------------------------------------------------------------------------
@@ -48,18 +51,19 @@ OscManager::OscManager(EventRouter *event_router) :
 //----------------------------------------------------------------------------
 OscManager::~OscManager()
 {
-    // Stop the OSC timer tasks
-    if (_send_timer)
+    // OSC send task running?
+    if (_osc_send_thread != 0)
     {
-        _send_timer->stop();
-        delete _send_timer;
-        _send_timer = 0;
-    }
-    if (_param_change_timer)
-    {
-        _param_change_timer->stop();
-        delete _param_change_timer;
-        _param_change_timer = 0;
+        // Stop the OSC send task
+        {
+            std::lock_guard<std::mutex> lock(_osc_mutex);
+            _run_osc_send_thread = false;
+        }
+        _osc_send_cv.notify_all();
+        if (_osc_send_thread->joinable())
+            _osc_send_thread->join();
+        delete _osc_send_thread;
+        _osc_send_thread = 0;
     }
 
     // Stop and free the server
@@ -113,8 +117,9 @@ bool OscManager::start()
 	// Before starting the OSC Manager, process all the preset values
 	_process_presets();
 
-	// Start the OSC send timer periodic thread
-	_send_timer->start(SEND_POLL_TIME, std::bind(&OscManager::_osc_send_callback, this));
+    // Create the thread to send the queued OSC values
+    // Note: Sending is done by this thread so that param changes never wait on OSC
+    _osc_send_thread = new std::thread(_process_osc_sends, this);
 
     // All ok, call the base manager
     return BaseManager::start();
@@ -168,12 +173,15 @@ void OscManager::process_event(const BaseEvent *event)
 //----------------------------------------------------------------------------
 // osc_control_receive_value
 //----------------------------------------------------------------------------
-void OscManager::osc_control_receive_value(std::string control_path, float value)
+void OscManager::osc_control_receive_value(const char *control_path, float value)
 {
-    // Get the param, make sure it exists
-    Param *param = utils::get_param(control_path.c_str());
-    if (param)
+    // Get the param from the receive dispatch map, make sure it exists
+    // Note: The map is not changed once the OSC server is running
+    auto itr = _receive_params.find(control_path);
+    if (itr != _receive_params.end())
     {
+        Param *param = itr->second;
+
         // Update the param value
         // Note: Assumes all OSC controls are normalised floats
         param->set_value_from_normalised_float(value);
@@ -183,7 +191,7 @@ void OscManager::osc_control_receive_value(std::string control_path, float value
         _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
 
         // Process the mapped params for this param change
-        _process_param_changed_mapped_params(param, value, nullptr, param_change.display);
+        _process_param_changed_mapped_params(param, value, param_change.display);
     }
 }
 
@@ -210,119 +218,83 @@ bool OscManager::_initialise_osc_server()
     // Get the send address
     _send_addr = lo_address_new(host_ip, outgoing_port);
 
-    // Start the OSC server thread
-    lo_server_thread_start(_osc_server);
-
-    // Add control methods for all Surface Control params
+    // Add all Surface Control params to the receive dispatch map
     std::vector<Param *> params = utils::get_params(NinaModule::SURFACE_CONTROL);
-    for (const Param *p : params)
+    for (Param *p : params)
     {
         // Only add physical control params
         if (p->physical_control_param)
-        {
-            // Add a control method for each param
-            lo_server_thread_add_method(_osc_server, p->get_path().c_str(), "f", _osc_receive_control_handler, this);
-        }
+            _add_receive_control(p);
     }
 
-    // Add control methods for all DAW params
+    // Add all DAW params
     params = utils::get_params(NinaModule::DAW);
-    for (const Param *p : params)
+    for (Param *p : params)
     {
-        // Add a control method for each param
-        lo_server_thread_add_method(_osc_server, p->get_path().c_str(), "f", _osc_receive_control_handler, this);
+        _add_receive_control(p);
     }
 
-    // Add control methods for all System Func params
+    // Add all System Func params, skipping alias params
     params = utils::get_params(ParamType::SYSTEM_FUNC);
-    for(const Param *p : params)
+    for (Param *p : params)
     {
-        // Skip alias params
-        if (!p->alias_param) {
-            // Add a control method for each System Func param
-            lo_server_thread_add_method(_osc_server, p->get_path().c_str(), "f", _osc_receive_control_handler, this);
-        }
+        if (!p->alias_param)
+            _add_receive_control(p);
     }
+
+    // Add a single control method for all received float values - the param is looked
+    // up in the receive dispatch map, rather than liblo matching each method path
+    lo_server_thread_add_method(_osc_server, NULL, "f", _osc_receive_control_handler, this);
+
+    // Start the OSC server thread
+    lo_server_thread_start(_osc_server);
     return true;
 }
 
+//----------------------------------------------------------------------------
+// _add_receive_control
+//----------------------------------------------------------------------------
+void OscManager::_add_receive_control(Param *param)
+{
+    // Add the param to the receive dispatch map, keyed by its OSC path
+    // Note: The paths are held in a deque so the map keys remain valid
+    const auto& path = _receive_paths.emplace_back(param->get_path());
+    if (!_receive_params.emplace(path, param).second)
+        _receive_paths.pop_back();
+}
+
 //----------------------------------------------------------------------------
 // _process_param_change_event
 //----------------------------------------------------------------------------
 void OscManager::_process_param_change_event(const ParamChange &param_change)
 {
-    // Get the OSC mutex
-    std::lock_guard<std::mutex> guard(_osc_mutex);
-
-    // Is this physical Surface Control param?
-    const Param *param = utils::get_param(param_change.path.c_str());
-    if (param && (param->module == NinaModule::SURFACE_CONTROL) && param->physical_control_param)
+    // Is this physical Surface Control param, or a DAW param?
+    const Param *param = utils::get_param_from_handle(param_change.handle);
+    if (param && (((param->module == NinaModule::SURFACE_CONTROL) && param->physical_control_param) ||
+                  (param->module == NinaModule::DAW)))
     {
-        // Stop the param change timer
-        _param_change_timer->stop();
-
-        // We ned to update the param changes vector with this change
-        // Firstly check if this param change already in the vector
-        bool found = false;
-        for (OscParamChange &pc : _param_changes) {
-            if (pc.path == param->get_path()) {
-                // Param already exists; update that param change
-                pc.value = param->get_normalised_value();
-                found = true;
-            }
-        }
-        if (!found) {
-            // Param not found in the deltas vector, add it
-            _param_changes.push_back(OscParamChange(param->get_path(), param->get_normalised_value()));
-        }
-        
-        // Start the param change timer to send the changed params if no param 
-        // has changed for a time interval
-        _param_change_timer->start(CHANGE_PARAMS_IDLE_INTERVAL, std::bind(&OscManager::_params_changed_timeout, this));
+        // Queue the param value to be sent, once no param has changed for a time interval
+        // Note: Any value already queued for this param is replaced
+        std::lock_guard<std::mutex> guard(_osc_mutex);
+        _queue_osc_send(param, true);
+        _osc_send_cv.notify_all();
     }
-    else
-    {
-        // Is this a DAW param?
-        if (param && (param->module == NinaModule::DAW))
-        {
-            // Stop the param change timer
-            _param_change_timer->stop();
-
-            // We ned to update the param changes vector with this change
-            // Firstly check if this param change already in the vector
-            bool found = false;
-            for (OscParamChange &pc : _param_changes) {
-                if (pc.path == param->get_path()) {
-                    // Param already exists; update that delta
-                    pc.value = param->get_normalised_value();
-                    found = true;
-                }
-            }
-            if (!found) {
-                // Param not found in the deltas vector, add it
-                _param_changes.push_back(OscParamChange(param->get_path(), param->get_normalised_value()));
-            }
-            
-            // Start the param change timer to send the changed params if no param 
-            // has changed for a time interval
-            _param_change_timer->start(CHANGE_PARAMS_IDLE_INTERVAL, std::bind(&OscManager::_params_changed_timeout, this));
-        }
-    }     
 }
 
 //----------------------------------------------------------------------------
 // _process_param_changed_mapped_params
 //----------------------------------------------------------------------------
-void OscManager::_process_param_changed_mapped_params(const Param *param, float value, const Param *skip_param, bool displayed)
+void OscManager::_process_param_changed_mapped_params(const Param *changed_param, float changed_value, bool displayed)
 {
-    // Get the mapped params
-    auto mapped_params = param->get_mapped_params();
-    for (Param *mp : mapped_params)
+    // Get the compiled mapping graph for the changed param, and process each mapped
+    // param from the param it is mapped from
+    auto mapped_param_graph = changed_param->get_mapped_param_graph();
+    for (uint i=0; i<mapped_param_graph->size(); i++)
     {
-        // Because this function is recursive, we need to skip the param that
-        // caused any recursion, so it is not processed twice
-        if (skip_param && (mp == skip_param))
-            continue;
+        auto& dest = mapped_param_graph->at(i);
+        Param *mp = dest.param;
+        const Param *param = dest.source;
+        float value = changed_value;
 
         // Is this a System Func param?
         if (mp->type == ParamType::SYSTEM_FUNC)
@@ -364,12 +336,18 @@ void OscManager::_process_param_changed_mapped_params(const Param *param, float
                 _event_router->post_system_func_event(new SystemFuncEvent(system_func));
             }
 
-            // Note: We don't recurse system function params as they are a system action to be performed
+            // Note: The params mapped to system function params are not in the mapping graph
+            // as they are a system action to be performed
         }
         else
         {
             // Only process if something has actually changed
-            if (mp->get_value() != value)
+            // If not, skip the params mapped through this param
+            if (mp->get_value() == value)
+            {
+                i += dest.num_descendants;
+            }
+            else
             {
                 // Update the param value
                 // Note: Assumes all OSC controls are normalised floats
@@ -383,36 +361,11 @@ void OscManager::_process_param_changed_mapped_params(const Param *param, float
                 else
                     displayed = param_change.display;
                 _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
-
-                // We need to recurse each mapped param and process it
-                _process_param_changed_mapped_params(mp, value, param, displayed);                
             }
         }
     }
 }
 
-//----------------------------------------------------------------------------
-// _params_changed_timeout
-//----------------------------------------------------------------------------
-void OscManager::_params_changed_timeout()
-{
-    // Get the OSC mutex
-    std::lock_guard<std::mutex> guard(_osc_mutex);
-
-    // Create a new bundle with all param changes
-    auto osc_bundle = OscBundle();
-    for (OscParamChange pc : _param_changes)
-    {
-        // Add to the bundle
-        auto osc_msg = lo_message_new();
-        lo_message_add(osc_msg, "f", pc.value);
-        lo_bundle_add_message(osc_bundle.bundle, pc.path.c_str(), osc_msg);
-    }
-    _param_changes.clear();
-    osc_bundle.id = _send_bundles.size() + 1;
-    _send_bundles.push_back(osc_bundle);
-}
-
 //----------------------------------------------------------------------------
 // _process_presets
 //----------------------------------------------------------------------------
@@ -421,78 +374,145 @@ void OscManager::_process_presets()
     // Get the OSC mutex
     std::lock_guard<std::mutex> guard(_osc_mutex);
 
-    // Parse the Surface Control params
+    // Queue the Surface Control params - only physical controls are sent
     std::vector<Param *> params = utils::get_params(NinaModule::SURFACE_CONTROL);
-    auto osc_bundle1 = OscBundle();
     for (const Param *p : params)
     {
-        // Only send physical controls
         if (p->physical_control_param)
-        {
-            // Add to the bundle
-            auto osc_msg = lo_message_new();
-            lo_message_add(osc_msg, "f", p->get_normalised_value());
-            lo_bundle_add_message(osc_bundle1.bundle, p->get_path().c_str(), osc_msg);
-        }
+            _queue_osc_send(p, false);
     }
-    osc_bundle1.id = _send_bundles.size() + 1;
-    _send_bundles.push_back(osc_bundle1);    
     
-    // Parse the DAW params
+    // Queue the DAW params, skipping alias params
     params = utils::get_params(NinaModule::DAW);
-    auto osc_bundle2 = OscBundle();
     for (const Param *p : params)
     {
-        // Skip alias params
-        if (!p->alias_param) {
-            // Add to the bundle
-            auto osc_msg = lo_message_new();
-            lo_message_add(osc_msg, "f", p->get_normalised_value());
-            lo_bundle_add_message(osc_bundle2.bundle, p->get_path().c_str(), osc_msg);
-        }
+        if (!p->alias_param)
+            _queue_osc_send(p, false);
     }
-    osc_bundle2.id = _send_bundles.size() + 1;
-    _send_bundles.push_back(osc_bundle2);
+    _osc_send_cv.notify_all();
 }
 
 //----------------------------------------------------------------------------
-// _osc_send_callback
+// _queue_osc_send
+// Note: The OSC mutex must be held by the caller
 //----------------------------------------------------------------------------
-void OscManager::_osc_send_callback()
+void OscManager::_queue_osc_send(const Param *param, bool wait_idle)
 {
-	// Get the OSC mutex
-	std::lock_guard<std::mutex> guard(_osc_mutex);
-    bool send_ok = true;
+    // Get the send value slot for this param, adding it to the pool if this is the first
+    // time it has been sent
+    auto itr = _send_value_indexes.find(param);
+    uint index;
+    if (itr == _send_value_indexes.end())
+    {
+        index = _send_values.size();
+        _send_values.push_back({param->get_path(), 0.0, false});
+        _send_value_indexes[param] = index;
+    }
+    else
+    {
+        index = itr->second;
+    }
 
-    // If send bundles exist
-    for (auto it = _send_bundles.begin(); it != _send_bundles.end(); it++)
+    // Update the value to send - if a value is already queued for this param, it is
+    // replaced by this value
+    auto& send_value = _send_values[index];
+    send_value.value = param->get_normalised_value();
+    if (!send_value.pending)
     {
-        // Send the bundle of control updates to OSC
-        for (uint i=0; i<_send_count; i++)
+        send_value.pending = true;
+        _pending_send_values.push_back(index);
+    }
+
+    // Should the value be sent once no param has changed for a time interval?
+    if (wait_idle)
+        _send_idle_time = std::chrono::steady_clock::now() + CHANGE_PARAMS_IDLE_INTERVAL;
+}
+
+//----------------------------------------------------------------------------
+// process_osc_sends
+//----------------------------------------------------------------------------
+void OscManager::process_osc_sends()
+{
+    // Do forever (until the thread is exited)
+    std::unique_lock<std::mutex> lock(_osc_mutex);
+    while (true)
+    {
+        // Wait for values to be queued, and then for the param changes to be idle
+        _osc_send_cv.wait(lock, [this]{ return !_pending_send_values.empty() || !_run_osc_send_thread; });
+        while (_run_osc_send_thread && (std::chrono::steady_clock::now() < _send_idle_time))
+            _osc_send_cv.wait_until(lock, _send_idle_time);
+        if (!_run_osc_send_thread)
+            break;
+
+        // Take the queued values
+        // Note: The path of a pooled send value never changes once added, so it can be
+        // used without the OSC mutex held
+        _send_batch.clear();
+        for (uint index : _pending_send_values)
+        {
+            auto& send_value = _send_values[index];
+            send_value.pending = false;
+            _send_batch.push_back({index, send_value.path.c_str(), send_value.value});
+        }
+        _pending_send_values.clear();
+
+        // Send the values without the OSC mutex held, so that param changes can be queued
+        // while sending
+        lock.unlock();
+        bool send_ok = _send_osc_batch();
+        lock.lock();
+
+        // If an error occurred sending, re-queue the values not since replaced, and try
+        // again after waiting the retry time
+        if (!send_ok)
         {
-            // Send the bundle
-            if (lo_send_bundle(_send_addr, it->bundle) < 0)
+            for (const auto& sbv : _send_batch)
             {
-                // An error occurred sending the bundle
-                // In this case we stop processing and try again after waiting
-                // the send poll time
-                send_ok = false;
-                break;
+                auto& send_value = _send_values[sbv.index];
+                if (!send_value.pending)
+                {
+                    send_value.pending = true;
+                    _pending_send_values.push_back(sbv.index);
+                }
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            _osc_send_cv.wait_for(lock, SEND_RETRY_TIME, [this]{ return !_run_osc_send_thread; });
         }
     }
+}
+
+//----------------------------------------------------------------------------
+// _send_osc_batch
+//----------------------------------------------------------------------------
+bool OscManager::_send_osc_batch()
+{
+    bool send_ok = true;
 
-    // Clear the sent bundles if all sent ok
-    if (send_ok)
+    // Create a bundle with the values to send
+    auto bundle = lo_bundle_new(LO_TT_IMMEDIATE);
+    for (const auto& sbv : _send_batch)
     {
-        // Free memory allocated to the bundles 
-        for (auto it = _send_bundles.begin(); it != _send_bundles.end(); it++)
-            lo_bundle_free_recursive(it->bundle);
+        auto osc_msg = lo_message_new();
+        lo_message_add_float(osc_msg, sbv.value);
+        lo_bundle_add_message(bundle, sbv.path, osc_msg);
+    }
 
-        // Clear the send bundles vector
-        _send_bundles.clear();
+    // Send the bundle the configured number of times, pacing the redundant sends
+    for (uint i=0; i<_send_count; i++)
+    {
+        // Send the bundle
+        if (lo_send_bundle(_send_addr, bundle) < 0)
+        {
+            // An error occurred sending the bundle
+            send_ok = false;
+            break;
+        }
+        if (i < (_send_count - 1))
+            std::this_thread::sleep_for(REDUNDANT_SEND_INTERVAL);
     }
+
+    // Free the bundle and its messages
+    lo_bundle_free_recursive(bundle);
+    return send_ok;
 }
 
 //----------------------------------------------------------------------------
@@ -502,10 +522,9 @@ static int _osc_receive_control_handler(const char *path, const char *types, lo_
                                         int, void *, void *user_data)
 {
     // Handle the receive control value event
-    std::string std_path(path);
     auto control_handler = static_cast<OscManager *>(user_data);
     if (std::strcmp(types, "f") == 0)
-        control_handler->osc_control_receive_value(std_path, argv[0]->f);
+        control_handler->osc_control_receive_value(path, argv[0]->f);
     return 0;
 }
 
@@ -517,3 +536,15 @@ static void _osc_err_handler([[maybe_unused]] int num, [[maybe_unused]] const ch
     // Show the error
     DEBUG_MSG("An OSC error occurred: " << num << ", " << msg << ", " << where);
 }
+
+//----------------------------------------------------------------------------
+// _process_osc_sends
+//----------------------------------------------------------------------------
+static void *_process_osc_sends(void* data)
+{
+    auto osc_manager = static_cast<OscManager*>(data);
+    osc_manager->process_osc_sends();
+
+    // To suppress warnings
+    return nullptr;
+}
@@ -9,37 +9,34 @@
 #ifndef _OSC_MANAGER_H
 #define _OSC_MANAGER_H
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <string_view>
 #include "lo/lo.h"
 #include "lo/lo_cpp.h"
 #include "base_manager.h"
 #include "event.h"
 #include "event_router.h"
 #include "param.h"
-#include "timer.h"
 
-// OSC Bundle structure
-struct OscBundle
+// OSC Send Value structure
+// A pooled slot holding the last value queued to be sent for an OSC path
+struct OscSendValue
 {
-	OscBundle() 
-	{
-		bundle = lo_bundle_new(LO_TT_IMMEDIATE);
-		send_count = 0;
-        id = 0;
-	}
-    lo_bundle bundle;
-    unsigned int send_count;
-    unsigned int id;
+    std::string path;
+    float value;
+    bool pending;
 };
 
-// OSC Param change structure
-struct OscParamChange
+// OSC Send Batch Value structure
+struct OscSendBatchValue
 {
-	OscParamChange(std::string path, float value) 
-	{
-		this->path = path;
-		this->value = value;
-	}    
-    std::string path;
+    uint index;
+    const char *path;
     float value;
 };
 
@@ -57,7 +54,8 @@ public:
     bool start();
     void process();
     void process_event(const BaseEvent *event);
-    void osc_control_receive_value(std::string control_path, float value);
+    void osc_control_receive_value(const char *control_path, float value);
+    void process_osc_sends();
 
 private:
     // Private variables
@@ -67,19 +65,26 @@ private:
     EventListener *_sfc_listener;
     EventListener *_fm_reload_presets_listener;
     EventListener *_fm_param_changed_listener;
-    Timer *_send_timer;
-    Timer *_param_change_timer;
+    std::thread *_osc_send_thread;
+    bool _run_osc_send_thread;
     std::mutex _osc_mutex;
-    std::vector<OscBundle> _send_bundles;
-    std::vector<OscParamChange> _param_changes;
+    std::condition_variable _osc_send_cv;
+    std::deque<OscSendValue> _send_values;
+    std::unordered_map<const Param *, uint> _send_value_indexes;
+    std::vector<uint> _pending_send_values;
+    std::vector<OscSendBatchValue> _send_batch;
+    std::chrono::steady_clock::time_point _send_idle_time;
+    std::deque<std::string> _receive_paths;
+    std::unordered_map<std::string_view, Param *> _receive_params;
 
     // Private functions
     bool _initialise_osc_server();
+    void _add_receive_control(Param *param);
     void _process_param_change_event(const ParamChange &param_change);
-    void _process_param_changed_mapped_params(const Param *param, float value, const Param *skip_param, bool displayed);
-    void _params_changed_timeout();
+    void _process_param_changed_mapped_params(const Param *changed_param, float changed_value, bool displayed);
     void _process_presets();
-    void _osc_send_callback();
+    void _queue_osc_send(const Param *param, bool wait_idle);
+    bool _send_osc_batch();
 };
 
 #endif  // _OSC_MANAGER_H
@@ -10,6 +10,8 @@
 #include <unistd.h>
 #include "sequencer_manager.h"
 #include "keyboard_manager.h"
+#include "clock_engine.h"
+#include "scheduled_note_queue.h"
 #include "utils.h"
 
 // Constants
@@ -41,6 +43,7 @@ SequencerManager::SequencerManager(EventRouter *event_router) :
     _tempo_event_thread = 0;
     _fsm_running = true;
     _reset_fsm = false;
+    _schedule_tick = 0;
     _tempo_pulse_count = utils::tempo_pulse_count(TempoNoteValue::QUARTER);
     _note_duration_pulse_count = _tempo_pulse_count >> 1;
     _num_steps = 0;
@@ -60,12 +63,13 @@ SequencerManager::SequencerManager(EventRouter *event_router) :
     _sfc_system_func_listener = 0;
     _seq_state = SeqState::IDLE;
     _base_note = 0xFF;
-    _preset_base_note = 0xFF;
     _step_note_index = 0;
     _tie_start_step = -1;
     _tie_end_step = -1;
     _idle_sent_notes.clear();
     _reset_seq_steps();
+    _play_steps = _edit_steps;
+    _edit_steps_pending = false;
     
     // Register the Sequencer params
     _register_params();
@@ -206,6 +210,9 @@ void SequencerManager::process_midi_event_direct(const snd_seq_event_t *event)
     // Are we in programming mode?
     if (_program)
     {
+        // Get the edit steps mutex, the steps are programmed into the edit steps
+        std::lock_guard<std::mutex> edit_guard(_edit_steps_mutex);
+
         // If there are steps to fill
         if ((_num_steps < _max_steps)) {
             // If this is a note on event, add it to the current step 
@@ -217,12 +224,13 @@ void SequencerManager::process_midi_event_direct(const snd_seq_event_t *event)
                     {
                         // Set the base note
                         _base_note = seq_event.data.note.note;
+                        _edit_steps.base_note = _base_note;
                     }
 
                     // Add the note to the step
+                    // Note: The step notes are always played at full velocity
                     DEBUG_BASEMGR_MSG("Added note: " << (int)seq_event.data.note.note << " to step " << _num_steps);
-                    _seq_steps[_num_steps].notes[_step_note_index] = seq_event;
-                    _seq_steps[_num_steps].notes[_step_note_index].data.note.note -= _base_note;
+                    _edit_steps.steps[_num_steps].notes[_step_note_index] = {(uint8_t)(seq_event.data.note.note - _base_note), 127};
                     _step_note_index++;
 
                     // Add the note to the played notes vector
@@ -251,26 +259,26 @@ void SequencerManager::process_midi_event_direct(const snd_seq_event_t *event)
                 {
                     // Update the step
                     DEBUG_BASEMGR_MSG("Sequencer Step " << _num_steps << ": Programmed " << _step_note_index << " notes");
-                    _seq_steps[_num_steps].num_notes = _step_note_index;
+                    _edit_steps.steps[_num_steps].num_notes = _step_note_index;
 
                     // Are we tying this step to other steps?
                     if ((_tie_start_step != -1) && (_tie_end_step != -1) && 
                         ((uint)_tie_start_step == _num_steps) && ((uint)_tie_end_step > (uint)_tie_start_step)) {
                         // Yes, indicate this is the first step in the tie
                         DEBUG_BASEMGR_MSG("Start Tie: " << _num_steps);
-                        _seq_steps[_num_steps].step_type = StepType::START_TIE;
+                        _edit_steps.steps[_num_steps].step_type = StepType::START_TIE;
                         _set_seq_step_param(_num_steps);
                         _num_steps++;
 
                         // Now loop through and set any middle steps to continue the tie
                         for (; _num_steps<(uint)_tie_end_step; _num_steps++) {
-                            _seq_steps[_num_steps].step_type = StepType::TIE;
+                            _edit_steps.steps[_num_steps].step_type = StepType::TIE;
                             _set_seq_step_param(_num_steps);
                         }
 
                         // Set the last step to indicate this is the last step in the tie
                         DEBUG_BASEMGR_MSG("End Tie: " << _num_steps);
-                        _seq_steps[_num_steps].step_type = StepType::END_TIE;
+                        _edit_steps.steps[_num_steps].step_type = StepType::END_TIE;
                         _set_seq_step_param(_num_steps);
                     }
                     else {
@@ -278,9 +286,11 @@ void SequencerManager::process_midi_event_direct(const snd_seq_event_t *event)
                         _set_seq_step_param(_num_steps);
                     }
 
-                    // Increment for the next step
+                    // Increment for the next step, and publish the programmed steps
                     _num_steps++;
                     _step_note_index = 0;
+                    _edit_steps.num_steps = _num_steps;
+                    _edit_steps_pending = true;
                     if (_num_steps < _max_steps) {
                         // If we just processed a tie, reset both tie step switches
                         if ((_tie_start_step != -1) && (_tie_end_step != -1)) {
@@ -384,13 +394,24 @@ void SequencerManager::process_midi_event_direct(const snd_seq_event_t *event)
 void SequencerManager::_process_param_changed_event(const ParamChange &param_change)
 {
     // Get the param, check if it exists and is for the Sequencer
-    const Param *param = utils::get_param(param_change.path.c_str());
+    const Param *param = utils::get_param_from_handle(param_change.handle);
     if (param && ((param->module == module()) || (param->module == NinaModule::KEYBOARD))) {
-        // Get the Sequencer mutex
-        std::lock_guard<std::mutex> guard(utils::seq_mutex());
-        
-        // Process the param value
-        _process_param_value(*param, param_change.value, param_change.from_module);
+        // Is this a Sequencer step param?
+        if (_is_seq_step_param(*param)) {
+            // Get the edit steps mutex - the step is edited without the Sequencer mutex, so
+            // the tempo thread is never waiting on the edit
+            std::lock_guard<std::mutex> guard(_edit_steps_mutex);
+
+            // Process the step param
+            _process_seq_step_param(*param);
+        }
+        else {
+            // Get the Sequencer mutex
+            std::lock_guard<std::mutex> guard(utils::seq_mutex());
+            
+            // Process the param value
+            _process_param_value(*param, param_change.value, param_change.from_module);
+        }
     }
 }
 
@@ -401,32 +422,48 @@ void SequencerManager::_process_presets(bool from_ab_toggle)
 {
     // If not from an A/B toggle - or layer change
     if (!from_ab_toggle) {    
-        // Get the mutex lock
-        std::unique_lock<std::mutex> lk(utils::seq_mutex());
-
-        // The Program mode in the sequencer should be reset whenever the presets
-        // are loaded
-        auto *param =utils::get_param(Param::ParamPath(this, REC_PARAM_NAME).c_str());
-        if (param)
         {
-            // Reset the sequencer
-            param->set_value((float)false);
+            // Get the mutex lock
+            std::unique_lock<std::mutex> lk(utils::seq_mutex());
+
+            // The Program mode in the sequencer should be reset whenever the presets
+            // are loaded
+            auto *param =utils::get_param(Param::ParamPath(this, REC_PARAM_NAME).c_str());
+            if (param)
+            {
+                // Reset the sequencer
+                param->set_value((float)false);
+            }
+
+            // Reset the sequencer settings
+            // Note: The current steps are played until the preset steps are published
+            _step_note_index = 0;
+            _tie_start_step = -1;
+            _tie_end_step = -1;
+            _played_notes.clear();
+
+            // Parse the Sequencer params, except the steps
+            for (const Param *p : utils::get_params(module()))
+            {
+                // Process the initial param value
+                if (!_is_seq_step_param(*p)) {
+                    _process_param_value(*p, p->get_value());
+                }
+            }
         }
 
-        // Reset the sequencer settings
-        _num_steps = 0;
-        _step_note_index = 0;
-        _base_note = 0xFF;
-        _tie_start_step = -1;
-        _tie_end_step = -1;
+        // Get the edit steps mutex, and parse the Sequencer step params into the edit
+        // steps - this is done without the Sequencer mutex, so the tempo thread keeps
+        // playing the current steps until the preset steps are published at the next
+        // step boundary
+        std::lock_guard<std::mutex> guard(_edit_steps_mutex);
         _reset_seq_steps();
-        _played_notes.clear();
-
-        // Parse the Sequencer params
         for (const Param *p : utils::get_params(module()))
         {
-            // Process the initial param value
-            _process_param_value(*p, p->get_value());
+            // Process the step param
+            if (_is_seq_step_param(*p)) {
+                _process_seq_step_param(*p);
+            }
         }
     }    
 }
@@ -462,10 +499,13 @@ void SequencerManager::_process_system_func_event(const SystemFunc &system_func)
                             _tie_end_step = -1;
                         }
 
-                        // Now add the rest
-                        _seq_steps[_num_steps].step_type = StepType::REST;
+                        // Now add the rest, and publish the programmed steps
+                        std::lock_guard<std::mutex> edit_guard(_edit_steps_mutex);
+                        _edit_steps.steps[_num_steps].step_type = StepType::REST;
                         _set_seq_step_param(_num_steps);
                         _num_steps++;
+                        _edit_steps.num_steps = _num_steps;
+                        _edit_steps_pending = true;
                         _step_note_index = 0;
                         if (_num_steps < _max_steps) {
                             _set_multifn_switch((_num_steps - 1), false);
@@ -659,76 +699,8 @@ void SequencerManager::_process_param_value(const Param& param, float value, Nin
 
             case SequencerParamId::STEP_1_ID:
             default:
-                // Processing for sequencer steps
-                // Ensure the step ID is valid
-                if ((uint)param.param_id < (SequencerParamId::STEP_1_ID + _max_steps)) {
-                    auto step_index = param.param_id - SequencerParamId::STEP_1_ID;
-
-                    // Reset the number of notes for this step
-                    _seq_steps[step_index].num_notes = -1;
-
-                    // Must be a string param
-                    if (param.str_param && (param.get_str_value().size() == (2 + (SeqStep::max_notes_per_step * 2)))) {
-                        auto notes = param.get_str_value();
-                        bool valid_step = true;
-
-                        // Get the note attributes
-                        auto str_attr = notes.substr(0, 2);
-                        auto attr = std::stoi(str_attr, nullptr, 16);
-
-                        // Is this a normal or start tie note
-                        if ((attr == 0) || (attr == TIE_START_STEP)) {
-                            // Set the note type
-                            _seq_steps[step_index].step_type = ((attr == TIE_START_STEP) ? StepType::START_TIE : StepType::NORMAL);
-
-                            // Process the notes for this step
-                            for (uint i=0; i<SeqStep::max_notes_per_step; i++) {
-                                auto str_note = notes.substr((2 + (i*2)), 2);
-                                auto note = std::stoi(str_note, nullptr, 16);
-
-                                // If this step has no note, stop processing notes for this step
-                                if (note == 0xFF) {
-                                    if (i == 0) {
-                                        valid_step = false;
-                                    }
-                                    break;
-                                }
-
-                                // If this is the first note of step 1, set the base note
-                                if ((step_index == 0) && (i == 0)) {
-                                    _preset_base_note = note;
-                                }
-
-                                // Convert the key to a char and insert into the step sequence
-                                snd_seq_event_t ev;
-                                snd_seq_ev_clear(&ev);
-                                snd_seq_ev_set_noteon(&ev, 0, (note - _preset_base_note), 127);
-                                _seq_steps[step_index].notes[i] = ev;
-                                _seq_steps[step_index].num_notes = i + 1;
-                            }
-                        }
-                        // Is this a tie note
-                        else if (attr == TIE_STEP) {
-                            _seq_steps[step_index].step_type = StepType::TIE;
-                        }
-                        // Is this an end tie note
-                        else if (attr == TIE_END_STEP) {
-                            _seq_steps[step_index].step_type = StepType::END_TIE;
-                        }
-                        // Is this a rest note
-                        else if (attr == REST_STEP) {
-                            _seq_steps[step_index].step_type = StepType::REST;
-                        }
-
-                        // If this step is valid, update the number of steps (and base note if not set)
-                        if (valid_step) {
-                            _num_steps = step_index + 1;
-                            if ((step_index == 0) && (_base_note == 0xFF)) {
-                                _base_note = _preset_base_note;
-                            }
-                        }
-                    }
-                }
+                // No specific processing
+                // Note: The step params are processed by _process_seq_step_param
                 break;         
         }        
     }
@@ -739,7 +711,8 @@ void SequencerManager::_process_param_value(const Param& param, float value, Nin
 //----------------------------------------------------------------------------
 void SequencerManager::_process_tempo_event()
 {
-    uint pulse_count = 0;
+    int pulse_count = 0;
+    uint64_t tick_count = ClockEngine::TickCount();
 
 	// Do forever until stopped
 	while (true) {
@@ -751,16 +724,32 @@ void SequencerManager::_process_tempo_event()
 
         // If the FSM is running
         if (_fsm_running) {
-            // Has the FSM been reset or the required number of tempo pulses reached?
-            if (_reset_fsm || (++pulse_count >= _note_duration_pulse_count)) {
-                // Process the FSN
+            // Count the clock ticks since the last wake - this includes any ticks signalled
+            // while the FSM was being processed, and excludes any wakes that were not ticks
+            uint64_t ticks = ClockEngine::TickCount();
+            pulse_count += ticks - tick_count;
+            tick_count = ticks;
+
+            // Has the FSM been reset, or is the required number of tempo pulses reached within
+            // the lookahead?
+            int note_duration_pulse_count = _note_duration_pulse_count;
+            if (_reset_fsm || ((pulse_count + (int)SCHEDULED_NOTE_LOOKAHEAD_TICKS) >= note_duration_pulse_count)) {
+                // Process the FSM, scheduling the notes sent for the tick they are due - if the
+                // FSM has been reset they are sent now
+                _schedule_tick = (!_reset_fsm && (pulse_count < note_duration_pulse_count)) ?
+                                    (ticks + (note_duration_pulse_count - pulse_count)) : 0;
                 bool start_playing = _process_fsm();
+                _schedule_tick = 0;
 
-                // Set the next note duration pulse count to check
+                // Set the next note duration pulse count to check, counting from the tick the
+                // notes are due
                 // Note: Wait for one MIDI clock before when we start playing - we do this to ensure
                 // the clock is running before sending note-on events                
+                pulse_count = _reset_fsm ? 0 : (pulse_count - note_duration_pulse_count);
                 _note_duration_pulse_count = _tempo_pulse_count - _note_duration_pulse_count;
-                pulse_count = start_playing ? (_note_duration_pulse_count - 1) : 0;
+                if (start_playing) {
+                    pulse_count += _note_duration_pulse_count - 1;
+                }
                 _reset_fsm = false;
             }
         }
@@ -778,6 +767,14 @@ bool SequencerManager::_process_fsm()
 {
     SeqState prev_seq_state = _seq_state;
 
+    // Publish any edited steps if at a step boundary (not between a step note-on and
+    // note-off) - if they cannot be published without waiting on an editor, they are
+    // published at the next step boundary, and if not playing any state change is
+    // processed then
+    if ((_seq_state != SeqState::PLAYING_NOTEON) && !_publish_seq_steps() && (_seq_state < SeqState::PLAYING_NOTEON)) {
+        return false;
+    }
+
     // Has the program state changed?
     if (_prev_program != _program)
     {
@@ -869,7 +866,10 @@ bool SequencerManager::_process_fsm()
             _base_note = 0xFF;
             _tie_start_step = -1;
             _tie_end_step = -1;
-            _reset_seq_steps();
+            {
+                std::lock_guard<std::mutex> edit_guard(_edit_steps_mutex);
+                _reset_seq_steps();
+            }
             _played_notes.clear();
             _set_multifn_switch(0, true);
         }
@@ -962,21 +962,20 @@ void SequencerManager::_send_seq_note()
 
     // If the tie state is normal or start tie, then play the notes ON
     // normally
-    if (_seq_steps[_step].step_type <= StepType::START_TIE) {
+    auto& step = _play_steps.steps[_step];
+    if (step.step_type <= StepType::START_TIE) {
         // Get the next Sequencer notes to play and send them
         _sent_notes.clear();
-        if (_seq_steps[_step].num_notes > 0) {
+        for (uint i=0; i<step.num_notes; i++) {
             // Play each note-on
-            for (uint i=0; i<(uint)_seq_steps[_step].num_notes; i++) {
-                auto note_on = _seq_steps[_step].notes[i];
-                note_on.data.note.note += _base_note;
-                if (note_on.data.note.note > MAX_MIDI_NOTE)
-                    note_on.data.note.note = MAX_MIDI_NOTE;
-                note_on.data.note.velocity = 127;      
-                note_on.data.note.channel = _current_midi_channel;
-                _send_note(note_on);
-                _sent_notes.push_back(note_on);
-            }
+            snd_seq_event_t note_on;
+            unsigned char note = step.notes[i].note + _base_note;
+            if (note > MAX_MIDI_NOTE)
+                note = MAX_MIDI_NOTE;
+            snd_seq_ev_clear(&note_on);
+            snd_seq_ev_set_noteon(&note_on, _current_midi_channel, note, step.notes[i].velocity);
+            _send_note(note_on);
+            _sent_notes.push_back(note_on);
         }
     }
 }
@@ -988,8 +987,8 @@ void SequencerManager::_stop_seq_note()
 {
     // If the tie state is either none or end tie, play all the recently played 
     // notes, except as a note-off with 0 velocity
-    if ((_seq_steps[_step].step_type == StepType::NORMAL) || 
-        (_seq_steps[_step].step_type == StepType::END_TIE)) {
+    if ((_play_steps.steps[_step].step_type == StepType::NORMAL) || 
+        (_play_steps.steps[_step].step_type == StepType::END_TIE)) {
         // Send the note OFF for each note
         _stop_seq();
     }
@@ -1043,8 +1042,9 @@ void SequencerManager::_send_note(const snd_seq_event_t &note)
     //else
     //    DEBUG_BASEMGR_MSG("Send note: " << (int)note.data.note.note << ": OFF");
 
-    // Send the note directly to the Arpeggiator
-    utils::get_manager(NinaModule::ARPEGGIATOR)->process_midi_event_direct(&note);
+    // Send the note to the Arpeggiator, either now or scheduled for the tick it is due
+    // if being sent ahead by the FSM
+    ScheduledNoteQueue::Send(ScheduledNoteSource::SEQUENCER, _schedule_tick, note);
 }
 
 //----------------------------------------------------------------------------
@@ -1104,13 +1104,129 @@ void SequencerManager::_reset_multifn_switches(bool force)
 
 //----------------------------------------------------------------------------
 // _reset_seq_steps
+// Note: The edit steps mutex must be held by the caller
 //----------------------------------------------------------------------------
 void SequencerManager::_reset_seq_steps()
 {
     // Reset the sequence steps
     for (uint i=0; i<_max_steps; i++) {
-        _seq_steps.at(i).num_notes = -1;
-        _seq_steps.at(i).step_type = StepType::NORMAL;
+        _edit_steps.steps.at(i).num_notes = 0;
+        _edit_steps.steps.at(i).step_type = StepType::NORMAL;
+    }
+    _edit_steps.num_steps = 0;
+    _edit_steps.base_note = 0xFF;
+    _edit_steps.reset = true;
+    _edit_steps_pending = true;
+}
+
+//----------------------------------------------------------------------------
+// _publish_seq_steps
+// Note: The SEQ mutex must be held by the caller
+//----------------------------------------------------------------------------
+bool SequencerManager::_publish_seq_steps()
+{
+    // Are there any edited steps to publish?
+    if (_edit_steps_pending) {
+        // Copy the edited steps to the play steps, if not being edited
+        std::unique_lock<std::mutex> lk(_edit_steps_mutex, std::try_to_lock);
+        if (!lk.owns_lock()) {
+            return false;
+        }
+        _play_steps = _edit_steps;
+        _edit_steps.reset = false;
+        _edit_steps_pending = false;
+        lk.unlock();
+
+        // Update the number of steps, and if the steps have been reset (or there is no
+        // base note) set the base note of the steps
+        _num_steps = _play_steps.num_steps;
+        _num_active_steps = std::min(_num_selected_steps, _num_steps);
+        if ((_play_steps.reset || (_base_note == 0xFF)) && (_play_steps.base_note != 0xFF)) {
+            _base_note = _play_steps.base_note;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _is_seq_step_param
+//----------------------------------------------------------------------------
+bool SequencerManager::_is_seq_step_param(const Param& param) const
+{
+    // Is this a valid Sequencer step param?
+    return (param.module == module()) && 
+           ((uint)param.param_id >= SequencerParamId::STEP_1_ID) &&
+           ((uint)param.param_id < (SequencerParamId::STEP_1_ID + _max_steps));
+}
+
+//----------------------------------------------------------------------------
+// _process_seq_step_param
+// Note: The edit steps mutex must be held by the caller
+//----------------------------------------------------------------------------
+void SequencerManager::_process_seq_step_param(const Param& param)
+{
+    auto step_index = param.param_id - SequencerParamId::STEP_1_ID;
+    auto& step = _edit_steps.steps[step_index];
+
+    // Reset the number of notes for this step
+    step.num_notes = 0;
+
+    // Must be a string param
+    if (param.str_param && (param.get_str_value().size() == (2 + (SeqStep::max_notes_per_step * 2)))) {
+        auto notes = param.get_str_value();
+        bool valid_step = true;
+
+        // Get the note attributes
+        auto str_attr = notes.substr(0, 2);
+        auto attr = std::stoi(str_attr, nullptr, 16);
+
+        // Is this a normal or start tie note
+        if ((attr == 0) || (attr == TIE_START_STEP)) {
+            // Set the note type
+            step.step_type = ((attr == TIE_START_STEP) ? StepType::START_TIE : StepType::NORMAL);
+
+            // Process the notes for this step
+            for (uint i=0; i<SeqStep::max_notes_per_step; i++) {
+                auto str_note = notes.substr((2 + (i*2)), 2);
+                auto note = std::stoi(str_note, nullptr, 16);
+
+                // If this step has no note, stop processing notes for this step
+                if (note == 0xFF) {
+                    if (i == 0) {
+                        valid_step = false;
+                    }
+                    break;
+                }
+
+                // If this is the first note of step 1, set the base note
+                if ((step_index == 0) && (i == 0)) {
+                    _edit_steps.base_note = note;
+                }
+
+                // Insert the note into the step sequence
+                // Note: The step notes are always played at full velocity
+                step.notes[i] = {(uint8_t)(note - _edit_steps.base_note), 127};
+                step.num_notes = i + 1;
+            }
+        }
+        // Is this a tie note
+        else if (attr == TIE_STEP) {
+            step.step_type = StepType::TIE;
+        }
+        // Is this an end tie note
+        else if (attr == TIE_END_STEP) {
+            step.step_type = StepType::END_TIE;
+        }
+        // Is this a rest note
+        else if (attr == REST_STEP) {
+            step.step_type = StepType::REST;
+        }
+
+        // If this step is valid, update the number of steps
+        if (valid_step) {
+            _edit_steps.num_steps = step_index + 1;
+        }
+        _edit_steps_pending = true;
     }
 }
 
@@ -1127,16 +1243,16 @@ void SequencerManager::_set_seq_step_param(uint step)
         char str_note[3];
 
         // If this is normal notes or the start of a tie
-        if (_seq_steps[_num_steps].step_type <= StepType::START_TIE) {
+        if (_edit_steps.steps[_num_steps].step_type <= StepType::START_TIE) {
             // Set the step attributes
-            attr = ((_seq_steps[_num_steps].step_type == StepType::START_TIE) ? TIE_START_STEP : 0);
+            attr = ((_edit_steps.steps[_num_steps].step_type == StepType::START_TIE) ? TIE_START_STEP : 0);
             std::sprintf(str_note, "%02X", (char)attr);
             step_notes.replace(0, 2, str_note);             
 
             // Process each note
             for (uint i=0; i<_step_note_index; i++) {
-                unsigned char note = _seq_steps[_num_steps].notes[i].data.note.note;
-                note += _base_note;
+                unsigned char note = _edit_steps.steps[_num_steps].notes[i].note;
+                note += _edit_steps.base_note;
                 if (note > MAX_MIDI_NOTE) {
                     note = MAX_MIDI_NOTE;
                 }
@@ -1146,15 +1262,15 @@ void SequencerManager::_set_seq_step_param(uint step)
         }
         else {
             // If this is a tie step
-            if (_seq_steps[_num_steps].step_type == StepType::TIE) {
+            if (_edit_steps.steps[_num_steps].step_type == StepType::TIE) {
                 attr = TIE_STEP;
             }
             // If this is an end tie step
-            else if (_seq_steps[_num_steps].step_type == StepType::END_TIE) {
+            else if (_edit_steps.steps[_num_steps].step_type == StepType::END_TIE) {
                 attr = TIE_END_STEP;
             }
             // If this is a rest ntoe
-            else if (_seq_steps[_num_steps].step_type == StepType::REST) {
+            else if (_edit_steps.steps[_num_steps].step_type == StepType::REST) {
                 attr = REST_STEP;
             }
 
@@ -10,6 +10,7 @@
 #define _SEQUENCER_MANAGER_H
 
 #include <atomic>
+#include <mutex>
 #include "base_manager.h"
 #include "event.h"
 #include "event_router.h"
@@ -50,13 +51,33 @@ enum class StepType
     REST
 };
 
+// Sequencer Step Note
+// The note is held as the offset from the base note of the steps
+struct SeqStepNote
+{
+    uint8_t note;
+    uint8_t velocity;
+};
+
 // Sequencer Step
 struct SeqStep
 {
     static const uint max_notes_per_step = 12;
     StepType step_type;
-    std::array<snd_seq_event_t, max_notes_per_step> notes;
-    int num_notes;
+    uint8_t num_notes;
+    std::array<SeqStepNote, max_notes_per_step> notes;
+};
+
+// Sequencer Steps
+// The Sequencer steps are double-buffered - the steps are edited in one buffer, and
+// copied to the buffer played by the tempo thread at a step boundary
+struct SeqSteps
+{
+    static const uint max_steps = 16;
+    std::array<SeqStep, max_steps> steps;
+    uint num_steps;
+    unsigned char base_note;
+    bool reset;
 };
 
 // Sequencer Manager class
@@ -77,7 +98,7 @@ public:
 
 private:
     // Private variables
-    static const uint _max_steps = 16;
+    static const uint _max_steps = SeqSteps::max_steps;
     EventListener *_midi_param_change_listener;
     EventListener *_sfc_listener;
     EventListener *_fm_reload_presets_listener;
@@ -87,9 +108,13 @@ private:
     std::thread *_tempo_event_thread;
     bool _fsm_running;
     bool _reset_fsm;
+    uint64_t _schedule_tick;
     uint _tempo_pulse_count;
     uint _note_duration_pulse_count;
-    std::array<SeqStep, _max_steps> _seq_steps;
+    std::mutex _edit_steps_mutex;
+    SeqSteps _edit_steps;
+    std::atomic<bool> _edit_steps_pending;
+    SeqSteps _play_steps;
     uint _num_steps;
     uint _num_active_steps;
     uint _num_selected_steps;
@@ -105,7 +130,6 @@ private:
     snd_seq_event_t _note_on;
     std::vector<unsigned char> _played_notes;
     unsigned char _base_note;
-    unsigned char _preset_base_note;
     uint _step_note_index;
     std::vector<snd_seq_event_t> _sent_notes;
     Param *_num_steps_param;
@@ -129,6 +153,9 @@ private:
     void _set_multifn_switch(uint index, bool on);
     void _reset_multifn_switches(bool force=false);
     void _reset_seq_steps();
+    bool _publish_seq_steps();
+    bool _is_seq_step_param(const Param& param) const;
+    void _process_seq_step_param(const Param& param);
     void _set_seq_step_param(uint step);
 };
 
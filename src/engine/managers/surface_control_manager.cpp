@@ -15,18 +15,20 @@
 #include "surface_control_manager.h"
 #include "utils.h"
 #include "logger.h"
+#include "trace_log.h"
 
 // Constants
-constexpr uint POLL_THRESH_COUNT = 300;
-constexpr uint SMALL_MOVEMENT_THRESHOLD_MAX_COUNT  = 20;
-constexpr int KNOB_MOVED_TO_TARGET_POLL_SKIP_COUNT = 6;
-constexpr int TAP_DETECTED_POLL_SKIP_COUNT         = 10;
+// Note: The knob poll counts are converted from these times using the knob poll
+// interval, so that they are the same regardless of how often a knob is polled
+constexpr uint POLL_THRESH_TIME                     = std::chrono::milliseconds(9000).count();
+constexpr uint SMALL_MOVEMENT_THRESHOLD_MAX_TIME    = std::chrono::milliseconds(600).count();
+constexpr uint KNOB_MOVED_TO_TARGET_POLL_SKIP_TIME  = std::chrono::milliseconds(180).count();
+constexpr uint KNOB_RECENT_MOVEMENT_TIME            = std::chrono::milliseconds(500).count();
+constexpr uint TAP_DETECTED_POLL_SKIP_TIME          = std::chrono::milliseconds(300).count();
 #ifndef TESTING_SURFACE_HARDWARE
-constexpr int SURFACE_HW_POLL_SECONDS     = 0;
-constexpr int SURFACE_HW_POLL_NANOSECONDS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(30)).count();
+constexpr uint SURFACE_HW_POLL_TIME                 = std::chrono::milliseconds(30).count();
 #else
-constexpr int SURFACE_HW_POLL_SECONDS    = std::chrono::seconds(1).count();
-constexpr int SURFACE_HW_POLL_NANOSECONDS = 0;
+constexpr uint SURFACE_HW_POLL_TIME                 = std::chrono::milliseconds(std::chrono::seconds(1)).count();
 #endif
 constexpr uint KNOB_LARGE_MOVEMENT_TIME_THRESHOLD = std::chrono::milliseconds(2000).count();
 constexpr uint SWITCH_PUSH_LATCH_THRESHOLD        = std::chrono::milliseconds(500).count();
@@ -59,7 +61,12 @@ SurfaceControlManager::SurfaceControlManager(EventRouter *event_router) :
         _knob_controls[i].small_movement_threshold_count = 0;
         _knob_controls[i].polls_since_last_threshold_hit = 0;
         _knob_controls[i].moving_to_target = false;
+        _knob_controls[i].target_position = 0;
+        _knob_controls[i].at_target_position = false;
+        _knob_controls[i].target_position_pending = false;
         _knob_controls[i].moving_to_large_threshold = false;
+        _knob_controls[i].poll_interval = 1;
+        _knob_controls[i].polls_since_last_poll = 0;
         if ((i == 0) || (i == 8) || (i == 31) || (i == 29)) {
             // The data, tempo, morph, and effects knobs are NOT morphable
             // Note: Shouldn't use magic numbers here
@@ -98,6 +105,14 @@ SurfaceControlManager::SurfaceControlManager(EventRouter *event_router) :
     _surface_control_init = false;
     _morph_knob_param = 0;
     _presets_reloaded = false;
+    _poll_interval = 1;
+    _main_poll_interval = 1;
+    _knob_max_poll_interval = 1;
+    _poll_thresh_count = 0;
+    _small_movement_threshold_max_count = 0;
+    _knob_moved_to_target_poll_skip_count = 0;
+    _knob_recent_movement_count = 0;
+    _trace_id = NO_LATENCY_TRACE_ID;
 
     // Register the Surface Control params
     _register_params();	    
@@ -322,6 +337,10 @@ void SurfaceControlManager::process_surface_control()
     bool reinit_sfc_control_initiated = false;
     bool reinit_sfc_control = false;
     Param *morph_mode_param = 0;
+    bool poll_knobs[NUM_PHYSICAL_KNOBS];
+    uint main_poll_elapsed = 0;
+    bool morph_knob_in_default_state = true;
+    bool morph_params_changed = false;
 
     // Initialise the knob and switch state arrays to zeros
     std::memset(knob_states, 0, sizeof(knob_states));
@@ -337,10 +356,8 @@ void SurfaceControlManager::process_surface_control()
         morph_mode_param = utils::get_param_from_ref(utils::ParamRef::MORPH_MODE);
     }
 
-    // Set the thread poll time (in nano-seconds)
-    std::memset(&poll_time, 0, sizeof(poll_time));
-    poll_time.tv_sec = SURFACE_HW_POLL_SECONDS;
-    poll_time.tv_nsec = SURFACE_HW_POLL_NANOSECONDS;   
+    // Set the thread poll time, and the knob poll scheduling
+    _init_poll_scheduler(poll_time);
 
     // Block the thread for the poll time
 #ifndef NO_XENOMAI
@@ -356,11 +373,21 @@ void SurfaceControlManager::process_surface_control()
             // Get the mutex
             std::lock_guard<std::mutex> lock(_mutex);
 
-            bool morph_knob_in_default_state = true;
-            bool morph_params_changed = false;
+            // Is this a main poll?
+            // The switches, morph and LEDs are processed on each main poll, the knobs are
+            // polled at their own scheduled interval
+            // Note: The elapsed time is carried over, so that the main poll interval is kept
+            // on average if it is not a multiple of the thread poll interval
+            main_poll_elapsed += _poll_interval;
+            bool main_poll = (main_poll_elapsed >= _main_poll_interval);
+            if (main_poll) {
+                main_poll_elapsed -= _main_poll_interval;
+                morph_knob_in_default_state = true;
+                morph_params_changed = false;
+            }
 
             // If not in maintenance mode
-            if (!utils::maintenance_mode()) {
+            if (main_poll && !utils::maintenance_mode()) {
                 // Re-init the panel?
                 if (reinit_sfc_control)
                 {
@@ -407,13 +434,20 @@ void SurfaceControlManager::process_surface_control()
                 if (utils::is_morph_on() && (morph_state || prev_morph_state) && morph_knob_in_default_state) {
                     // Yes - if we are in morph dance mode, retrieve the state params
                     if (utils::get_morph_mode(morph_mode_param->get_value()) == MorphMode::DANCE) {
-                        // Dance mode, retrieve the params
+                        // Dance mode, blend the state params locally from the morph knob position
+                        // if the layer states are available, otherwise retrieve them from the DAW
                         auto s = std::chrono::steady_clock::now();
-                        morph_params_changed = static_cast<DawManager *>(utils::get_manager(NinaModule::DAW))->get_patch_state_params();
+                        uint layer_num = utils::get_current_layer_info().layer_num();
+                        if (utils::morph_engine()->layer_states_set(layer_num)) {
+                            morph_params_changed = utils::morph_engine()->blend(layer_num, _morph_knob_param->get_value());
+                        }
+                        else {
+                            morph_params_changed = static_cast<DawManager *>(utils::get_manager(NinaModule::DAW))->get_patch_state_params();
+                        }
                         auto f = std::chrono::steady_clock::now();
                         float tt = std::chrono::duration_cast<std::chrono::microseconds>(f - s).count();
                         if(tt > 10000) {
-                            DEBUG_MSG("get_patch_state_params time (us): " << tt);
+                            NINA_TRACE_DEBUG(module(), "Dance mode morph time (us): {}", tt);
                         }
                     }
                 }
@@ -421,14 +455,19 @@ void SurfaceControlManager::process_surface_control()
                 utils::morph_unlock();
             }
 
-            // Lock the Surface Control
+            // Lock the Surface Control, and save the time the states are read for
+            // latency tracing
+            _knob_states_read_time = std::chrono::steady_clock::now();
             _surface_control->lock();
 
             // Read the switch states
-            switch_states_res = _surface_control->read_switch_states(switch_physical_states);
+            if (main_poll) {
+                switch_states_res = _surface_control->read_switch_states(switch_physical_states);
+            }
 
-            // Request the knob states
-            knob_states_res = _surface_control->request_knob_states(); 
+            // Request the state of each knob due to be polled
+            _get_knob_polls(poll_knobs);
+            knob_states_res = _surface_control->request_knob_states(poll_knobs); 
             if (knob_states_res == 0)
             {
                 // Read the knob states
@@ -438,8 +477,11 @@ void SurfaceControlManager::process_surface_control()
             // Unlock the Surface Control
             _surface_control->unlock();
 
+            // Confirm any knob target positions that have now been written
+            _check_knob_target_positions();
+
             // If not in maintenance mode
-            if (!utils::maintenance_mode()) {
+            if (!utils::maintenance_mode() && poll_knobs[_morph_knob_num]) {
                 // Always process the moph knob
                 _process_physical_knob(_knob_controls[_morph_knob_num], knob_states[_morph_knob_num]);
             }
@@ -449,7 +491,7 @@ void SurfaceControlManager::process_surface_control()
             if (!morph_params_changed)
             {
                 // Switches read OK?
-                if (switch_states_res == 0) {
+                if (main_poll && (switch_states_res == 0)) {
                     // Process each switch physical
                     for (int i=0; i<NUM_PHYSICAL_SWITCHES; i++) {
                         // Process the switch
@@ -461,7 +503,7 @@ void SurfaceControlManager::process_surface_control()
                 }
 
                 // Are all three soft buttons pressed?
-                if (_switch_controls[0].logical_state == 1 && _switch_controls[1].logical_state == 1 &&
+                if (main_poll && _switch_controls[0].logical_state == 1 && _switch_controls[1].logical_state == 1 &&
                     _switch_controls[2].logical_state == 1)
                 {
                     if (!poweroff)
@@ -486,7 +528,7 @@ void SurfaceControlManager::process_surface_control()
                     }
                 }
                 // Are ALT & ENTER pressed?
-                else if (_switch_controls[0].logical_state == 0 && _switch_controls[1].logical_state == 1 && 
+                else if (main_poll && _switch_controls[0].logical_state == 0 && _switch_controls[1].logical_state == 1 && 
                         _switch_controls[2].logical_state == 1)
                 {
                     if (!reinit_sfc_control_initiated)
@@ -504,7 +546,7 @@ void SurfaceControlManager::process_surface_control()
                         }
                     }
                 }
-                else
+                else if (main_poll)
                 {
                     poweroff_initiated = false;
                     reinit_sfc_control_initiated = false;
@@ -512,7 +554,7 @@ void SurfaceControlManager::process_surface_control()
 
                 // Process each knob position (except for the morph knob if morphing)
                 for (int i=0; i<NUM_PHYSICAL_KNOBS; i++) {
-                    if (_surface_control->knob_is_active(i) && 
+                    if (_surface_control->knob_is_active(i) && poll_knobs[i] &&
                         ((i != _morph_knob_num) || !morph_knob_in_default_state)) {
                         _process_physical_knob(_knob_controls[i], knob_states[i]);
                     }
@@ -522,17 +564,23 @@ void SurfaceControlManager::process_surface_control()
             {
                 // Morphing
                 // Process each knob position
+                // Note: The knobs are morphed on each main poll
                 for (int i=0; i<NUM_PHYSICAL_KNOBS; i++) {
                     if (_surface_control->knob_is_active(i)) {
                         // Morph the knob or process normally
-                        _knob_controls[i].morphable ?
-                            _morph_control(SurfaceControlType::KNOB, i) :
+                        if (_knob_controls[i].morphable) {
+                            if (main_poll) {
+                                _morph_control(SurfaceControlType::KNOB, i);
+                            }
+                        }
+                        else if (poll_knobs[i]) {
                             _process_physical_knob(_knob_controls[i], knob_states[i]);
+                        }
                     }
                 }
 
                 // Process each switch
-                for (int i=0; i<NUM_PHYSICAL_SWITCHES; i++) {
+                for (int i=0; (i<NUM_PHYSICAL_SWITCHES) && main_poll; i++) {
                     // If morphable
                     if (_switch_controls[i].morphable) {
                         // Norph the switch
@@ -548,17 +596,26 @@ void SurfaceControlManager::process_surface_control()
                 }                        
             }
             
-            // Update the read knob positions for the next poll processing
-            for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
-                _knob_controls[i].position = knob_states[i].position;
+            // Schedule the next poll of each polled knob, and update the read knob positions
+            // for the next poll processing
+            for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++) {
+                if (poll_knobs[i]) {
+                    _schedule_knob_poll(_knob_controls[i], knob_states[i]);
+                    _knob_controls[i].position = knob_states[i].position;
+                }
+            }
 
             // Reset the presets loaded flag, if set
-            if (_presets_reloaded) {
+            if (_presets_reloaded && main_poll) {
                 _presets_reloaded = false;
             }
 
             // Always commit the LED states so that they are guaranteed to be in the correct state
-            _commit_led_control_states();
+            // Note: Any LED changes made since the last main poll (including by the LED pulse
+            // timers) are committed together, and nothing is written if the LEDs are unchanged
+            if (main_poll) {
+                _commit_led_control_states();
+            }
         }
 
         // Sleep to give other tasks time to run
@@ -572,7 +629,7 @@ void SurfaceControlManager::process_surface_control()
 void SurfaceControlManager::_process_param_changed_event(const ParamChange &param_change)
 {
     // If this is a Surface Control param change
-    Param *param = utils::get_param(param_change.path.c_str());
+    Param *param = utils::get_param_from_handle(param_change.handle);
     if (param && (param->module == NinaModule::SURFACE_CONTROL))
     {
         // Process the Surface Control param change
@@ -808,7 +865,7 @@ void SurfaceControlManager::_process_sfc_func(const SurfaceControlFunc &sfc_func
                             _set_knob_control_position(static_cast<KnobParam *>(sfc_param));
 
                             // Create the control param change event
-                            auto mapped_param_change = ParamChange(p->get_path(), p->get_value(), module());
+                            auto mapped_param_change = ParamChange(p->handle, p->get_value(), module());
                             _event_router->post_param_changed_event(new ParamChangedEvent(mapped_param_change));                            
                         }
                         // Are we changing a switch control value?
@@ -841,8 +898,12 @@ void SurfaceControlManager::_set_knob_control_position_from_preset(uint num)
             _set_knob_control_haptic_mode(param);
         }
 
-        // Now set the knob position from the param
-        _set_knob_control_position(param);
+        // Now set the knob position from the param - unless the knob is already at this
+        // position (set and not moved since), in which case there is no need to drive the motor
+        auto& knob_control = _knob_controls[num];
+        if (!knob_control.at_target_position || (knob_control.target_position != param->get_hw_value())) {
+            _set_knob_control_position(param);
+        }
     }
 }
 
@@ -893,17 +954,16 @@ void SurfaceControlManager::_process_sfc_param_changed(Param *param)
 //----------------------------------------------------------------------------
 // _process_param_changed_mapped_params
 //----------------------------------------------------------------------------
-void SurfaceControlManager::_process_param_changed_mapped_params(const Param *param, const Param *skip_param, bool displayed)
+void SurfaceControlManager::_process_param_changed_mapped_params(const Param *changed_param, bool displayed)
 {
-    // Get the mapped params and linked param, if any, and process them
-    auto mapped_params = param->get_mapped_params();
-    auto linked_param = param->get_linked_param();
-    for (Param *mp : mapped_params)
+    // Get the compiled mapping graph for the changed param, and process each mapped
+    // param from the param it is mapped from
+    auto mapped_param_graph = changed_param->get_mapped_param_graph();
+    for (const MappedParamDest& dest : *mapped_param_graph)
     {
-        // Because this function is recursive, we need to skip the param that
-        // caused any recursion, so it is not processed twice
-        if (skip_param && (mp == skip_param))
-            continue;
+        Param *mp = dest.param;
+        const Param *param = dest.source;
+        auto linked_param = param->get_linked_param();
 
         // Is this not a state change param?
         if (mp->type != ParamType::UI_STATE_CHANGE)
@@ -920,7 +980,7 @@ void SurfaceControlManager::_process_param_changed_mapped_params(const Param *pa
                 // Is this a Surface Control param
                 if ((mp->module == NinaModule::SURFACE_CONTROL)) {
                     // If in the current state, process it
-                    if (mp->state == utils::get_param_state(mp->get_path())) {
+                    if (utils::param_in_current_state(mp)) {
                         _process_sfc_param_changed(mp);
                     }
                 }           
@@ -930,7 +990,8 @@ void SurfaceControlManager::_process_param_changed_mapped_params(const Param *pa
                     if (current_value != mp->get_value())
                     {
                         // Send the param changed event
-                        auto mapped_param_change = ParamChange(mp->get_path(), mp->get_value(), module());
+                        auto mapped_param_change = ParamChange(mp->handle, mp->get_value(), module());
+                        mapped_param_change.trace_id = _trace_id;
                         if (displayed)
                             mapped_param_change.display = false;
                         else
@@ -1032,17 +1093,12 @@ void SurfaceControlManager::_process_param_changed_mapped_params(const Param *pa
                     if (mp->patch_param)
                     {
                         // Send the param changed event
-                        auto mapped_param_change = ParamChange(mp->get_path(), mp->get_value(), module());
+                        auto mapped_param_change = ParamChange(mp->handle, mp->get_value(), module());
                         _event_router->post_param_changed_event(new ParamChangedEvent(mapped_param_change));
                     }                                                
                 }
             }
         }
-
-        // We need to recurse each mapped param and process it
-        // Note: We don't recurse system function params as they are a system action to be performed
-        if (mp->type != ParamType::SYSTEM_FUNC)
-            _process_param_changed_mapped_params(mp, param, displayed);
     }
 }
 
@@ -1056,12 +1112,13 @@ void SurfaceControlManager::_send_control_param_change_events(const Param *param
     if (utils::is_osc_running())
     {
         // Create the control param change event
-        auto mapped_param_change = ParamChange(param->get_path(), param->get_value(), module());
+        auto mapped_param_change = ParamChange(param->handle, param->get_value(), module());
+        mapped_param_change.trace_id = _trace_id;
         _event_router->post_param_changed_event(new ParamChangedEvent(mapped_param_change));
     }
 
     // Send the mapped params changed events
-    _process_param_changed_mapped_params(param, nullptr, false);     
+    _process_param_changed_mapped_params(param, false);     
 }
 
 //----------------------------------------------------------------------------
@@ -1087,12 +1144,60 @@ void SurfaceControlManager::_set_knob_control_position(const KnobParam *param, b
 
                 // Set the target knob position in the hardware
                 int res = _surface_control->set_knob_position(num, pos, robust);
+
+                // Poll this knob at the minimum interval so that the move to target is
+                // always seen
+                _knob_controls[num].poll_interval = 1;
+
+                // Save the target position, so that the knob is not set to the same position again
+                // until it has been moved
+                // Note: The position is written asynchronously, so the knob is only at its
+                // target position once the write has been confirmed - the result returned is
+                // that of the previous position written
+                _knob_controls[num].target_position = pos;
+                _knob_controls[num].at_target_position = false;
+                _knob_controls[num].target_position_pending = true;
                 if (res < 0)
                 {
                     // Show the error
-                    //DEBUG_BASEMGR_MSG("Could not set the knob(" << num << ") position: " << res);
+                    NINA_TRACE_DEBUG(module(), "Could not set the knob({}) previous position: {}", num, res);
+                }
+                NINA_TRACE_DEBUG(module(), "Knob({}) control externally updated: {}", num, pos);
+            }
+            else
+            {
+                // The knob is not active, so its position is no longer known
+                _knob_controls[num].at_target_position = false;
+                _knob_controls[num].target_position_pending = false;
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _check_knob_target_positions
+//----------------------------------------------------------------------------
+void SurfaceControlManager::_check_knob_target_positions()
+{
+    // Check each knob with a target position still to be confirmed
+    for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+    {
+        auto& knob_control = _knob_controls[i];
+        if (knob_control.target_position_pending)
+        {
+            // Has the target position been written?
+            // If the write failed the knob is left not at its target position, so that
+            // it is set again from the next preset
+            int res = _surface_control->knob_position_result(i, knob_control.target_position);
+            if (res != -EINPROGRESS)
+            {
+                knob_control.target_position_pending = false;
+                knob_control.at_target_position = (res == 0);
+                if (res < 0)
+                {
+                    // Show the error
+                    NINA_TRACE_DEBUG(module(), "Could not set the knob({}) position: {}", i, res);
                 }
-                //DEBUG_BASEMGR_MSG("Knob(" << num << ") control externally updated: " << pos);
             }
         }
     }
@@ -1123,7 +1228,7 @@ void SurfaceControlManager::_set_knob_control_haptic_mode(const KnobParam *param
     if (res < 0)
     {
         // Error setting the knob mode
-        MSG("ERROR: Could not set a surface control knob haptic mode: " << res);
+        NINA_TRACE_ERROR(module(), "Could not set a surface control knob haptic mode: {}", res);
     }
 }
 
@@ -1143,7 +1248,7 @@ void SurfaceControlManager::_process_physical_knob(KnobControl &knob_control, co
             // Has the knob just finished moving to target?
             if (knob_control.moving_to_target) {
                 // Skip the processing of this knob for n polls, to allow the motor to settle
-                knob_control.poll_skip_count--;
+                knob_control.poll_skip_count -= std::min(knob_control.poll_skip_count, knob_control.polls_since_last_poll);
 
                 // Is this the last poll to skip?
                 if (knob_control.poll_skip_count == 0) {
@@ -1174,11 +1279,11 @@ void SurfaceControlManager::_process_physical_knob(KnobControl &knob_control, co
 
                 // Drift detection
                 // Increment the timer and check if we are outside the threshold
-                knob_control.polls_since_last_threshold_hit++;
+                knob_control.polls_since_last_threshold_hit += knob_control.polls_since_last_poll;
                 bool threshold_reached = param->hw_delta_outside_target_threshold(knob_control.position_delta,knob_control.use_large_movement_threshold);
 
                 // If we are beyond the threshold but the timer is expired, then reset the delta
-                if((knob_control.polls_since_last_threshold_hit > POLL_THRESH_COUNT) && threshold_reached)
+                if((knob_control.polls_since_last_threshold_hit > _poll_thresh_count) && threshold_reached)
                 {
                     knob_control.polls_since_last_threshold_hit = 0;
                     knob_control.position_delta = 0;
@@ -1201,13 +1306,22 @@ void SurfaceControlManager::_process_physical_knob(KnobControl &knob_control, co
                     knob_control.use_large_movement_threshold = false;
                     knob_control.small_movement_threshold_count = 0;
 
-                    // Update the knob parameter
+                    // Update the knob parameter - the knob is no longer at its set target position
                     param->set_value_from_hw(knob_state.position);
+                    knob_control.at_target_position = false;
+                    knob_control.target_position_pending = false;
 
                     // If not in maintenance mode
                     if (!utils::maintenance_mode()) {
+                        // Start a latency trace for this knob change (if sampled), recording
+                        // when the knob state was read and detected as changed
+                        _trace_id = LatencyTrace::Begin();
+                        LatencyTrace::Record(_trace_id, LatencyTraceStage::KNOB_READ, _knob_states_read_time);
+                        LatencyTrace::Record(_trace_id, LatencyTraceStage::KNOB_DETECTED);
+
                         // Send the control param change events
                         _send_control_param_change_events(param);
+                        _trace_id = NO_LATENCY_TRACE_ID;
                     }                                  
                 }
                 else {
@@ -1215,11 +1329,11 @@ void SurfaceControlManager::_process_physical_knob(KnobControl &knob_control, co
                     // If NOT using the large threshold
                     if (!knob_control.use_large_movement_threshold) {
                         // Increment the small movement threshold count
-                        knob_control.small_movement_threshold_count++;
+                        knob_control.small_movement_threshold_count += knob_control.polls_since_last_poll;
 
                         // If there have been N successive checks of this knob with no movement, reset to
                         // a large threshold
-                        if (knob_control.small_movement_threshold_count >= SMALL_MOVEMENT_THRESHOLD_MAX_COUNT) {
+                        if (knob_control.small_movement_threshold_count >= _small_movement_threshold_max_count) {
                             knob_control.use_large_movement_threshold = true;
                             knob_control.moving_to_large_threshold = false;
                         }
@@ -1242,14 +1356,81 @@ void SurfaceControlManager::_process_physical_knob(KnobControl &knob_control, co
             // Knob is moving to target - indicate this in the knob control, and set the poll skip
             // count once the knob has reached the target
             knob_control.moving_to_target = true;
-            knob_control.poll_skip_count = KNOB_MOVED_TO_TARGET_POLL_SKIP_COUNT;
+            knob_control.poll_skip_count = _knob_moved_to_target_poll_skip_count;
 
             // This is to make sure we start in the threshold exeeded state on a knob move
-            knob_control.polls_since_last_threshold_hit = POLL_THRESH_COUNT +1;
+            knob_control.polls_since_last_threshold_hit = _poll_thresh_count +1;
         }
     }
 }
 
+//----------------------------------------------------------------------------
+// _init_poll_scheduler
+//----------------------------------------------------------------------------
+void SurfaceControlManager::_init_poll_scheduler(struct timespec &poll_time)
+{
+    uint main_poll_interval = SURFACE_HW_POLL_TIME;
+
+    // Get the knob poll intervals (ms), making sure they are valid
+    // The thread polls at the minimum interval, which cannot be longer than the main
+    // poll interval
+#ifndef TESTING_SURFACE_HARDWARE
+    uint min_interval = std::clamp(utils::system_config()->get_surface_poll_min_interval(), 1U, main_poll_interval);
+    uint max_interval = std::max(utils::system_config()->get_surface_poll_max_interval(), min_interval);
+#else
+    uint min_interval = main_poll_interval;
+    uint max_interval = main_poll_interval;
+#endif
+
+    // Set the thread poll time (in nano-seconds)
+    std::memset(&poll_time, 0, sizeof(poll_time));
+    poll_time.tv_sec = min_interval / 1000;
+    poll_time.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(min_interval % 1000)).count();
+
+    // Set the main poll interval, and the number of polls for each knob poll time
+    _poll_interval = min_interval;
+    _main_poll_interval = main_poll_interval;
+    _knob_max_poll_interval = max_interval / min_interval;
+    _poll_thresh_count = POLL_THRESH_TIME / min_interval;
+    _small_movement_threshold_max_count = SMALL_MOVEMENT_THRESHOLD_MAX_TIME / min_interval;
+    _knob_moved_to_target_poll_skip_count = std::max(KNOB_MOVED_TO_TARGET_POLL_SKIP_TIME / min_interval, 1U);
+    _knob_recent_movement_count = KNOB_RECENT_MOVEMENT_TIME / min_interval;
+    MSG("Surface poll interval: " << min_interval << "ms - " << max_interval << "ms");
+    NINA_LOG_INFO(module(), "Surface poll interval: {}ms - {}ms", min_interval, max_interval);
+}
+
+//----------------------------------------------------------------------------
+// _get_knob_polls
+//----------------------------------------------------------------------------
+void SurfaceControlManager::_get_knob_polls(bool *poll_knobs)
+{
+    // Check if each knob is due to be polled
+    for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++) {
+        auto& knob_control = _knob_controls[i];
+        knob_control.polls_since_last_poll++;
+        poll_knobs[i] = knob_control.polls_since_last_poll >= knob_control.poll_interval;
+    }
+}
+
+//----------------------------------------------------------------------------
+// _schedule_knob_poll
+//----------------------------------------------------------------------------
+void SurfaceControlManager::_schedule_knob_poll(KnobControl &knob_control, const KnobState &knob_state)
+{
+    // Has this knob recently moved, or is it moving to (or settling at) a target position?
+    // If so poll it at the minimum interval
+    if (knob_control.moving_to_target || knob_control.moving_to_large_threshold ||
+        (knob_state.state & KnobState::STATE_MOVING_TO_TARGET) ||
+        (knob_control.polls_since_last_threshold_hit < _knob_recent_movement_count)) {
+        knob_control.poll_interval = 1;
+    }
+    else {
+        // The knob is idle, back off the poll interval up to the maximum interval
+        knob_control.poll_interval = std::min((knob_control.poll_interval * 2), _knob_max_poll_interval);
+    }
+    knob_control.polls_since_last_poll = 0;
+}
+
 //----------------------------------------------------------------------------
 // _process_physical_switch
 //----------------------------------------------------------------------------
@@ -1576,7 +1757,7 @@ void SurfaceControlManager::_commit_led_control_states()
         if (res < 0)
         {
             // Show the error
-            //DEBUG_BASEMGR_MSG("Could not commit the LED states: " << res);
+            NINA_TRACE_DEBUG(module(), "Could not commit the LED states: {}", res);
         }
     }
 }
@@ -1635,6 +1816,10 @@ void SurfaceControlManager::_switch_led_pulse_timer_callback(SwitchControl *swit
 void SurfaceControlManager::_register_params()
 {
 	// Register the surface params
+    // Note: These are registered as a batch, the params registry is published once
+    // they have all been registered
+    utils::begin_params_registration();
+
     // Register the Knob controls (knobs + knob switches)
     for (int i=0; i<NUM_PHYSICAL_KNOBS; i++)
     {   
@@ -1649,6 +1834,7 @@ void SurfaceControlManager::_register_params()
         // Register the switch control
 	    utils::register_param(std::move(SwitchParam::CreateParam(i)));
     }
+    utils::end_params_registration();
 }
 
 //----------------------------------------------------------------------------
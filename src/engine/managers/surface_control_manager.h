@@ -37,9 +37,14 @@ struct KnobControl
     uint small_movement_threshold_count;
     uint polls_since_last_threshold_hit;
     bool moving_to_target;
+    uint16_t target_position;
+    bool at_target_position;
+    bool target_position_pending;
     std::chrono::_V2::steady_clock::time_point large_movement_time_start;
     bool moving_to_large_threshold;
     bool morphable;
+    uint poll_interval;
+    uint polls_since_last_poll;
 };
 
 // Switch control
@@ -98,6 +103,15 @@ private:
     int _morph_knob_num;
     KnobParam *_morph_knob_param;
     bool _presets_reloaded;
+    uint _poll_interval;
+    uint _main_poll_interval;
+    uint _knob_max_poll_interval;
+    uint _poll_thresh_count;
+    uint _small_movement_threshold_max_count;
+    uint _knob_moved_to_target_poll_skip_count;
+    uint _knob_recent_movement_count;
+    std::chrono::steady_clock::time_point _knob_states_read_time;
+    LatencyTraceId _trace_id;
 
     // Private functions
     void _process_param_changed_event(const ParamChange &param_change);
@@ -106,12 +120,16 @@ private:
     void _set_knob_control_position_from_preset(uint num);
     void _set_switch_control_value_from_preset(uint num);
     void _process_sfc_param_changed(Param *param);
-    void _process_param_changed_mapped_params(const Param *param, const Param *skip_param, bool displayed);
+    void _process_param_changed_mapped_params(const Param *changed_param, bool displayed);
     void _send_control_param_change_events(const Param *param);
     void _set_knob_control_position(const KnobParam *param, bool robust=true);
+    void _check_knob_target_positions();
     void _set_switch_control_value(const SwitchParam *param);
     void _set_knob_control_haptic_mode(const KnobParam *param);
     void _process_physical_knob(KnobControl &knob_control, const KnobState &knob_state);
+    void _init_poll_scheduler(struct timespec &poll_time);
+    void _get_knob_polls(bool *poll_knobs);
+    void _schedule_knob_poll(KnobControl &knob_control, const KnobState &knob_state);
     void _process_physical_switch(SwitchControl &switch_control, bool physical_state);
     void _morph_control(SurfaceControlType type, uint num);
     void _commit_led_control_states();
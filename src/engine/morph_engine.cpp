@@ -0,0 +1,205 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  morph_engine.cpp
+ * @brief Morph Engine implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <assert.h>
+#include <cmath>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+#include "morph_engine.h"
+
+//----------------------------------------------------------------------------
+// MorphEngine
+//----------------------------------------------------------------------------
+MorphEngine::MorphEngine()
+{
+    // Initialise class data
+    for (uint i=0; i<NUM_LAYERS; i++) {
+        _layer_states[i].valid = false;
+        _layer_states[i].output_set = false;
+    }
+}
+
+//----------------------------------------------------------------------------
+// ~MorphEngine
+//----------------------------------------------------------------------------
+MorphEngine::~MorphEngine()
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// set_layer_states
+//----------------------------------------------------------------------------
+void MorphEngine::set_layer_states(uint layer_num, const std::vector<Param *>& params, const std::vector<float>& state_a_values,
+                                   const std::vector<float>& state_b_values)
+{
+    assert(layer_num < NUM_LAYERS);
+    assert((params.size() == state_a_values.size()) && (params.size() == state_b_values.size()));
+
+    // Get the morph engine mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Replace the layer states
+    // The output values are flagged as not set so that the first blend always
+    // updates every param
+    // Note: A NaN sentinel cannot be used for this, as NaN checks are removed when
+    // built with -ffast-math
+    auto& states = _layer_states[layer_num];
+    states.params = params;
+    states.state_a = state_a_values;
+    states.state_b = state_b_values;
+    states.output.assign(params.size(), 0.0f);
+    states.output_set = false;
+    states.changed.assign(params.size(), 0);
+    states.index.clear();
+    for (uint i=0; i<params.size(); i++) {
+        states.index[params[i]] = i;
+    }
+    states.valid = true;
+}
+
+//----------------------------------------------------------------------------
+// set_state_value
+//----------------------------------------------------------------------------
+void MorphEngine::set_state_value(uint layer_num, PatchState state, const Param *param, float value)
+{
+    assert(layer_num < NUM_LAYERS);
+
+    // Get the morph engine mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Update the state value if this param is blended in this layer
+    auto& states = _layer_states[layer_num];
+    auto itr = states.index.find(param);
+    if (itr != states.index.end()) {
+        if (state == PatchState::STATE_A) {
+            states.state_a[itr->second] = value;
+        }
+        else {
+            states.state_b[itr->second] = value;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// clear_layer_states
+//----------------------------------------------------------------------------
+void MorphEngine::clear_layer_states(uint layer_num)
+{
+    assert(layer_num < NUM_LAYERS);
+
+    // Get the morph engine mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Clear the layer states
+    auto& states = _layer_states[layer_num];
+    states.valid = false;
+    states.output_set = false;
+    states.params.clear();
+    states.state_a.clear();
+    states.state_b.clear();
+    states.output.clear();
+    states.changed.clear();
+    states.index.clear();
+}
+
+//----------------------------------------------------------------------------
+// layer_states_set
+//----------------------------------------------------------------------------
+bool MorphEngine::layer_states_set(uint layer_num)
+{
+    assert(layer_num < NUM_LAYERS);
+
+    // Get the morph engine mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Return if the layer states have been set
+    return _layer_states[layer_num].valid;
+}
+
+//----------------------------------------------------------------------------
+// blend
+//----------------------------------------------------------------------------
+bool MorphEngine::blend(uint layer_num, float morph_value)
+{
+    bool ret = false;
+    assert(layer_num < NUM_LAYERS);
+
+    // Get the morph engine mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // If the layer states have been set
+    auto& states = _layer_states[layer_num];
+    if (states.valid) {
+        // Blend the values, and update any params that have changed
+        _blend_values(states, morph_value);
+        for (uint i=0; i<states.params.size(); i++) {
+            if (states.changed[i]) {
+                states.params[i]->set_value(states.output[i]);
+                ret = true;
+            }
+        }
+    }
+    return ret;
+}
+
+//----------------------------------------------------------------------------
+// _blend_values
+// Note: The morph engine mutex must be held by the caller
+//----------------------------------------------------------------------------
+void MorphEngine::_blend_values(LayerStates& states, float morph_value)
+{
+    const float *a = states.state_a.data();
+    const float *b = states.state_b.data();
+    float *out = states.output.data();
+    uint8_t *changed = states.changed.data();
+    uint num_values = states.params.size();
+    uint i = 0;
+
+    // If the output values have not been set yet, every value is changed
+    bool set_all = !states.output_set;
+    states.output_set = true;
+
+#ifdef __ARM_NEON
+    // Blend four values at a time: out = a + (b - a) * morph
+    const float32x4_t threshold = vdupq_n_f32(MORPH_BLEND_THRESHOLD);
+    const uint32x4_t vset_all = vdupq_n_u32(set_all ? 0xFFFFFFFF : 0);
+    for (; (i + 4) <= num_values; i += 4) {
+        float32x4_t va = vld1q_f32(a + i);
+        float32x4_t vb = vld1q_f32(b + i);
+        float32x4_t vprev = vld1q_f32(out + i);
+        float32x4_t vout = vmlaq_n_f32(va, vsubq_f32(vb, va), morph_value);
+        uint32x4_t vchanged = vorrq_u32(vcgeq_f32(vabdq_f32(vout, vprev), threshold), vset_all);
+        uint32_t mask[4];
+        float blended[4];
+        vst1q_u32(mask, vchanged);
+        vst1q_f32(blended, vout);
+
+        // Only write back the lanes that changed, so small movements accumulate
+        // against the last applied value
+        for (uint j=0; j<4; j++) {
+            changed[i + j] = mask[j] ? 1 : 0;
+            if (mask[j]) {
+                out[i + j] = blended[j];
+            }
+        }
+    }
+#endif
+
+    // Blend any remaining values (or all values if NEON is not available)
+    for (; i<num_values; i++) {
+        float value = a[i] + (b[i] - a[i]) * morph_value;
+        bool value_changed = set_all || (std::fabs(value - out[i]) >= MORPH_BLEND_THRESHOLD);
+        changed[i] = value_changed ? 1 : 0;
+        if (value_changed) {
+            out[i] = value;
+        }
+    }
+}
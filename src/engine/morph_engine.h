@@ -0,0 +1,64 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  morph_engine.h
+ * @brief Morph Engine class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _MORPH_ENGINE_H
+#define _MORPH_ENGINE_H
+
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include "param.h"
+#include "common.h"
+
+// Minimum change in a blended value before the param is updated - this is
+// just below the resolution of the motor driven knobs
+constexpr float MORPH_BLEND_THRESHOLD = 1.0f / 1024;
+
+// Morph Engine class
+// Blends the State A and State B values of the patch state params locally, so
+// that morphing in dance mode does not require the values to be fetched from
+// the DAW
+class MorphEngine
+{
+public:
+    // Constructor
+    MorphEngine();
+
+    // Destructor
+    virtual ~MorphEngine();
+
+    // Public functions
+    void set_layer_states(uint layer_num, const std::vector<Param *>& params, const std::vector<float>& state_a_values,
+                          const std::vector<float>& state_b_values);
+    void set_state_value(uint layer_num, PatchState state, const Param *param, float value);
+    void clear_layer_states(uint layer_num);
+    bool layer_states_set(uint layer_num);
+    bool blend(uint layer_num, float morph_value);
+
+private:
+    // Layer morph states
+    // The values are stored as separate arrays so they can be blended in a
+    // single vectorised pass
+    struct LayerStates
+    {
+        bool valid;
+        bool output_set;
+        std::vector<Param *> params;
+        std::vector<float> state_a;
+        std::vector<float> state_b;
+        std::vector<float> output;
+        std::vector<uint8_t> changed;
+        std::unordered_map<const Param *, uint> index;
+    };
+    std::mutex _mutex;
+    LayerStates _layer_states[NUM_LAYERS];
+
+    void _blend_values(LayerStates& states, float morph_value);
+};
+
+#endif // _MORPH_ENGINE_H
@@ -11,9 +11,11 @@
 #include <cstring>
 #include <cstdlib>
 #include <math.h>
+#include <algorithm>
 #include "param.h"
 #include "base_manager.h"
 #include "utils.h"
+#include "logger.h"
 
 // Constants
 constexpr char ARPEGGIATOR_PARAM_PATH_PREFIX[]     = "/arp/";
@@ -134,6 +136,11 @@ std::string Param::ParamPath(NinaModule module, std::string param_name)
     return (path_prefix + param_name);
 }
 
+// Static variables
+// The mapped params generation is incremented whenever any param mappings change, so
+// that each compiled mapping graph is rebuilt when next used
+std::atomic<uint> Param::_mapped_params_generation{1};
+
 //----------------------------------------------------------------------------
 // Param
 //----------------------------------------------------------------------------
@@ -141,6 +148,7 @@ Param::Param(const Param& param)
 {
     type = param.type;
     module = param.module;
+    handle = param.handle;
     name = param.name;
     processor_id = param.processor_id;
     param_id = param.param_id;
@@ -159,6 +167,8 @@ Param::Param(const Param& param)
     global_param = param.global_param;
     layer_1_param = param.layer_1_param;
     state = param.state;
+    state_id = param.state_id;
+    param_state = nullptr;
     alias_param = param.alias_param;
     _path = param._path;
     _value = param._value;
@@ -166,6 +176,9 @@ Param::Param(const Param& param)
     _position_increment = param._position_increment;
     _mapped_params = param._mapped_params;
     _linked_param = param._linked_param;
+    _mapped_param_graph = nullptr;
+    _mapped_param_graph_generation = 0;
+    _mapped_params_generation++;
     num_positions = param.num_positions;
     actual_num_positions = param.actual_num_positions;
     display_name = param.display_name;
@@ -193,6 +206,7 @@ Param::Param(NinaModule module)
     // Initialise class data
     type = ParamType::MODULE_PARAM;
     this->module = module;
+    handle = INVALID_PARAM_HANDLE;
     name = "";
     processor_id = -1;
     param_id = -1;
@@ -215,6 +229,8 @@ Param::Param(NinaModule module)
     ref = "";
     set_ui_state = "";
     state = "default";
+    state_id = DEFAULT_PARAM_STATE_ID;
+    param_state = nullptr;
     alias_param = false;
     num_positions = 0;
     actual_num_positions = 0;
@@ -231,6 +247,8 @@ Param::Param(NinaModule module)
     _normalised_value = true;
     _mapped_params.clear();
     _linked_param = nullptr;    
+    _mapped_param_graph = nullptr;
+    _mapped_param_graph_generation = 0;
     param_list_name = "";
     param_list_display_name = "";
     value_tag = "";
@@ -697,6 +715,7 @@ std::string Param::get_position_as_string(uint pos) const
 void Param::add_mapped_param(Param *param)
 {
     _mapped_params.push_back(param);
+    _mapped_params_generation++;
 }
 
 //----------------------------------------------------------------------------
@@ -729,6 +748,57 @@ Param *Param::get_linked_param() const
 void Param::clear_mapped_params()
 {
     _mapped_params.clear();
+    _mapped_params_generation++;
+}
+
+//----------------------------------------------------------------------------
+// get_mapped_param_graph
+//----------------------------------------------------------------------------
+std::shared_ptr<const MappedParamGraph> Param::get_mapped_param_graph() const
+{
+    std::lock_guard<std::mutex> lock(_mapped_param_graph_mutex);
+
+    // Has any param mapping changed since the mapping graph was compiled?
+    uint generation = _mapped_params_generation;
+    if (!_mapped_param_graph || (_mapped_param_graph_generation != generation))
+    {
+        // Compile the mapping graph
+        // This is a flat list of every param this param is mapped to, directly or through
+        // other params, in the order they should be processed - each param is only
+        // included once, so params mapped to each other do not cause a cycle
+        auto graph = std::make_shared<MappedParamGraph>();
+        std::vector<const Param *> visited = { this };
+        _compile_mapped_param_graph(this, *graph, visited);
+        _mapped_param_graph = graph;
+        _mapped_param_graph_generation = generation;
+    }
+
+    // Return the mapping graph - this remains valid for the caller even if the mapping
+    // graph is re-compiled
+    return _mapped_param_graph;
+}
+
+//----------------------------------------------------------------------------
+// _compile_mapped_param_graph
+//----------------------------------------------------------------------------
+void Param::_compile_mapped_param_graph(const Param *source, MappedParamGraph& graph, std::vector<const Param *>& visited) const
+{
+    // Add each param mapped to the source param that has not already been added
+    for (Param *mp : source->_mapped_params)
+    {
+        if (std::find(visited.begin(), visited.end(), mp) != visited.end())
+            continue;
+        visited.push_back(mp);
+        uint index = graph.size();
+        graph.push_back({mp, source, 0});
+
+        // Add the params mapped through this param, these follow it in the graph
+        // Note: We don't add the params mapped to system function params as they are
+        // a system action to be performed
+        if (mp->type != ParamType::SYSTEM_FUNC)
+            _compile_mapped_param_graph(mp, graph, visited);
+        graph[index].num_descendants = graph.size() - index - 1;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -2132,11 +2202,33 @@ DummyParam::~DummyParam()
 //----------------------------------------------------------------------------
 ParamChange::ParamChange(std::string path, float value, NinaModule from_module)
 {
-    this->path = path;
+    // Get the handle for this path
+    // Note: A param change for an unregistered path has no handle, and is never
+    // coalesced with other param changes
+    this->handle = utils::get_param_handle(path);
+    if (this->handle == INVALID_PARAM_HANDLE)
+    {
+        DEBUG_MSG("Param change for an unregistered param: " << path);
+        NINA_LOG_WARNING(from_module, "Param change for an unregistered param: {}", path);
+    }
     this->value = value;
     this->from_module = from_module;
     this->display = true;
     this->layers_mask = LayerInfo::GetLayerMaskBit(utils::get_current_layer_info().layer_num());
+    this->trace_id = NO_LATENCY_TRACE_ID;
+}
+
+//----------------------------------------------------------------------------
+// ParamChange
+//----------------------------------------------------------------------------
+ParamChange::ParamChange(ParamHandle handle, float value, NinaModule from_module)
+{
+    this->handle = handle;
+    this->value = value;
+    this->from_module = from_module;
+    this->display = true;
+    this->layers_mask = LayerInfo::GetLayerMaskBit(utils::get_current_layer_info().layer_num());
+    this->trace_id = NO_LATENCY_TRACE_ID;
 }
 
 //----------------------------------------------------------------------------
@@ -2144,7 +2236,9 @@ ParamChange::ParamChange(std::string path, float value, NinaModule from_module)
 //----------------------------------------------------------------------------
 ParamChange::ParamChange(const Param *param, NinaModule from_module)
 {
-    this->path = param->get_path();
+    // Note: If the param has not been registered (no handle), get the handle
+    // from the path
+    this->handle = (param->handle != INVALID_PARAM_HANDLE) ? param->handle : utils::get_param_handle(param->get_path());
     this->value = param->get_value();
     this->from_module = from_module;
     this->display = (std::strlen(param->get_name()) > 0) &&
@@ -2152,4 +2246,14 @@ ParamChange::ParamChange(const Param *param, NinaModule from_module)
                         (param->module != NinaModule::MIDI_DEVICE) &&
                         (param->type != ParamType::UI_STATE_CHANGE));
     this->layers_mask = LayerInfo::GetLayerMaskBit(utils::get_current_layer_info().layer_num());
+    this->trace_id = NO_LATENCY_TRACE_ID;
+}
+
+//----------------------------------------------------------------------------
+// path
+//----------------------------------------------------------------------------
+const std::string& ParamChange::path() const
+{
+    // Get the path from the param handle
+    return utils::get_param_path(handle);
 }
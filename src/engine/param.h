@@ -14,9 +14,11 @@
 #include <cstring>
 #include <functional>
 #include <mutex>
+#include <atomic>
 #include "tempo.h"
 #include "surface_control.h"
 #include "system_func.h"
+#include "latency_trace.h"
 #include "common.h"
 
 // External classes
@@ -48,16 +50,38 @@ enum class PatchState
     STATE_B
 };
 
+// Param Handle
+// Each registered param path is assigned a handle, which can be used
+// to identify the param without the path string
+typedef uint32_t ParamHandle;
+constexpr ParamHandle INVALID_PARAM_HANDLE = (ParamHandle)-1;
+
+// Param State IDs
+// Param state names are interned when a param is registered, and the
+// default state is always ID 0
+constexpr uint DEFAULT_PARAM_STATE_ID = 0;
+constexpr uint INVALID_PARAM_STATE_ID = (uint)-1;
+constexpr uint PARAM_STATE_STACK_RESERVE = 8;
+
 // Current Param State
+// The current state ID is the top of the state stack - the stack is only accessed
+// with the params mutex held, but the current state can be read from any thread
 struct ParamState
 {
     std::string path;
-    std::vector<std::string> state_stack;
+    std::vector<uint> state_stack;
+    std::atomic<uint> current_state_id;
+    bool modified;
 
     ParamState()
     {
         // There is always a default state
-        state_stack.push_back("default");
+        // Reserve space in the stack so that pushing a state doesn't
+        // normally allocate
+        state_stack.reserve(PARAM_STATE_STACK_RESERVE);
+        state_stack.push_back(DEFAULT_PARAM_STATE_ID);
+        current_state_id = DEFAULT_PARAM_STATE_ID;
+        modified = false;
     }
 };
 
@@ -69,6 +93,18 @@ struct ContextSpecificParams
     std::vector<Param *> param_list;
 };
 
+// Mapped Param destination
+// An entry in a compiled mapping graph - the destination param, the param it is
+// mapped from (its value is set from this param), and the number of entries that
+// follow which are mapped through this destination
+struct MappedParamDest
+{
+    Param *param;
+    const Param *source;
+    uint num_descendants;
+};
+typedef std::vector<MappedParamDest> MappedParamGraph;
+
 // Param class
 class Param
 {
@@ -76,6 +112,7 @@ public:
     // General attributes
     ParamType type;
     NinaModule module;
+    ParamHandle handle;
     int param_id;
     int processor_id;
     bool str_param;
@@ -92,6 +129,8 @@ public:
     std::string ref;
     std::string set_ui_state;
     std::string state;
+    uint state_id;
+    ParamState *param_state;
     bool alias_param;
     
     // Position based attributes
@@ -165,6 +204,7 @@ public:
     const std::vector<Param *>& get_mapped_params() const;
     Param *get_linked_param() const;
     void clear_mapped_params();
+    std::shared_ptr<const MappedParamGraph> get_mapped_param_graph() const;
     std::string get_value_tag() const;
     std::vector<Param *> get_param_list() const;
 
@@ -179,10 +219,15 @@ protected:
     float _physical_position_increment;
     std::vector<Param *> _mapped_params;
     Param *_linked_param;
+    mutable std::mutex _mapped_param_graph_mutex;
+    mutable std::shared_ptr<const MappedParamGraph> _mapped_param_graph;
+    mutable uint _mapped_param_graph_generation;
+    static std::atomic<uint> _mapped_params_generation;
 
     // Protected functions
     virtual float _to_normalised_float() const;
     virtual float _from_normalised_float(float value) const;
+    void _compile_mapped_param_graph(const Param *source, MappedParamGraph& graph, std::vector<const Param *>& visited) const;
 };
 
 // Param Alias class
@@ -429,31 +474,21 @@ public:
 struct ParamChange
 {
     // Constructor
-    ParamChange() {}
+    ParamChange() { handle = INVALID_PARAM_HANDLE; trace_id = NO_LATENCY_TRACE_ID; }
     ParamChange(std::string path, float value, NinaModule from_module);
+    ParamChange(ParamHandle handle, float value, NinaModule from_module);
     ParamChange(const Param *param, NinaModule from_module);
 
+    // Public functions
+    const std::string& path() const;
+
     // Public variables    
-    std::string path;
+    ParamHandle handle;
     float value;
     NinaModule from_module;
     bool display;
     uint layers_mask;
-};
-
-// Param Change History
-struct ParamChangeHistory
-{
-    std::string path;
-    float value;
-
-    // Constructor
-    ParamChangeHistory() {}
-    ParamChangeHistory(std::string path, float value)
-    {
-        this->path = path;
-        this->value = value;
-    }    
+    LatencyTraceId trace_id;
 };
 
 #endif  // _PARAM_H
@@ -0,0 +1,156 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  param_value_bank.cpp
+ * @brief Param Value Bank implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+#include "param_value_bank.h"
+
+//----------------------------------------------------------------------------
+// ParamValueBank
+//----------------------------------------------------------------------------
+ParamValueBank::ParamValueBank()
+{
+    // Initialise class data
+    _valid = false;
+}
+
+//----------------------------------------------------------------------------
+// ~ParamValueBank
+//----------------------------------------------------------------------------
+ParamValueBank::~ParamValueBank()
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// valid
+//----------------------------------------------------------------------------
+bool ParamValueBank::valid() const
+{
+    // Return if the bank holds captured values
+    return _valid;
+}
+
+//----------------------------------------------------------------------------
+// invalidate
+//----------------------------------------------------------------------------
+void ParamValueBank::invalidate()
+{
+    // Mark the bank as invalid - the values are kept allocated so that the next
+    // capture does not need to re-allocate them
+    _valid = false;
+}
+
+//----------------------------------------------------------------------------
+// capture
+//----------------------------------------------------------------------------
+void ParamValueBank::capture(const std::vector<Param *>& params, std::function<bool(const Param *)> filter)
+{
+    // Clear the bank
+    std::fill(_values.begin(), _values.end(), 0.0f);
+    std::fill(_contains.begin(), _contains.end(), false);
+    _str_values.clear();
+
+    // Capture the current value of each param that passes the filter
+    // Note: A param that has not been registered has no handle, so it cannot be
+    // held in the bank
+    for (const Param *p : params)
+    {
+        if ((p->handle == INVALID_PARAM_HANDLE) || !filter(p))
+            continue;
+
+        // Make sure the bank is large enough for this param handle
+        if (p->handle >= _values.size())
+        {
+            _values.resize(p->handle + 1, 0.0f);
+            _contains.resize(p->handle + 1, false);
+        }
+        if (p->str_param) {
+            _str_values[p->handle] = p->get_str_value();
+        }
+        else {
+            _values[p->handle] = p->get_value();
+        }
+        _contains[p->handle] = true;
+    }
+    _valid = true;
+}
+
+//----------------------------------------------------------------------------
+// contains
+//----------------------------------------------------------------------------
+bool ParamValueBank::contains(const Param *param) const
+{
+    // Check if the bank is valid and holds a value for this param
+    return _valid && (param->handle < _contains.size()) && _contains[param->handle];
+}
+
+//----------------------------------------------------------------------------
+// can_apply
+//----------------------------------------------------------------------------
+bool ParamValueBank::can_apply(const std::vector<Param *>& params, std::function<bool(const Param *)> filter) const
+{
+    // The bank can only be applied if it is valid and holds a value for every param that
+    // passes the filter, and no string value has changed - loading a string param has
+    // side effects, so the caller must load the params another way
+    if (!_valid) {
+        return false;
+    }
+    for (const Param *p : params)
+    {
+        if ((p->handle == INVALID_PARAM_HANDLE) || !filter(p))
+            continue;
+        if (!contains(p) || (p->str_param && (get_str_value(p) != p->get_str_value()))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// get_value
+// Note: The caller must check the bank contains this param
+//----------------------------------------------------------------------------
+float ParamValueBank::get_value(const Param *param) const
+{
+    // Return the param value
+    return _values[param->handle];
+}
+
+//----------------------------------------------------------------------------
+// get_str_value
+// Note: The caller must check the bank contains this param
+//----------------------------------------------------------------------------
+const std::string& ParamValueBank::get_str_value(const Param *param) const
+{
+    // Return the param string value
+    return _str_values.at(param->handle);
+}
+
+//----------------------------------------------------------------------------
+// set_value
+//----------------------------------------------------------------------------
+void ParamValueBank::set_value(const Param *param, float value)
+{
+    // Update the value if the bank holds this param - the value is clipped in
+    // the same way as when it is set in the param
+    if (contains(param) && !param->str_param) {
+        _values[param->handle] = std::clamp(value, 0.0f, 1.0f);
+    }
+}
+
+//----------------------------------------------------------------------------
+// set_str_value
+//----------------------------------------------------------------------------
+void ParamValueBank::set_str_value(const Param *param, const std::string& str_value)
+{
+    // Update the string value if the bank holds this param
+    if (contains(param) && param->str_param) {
+        _str_values[param->handle] = str_value;
+    }
+}
@@ -0,0 +1,48 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  param_value_bank.h
+ * @brief Param Value Bank class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _PARAM_VALUE_BANK_H
+#define _PARAM_VALUE_BANK_H
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include "param.h"
+
+// Param Value Bank class
+// A resident, contiguous bank of param values indexed by param handle - used to
+// hold the values of a set of params (for example a layer's patch params) when
+// they are not loaded in the params themselves
+class ParamValueBank
+{
+public:
+    // Constructor/destructor
+    ParamValueBank();
+    ~ParamValueBank();
+
+    // Public functions
+    bool valid() const;
+    void invalidate();
+    void capture(const std::vector<Param *>& params, std::function<bool(const Param *)> filter);
+    bool contains(const Param *param) const;
+    bool can_apply(const std::vector<Param *>& params, std::function<bool(const Param *)> filter) const;
+    float get_value(const Param *param) const;
+    const std::string& get_str_value(const Param *param) const;
+    void set_value(const Param *param, float value);
+    void set_str_value(const Param *param, const std::string& str_value);
+
+private:
+    // Private variables
+    bool _valid;
+    std::vector<float> _values;
+    std::vector<bool> _contains;
+    std::unordered_map<ParamHandle, std::string> _str_values;
+};
+
+#endif // _PARAM_VALUE_BANK_H
@@ -0,0 +1,426 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  patch_cache.cpp
+ * @brief Patch Cache implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "patch_cache.h"
+
+// Patch cache sections, in the order they are stored
+constexpr const char *PATCH_CACHE_SECTIONS[NUM_PATCH_CACHE_SECTIONS] = { "common", "state_a", "state_b" };
+
+//----------------------------------------------------------------------------
+// PatchCache
+//----------------------------------------------------------------------------
+PatchCache::PatchCache(std::string cache_dir)
+{
+    // Initialise class data
+    _cache_dir = cache_dir;
+    _memory_size = 0;
+    _memory_budget = DEFAULT_PATCH_CACHE_MEMORY_BUDGET_KB * 1024;
+}
+
+//----------------------------------------------------------------------------
+// ~PatchCache
+//----------------------------------------------------------------------------
+PatchCache::~PatchCache()
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// set_memory_budget
+//----------------------------------------------------------------------------
+void PatchCache::set_memory_budget(size_t budget)
+{
+    // Get the memory mutex
+    std::lock_guard<std::mutex> lock(_memory_mutex);
+
+    // Set the budget, and drop the least recently used patches that no longer fit
+    _memory_budget = budget;
+    while ((_memory_size > _memory_budget) && !_memory_lru.empty()) {
+        _remove_from_memory(std::prev(_memory_lru.end()));
+    }
+}
+
+//----------------------------------------------------------------------------
+// load
+//----------------------------------------------------------------------------
+bool PatchCache::load(const std::string& patch_file_path, rapidjson::Document& json_doc)
+{
+    struct stat patch_stat;
+    struct stat cache_stat;
+
+    // Get the patch file details - these are used to check the cached patch is current
+    if (::stat(patch_file_path.c_str(), &patch_stat) != 0) {
+        return false;
+    }
+
+    // Release any existing patch data - the patch is loaded into the document
+    // allocator, which otherwise only grows
+    json_doc.SetNull();
+    json_doc.GetAllocator().Clear();
+
+    // Is the patch held in memory?
+    if (_load_from_memory(patch_file_path, patch_stat, json_doc)) {
+        return true;
+    }
+
+    // Open the cached patch, if any
+    int fd = ::open(_get_cache_file_path(patch_file_path).c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    if ((::fstat(fd, &cache_stat) != 0) || ((size_t)cache_stat.st_size < sizeof(PatchCacheHeader))) {
+        ::close(fd);
+        return false;
+    }
+
+    // Map the cached patch and restore the patch JSON data from it
+    size_t size = cache_stat.st_size;
+    void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    bool ret = _restore(static_cast<const uint8_t *>(data), size, patch_file_path, patch_stat, json_doc);
+    ::munmap(data, size);
+
+    // If restored, also hold the patch in memory
+    if (ret) {
+        _add_to_memory(patch_file_path, patch_stat, json_doc);
+    }
+    return ret;
+}
+
+//----------------------------------------------------------------------------
+// save
+//----------------------------------------------------------------------------
+void PatchCache::save(const std::string& patch_file_path, const rapidjson::Document& json_doc)
+{
+    PatchCacheHeader header = {};
+    std::vector<PatchCacheEntry> entries;
+    std::string strings;
+    struct stat patch_stat;
+
+    // Get the patch file details
+    auto cache_file_path = _get_cache_file_path(patch_file_path);
+    if (!json_doc.IsObject() || (::stat(patch_file_path.c_str(), &patch_stat) != 0)) {
+        return;
+    }
+
+    // Hold the patch in memory
+    _add_to_memory(patch_file_path, patch_stat, json_doc);
+
+    // The string table starts with the patch file path, this is checked on load in
+    // case two patch paths map to the same cache file
+    strings = patch_file_path;
+
+    // Add the entries for each section
+    for (uint i=0; i<NUM_PATCH_CACHE_SECTIONS; i++) {
+        if (!json_doc.HasMember(PATCH_CACHE_SECTIONS[i]) || !json_doc[PATCH_CACHE_SECTIONS[i]].IsArray()) {
+            return;
+        }
+        auto& section = json_doc[PATCH_CACHE_SECTIONS[i]];
+        for (auto itr = section.Begin(); itr != section.End(); ++itr) {
+            // If the entry cannot be cached, the patch is not cached
+            if (!_add_entry(*itr, entries, strings)) {
+                (void)std::remove(cache_file_path.c_str());
+                return;
+            }
+        }
+        header.num_entries[i] = section.Size();
+    }
+
+    // Any other patch data (version, revision) is stored as JSON
+    rapidjson::Document extra_doc;
+    extra_doc.SetObject();
+    for (auto itr = json_doc.MemberBegin(); itr != json_doc.MemberEnd(); ++itr) {
+        bool section = false;
+        for (uint i=0; i<NUM_PATCH_CACHE_SECTIONS; i++) {
+            section |= (std::strcmp(itr->name.GetString(), PATCH_CACHE_SECTIONS[i]) == 0);
+        }
+        if (!section) {
+            extra_doc.AddMember(rapidjson::Value(itr->name, extra_doc.GetAllocator()),
+                                rapidjson::Value(itr->value, extra_doc.GetAllocator()), extra_doc.GetAllocator());
+        }
+    }
+    rapidjson::StringBuffer extra_buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(extra_buffer);
+    (void)extra_doc.Accept(writer);
+    header.extra_offset = strings.size();
+    header.extra_len = extra_buffer.GetSize();
+    strings.append(extra_buffer.GetString(), extra_buffer.GetSize());
+
+    // Fill in the header
+    header.magic = PATCH_CACHE_MAGIC;
+    header.version = PATCH_CACHE_VERSION;
+    header.patch_mtime_sec = patch_stat.st_mtim.tv_sec;
+    header.patch_mtime_nsec = patch_stat.st_mtim.tv_nsec;
+    header.patch_size = patch_stat.st_size;
+    header.patch_path_len = patch_file_path.size();
+    header.strings_size = strings.size();
+
+    // Build the cache file data
+    std::vector<uint8_t> data(sizeof(header) + (entries.size() * sizeof(PatchCacheEntry)) + strings.size());
+    std::memcpy(data.data() + sizeof(header), entries.data(), entries.size() * sizeof(PatchCacheEntry));
+    std::memcpy(data.data() + sizeof(header) + (entries.size() * sizeof(PatchCacheEntry)), strings.data(), strings.size());
+    header.checksum = _checksum(data.data() + sizeof(header), data.size() - sizeof(header));
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    // Write the cache file to a temporary file and then rename it, so that a
+    // partially written cache file is never loaded
+    // Note: The cache file is not synced to disk - if it is lost or truncated it
+    // fails validation and is simply re-created
+    std::filesystem::create_directories(_cache_dir);
+    auto tmp_file_path = cache_file_path + "." + std::to_string(::syscall(SYS_gettid)) + ".tmp";
+    FILE *fp = std::fopen(tmp_file_path.c_str(), "wb");
+    if (fp == nullptr) {
+        return;
+    }
+    bool written = (std::fwrite(data.data(), data.size(), 1, fp) == 1);
+    written = (std::fclose(fp) == 0) && written;
+    if (!written || (std::rename(tmp_file_path.c_str(), cache_file_path.c_str()) != 0)) {
+        (void)std::remove(tmp_file_path.c_str());
+    }
+}
+
+//----------------------------------------------------------------------------
+// in_memory
+//----------------------------------------------------------------------------
+bool PatchCache::in_memory(const std::string& patch_file_path)
+{
+    struct stat patch_stat;
+
+    // Get the patch file details
+    if (::stat(patch_file_path.c_str(), &patch_stat) != 0) {
+        return false;
+    }
+
+    // Get the memory mutex
+    std::lock_guard<std::mutex> lock(_memory_mutex);
+
+    // Return if a current copy of the patch is held in memory
+    auto itr = _memory_index.find(patch_file_path);
+    return (itr != _memory_index.end()) &&
+           (itr->second->patch_mtime_sec == patch_stat.st_mtim.tv_sec) && (itr->second->patch_mtime_nsec == patch_stat.st_mtim.tv_nsec) &&
+           (itr->second->patch_size == (uint64_t)patch_stat.st_size);
+}
+
+//----------------------------------------------------------------------------
+// _load_from_memory
+//----------------------------------------------------------------------------
+bool PatchCache::_load_from_memory(const std::string& patch_file_path, const struct stat& patch_stat, rapidjson::Document& json_doc)
+{
+    // Get the memory mutex
+    std::lock_guard<std::mutex> lock(_memory_mutex);
+
+    // Is the patch held in memory?
+    auto itr = _memory_index.find(patch_file_path);
+    if (itr == _memory_index.end()) {
+        return false;
+    }
+
+    // If the patch file has changed, drop the copy in memory
+    auto entry = itr->second;
+    if ((entry->patch_mtime_sec != patch_stat.st_mtim.tv_sec) || (entry->patch_mtime_nsec != patch_stat.st_mtim.tv_nsec) ||
+        (entry->patch_size != (uint64_t)patch_stat.st_size)) {
+        _remove_from_memory(entry);
+        return false;
+    }
+
+    // Copy the patch and make it the most recently used
+    json_doc.CopyFrom(*entry->json_doc, json_doc.GetAllocator());
+    _memory_lru.splice(_memory_lru.begin(), _memory_lru, entry);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _add_to_memory
+//----------------------------------------------------------------------------
+void PatchCache::_add_to_memory(const std::string& patch_file_path, const struct stat& patch_stat, const rapidjson::Document& json_doc)
+{
+    // Copy the patch
+    PatchCacheMemoryEntry entry;
+    entry.patch_file_path = patch_file_path;
+    entry.patch_mtime_sec = patch_stat.st_mtim.tv_sec;
+    entry.patch_mtime_nsec = patch_stat.st_mtim.tv_nsec;
+    entry.patch_size = patch_stat.st_size;
+    entry.json_doc = std::make_unique<rapidjson::Document>();
+    entry.json_doc->CopyFrom(json_doc, entry.json_doc->GetAllocator());
+    entry.memory_size = entry.json_doc->GetAllocator().Size();
+
+    // Get the memory mutex
+    std::lock_guard<std::mutex> lock(_memory_mutex);
+
+    // Replace any existing copy of this patch
+    auto itr = _memory_index.find(patch_file_path);
+    if (itr != _memory_index.end()) {
+        _remove_from_memory(itr->second);
+    }
+
+    // If the patch fits in the budget, add it as the most recently used, and drop the
+    // least recently used patches until it fits
+    if (entry.memory_size <= _memory_budget) {
+        _memory_size += entry.memory_size;
+        _memory_lru.push_front(std::move(entry));
+        _memory_index[patch_file_path] = _memory_lru.begin();
+        while (_memory_size > _memory_budget) {
+            _remove_from_memory(std::prev(_memory_lru.end()));
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _remove_from_memory
+// Note: The memory mutex must be held by the caller
+//----------------------------------------------------------------------------
+void PatchCache::_remove_from_memory(std::list<PatchCacheMemoryEntry>::iterator itr)
+{
+    // Remove the patch from memory
+    _memory_size -= itr->memory_size;
+    _memory_index.erase(itr->patch_file_path);
+    _memory_lru.erase(itr);
+}
+
+//----------------------------------------------------------------------------
+// _get_cache_file_path
+//----------------------------------------------------------------------------
+std::string PatchCache::_get_cache_file_path(const std::string& patch_file_path)
+{
+    char filename[sizeof("0123456789abcdef.bin")];
+
+    // The cache filename is a hash of the patch file path
+    std::snprintf(filename, sizeof(filename), "%016llx.bin", (unsigned long long)std::hash<std::string>{}(patch_file_path));
+    return _cache_dir + filename;
+}
+
+//----------------------------------------------------------------------------
+// _restore
+//----------------------------------------------------------------------------
+bool PatchCache::_restore(const uint8_t *data, size_t size, const std::string& patch_file_path, const struct stat& patch_stat,
+                          rapidjson::Document& json_doc)
+{
+    PatchCacheHeader header;
+
+    // Check the header
+    std::memcpy(&header, data, sizeof(header));
+    if ((header.magic != PATCH_CACHE_MAGIC) || (header.version != PATCH_CACHE_VERSION)) {
+        return false;
+    }
+
+    // Check the cached patch is for this patch file, and the patch file has not
+    // changed since it was cached
+    if ((header.patch_mtime_sec != patch_stat.st_mtim.tv_sec) || (header.patch_mtime_nsec != patch_stat.st_mtim.tv_nsec) ||
+        (header.patch_size != (uint64_t)patch_stat.st_size)) {
+        return false;
+    }
+
+    // Check the cache file size and checksum
+    size_t num_entries = 0;
+    for (uint i=0; i<NUM_PATCH_CACHE_SECTIONS; i++) {
+        num_entries += header.num_entries[i];
+    }
+    if (size != (sizeof(header) + (num_entries * sizeof(PatchCacheEntry)) + header.strings_size)) {
+        return false;
+    }
+    if (header.checksum != _checksum(data + sizeof(header), size - sizeof(header))) {
+        return false;
+    }
+    auto entries = reinterpret_cast<const PatchCacheEntry *>(data + sizeof(header));
+    auto strings = reinterpret_cast<const char *>(data + sizeof(header) + (num_entries * sizeof(PatchCacheEntry)));
+    if ((header.patch_path_len != patch_file_path.size()) || (header.patch_path_len > header.strings_size) ||
+        (std::memcmp(strings, patch_file_path.data(), header.patch_path_len) != 0) ||
+        ((header.extra_offset + header.extra_len) > header.strings_size)) {
+        return false;
+    }
+
+    // Restore the other patch data first
+    json_doc.Parse(strings + header.extra_offset, header.extra_len);
+    if (json_doc.HasParseError() || !json_doc.IsObject()) {
+        return false;
+    }
+
+    // Restore each section from the flat entries
+    auto& allocator = json_doc.GetAllocator();
+    for (uint i=0; i<NUM_PATCH_CACHE_SECTIONS; i++) {
+        rapidjson::Value section(rapidjson::kArrayType);
+        section.Reserve(header.num_entries[i], allocator);
+        for (uint j=0; j<header.num_entries[i]; j++) {
+            auto& entry = *entries++;
+            if (((entry.path_offset + entry.path_len) > header.strings_size) ||
+                ((entry.str_value_len != PATCH_CACHE_NUMERIC) && ((entry.str_value_offset + entry.str_value_len) > header.strings_size))) {
+                return false;
+            }
+            rapidjson::Value obj(rapidjson::kObjectType);
+            obj.AddMember("path", rapidjson::Value(strings + entry.path_offset, entry.path_len, allocator), allocator);
+            if (entry.str_value_len == PATCH_CACHE_NUMERIC) {
+                obj.AddMember("value", entry.value, allocator);
+            }
+            else {
+                obj.AddMember("str_value", rapidjson::Value(strings + entry.str_value_offset, entry.str_value_len, allocator), allocator);
+            }
+            section.PushBack(obj, allocator);
+        }
+        json_doc.AddMember(rapidjson::StringRef(PATCH_CACHE_SECTIONS[i]), section, allocator);
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _add_entry
+//----------------------------------------------------------------------------
+bool PatchCache::_add_entry(const rapidjson::Value& entry, std::vector<PatchCacheEntry>& entries, std::string& strings)
+{
+    PatchCacheEntry cache_entry;
+
+    // Only entries with a path and either a numeric or string value can be cached
+    if (!entry.IsObject() || (entry.MemberCount() != 2) || !entry.HasMember("path") || !entry["path"].IsString()) {
+        return false;
+    }
+    cache_entry.path_offset = strings.size();
+    cache_entry.path_len = entry["path"].GetStringLength();
+    strings.append(entry["path"].GetString(), cache_entry.path_len);
+    if (entry.HasMember("value") && entry["value"].IsNumber()) {
+        cache_entry.str_value_offset = 0;
+        cache_entry.str_value_len = PATCH_CACHE_NUMERIC;
+        cache_entry.value = entry["value"].GetFloat();
+    }
+    else if (entry.HasMember("str_value") && entry["str_value"].IsString()) {
+        cache_entry.str_value_offset = strings.size();
+        cache_entry.str_value_len = entry["str_value"].GetStringLength();
+        cache_entry.value = 0.0f;
+        strings.append(entry["str_value"].GetString(), cache_entry.str_value_len);
+    }
+    else {
+        return false;
+    }
+    entries.push_back(cache_entry);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _checksum
+//----------------------------------------------------------------------------
+uint32_t PatchCache::_checksum(const uint8_t *data, size_t size)
+{
+    // FNV-1a checksum of the data
+    uint32_t checksum = 2166136261u;
+    for (size_t i=0; i<size; i++) {
+        checksum = (checksum ^ data[i]) * 16777619u;
+    }
+    return checksum;
+}
@@ -0,0 +1,112 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  patch_cache.h
+ * @brief Patch Cache class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _PATCH_CACHE_H
+#define _PATCH_CACHE_H
+
+#define RAPIDJSON_HAS_STDSTRING 1
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <sys/stat.h>
+#include "rapidjson/document.h"
+
+// Patch cache constants
+constexpr char PATCH_CACHE_DIR[]            = "patch_cache/";
+constexpr uint32_t PATCH_CACHE_MAGIC        = 0x3143504e;  // "NPC1"
+constexpr uint32_t PATCH_CACHE_VERSION      = 1;
+constexpr uint NUM_PATCH_CACHE_SECTIONS     = 3;
+constexpr uint32_t PATCH_CACHE_NUMERIC      = 0xFFFFFFFF;
+constexpr uint DEFAULT_PATCH_CACHE_MEMORY_BUDGET_KB = 4096;
+
+// Patch cache file header
+// The header is followed by the entries for each section (common, state A,
+// state B) and then the string table
+struct PatchCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    int64_t patch_mtime_sec;
+    int64_t patch_mtime_nsec;
+    uint64_t patch_size;
+    uint32_t patch_path_len;
+    uint32_t extra_offset;
+    uint32_t extra_len;
+    uint32_t num_entries[NUM_PATCH_CACHE_SECTIONS];
+    uint32_t strings_size;
+    uint32_t checksum;
+};
+
+// Patch cache entry
+// The path and string value are offsets into the string table - if the string
+// value length is PATCH_CACHE_NUMERIC, the entry is a numeric value
+struct PatchCacheEntry
+{
+    uint32_t path_offset;
+    uint32_t path_len;
+    uint32_t str_value_offset;
+    uint32_t str_value_len;
+    float value;
+};
+
+// Patch cache memory entry - a parsed patch held in memory
+struct PatchCacheMemoryEntry
+{
+    std::string patch_file_path;
+    int64_t patch_mtime_sec;
+    int64_t patch_mtime_nsec;
+    uint64_t patch_size;
+    std::unique_ptr<rapidjson::Document> json_doc;
+    size_t memory_size;
+};
+
+// Patch Cache class
+// A binary copy of each loaded or saved patch, so that a patch can be loaded
+// without reading, parsing and validating the JSON patch file
+// The most recently used patches are also held in memory as parsed documents,
+// up to the memory budget
+// Each cached patch is invalidated if the JSON patch file size or modified
+// time changes
+class PatchCache
+{
+public:
+    // Constructor
+    PatchCache(std::string cache_dir);
+
+    // Destructor
+    virtual ~PatchCache();
+
+    // Public functions
+    void set_memory_budget(size_t budget);
+    bool load(const std::string& patch_file_path, rapidjson::Document& json_doc);
+    void save(const std::string& patch_file_path, const rapidjson::Document& json_doc);
+    bool in_memory(const std::string& patch_file_path);
+
+private:
+    // Private variables
+    std::string _cache_dir;
+    std::mutex _memory_mutex;
+    std::list<PatchCacheMemoryEntry> _memory_lru;
+    std::unordered_map<std::string, std::list<PatchCacheMemoryEntry>::iterator> _memory_index;
+    size_t _memory_size;
+    size_t _memory_budget;
+
+    bool _load_from_memory(const std::string& patch_file_path, const struct stat& patch_stat, rapidjson::Document& json_doc);
+    void _add_to_memory(const std::string& patch_file_path, const struct stat& patch_stat, const rapidjson::Document& json_doc);
+    void _remove_from_memory(std::list<PatchCacheMemoryEntry>::iterator itr);
+    std::string _get_cache_file_path(const std::string& patch_file_path);
+    bool _restore(const uint8_t *data, size_t size, const std::string& patch_file_path, const struct stat& patch_stat,
+                  rapidjson::Document& json_doc);
+    bool _add_entry(const rapidjson::Value& entry, std::vector<PatchCacheEntry>& entries, std::string& strings);
+    uint32_t _checksum(const uint8_t *data, size_t size);
+};
+
+#endif // _PATCH_CACHE_H
@@ -0,0 +1,420 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  patch_history.cpp
+ * @brief Patch History implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include "patch_history.h"
+#include "utils.h"
+
+// Constants
+constexpr uint JOURNAL_COMPACT_FACTOR = 4;
+constexpr uint32_t MAX_RECORD_PAYLOAD_LEN = 4096;
+
+//----------------------------------------------------------------------------
+// PatchHistory
+//----------------------------------------------------------------------------
+PatchHistory::PatchHistory(uint capacity)
+{
+    // Initialise class data
+    _journal_fd = -1;
+    _journal_num_records = 0;
+    _entries.resize(capacity);
+    _start = 0;
+    _count = 0;
+    _cursor = 0;
+}
+
+//----------------------------------------------------------------------------
+// ~PatchHistory
+//----------------------------------------------------------------------------
+PatchHistory::~PatchHistory()
+{
+    // Close the journal if open
+    if (_journal_fd != -1) {
+        ::close(_journal_fd);
+    }
+}
+
+//----------------------------------------------------------------------------
+// open
+//----------------------------------------------------------------------------
+bool PatchHistory::open(const std::string& journal_file_path, const std::vector<PatchId>& layer_patch_ids,
+                        std::vector<PatchHistoryEntry>& recovered_entries)
+{
+    bool clean_close = true;
+
+    // Read the existing journal, if any
+    _journal_file_path = journal_file_path;
+    std::ifstream journal_file(_journal_file_path, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(journal_file)), std::istreambuf_iterator<char>());
+    journal_file.close();
+
+    // Replay the journal to restore the history
+    // The history is only kept if the app did not exit cleanly and the same patches
+    // are loaded - in which case the applied changes are returned so that any unsaved
+    // edits can be recovered
+    if (_replay(data, clean_close) && !clean_close && (_layer_patch_ids == layer_patch_ids)) {
+        for (uint i=0; i<_cursor; i++) {
+            recovered_entries.push_back(_entry(i));
+        }
+    }
+    else {
+        _reset(layer_patch_ids);
+    }
+
+    // Rewrite the journal with just the current history, and open it for appending
+    _compact();
+    return _journal_fd != -1;
+}
+
+//----------------------------------------------------------------------------
+// close
+//----------------------------------------------------------------------------
+void PatchHistory::close()
+{
+    // Write any pending changes, and indicate the journal was closed cleanly
+    if (_journal_fd != -1) {
+        flush();
+        _append(PatchHistoryRecordType::CLOSE, nullptr);
+        ::close(_journal_fd);
+        _journal_fd = -1;
+    }
+}
+
+//----------------------------------------------------------------------------
+// add
+//----------------------------------------------------------------------------
+void PatchHistory::add(uint layer_num, ParamHandle handle, float prev_value, float value)
+{
+    // Is this param already pending?
+    // If so just update the value, so that a knob movement is a single history entry
+    for (auto& pending : _pending_entries) {
+        if ((pending.handle == handle) && (pending.layer_num == layer_num)) {
+            pending.value = value;
+            pending.timestamp_us = _timestamp_us();
+            return;
+        }
+    }
+
+    // Add the pending change
+    PatchHistoryEntry entry;
+    entry.handle = handle;
+    entry.layer_num = layer_num;
+    entry.prev_value = prev_value;
+    entry.value = value;
+    entry.timestamp_us = _timestamp_us();
+    _pending_entries.push_back(entry);
+}
+
+//----------------------------------------------------------------------------
+// flush
+//----------------------------------------------------------------------------
+void PatchHistory::flush()
+{
+    // Add each pending change to the history and the journal
+    for (const auto& entry : _pending_entries) {
+        if (entry.value != entry.prev_value) {
+            _push(entry);
+            _append(PatchHistoryRecordType::CHANGE, &entry);
+        }
+    }
+    _pending_entries.clear();
+
+    // Compact the journal if it has grown too large
+    if (_journal_num_records > (JOURNAL_COMPACT_FACTOR * _entries.size())) {
+        _compact();
+    }
+}
+
+//----------------------------------------------------------------------------
+// undo
+//----------------------------------------------------------------------------
+bool PatchHistory::undo(PatchHistoryEntry& entry)
+{
+    // Add any pending changes first, so that the last change is undone
+    flush();
+
+    // Is there a change to undo?
+    if (_cursor == 0) {
+        return false;
+    }
+    _cursor--;
+    entry = _entry(_cursor);
+    _append(PatchHistoryRecordType::UNDO, nullptr);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// redo
+//----------------------------------------------------------------------------
+bool PatchHistory::redo(PatchHistoryEntry& entry)
+{
+    // Add any pending changes first - these discard any undone changes
+    flush();
+
+    // Is there a change to redo?
+    if (_cursor == _count) {
+        return false;
+    }
+    entry = _entry(_cursor);
+    _cursor++;
+    _append(PatchHistoryRecordType::REDO, nullptr);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// clear
+//----------------------------------------------------------------------------
+void PatchHistory::clear(const std::vector<PatchId>& layer_patch_ids)
+{
+    // Clear the history, and indicate which patches are now loaded
+    _pending_entries.clear();
+    _reset(layer_patch_ids);
+    _append(PatchHistoryRecordType::CLEAR, nullptr);
+}
+
+//----------------------------------------------------------------------------
+// _push
+//----------------------------------------------------------------------------
+void PatchHistory::_push(const PatchHistoryEntry& entry)
+{
+    // A new change discards any undone changes
+    _count = _cursor;
+
+    // If the history is full, drop the oldest change
+    if (_count == _entries.size()) {
+        _start = (_start + 1) % _entries.size();
+        _count--;
+    }
+
+    // Add the change
+    _entries[(_start + _count) % _entries.size()] = entry;
+    _count++;
+    _cursor = _count;
+}
+
+//----------------------------------------------------------------------------
+// _reset
+//----------------------------------------------------------------------------
+void PatchHistory::_reset(const std::vector<PatchId>& layer_patch_ids)
+{
+    // Empty the history
+    _start = 0;
+    _count = 0;
+    _cursor = 0;
+    _layer_patch_ids = layer_patch_ids;
+}
+
+//----------------------------------------------------------------------------
+// _entry
+//----------------------------------------------------------------------------
+PatchHistoryEntry& PatchHistory::_entry(uint index)
+{
+    // Return the entry, oldest first
+    return _entries[(_start + index) % _entries.size()];
+}
+
+//----------------------------------------------------------------------------
+// _replay
+//----------------------------------------------------------------------------
+bool PatchHistory::_replay(const std::vector<uint8_t>& data, bool& clean_close)
+{
+    PatchHistoryJournalHeader header;
+    PatchHistoryRecord record;
+
+    // Check the journal header
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if ((header.magic != PATCH_HISTORY_JOURNAL_MAGIC) || (header.version != PATCH_HISTORY_JOURNAL_VERSION)) {
+        return false;
+    }
+
+    // Replay each record
+    // Note: A truncated last record (the app exited during the write) is ignored
+    _reset(std::vector<PatchId>());
+    size_t offset = sizeof(header);
+    while ((offset + sizeof(record)) <= data.size()) {
+        std::memcpy(&record, data.data() + offset, sizeof(record));
+        offset += sizeof(record);
+        if ((record.payload_len > MAX_RECORD_PAYLOAD_LEN) || ((offset + record.payload_len) > data.size())) {
+            break;
+        }
+        auto payload = data.data() + offset;
+        offset += record.payload_len;
+        clean_close = false;
+
+        // Process the record
+        switch (record.type) {
+            case PatchHistoryRecordType::CHANGE: {
+                // Get the param from the path, and add the change
+                // If the param no longer exists, the change is ignored
+                auto handle = utils::get_param_handle(std::string(reinterpret_cast<const char *>(payload), record.payload_len));
+                if (handle != INVALID_PARAM_HANDLE) {
+                    PatchHistoryEntry entry;
+                    entry.handle = handle;
+                    entry.layer_num = record.layer_num;
+                    entry.prev_value = record.prev_value;
+                    entry.value = record.value;
+                    entry.timestamp_us = record.timestamp_us;
+                    _push(entry);
+                }
+                break;
+            }
+
+            case PatchHistoryRecordType::UNDO:
+                if (_cursor > 0) {
+                    _cursor--;
+                }
+                break;
+
+            case PatchHistoryRecordType::REDO:
+                if (_cursor < _count) {
+                    _cursor++;
+                }
+                break;
+
+            case PatchHistoryRecordType::CLEAR: {
+                // Get the loaded patches
+                std::vector<PatchId> layer_patch_ids;
+                for (uint i=0; (i + (2 * sizeof(uint32_t))) <= record.payload_len; i += (2 * sizeof(uint32_t))) {
+                    uint32_t ids[2];
+                    std::memcpy(ids, payload + i, sizeof(ids));
+                    PatchId id;
+                    id.bank_num = ids[0];
+                    id.patch_num = ids[1];
+                    layer_patch_ids.push_back(id);
+                }
+                _reset(layer_patch_ids);
+                break;
+            }
+
+            case PatchHistoryRecordType::CLOSE:
+                clean_close = true;
+                break;
+
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _append
+//----------------------------------------------------------------------------
+void PatchHistory::_append(PatchHistoryRecordType type, const PatchHistoryEntry *entry)
+{
+    // Append the record to the journal
+    // Note: The journal is not synced, a record only needs to survive the app
+    // exiting unexpectedly
+    if (_journal_fd != -1) {
+        std::string data;
+        _append_record(data, type, entry);
+        if (::write(_journal_fd, data.data(), data.size()) == (ssize_t)data.size()) {
+            _journal_num_records++;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _append_record
+//----------------------------------------------------------------------------
+void PatchHistory::_append_record(std::string& data, PatchHistoryRecordType type, const PatchHistoryEntry *entry)
+{
+    PatchHistoryRecord record = {};
+    std::string payload;
+
+    // Set the record and its payload
+    record.type = type;
+    if (entry) {
+        record.layer_num = entry->layer_num;
+        record.prev_value = entry->prev_value;
+        record.value = entry->value;
+        record.timestamp_us = entry->timestamp_us;
+        if (type == PatchHistoryRecordType::CHANGE) {
+            payload = utils::get_param_path(entry->handle);
+        }
+    }
+    else {
+        record.timestamp_us = _timestamp_us();
+    }
+    if (type == PatchHistoryRecordType::CLEAR) {
+        for (const auto& id : _layer_patch_ids) {
+            uint32_t ids[2] = { id.bank_num, id.patch_num };
+            payload.append(reinterpret_cast<const char *>(ids), sizeof(ids));
+        }
+    }
+    record.payload_len = payload.size();
+    data.append(reinterpret_cast<const char *>(&record), sizeof(record));
+    data.append(payload);
+}
+
+//----------------------------------------------------------------------------
+// _compact
+//----------------------------------------------------------------------------
+void PatchHistory::_compact()
+{
+    PatchHistoryJournalHeader header = { PATCH_HISTORY_JOURNAL_MAGIC, PATCH_HISTORY_JOURNAL_VERSION };
+    std::string data;
+    uint num_records = 0;
+
+    // Build the compacted journal - the loaded patches, each change in the history, and
+    // then an undo for each undone change
+    data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    _append_record(data, PatchHistoryRecordType::CLEAR, nullptr);
+    num_records++;
+    for (uint i=0; i<_count; i++) {
+        _append_record(data, PatchHistoryRecordType::CHANGE, &_entry(i));
+        num_records++;
+    }
+    for (uint i=_cursor; i<_count; i++) {
+        _append_record(data, PatchHistoryRecordType::UNDO, nullptr);
+        num_records++;
+    }
+
+    // Close the current journal
+    if (_journal_fd != -1) {
+        ::close(_journal_fd);
+        _journal_fd = -1;
+    }
+
+    // Write the compacted journal to a temporary file, and then replace the journal
+    // so that the journal is never left partially written
+    auto tmp_file_path = _journal_file_path + ".tmp";
+    int fd = ::open(tmp_file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return;
+    }
+    bool written = (::write(fd, data.data(), data.size()) == (ssize_t)data.size());
+    written = (::close(fd) == 0) && written;
+    if (!written || (std::rename(tmp_file_path.c_str(), _journal_file_path.c_str()) != 0)) {
+        (void)std::remove(tmp_file_path.c_str());
+        return;
+    }
+
+    // Open the journal for appending
+    _journal_fd = ::open(_journal_file_path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    _journal_num_records = num_records;
+}
+
+//----------------------------------------------------------------------------
+// _timestamp_us
+//----------------------------------------------------------------------------
+uint64_t PatchHistory::_timestamp_us()
+{
+    // Return the current time in microseconds
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,109 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  patch_history.h
+ * @brief Patch History class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _PATCH_HISTORY_H
+#define _PATCH_HISTORY_H
+
+#include <string>
+#include <vector>
+#include "param.h"
+#include "common.h"
+
+// Patch history constants
+constexpr uint32_t PATCH_HISTORY_JOURNAL_MAGIC   = 0x3148504e;  // "NPH1"
+constexpr uint32_t PATCH_HISTORY_JOURNAL_VERSION = 1;
+constexpr uint DEFAULT_PATCH_HISTORY_CAPACITY    = 1000;
+
+// Patch history journal record types
+enum class PatchHistoryRecordType : uint32_t
+{
+    CHANGE = 0,
+    UNDO,
+    REDO,
+    CLEAR,
+    CLOSE
+};
+
+// Patch history journal file header
+struct PatchHistoryJournalHeader
+{
+    uint32_t magic;
+    uint32_t version;
+};
+
+// Patch history journal record
+// Each record is followed by its payload - the param path for a CHANGE record,
+// or the patch ID of each layer for a CLEAR record
+struct PatchHistoryRecord
+{
+    PatchHistoryRecordType type;
+    uint32_t layer_num;
+    float prev_value;
+    float value;
+    uint64_t timestamp_us;
+    uint32_t payload_len;
+};
+
+// Patch history entry
+struct PatchHistoryEntry
+{
+    ParamHandle handle;
+    uint layer_num;
+    float prev_value;
+    float value;
+    uint64_t timestamp_us;
+};
+
+// Patch History class
+// The param changes made to the loaded patches, held in a fixed size ring buffer
+// for undo and redo
+// Each change, undo and redo is appended to a binary journal, so that the history
+// (and any unsaved edits) can be recovered if the app exits unexpectedly - the
+// journal is compacted when it grows to several times the ring buffer size
+class PatchHistory
+{
+public:
+    // Constructor
+    PatchHistory(uint capacity=DEFAULT_PATCH_HISTORY_CAPACITY);
+
+    // Destructor
+    virtual ~PatchHistory();
+
+    // Public functions
+    bool open(const std::string& journal_file_path, const std::vector<PatchId>& layer_patch_ids,
+              std::vector<PatchHistoryEntry>& recovered_entries);
+    void close();
+    void add(uint layer_num, ParamHandle handle, float prev_value, float value);
+    void flush();
+    bool undo(PatchHistoryEntry& entry);
+    bool redo(PatchHistoryEntry& entry);
+    void clear(const std::vector<PatchId>& layer_patch_ids);
+
+private:
+    // Private variables
+    std::string _journal_file_path;
+    int _journal_fd;
+    uint _journal_num_records;
+    std::vector<PatchHistoryEntry> _entries;
+    uint _start;
+    uint _count;
+    uint _cursor;
+    std::vector<PatchHistoryEntry> _pending_entries;
+    std::vector<PatchId> _layer_patch_ids;
+
+    void _push(const PatchHistoryEntry& entry);
+    void _reset(const std::vector<PatchId>& layer_patch_ids);
+    PatchHistoryEntry& _entry(uint index);
+    bool _replay(const std::vector<uint8_t>& data, bool& clean_close);
+    void _append(PatchHistoryRecordType type, const PatchHistoryEntry *entry);
+    void _append_record(std::string& data, PatchHistoryRecordType type, const PatchHistoryEntry *entry);
+    void _compact();
+    uint64_t _timestamp_us();
+};
+
+#endif // _PATCH_HISTORY_H
@@ -0,0 +1,184 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  scheduled_note_queue.cpp
+ * @brief Scheduled Note Queue implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <iostream>
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include "scheduled_note_queue.h"
+#include "clock_engine.h"
+#include "base_manager.h"
+#include "utils.h"
+
+// Constants
+constexpr uint DUE_NOTE_RING_NUM_SLOTS = 256;   // Must be a power of 2
+constexpr uint DUE_NOTE_RING_SLOT_MASK = (DUE_NOTE_RING_NUM_SLOTS - 1);
+
+// Scheduled note
+struct ScheduledNote
+{
+    uint64_t tick;
+    snd_seq_event_t note;
+};
+
+// Due note ring
+// A single producer, single consumer ring of the notes due to be received by the
+// next stage - the producers are serialised by the source queue send mutex, and
+// the consumers by the next stage
+struct DueNoteRing
+{
+    snd_seq_event_t notes[DUE_NOTE_RING_NUM_SLOTS];
+    alignas(64) std::atomic<uint> head{0};
+    alignas(64) std::atomic<uint> tail{0};
+};
+
+// Scheduled note source queue
+// The queue mutex protects the scheduled notes, and the send mutex is held while
+// the notes are sent, so that notes from the same source are never re-ordered
+struct ScheduledNoteSourceQueue
+{
+    std::mutex queue_mutex;
+    std::mutex send_mutex;
+    std::deque<ScheduledNote> notes;
+    DueNoteRing due_notes;
+};
+
+// Private variables
+static ScheduledNoteSourceQueue _scheduled_note_queues[static_cast<uint>(ScheduledNoteSource::NUM_SOURCES)];
+
+// Static functions
+static void _send_scheduled_notes(ScheduledNoteSource source, uint64_t tick, bool flush);
+static void _send_due_note(ScheduledNoteSource source, const snd_seq_event_t &note);
+static void _send_note(ScheduledNoteSource source, const snd_seq_event_t &note);
+
+//----------------------------------------------------------------------------
+// Send
+//----------------------------------------------------------------------------
+void ScheduledNoteQueue::Send(ScheduledNoteSource source, uint64_t tick, const snd_seq_event_t &note)
+{
+    auto& queue = _scheduled_note_queues[static_cast<uint>(source)];
+
+    // Is the note due at a future tick?
+    if (tick > ClockEngine::TickCount())
+    {
+        // Add the note to the queue, after any notes scheduled for the same tick
+        std::lock_guard<std::mutex> lock(queue.queue_mutex);
+        auto itr = std::upper_bound(queue.notes.begin(), queue.notes.end(), tick, [](uint64_t t, const ScheduledNote& n) {
+            return t < n.tick;
+        });
+        queue.notes.insert(itr, {tick, note});
+        return;
+    }
+
+    // Send any notes still scheduled by this source, and then the note
+    std::lock_guard<std::mutex> lock(queue.send_mutex);
+    _send_scheduled_notes(source, 0, true);
+    _send_note(source, note);
+}
+
+//----------------------------------------------------------------------------
+// Process
+//----------------------------------------------------------------------------
+void ScheduledNoteQueue::Process(uint64_t tick)
+{
+    // Send the notes due at or before this tick, for each source
+    for (uint i=0; i<static_cast<uint>(ScheduledNoteSource::NUM_SOURCES); i++)
+    {
+        std::lock_guard<std::mutex> lock(_scheduled_note_queues[i].send_mutex);
+        _send_scheduled_notes(static_cast<ScheduledNoteSource>(i), tick, false);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Receive
+// Note: The receives for a source must be serialised by the caller
+//----------------------------------------------------------------------------
+bool ScheduledNoteQueue::Receive(ScheduledNoteSource source, snd_seq_event_t &note)
+{
+    auto& ring = _scheduled_note_queues[static_cast<uint>(source)].due_notes;
+
+    // Is there a due note to receive?
+    uint tail = ring.tail.load(std::memory_order_relaxed);
+    if (tail == ring.head.load(std::memory_order_acquire))
+        return false;
+
+    // Receive the note, and release the slot
+    note = ring.notes[tail & DUE_NOTE_RING_SLOT_MASK];
+    ring.tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _send_scheduled_notes
+// Note: The source queue send mutex must be held by the caller
+//----------------------------------------------------------------------------
+static void _send_scheduled_notes(ScheduledNoteSource source, uint64_t tick, bool flush)
+{
+    auto& queue = _scheduled_note_queues[static_cast<uint>(source)];
+    std::vector<snd_seq_event_t> notes;
+
+    // Take the due notes (or all notes if flushing) from the queue
+    {
+        std::lock_guard<std::mutex> lock(queue.queue_mutex);
+        while (!queue.notes.empty() && (flush || (queue.notes.front().tick <= tick)))
+        {
+            notes.push_back(queue.notes.front().note);
+            queue.notes.pop_front();
+        }
+    }
+
+    // Send the notes in order
+    // Note: The queue mutex is not held, so the source can schedule notes while they
+    // are being sent
+    for (const auto& note : notes)
+    {
+        _send_due_note(source, note);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _send_due_note
+// Note: The source queue send mutex must be held by the caller
+//----------------------------------------------------------------------------
+static void _send_due_note(ScheduledNoteSource source, const snd_seq_event_t &note)
+{
+    // Is this a Sequencer note?
+    if (source == ScheduledNoteSource::SEQUENCER)
+    {
+        auto& ring = _scheduled_note_queues[static_cast<uint>(source)].due_notes;
+
+        // Add the note to the due note ring, to be received by the Arpeggiator
+        uint head = ring.head.load(std::memory_order_relaxed);
+        if ((head - ring.tail.load(std::memory_order_acquire)) < DUE_NOTE_RING_NUM_SLOTS)
+        {
+            ring.notes[head & DUE_NOTE_RING_SLOT_MASK] = note;
+            ring.head.store(head + 1, std::memory_order_release);
+            return;
+        }
+
+        // The ring is full, so send the note directly - the Arpeggiator receives the
+        // notes in the ring first, so the order is kept
+        DEBUG_MSG("Scheduled note ring full, sending the note directly");
+    }
+    _send_note(source, note);
+}
+
+//----------------------------------------------------------------------------
+// _send_note
+//----------------------------------------------------------------------------
+static void _send_note(ScheduledNoteSource source, const snd_seq_event_t &note)
+{
+    // Send the note directly to the next stage - the Sequencer notes are sent to the
+    // Arpeggiator, and the Arpeggiator notes to the DAW
+    auto manager = utils::get_manager((source == ScheduledNoteSource::SEQUENCER) ? NinaModule::ARPEGGIATOR : NinaModule::DAW);
+    if (manager)
+        manager->process_midi_event_direct(&note);
+}
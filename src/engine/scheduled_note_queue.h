@@ -0,0 +1,50 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  scheduled_note_queue.h
+ * @brief Scheduled Note Queue class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _SCHEDULED_NOTE_QUEUE_H
+#define _SCHEDULED_NOTE_QUEUE_H
+
+#include "alsa/asoundlib.h"
+#include "common.h"
+
+// Scheduled note queue constants
+// The number of clock ticks the sequencer and arpeggiator process their FSMs ahead
+// of each note being due
+constexpr uint SCHEDULED_NOTE_LOOKAHEAD_TICKS = 1;
+
+// Scheduled note sources
+// The Sequencer notes are sent to the Arpeggiator, and the Arpeggiator notes to
+// the DAW
+enum class ScheduledNoteSource
+{
+    SEQUENCER,
+    ARPEGGIATOR,
+    NUM_SOURCES
+};
+
+// Scheduled Note Queue class
+// The notes generated by the sequencer and arpeggiator FSMs ahead of time, each
+// timestamped with the clock engine tick it is due at - the queue is drained by
+// the clock engine thread at each tick, so the note timing does not depend on the
+// wakeup latency of the sequencer and arpeggiator threads
+// A note sent immediately by a source first sends any notes still scheduled by that
+// source, so the notes from each source are always sent in order
+// The Sequencer notes are not sent to the Arpeggiator on the clock engine thread, as
+// the Arpeggiator holds its mutex while processing - they are passed via a lock-free
+// ring, and received by the Arpeggiator when next signalled (or before its next note
+// sent immediately)
+class ScheduledNoteQueue
+{
+public:
+    // Public functions
+    static void Send(ScheduledNoteSource source, uint64_t tick, const snd_seq_event_t &note);
+    static void Process(uint64_t tick);
+    static bool Receive(ScheduledNoteSource source, snd_seq_event_t &note);
+};
+
+#endif // _SCHEDULED_NOTE_QUEUE_H
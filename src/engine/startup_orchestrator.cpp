@@ -0,0 +1,216 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  startup_orchestrator.cpp
+ * @brief Startup Orchestrator implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <thread>
+#include <algorithm>
+#include "startup_orchestrator.h"
+#include "logger.h"
+
+//----------------------------------------------------------------------------
+// StartupOrchestrator
+//----------------------------------------------------------------------------
+StartupOrchestrator::StartupOrchestrator()
+{
+    // Initialise class data
+    _boot_time = std::chrono::steady_clock::now();
+}
+
+//----------------------------------------------------------------------------
+// ~StartupOrchestrator
+//----------------------------------------------------------------------------
+StartupOrchestrator::~StartupOrchestrator()
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// add
+//----------------------------------------------------------------------------
+void StartupOrchestrator::add(BaseManager *manager, std::vector<BaseManager *> dependencies, bool critical)
+{
+    // Add the manager to be started on the next call to start
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.push_back(Entry{manager, dependencies, critical, State::PENDING, {}, {}});
+}
+
+//----------------------------------------------------------------------------
+// start
+//----------------------------------------------------------------------------
+bool StartupOrchestrator::start()
+{
+    std::vector<Entry *> entries;
+
+    // Get the entries not yet started, and mark them as starting
+    // Note: This is done before any are started, so that a manager only waits on
+    // dependencies in this or a previous start
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (Entry& entry : _entries)
+        {
+            if (entry.state == State::PENDING)
+            {
+                entry.state = State::STARTING;
+                entries.push_back(&entry);
+            }
+        }
+    }
+
+    // Start each manager in its own thread - each waits for its dependencies to be
+    // ready before starting
+    std::vector<std::thread> threads;
+    for (Entry *entry : entries)
+    {
+        threads.emplace_back(&StartupOrchestrator::_start_manager, this, std::ref(*entry));
+    }
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+
+    // Log the boot timeline
+    _log_boot_timeline(entries);
+
+    // Return false if any critical manager failed to start
+    std::lock_guard<std::mutex> lock(_mutex);
+    return std::none_of(entries.begin(), entries.end(), [](const Entry *e) { return e->critical && (e->state == State::FAILED); });
+}
+
+//----------------------------------------------------------------------------
+// stop
+//----------------------------------------------------------------------------
+void StartupOrchestrator::stop()
+{
+    std::vector<Entry *> start_order;
+
+    // Get the managers in the order they were started, and clear it so they are
+    // only stopped once
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        start_order.swap(_start_order);
+    }
+
+    // Stop the managers in reverse order, so that a manager is stopped before
+    // its dependencies are
+    for (auto itr = start_order.rbegin(); itr != start_order.rend(); ++itr)
+    {
+        (*itr)->manager->stop();
+    }
+}
+
+//----------------------------------------------------------------------------
+// _start_manager
+//----------------------------------------------------------------------------
+void StartupOrchestrator::_start_manager(Entry& entry)
+{
+    // Wait for the dependencies to be ready (or have failed)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this, &entry]{ return _dependencies_done(entry); });
+
+        // If a critical dependency failed, don't start this manager
+        if (_critical_dependency_failed(entry))
+        {
+            entry.state = State::FAILED;
+            lock.unlock();
+            _cv.notify_all();
+            NINA_LOG_ERROR(entry.manager->module(), "{} not started, a critical dependency failed to start", entry.manager->name());
+            return;
+        }
+        entry.start_time = std::chrono::steady_clock::now();
+        _start_order.push_back(&entry);
+    }
+
+    // Start the manager, and wait for it to be processing events
+    bool ready = entry.manager->start();
+    if (ready && !entry.manager->wait_ready(STARTUP_READY_TIMEOUT))
+    {
+        // Don't hold up the dependent managers forever, but flag this
+        NINA_LOG_WARNING(entry.manager->module(), "{} did not become ready within {}ms", entry.manager->name(), STARTUP_READY_TIMEOUT.count());
+    }
+    else if (!ready)
+    {
+        NINA_LOG_ERROR(entry.manager->module(), "{} failed to start", entry.manager->name());
+    }
+
+    // Update the state and notify the managers waiting on this one
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        entry.ready_time = std::chrono::steady_clock::now();
+        entry.state = ready ? State::READY : State::FAILED;
+    }
+    _cv.notify_all();
+}
+
+//----------------------------------------------------------------------------
+// _dependencies_done
+// Note: The orchestrator mutex must be held by the caller
+//----------------------------------------------------------------------------
+bool StartupOrchestrator::_dependencies_done(const Entry& entry)
+{
+    // A dependency is done once it is ready or has failed - a dependency not added
+    // to the orchestrator, or not being started, is not waited on
+    for (const BaseManager *dependency : entry.dependencies)
+    {
+        auto dep_entry = _find_entry(dependency);
+        if (dep_entry && (dep_entry->state == State::STARTING))
+            return false;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _critical_dependency_failed
+// Note: The orchestrator mutex must be held by the caller
+//----------------------------------------------------------------------------
+bool StartupOrchestrator::_critical_dependency_failed(const Entry& entry)
+{
+    // Check if any critical dependency failed to start
+    for (const BaseManager *dependency : entry.dependencies)
+    {
+        auto dep_entry = _find_entry(dependency);
+        if (dep_entry && dep_entry->critical && (dep_entry->state == State::FAILED))
+            return true;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// _find_entry
+// Note: The orchestrator mutex must be held by the caller
+//----------------------------------------------------------------------------
+StartupOrchestrator::Entry *StartupOrchestrator::_find_entry(const BaseManager *manager)
+{
+    // Find the entry for this manager, if any
+    auto itr = std::find_if(_entries.begin(), _entries.end(), [manager](const Entry& e) { return e.manager == manager; });
+    return (itr != _entries.end()) ? &(*itr) : nullptr;
+}
+
+//----------------------------------------------------------------------------
+// _log_boot_timeline
+//----------------------------------------------------------------------------
+void StartupOrchestrator::_log_boot_timeline(const std::vector<Entry *>& entries)
+{
+    std::chrono::steady_clock::time_point last_ready_time = _boot_time;
+
+    // Log when each manager was started and ready, relative to the boot time
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const Entry *entry : _start_order)
+    {
+        // Only log the managers started in this batch
+        if (std::find(entries.begin(), entries.end(), entry) == entries.end())
+            continue;
+        auto start_ms = std::chrono::duration_cast<std::chrono::milliseconds>(entry->start_time - _boot_time).count();
+        auto ready_ms = std::chrono::duration_cast<std::chrono::milliseconds>(entry->ready_time - _boot_time).count();
+        NINA_LOG_INFO(NinaModule::ANY, "Boot: {} started {}ms, {} {}ms", entry->manager->name(), start_ms,
+                      (entry->state == State::READY ? "ready" : "failed"), ready_ms);
+        last_ready_time = std::max(last_ready_time, entry->ready_time);
+    }
+    NINA_LOG_INFO(NinaModule::ANY, "Boot: {} managers started, all ready {}ms", entries.size(),
+                  std::chrono::duration_cast<std::chrono::milliseconds>(last_ready_time - _boot_time).count());
+}
@@ -0,0 +1,73 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  startup_orchestrator.h
+ * @brief Startup Orchestrator class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _STARTUP_ORCHESTRATOR_H
+#define _STARTUP_ORCHESTRATOR_H
+
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include "base_manager.h"
+
+// Startup constants
+constexpr std::chrono::milliseconds STARTUP_READY_TIMEOUT = std::chrono::milliseconds(30000);
+
+// Startup Orchestrator class
+// Starts the managers concurrently - each manager is started once all of its
+// dependencies are ready, and stopped in the reverse order they were started
+class StartupOrchestrator
+{
+public:
+    // Constructor/destructor
+    StartupOrchestrator();
+    ~StartupOrchestrator();
+
+    // Public functions
+    void add(BaseManager *manager, std::vector<BaseManager *> dependencies = {}, bool critical = false);
+    bool start();
+    void stop();
+
+private:
+    // Startup state
+    enum class State
+    {
+        PENDING,
+        STARTING,
+        READY,
+        FAILED
+    };
+
+    // Startup entry
+    struct Entry
+    {
+        BaseManager *manager;
+        std::vector<BaseManager *> dependencies;
+        bool critical;
+        State state;
+        std::chrono::steady_clock::time_point start_time;
+        std::chrono::steady_clock::time_point ready_time;
+    };
+
+    // Private variables
+    std::deque<Entry> _entries;
+    std::vector<Entry *> _start_order;
+    std::chrono::steady_clock::time_point _boot_time;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+
+    // Private functions
+    void _start_manager(Entry& entry);
+    bool _dependencies_done(const Entry& entry);
+    bool _critical_dependency_failed(const Entry& entry);
+    Entry *_find_entry(const BaseManager *manager);
+    void _log_boot_timeline(const std::vector<Entry *>& entries);
+};
+
+#endif // _STARTUP_ORCHESTRATOR_H
@@ -0,0 +1,121 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  sushi_write_queue.cpp
+ * @brief Sushi Write Queue implementation.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <assert.h>
+#include "sushi_write_queue.h"
+
+//----------------------------------------------------------------------------
+// SushiWriteQueue
+//----------------------------------------------------------------------------
+SushiWriteQueue::SushiWriteQueue(uint reserve_size)
+{
+    // Initialise class data
+    _param_values.reserve(reserve_size);
+    _trace_ids.reserve(reserve_size);
+    _layers_masks.reserve(reserve_size);
+    _prev_index.reserve(reserve_size);
+}
+
+//----------------------------------------------------------------------------
+// ~SushiWriteQueue
+//----------------------------------------------------------------------------
+SushiWriteQueue::~SushiWriteQueue()
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// push
+//----------------------------------------------------------------------------
+bool SushiWriteQueue::push(uint64_t param_key, uint layers_mask, const sushi_controller::ParameterValue& param_value, LatencyTraceId trace_id)
+{
+    assert(layers_mask < 0x10);
+
+    // Has a write for this param and layers already been queued?
+    // If so, it can only be coalesced if no write queued after it for this param
+    // overlaps these layers
+    uint64_t key = (param_key << 4) | layers_mask;
+    auto itr = _index.find(key);
+    auto last_itr = _last_index.find(param_key);
+    if (itr != _index.end())
+    {
+        // Check the writes for this param queued after it
+        for (uint pos = last_itr->second; pos != itr->second; pos = _prev_index[pos])
+        {
+            if (_layers_masks[pos] & layers_mask)
+            {
+                itr = _index.end();
+                break;
+            }
+        }
+        if (itr != _index.end())
+        {
+            // Coalesce the write, the last value wins
+            // Note: A traced write keeps its trace if coalesced with an untraced write
+            _param_values[itr->second].value = param_value.value;
+            if (trace_id != NO_LATENCY_TRACE_ID)
+                _trace_ids[itr->second] = trace_id;
+            return true;
+        }
+    }
+
+    // Queue the write, linked to the previous write queued for this param (any
+    // layers), if any
+    uint pos = _param_values.size();
+    _index[key] = pos;
+    if (last_itr != _last_index.end())
+    {
+        _prev_index.push_back(last_itr->second);
+        last_itr->second = pos;
+    }
+    else
+    {
+        _prev_index.push_back(pos);
+        _last_index.emplace(param_key, pos);
+    }
+    _param_values.push_back(param_value);
+    _trace_ids.push_back(trace_id);
+    _layers_masks.push_back(layers_mask);
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// empty
+//----------------------------------------------------------------------------
+bool SushiWriteQueue::empty() const
+{
+    return _param_values.empty();
+}
+
+//----------------------------------------------------------------------------
+// size
+//----------------------------------------------------------------------------
+uint SushiWriteQueue::size() const
+{
+    return _param_values.size();
+}
+
+//----------------------------------------------------------------------------
+// take
+//----------------------------------------------------------------------------
+void SushiWriteQueue::take(std::vector<sushi_controller::ParameterValue>& param_values, std::vector<LatencyTraceId>& trace_ids)
+{
+    // Swap the queued writes (in the order queued) into the passed vectors, and
+    // clear the queue
+    // Note: The passed vectors are expected to be empty, and are swapped rather
+    // than copied so their capacity is re-used by the queue
+    param_values.swap(_param_values);
+    trace_ids.swap(_trace_ids);
+    _param_values.clear();
+    _trace_ids.clear();
+    _layers_masks.clear();
+    _prev_index.clear();
+    _index.clear();
+    _last_index.clear();
+}
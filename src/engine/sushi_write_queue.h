@@ -0,0 +1,47 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  sushi_write_queue.h
+ * @brief Sushi Write Queue class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _SUSHI_WRITE_QUEUE_H
+#define _SUSHI_WRITE_QUEUE_H
+
+#include <vector>
+#include <unordered_map>
+#include "sushi_client.h"
+#include "latency_trace.h"
+
+// Sushi Write Queue class
+// The param writes queued to send to Sushi - a write to a param (and layers) already
+// queued is coalesced with that write (last value wins), unless a write to the same
+// param for overlapping layers has been queued after it, so that the writes are
+// always applied in the order they were made
+class SushiWriteQueue
+{
+public:
+    // Constructor/destructor
+    SushiWriteQueue(uint reserve_size=0);
+    ~SushiWriteQueue();
+
+    // Public functions
+    // Note: The param key identifies the param for any layers, and the layers mask
+    // must be less than 0x10
+    bool push(uint64_t param_key, uint layers_mask, const sushi_controller::ParameterValue& param_value, LatencyTraceId trace_id);
+    bool empty() const;
+    uint size() const;
+    void take(std::vector<sushi_controller::ParameterValue>& param_values, std::vector<LatencyTraceId>& trace_ids);
+
+private:
+    // Private variables
+    std::vector<sushi_controller::ParameterValue> _param_values;
+    std::vector<LatencyTraceId> _trace_ids;
+    std::vector<uint> _layers_masks;
+    std::vector<uint> _prev_index;
+    std::unordered_map<uint64_t, uint> _index;
+    std::unordered_map<uint64_t, uint> _last_index;
+};
+
+#endif // _SUSHI_WRITE_QUEUE_H
@@ -27,6 +27,13 @@ SystemConfig::SystemConfig()
     _osc_incoming_port = "";
     _osc_outgoing_port = "";
     _osc_send_count = DEFAULT_OSC_SEND_COUNT;
+    _note_transport = NoteTransport::GRPC;
+    _pretty_json_files = true;
+    _patch_cache_memory_budget = 0;
+    _surface_poll_min_interval = DEFAULT_SURFACE_POLL_MIN_INTERVAL_MS;
+    _surface_poll_max_interval = DEFAULT_SURFACE_POLL_MAX_INTERVAL_MS;
+    _latency_trace_sample_interval = DEFAULT_LATENCY_TRACE_SAMPLE_INTERVAL;
+    _midi_event_queue_min_interval = DEFAULT_MIDI_EVENT_QUEUE_MIN_INTERVAL_MS;
 }
 
 //----------------------------------------------------------------------------
@@ -224,3 +231,129 @@ uint SystemConfig::osc_send_count()
     // Return the OSC send count
     return _osc_send_count;
 }
+
+//----------------------------------------------------------------------------
+// get_note_transport
+//----------------------------------------------------------------------------
+NoteTransport SystemConfig::get_note_transport()
+{
+    // Return the note transport
+    return _note_transport;
+}
+
+//----------------------------------------------------------------------------
+// set_note_transport
+//----------------------------------------------------------------------------
+void SystemConfig::set_note_transport(NoteTransport transport)
+{
+    // Set the note transport
+    _note_transport = transport;
+}
+
+//----------------------------------------------------------------------------
+// get_pretty_json_files
+//----------------------------------------------------------------------------
+bool SystemConfig::get_pretty_json_files()
+{
+    // Return if JSON files are saved pretty printed
+    return _pretty_json_files;
+}
+
+//----------------------------------------------------------------------------
+// set_pretty_json_files
+//----------------------------------------------------------------------------
+void SystemConfig::set_pretty_json_files(bool pretty)
+{
+    // Set if JSON files are saved pretty printed or compact
+    _pretty_json_files = pretty;
+}
+
+//----------------------------------------------------------------------------
+// get_patch_cache_memory_budget
+//----------------------------------------------------------------------------
+uint SystemConfig::get_patch_cache_memory_budget()
+{
+    // Return the patch cache memory budget (KB)
+    return _patch_cache_memory_budget;
+}
+
+//----------------------------------------------------------------------------
+// set_patch_cache_memory_budget
+//----------------------------------------------------------------------------
+void SystemConfig::set_patch_cache_memory_budget(uint budget_kb)
+{
+    // Set the patch cache memory budget (KB)
+    _patch_cache_memory_budget = budget_kb;
+}
+
+//----------------------------------------------------------------------------
+// get_surface_poll_min_interval
+//----------------------------------------------------------------------------
+uint SystemConfig::get_surface_poll_min_interval()
+{
+    // Return the surface poll minimum interval (ms)
+    return _surface_poll_min_interval;
+}
+
+//----------------------------------------------------------------------------
+// get_surface_poll_max_interval
+//----------------------------------------------------------------------------
+uint SystemConfig::get_surface_poll_max_interval()
+{
+    // Return the surface poll maximum interval (ms)
+    return _surface_poll_max_interval;
+}
+
+//----------------------------------------------------------------------------
+// set_surface_poll_min_interval
+//----------------------------------------------------------------------------
+void SystemConfig::set_surface_poll_min_interval(uint interval_ms)
+{
+    // Set the surface poll minimum interval (ms)
+    _surface_poll_min_interval = interval_ms;
+}
+
+//----------------------------------------------------------------------------
+// set_surface_poll_max_interval
+//----------------------------------------------------------------------------
+void SystemConfig::set_surface_poll_max_interval(uint interval_ms)
+{
+    // Set the surface poll maximum interval (ms)
+    _surface_poll_max_interval = interval_ms;
+}
+
+//----------------------------------------------------------------------------
+// get_latency_trace_sample_interval
+//----------------------------------------------------------------------------
+uint SystemConfig::get_latency_trace_sample_interval()
+{
+    // Return the latency trace sample interval (0 if disabled)
+    return _latency_trace_sample_interval;
+}
+
+//----------------------------------------------------------------------------
+// set_latency_trace_sample_interval
+//----------------------------------------------------------------------------
+void SystemConfig::set_latency_trace_sample_interval(uint sample_interval)
+{
+    // Set the latency trace sample interval (0 if disabled)
+    _latency_trace_sample_interval = sample_interval;
+}
+
+//----------------------------------------------------------------------------
+// get_midi_event_queue_min_interval
+//----------------------------------------------------------------------------
+uint SystemConfig::get_midi_event_queue_min_interval()
+{
+    // Return the MIDI event queue minimum batching interval (ms)
+    return _midi_event_queue_min_interval;
+}
+
+//----------------------------------------------------------------------------
+// set_midi_event_queue_min_interval
+//----------------------------------------------------------------------------
+void SystemConfig::set_midi_event_queue_min_interval(uint interval_ms)
+{
+    // Set the MIDI event queue minimum batching interval (ms)
+    _midi_event_queue_min_interval = interval_ms;
+}
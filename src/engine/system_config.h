@@ -13,6 +13,14 @@
 #include "param.h"
 #include "common.h"
 
+// Note Transport
+// How note events are sent to Sushi
+enum class NoteTransport
+{
+    GRPC,
+    ALSA_SEQ
+};
+
 // System Config struct
 class SystemConfig
 {
@@ -44,6 +52,20 @@ public:
     const char *osc_incoming_port();
     const char *osc_outgoing_port();
     uint osc_send_count();
+    NoteTransport get_note_transport();
+    void set_note_transport(NoteTransport transport);
+    bool get_pretty_json_files();
+    void set_pretty_json_files(bool pretty);
+    uint get_patch_cache_memory_budget();
+    void set_patch_cache_memory_budget(uint budget_kb);
+    uint get_surface_poll_min_interval();
+    uint get_surface_poll_max_interval();
+    void set_surface_poll_min_interval(uint interval_ms);
+    void set_surface_poll_max_interval(uint interval_ms);
+    uint get_latency_trace_sample_interval();
+    void set_latency_trace_sample_interval(uint sample_interval);
+    uint get_midi_event_queue_min_interval();
+    void set_midi_event_queue_min_interval(uint interval_ms);
 
 private:
     // Private variables
@@ -58,6 +80,13 @@ private:
     const char *_osc_incoming_port;
     const char *_osc_outgoing_port;
     uint _osc_send_count;
+    NoteTransport _note_transport;
+    bool _pretty_json_files;
+    uint _patch_cache_memory_budget;
+    uint _surface_poll_min_interval;
+    uint _surface_poll_max_interval;
+    uint _latency_trace_sample_interval;
+    uint _midi_event_queue_min_interval;
     std::mutex _mutex;
 };
 
@@ -55,7 +55,9 @@ const char *SystemFunc::_type_names[] = {
     "start_calibration",
     "finish_calibration",
     "system_colour_set",
-    "eg_2_level_mod_dst"
+    "eg_2_level_mod_dst",
+    "prefetch_patches",
+    "redo_last_param_change"
 };
 
 //----------------------------------------------------------------------------
@@ -142,6 +144,10 @@ void SystemFunc::RegisterParams()
     utils::register_param(std::move(param));
     param = SystemFuncParam::CreateParam(SystemFuncType::EG_2_LEVEL_MOD_DST);
     utils::register_param(std::move(param));
+    param = SystemFuncParam::CreateParam(SystemFuncType::PREFETCH_PATCHES);
+    utils::register_param(std::move(param));
+    param = SystemFuncParam::CreateParam(SystemFuncType::REDO_LAST_PARAM_CHANGE);
+    utils::register_param(std::move(param));
 }
 
 //----------------------------------------------------------------------------
@@ -58,6 +58,8 @@ enum SystemFuncType : int
     FINISH_CALIBRATION,
     SYSTEM_COLOUR_SET,
     EG_2_LEVEL_MOD_DST,
+    PREFETCH_PATCHES,
+    REDO_LAST_PARAM_CHANGE,
     UNKNOWN
 };
 
@@ -10,9 +10,76 @@
 #include <stdint.h>
 #include <cstring>
 #include <iostream>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <unordered_map>
 #include "timer.h"
 #include "common.h"
 
+// Constants
+constexpr uint TIMER_SERVICE_NUM_EXECUTORS = 3;
+
+// Timer Service class
+// A single scheduler thread waits for the earliest timer deadline (held in a
+// min-heap), and passes each expired timer to a small pool of executor threads
+// to call the timer callback
+// Each start of a timer gives it a new ID, and each schedule of a timer a new
+// sequence number, so that a stopped or re-scheduled timer is simply ignored when
+// its old schedule entry expires
+class TimerService
+{
+public:
+	// Helper functions
+	static TimerService& Instance();
+
+	// Constructor
+	TimerService();
+
+	// Destructor
+	~TimerService();
+
+	// Public functions
+	void start(Timer *timer, int interval_us, std::function<void(void)> callback_fn);
+	void signal(Timer *timer);
+	void change_interval(Timer *timer, int interval_us);
+	void stop(Timer *timer);
+	bool is_running(Timer *timer);
+
+private:
+	// Scheduled timer
+	struct ScheduledTimer
+	{
+		std::chrono::steady_clock::time_point deadline;
+		uint64_t timer_id;
+		uint64_t schedule_seq;
+
+		bool operator>(const ScheduledTimer& other) const
+		{
+			return deadline > other.deadline;
+		}
+	};
+
+	// Private data
+	std::mutex _mutex;
+	std::condition_variable _scheduler_cv;
+	std::condition_variable _executor_cv;
+	std::condition_variable _callback_done_cv;
+	std::priority_queue<ScheduledTimer, std::vector<ScheduledTimer>, std::greater<ScheduledTimer>> _schedule;
+	std::deque<std::pair<uint64_t, uint64_t>> _expired_timers;
+	std::unordered_map<uint64_t, Timer *> _timers;
+	std::unordered_map<uint64_t, std::thread::id> _running_callbacks;
+	uint64_t _next_timer_id;
+	bool _run;
+	std::thread *_scheduler_thread;
+	std::vector<std::thread *> _executor_threads;
+
+	// Private functions
+	void _schedule_timer(Timer *timer, std::chrono::steady_clock::time_point deadline);
+	void _stop_timer(Timer *timer, std::unique_lock<std::mutex>& lock);
+	void _process_schedule();
+	void _process_expired_timers();
+};
 
 //----------------------------------------------------------------------------
 // Timer
@@ -23,7 +90,8 @@ Timer::Timer(TimerType type)
 	_timer_type = type;
 	_timer_running = false;
 	_timer_signalled = false;
-	_timer_thread = 0;
+	_timer_id = 0;
+	_schedule_seq = 0;
 	_interval_us = 0;
 	_callback_fn = 0;
 }
@@ -33,9 +101,8 @@ Timer::Timer(TimerType type)
 //----------------------------------------------------------------------------
 Timer::~Timer()
 {
-	// Stop the timer if running
-	if (_timer_running)
-    	stop();
+	// Stop the timer, and make sure its callback is not running
+	stop();
 }
 
 //----------------------------------------------------------------------------
@@ -43,22 +110,8 @@ Timer::~Timer()
 //----------------------------------------------------------------------------
 void Timer::start(int interval_us, std::function<void(void)> callback_fn)
 {
-	// Check if a timer thread already exists - we must always ensure
-	// it is stopped and deallocated before starting a new timer
-	if (_timer_thread) {
-    	stop();
-	}
-
-	// Set the interval and callback function
-	_interval_us = interval_us;
-	_callback_fn = callback_fn;
-
-	// Indicate the timer is now running
-	_timer_running = true;
-	_timer_signalled = false;
-
-	// Start the timer thread
-	_timer_thread = new std::thread(&Timer::_timer_callback, this);
+	// Start the timer - if it is already started it is stopped first
+	TimerService::Instance().start(this, interval_us, callback_fn);
 }
 
 //----------------------------------------------------------------------------
@@ -67,8 +120,7 @@ void Timer::start(int interval_us, std::function<void(void)> callback_fn)
 void Timer::signal()
 {
 	// Signal the timer
-	_timer_signalled = true;
-	_cv.notify_all();
+	TimerService::Instance().signal(this);
 }
 
 //----------------------------------------------------------------------------
@@ -76,8 +128,8 @@ void Timer::signal()
 //----------------------------------------------------------------------------
 void Timer::change_interval(int interval_us)
 {
-	// Get the mutex and change the timer interval
-	_interval_us = interval_us;
+	// Change the timer interval, used from the next time the timer is scheduled
+	TimerService::Instance().change_interval(this, interval_us);
 }
 
 //----------------------------------------------------------------------------
@@ -86,79 +138,288 @@ void Timer::change_interval(int interval_us)
 void Timer::stop()
 {
 	// Stop the timer
+	TimerService::Instance().stop(this);
+}
+
+//----------------------------------------------------------------------------
+// is_running
+//----------------------------------------------------------------------------
+bool Timer::is_running()
+{
+	return TimerService::Instance().is_running(this);
+}
+
+//----------------------------------------------------------------------------
+// Instance
+//----------------------------------------------------------------------------
+TimerService& TimerService::Instance()
+{
+	// The timer service is created on first use
+	static TimerService timer_service;
+	return timer_service;
+}
+
+//----------------------------------------------------------------------------
+// TimerService
+//----------------------------------------------------------------------------
+TimerService::TimerService()
+{
+	// Initialise the private data
+	_next_timer_id = 1;
+	_run = true;
+
+	// Start the scheduler and executor threads
+	_scheduler_thread = new std::thread(&TimerService::_process_schedule, this);
+	for (uint i=0; i<TIMER_SERVICE_NUM_EXECUTORS; i++) {
+		_executor_threads.push_back(new std::thread(&TimerService::_process_expired_timers, this));
+	}
+}
+
+//----------------------------------------------------------------------------
+// ~TimerService
+//----------------------------------------------------------------------------
+TimerService::~TimerService()
+{
+	// Stop the scheduler and executor threads
 	{
 		std::lock_guard<std::mutex> lk(_mutex);
-		_timer_running = false;
-		_timer_signalled = true;
+		_run = false;
 	}
-	_cv.notify_all();
-	
-	// Stop the timer thread
-	if (_timer_thread)
+	_scheduler_cv.notify_all();
+	_executor_cv.notify_all();
+	if (_scheduler_thread->joinable())
+		_scheduler_thread->join();
+	delete _scheduler_thread;
+	for (auto t : _executor_threads) {
+		if (t->joinable())
+			t->join();
+		delete t;
+	}
+}
+
+//----------------------------------------------------------------------------
+// start
+//----------------------------------------------------------------------------
+void TimerService::start(Timer *timer, int interval_us, std::function<void(void)> callback_fn)
+{
+	std::unique_lock<std::mutex> lk(_mutex);
+
+	// We must always ensure the timer is stopped (and its callback is not running)
+	// before starting it again
+	_stop_timer(timer, lk);
+
+	// Set the interval and callback function
+	timer->_interval_us = interval_us;
+	timer->_callback_fn = callback_fn;
+
+	// Indicate the timer is now running, and schedule it
+	timer->_timer_id = _next_timer_id++;
+	timer->_timer_running = true;
+	timer->_timer_signalled = false;
+	_timers[timer->_timer_id] = timer;
+	_schedule_timer(timer, std::chrono::steady_clock::now() + std::chrono::microseconds(interval_us));
+}
+
+//----------------------------------------------------------------------------
+// signal
+//----------------------------------------------------------------------------
+void TimerService::signal(Timer *timer)
+{
+	std::lock_guard<std::mutex> lk(_mutex);
+
+	// Is the timer running?
+	if (timer->_timer_running)
 	{
-		// Wait for the timer thread to finish and delete it
-		if (_timer_thread->joinable())
-			_timer_thread->join();
-		delete _timer_thread;
-		_timer_thread = 0;
+		// If the timer callback is running, call it again as soon as it finishes,
+		// otherwise call it now
+		if (_running_callbacks.count(timer->_timer_id))
+			timer->_timer_signalled = true;
+		else
+			_schedule_timer(timer, std::chrono::steady_clock::now());
 	}
 }
 
+//----------------------------------------------------------------------------
+// change_interval
+//----------------------------------------------------------------------------
+void TimerService::change_interval(Timer *timer, int interval_us)
+{
+	std::lock_guard<std::mutex> lk(_mutex);
+
+	// Change the timer interval
+	timer->_interval_us = interval_us;
+}
+
+//----------------------------------------------------------------------------
+// stop
+//----------------------------------------------------------------------------
+void TimerService::stop(Timer *timer)
+{
+	std::unique_lock<std::mutex> lk(_mutex);
+	_stop_timer(timer, lk);
+}
+
 //----------------------------------------------------------------------------
 // is_running
 //----------------------------------------------------------------------------
-bool Timer::is_running()
+bool TimerService::is_running(Timer *timer)
+{
+	std::lock_guard<std::mutex> lk(_mutex);
+	return timer->_timer_running;
+}
+
+//----------------------------------------------------------------------------
+// _schedule_timer
+// Note: The timer service mutex must be held by the caller
+//----------------------------------------------------------------------------
+void TimerService::_schedule_timer(Timer *timer, std::chrono::steady_clock::time_point deadline)
+{
+	// Add the timer to the schedule - any previous schedule entry for this timer is
+	// now ignored
+	_schedule.push({deadline, timer->_timer_id, ++timer->_schedule_seq});
+
+	// Wake the scheduler if this is now the earliest deadline
+	if (_schedule.top().timer_id == timer->_timer_id)
+		_scheduler_cv.notify_one();
+}
+
+//----------------------------------------------------------------------------
+// _stop_timer
+// Note: The timer service mutex must be held by the caller
+//----------------------------------------------------------------------------
+void TimerService::_stop_timer(Timer *timer, std::unique_lock<std::mutex>& lock)
 {
-    return (_timer_thread && _timer_running);
+	// Is the timer started?
+	uint64_t timer_id = timer->_timer_id;
+	if (timer_id)
+	{
+		// Remove the timer, any schedule entries are now ignored
+		_timers.erase(timer_id);
+		timer->_timer_id = 0;
+		timer->_timer_running = false;
+		timer->_timer_signalled = false;
+
+		// Wait for the timer callback to finish, if running
+		// If the timer is being stopped from its own callback, there is no need to wait
+		_callback_done_cv.wait(lock, [this, timer_id]() {
+			auto itr = _running_callbacks.find(timer_id);
+			return (itr == _running_callbacks.end()) || (itr->second == std::this_thread::get_id());
+		});
+	}
 }
 
 //----------------------------------------------------------------------------
-// _timer_callback
+// _process_schedule
 //----------------------------------------------------------------------------
-void Timer::_timer_callback()
+void TimerService::_process_schedule()
 {
-	std::chrono::duration<double> adj = std::chrono::microseconds(0);
+	std::unique_lock<std::mutex> lk(_mutex);
 
 	// Do forever until stopped
-	while (true)
+	while (_run)
 	{
-		// Get the mutex lock
-		std::unique_lock<std::mutex> lk(_mutex);
+		// Wait for a timer to be scheduled
+		if (_schedule.empty())
+		{
+			_scheduler_cv.wait(lk);
+			continue;
+		}
+
+		// Wait until the earliest deadline - note this may change while waiting
+		auto next = _schedule.top();
+		if (next.deadline > std::chrono::steady_clock::now())
+		{
+			_scheduler_cv.wait_until(lk, next.deadline);
+			continue;
+		}
+		_schedule.pop();
+
+		// If the timer is still running and this is its current schedule entry, pass
+		// it to the executors to call the timer callback
+		auto itr = _timers.find(next.timer_id);
+		if ((itr != _timers.end()) && (itr->second->_schedule_seq == next.schedule_seq))
+		{
+			_expired_timers.push_back({next.timer_id, next.schedule_seq});
+			_executor_cv.notify_one();
+		}
+	}
+}
 
-		// Calculate the wait duration
-		auto const timeout = std::chrono::steady_clock::now() + std::chrono::microseconds(_interval_us) - adj;
+//----------------------------------------------------------------------------
+// _process_expired_timers
+//----------------------------------------------------------------------------
+void TimerService::_process_expired_timers()
+{
+	std::unique_lock<std::mutex> lk(_mutex);
+
+	// Do forever until stopped
+	while (true)
+	{
+		// Wait for an expired timer
+		_executor_cv.wait(lk, [this]() { return !_run || !_expired_timers.empty(); });
+		if (!_run)
+			break;
+		uint64_t timer_id = _expired_timers.front().first;
+		uint64_t schedule_seq = _expired_timers.front().second;
+		_expired_timers.pop_front();
 
-		// Wait for either a timeout or for the timer to be signalled
-		bool res = _cv.wait_until(lk, timeout, [this]{return _timer_signalled;});
+		// Has the timer been stopped or re-scheduled since it expired?
+		auto itr = _timers.find(timer_id);
+		if ((itr == _timers.end()) || (itr->second->_schedule_seq != schedule_seq))
+			continue;
+		Timer *timer = itr->second;
 
-		// Did either a timeout occur, or the timer signalled and still running?
-		if (!res || _timer_running)
+		// If the timer callback is already running, call it again once it finishes
+		if (_running_callbacks.count(timer_id))
 		{
-			// Save the time at the start of processing
-			std::chrono::_V2::system_clock::time_point start = std::chrono::high_resolution_clock::now();
+			timer->_timer_signalled = true;
+			continue;
+		}
 
-			// Call the callback function
-			(_callback_fn)();
+		// Call the callback function
+		// Note: The mutex is not held so the callback can use any timer functions, and a
+		// stop of this timer will wait until the callback has finished
+		// A copy of the callback is called, as the callback may re-start (or delete) its
+		// own timer
+		auto start = std::chrono::steady_clock::now();
+		auto callback_fn = timer->_callback_fn;
+		_running_callbacks[timer_id] = std::this_thread::get_id();
+		timer->_timer_signalled = false;
+		lk.unlock();
+		callback_fn();
+		lk.lock();
+		_running_callbacks.erase(timer_id);
+		_callback_done_cv.notify_all();
 
-			// Is this a one-shot timer? If so, stop the timer task
-			if (_timer_type == TimerType::ONE_SHOT)
-				break;
-			
-			// Reset the timer signalled indicator
-			_timer_signalled = false;
+		// If the timer has been stopped (or deleted) by the callback, no further
+		// processing is needed
+		itr = _timers.find(timer_id);
+		if (itr == _timers.end())
+			continue;
 
-			// Calculate the processing time adjustment
-			adj = std::chrono::high_resolution_clock::now() - start;			
+		// Is this a one-shot timer?
+		if (timer->_timer_type == TimerType::ONE_SHOT)
+		{
+			// If the timer was signalled while the callback was running, keep the timer
+			// running and call the callback again now, otherwise stop the timer
+			if (timer->_timer_signalled)
+			{
+				_schedule_timer(timer, std::chrono::steady_clock::now());
+			}
+			else
+			{
+				_timers.erase(timer_id);
+				timer->_timer_id = 0;
+				timer->_timer_running = false;
+			}
 		}
-		else 
+		else
 		{
-			// A timeout did not occur, meaning the timer was signalled and is
-			// no longer running
-			// In this case we can break from the thread loop
-			break;
+			// Schedule the next timer period from the start of processing, or now if
+			// the timer was signalled while the callback was running
+			_schedule_timer(timer, timer->_timer_signalled ?
+									std::chrono::steady_clock::now() :
+									(start + std::chrono::microseconds(timer->_interval_us)));
 		}
 	}
-
-	// Indicate the timer is no longer running
-	_timer_running = false;
 }
@@ -14,6 +14,7 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
 
 // Timer Type
 enum class TimerType
@@ -22,7 +23,13 @@ enum class TimerType
 	PERIODIC
 };
 
+// Timer Service class (defined in the timer implementation)
+class TimerService;
+
 // Timer class
+// All timers are run by a single shared timer service, which schedules each
+// timer and calls the timer callbacks from a small pool of threads
+// A timer callback is never called concurrently with itself
 class Timer
 {
 public:
@@ -40,18 +47,17 @@ public:
     bool is_running();
 
 private:
+    friend class TimerService;
+
     // Private data
+    // Note: Accessed by the timer service with the timer service mutex held
     TimerType _timer_type;
-    std::mutex _mutex;
-    std::condition_variable _cv;
     bool _timer_running;
     bool _timer_signalled;
-    std::thread *_timer_thread;
+    uint64_t _timer_id;
+    uint64_t _schedule_seq;
     int _interval_us;
     std::function<void(void)> _callback_fn;
-    
-    // Private functions
-    void _timer_callback();
 };
 
 #endif  // _TIMER_H
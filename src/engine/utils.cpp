@@ -13,12 +13,18 @@
 #include <stdint.h>
 #include <cstdio>
 #include <cstring>
+#include <cerrno>
 #include <unordered_map>
+#include <string_view>
+#include <thread>
+#include <deque>
 #include <condition_variable>
 #include <utility>
 #include <fstream>
 #include <atomic>
 #include <regex>
+#include <algorithm>
+#include <cassert>
 #include <sys/sysinfo.h>
 #ifndef NO_XENOMAI
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -42,6 +48,68 @@ constexpr char SYSTEM_COLOUR_NAME[]          = "System Colour";
 constexpr char SYSTEM_COLOUR_PARAM_NAME[]    = "system_colour";
 constexpr char PARAM_DEFAULT[]               = "default";
 constexpr uint DEFAULT_NUM_MPE_CHANNELS      = 7;
+constexpr uint PARAM_PATH_REGEX_CACHE_SIZE   = 64;
+constexpr uint NUM_PARAMS_VIEW_MODULES       = NinaModule::SOFTWARE + 1;
+constexpr uint NUM_PARAMS_VIEW_TYPES         = static_cast<uint>(ParamType::UI_STATE_CHANGE) + 1;
+
+// Param index entry - all registered params with the same path, and the
+// current UI state of that path
+struct ParamIndexEntry
+{
+    ParamHandle handle;
+    ParamState *param_state;
+    std::vector<Param *> nina_params;
+    std::vector<Param *> daw_params;
+};
+
+// Params registry - the index of all registered params
+// A snapshot of the registry is published by the registering thread once params
+// have been registered, and is never modified once published, so can be read without
+// the params mutex. The index keys reference the param state paths, which are never
+// removed
+struct ParamsRegistry
+{
+    std::unordered_map<std::string_view, ParamHandle> index;
+    std::vector<ParamIndexEntry> entries;
+    std::vector<ParamHandle> by_path;
+    std::vector<Param *> nina_params;
+    std::vector<Param *> daw_params;
+    std::unordered_map<std::string, uint> state_ids;
+    std::vector<const std::string *> state_names;
+};
+
+// Params registry reader - holds the published registry snapshot while in scope,
+// so that it is not reclaimed, or the registry builder (and the params mutex) if
+// this thread is registering params that have not been published yet
+// Note: A reader must not be created while another reader is held by the same thread
+class ParamsRegistryReader
+{
+public:
+    ParamsRegistryReader();
+    ~ParamsRegistryReader();
+    const ParamsRegistry *operator->() const { return _registry; }
+
+private:
+    std::unique_lock<std::mutex> _lock;
+    uint _epoch_index;
+    const ParamsRegistry *_registry;
+};
+
+// Params view cache - a cached view, and the generation of the params
+// registry it was built from
+struct ParamsViewCache
+{
+    uint generation;
+    utils::ParamsView view;
+};
+
+// Param path match - how a param path regex can be matched
+enum class ParamPathMatch
+{
+    EXACT,
+    PREFIX,
+    REGEX
+};
 
 // Private variables
 SystemConfig _system_config = SystemConfig();
@@ -52,12 +120,33 @@ bool _morph_on = true;
 bool _morph_enabled = false;
 bool _prev_morph_enabled = false;
 std::mutex _morph_mutex;
+MorphEngine _morph_engine;
+BankIndex _bank_index(NINA_PATCHES_DIR);
 std::atomic<uint> _current_layer_num = 0;
 LayerInfo _layer_info[] = { LayerInfo(0), LayerInfo(1), LayerInfo(2), LayerInfo(3) };
 std::vector<std::unique_ptr<Param>> _nina_params;
 std::vector<std::unique_ptr<Param>> _daw_params;
 std::mutex _params_mutex;
-std::vector<ParamState> _param_states;
+std::deque<ParamState> _param_states;
+std::deque<std::string> _param_state_names = { PARAM_DEFAULT };
+ParamsRegistry _params_builder = { {}, {}, {}, {}, {}, { { PARAM_DEFAULT, DEFAULT_PARAM_STATE_ID } }, { &_param_state_names.front() } };
+std::atomic<const ParamsRegistry *> _params_registry = new ParamsRegistry(_params_builder);
+std::atomic<bool> _params_registry_dirty = false;
+thread_local uint _params_registration_depth = 0;
+thread_local bool _params_registry_reader_held = false;
+std::atomic<uint> _params_registry_epoch = 0;
+std::atomic<uint> _params_registry_readers[2] = { 0, 0 };
+std::mutex _param_path_regex_mutex;
+std::unordered_map<std::string, std::shared_ptr<const std::regex>> _param_path_regex_cache;
+std::atomic<uint> _params_view_generation = 0;
+std::atomic<uint> _midi_channel_config_generation = 0;
+std::shared_ptr<const ParamsViewCache> _module_params_views[NUM_PARAMS_VIEW_MODULES];
+std::shared_ptr<const ParamsViewCache> _type_params_views[NUM_PARAMS_VIEW_TYPES];
+std::shared_ptr<const ParamsViewCache> _patch_params_view;
+std::shared_ptr<const ParamsViewCache> _mod_matrix_params_view;
+std::shared_ptr<const ParamsViewCache> _global_params_view;
+const std::string _invalid_param_path;
+std::vector<ParamState *> _modified_param_states;
 std::vector<HapticMode> _haptic_modes;
 std::vector<std::string> _params_blacklist;
 MultifnSwitchesMode _normal_multifn_switches_mode = MultifnSwitchesMode::NONE;
@@ -124,9 +213,22 @@ const char *_param_refs[] = {
 };
 
 // Private functions
-Param *_get_param(std::string path);
-Param *_get_param(std::string path, std::string state, bool preset_param);
-Param *_get_param(std::string path, std::string state, std::vector<std::unique_ptr<Param>>& params);
+ParamIndexEntry *_get_param_index_entry(const std::string& path);
+const ParamIndexEntry *_get_param_index_entry(const ParamsRegistryReader& registry, const std::string& path);
+uint _get_param_state_id(const std::string& state);
+uint _get_param_state_id(const ParamsRegistryReader& registry, const std::string& state);
+uint _add_param_state_id(const std::string& state);
+bool _param_in_current_state(const Param *param);
+void _push_param_state(ParamState& ps, uint state_id);
+void _pop_param_state(ParamState& ps);
+Param *_get_param(const ParamIndexEntry *entry);
+Param *_get_param(const std::string& path, uint state_id, bool preset_param);
+void _publish_params_registry();
+void _synchronize_params_registry();
+ParamPathMatch _get_param_path_regex_prefix(const std::string& regex, std::string& prefix);
+std::shared_ptr<const std::regex> _get_param_path_regex(const std::string& regex);
+template <typename Filter>
+utils::ParamsView _get_params_view(std::shared_ptr<const ParamsViewCache>& cache, Filter filter);
 
 
 //----------------------------------------------------------------------------
@@ -364,6 +466,20 @@ void utils::rt_task_nanosleep(struct timespec *time)
 #endif
 }
 
+//----------------------------------------------------------------------------
+// rt_task_nanosleep_until
+//----------------------------------------------------------------------------
+void utils::rt_task_nanosleep_until(const struct timespec *deadline)
+{
+#ifndef NO_XENOMAI    
+    // Perform the RT sleep until the absolute (monotonic) deadline, restarting the
+    // sleep if interrupted
+    while (__cobalt_clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL) == EINTR);
+#else
+    (void)deadline;
+#endif
+}
+
 //----------------------------------------------------------------------------
 // rtdm_open
 //----------------------------------------------------------------------------
@@ -485,6 +601,7 @@ void utils::reset_mpe_params()
     if (_mpe_upper_zone_num_channels_param) {
         _mpe_upper_zone_num_channels_param->set_value(0);
     }    
+    midi_channel_config_changed();
 }
 
 //----------------------------------------------------------------------------
@@ -605,9 +722,30 @@ std::pair<const Param *, const Param *> utils::config_mpe_zone_channel_params()
             ret.second = _mpe_upper_zone_num_channels_param;
         }               
     }
+
+    // The MPE config may have changed
+    midi_channel_config_changed();
     return ret;    
 }
 
+//----------------------------------------------------------------------------
+// mpe_zone_num_channels
+//----------------------------------------------------------------------------
+std::pair<uint, uint> utils::mpe_zone_num_channels()
+{
+    uint lower_zone_num_channels = 0;
+    uint upper_zone_num_channels = 0;
+
+    // Get the Lower and Upper Zone Number of Channels
+    if (_mpe_lower_zone_num_channels_param) {
+        lower_zone_num_channels = _mpe_lower_zone_num_channels_param->get_position_value();
+    }
+    if (_mpe_upper_zone_num_channels_param) {
+        upper_zone_num_channels = _mpe_upper_zone_num_channels_param->get_position_value();
+    }
+    return std::pair<uint, uint>(lower_zone_num_channels, upper_zone_num_channels);
+}
+
 //----------------------------------------------------------------------------
 // is_mpe_channel
 //----------------------------------------------------------------------------
@@ -638,6 +776,25 @@ bool utils::is_mpe_channel(uint channel)
     return false;
 }
 
+//----------------------------------------------------------------------------
+// midi_channel_config_changed
+//----------------------------------------------------------------------------
+void utils::midi_channel_config_changed()
+{
+    // The layer MIDI channel filters or MPE config have changed
+    _midi_channel_config_generation++;
+}
+
+//----------------------------------------------------------------------------
+// midi_channel_config_generation
+//----------------------------------------------------------------------------
+uint utils::midi_channel_config_generation()
+{
+    // Return the MIDI channel config generation - this changes whenever the layer MIDI
+    // channel filters or MPE config change
+    return _midi_channel_config_generation;
+}
+
 //----------------------------------------------------------------------------
 // get_mpe_mode
 //----------------------------------------------------------------------------
@@ -669,35 +826,8 @@ std::string utils::get_default_patch_filename(uint index, bool with_ext)
 //----------------------------------------------------------------------------
 std::vector<Param *> utils::get_params(NinaModule module)
 {
-    std::vector<Param *> params;
-
-    // Get the params mutex
-    std::lock_guard<std::mutex> lock(_params_mutex);
-
-    // First parse the Nina specific params
-    for (const std::unique_ptr<Param> &p : _nina_params)
-    {
-        // Specified module and state?
-        if ((p->module == module) && 
-            (p->state == get_param_state(p->get_path())))
-        {
-            // Yes, add it
-            params.push_back(p.get());
-        }
-    }
-
-    // Now parse the DAW specific params
-    for (const std::unique_ptr<Param> &p : _daw_params)
-    {
-        // Specified module and state?
-        if ((p->module == module) && 
-            (p->state == get_param_state(p->get_path())))
-        {
-            // Yes, add it
-            params.push_back(p.get());
-        }
-    }
-    return params;
+    // Return a copy of the cached view
+    return *get_params_view(module);
 }
 
 //----------------------------------------------------------------------------
@@ -705,81 +835,124 @@ std::vector<Param *> utils::get_params(NinaModule module)
 //----------------------------------------------------------------------------
 std::vector<Param *> utils::get_params(ParamType param_type)
 {
-    std::vector<Param *> params;
+    // Return a copy of the cached view
+    return *get_params_view(param_type);
+}
 
-    // Get the params mutex
-    std::lock_guard<std::mutex> lock(_params_mutex);
+//----------------------------------------------------------------------------
+// get_params_view
+//----------------------------------------------------------------------------
+utils::ParamsView utils::get_params_view(NinaModule module)
+{
+    // Check the module is valid
+    uint index = static_cast<uint>(module);
+    if (index >= NUM_PARAMS_VIEW_MODULES)
+        return std::make_shared<std::vector<Param *>>();
 
-    // First parse the Nina specific params
-    for (const std::unique_ptr<Param> &p : _nina_params)
-    {
-        // Specified type and state?
-        if ((p->type == param_type) && 
-            ((param_type == ParamType::UI_STATE_CHANGE) || (p->state == get_param_state(p->get_path()))))
-        {
-            // Yes, add it
-            params.push_back(p.get());
-        }
-    }
+    // Get the view of the params for the specified module and state
+    return _get_params_view(_module_params_views[index], [module](const Param *p) {
+        return (p->module == module) && _param_in_current_state(p);
+    });
+}
 
-    // Now parse the DAW specific params
-    for (const std::unique_ptr<Param> &p : _daw_params)
-    {
-        // Specified type and state?
-        if ((p->type == param_type) && 
-            ((param_type == ParamType::UI_STATE_CHANGE) || (p->state == get_param_state(p->get_path()))))
-        {
-            // Yes, add it
-            params.push_back(p.get());
-        }
-    }
-    return params;
+//----------------------------------------------------------------------------
+// get_params_view
+//----------------------------------------------------------------------------
+utils::ParamsView utils::get_params_view(ParamType param_type)
+{
+    // Check the param type is valid
+    uint index = static_cast<uint>(param_type);
+    if (index >= NUM_PARAMS_VIEW_TYPES)
+        return std::make_shared<std::vector<Param *>>();
+
+    // Get the view of the params for the specified type and state
+    return _get_params_view(_type_params_views[index], [param_type](const Param *p) {
+        return (p->type == param_type) && 
+               ((param_type == ParamType::UI_STATE_CHANGE) || _param_in_current_state(p));
+    });
 }
 
 //----------------------------------------------------------------------------
 // get_param
 //----------------------------------------------------------------------------
-Param *utils::get_param(std::string path)
+Param *utils::get_param(const std::string& path)
 {
-    // Get the params mutex
-    std::lock_guard<std::mutex> lock(_params_mutex);
+    // Find the index entry for this path in the registry and get the param
+    ParamsRegistryReader registry;
+    auto entry = _get_param_index_entry(registry, path);
+    return entry ? _get_param(entry) : nullptr;
+}
+
+//----------------------------------------------------------------------------
+// get_param_from_handle
+//----------------------------------------------------------------------------
+Param *utils::get_param_from_handle(ParamHandle handle)
+{
+    // Get the param for the current state of this handle
+    ParamsRegistryReader registry;
+    return (handle < registry->entries.size()) ? _get_param(&registry->entries[handle]) : nullptr;
+}
 
-    // Get the param
-    return _get_param(path);
+//----------------------------------------------------------------------------
+// get_param_handle
+//----------------------------------------------------------------------------
+ParamHandle utils::get_param_handle(const std::string& path)
+{
+    // Return the handle for this path, if registered
+    ParamsRegistryReader registry;
+    auto entry = _get_param_index_entry(registry, path);
+    return entry ? entry->handle : INVALID_PARAM_HANDLE;
+}
+
+//----------------------------------------------------------------------------
+// get_param_path
+//----------------------------------------------------------------------------
+const std::string& utils::get_param_path(ParamHandle handle)
+{
+    // Return the path for this handle, if valid
+    // Note: Param states are never removed, so the path returned is valid for
+    // the lifetime of the app
+    ParamsRegistryReader registry;
+    return (handle < registry->entries.size()) ? registry->entries[handle].param_state->path : _invalid_param_path;
 }
 
 //----------------------------------------------------------------------------
 // get_params
 //----------------------------------------------------------------------------
-std::vector<Param *> utils::get_params(const std::string param_path_regex)
+std::vector<Param *> utils::get_params(const std::string& param_path_regex)
 {
     std::vector<Param *> params;
-    std::cmatch m;
-    const std::regex base_regex(param_path_regex);
+    std::string prefix;
 
-    // Get the params mutex
-    std::lock_guard<std::mutex> lock(_params_mutex);
+    // Get the literal prefix of the regex, and check if the regex can be matched
+    // using that prefix only
+    auto match = _get_param_path_regex_prefix(param_path_regex, prefix);
 
-    // First parse the Nina specific params
-    for (const std::unique_ptr<Param> &p : _nina_params)
-    {
-        // Does the param path match (regex)
-        if (std::regex_match(p->get_path().c_str(), m, base_regex))
-        {
-            // Yes, add it
-            params.push_back(p.get());
-        }
-    }
+    // Get the compiled regex if the full regex needs to be matched
+    auto base_regex = (match == ParamPathMatch::REGEX) ? _get_param_path_regex(param_path_regex) : nullptr;
 
-    // Now parse the DAW specific params
-    for (const std::unique_ptr<Param> &p : _daw_params)
+    // Iterate through the registry param paths (sorted) starting with the prefix
+    ParamsRegistryReader registry;
+    auto itr = std::lower_bound(registry->by_path.begin(), registry->by_path.end(), prefix,
+                                [&registry](ParamHandle handle, const std::string& path) { return registry->entries[handle].param_state->path < path; });
+    for (; itr != registry->by_path.end(); ++itr)
     {
-        // Does the param path match (regex)
-        if (std::regex_match(p->get_path().c_str(), m, base_regex))
-        {
-            // Yes, add it
-            params.push_back(p.get());
-        }
+        // Stop if this path doesn't start with the prefix, as there are no more
+        // matching paths
+        auto& entry = registry->entries[*itr];
+        auto& path = entry.param_state->path;
+        if (path.compare(0, prefix.size(), prefix) != 0)
+            break;
+
+        // Does the param path match?
+        if (((match == ParamPathMatch::EXACT) && (path.size() != prefix.size())) ||
+            (base_regex && !std::regex_match(path, *base_regex)))
+            continue;
+
+        // Yes, add the Nina specific params and then the DAW specific params
+        // with this path
+        params.insert(params.end(), entry.nina_params.begin(), entry.nina_params.end());
+        params.insert(params.end(), entry.daw_params.begin(), entry.daw_params.end());
     }
     return params;
 }
@@ -793,17 +966,15 @@ std::vector<Param *> utils::get_params_with_state(const std::string state)
 
     // Was a state specified?
     if (state.size() > 0) {
-        // Get the params mutex
-        std::lock_guard<std::mutex> lock(_params_mutex);
-
         // First parse the Nina specific params
-        for (const std::unique_ptr<Param> &p : _nina_params)
+        ParamsRegistryReader registry;
+        for (Param *p : registry->nina_params)
         {
             // Does the param state match
             if ((p->type != ParamType::UI_STATE_CHANGE) && (p->state == state))
             {
                 // Yes, add it
-                params.push_back(p.get());
+                params.push_back(p);
             }
         }
 
@@ -811,13 +982,13 @@ std::vector<Param *> utils::get_params_with_state(const std::string state)
         if (params.size() == 0)
         {
             // Parse the DAW specific params
-            for (const std::unique_ptr<Param> &p : _daw_params)
+            for (Param *p : registry->daw_params)
             {
                 // Does the param state match
                 if ((p->type != ParamType::UI_STATE_CHANGE) && (p->state == state))
                 {
                     // Yes, add it
-                    params.push_back(p.get());
+                    params.push_back(p);
                 }
             }
         }
@@ -830,33 +1001,8 @@ std::vector<Param *> utils::get_params_with_state(const std::string state)
 //----------------------------------------------------------------------------
 std::vector<Param *> utils::get_patch_params()
 {
-    std::vector<Param *> params;
-
-    // Get the params mutex
-    std::lock_guard<std::mutex> lock(_params_mutex);
-
-    // First parse the Nina specific params
-    for (const std::unique_ptr<Param> &p : _nina_params)
-    {
-        // Patch param and state?
-        if (p->patch_param && (p->state == get_param_state(p->get_path())))
-        {
-            // Yes, add it
-            params.push_back(p.get());
-        }
-    }
-
-    // Now parse the DAW specific params
-    for (const std::unique_ptr<Param> &p : _daw_params)
-    {
-        // Patch param and state?
-        if (p->patch_param && (p->state == get_param_state(p->get_path())))
-        {
-            // Yes, add it
-            params.push_back(p.get());
-        }
-    }
-    return params;
+    // Return a copy of the cached view
+    return *get_patch_params_view();
 }
 
 //----------------------------------------------------------------------------
@@ -864,112 +1010,112 @@ std::vector<Param *> utils::get_patch_params()
 //----------------------------------------------------------------------------
 std::vector<Param *> utils::get_mod_matrix_params()
 {
-    std::vector<Param *> params;
+    // Return a copy of the cached view
+    return *get_mod_matrix_params_view();
+}
 
-    // Get the params mutex
-    std::lock_guard<std::mutex> lock(_params_mutex);
+//----------------------------------------------------------------------------
+// get_global_params
+//----------------------------------------------------------------------------
+std::vector<Param *> utils::get_global_params()
+{
+    // Return a copy of the cached view
+    return *get_global_params_view();
+}
 
-    // First parse the Nina specific params
-    for (const std::unique_ptr<Param> &p : _nina_params)
-    {
-        // Mod Matrix param and state?
-        if (p->mod_matrix_param && (p->state == get_param_state(p->get_path())))
-        {
-            // Yes, add it
-            params.push_back(p.get());
-        }
-    }
+//----------------------------------------------------------------------------
+// get_patch_params_view
+//----------------------------------------------------------------------------
+utils::ParamsView utils::get_patch_params_view()
+{
+    // Get the view of the patch params in the current state
+    return _get_params_view(_patch_params_view, [](const Param *p) {
+        return p->patch_param && _param_in_current_state(p);
+    });
+}
 
-    // Now parse the DAW specific params
-    for (const std::unique_ptr<Param> &p : _daw_params)
-    {
-        // Mod Matrix param and state?
-        if (p->mod_matrix_param && (p->state == get_param_state(p->get_path())))
-        {
-            // Yes, add it
-            params.push_back(p.get());
-        }
-    }
-    return params;
+//----------------------------------------------------------------------------
+// get_mod_matrix_params_view
+//----------------------------------------------------------------------------
+utils::ParamsView utils::get_mod_matrix_params_view()
+{
+    // Get the view of the Mod Matrix params in the current state
+    return _get_params_view(_mod_matrix_params_view, [](const Param *p) {
+        return p->mod_matrix_param && _param_in_current_state(p);
+    });
 }
 
 //----------------------------------------------------------------------------
-// get_global_params
+// get_global_params_view
 //----------------------------------------------------------------------------
-std::vector<Param *> utils::get_global_params()
+utils::ParamsView utils::get_global_params_view()
 {
-    std::vector<Param *> params;
+    // Get the view of the global params in the current state
+    return _get_params_view(_global_params_view, [](const Param *p) {
+        return p->global_param && _param_in_current_state(p);
+    });
+}
 
+//----------------------------------------------------------------------------
+// invalidate_params_views
+//----------------------------------------------------------------------------
+void utils::invalidate_params_views()
+{
     // Get the params mutex
     std::lock_guard<std::mutex> lock(_params_mutex);
 
-    // First parse the Nina specific params
-    for (const std::unique_ptr<Param> &p : _nina_params)
-    {
-        // Global param and state?
-        if (p->global_param && (p->state == get_param_state(p->get_path())))
-        {
-            // Yes, add it
-            params.push_back(p.get());
-        }
-    }
+    // Invalidate all cached views
+    _params_view_generation++;
+}
 
-    // Now parse the DAW specific params
-    for (const std::unique_ptr<Param> &p : _daw_params)
-    {
-        // Global param and state?
-        if (p->global_param && (p->state == get_param_state(p->get_path())))
-        {
-            // Yes, add it
-            params.push_back(p.get());
-        }
-    }
-    return params;
+//----------------------------------------------------------------------------
+// params_generation
+//----------------------------------------------------------------------------
+uint utils::params_generation()
+{
+    // Return the params generation - this changes whenever a param is registered, or
+    // the param states change
+    return _params_view_generation;
 }
 
 //----------------------------------------------------------------------------
 // get_param
 //----------------------------------------------------------------------------
-Param *utils::get_param(std::string path, std::string state)
+Param *utils::get_param(const std::string& path, const std::string& state)
 {
-    // Get the params mutex
-    std::lock_guard<std::mutex> lock(_params_mutex);
-
-    // First parse the Nina specific params
-    for (const std::unique_ptr<Param> &p : _nina_params)
+    // Find the index entry for this path in the registry
+    ParamsRegistryReader registry;
+    auto entry = _get_param_index_entry(registry, path);
+    if (entry)
     {
-        // If this is a state change param, don't check the state
-        // This is because the state variable contains the target state
-        if (p->type == ParamType::UI_STATE_CHANGE)
+        // Get the ID of the passed state
+        // Note: If the state has never been registered no (non UI state change)
+        // param can match it
+        uint state_id = _get_param_state_id(registry, state);
+
+        // First check the Nina specific params
+        for (Param *p : entry->nina_params)
         {
-            // Does the parameter path match?
-            if (p->cmp_path(path))
+            // If this is a state change param, don't check the state
+            // This is because the state variable contains the target state
+            if ((p->type == ParamType::UI_STATE_CHANGE) || (p->state_id == state_id))
             {
                 // Param found, return it
-                return (p.get());
+                return p;
             }
         }
-        else
+
+        // Not in the Nina params, try the DAW specific params
+        for (Param *p : entry->daw_params)
         {
-            // Does the parameter path and passed state match?
-            if (p->cmp_path(path) && (p->state == state))
-            {              
+            // Does the passed state match?
+            if (p->state_id == state_id)
+            {
                 // Param found, return it
-                return (p.get());
+                return p;
             }
         }
     }
-
-    // Not in the Nina params, try the DAW specific params
-    for (const std::unique_ptr<Param> &p : _daw_params)
-    {
-        // Does the parameter path and passed state match?
-        if (p->cmp_path(path) && (p->state == state))
-        {
-            // Param found, return it
-            return (p.get());
-        }
-    }
     return nullptr;
 }
 
@@ -978,11 +1124,9 @@ Param *utils::get_param(std::string path, std::string state)
 //----------------------------------------------------------------------------
 Param *utils::get_param(ParamType param_type, int param_id)
 {
-    // Get the params mutex
-    std::lock_guard<std::mutex> lock(_params_mutex);
-
-    // First parse the Nina specific params
-    for (const std::unique_ptr<Param> &p : _nina_params)
+    // First parse the Nina specific params in the registry
+    ParamsRegistryReader registry;
+    for (Param *p : registry->nina_params)
     {
         // If this is a state change param, don't check the state
         // This is because the state variable contains the target state
@@ -992,28 +1136,28 @@ Param *utils::get_param(ParamType param_type, int param_id)
             if ((p->type == param_type) && (p->param_id == param_id))
             {
                 // Param found, return it
-                return (p.get());
+                return p;
             }
         }
         else
         {
             // Does the parameter type and ID and passed state match?
-            if ((p->type == param_type) && (p->param_id == param_id) && (p->state == utils::get_param_state(p->get_path())))
+            if ((p->type == param_type) && (p->param_id == param_id) && _param_in_current_state(p))
             {              
                 // Param found, return it
-                return (p.get());
+                return p;
             }
         }
     }
 
     // Not in the Nina params, try the DAW specific params
-    for (const std::unique_ptr<Param> &p : _daw_params)
+    for (Param *p : registry->daw_params)
     {
         // Does the parameter type and ID and passed state match?
-        if ((p->type == param_type) && (p->param_id == param_id) && (p->state == utils::get_param_state(p->get_path())))
+        if ((p->type == param_type) && (p->param_id == param_id) && _param_in_current_state(p))
         {
             // Param found, return it
-            return (p.get());
+            return p;
         }
     }
     return nullptr;
@@ -1024,11 +1168,9 @@ Param *utils::get_param(ParamType param_type, int param_id)
 //----------------------------------------------------------------------------
 Param *utils::get_param(NinaModule module, int param_id)
 {
-    // Get the params mutex
-    std::lock_guard<std::mutex> lock(_params_mutex);
-
-    // First parse the Nina specific params
-    for (const std::unique_ptr<Param> &p : _nina_params)
+    // First parse the Nina specific params in the registry
+    ParamsRegistryReader registry;
+    for (Param *p : registry->nina_params)
     {
         // If this is a state change param, don't check the state
         // This is because the state variable contains the target state
@@ -1038,28 +1180,28 @@ Param *utils::get_param(NinaModule module, int param_id)
             if ((p->module == module) && (p->param_id == param_id))
             {
                 // Param found, return it
-                return (p.get());
+                return p;
             }
         }
         else
         {
             // Does the parameter type and ID and passed state match?
-            if ((p->module == module) && (p->param_id == param_id) && (p->state == utils::get_param_state(p->get_path())))
+            if ((p->module == module) && (p->param_id == param_id) && _param_in_current_state(p))
             {              
                 // Param found, return it
-                return (p.get());
+                return p;
             }
         }
     }
 
     // Not in the Nina params, try the DAW specific params
-    for (const std::unique_ptr<Param> &p : _daw_params)
+    for (Param *p : registry->daw_params)
     {
         // Does the parameter type and ID and passed state match?
-        if ((p->module == module) && (p->param_id == param_id) && (p->state == utils::get_param_state(p->get_path())))
+        if ((p->module == module) && (p->param_id == param_id) && _param_in_current_state(p))
         {
             // Param found, return it
-            return (p.get());
+            return p;
         }
     }
     return nullptr;    
@@ -1070,17 +1212,15 @@ Param *utils::get_param(NinaModule module, int param_id)
 //----------------------------------------------------------------------------
 Param *utils::get_sys_func_param(SystemFuncType sys_func_type)
 {
-    // Get the params mutex
-    std::lock_guard<std::mutex> lock(_params_mutex);
-
-    // First parse the Nina specific params
-    for (const std::unique_ptr<Param> &p : _nina_params)
+    // First parse the Nina specific params in the registry
+    ParamsRegistryReader registry;
+    for (Param *p : registry->nina_params)
     {
         // Does the parameter type and system function match?
-        if ((p->type == ParamType::SYSTEM_FUNC) && (static_cast<const SystemFuncParam *>(p.get())->get_system_func_type() == sys_func_type))
+        if ((p->type == ParamType::SYSTEM_FUNC) && (static_cast<const SystemFuncParam *>(p)->get_system_func_type() == sys_func_type))
         {
             // Param found, return it
-            return (p.get());
+            return p;
         }
     }
     return nullptr;    
@@ -1091,28 +1231,26 @@ Param *utils::get_sys_func_param(SystemFuncType sys_func_type)
 //----------------------------------------------------------------------------
 Param *utils::get_param_from_ref(ParamRef ref)
 {
-    // Get the params mutex
-    std::lock_guard<std::mutex> lock(_params_mutex);
-
-    // First parse the Nina specific params
-    for (const std::unique_ptr<Param> &p : _nina_params)
+    // First parse the Nina specific params in the registry
+    ParamsRegistryReader registry;
+    for (Param *p : registry->nina_params)
     {
         // Does the reference match?
         if (p->ref == _param_refs[ref])
         {
             // Param found, return it
-            return (p.get());
+            return p;
         }
     }
 
     // Not in the Nina params, try the DAW specific params
-    for (const std::unique_ptr<Param> &p : _daw_params)
+    for (Param *p : registry->daw_params)
     {
         // Does the reference match?
         if (p->ref == _param_refs[ref])
         {
             // Param found, return it
-            return (p.get());
+            return p;
         }
     }
     return nullptr;
@@ -1134,74 +1272,87 @@ void utils::register_param(std::unique_ptr<Param> param)
     // All params go into the Nina params vector, unless they
     // have the preset flag set to true, in which case they go into
     // the DAW specific params vector
-    if (!param->patch_param)
+    bool preset_param = param->patch_param;
+
+    // Get the params mutex
+    // Note: The param is added to the registry builder, and a new snapshot of the
+    // registry is published now, or at the end of the registration if this thread
+    // is registering a batch of params
+    std::lock_guard<std::mutex> lock(_params_mutex);
+
+    // Does the parameter already exist?
+    if (_get_param(param->get_path(), _get_param_state_id(param->state), preset_param) == nullptr)
     {
-        // These params go into the Nina params vector
-        // Does the parameter already exist?
-        if (_get_param(param->get_path(), param->state, false) == nullptr)
+        // Get the index entry for this param path, creating it (and the
+        // param state for this path) if it doesn't exist
+        auto entry = _get_param_index_entry(param->get_path());
+        if (!entry)
         {
-            auto path = param->get_path();
-            auto state = param->state;
-
-            // Add the param
-            _nina_params.push_back(std::move(param));
+            // New param path, assign it the next handle
+            auto& ps = _param_states.emplace_back();
+            ps.path = param->get_path();
+            ParamHandle handle = _params_builder.entries.size();
+            _params_builder.entries.push_back(ParamIndexEntry{handle, &ps, {}, {}});
+            _params_builder.index.emplace(ps.path, handle);
+            auto itr = std::lower_bound(_params_builder.by_path.begin(), _params_builder.by_path.end(), ps.path,
+                                        [](ParamHandle h, const std::string& path) { return _params_builder.entries[h].param_state->path < path; });
+            _params_builder.by_path.insert(itr, handle);
+            entry = &_params_builder.entries.back();
+        }
+        param->handle = entry->handle;
 
-            // Does a param state for this param exist?
-            bool found = false;
-            for (ParamState &ps : _param_states)
-            {
-                // Does the param path match?
-                if (path == ps.path)
-                {
-                    // Param found
-                    found = true;
-                    break;
-                }
-            }
+        // Intern the param state, and attach the param state for this path
+        // to the param
+        param->state_id = _add_param_state_id(param->state);
+        param->param_state = entry->param_state;
 
-            // Does a param state need to be added?
-            if (!found)
-            {
-                // Add it to the param states vector
-                auto param_state = ParamState();
-                param_state.path = path;
-                _param_states.push_back(param_state);
-            }
+        // Add the param to the index and params vector
+        if (!preset_param)
+        {
+            entry->nina_params.push_back(param.get());
+            _params_builder.nina_params.push_back(param.get());
+            _nina_params.push_back(std::move(param));
         }
-    }
-    else
-    {
-        // These params go into the specific DAW params vector
-        if (_get_param(param->get_path(), param->state, _daw_params) == nullptr)
+        else
         {
-            auto path = param->get_path();
-            auto state = param->state;
-
-            // Add the param
+            entry->daw_params.push_back(param.get());
+            _params_builder.daw_params.push_back(param.get());
             _daw_params.push_back(std::move(param));
+        }
 
-            // Does a param state for this param exist?
-            bool found = false;
-            for (ParamState &ps : _param_states)
-            {
-                // Does the patch match?
-                if (path == ps.path)
-                {
-                    // Param found
-                    found = true;
-                    break;
-                }
-            }
+        // A param has been registered, so the registry needs to be published, and
+        // invalidate any cached views
+        _params_registry_dirty = true;
+        _params_view_generation++;
+        if (_params_registration_depth == 0)
+            _publish_params_registry();
+    }
+}
 
-            // Does a param state need to be added?
-            if (!found)
-            {
-                // Add it to the param states vector
-                auto param_state = ParamState();
-                param_state.path = path;
-                _param_states.push_back(param_state);
-            }           
-        }        
+//----------------------------------------------------------------------------
+// begin_params_registration
+//----------------------------------------------------------------------------
+void utils::begin_params_registration()
+{
+    // Params registered by this thread are now only published when the registration
+    // ends, and until then this thread reads them from the registry builder
+    // Note: Registrations can be nested
+    _params_registration_depth++;
+}
+
+//----------------------------------------------------------------------------
+// end_params_registration
+//----------------------------------------------------------------------------
+void utils::end_params_registration()
+{
+    // If this ends the registration, publish any params registered
+    assert(_params_registration_depth > 0);
+    if (--_params_registration_depth == 0)
+    {
+        // Get the params mutex
+        std::lock_guard<std::mutex> lock(_params_mutex);
+        if (_params_registry_dirty)
+            _publish_params_registry();
     }
 }
 
@@ -1269,38 +1420,37 @@ void utils::reset_param_states()
     // Get the params mutex
     std::lock_guard<std::mutex> lock(_params_mutex);
 
-    // For each param state
-    for (ParamState &ps : _param_states)
+    // For each param state that has been pushed since the last reset
+    for (ParamState *ps : _modified_param_states)
     {
         // Pop the states until we are back at default
-        while (ps.state_stack.size() > 1)
-            ps.state_stack.pop_back();
+        ps->state_stack.resize(1);
+        ps->current_state_id = DEFAULT_PARAM_STATE_ID;
+        ps->modified = false;
+    }
+    if (!_modified_param_states.empty())
+    {
+        // The param states have changed, so invalidate any cached views
+        _modified_param_states.clear();
+        _params_view_generation++;
     }
 }
 
 //----------------------------------------------------------------------------
 // push_param_state
 //----------------------------------------------------------------------------
-Param *utils::push_param_state(std::string path, std::string state)
+Param *utils::push_param_state(const std::string& path, const std::string& state)
 {
     // Get the params mutex
     std::lock_guard<std::mutex> lock(_params_mutex);
 
     // Does the param exist for this state?
-    auto p = _get_param(path, state, false);
+    uint state_id = _get_param_state_id(state);
+    auto p = _get_param(path, state_id, false);
     if (p)
     {
-        // Find the param state object for this param
-        for (ParamState &ps : _param_states)
-        {
-            // Does the parameter path match?
-            if (ps.path == path)
-            {
-                // Push the new state and return the param
-                ps.state_stack.push_back(state);
-                break;
-            }
-        }
+        // Push the new state for this param
+        _push_param_state(*p->param_state, state_id);
     }
     return p;    
 }
@@ -1308,37 +1458,36 @@ Param *utils::push_param_state(std::string path, std::string state)
 //----------------------------------------------------------------------------
 // pop_and_push_param_state
 //----------------------------------------------------------------------------
-Param *utils::pop_and_push_param_state(std::string path, std::string push_state, std::string pop_state)
+Param *utils::pop_and_push_param_state(const std::string& path, const std::string& push_state, const std::string& pop_state)
 {
     // Get the params mutex
     std::lock_guard<std::mutex> lock(_params_mutex);
 
     // Get the param for the state to pop and push
-    auto p = _get_param(path, push_state, false);
+    uint push_state_id = _get_param_state_id(push_state);
+    auto p = _get_param(path, push_state_id, false);
 
-    // For each stored param
-    for (ParamState &ps : _param_states)
+    // Find the param state object for this param
+    auto entry = _get_param_index_entry(path);
+    if (entry)
     {
-        // Does the parameter path match?
-        if (ps.path == path)
-        {
-            // Pop the last state if possible
-            if ((ps.state_stack.size() > 1) && (ps.state_stack.back() == pop_state)) {
-                ps.state_stack.pop_back();
-            }
+        auto &ps = *entry->param_state;
 
-            // Does the param exist for the state to push?
-            if (p)
-            {
-                // Push the new state
-                ps.state_stack.push_back(push_state);
-            }
-            else
-            {
-                // Get the param for the current state
-                p = _get_param(path, ps.state_stack.back(), false);
-            }
-            break;
+        // Pop the last state if possible
+        if ((ps.state_stack.size() > 1) && (ps.state_stack.back() == _get_param_state_id(pop_state))) {
+            _pop_param_state(ps);
+        }
+
+        // Does the param exist for the state to push?
+        if (p)
+        {
+            // Push the new state
+            _push_param_state(ps, push_state_id);
+        }
+        else
+        {
+            // Get the param for the current state
+            p = _get_param(path, ps.state_stack.back(), false);
         }
     }
     return p;    
@@ -1347,31 +1496,24 @@ Param *utils::pop_and_push_param_state(std::string path, std::string push_state,
 //----------------------------------------------------------------------------
 // pop_param_state
 //----------------------------------------------------------------------------
-Param *utils::pop_param_state(std::string path, std::string state)
+Param *utils::pop_param_state(const std::string& path, const std::string& state)
 {
     // Get the params mutex
     std::lock_guard<std::mutex> lock(_params_mutex);
 
-    // For each stored param
-    for (ParamState &ps : _param_states)
+    // Find the param state object for this param
+    auto entry = _get_param_index_entry(path);
+    if (entry)
     {
-        // Does the parameter path match?
-        if (ps.path == path)
-        {
-            // Pop the last state if possible
-            if ((ps.state_stack.size() > 1) && (ps.state_stack.back() == state)) {
-                ps.state_stack.pop_back();
-            }
+        auto &ps = *entry->param_state;
 
-            // Get the param for the current state
-            auto p = _get_param(path, ps.state_stack.back(), false);
-            if (p)
-            {
-                // Return the param
-                return p;
-            }
-            break;
+        // Pop the last state if possible
+        if ((ps.state_stack.size() > 1) && (ps.state_stack.back() == _get_param_state_id(state))) {
+            _pop_param_state(ps);
         }
+
+        // Get and return the param for the current state
+        return _get_param(path, ps.state_stack.back(), false);
     }     
     return nullptr;    
 }
@@ -1379,16 +1521,23 @@ Param *utils::pop_param_state(std::string path, std::string state)
 //----------------------------------------------------------------------------
 // get_param_state
 //----------------------------------------------------------------------------
-std::string utils::get_param_state(std::string path)
+const std::string& utils::get_param_state(const std::string& path)
 {
-    // For each stored param
-    for (ParamState &ps : _param_states)
-    {
-        // Does the parameter path match?
-        if (ps.path == path)
-            return ps.state_stack.back();
-    }
-    return PARAM_DEFAULT;    
+    // Find the param state object for this param in the registry
+    ParamsRegistryReader registry;
+    auto entry = _get_param_index_entry(registry, path);
+    if (entry)
+        return *registry->state_names[entry->param_state->current_state_id];
+    return *registry->state_names[DEFAULT_PARAM_STATE_ID];
+}
+
+//----------------------------------------------------------------------------
+// param_in_current_state
+//----------------------------------------------------------------------------
+bool utils::param_in_current_state(const Param *param)
+{
+    // Is the param state the current state for its path?
+    return _param_in_current_state(param);
 }
 
 //----------------------------------------------------------------------------
@@ -1711,6 +1860,24 @@ MorphMode utils::get_morph_mode(float mode_value)
     return MorphMode(mode);
 }
 
+//----------------------------------------------------------------------------
+// morph_engine
+//----------------------------------------------------------------------------
+MorphEngine *utils::morph_engine()
+{
+    // Return a pointer to the morph engine object
+    return &_morph_engine;
+}
+
+//----------------------------------------------------------------------------
+// bank_index
+//----------------------------------------------------------------------------
+BankIndex *utils::bank_index()
+{
+    // Return a pointer to the bank index object
+    return &_bank_index;
+}
+
 //----------------------------------------------------------------------------
 // init_haptic_modes
 //----------------------------------------------------------------------------
@@ -1736,7 +1903,11 @@ void utils::add_haptic_mode(const HapticMode& haptic_mode)
     }
 
     // Add the mode to the hapticl modes vector
-    _haptic_modes.push_back(haptic_mode);  
+    // Each mode is given an ID and compiled when added, so that it can be written to
+    // the Motor Controllers without processing the mode each time
+    _haptic_modes.push_back(haptic_mode);
+    _haptic_modes.back().id = _haptic_modes.size();
+    SurfaceControl::CompileHapticMode(_haptic_modes.back());
 }
 
 //----------------------------------------------------------------------------
@@ -1763,6 +1934,8 @@ bool utils::set_default_haptic_mode(SurfaceControlType control_type,std::string
     haptic_mode.type = control_type;
     haptic_mode.name = haptic_mode_name;
     haptic_mode.default_mode = true;
+    haptic_mode.id = _haptic_modes.size() + 1;
+    SurfaceControl::CompileHapticMode(haptic_mode);
     _haptic_modes.push_back(haptic_mode);
     return false;
 }
@@ -1838,17 +2011,15 @@ std::vector<SwitchParam *> utils::get_multifn_switch_params()
 {
     std::vector<SwitchParam *> params;
 
-    // Get the params mutex
-    std::lock_guard<std::mutex> lock(_params_mutex);
-
-    // First parse the Nina specific params
-    for (std::unique_ptr<Param> &p : _nina_params)
+    // First parse the Nina specific params in the registry
+    ParamsRegistryReader registry;
+    for (Param *p : registry->nina_params)
     {
         // Does the reference match?
         if (p->multifn_switch)
         {
             // Push the param source
-            params.push_back(static_cast<SwitchParam *>(p.get()));
+            params.push_back(static_cast<SwitchParam *>(p));
         }
     }
     return params;
@@ -2062,44 +2233,137 @@ TempoNoteValue utils::tempo_note_value(int value)
     return TempoNoteValue(value);
 }
 
+//----------------------------------------------------------------------------
+// _get_param_index_entry
+// Note: Private function, and the params mutex must be held by the caller
+//----------------------------------------------------------------------------
+ParamIndexEntry *_get_param_index_entry(const std::string& path)
+{
+    // Find the index entry for this path in the registry builder
+    auto itr = _params_builder.index.find(path);
+    return (itr != _params_builder.index.end()) ? &_params_builder.entries[itr->second] : nullptr;
+}
+
+//----------------------------------------------------------------------------
+// _get_param_index_entry
+// Note: Private function
+//----------------------------------------------------------------------------
+const ParamIndexEntry *_get_param_index_entry(const ParamsRegistryReader& registry, const std::string& path)
+{
+    // Find the index entry for this path in the registry snapshot
+    auto itr = registry->index.find(path);
+    return (itr != registry->index.end()) ? &registry->entries[itr->second] : nullptr;
+}
+
+//----------------------------------------------------------------------------
+// _get_param_state_id
+// Note: Private function, and the params mutex must be held by the caller
+//----------------------------------------------------------------------------
+uint _get_param_state_id(const std::string& state)
+{
+    // Find the interned ID for this state
+    auto itr = _params_builder.state_ids.find(state);
+    return (itr != _params_builder.state_ids.end()) ? itr->second : INVALID_PARAM_STATE_ID;
+}
+
+//----------------------------------------------------------------------------
+// _get_param_state_id
+// Note: Private function
+//----------------------------------------------------------------------------
+uint _get_param_state_id(const ParamsRegistryReader& registry, const std::string& state)
+{
+    // Find the interned ID for this state in the registry snapshot
+    auto itr = registry->state_ids.find(state);
+    return (itr != registry->state_ids.end()) ? itr->second : INVALID_PARAM_STATE_ID;
+}
+
+//----------------------------------------------------------------------------
+// _add_param_state_id
+// Note: Private function
+//----------------------------------------------------------------------------
+uint _add_param_state_id(const std::string& state)
+{
+    // Intern the state if it doesn't already have an ID
+    auto itr = _params_builder.state_ids.try_emplace(state, _param_state_names.size());
+    if (itr.second)
+    {
+        _param_state_names.push_back(state);
+        _params_builder.state_names.push_back(&_param_state_names.back());
+    }
+    return itr.first->second;
+}
+
+//----------------------------------------------------------------------------
+// _param_in_current_state
+// Note: Private function
+//----------------------------------------------------------------------------
+bool _param_in_current_state(const Param *param)
+{
+    // The param is in the current state if its state matches the current state
+    // (top of the param state stack) for its path
+    return param->param_state && (param->state_id == param->param_state->current_state_id);
+}
+
+//----------------------------------------------------------------------------
+// _push_param_state
+// Note: Private function
+//----------------------------------------------------------------------------
+void _push_param_state(ParamState& ps, uint state_id)
+{
+    // Push the state, and track the param state so it can be reset
+    // Note: The param state has changed, so invalidate any cached views
+    ps.state_stack.push_back(state_id);
+    ps.current_state_id = state_id;
+    _params_view_generation++;
+    if (!ps.modified)
+    {
+        ps.modified = true;
+        _modified_param_states.push_back(&ps);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _pop_param_state
+// Note: Private function
+//----------------------------------------------------------------------------
+void _pop_param_state(ParamState& ps)
+{
+    // Pop the state
+    // Note: The param state has changed, so invalidate any cached views
+    ps.state_stack.pop_back();
+    ps.current_state_id = ps.state_stack.back();
+    _params_view_generation++;
+}
+
 //----------------------------------------------------------------------------
 // _get_param
+// Note: Private function
 //----------------------------------------------------------------------------
-Param *_get_param(std::string path)
+Param *_get_param(const ParamIndexEntry *entry)
 {
+    // Get the current state of this path
+    uint state_id = entry->param_state->current_state_id;
+
     // First check the Nina specific params
-    for (const std::unique_ptr<Param> &p : _nina_params)
+    for (Param *p : entry->nina_params)
     {
         // If this is a state change param, don't check the state
         // This is because the state variable contains the target state
-        if (p->type == ParamType::UI_STATE_CHANGE)
-        {
-            // Does the parameter path match?
-            if (p->cmp_path(path))
-            {
-                // Param found, return it
-                return (p.get());
-            }
-        }
-        else
+        if ((p->type == ParamType::UI_STATE_CHANGE) || (p->state_id == state_id))
         {
-            // Does the parameter path and state match?
-            if (p->cmp_path(path) && (p->state == utils::get_param_state(p->get_path())))
-            {
-                // Param found, return it
-                return (p.get());
-            }
+            // Param found, return it
+            return p;
         }
     }
 
     // Not in the Nina params, try the DAW specific params
-    for (const std::unique_ptr<Param> &p : _daw_params)
+    for (Param *p : entry->daw_params)
     {
-        // Does the parameter path and state match?
-        if (p->cmp_path(path) && (p->state == utils::get_param_state(p->get_path())))
+        // Does the parameter state match?
+        if (p->state_id == state_id)
         {
             // Param found, return it
-            return (p.get());
+            return p;
         }
     }
     return nullptr;
@@ -2107,46 +2371,212 @@ Param *_get_param(std::string path)
 
 //----------------------------------------------------------------------------
 // _get_param
-// Note: Private function
+// Note: Private function, and the params mutex must be held by the caller
+//----------------------------------------------------------------------------
+Param *_get_param(const std::string& path, uint state_id, bool preset_param)
+{
+    // Find the index entry for this path in the registry builder
+    auto entry = _get_param_index_entry(path);
+    if (entry)
+    {
+        // Search either the DAW specific params or the Nina specific params
+        // for this path
+        for (Param *p : (preset_param ? entry->daw_params : entry->nina_params))
+        {
+            // Does the parameter state match?
+            if (p->state_id == state_id)
+                return p;
+        }
+    }
+    return nullptr;
+}
+
+//----------------------------------------------------------------------------
+// _publish_params_registry
+// Note: Private function, and the params mutex must be held by the caller
+//----------------------------------------------------------------------------
+void _publish_params_registry()
+{
+    // Build the new registry snapshot from the builder
+    auto registry = new ParamsRegistry(_params_builder);
+
+    // Publish the new snapshot, and once no reader can be using the previous
+    // snapshot, delete it
+    auto prev_registry = _params_registry.exchange(registry);
+    _params_registry_dirty = false;
+    if (prev_registry)
+    {
+        _synchronize_params_registry();
+        delete prev_registry;
+    }
+}
+
 //----------------------------------------------------------------------------
-Param *_get_param(std::string path, std::string state, bool preset_param)
+// _synchronize_params_registry
+// Note: Private function, and the params mutex must be held by the caller
+//----------------------------------------------------------------------------
+void _synchronize_params_registry()
 {
-    // Is this a preset parameter?
-    if (!preset_param)
+    // Wait for the readers in each epoch to finish - flipping the epoch twice means
+    // any reader that could have got the previous snapshot has released it
+    // Note: Readers only hold the registry for the duration of a lookup
+    for (uint i=0; i<2; i++)
     {
-        // Search the Nina specific params vector
-        for (std::unique_ptr<Param> &p : _nina_params)
+        uint epoch = _params_registry_epoch.fetch_add(1);
+        while (_params_registry_readers[epoch & 1] != 0)
         {
-            // Does the parameter path and state match?
-            if (p->cmp_path(path) && (p->state == state))
-                return p.get();
+            std::this_thread::yield();
         }
     }
-    else
+}
+
+//----------------------------------------------------------------------------
+// _get_param_path_regex_prefix
+// Note: Private function
+//----------------------------------------------------------------------------
+ParamPathMatch _get_param_path_regex_prefix(const std::string& regex, std::string& prefix)
+{
+    uint i = 0;
+
+    // Any alternation means there is no common prefix (note this also matches
+    // an escaped or bracketed '|', which is fine as the full regex is used)
+    prefix.clear();
+    if (regex.find('|') != std::string::npos)
+        return ParamPathMatch::REGEX;
+
+    // Get the literal characters at the start of the regex
+    while (i < regex.size())
     {
-        // Search the DAW specific params
-        for (std::unique_ptr<Param> &p : _daw_params)
+        char c = regex[i];
+        if (c == '\\')
         {
-            // Does the parameter path and state match?
-            if (p->cmp_path(path) && (p->state == state))
-                return p.get();
+            // An escaped punctuation character is a literal, otherwise this is
+            // a character class and the prefix ends here
+            if (((i + 1) < regex.size()) && std::ispunct(static_cast<unsigned char>(regex[i + 1])))
+            {
+                prefix += regex[i + 1];
+                i += 2;
+                continue;
+            }
+            break;
         }
+        if (std::strchr(".[]{}()*+?^$", c))
+            break;
+        prefix += c;
+        i++;
     }
-    return nullptr;
+
+    // Is the whole regex a literal path?
+    if (i == regex.size())
+        return ParamPathMatch::EXACT;
+
+    // If the last literal character is optional, it is not part of the prefix
+    if (std::strchr("*?{", regex[i]))
+    {
+        if (prefix.size() > 0)
+            prefix.pop_back();
+        return ParamPathMatch::REGEX;
+    }
+
+    // Is this a prefix match, e.g. "/daw/.*"?
+    return (regex.compare(i, std::string::npos, ".*") == 0) ? ParamPathMatch::PREFIX : ParamPathMatch::REGEX;
 }
 
 //----------------------------------------------------------------------------
-// _get_param
+// _get_param_path_regex
 // Note: Private function
 //----------------------------------------------------------------------------
-Param *_get_param(std::string path, std::string state, std::vector<std::unique_ptr<Param>>& params)
+std::shared_ptr<const std::regex> _get_param_path_regex(const std::string& regex)
 {
-    // Search the passed params
-    for (std::unique_ptr<Param> &p : params)
+    // Get the regex cache mutex
+    std::lock_guard<std::mutex> lock(_param_path_regex_mutex);
+
+    // Is this regex already compiled?
+    auto itr = _param_path_regex_cache.find(regex);
+    if (itr != _param_path_regex_cache.end())
+        return itr->second;
+
+    // Compile the regex and add it to the cache, clearing the cache if it is full
+    // Note: A regex in use by another thread is held by that thread, so can be cleared
+    if (_param_path_regex_cache.size() >= PARAM_PATH_REGEX_CACHE_SIZE)
+        _param_path_regex_cache.clear();
+    return _param_path_regex_cache.emplace(regex, std::make_shared<const std::regex>(regex)).first->second;
+}
+
+//----------------------------------------------------------------------------
+// _get_params_view
+// Note: Private function
+//----------------------------------------------------------------------------
+template <typename Filter>
+utils::ParamsView _get_params_view(std::shared_ptr<const ParamsViewCache>& cache, Filter filter)
+{
+    // Is the cached view still valid?
+    uint generation = _params_view_generation;
+    auto cached = std::atomic_load(&cache);
+    if (cached && (cached->generation == generation))
+        return cached->view;
+
+    // Build the view from the registry, first from the Nina specific params
+    ParamsRegistryReader registry;
+    auto params = std::make_shared<std::vector<Param *>>();
+    for (Param *p : registry->nina_params)
     {
-        // Does the parameter path and state match?
-        if (p->cmp_path(path) && (p->state == state))
-            return p.get();
+        // Add the param if it matches the filter
+        if (filter(p))
+            params->push_back(p);
     }
-    return nullptr;
+
+    // Now the DAW specific params
+    for (Param *p : registry->daw_params)
+    {
+        // Add the param if it matches the filter
+        if (filter(p))
+            params->push_back(p);
+    }
+
+    // Cache the view
+    // Note: If the generation has changed while building the view, it is rebuilt
+    // on the next call
+    std::atomic_store(&cache, std::make_shared<const ParamsViewCache>(ParamsViewCache{generation, params}));
+    return params;
+}
+
+//----------------------------------------------------------------------------
+// ParamsRegistryReader
+// Note: Private class
+//----------------------------------------------------------------------------
+ParamsRegistryReader::ParamsRegistryReader()
+{
+    // A reader must not be created while another reader is held by the same thread
+    assert(!_params_registry_reader_held);
+    _params_registry_reader_held = true;
+
+    // If this thread is registering params that have not been published yet, read
+    // the registry builder under the params mutex
+    // Note: Only the registering thread reads the builder, all other threads read
+    // the published registry, and never wait for the params mutex
+    if ((_params_registration_depth > 0) && _params_registry_dirty)
+    {
+        _lock = std::unique_lock<std::mutex>(_params_mutex);
+        _registry = &_params_builder;
+        return;
+    }
+
+    // Enter the current epoch, and get the published registry
+    _epoch_index = _params_registry_epoch & 1;
+    _params_registry_readers[_epoch_index]++;
+    _registry = _params_registry;
+}
+
+//----------------------------------------------------------------------------
+// ~ParamsRegistryReader
+// Note: Private class
+//----------------------------------------------------------------------------
+ParamsRegistryReader::~ParamsRegistryReader()
+{
+    // Exit the epoch if the published registry was read, the registry can now be
+    // reclaimed
+    if (!_lock.owns_lock())
+        _params_registry_readers[_epoch_index]--;
+    _params_registry_reader_held = false;
 }
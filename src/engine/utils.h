@@ -18,9 +18,16 @@
 #include "param.h"
 #include "surface_control.h"
 #include "layer_info.h"
+#include "morph_engine.h"
+#include "bank_index.h"
 
 namespace utils
 {
+    // Params View - a shared, read-only list of params
+    // Views are cached, and only rebuilt when params are registered, param
+    // states change, or the views are explicitly invalidated
+    typedef std::shared_ptr<const std::vector<Param *>> ParamsView;
+
     enum ParamRef
     {
         MORPH_VALUE,
@@ -97,6 +104,7 @@ namespace utils
     int create_rt_task(pthread_t *rt_thread, void *(*start_routine)(void *), void *arg, int sched_policy);
     void stop_rt_task(pthread_t *rt_thread);
     void rt_task_nanosleep(struct timespec *time);
+    void rt_task_nanosleep_until(const struct timespec *deadline);
     int rtdm_open(const char *path, int oflag);
     int rtdm_ioctl(int fd, int request, void *argp);
     int rtdm_close(int fd);
@@ -107,11 +115,14 @@ namespace utils
     void set_current_layer(uint layer_num);
     bool is_current_layer(uint layer_num);
     std::string get_default_layers_filename(uint index, bool with_ext);
+    void midi_channel_config_changed();
+    uint midi_channel_config_generation();
 
     // MPE utilities
     void init_mpe_handling();
     void reset_mpe_params();
     std::pair<const Param *, const Param *> config_mpe_zone_channel_params();
+    std::pair<uint, uint> mpe_zone_num_channels();
     bool is_mpe_channel(uint channel);
     MpeMode get_mpe_mode(float mode_value);
 
@@ -120,25 +131,38 @@ namespace utils
     std::string get_default_patch_filename(uint index, bool with_ext);
     std::vector<Param *> get_params(NinaModule module);
     std::vector<Param *> get_params(ParamType param_type);
-    std::vector<Param *> get_params(const std::string param_path_regex);
+    std::vector<Param *> get_params(const std::string& param_path_regex);
     std::vector<Param *> get_params_with_state(const std::string state);
     std::vector<Param *> get_patch_params();
     std::vector<Param *> get_mod_matrix_params();
     std::vector<Param *> get_global_params();
-    Param *get_param(std::string path);
-    Param *get_param(std::string path, std::string state);
+    ParamsView get_params_view(NinaModule module);
+    ParamsView get_params_view(ParamType param_type);
+    ParamsView get_patch_params_view();
+    ParamsView get_mod_matrix_params_view();
+    ParamsView get_global_params_view();
+    void invalidate_params_views();
+    uint params_generation();
+    Param *get_param(const std::string& path);
+    Param *get_param_from_handle(ParamHandle handle);
+    ParamHandle get_param_handle(const std::string& path);
+    const std::string& get_param_path(ParamHandle handle);
+    Param *get_param(const std::string& path, const std::string& state);
     Param *get_param(ParamType param_type, int param_id);
     Param *get_param(NinaModule module, int param_id);
     Param *get_sys_func_param(SystemFuncType sys_func_type);
     Param *get_param_from_ref(ParamRef ref);
     KnobParam *get_data_knob_param();
     void register_param(std::unique_ptr<Param> param);
+    void begin_params_registration();
+    void end_params_registration();
     void register_common_params();
     void reset_param_states();
-    Param *push_param_state(std::string path, std::string state);
-    Param *pop_and_push_param_state(std::string path, std::string push_state, std::string pop_state);
-    Param *pop_param_state(std::string path, std::string state);
-    std::string get_param_state(std::string path);
+    Param *push_param_state(const std::string& path, const std::string& state);
+    Param *pop_and_push_param_state(const std::string& path, const std::string& push_state, const std::string& pop_state);
+    Param *pop_param_state(const std::string& path, const std::string& state);
+    const std::string& get_param_state(const std::string& path);
+    bool param_in_current_state(const Param *param);
     void blacklist_param(std::string path);
     bool param_is_blacklisted(std::string path);
     bool param_has_ref(const Param *param, ParamRef ref);
@@ -174,6 +198,10 @@ namespace utils
     void set_prev_morph_state();
     void reset_morph_state();
     MorphMode get_morph_mode(float mode_value);
+    MorphEngine *morph_engine();
+
+    // Bank utilities
+    BankIndex *bank_index();
 
     // Haptic utilities
     void init_haptic_modes();
@@ -13,12 +13,13 @@
 #include "spdlog/async.h"
 
 // Constants
-constexpr char LOGGER_NAME[]       = "Nina";
+constexpr char LOGGER_NAME[]       = "[main]";
 constexpr char LOGGER_FILENAME[]   = "/udata/nina/nina.log";
 constexpr int LOGGER_MAX_FILE_SIZE = 1048576 * 10;          // 10MB
 
 // Static variables
 std::shared_ptr<spdlog::logger> Logger::_logger{nullptr};
+std::array<std::shared_ptr<spdlog::logger>, NUM_NINA_MODULES> Logger::_module_loggers;
 
 //----------------------------------------------------------------------------
 // Start
@@ -26,13 +27,28 @@ std::shared_ptr<spdlog::logger> Logger::_logger{nullptr};
 void Logger::Start() 
 {
     // Setup the spd file logger
-    spdlog::set_pattern("[%Y-%m-%d %T.%e] [%l] %v");
+    // Note: The module name is shown using the logger name, so that it doesn't need to
+    // be added to each message when logging
+    spdlog::set_pattern("[%Y-%m-%d %T.%e] [%l] %n %v");
     spdlog::set_level(spdlog::level::info);
     _logger = spdlog::rotating_logger_mt<spdlog::async_factory>(LOGGER_NAME,
                                                                 LOGGER_FILENAME,
                                                                 LOGGER_MAX_FILE_SIZE,
                                                                 1);
 
+    // Create a logger for each module, sharing the file logger sink and thread pool
+    for (uint i=0; i<NUM_NINA_MODULES; i++)
+    {
+        auto logger = std::make_shared<spdlog::async_logger>(module_name(static_cast<NinaModule>(i)),
+                                                             _logger->sinks().begin(),
+                                                             _logger->sinks().end(),
+                                                             spdlog::thread_pool(),
+                                                             spdlog::async_overflow_policy::block);
+        logger->set_level(spdlog::level::debug);
+        logger->flush_on(spdlog::level::err);
+        _module_loggers[i] = logger;
+    }
+
     // Show the start log header
     _logger->flush_on(spdlog::level::err);
     _logger->info("--------------------");
@@ -66,6 +82,15 @@ void Logger::Flush()
     _logger->flush();
 }
 
+//----------------------------------------------------------------------------
+// Log
+//----------------------------------------------------------------------------
+void Logger::Log(NinaModule module, spdlog::level::level_enum level, const std::string& msg)
+{
+    // Log the pre-formatted message
+    _module_loggers[module]->log(level, "{}", msg);
+}
+
 //----------------------------------------------------------------------------
 // module_name
 //----------------------------------------------------------------------------
@@ -104,6 +129,9 @@ std::string Logger::module_name(NinaModule module)
         case NinaModule::KEYBOARD:
             return "[kbd]"; 
 
+        case NinaModule::GUI:
+            return "[gui]";
+
         case NinaModule::ANY:
         default:
             return "[main]";            
@@ -10,7 +10,9 @@
 #define LOGGER_H
 
 #include <string>
+#include <array>
 #include "spdlog/spdlog.h"
+#include "common.h"
 
 #define NINA_LOG_INFO(module, msg, ...)          Logger::LogInfo(module, msg, ##__VA_ARGS__)
 #define NINA_LOG_WARNING(module, msg, ...)       Logger::LogWarning(module, msg, ##__VA_ARGS__)
@@ -26,30 +28,32 @@ public:
     static void Start();
     static void Stop();
     static void Flush();
+    static void Log(NinaModule module, spdlog::level::level_enum level, const std::string& msg);
     template <typename ... Args>
     static void LogInfo(NinaModule module, const std::string& msg, Args... args)
     {
-        _logger->info("{} " + msg, module_name(module), std::forward<Args>(args)...);
+        _module_loggers[module]->info(msg, std::forward<Args>(args)...);
     }
     template <typename ... Args>
     static void LogWarning(NinaModule module, const std::string& msg, Args... args)
     {
-        _logger->warn("{} " + msg, module_name(module), std::forward<Args>(args)...);
+        _module_loggers[module]->warn(msg, std::forward<Args>(args)...);
     }
     template <typename ... Args>
     static void LogError(NinaModule module, const std::string& msg, Args... args)
     {
-        _logger->error("{} " + msg, module_name(module), std::forward<Args>(args)...);
+        _module_loggers[module]->error(msg, std::forward<Args>(args)...);
     }
     template <typename ... Args>
     static void LogCritical(NinaModule module, const std::string& msg, Args... args)
     {
-        _logger->critical("{} " + msg, module_name(module), std::forward<Args>(args)...);
+        _module_loggers[module]->critical(msg, std::forward<Args>(args)...);
     }
 
 private:
     // Private variables
     static std::shared_ptr<spdlog::logger> _logger;
+    static std::array<std::shared_ptr<spdlog::logger>, NUM_NINA_MODULES> _module_loggers;
 
     // Private functions
     static std::string module_name(NinaModule module);
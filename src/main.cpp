@@ -24,6 +24,9 @@
 #include "utils.h"
 #include "system_func.h"
 #include "logger.h"
+#include "trace_log.h"
+#include "latency_trace.h"
+#include "startup_orchestrator.h"
 #include "version.h"
 
 // Constants
@@ -31,13 +34,18 @@ constexpr char PID_FILENAME[] = "/var/run/nina_app.pid";
 
 // Global variables
 bool exit_flag = false;
+bool log_event_stats_flag = false;
+bool export_latency_trace_flag = false;
 bool exit_condition() {return exit_flag;}
+bool exit_or_signal_request_condition() {return exit_flag || log_event_stats_flag || export_latency_trace_flag;}
 std::condition_variable exit_notifier;
 
 // Local functions
 void _print_nina_ui_info();
 bool _check_pid();
 void _sigint_handler([[maybe_unused]] int sig);
+void _sigusr1_handler([[maybe_unused]] int sig);
+void _sigusr2_handler([[maybe_unused]] int sig);
 
 //----------------------------------------------------------------------------
 // main
@@ -48,6 +56,12 @@ int main(void)
     signal(SIGINT, _sigint_handler);
     signal(SIGTERM, _sigint_handler);
 
+    // Setup the log event stats signal handler
+    signal(SIGUSR1, _sigusr1_handler);
+
+    // Setup the export latency trace signal handler
+    signal(SIGUSR2, _sigusr2_handler);
+
     // Ignore broken pipe signals, handle in the app instead
     signal(SIGPIPE, SIG_IGN);
 
@@ -61,8 +75,12 @@ int main(void)
         // This just needs to be done once on startup
         utils::generate_session_uuid();
         
-        // Start the logger
+        // Start the logger, and the trace log
         Logger::Start();
+        TraceLog::Start();
+
+        // Create the startup orchestrator - the boot timeline is logged relative to this
+        StartupOrchestrator orchestrator;
 
         // Create the Event Router
         auto event_router = std::make_unique<EventRouter>();
@@ -98,73 +116,94 @@ int main(void)
         SystemFunc::RegisterParams();
 
         // Start the managers
-        // Note: The file manager must be started first so that it can initialise the
+        // Each manager is started once the managers it depends on are ready, and
+        // independent managers are started concurrently
+        // Note 1: The file manager must be started first so that it can initialise the
         // params from the preset files, and map from the map file
-        if (file_manager->start())
+        // Note 2: The GUI manager is always used no matter the mode. If the software
+        // manager finds a software update, it will put the app into maintenance mode
+        orchestrator.add(file_manager.get(), {}, true);
+        orchestrator.add(gui_manager.get(), { file_manager.get() });
+        orchestrator.add(sw_manager.get(), { file_manager.get(), gui_manager.get() });
+        if (orchestrator.start())
         {
-            // Start the GUI manager, this is always used no matter the mode
-            gui_manager->start();
-
-            // Start the software manager - if this module finds a software
-            // update, it will put the app into maintenance mode
-            sw_manager->start();
             if (!utils::maintenance_mode())
             {
                 // Start the other managers
-                analog_input_control_manager->start();
-                midi_device_manager->start();
-                daw_manager->start();
-                sequencer_manager->start();
-                arpeggiator_manager->start();
-                keyboard_manager->start();
-                osc_manager->start();
-                surface_control_manager->start();
+                // The MIDI, sequencer, arpeggiator and OSC managers send directly to the DAW
+                // manager, and the keyboard manager to the sequencer and arpeggiator
+                // The surface control manager is started last, once everything it can control
+                // is ready
+                orchestrator.add(analog_input_control_manager.get(), { file_manager.get() });
+                orchestrator.add(daw_manager.get(), { file_manager.get() });
+                orchestrator.add(midi_device_manager.get(), { file_manager.get(), daw_manager.get() });
+                orchestrator.add(sequencer_manager.get(), { file_manager.get(), daw_manager.get() });
+                orchestrator.add(arpeggiator_manager.get(), { file_manager.get(), daw_manager.get() });
+                orchestrator.add(keyboard_manager.get(), { file_manager.get(), sequencer_manager.get(), arpeggiator_manager.get() });
+                orchestrator.add(osc_manager.get(), { file_manager.get(), daw_manager.get() });
+                orchestrator.add(surface_control_manager.get(), { file_manager.get(), gui_manager.get(), analog_input_control_manager.get(),
+                                                                  daw_manager.get(), midi_device_manager.get(), sequencer_manager.get(),
+                                                                  arpeggiator_manager.get(), keyboard_manager.get(), osc_manager.get() });
+                (void)orchestrator.start();
+
+                // All listeners have now been registered
+                event_router->freeze();
                 
                 // Wait forever for an exit signal
+                // Log the manager event stats whenever requested (SIGUSR1), and export
+                // the latency trace whenever requested (SIGUSR2)
                 std::mutex m;
                 std::unique_lock<std::mutex> lock(m);
-                exit_notifier.wait(lock, exit_condition);
-
-                // Clean up the managers
-                analog_input_control_manager->stop();
-                file_manager->stop();
-                gui_manager->stop();
-                daw_manager->stop();
-                midi_device_manager->stop();
-                sequencer_manager->stop();
-                arpeggiator_manager->stop();
-                keyboard_manager->start();
-                osc_manager->stop();
-                sw_manager->stop();
-                surface_control_manager->stop();
+                while (!exit_flag)
+                {
+                    exit_notifier.wait(lock, exit_or_signal_request_condition);
+                    if (log_event_stats_flag)
+                    {
+                        // Log the event stats for each manager
+                        log_event_stats_flag = false;
+                        BaseManager *managers[] = { file_manager.get(), surface_control_manager.get(), analog_input_control_manager.get(),
+                                                    gui_manager.get(), daw_manager.get(), midi_device_manager.get(), sequencer_manager.get(),
+                                                    arpeggiator_manager.get(), keyboard_manager.get(), osc_manager.get(), sw_manager.get() };
+                        for (auto mgr : managers)
+                        {
+                            mgr->log_event_stats();
+                        }
+                        NINA_LOG_FLUSH();
+                    }
+                    if (export_latency_trace_flag)
+                    {
+                        // Export the latency trace
+                        export_latency_trace_flag = false;
+                        LatencyTrace::Export(NINA_UDATA_FILE_PATH(LATENCY_TRACE_FILE));
+                    }
+                }
             }
             else
             {
                 // Maintence mode - a software update is available and in progress
                 // Start the minimum managers to process the software update
-                analog_input_control_manager->start();
-                surface_control_manager->start();
+                orchestrator.add(analog_input_control_manager.get(), { file_manager.get() });
+                orchestrator.add(surface_control_manager.get(), { file_manager.get(), analog_input_control_manager.get() });
+                (void)orchestrator.start();
 
                 // Wait forever for an exit signal
                 std::mutex m;
                 std::unique_lock<std::mutex> lock(m);
                 exit_notifier.wait(lock, exit_condition);
-
-                // Clean up the managers
-                file_manager->stop();
-                gui_manager->stop();
-                surface_control_manager->stop();
-                analog_input_control_manager->stop();
-                sw_manager->stop();     
             }
+
+            // Clean up the managers, in the reverse order they were started
+            orchestrator.stop();
         }          
         else
         {
             // The file manager is a critical component to start the UI
+            orchestrator.stop();
             MSG("\nNINA UI could not be started");
         }
 
-        // Stop the logger
+        // Stop the trace log, and the logger
+        TraceLog::Stop();
         Logger::Stop();
     }
 
@@ -253,3 +292,23 @@ void _sigint_handler([[maybe_unused]] int sig)
     exit_flag = true;
     exit_notifier.notify_one();
 }
+
+//----------------------------------------------------------------------------
+// _sigusr1_handler
+//----------------------------------------------------------------------------
+void _sigusr1_handler([[maybe_unused]] int sig)
+{
+    // Signal to log the manager event stats
+    log_event_stats_flag = true;
+    exit_notifier.notify_one();
+}
+
+//----------------------------------------------------------------------------
+// _sigusr2_handler
+//----------------------------------------------------------------------------
+void _sigusr2_handler([[maybe_unused]] int sig)
+{
+    // Signal to export the latency trace
+    export_latency_trace_flag = true;
+    exit_notifier.notify_one();
+}
@@ -0,0 +1,267 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  trace_log.cpp
+ * @brief Trace Log implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <string>
+#include "trace_log.h"
+#include "logger.h"
+
+// Constants
+constexpr auto TRACE_LOG_DRAIN_PERIOD = std::chrono::milliseconds(50);
+constexpr TraceLogLevel DEFAULT_TRACE_LOG_LEVEL = TraceLogLevel::INFO;
+
+// Trace log ring
+// A single producer (the owning thread), single consumer (the drain thread) ring
+// of trace records
+struct TraceLogRing
+{
+    alignas(64) std::atomic<uint32_t> head;
+    alignas(64) std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> num_dropped;
+    TraceLogRecord records[TRACE_LOG_RING_SIZE];
+};
+
+// Static variables
+std::atomic<uint8_t> TraceLog::_module_levels[NUM_NINA_MODULES];
+
+// Private variables
+static std::mutex _trace_log_mutex;
+static std::condition_variable _trace_log_cv;
+static std::vector<std::unique_ptr<TraceLogRing>> _trace_log_rings;
+static std::thread *_trace_log_drain_thread = nullptr;
+static bool _run_trace_log_drain_thread = false;
+static thread_local TraceLogRing *_thread_trace_log_ring = nullptr;
+
+// Static functions
+static void _process_trace_log_drain();
+static void _drain_trace_log_rings();
+static std::string _format_record(const TraceLogRecord &record);
+static spdlog::level::level_enum _spdlog_level(TraceLogLevel level);
+
+//----------------------------------------------------------------------------
+// Start
+//----------------------------------------------------------------------------
+void TraceLog::Start()
+{
+    // Set the default level for all modules
+    SetLevel(DEFAULT_TRACE_LOG_LEVEL);
+
+    // Start the drain thread
+    // Note: The logger must be started before the trace log
+    std::lock_guard<std::mutex> lock(_trace_log_mutex);
+    if (!_trace_log_drain_thread)
+    {
+        _run_trace_log_drain_thread = true;
+        _trace_log_drain_thread = new std::thread(_process_trace_log_drain);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Stop
+//----------------------------------------------------------------------------
+void TraceLog::Stop()
+{
+    // Drain thread running?
+    if (_trace_log_drain_thread)
+    {
+        // Stop the drain thread
+        // Note: Any traces still in the rings are written before the thread exits
+        {
+            std::lock_guard<std::mutex> lock(_trace_log_mutex);
+            _run_trace_log_drain_thread = false;
+        }
+        _trace_log_cv.notify_all();
+        if (_trace_log_drain_thread->joinable())
+            _trace_log_drain_thread->join();
+        delete _trace_log_drain_thread;
+        _trace_log_drain_thread = nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+// SetLevel
+//----------------------------------------------------------------------------
+void TraceLog::SetLevel(TraceLogLevel level)
+{
+    // Set the level for all modules
+    for (uint i=0; i<NUM_NINA_MODULES; i++)
+    {
+        SetLevel(static_cast<NinaModule>(i), level);
+    }
+}
+
+//----------------------------------------------------------------------------
+// SetLevel
+//----------------------------------------------------------------------------
+void TraceLog::SetLevel(NinaModule module, TraceLogLevel level)
+{
+    // Set the minimum level traced for the module
+    _module_levels[module].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// _begin_record
+//----------------------------------------------------------------------------
+TraceLogRecord *TraceLog::_begin_record()
+{
+    // Get this thread's ring, creating it if this is the first trace from this thread
+    // Note: The rings are never freed, so that a ring can be safely drained after its
+    // thread exits
+    if (!_thread_trace_log_ring)
+    {
+        auto ring = std::make_unique<TraceLogRing>();
+        ring->head = 0;
+        ring->tail = 0;
+        ring->num_dropped = 0;
+        _thread_trace_log_ring = ring.get();
+        std::lock_guard<std::mutex> lock(_trace_log_mutex);
+        _trace_log_rings.push_back(std::move(ring));
+    }
+    auto ring = _thread_trace_log_ring;
+
+    // If the ring is full, drop the record
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    if ((head - ring->tail.load(std::memory_order_acquire)) >= TRACE_LOG_RING_SIZE)
+    {
+        ring->num_dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // Return the next record, timestamped
+    auto record = &ring->records[head % TRACE_LOG_RING_SIZE];
+    record->time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    return record;
+}
+
+//----------------------------------------------------------------------------
+// _commit_record
+//----------------------------------------------------------------------------
+void TraceLog::_commit_record()
+{
+    // Make the record filled by _begin_record available to the drain thread
+    auto ring = _thread_trace_log_ring;
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------
+// _process_trace_log_drain
+//----------------------------------------------------------------------------
+static void _process_trace_log_drain()
+{
+    // Do forever (until the thread is exited)
+    std::unique_lock<std::mutex> lock(_trace_log_mutex);
+    while (true)
+    {
+        // Wait for the drain period, or the thread to be exited
+        _trace_log_cv.wait_for(lock, TRACE_LOG_DRAIN_PERIOD, []{ return !_run_trace_log_drain_thread; });
+
+        // Write the traces in each ring to the log
+        // Note: The mutex is held so the rings list isn't changed while draining - a thread
+        // only takes the mutex when it creates its ring
+        _drain_trace_log_rings();
+        if (!_run_trace_log_drain_thread)
+            break;
+    }
+}
+
+//----------------------------------------------------------------------------
+// _drain_trace_log_rings
+// Note: The trace log mutex must be held by the caller
+//----------------------------------------------------------------------------
+static void _drain_trace_log_rings()
+{
+    for (auto& ring : _trace_log_rings)
+    {
+        // Write each trace record in the ring
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+        while (tail != head)
+        {
+            auto& record = ring->records[tail % TRACE_LOG_RING_SIZE];
+            Logger::Log(record.module, _spdlog_level(record.format->level), _format_record(record));
+            tail++;
+            ring->tail.store(tail, std::memory_order_release);
+        }
+
+        // Log any records dropped because the ring was full
+        uint32_t num_dropped = ring->num_dropped.exchange(0, std::memory_order_relaxed);
+        if (num_dropped > 0)
+            Logger::Log(NinaModule::ANY, spdlog::level::warn, "Trace log ring full, " + std::to_string(num_dropped) + " traces dropped");
+    }
+}
+
+//----------------------------------------------------------------------------
+// _format_record
+//----------------------------------------------------------------------------
+static std::string _format_record(const TraceLogRecord &record)
+{
+    // Prefix the trace with the time it was recorded (steady clock, in microseconds)
+    std::string str = "[" + std::to_string(record.time_ns / 1000) + "us] ";
+
+    // Replace each {} placeholder in the format with its argument
+    uint arg = 0;
+    for (const char *f = record.format->format; *f; f++)
+    {
+        if ((f[0] == '{') && (f[1] == '}') && (arg < record.num_args))
+        {
+            auto& a = record.args[arg++];
+            switch (a.type)
+            {
+                case TraceLogArgType::INT:
+                    str += std::to_string(a.i);
+                    break;
+
+                case TraceLogArgType::UINT:
+                    str += std::to_string(a.u);
+                    break;
+
+                case TraceLogArgType::FLOAT:
+                    str += std::to_string(a.f);
+                    break;
+
+                case TraceLogArgType::BOOL:
+                    str += a.b ? "true" : "false";
+                    break;
+            }
+            f++;
+        }
+        else
+        {
+            str += *f;
+        }
+    }
+    return str;
+}
+
+//----------------------------------------------------------------------------
+// _spdlog_level
+//----------------------------------------------------------------------------
+static spdlog::level::level_enum _spdlog_level(TraceLogLevel level)
+{
+    // Parse the level
+    switch (level)
+    {
+        case TraceLogLevel::DEBUG:
+            return spdlog::level::debug;
+
+        case TraceLogLevel::WARNING:
+            return spdlog::level::warn;
+
+        case TraceLogLevel::ERROR:
+            return spdlog::level::err;
+
+        case TraceLogLevel::INFO:
+        default:
+            return spdlog::level::info;
+    }
+}
@@ -0,0 +1,176 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  trace_log.h
+ * @brief Trace Log class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _TRACE_LOG_H
+#define _TRACE_LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "common.h"
+
+// Trace log constants
+constexpr uint TRACE_LOG_RING_SIZE = 512;
+constexpr uint TRACE_LOG_MAX_ARGS  = 4;
+
+// MACROs to trace a message
+// The format must be a string literal, using {} for each argument - the arguments
+// must be arithmetic or enum values
+#define NINA_TRACE(level, module, format, ...)                                                          \
+    do {                                                                                                \
+        static_assert(trace_log_num_placeholders(format) == decltype(trace_log_num_args(__VA_ARGS__))::value, \
+                      "Trace log format does not match the number of arguments");                       \
+        static constexpr TraceLogFormat trace_log_format{level, format};                                \
+        if (TraceLog::Enabled(module, level))                                                           \
+            TraceLog::Log(module, &trace_log_format, ##__VA_ARGS__);                                    \
+    } while (false)
+#define NINA_TRACE_DEBUG(module, format, ...)    NINA_TRACE(TraceLogLevel::DEBUG, module, format, ##__VA_ARGS__)
+#define NINA_TRACE_INFO(module, format, ...)     NINA_TRACE(TraceLogLevel::INFO, module, format, ##__VA_ARGS__)
+#define NINA_TRACE_WARNING(module, format, ...)  NINA_TRACE(TraceLogLevel::WARNING, module, format, ##__VA_ARGS__)
+#define NINA_TRACE_ERROR(module, format, ...)    NINA_TRACE(TraceLogLevel::ERROR, module, format, ##__VA_ARGS__)
+
+// Trace log level
+enum class TraceLogLevel : uint8_t
+{
+    DEBUG = 0,
+    INFO,
+    WARNING,
+    ERROR,
+    OFF
+};
+
+// Trace log format
+// Defined at compile time for each trace, only a pointer to it is recorded
+struct TraceLogFormat
+{
+    TraceLogLevel level;
+    const char *format;
+};
+
+// Trace log argument type
+enum class TraceLogArgType : uint8_t
+{
+    INT,
+    UINT,
+    FLOAT,
+    BOOL
+};
+
+// Trace log argument
+struct TraceLogArg
+{
+    TraceLogArgType type;
+    union
+    {
+        int64_t i;
+        uint64_t u;
+        double f;
+        bool b;
+    };
+};
+
+// Trace log record
+struct TraceLogRecord
+{
+    uint64_t time_ns;
+    const TraceLogFormat *format;
+    NinaModule module;
+    uint num_args;
+    TraceLogArg args[TRACE_LOG_MAX_ARGS];
+};
+
+// Return the number of {} placeholders in a trace log format
+constexpr uint trace_log_num_placeholders(const char *format)
+{
+    uint num = 0;
+    for (; *format; format++)
+    {
+        if ((format[0] == '{') && (format[1] == '}'))
+            num++;
+    }
+    return num;
+}
+
+// Return the number of trace log arguments (unevaluated)
+template <typename ... Args>
+std::integral_constant<uint, sizeof...(Args)> trace_log_num_args(const Args&...);
+
+// Trace Log class
+// A trace is recorded in binary form to a lock-free ring buffer owned by the calling
+// thread - recording takes a timestamp and copies the arguments, no formatting or
+// I/O is done by the calling thread. A background thread drains the rings, formats
+// each record, and writes it to the log
+// If a ring is full the record is dropped, and the number dropped is logged
+class TraceLog
+{
+public:
+    // Public functions
+    static void Start();
+    static void Stop();
+    static void SetLevel(TraceLogLevel level);
+    static void SetLevel(NinaModule module, TraceLogLevel level);
+    static bool Enabled(NinaModule module, TraceLogLevel level)
+    {
+        return static_cast<uint8_t>(level) >= _module_levels[module].load(std::memory_order_relaxed);
+    }
+    template <typename ... Args>
+    static void Log(NinaModule module, const TraceLogFormat *format, Args... args)
+    {
+        static_assert(sizeof...(Args) <= TRACE_LOG_MAX_ARGS, "Too many trace log arguments");
+
+        // Get the next record in this thread's ring, and fill it
+        auto record = _begin_record();
+        if (record)
+        {
+            record->format = format;
+            record->module = module;
+            record->num_args = sizeof...(Args);
+            [[maybe_unused]] uint i = 0;
+            ((record->args[i++] = _make_arg(args)), ...);
+            _commit_record();
+        }
+    }
+
+private:
+    // Private variables
+    static std::atomic<uint8_t> _module_levels[NUM_NINA_MODULES];
+
+    // Private functions
+    static TraceLogRecord *_begin_record();
+    static void _commit_record();
+    template <typename T>
+    static TraceLogArg _make_arg(T value)
+    {
+        TraceLogArg arg;
+        if constexpr (std::is_same_v<T, bool>) {
+            arg.type = TraceLogArgType::BOOL;
+            arg.b = value;
+        }
+        else if constexpr (std::is_enum_v<T>) {
+            arg.type = TraceLogArgType::INT;
+            arg.i = static_cast<int64_t>(value);
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            arg.type = TraceLogArgType::FLOAT;
+            arg.f = value;
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            arg.type = TraceLogArgType::INT;
+            arg.i = value;
+        }
+        else {
+            static_assert(std::is_integral_v<T>, "Trace log arguments must be arithmetic or enum values");
+            arg.type = TraceLogArgType::UINT;
+            arg.u = value;
+        }
+        return arg;
+    }
+};
+
+#endif // _TRACE_LOG_H
@@ -0,0 +1,318 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  nina_ui_benchmarks.cpp
+ * @brief Micro-benchmarks for the engine hot paths.
+ *-----------------------------------------------------------------------------
+ */
+#include "benchmark/benchmark.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+#include "rapidjson/document.h"
+#include "rapidjson/schema.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+#include "utils.h"
+#include "param.h"
+#include "event.h"
+#include "event_router.h"
+#include "base_manager.h"
+#include "patch_cache.h"
+#include "midi_device_manager.h"
+
+// Benchmark constants
+constexpr uint NUM_BENCH_PARAMS       = 1024;
+constexpr uint NUM_BENCH_PATCH_PARAMS = 256;
+constexpr uint NUM_BENCH_COALESCE_CCS = 16;
+constexpr uint BENCH_MIDI_QUEUE_SIZE   = 4096;
+constexpr char BENCH_PARAM_NAME[]     = "bench_param_";
+constexpr char BENCH_DIR_TEMPLATE[]   = "/tmp/nina_ui_benchmarks.XXXXXX";
+
+// Benchmark Manager class
+// A manager that is never started, so posted messages stay queued (and are coalesced)
+class BenchManager : public BaseManager
+{
+public:
+    BenchManager(EventRouter *event_router) : BaseManager(NinaModule::GUI, "BenchManager", event_router) {}
+    void process_event(const BaseEvent *) {}
+};
+
+// Helper to register the benchmark params (once)
+static const std::vector<Param *>& bench_params()
+{
+    static std::vector<Param *> params;
+    if (params.empty())
+    {
+        for (uint i=0; i<NUM_BENCH_PARAMS; i++)
+        {
+            auto param = Param::CreateParam(NinaModule::DAW, BENCH_PARAM_NAME + std::to_string(i));
+            auto path = param->get_path();
+            utils::register_param(std::move(param));
+            params.push_back(utils::get_param(path));
+        }
+    }
+    return params;
+}
+
+// Helper to create a patch, with the benchmark params in each section
+static void bench_patch(rapidjson::Document& json_doc)
+{
+    json_doc.SetObject();
+    auto& a = json_doc.GetAllocator();
+    json_doc.AddMember("revision", 1, a);
+    for (auto section : { "common", "state_a", "state_b" })
+    {
+        rapidjson::Value params(rapidjson::kArrayType);
+        for (uint i=0; i<NUM_BENCH_PATCH_PARAMS; i++)
+        {
+            auto path = Param::ParamPath(NinaModule::DAW, BENCH_PARAM_NAME + std::to_string(i));
+            rapidjson::Value param(rapidjson::kObjectType);
+            param.AddMember("path", rapidjson::Value(path.c_str(), a), a);
+            param.AddMember("value", (float)i / NUM_BENCH_PATCH_PARAMS, a);
+            params.PushBack(param, a);
+        }
+        json_doc.AddMember(rapidjson::StringRef(section), params, a);
+    }
+}
+
+// Helper to serialise a JSON document
+static std::string bench_serialise(const rapidjson::Document& json_doc)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    (void)json_doc.Accept(writer);
+    return buffer.GetString();
+}
+
+// Helper to get a temporary benchmark directory (created once)
+static const std::string& bench_dir()
+{
+    static std::string dir;
+    if (dir.empty())
+    {
+        char tmpl[sizeof(BENCH_DIR_TEMPLATE)];
+        std::strcpy(tmpl, BENCH_DIR_TEMPLATE);
+        dir = std::string(::mkdtemp(tmpl)) + "/";
+    }
+    return dir;
+}
+
+// Helper to create a MIDI CC event
+static snd_seq_event_t bench_cc_event(uint channel, uint param, int value)
+{
+    snd_seq_event_t event = {};
+    event.type = SND_SEQ_EVENT_CONTROLLER;
+    event.data.control.channel = channel;
+    event.data.control.param = param;
+    event.data.control.value = value;
+    return event;
+}
+
+//----------------------------------------------------------------------------
+// Param registry
+//----------------------------------------------------------------------------
+static void BM_GetParam(benchmark::State& state)
+{
+    // Look up each param by its path
+    auto& params = bench_params();
+    std::vector<std::string> paths;
+    for (auto p : params)
+        paths.push_back(p->get_path());
+    uint i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(utils::get_param(paths[i++ % paths.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetParam);
+
+static void BM_GetParamsRegex(benchmark::State& state)
+{
+    // Get the params matching a regex with a literal prefix - 1 in 10 params match
+    auto& params = bench_params();
+    auto prefix = params.front()->get_path();
+    auto regex = prefix.substr(0, prefix.size() - 1) + "[0-9]*7";
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(utils::get_params(regex));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetParamsRegex);
+
+//----------------------------------------------------------------------------
+// Event Router
+//----------------------------------------------------------------------------
+static void BM_EventRouterFanOut(benchmark::State& state)
+{
+    // Register the listeners for the Param Changed events
+    auto event_router = std::make_unique<EventRouter>();
+    std::vector<std::unique_ptr<BenchManager>> managers;
+    std::vector<std::unique_ptr<EventListener>> listeners;
+    for (int i=0; i<state.range(0); i++)
+    {
+        managers.push_back(std::make_unique<BenchManager>(event_router.get()));
+        listeners.push_back(std::make_unique<EventListener>(NinaModule::SURFACE_CONTROL, EventType::PARAM_CHANGED, managers.back().get()));
+        event_router->register_event_listener(listeners.back().get());
+    }
+    event_router->freeze();
+
+    // Post Param Changed events for a set of params to all listeners
+    auto& params = bench_params();
+    uint i = 0;
+    for (auto _ : state)
+    {
+        auto param_change = ParamChange(params[i++ % NUM_BENCH_COALESCE_CCS], NinaModule::SURFACE_CONTROL);
+        event_router->post_param_changed_event(new ParamChangedEvent(param_change));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EventRouterFanOut)->Arg(1)->Arg(4)->Arg(10);
+
+//----------------------------------------------------------------------------
+// Base Manager
+//----------------------------------------------------------------------------
+static void BM_PostMsgCoalesced(benchmark::State& state)
+{
+    // Post Param Changed events for a set of params - once each param has been queued,
+    // each event is coalesced with the queued event for its param
+    auto event_router = std::make_unique<EventRouter>();
+    auto manager = std::make_unique<BenchManager>(event_router.get());
+    auto& params = bench_params();
+    uint i = 0;
+    for (auto _ : state)
+    {
+        auto param_change = ParamChange(params[i++ % state.range(0)], NinaModule::SURFACE_CONTROL);
+        manager->post_msg(new ParamChangedEvent(param_change));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["coalesced"] = manager->num_coalesced_msgs();
+}
+BENCHMARK(BM_PostMsgCoalesced)->Arg(1)->Arg(64)->Arg(NUM_BENCH_PARAMS);
+
+//----------------------------------------------------------------------------
+// Patch parse/save
+//----------------------------------------------------------------------------
+static void BM_PatchParse(benchmark::State& state)
+{
+    // Parse and validate a patch against the patch schema, as done when a patch file
+    // is opened that is not trusted
+    const char *schema =
+#include "json_schemas/patch_schema.json"
+    ;
+    rapidjson::Document schema_doc;
+    schema_doc.Parse(schema);
+    rapidjson::SchemaDocument schema_document(schema_doc);
+    rapidjson::Document patch;
+    bench_patch(patch);
+    auto patch_str = bench_serialise(patch);
+    for (auto _ : state)
+    {
+        rapidjson::Document json_doc;
+        json_doc.Parse(patch_str.c_str());
+        rapidjson::SchemaValidator schema_validator(schema_document);
+        if (!json_doc.Accept(schema_validator))
+            state.SkipWithError("Schema validation failed");
+    }
+    state.SetBytesProcessed(state.iterations() * patch_str.size());
+}
+BENCHMARK(BM_PatchParse);
+
+static void BM_PatchSerialise(benchmark::State& state)
+{
+    // Serialise a patch, as done when a patch file is saved
+    rapidjson::Document patch;
+    bench_patch(patch);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(bench_serialise(patch));
+    }
+}
+BENCHMARK(BM_PatchSerialise);
+
+static void BM_PatchCacheLoad(benchmark::State& state)
+{
+    // Save a patch file and its cached copy
+    auto patch_file_path = bench_dir() + "patch.json";
+    rapidjson::Document patch;
+    bench_patch(patch);
+    std::ofstream(patch_file_path) << bench_serialise(patch);
+    auto cache_dir = bench_dir() + "patch_cache/";
+    ::mkdir(cache_dir.c_str(), 0755);
+    PatchCache patch_cache(cache_dir);
+
+    // Load the patch from the in memory cache (range 1), or the binary cache file (range 0)
+    if (state.range(0) == 0)
+        patch_cache.set_memory_budget(0);
+    patch_cache.save(patch_file_path, patch);
+    rapidjson::Document json_doc;
+    for (auto _ : state)
+    {
+        if (!patch_cache.load(patch_file_path, json_doc))
+            state.SkipWithError("Patch cache load failed");
+    }
+}
+BENCHMARK(BM_PatchCacheLoad)->Arg(0)->Arg(1);
+
+static void BM_PatchCacheSave(benchmark::State& state)
+{
+    // Save a patch to the binary patch cache
+    auto patch_file_path = bench_dir() + "patch_save.json";
+    rapidjson::Document patch;
+    bench_patch(patch);
+    std::ofstream(patch_file_path) << bench_serialise(patch);
+    auto cache_dir = bench_dir() + "patch_cache/";
+    ::mkdir(cache_dir.c_str(), 0755);
+    PatchCache patch_cache(cache_dir);
+    for (auto _ : state)
+    {
+        patch_cache.save(patch_file_path, patch);
+    }
+}
+BENCHMARK(BM_PatchCacheSave);
+
+//----------------------------------------------------------------------------
+// MIDI CC queue coalescing
+//----------------------------------------------------------------------------
+static void BM_MidiCcQueueCoalesce(benchmark::State& state)
+{
+    // Queue a burst of CC events for a set of controllers, as the MIDI event queue
+    // does - an event for a controller already queued overwrites the queued event
+    std::vector<snd_seq_event_t> queue;
+    queue.reserve(BENCH_MIDI_QUEUE_SIZE);
+    MidiCoalesceTable coalesce_table;
+    for (auto _ : state)
+    {
+        for (int i=0; i<state.range(0); i++)
+        {
+            auto event = bench_cc_event(0, i % NUM_BENCH_COALESCE_CCS, i);
+            uint index;
+            if (coalesce_table.find(event, index))
+            {
+                queue[index] = event;
+            }
+            else
+            {
+                coalesce_table.add(event, queue.size());
+                queue.push_back(event);
+            }
+        }
+
+        // The queue is processed
+        benchmark::DoNotOptimize(queue.data());
+        queue.clear();
+        coalesce_table.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MidiCcQueueCoalesce)->Arg(16)->Arg(256);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,194 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  mock_surface_control.cpp
+ * @brief Mock Surface Control driver, for building the engine without hardware.
+ *-----------------------------------------------------------------------------
+ */
+#include <cstring>
+#include "surface_control.h"
+
+// Constants
+constexpr char KNOB_TYPE_STRING[] = "knob";
+constexpr char SWITCH_TYPE_STRING[] = "switch";
+
+//----------------------------------------------------------------------------
+// ControlTypeFromString
+//----------------------------------------------------------------------------
+SurfaceControlType SurfaceControl::ControlTypeFromString(const char *type)
+{
+    // Return the Surface Control type from the string
+    if (std::strcmp(type, KNOB_TYPE_STRING) == 0)
+        return SurfaceControlType::KNOB;
+    else if (std::strcmp(type, SWITCH_TYPE_STRING) == 0)
+        return SurfaceControlType::SWITCH;
+    return SurfaceControlType::UNKNOWN;
+}
+
+//----------------------------------------------------------------------------
+// CompileHapticMode
+//----------------------------------------------------------------------------
+void SurfaceControl::CompileHapticMode(HapticMode& haptic_mode)
+{
+    // There is no Motor Controller, so there is no command to compile
+    haptic_mode.knob_cmd_image.clear();
+}
+
+//----------------------------------------------------------------------------
+// SurfaceControl
+//----------------------------------------------------------------------------
+SurfaceControl::SurfaceControl()
+{
+    // Initialise class data
+    _dev_handle = -1;
+    _panel_controller_active = false;
+    _led_states = nullptr;
+    _committed_led_states = nullptr;
+    _committed_led_states_valid = false;
+    _num_led_commits_skipped = 0;
+    _bus_thread = nullptr;
+    _run_bus_thread = false;
+    _num_bus_reads_pending = 0;
+    _next_bus_knob_num = 0;
+    _led_commit_pending = false;
+    _selected_controller_addr = -1;
+    _i2c_combined_transfers = false;
+}
+
+//----------------------------------------------------------------------------
+// ~SurfaceControl
+//----------------------------------------------------------------------------
+SurfaceControl::~SurfaceControl()
+{
+}
+
+//----------------------------------------------------------------------------
+// open
+//----------------------------------------------------------------------------
+int SurfaceControl::open()
+{
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// close
+//----------------------------------------------------------------------------
+int SurfaceControl::close()
+{
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// lock
+//----------------------------------------------------------------------------
+void SurfaceControl::lock()
+{
+    _controller_mutex.lock();
+}
+
+//----------------------------------------------------------------------------
+// unlock
+//----------------------------------------------------------------------------
+void SurfaceControl::unlock()
+{
+    _controller_mutex.unlock();
+}
+
+//----------------------------------------------------------------------------
+// knob_is_active
+//----------------------------------------------------------------------------
+bool SurfaceControl::knob_is_active([[maybe_unused]] uint num)
+{
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// request_knob_states
+//----------------------------------------------------------------------------
+int SurfaceControl::request_knob_states([[maybe_unused]] const bool *poll_knobs)
+{
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// read_knob_states
+//----------------------------------------------------------------------------
+int SurfaceControl::read_knob_states(KnobState *states)
+{
+    // All knobs are at rest, at position zero
+    std::memset(states, 0, sizeof(KnobState) * NUM_PHYSICAL_KNOBS);
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// knob_state_result
+//----------------------------------------------------------------------------
+int SurfaceControl::knob_state_result([[maybe_unused]] uint num)
+{
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// read_switch_states
+//----------------------------------------------------------------------------
+int SurfaceControl::read_switch_states(bool *states)
+{
+    // All switches are released
+    std::memset(states, 0, sizeof(bool) * NUM_PHYSICAL_SWITCHES);
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// set_knob_haptic_mode
+//----------------------------------------------------------------------------
+int SurfaceControl::set_knob_haptic_mode([[maybe_unused]] unsigned int num, [[maybe_unused]] const HapticMode& haptic_mode)
+{
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// set_knob_position
+//----------------------------------------------------------------------------
+int SurfaceControl::set_knob_position([[maybe_unused]] unsigned int num, [[maybe_unused]] uint16_t position, [[maybe_unused]] bool robust)
+{
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// knob_position_result
+//----------------------------------------------------------------------------
+int SurfaceControl::knob_position_result([[maybe_unused]] unsigned int num, [[maybe_unused]] uint16_t position)
+{
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// set_switch_led_state
+//----------------------------------------------------------------------------
+int SurfaceControl::set_switch_led_state([[maybe_unused]] unsigned int num, [[maybe_unused]] bool led_on)
+{
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// set_all_switch_led_states
+//----------------------------------------------------------------------------
+void SurfaceControl::set_all_switch_led_states([[maybe_unused]] bool leds_on)
+{
+}
+
+//----------------------------------------------------------------------------
+// commit_led_states
+//----------------------------------------------------------------------------
+int SurfaceControl::commit_led_states()
+{
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// reinit
+//----------------------------------------------------------------------------
+void SurfaceControl::reinit()
+{
+}
@@ -0,0 +1,210 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  mock_sushi_controller.cpp
+ * @brief Mock Sushi controller, for building the engine without Sushi and
+ *        capturing the calls made to Sushi.
+ *-----------------------------------------------------------------------------
+ */
+#include <string>
+#include <vector>
+#include "mock_sushi_controller.h"
+
+using namespace sushi_controller;
+
+// Private variables
+std::function<void(const MockSushiCall&)> _mock_sushi_call_handler;
+
+// Static functions
+static void _capture_call(MockSushiCallType type, int id_a, int id_b, float value);
+
+// Mock System controller
+class MockSystemController : public SystemController
+{
+public:
+    std::pair<ControlStatus, SushiBuildInfo> get_build_info() const override
+    {
+        // Note: No commit hash is returned, so the DAW Manager never caches the mock schema
+        auto build_info = SushiBuildInfo();
+        build_info.version = "mock";
+        return {ControlStatus::OK, build_info};
+    }
+};
+
+// Mock Transport controller
+class MockTransportController : public TransportController
+{
+public:
+    ControlStatus set_tempo(float tempo) override
+    {
+        _capture_call(MockSushiCallType::SET_TEMPO, 0, 0, tempo);
+        return ControlStatus::OK;
+    }
+};
+
+// Mock Keyboard controller
+class MockKeyboardController : public KeyboardController
+{
+public:
+    ControlStatus send_note_on([[maybe_unused]] int track_id, int channel, int note, float velocity) override
+    {
+        _capture_call(MockSushiCallType::NOTE_ON, channel, note, velocity);
+        return ControlStatus::OK;
+    }
+    ControlStatus send_note_off([[maybe_unused]] int track_id, int channel, int note, float velocity) override
+    {
+        _capture_call(MockSushiCallType::NOTE_OFF, channel, note, velocity);
+        return ControlStatus::OK;
+    }
+    ControlStatus send_note_aftertouch([[maybe_unused]] int track_id, int channel, int note, float value) override
+    {
+        _capture_call(MockSushiCallType::NOTE_AFTERTOUCH, channel, note, value);
+        return ControlStatus::OK;
+    }
+};
+
+// Mock Audio Graph controller
+class MockAudioGraphController : public AudioGraphController
+{
+public:
+    std::pair<ControlStatus, std::vector<TrackInfo>> get_all_tracks() const override
+    {
+        // Return the main track
+        auto track_info = TrackInfo();
+        track_info.id = MOCK_SUSHI_MAIN_TRACK_ID;
+        track_info.name = "main";
+        track_info.processors = { MOCK_SUSHI_PROCESSOR_ID };
+        return {ControlStatus::OK, { track_info }};
+    }
+    std::pair<ControlStatus, std::vector<ProcessorInfo>> get_track_processors(int track_id) const override
+    {
+        // Return the processor on the main track
+        if (track_id != MOCK_SUSHI_MAIN_TRACK_ID)
+            return {ControlStatus::NOT_FOUND, {}};
+        auto processor_info = ProcessorInfo();
+        processor_info.id = MOCK_SUSHI_PROCESSOR_ID;
+        processor_info.name = MOCK_SUSHI_PROCESSOR_NAME;
+        processor_info.parameter_count = MOCK_SUSHI_NUM_PARAMS;
+        return {ControlStatus::OK, { processor_info }};
+    }
+};
+
+// Mock Parameter controller
+class MockParameterController : public ParameterController
+{
+public:
+    std::pair<ControlStatus, std::vector<ParameterInfo>> get_processor_parameters(int processor_id) const override
+    {
+        // Return the processor params
+        std::vector<ParameterInfo> params;
+        if (processor_id == MOCK_SUSHI_PROCESSOR_ID)
+        {
+            for (uint i=0; i<MOCK_SUSHI_NUM_PARAMS; i++)
+            {
+                auto param_info = ParameterInfo();
+                param_info.id = i;
+                param_info.type = ParameterType::FLOAT;
+                param_info.name = MOCK_SUSHI_PARAM_NAME + std::to_string(i);
+                param_info.automatable = true;
+                param_info.min_domain_value = 0.0f;
+                param_info.max_domain_value = 1.0f;
+                params.push_back(param_info);
+            }
+        }
+        return {ControlStatus::OK, params};
+    }
+    std::pair<ControlStatus, std::vector<ParameterInfo>> get_track_parameters([[maybe_unused]] int track_id) const override
+    {
+        return {ControlStatus::OK, {}};
+    }
+    std::pair<ControlStatus, float> get_parameter_value([[maybe_unused]] int processor_id, [[maybe_unused]] int parameter_id) const override
+    {
+        return {ControlStatus::OK, 0.0f};
+    }
+    std::pair<ControlStatus, std::vector<ParameterValue>> get_parameter_values(int processor_id) const override
+    {
+        // Return the processor param values - all params are initially zero
+        std::vector<ParameterValue> values;
+        if (processor_id == MOCK_SUSHI_PROCESSOR_ID)
+        {
+            for (uint i=0; i<MOCK_SUSHI_NUM_PARAMS; i++)
+            {
+                values.push_back(ParameterValue{processor_id, (int)i, 0.0f});
+            }
+        }
+        return {ControlStatus::OK, values};
+    }
+    ControlStatus set_parameter_value(int processor_id, int parameter_id, float value) override
+    {
+        _capture_call(MockSushiCallType::SET_PARAMETER_VALUE, processor_id, parameter_id, value);
+        return ControlStatus::OK;
+    }
+    ControlStatus set_parameter_values(const std::vector<ParameterValue>& values) override
+    {
+        // Capture each value in the batch
+        for (const ParameterValue& pv : values)
+        {
+            _capture_call(MockSushiCallType::SET_PARAMETER_VALUE, pv.processor_id, pv.parameter_id, pv.value);
+        }
+        return ControlStatus::OK;
+    }
+};
+
+// Mock Notification controller
+class MockNotificationController : public NotificationController
+{
+public:
+    ControlStatus subscribe_to_parameter_updates([[maybe_unused]] std::function<void(int, int, float)> callback,
+                                                 [[maybe_unused]] const std::vector<std::pair<int,int>> param_blocklist) override
+    {
+        // The mock Sushi never changes a param, so never notifies
+        return ControlStatus::OK;
+    }
+};
+
+// Mock Sushi controller
+class MockSushiController : public SushiController
+{
+public:
+    SystemController* system_controller() override { return &_system_controller; }
+    TransportController* transport_controller() override { return &_transport_controller; }
+    KeyboardController* keyboard_controller() override { return &_keyboard_controller; }
+    AudioGraphController* audio_graph_controller() override { return &_audio_graph_controller; }
+    ParameterController* parameter_controller() override { return &_parameter_controller; }
+    NotificationController* notification_controller() override { return &_notification_controller; }
+
+private:
+    MockSystemController _system_controller;
+    MockTransportController _transport_controller;
+    MockKeyboardController _keyboard_controller;
+    MockAudioGraphController _audio_graph_controller;
+    MockParameterController _parameter_controller;
+    MockNotificationController _notification_controller;
+};
+
+//----------------------------------------------------------------------------
+// mock_sushi_set_call_handler
+//----------------------------------------------------------------------------
+void mock_sushi_set_call_handler(std::function<void(const MockSushiCall&)> handler)
+{
+    _mock_sushi_call_handler = handler;
+}
+
+//----------------------------------------------------------------------------
+// CreateSushiController
+//----------------------------------------------------------------------------
+std::shared_ptr<SushiController> sushi_controller::CreateSushiController([[maybe_unused]] const std::string& server_address)
+{
+    return std::make_shared<MockSushiController>();
+}
+
+//----------------------------------------------------------------------------
+// _capture_call
+//----------------------------------------------------------------------------
+static void _capture_call(MockSushiCallType type, int id_a, int id_b, float value)
+{
+    // Timestamp the call and pass it to the handler
+    if (_mock_sushi_call_handler)
+        _mock_sushi_call_handler(MockSushiCall{std::chrono::steady_clock::now(), type, id_a, id_b, value});
+}
@@ -0,0 +1,52 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  mock_sushi_controller.h
+ * @brief Mock Sushi controller, for building the engine without Sushi and
+ *        capturing the calls made to Sushi.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _MOCK_SUSHI_CONTROLLER_H
+#define _MOCK_SUSHI_CONTROLLER_H
+
+#include <chrono>
+#include <functional>
+#include "sushi_client.h"
+
+// Mock Sushi constants
+// The mock Sushi has a single "main" track, with one processor
+constexpr int MOCK_SUSHI_MAIN_TRACK_ID       = 0;
+constexpr int MOCK_SUSHI_PROCESSOR_ID        = 1;
+constexpr char MOCK_SUSHI_PROCESSOR_NAME[]   = "soak";
+constexpr char MOCK_SUSHI_PARAM_NAME[]       = "param_";
+constexpr uint MOCK_SUSHI_NUM_PARAMS         = 128;
+constexpr int MOCK_SUSHI_PARAM_ID_MASK       = 0xFF;
+
+// Mock Sushi call type
+enum class MockSushiCallType
+{
+    SET_PARAMETER_VALUE,
+    NOTE_ON,
+    NOTE_OFF,
+    NOTE_AFTERTOUCH,
+    SET_TEMPO
+};
+
+// Mock Sushi call
+// For a parameter the ID is the processor and parameter ID, for a note it is
+// the channel and note number
+struct MockSushiCall
+{
+    std::chrono::steady_clock::time_point time;
+    MockSushiCallType type;
+    int id_a;
+    int id_b;
+    float value;
+};
+
+// Set the function called (from the calling thread) for each call made to Sushi
+// Note: This must be set before the DAW Manager is created
+void mock_sushi_set_call_handler(std::function<void(const MockSushiCall&)> handler);
+
+#endif // _MOCK_SUSHI_CONTROLLER_H
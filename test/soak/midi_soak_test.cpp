@@ -0,0 +1,720 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  midi_soak_test.cpp
+ * @brief MIDI flood replay and latency soak test.
+ *
+ * Replays a synthetic or recorded MIDI stream into the MIDI Device Manager ALSA
+ * sequencer port at a configurable rate, and captures the resulting calls to
+ * Sushi through a mock Sushi controller. Both ends are timestamped, and the
+ * throughput, latency, and merged/dropped event counts are reported periodically,
+ * along with the process memory use, until the soak duration has elapsed.
+ *
+ * Note: This must be run on the target (or a host with an ALSA sequencer and the
+ * Nina data directories), with the Nina UI app stopped.
+ *-----------------------------------------------------------------------------
+ */
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+#include <csignal>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <getopt.h>
+#include <unistd.h>
+#include <alsa/asoundlib.h>
+#include "event_router.h"
+#include "daw_manager.h"
+#include "midi_device_manager.h"
+#include "utils.h"
+#include "system_func.h"
+#include "logger.h"
+#include "trace_log.h"
+#include "mock_sushi_controller.h"
+
+// Soak test constants
+constexpr char SOAK_SEQ_CLIENT_NAME[]      = "Nina_Soak:";
+constexpr char NINA_SEQ_CLIENT_NAME[]      = "Nina_App:";
+constexpr uint DEFAULT_SOAK_RATE           = 2000;
+constexpr uint DEFAULT_SOAK_DURATION_S     = 3600;
+constexpr uint DEFAULT_SOAK_REPORT_S       = 10;
+constexpr uint DEFAULT_SOAK_MAX_RSS_GROWTH = 4096;
+constexpr auto SOAK_SETTLE_TIME            = std::chrono::seconds(2);
+constexpr uint SOAK_NUM_CCS                = 32;
+constexpr uint SOAK_NUM_MPE_CHANNELS       = 15;
+constexpr uint SOAK_FIRST_NOTE             = 36;
+constexpr uint SOAK_NUM_NOTES              = 48;
+constexpr uint SOAK_PITCH_BEND_PARAM_ID    = MOCK_SUSHI_NUM_PARAMS - 1;
+constexpr uint SOAK_CLOCK_TEMPO            = 120;
+constexpr uint SOAK_CLOCK_PULSES_PER_BEAT  = 24;
+constexpr float SOAK_VALUE_TOLERANCE       = 1.0e-5f;
+constexpr int MIDI_PITCH_BEND_MIN_VALUE    = -8192;
+constexpr int MIDI_PITCH_BEND_MAX_VALUE    = 8191;
+
+// Soak test pattern
+enum class SoakPattern
+{
+    DENSE_CC,
+    MPE_PITCH_BEND,
+    CLOCK_NOTES,
+    FILE
+};
+
+// Soak test options
+struct SoakOptions
+{
+    SoakPattern pattern = SoakPattern::DENSE_CC;
+    std::string file_path;
+    uint rate = DEFAULT_SOAK_RATE;
+    uint duration_s = DEFAULT_SOAK_DURATION_S;
+    uint report_s = DEFAULT_SOAK_REPORT_S;
+    uint max_rss_growth_kb = DEFAULT_SOAK_MAX_RSS_GROWTH;
+};
+
+// Soak test sent event
+// An event sent to the MIDI Device Manager, and not yet seen at Sushi
+struct SoakSentEvent
+{
+    std::chrono::steady_clock::time_point time;
+    float value;
+};
+
+// Soak test stats
+struct SoakStats
+{
+    uint64_t num_sent = 0;
+    uint64_t num_delivered = 0;
+    uint64_t num_merged = 0;
+    uint64_t num_unmatched = 0;
+    uint64_t num_untracked_calls = 0;
+    EventLatencyHistogram latency;
+};
+
+// Soak Note Manager class
+// Stands in for the sequencer (not running), passing the notes from the MIDI Device
+// Manager straight to the DAW Manager
+class SoakNoteManager : public BaseManager
+{
+public:
+    SoakNoteManager(EventRouter *event_router, DawManager *daw_manager) :
+        BaseManager(NinaModule::SEQUENCER, "SoakNoteManager", event_router), _daw_manager(daw_manager) {}
+    void process_event(const BaseEvent *) {}
+    void process_midi_event_direct(const snd_seq_event_t *event) { _daw_manager->process_midi_event_direct(event); }
+
+private:
+    DawManager *_daw_manager;
+};
+
+// Private variables
+bool _exit_flag = false;
+std::mutex _soak_mutex;
+std::unordered_map<uint64_t, std::deque<SoakSentEvent>> _soak_pending;
+SoakStats _soak_stats;
+SoakStats _soak_interval_stats;
+uint64_t _num_tempo_calls = 0;
+
+// Static functions
+static bool _parse_options(int argc, char *argv[], SoakOptions& options);
+static void _print_usage(const char *name);
+static void _sigint_handler([[maybe_unused]] int sig);
+static bool _map_soak_params();
+static bool _load_midi_file(const std::string& file_path, std::vector<snd_seq_event_t>& events);
+static snd_seq_event_t _next_event(const SoakOptions& options, uint64_t num, const std::vector<snd_seq_event_t>& file_events);
+static bool _event_target(const snd_seq_event_t& event, uint64_t& key, float& value);
+static uint64_t _target_key(MockSushiCallType type, int id_a, int id_b);
+static void _handle_sushi_call(const MockSushiCall& call);
+static bool _open_soak_seq(snd_seq_t **seq_handle, int& seq_port);
+static void _print_report(const char *title, uint elapsed_s, uint interval_s, const SoakStats& stats, const MidiDeviceManager& midi_device_manager, const DawManager& daw_manager);
+static void _reset_stats(SoakStats& stats);
+static uint64_t _pending_count();
+static uint64_t _rss_kb();
+
+//----------------------------------------------------------------------------
+// main
+//----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    SoakOptions options;
+    std::vector<snd_seq_event_t> file_events;
+
+    // Parse the options
+    if (!_parse_options(argc, argv, options))
+    {
+        _print_usage(argv[0]);
+        return 1;
+    }
+    if ((options.pattern == SoakPattern::FILE) && !_load_midi_file(options.file_path, file_events))
+    {
+        std::cerr << "Could not load any MIDI events from: " << options.file_path << std::endl;
+        return 1;
+    }
+
+    // Setup the exit signal handler (e.g. ctrl-c, kill)
+    signal(SIGINT, _sigint_handler);
+    signal(SIGTERM, _sigint_handler);
+
+    // Start the logger, and the trace log
+    Logger::Start();
+    TraceLog::Start();
+
+    // Capture the calls made to Sushi
+    mock_sushi_set_call_handler(_handle_sushi_call);
+
+    // Create the DAW and MIDI Device managers - the DAW manager registers the mock Sushi params
+    // Notes are passed straight to the DAW manager, as they are when the sequencer is not running
+    auto event_router = std::make_unique<EventRouter>();
+    auto daw_manager = std::make_unique<DawManager>(event_router.get());
+    auto midi_device_manager = std::make_unique<MidiDeviceManager>(event_router.get());
+    auto note_manager = std::make_unique<SoakNoteManager>(event_router.get(), daw_manager.get());
+    utils::register_manager(NinaModule::DAW, daw_manager.get());
+    utils::register_manager(NinaModule::MIDI_DEVICE, midi_device_manager.get());
+    utils::register_manager(NinaModule::SEQUENCER, note_manager.get());
+    utils::register_common_params();
+    SystemFunc::RegisterParams();
+
+    // Map the MIDI CC and pitch bend params to the mock Sushi params, as the MIDI map file would
+    if (!_map_soak_params())
+    {
+        std::cerr << "Could not map the MIDI params to the mock Sushi params" << std::endl;
+        TraceLog::Stop();
+        Logger::Stop();
+        return 1;
+    }
+
+    // Start the managers
+    if (!midi_device_manager->start())
+    {
+        std::cerr << "Could not open a MIDI interface" << std::endl;
+        TraceLog::Stop();
+        Logger::Stop();
+        return 1;
+    }
+    daw_manager->start();
+
+    // Open the soak test sequencer port, connected to the MIDI Device Manager port
+    snd_seq_t *seq_handle = nullptr;
+    int seq_port = -1;
+    if (!_open_soak_seq(&seq_handle, seq_port))
+    {
+        std::cerr << "Could not connect to the " << NINA_SEQ_CLIENT_NAME << " sequencer port" << std::endl;
+        _exit_flag = true;
+    }
+
+    // Replay the MIDI stream at the specified rate, reporting at each interval
+    auto start_time = std::chrono::steady_clock::now();
+    auto end_time = start_time + std::chrono::seconds(options.duration_s);
+    auto next_report_time = start_time + std::chrono::seconds(options.report_s);
+    auto event_period = std::chrono::duration<double>(1.0 / options.rate);
+    uint64_t rss_start_kb = 0;
+    uint64_t rss_mid_kb = 0;
+    uint64_t num = 0;
+    uint elapsed_s = 0;
+    while (!_exit_flag && (std::chrono::steady_clock::now() < end_time))
+    {
+        // Send the next event when it is due
+        auto send_time = start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(event_period * num);
+        std::this_thread::sleep_until(send_time);
+        auto event = _next_event(options, num++, file_events);
+        snd_seq_ev_set_source(&event, seq_port);
+        snd_seq_ev_set_subs(&event);
+        snd_seq_ev_set_direct(&event);
+        {
+            // Timestamp the event as sent, against the Sushi call it should result in (if any)
+            std::lock_guard<std::mutex> lock(_soak_mutex);
+            uint64_t key;
+            float value;
+            if (_event_target(event, key, value))
+                _soak_pending[key].push_back(SoakSentEvent{std::chrono::steady_clock::now(), value});
+            _soak_stats.num_sent++;
+            _soak_interval_stats.num_sent++;
+        }
+        snd_seq_event_output_direct(seq_handle, &event);
+
+        // Report the interval stats if due
+        if (std::chrono::steady_clock::now() >= next_report_time)
+        {
+            elapsed_s += options.report_s;
+            next_report_time += std::chrono::seconds(options.report_s);
+            std::lock_guard<std::mutex> lock(_soak_mutex);
+            _print_report("Interval", elapsed_s, options.report_s, _soak_interval_stats, *midi_device_manager, *daw_manager);
+            _reset_stats(_soak_interval_stats);
+
+            // Record the memory use after the first interval (once warmed up), and at the
+            // half-way point, to check for growth over the second half of the soak
+            if (rss_start_kb == 0)
+                rss_start_kb = _rss_kb();
+            if ((rss_mid_kb == 0) && (elapsed_s >= (options.duration_s / 2)))
+                rss_mid_kb = _rss_kb();
+        }
+    }
+
+    // Wait for the events in flight to settle, then stop the managers
+    std::this_thread::sleep_for(SOAK_SETTLE_TIME);
+    midi_device_manager->stop();
+    daw_manager->stop();
+    if (seq_handle)
+        snd_seq_close(seq_handle);
+
+    // Any events still pending were never delivered to Sushi, not even merged into a later event
+    bool passed = true;
+    uint64_t num_lost = 0;
+    {
+        std::lock_guard<std::mutex> lock(_soak_mutex);
+        num_lost = _pending_count();
+        _print_report("Total", elapsed_s, elapsed_s, _soak_stats, *midi_device_manager, *daw_manager);
+    }
+    uint64_t rss_end_kb = _rss_kb();
+    std::cout << "Tempo calls: " << _num_tempo_calls << ", lost events: " << num_lost << std::endl;
+    if (num_lost > 0)
+    {
+        std::cout << "FAILED: " << num_lost << " events were never delivered to Sushi" << std::endl;
+        passed = false;
+    }
+    if ((rss_mid_kb > 0) && (rss_end_kb > (rss_mid_kb + options.max_rss_growth_kb)))
+    {
+        std::cout << "FAILED: Memory grew by " << (rss_end_kb - rss_mid_kb) << "KB over the second half of the soak" << std::endl;
+        passed = false;
+    }
+    std::cout << "Memory: " << rss_start_kb << "KB after the first interval, " << rss_end_kb << "KB at the end" << std::endl;
+    std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+
+    // Stop the trace log, and the logger
+    mock_sushi_set_call_handler(nullptr);
+    TraceLog::Stop();
+    Logger::Stop();
+    return passed ? 0 : 1;
+}
+
+//----------------------------------------------------------------------------
+// _parse_options
+//----------------------------------------------------------------------------
+static bool _parse_options(int argc, char *argv[], SoakOptions& options)
+{
+    static const struct option long_options[] = {
+        { "pattern",        required_argument, nullptr, 'p' },
+        { "file",           required_argument, nullptr, 'f' },
+        { "rate",           required_argument, nullptr, 'r' },
+        { "duration",       required_argument, nullptr, 'd' },
+        { "report",         required_argument, nullptr, 'i' },
+        { "max-rss-growth", required_argument, nullptr, 'm' },
+        { nullptr,          0,                 nullptr, 0   }
+    };
+
+    // Parse each option
+    int opt;
+    while ((opt = ::getopt_long(argc, argv, "p:f:r:d:i:m:", long_options, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+            case 'p':
+            {
+                std::string pattern = optarg;
+                if (pattern == "cc")
+                    options.pattern = SoakPattern::DENSE_CC;
+                else if (pattern == "mpe")
+                    options.pattern = SoakPattern::MPE_PITCH_BEND;
+                else if (pattern == "clock")
+                    options.pattern = SoakPattern::CLOCK_NOTES;
+                else if (pattern == "file")
+                    options.pattern = SoakPattern::FILE;
+                else
+                    return false;
+                break;
+            }
+
+            case 'f':
+                options.file_path = optarg;
+                break;
+
+            case 'r':
+                options.rate = std::strtoul(optarg, nullptr, 0);
+                break;
+
+            case 'd':
+                options.duration_s = std::strtoul(optarg, nullptr, 0);
+                break;
+
+            case 'i':
+                options.report_s = std::strtoul(optarg, nullptr, 0);
+                break;
+
+            case 'm':
+                options.max_rss_growth_kb = std::strtoul(optarg, nullptr, 0);
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    // Check the options are valid
+    return (options.rate > 0) && (options.duration_s > 0) && (options.report_s > 0) &&
+           ((options.pattern != SoakPattern::FILE) || !options.file_path.empty());
+}
+
+//----------------------------------------------------------------------------
+// _print_usage
+//----------------------------------------------------------------------------
+static void _print_usage(const char *name)
+{
+    std::cout << "Usage: " << name << " [options]" << std::endl;
+    std::cout << "  -p, --pattern <cc|mpe|clock|file>  MIDI stream to replay (default cc)" << std::endl;
+    std::cout << "                                       cc: dense CCs on channel 1" << std::endl;
+    std::cout << "                                       mpe: pitch bend on each MPE member channel" << std::endl;
+    std::cout << "                                       clock: MIDI clock plus notes" << std::endl;
+    std::cout << "                                       file: a recorded raw MIDI byte stream, looped" << std::endl;
+    std::cout << "  -f, --file <path>                  Raw MIDI file to replay (e.g. recorded with amidi -r)" << std::endl;
+    std::cout << "  -r, --rate <events/s>              Replay rate (default " << DEFAULT_SOAK_RATE << ")" << std::endl;
+    std::cout << "  -d, --duration <s>                 Soak duration (default " << DEFAULT_SOAK_DURATION_S << ")" << std::endl;
+    std::cout << "  -i, --report <s>                   Report interval (default " << DEFAULT_SOAK_REPORT_S << ")" << std::endl;
+    std::cout << "  -m, --max-rss-growth <KB>          Memory growth allowed over the second half of the soak (default "
+              << DEFAULT_SOAK_MAX_RSS_GROWTH << ")" << std::endl;
+}
+
+//----------------------------------------------------------------------------
+// _sigint_handler
+//----------------------------------------------------------------------------
+static void _sigint_handler([[maybe_unused]] int sig)
+{
+    // Stop the soak, and report the results so far
+    _exit_flag = true;
+}
+
+//----------------------------------------------------------------------------
+// _map_soak_params
+//----------------------------------------------------------------------------
+static bool _map_soak_params()
+{
+    // Get the mock Sushi params registered by the DAW manager
+    std::vector<Param *> daw_params(MOCK_SUSHI_NUM_PARAMS, nullptr);
+    for (Param *param : utils::get_params(NinaModule::DAW))
+    {
+        if ((param->processor_id == MOCK_SUSHI_PROCESSOR_ID) && (param->param_id >= 0) && ((uint)param->param_id < MOCK_SUSHI_NUM_PARAMS))
+            daw_params[param->param_id] = param;
+    }
+
+    // Map each soak CC, and the pitch bend, to a mock Sushi param
+    // Note: The MIDI params are dummy params, created in the same way as the file manager creates
+    // them when mapped in the MIDI map file
+    for (uint i=0; i<=SOAK_NUM_CCS; i++)
+    {
+        auto path = (i < SOAK_NUM_CCS) ?
+                        Param::ParamPath(NinaModule::MIDI_DEVICE, "cc/0/" + std::to_string(i + 1)) :
+                        Param::ParamPath(NinaModule::MIDI_DEVICE, "pitch_bend/0");
+        auto daw_param = (i < SOAK_NUM_CCS) ? daw_params[i + 1] : daw_params[SOAK_PITCH_BEND_PARAM_ID];
+        if (!daw_param)
+            return false;
+        auto param = DummyParam::CreateParam(path);
+        param->module = NinaModule::MIDI_DEVICE;
+        param->patch_param = false;
+        utils::register_param(std::move(param));
+        utils::get_param(path)->add_mapped_param(daw_param);
+    }
+
+    // Disable the MIDI echo filter, and enable the MIDI clock in
+    utils::get_param(ParamType::COMMON_PARAM, CommonParamId::MIDI_ECHO_FILTER_PARAM_ID)->set_value(0.0f);
+    utils::get_param(ParamType::COMMON_PARAM, CommonParamId::MIDI_CLK_IN_PARAM_ID)->set_value(1.0f);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _load_midi_file
+//----------------------------------------------------------------------------
+static bool _load_midi_file(const std::string& file_path, std::vector<snd_seq_event_t>& events)
+{
+    snd_midi_event_t *encoder;
+
+    // Read the raw MIDI bytes
+    std::ifstream file(file_path, std::ios::binary);
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.empty() || (snd_midi_event_new(bytes.size(), &encoder) < 0))
+        return false;
+
+    // Encode the bytes into sequencer events
+    // Note: Events the soak replay cannot send (e.g. SysEx) are skipped
+    const unsigned char *buf = bytes.data();
+    long buf_size = bytes.size();
+    while (buf_size > 0)
+    {
+        snd_seq_event_t ev;
+        snd_seq_ev_clear(&ev);
+        long res = snd_midi_event_encode(encoder, buf, buf_size, &ev);
+        if (res <= 0)
+            break;
+        if ((ev.type != SND_SEQ_EVENT_NONE) && (ev.type != SND_SEQ_EVENT_SYSEX))
+            events.push_back(ev);
+        buf += res;
+        buf_size -= res;
+    }
+    snd_midi_event_free(encoder);
+    return !events.empty();
+}
+
+//----------------------------------------------------------------------------
+// _next_event
+//----------------------------------------------------------------------------
+static snd_seq_event_t _next_event(const SoakOptions& options, uint64_t num, const std::vector<snd_seq_event_t>& file_events)
+{
+    snd_seq_event_t ev;
+    snd_seq_ev_clear(&ev);
+
+    // Generate the next event in the pattern
+    switch (options.pattern)
+    {
+        case SoakPattern::DENSE_CC:
+        {
+            // Sweep each CC in turn, each at a different phase
+            uint cc = num % SOAK_NUM_CCS;
+            uint value = ((num / SOAK_NUM_CCS) + (cc * 4)) % 128;
+            snd_seq_ev_set_controller(&ev, 0, cc + 1, value);
+            break;
+        }
+
+        case SoakPattern::MPE_PITCH_BEND:
+        {
+            // Bend each MPE member channel (2-16) in turn, each at a different phase
+            // Note: No MPE zone is configured, so the bends are processed as mapped pitch bend params
+            uint channel = num % SOAK_NUM_MPE_CHANNELS;
+            int value = ((((num / SOAK_NUM_MPE_CHANNELS) * 64) + (channel * 1024)) % 16384) + MIDI_PITCH_BEND_MIN_VALUE;
+            snd_seq_ev_set_pitchbend(&ev, channel + 1, value);
+            break;
+        }
+
+        case SoakPattern::CLOCK_NOTES:
+        {
+            // Send a clock pulse at the clock rate for the soak tempo, and notes in between
+            uint clock_period = std::max(1u, (options.rate * 60) / (SOAK_CLOCK_TEMPO * SOAK_CLOCK_PULSES_PER_BEAT));
+            if ((num % clock_period) == 0)
+            {
+                ev.type = SND_SEQ_EVENT_CLOCK;
+            }
+            else
+            {
+                // Alternate note on and off, cycling through the notes
+                uint note_num = num / 2;
+                uint note = SOAK_FIRST_NOTE + (note_num % SOAK_NUM_NOTES);
+                if ((num % 2) == 0)
+                    snd_seq_ev_set_noteon(&ev, 0, note, 1 + (note_num % 127));
+                else
+                    snd_seq_ev_set_noteoff(&ev, 0, note, 0);
+            }
+            break;
+        }
+
+        case SoakPattern::FILE:
+            // Loop the recorded events
+            ev = file_events[num % file_events.size()];
+            break;
+    }
+    return ev;
+}
+
+//----------------------------------------------------------------------------
+// _event_target
+// Note: The soak mutex must be held by the caller
+//----------------------------------------------------------------------------
+static bool _event_target(const snd_seq_event_t& event, uint64_t& key, float& value)
+{
+    // Get the Sushi call this event should result in, and the value it should be called with
+    switch (event.type)
+    {
+        case SND_SEQ_EVENT_CONTROLLER:
+            if ((event.data.control.param == 0) || (event.data.control.param > SOAK_NUM_CCS))
+                return false;
+            key = _target_key(MockSushiCallType::SET_PARAMETER_VALUE, MOCK_SUSHI_PROCESSOR_ID, event.data.control.param);
+            value = (float)event.data.control.value / 127.0f;
+            return true;
+
+        case SND_SEQ_EVENT_PITCHBEND:
+            key = _target_key(MockSushiCallType::SET_PARAMETER_VALUE, MOCK_SUSHI_PROCESSOR_ID, SOAK_PITCH_BEND_PARAM_ID);
+            value = (float)(event.data.control.value - MIDI_PITCH_BEND_MIN_VALUE) / (MIDI_PITCH_BEND_MAX_VALUE - MIDI_PITCH_BEND_MIN_VALUE);
+            return true;
+
+        case SND_SEQ_EVENT_NOTEON:
+            // Note: A note on with zero velocity is sent as a note off
+            key = _target_key((event.data.note.velocity > 0) ? MockSushiCallType::NOTE_ON : MockSushiCallType::NOTE_OFF,
+                              event.data.note.channel, event.data.note.note);
+            value = (float)event.data.note.velocity / 127.0f;
+            return true;
+
+        case SND_SEQ_EVENT_NOTEOFF:
+            key = _target_key(MockSushiCallType::NOTE_OFF, event.data.note.channel, event.data.note.note);
+            value = (float)event.data.note.velocity / 127.0f;
+            return true;
+
+        default:
+            // Not tracked (e.g. clock pulses, which only result in a call when the tempo changes)
+            return false;
+    }
+}
+
+//----------------------------------------------------------------------------
+// _target_key
+//----------------------------------------------------------------------------
+static uint64_t _target_key(MockSushiCallType type, int id_a, int id_b)
+{
+    return (static_cast<uint64_t>(type) << 48) | (static_cast<uint64_t>(id_a & 0xFFFF) << 32) | static_cast<uint32_t>(id_b);
+}
+
+//----------------------------------------------------------------------------
+// _handle_sushi_call
+//----------------------------------------------------------------------------
+static void _handle_sushi_call(const MockSushiCall& call)
+{
+    std::lock_guard<std::mutex> lock(_soak_mutex);
+
+    // Tempo changes are only counted
+    if (call.type == MockSushiCallType::SET_TEMPO)
+    {
+        _num_tempo_calls++;
+        return;
+    }
+
+    // Get the events pending for this call
+    // Note: The layers mask is encoded in the Sushi param ID, so mask it off
+    int id_b = (call.type == MockSushiCallType::SET_PARAMETER_VALUE) ? (call.id_b & MOCK_SUSHI_PARAM_ID_MASK) : call.id_b;
+    auto itr = _soak_pending.find(_target_key(call.type, call.id_a, id_b));
+    if ((itr == _soak_pending.end()) || itr->second.empty())
+    {
+        _soak_stats.num_untracked_calls++;
+        _soak_interval_stats.num_untracked_calls++;
+        return;
+    }
+
+    // Find the most recent event sent with this value - any earlier events were merged into it
+    auto& pending = itr->second;
+    for (auto e = pending.rbegin(); e != pending.rend(); ++e)
+    {
+        if (std::fabs(e->value - call.value) < SOAK_VALUE_TOLERANCE)
+        {
+            auto latency = std::chrono::duration_cast<std::chrono::microseconds>(call.time - e->time).count();
+            uint64_t num_merged = std::distance(e, pending.rend()) - 1;
+            for (auto stats : { &_soak_stats, &_soak_interval_stats })
+            {
+                stats->num_delivered++;
+                stats->num_merged += num_merged;
+                stats->latency.record((latency > 0) ? latency : 0);
+            }
+            pending.erase(pending.begin(), e.base());
+            return;
+        }
+    }
+
+    // No event was sent with this value
+    _soak_stats.num_unmatched++;
+    _soak_interval_stats.num_unmatched++;
+}
+
+//----------------------------------------------------------------------------
+// _open_soak_seq
+//----------------------------------------------------------------------------
+static bool _open_soak_seq(snd_seq_t **seq_handle, int& seq_port)
+{
+    // Open the ALSA Sequencer (output only), and create a port to send the events from
+    if (snd_seq_open(seq_handle, "hw", SND_SEQ_OPEN_OUTPUT, 0) < 0)
+    {
+        *seq_handle = nullptr;
+        return false;
+    }
+    snd_seq_set_client_name(*seq_handle, SOAK_SEQ_CLIENT_NAME);
+    seq_port = snd_seq_create_simple_port(*seq_handle, SOAK_SEQ_CLIENT_NAME,
+                                          (SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_SUBS_READ),
+                                          SND_SEQ_PORT_TYPE_APPLICATION);
+    if (seq_port < 0)
+        return false;
+
+    // Find the MIDI Device Manager client, and connect to its port
+    snd_seq_client_info_t *cinfo;
+    snd_seq_port_info_t *pinfo;
+    snd_seq_client_info_alloca(&cinfo);
+    snd_seq_port_info_alloca(&pinfo);
+    snd_seq_client_info_set_client(cinfo, -1);
+    while (snd_seq_query_next_client(*seq_handle, cinfo) >= 0)
+    {
+        if (std::strcmp(snd_seq_client_info_get_name(cinfo), NINA_SEQ_CLIENT_NAME) == 0)
+        {
+            snd_seq_port_info_set_client(pinfo, snd_seq_client_info_get_client(cinfo));
+            snd_seq_port_info_set_port(pinfo, -1);
+            if (snd_seq_query_next_port(*seq_handle, pinfo) >= 0)
+            {
+                return snd_seq_connect_to(*seq_handle, seq_port,
+                                          snd_seq_port_info_get_client(pinfo),
+                                          snd_seq_port_info_get_port(pinfo)) == 0;
+            }
+        }
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// _print_report
+// Note: The soak mutex must be held by the caller
+//----------------------------------------------------------------------------
+static void _print_report(const char *title, uint elapsed_s, uint interval_s, const SoakStats& stats, const MidiDeviceManager& midi_device_manager, const DawManager& daw_manager)
+{
+    auto& midi_stats = midi_device_manager.midi_event_queue_stats();
+    auto& sushi_stats = daw_manager.sushi_write_stats();
+    interval_s = std::max(1u, interval_s);
+    std::cout << "[" << elapsed_s << "s] " << title << ": "
+              << "sent " << stats.num_sent << " (" << (stats.num_sent / interval_s) << "/s), "
+              << "delivered " << stats.num_delivered << " (" << (stats.num_delivered / interval_s) << "/s), "
+              << "merged " << stats.num_merged << ", "
+              << "unmatched " << stats.num_unmatched << ", "
+              << "untracked " << stats.num_untracked_calls << ", "
+              << "pending " << _pending_count() << std::endl;
+    std::cout << "    latency p50 " << stats.latency.percentile_us(50.0f) << "us, "
+              << "p99 " << stats.latency.percentile_us(99.0f) << "us, "
+              << "p999 " << stats.latency.percentile_us(99.9f) << "us, "
+              << "max " << stats.latency.max_us() << "us" << std::endl;
+    std::cout << "    MIDI queue: " << midi_stats.num_queued.load() << " queued, " << midi_stats.num_merged.load() << " merged, "
+              << midi_stats.num_dropped.load() << " dropped; "
+              << "Sushi writes: " << sushi_stats.num_writes.load() << " queued, " << sushi_stats.num_coalesced.load() << " coalesced; "
+              << "RSS " << _rss_kb() << "KB" << std::endl;
+}
+
+//----------------------------------------------------------------------------
+// _reset_stats
+//----------------------------------------------------------------------------
+static void _reset_stats(SoakStats& stats)
+{
+    stats.num_sent = 0;
+    stats.num_delivered = 0;
+    stats.num_merged = 0;
+    stats.num_unmatched = 0;
+    stats.num_untracked_calls = 0;
+    stats.latency.reset();
+}
+
+//----------------------------------------------------------------------------
+// _pending_count
+// Note: The soak mutex must be held by the caller
+//----------------------------------------------------------------------------
+static uint64_t _pending_count()
+{
+    uint64_t count = 0;
+    for (auto& p : _soak_pending)
+    {
+        count += p.second.size();
+    }
+    return count;
+}
+
+//----------------------------------------------------------------------------
+// _rss_kb
+//----------------------------------------------------------------------------
+static uint64_t _rss_kb()
+{
+    // Read the resident set size (in pages)
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> size >> resident;
+    return (resident * ::sysconf(_SC_PAGESIZE)) / 1024;
+}
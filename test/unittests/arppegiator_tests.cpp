@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 
-#include "arpeggiator_manager.h"
+#include <algorithm>
+#include "arp_engine.h"
 
 #define private public
 
@@ -30,3 +31,182 @@ TEST_F(ArpInitTestCase, ArpInitTest)
 {
     EXPECT_FALSE(0);
 }
+
+// Helper to add notes to the arp engine
+static void add_notes(ArpEngine& engine, std::vector<uint8_t> notes)
+{
+    for (uint8_t note : notes)
+    {
+        engine.add({note, 100, 0});
+    }
+}
+
+// Helper to get the next notes played by the arp engine
+static std::vector<uint8_t> next_notes(ArpEngine& engine, uint num_notes)
+{
+    std::vector<uint8_t> notes;
+    for (uint i=0; i<num_notes; i++)
+    {
+        notes.push_back(engine.next().note);
+    }
+    return notes;
+}
+
+TEST(ArpNoteSetTest, SetResetAndNext)
+{
+    ArpNoteSet set;
+    EXPECT_TRUE(set.empty());
+    set.set(0);
+    set.set(63);
+    set.set(64);
+    set.set(127);
+    EXPECT_EQ(4u, set.count());
+    EXPECT_TRUE(set.test(63));
+    EXPECT_TRUE(set.test(64));
+    EXPECT_FALSE(set.test(65));
+    EXPECT_EQ(0, set.next(0));
+    EXPECT_EQ(63, set.next(1));
+    EXPECT_EQ(64, set.next(64));
+    EXPECT_EQ(127, set.next(65));
+    set.reset(127);
+    EXPECT_EQ(-1, set.next(65));
+    set.clear();
+    EXPECT_TRUE(set.empty());
+}
+
+TEST(ArpEngineTest, UpMode)
+{
+    ArpEngine engine;
+    add_notes(engine, {64, 60, 67});
+    EXPECT_EQ((std::vector<uint8_t>{60, 64, 67, 60, 64, 67}), next_notes(engine, 6));
+}
+
+TEST(ArpEngineTest, DownMode)
+{
+    ArpEngine engine;
+    engine.set_dir_mode(ArpDirMode::DOWN);
+    add_notes(engine, {64, 60, 67});
+    EXPECT_EQ((std::vector<uint8_t>{67, 64, 60, 67, 64, 60}), next_notes(engine, 6));
+}
+
+TEST(ArpEngineTest, UpDownMode)
+{
+    ArpEngine engine;
+    engine.set_dir_mode(ArpDirMode::UPDOWN);
+    add_notes(engine, {60, 64, 67, 72});
+    EXPECT_EQ((std::vector<uint8_t>{60, 64, 67, 72, 67, 64, 60, 64, 67}), next_notes(engine, 9));
+}
+
+TEST(ArpEngineTest, UpDownModeTwoNotes)
+{
+    ArpEngine engine;
+    engine.set_dir_mode(ArpDirMode::UPDOWN);
+    add_notes(engine, {60, 64});
+    EXPECT_EQ((std::vector<uint8_t>{60, 64, 60, 64}), next_notes(engine, 4));
+}
+
+TEST(ArpEngineTest, AssignedMode)
+{
+    ArpEngine engine;
+    engine.set_dir_mode(ArpDirMode::ASSIGNED);
+    add_notes(engine, {67, 60, 64});
+    EXPECT_EQ((std::vector<uint8_t>{67, 60, 64, 67}), next_notes(engine, 4));
+}
+
+TEST(ArpEngineTest, RandomModePlaysEachNoteOncePerPass)
+{
+    ArpEngine engine;
+    engine.seed(1234);
+    engine.set_dir_mode(ArpDirMode::RANDOM);
+    add_notes(engine, {60, 62, 64, 65, 67});
+    for (uint pass=0; pass<4; pass++)
+    {
+        auto notes = next_notes(engine, 5);
+        std::sort(notes.begin(), notes.end());
+        EXPECT_EQ((std::vector<uint8_t>{60, 62, 64, 65, 67}), notes);
+    }
+}
+
+TEST(ArpEngineTest, AddNoteContinuesFromLastNote)
+{
+    ArpEngine engine;
+    add_notes(engine, {60, 67});
+    EXPECT_EQ(60, engine.next().note);
+
+    // A note added between the last note and the next note is played next
+    add_notes(engine, {64});
+    EXPECT_EQ((std::vector<uint8_t>{64, 67, 60}), next_notes(engine, 3));
+}
+
+TEST(ArpEngineTest, RemoveNote)
+{
+    ArpEngine engine;
+    add_notes(engine, {60, 64, 67});
+    EXPECT_EQ(60, engine.next().note);
+    EXPECT_TRUE(engine.remove(64));
+    EXPECT_FALSE(engine.remove(64));
+    EXPECT_FALSE(engine.contains(64));
+    EXPECT_EQ(2u, engine.size());
+    EXPECT_EQ((std::vector<uint8_t>{67, 60}), next_notes(engine, 2));
+}
+
+TEST(ArpEngineTest, AssignedModeRemovePlayedNote)
+{
+    ArpEngine engine;
+    engine.set_dir_mode(ArpDirMode::ASSIGNED);
+    add_notes(engine, {67, 60, 64});
+    EXPECT_EQ((std::vector<uint8_t>{67, 60}), next_notes(engine, 2));
+
+    // Removing the note just played continues from the same position
+    engine.remove(60);
+    EXPECT_EQ((std::vector<uint8_t>{64, 67}), next_notes(engine, 2));
+}
+
+TEST(ArpEngineTest, DirModeChangeContinuesFromLastNote)
+{
+    ArpEngine engine;
+    add_notes(engine, {60, 64, 67, 72});
+    EXPECT_EQ((std::vector<uint8_t>{60, 64}), next_notes(engine, 2));
+    engine.set_dir_mode(ArpDirMode::DOWN);
+    EXPECT_EQ((std::vector<uint8_t>{60, 72, 67}), next_notes(engine, 3));
+}
+
+TEST(ArpEngineTest, PeekDoesNotAdvance)
+{
+    ArpEngine engine;
+    add_notes(engine, {60, 64, 67});
+    EXPECT_EQ(60, engine.peek().note);
+    EXPECT_EQ(64, engine.peek(1).note);
+    EXPECT_EQ(60, engine.peek(3).note);
+    EXPECT_EQ(60, engine.next().note);
+    EXPECT_EQ(64, engine.peek().note);
+}
+
+TEST(ArpEngineTest, ResetStartsFromBeginning)
+{
+    ArpEngine engine;
+    add_notes(engine, {60, 64, 67});
+    next_notes(engine, 2);
+    engine.reset();
+    EXPECT_EQ(60, engine.next().note);
+}
+
+TEST(ArpEngineTest, NoteDataAndCapacity)
+{
+    ArpEngine engine;
+    EXPECT_TRUE(engine.empty());
+    EXPECT_TRUE(engine.add({60, 90, 3}));
+    auto note = engine.next();
+    EXPECT_EQ(60, note.note);
+    EXPECT_EQ(90, note.velocity);
+    EXPECT_EQ(3, note.channel);
+
+    engine.clear();
+    for (uint i=0; i<ARP_ENGINE_MAX_NOTES; i++)
+    {
+        EXPECT_TRUE(engine.add({static_cast<uint8_t>(i), 100, 0}));
+    }
+    EXPECT_FALSE(engine.add({static_cast<uint8_t>(ARP_ENGINE_MAX_NOTES), 100, 0}));
+    EXPECT_FALSE(engine.add({128, 100, 0}));
+    EXPECT_EQ(ARP_ENGINE_MAX_NOTES, engine.size());
+}
@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include "json_path_index.h"
+
+// JSON path index test case
+class JsonPathIndexTestCase : public ::testing::Test
+{
+    protected:
+    JsonPathIndexTestCase()
+    {
+    }
+    void SetUp()
+    {
+        // Create a JSON array section with a number of path entries
+        json_doc.SetArray();
+        for (uint i=0; i<NUM_ENTRIES; i++)
+        {
+            add_entry(path(i), (float)i);
+        }
+    }
+
+    void TearDown()
+    {
+    }
+
+    // Helper to get the path of an entry
+    static std::string path(uint i)
+    {
+        return "/daw/main/ninavst/Param_" + std::to_string(i);
+    }
+
+    // Helper to add an entry to the array
+    void add_entry(const std::string& path, float value)
+    {
+        rapidjson::Value obj;
+        obj.SetObject();
+        obj.AddMember("path", path, json_doc.GetAllocator());
+        obj.AddMember("value", value, json_doc.GetAllocator());
+        json_doc.PushBack(obj, json_doc.GetAllocator());
+    }
+
+    // Helper to get the value of a found entry
+    static float value(rapidjson::Value::ValueIterator itr)
+    {
+        return itr->GetObject()["value"].GetFloat();
+    }
+
+    static constexpr uint NUM_ENTRIES = 10;
+    rapidjson::Document json_doc;
+    JsonPathIndex index;
+};
+
+TEST_F(JsonPathIndexTestCase, FindHit)
+{
+    // Each path is found at its entry
+    for (uint i=0; i<NUM_ENTRIES; i++)
+    {
+        auto itr = index.find(json_doc, path(i).c_str());
+        ASSERT_NE(itr, nullptr);
+        EXPECT_FLOAT_EQ(value(itr), (float)i);
+    }
+}
+
+TEST_F(JsonPathIndexTestCase, FindMiss)
+{
+    // A path not in the array is not found, before and after the index is built
+    EXPECT_EQ(index.find(json_doc, "/daw/main/ninavst/Missing"), nullptr);
+    EXPECT_NE(index.find(json_doc, path(0).c_str()), nullptr);
+    EXPECT_EQ(index.find(json_doc, "/daw/main/ninavst/Missing"), nullptr);
+    EXPECT_EQ(index.find(json_doc, ""), nullptr);
+
+    // An empty array never finds a path
+    rapidjson::Document empty_doc;
+    empty_doc.SetArray();
+    EXPECT_EQ(index.find(empty_doc, path(0).c_str()), nullptr);
+}
+
+TEST_F(JsonPathIndexTestCase, FindAfterAppend)
+{
+    // An entry appended after the index is built is found, as the index is rebuilt
+    // when the array size changes
+    EXPECT_EQ(index.find(json_doc, path(NUM_ENTRIES).c_str()), nullptr);
+    add_entry(path(NUM_ENTRIES), (float)NUM_ENTRIES);
+    auto itr = index.find(json_doc, path(NUM_ENTRIES).c_str());
+    ASSERT_NE(itr, nullptr);
+    EXPECT_FLOAT_EQ(value(itr), (float)NUM_ENTRIES);
+}
+
+TEST_F(JsonPathIndexTestCase, FindAfterInPlaceReorder)
+{
+    // Build the index, then swap two entries in-place (the array size and storage are
+    // unchanged) - the stale index positions are detected and the index rebuilt
+    EXPECT_NE(index.find(json_doc, path(0).c_str()), nullptr);
+    json_doc.Begin()->Swap(*(json_doc.Begin() + (NUM_ENTRIES - 1)));
+    auto itr = index.find(json_doc, path(0).c_str());
+    ASSERT_NE(itr, nullptr);
+    EXPECT_EQ(itr, json_doc.Begin() + (NUM_ENTRIES - 1));
+    EXPECT_FLOAT_EQ(value(itr), 0.0f);
+    itr = index.find(json_doc, path(NUM_ENTRIES - 1).c_str());
+    ASSERT_NE(itr, nullptr);
+    EXPECT_EQ(itr, json_doc.Begin());
+}
+
+TEST_F(JsonPathIndexTestCase, FindAfterInPlaceRemove)
+{
+    // Build the index, then replace an entry in-place with a non-path entry - the stale
+    // index position is detected, and the path is no longer found
+    EXPECT_NE(index.find(json_doc, path(3).c_str()), nullptr);
+    json_doc[3].SetObject();
+    EXPECT_EQ(index.find(json_doc, path(3).c_str()), nullptr);
+    EXPECT_NE(index.find(json_doc, path(4).c_str()), nullptr);
+}
+
+TEST_F(JsonPathIndexTestCase, FindAfterReplace)
+{
+    // Replace the array contents with a copy of fewer entries - the index is rebuilt
+    // and the removed paths are not found
+    EXPECT_NE(index.find(json_doc, path(NUM_ENTRIES - 1).c_str()), nullptr);
+    json_doc.Erase(json_doc.Begin() + (NUM_ENTRIES / 2), json_doc.End());
+    EXPECT_EQ(index.find(json_doc, path(NUM_ENTRIES - 1).c_str()), nullptr);
+    EXPECT_NE(index.find(json_doc, path(0).c_str()), nullptr);
+}
+
+TEST_F(JsonPathIndexTestCase, FindAfterInvalidate)
+{
+    // Invalidating the indexes rebuilds them on the next find
+    EXPECT_NE(index.find(json_doc, path(1).c_str()), nullptr);
+    index.invalidate();
+    auto itr = index.find(json_doc, path(1).c_str());
+    ASSERT_NE(itr, nullptr);
+    EXPECT_FLOAT_EQ(value(itr), 1.0f);
+}
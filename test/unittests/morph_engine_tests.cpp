@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <vector>
+#include "morph_engine.h"
+
+// Morph engine test case
+// Note: The morph engine is built with the project compile flags (including
+// -ffast-math), so these tests check the blend behaves the same with them
+class MorphEngineTestCase : public ::testing::Test
+{
+    protected:
+    MorphEngineTestCase()
+    {
+    }
+    void SetUp()
+    {
+    }
+
+    void TearDown()
+    {
+    }
+
+    // Create the params to blend
+    // Note: Nine params, so that both the vectorised and remaining value blends
+    // are tested
+    void create_params(uint num_params=9)
+    {
+        for (uint i=0; i<num_params; i++)
+        {
+            _owned_params.push_back(Param::CreateParam(NinaModule::DAW, "morph_test_" + std::to_string(i)));
+            params.push_back(_owned_params.back().get());
+        }
+    }
+
+    MorphEngine engine;
+    std::vector<Param *> params;
+
+    private:
+    std::vector<std::unique_ptr<Param>> _owned_params;
+};
+
+TEST_F(MorphEngineTestCase, FirstBlendSetsEveryParam)
+{
+    // The first blend must update every param, even if the blended value is the
+    // same as the current param value
+    create_params();
+    std::vector<float> state_a(params.size(), 0.0f);
+    std::vector<float> state_b(params.size(), 0.0f);
+    engine.set_layer_states(0, params, state_a, state_b);
+    for (Param *p : params)
+        p->set_value(0.0f);
+    EXPECT_TRUE(engine.blend(0, 0.5f));
+}
+
+TEST_F(MorphEngineTestCase, BlendWritesParams)
+{
+    // Blend halfway between State A and State B
+    create_params();
+    std::vector<float> state_a(params.size(), 0.0f);
+    std::vector<float> state_b(params.size(), 1.0f);
+    engine.set_layer_states(0, params, state_a, state_b);
+    EXPECT_TRUE(engine.blend(0, 0.5f));
+    for (Param *p : params)
+        EXPECT_FLOAT_EQ(p->get_value(), 0.5f);
+
+    // Blend to State B
+    EXPECT_TRUE(engine.blend(0, 1.0f));
+    for (Param *p : params)
+        EXPECT_FLOAT_EQ(p->get_value(), 1.0f);
+}
+
+TEST_F(MorphEngineTestCase, BlendSkipsUnchangedParams)
+{
+    // Once blended, a change below the threshold does not update the params
+    create_params();
+    std::vector<float> state_a(params.size(), 0.0f);
+    std::vector<float> state_b(params.size(), 1.0f);
+    engine.set_layer_states(0, params, state_a, state_b);
+    EXPECT_TRUE(engine.blend(0, 0.5f));
+    EXPECT_FALSE(engine.blend(0, 0.5f));
+    EXPECT_FALSE(engine.blend(0, 0.5f + (MORPH_BLEND_THRESHOLD / 2)));
+    EXPECT_TRUE(engine.blend(0, 0.5f + (MORPH_BLEND_THRESHOLD * 2)));
+}
+
+TEST_F(MorphEngineTestCase, SetLayerStatesResetsOutput)
+{
+    // Setting the layer states again means the next blend updates every param
+    create_params();
+    std::vector<float> state_a(params.size(), 0.25f);
+    std::vector<float> state_b(params.size(), 0.25f);
+    engine.set_layer_states(0, params, state_a, state_b);
+    EXPECT_TRUE(engine.blend(0, 0.5f));
+    EXPECT_FALSE(engine.blend(0, 0.5f));
+    engine.set_layer_states(0, params, state_a, state_b);
+    EXPECT_TRUE(engine.blend(0, 0.5f));
+}
+
+TEST_F(MorphEngineTestCase, ClearedLayerNotBlended)
+{
+    // A layer without states is never blended
+    create_params();
+    std::vector<float> state_a(params.size(), 0.0f);
+    std::vector<float> state_b(params.size(), 1.0f);
+    engine.set_layer_states(0, params, state_a, state_b);
+    engine.clear_layer_states(0);
+    EXPECT_FALSE(engine.layer_states_set(0));
+    EXPECT_FALSE(engine.blend(0, 0.5f));
+}
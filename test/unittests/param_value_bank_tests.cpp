@@ -0,0 +1,154 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <vector>
+#include "param_value_bank.h"
+
+// Param value bank test case
+class ParamValueBankTestCase : public ::testing::Test
+{
+    protected:
+    ParamValueBankTestCase()
+    {
+    }
+    void SetUp()
+    {
+    }
+
+    void TearDown()
+    {
+    }
+
+    // Create the params to capture
+    // Note: The params are not registered, so each is given its index as its handle
+    void create_params(uint num_params=4)
+    {
+        for (uint i=0; i<num_params; i++)
+        {
+            _owned_params.push_back(Param::CreateParam(NinaModule::DAW, "bank_test_" + std::to_string(i)));
+            _owned_params.back()->handle = params.size();
+            params.push_back(_owned_params.back().get());
+        }
+    }
+
+    // Create a string param to capture
+    Param *create_str_param(const std::string& str_value)
+    {
+        _owned_params.push_back(Param::CreateParam(NinaModule::DAW, "bank_test_str_" + std::to_string(params.size())));
+        auto param = _owned_params.back().get();
+        param->handle = params.size();
+        param->str_param = true;
+        param->set_str_value(str_value);
+        params.push_back(param);
+        return param;
+    }
+
+    // Filter that captures every param
+    static bool all_params(const Param *)
+    {
+        return true;
+    }
+
+    ParamValueBank bank;
+    std::vector<Param *> params;
+
+    private:
+    std::vector<std::unique_ptr<Param>> _owned_params;
+};
+
+TEST_F(ParamValueBankTestCase, CaptureWithFilter)
+{
+    // Only the params that pass the filter are captured, with their current values
+    create_params();
+    for (uint i=0; i<params.size(); i++)
+        params[i]->set_value(0.1f * (i + 1));
+    EXPECT_FALSE(bank.valid());
+    bank.capture(params, [this](const Param *p) { return p != params[1]; });
+    EXPECT_TRUE(bank.valid());
+    EXPECT_TRUE(bank.contains(params[0]));
+    EXPECT_FALSE(bank.contains(params[1]));
+    EXPECT_TRUE(bank.contains(params[2]));
+    EXPECT_TRUE(bank.contains(params[3]));
+    EXPECT_FLOAT_EQ(bank.get_value(params[0]), 0.1f);
+    EXPECT_FLOAT_EQ(bank.get_value(params[3]), 0.4f);
+
+    // The bank cannot be applied to params it does not fully hold
+    EXPECT_FALSE(bank.can_apply(params, all_params));
+    EXPECT_TRUE(bank.can_apply(params, [this](const Param *p) { return p != params[1]; }));
+}
+
+TEST_F(ParamValueBankTestCase, CaptureSkipsUnregisteredParam)
+{
+    // A param with no handle is not captured, and does not affect the other params
+    create_params();
+    params[2]->handle = INVALID_PARAM_HANDLE;
+    bank.capture(params, all_params);
+    EXPECT_TRUE(bank.contains(params[0]));
+    EXPECT_TRUE(bank.contains(params[1]));
+    EXPECT_FALSE(bank.contains(params[2]));
+    EXPECT_TRUE(bank.contains(params[3]));
+    EXPECT_TRUE(bank.can_apply(params, all_params));
+}
+
+TEST_F(ParamValueBankTestCase, ContainsAfterInvalidate)
+{
+    // Once invalidated, the bank holds no params until captured again
+    create_params();
+    bank.capture(params, all_params);
+    bank.invalidate();
+    EXPECT_FALSE(bank.valid());
+    for (const Param *p : params)
+        EXPECT_FALSE(bank.contains(p));
+    EXPECT_FALSE(bank.can_apply(params, all_params));
+    bank.capture(params, all_params);
+    for (const Param *p : params)
+        EXPECT_TRUE(bank.contains(p));
+}
+
+TEST_F(ParamValueBankTestCase, SetValueClamped)
+{
+    // The value set is clipped to the param range
+    create_params();
+    bank.capture(params, all_params);
+    bank.set_value(params[0], 1.5f);
+    bank.set_value(params[1], -0.5f);
+    bank.set_value(params[2], 0.25f);
+    EXPECT_FLOAT_EQ(bank.get_value(params[0]), 1.0f);
+    EXPECT_FLOAT_EQ(bank.get_value(params[1]), 0.0f);
+    EXPECT_FLOAT_EQ(bank.get_value(params[2]), 0.25f);
+}
+
+TEST_F(ParamValueBankTestCase, SetValueIgnoredIfNotCaptured)
+{
+    // Setting the value of a param the bank does not hold is ignored, including a
+    // param with a handle beyond those captured
+    create_params();
+    params[0]->set_value(0.5f);
+    bank.capture(params, [this](const Param *p) { return p == params[0]; });
+    bank.set_value(params[1], 0.75f);
+    EXPECT_FALSE(bank.contains(params[1]));
+    params[3]->handle = 100;
+    bank.set_value(params[3], 0.75f);
+    EXPECT_FALSE(bank.contains(params[3]));
+    EXPECT_FLOAT_EQ(bank.get_value(params[0]), 0.5f);
+}
+
+TEST_F(ParamValueBankTestCase, StrValueChangedNotApplied)
+{
+    // The bank can be applied while the string values are unchanged
+    create_params();
+    auto str_param = create_str_param("wavetable_1");
+    bank.capture(params, all_params);
+    EXPECT_TRUE(bank.contains(str_param));
+    EXPECT_EQ(bank.get_str_value(str_param), "wavetable_1");
+    EXPECT_TRUE(bank.can_apply(params, all_params));
+
+    // Once a string value has changed the bank cannot be applied, so the caller falls
+    // back to loading the params
+    str_param->set_str_value("wavetable_2");
+    EXPECT_FALSE(bank.can_apply(params, all_params));
+
+    // Updating the bank string value allows it to be applied again
+    bank.set_str_value(str_param, "wavetable_2");
+    EXPECT_TRUE(bank.can_apply(params, all_params));
+}
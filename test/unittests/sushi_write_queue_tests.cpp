@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+#include "sushi_write_queue.h"
+
+// Sushi write queue test case
+class SushiWriteQueueTestCase : public ::testing::Test
+{
+    protected:
+    SushiWriteQueueTestCase()
+    {
+    }
+    void SetUp()
+    {
+    }
+
+    void TearDown()
+    {
+    }
+
+    // Helper to queue a write to a param for the specified layers
+    // Note: The layers mask is encoded in the parameter ID, as the DAW manager does
+    bool push(int param_id, uint layers_mask, float value)
+    {
+        auto param_value = sushi_controller::ParameterValue();
+        param_value.processor_id = PROCESSOR_ID;
+        param_value.parameter_id = param_id | (layers_mask << LAYERS_MASK_BIT_SHIFT);
+        param_value.value = value;
+        return queue.push(param_id, layers_mask, param_value, NO_LATENCY_TRACE_ID);
+    }
+
+    // Helper to take the queued writes, and apply them in order to get the final
+    // value of a param for a layer
+    float final_value(int param_id, uint layer_mask)
+    {
+        float value = -1.0f;
+        if (param_values.empty())
+            queue.take(param_values, trace_ids);
+        for (const auto& pv : param_values)
+        {
+            if (((pv.parameter_id & PARAM_ID_MASK) == param_id) && ((pv.parameter_id >> LAYERS_MASK_BIT_SHIFT) & layer_mask))
+                value = pv.value;
+        }
+        return value;
+    }
+
+    static constexpr int PROCESSOR_ID = 1;
+    static constexpr uint LAYERS_MASK_BIT_SHIFT = 27;
+    static constexpr int PARAM_ID_MASK = ~0x78000000;
+    SushiWriteQueue queue;
+    std::vector<sushi_controller::ParameterValue> param_values;
+    std::vector<LatencyTraceId> trace_ids;
+};
+
+TEST_F(SushiWriteQueueTestCase, CoalesceSameLayers)
+{
+    // Writes to the same param and layers are coalesced, and the last value wins
+    EXPECT_FALSE(push(10, 0x1, 0.1f));
+    EXPECT_TRUE(push(10, 0x1, 0.2f));
+    EXPECT_TRUE(push(10, 0x1, 0.3f));
+    EXPECT_EQ(queue.size(), 1u);
+    EXPECT_FLOAT_EQ(final_value(10, 0x1), 0.3f);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(SushiWriteQueueTestCase, NoCoalesceDifferentParams)
+{
+    // Writes to different params, or the same param for different layers, are not
+    // coalesced
+    EXPECT_FALSE(push(10, 0x1, 0.1f));
+    EXPECT_FALSE(push(11, 0x1, 0.2f));
+    EXPECT_FALSE(push(10, 0x2, 0.3f));
+    EXPECT_EQ(queue.size(), 3u);
+    EXPECT_FLOAT_EQ(final_value(10, 0x1), 0.1f);
+    EXPECT_FLOAT_EQ(final_value(11, 0x1), 0.2f);
+    EXPECT_FLOAT_EQ(final_value(10, 0x2), 0.3f);
+}
+
+TEST_F(SushiWriteQueueTestCase, CoalesceNonOverlappingLayers)
+{
+    // Alternating writes to the same param for layers that don't overlap are still
+    // coalesced
+    EXPECT_FALSE(push(10, 0x1, 0.1f));
+    EXPECT_FALSE(push(10, 0x2, 0.2f));
+    EXPECT_TRUE(push(10, 0x1, 0.3f));
+    EXPECT_TRUE(push(10, 0x2, 0.4f));
+    EXPECT_EQ(queue.size(), 2u);
+    EXPECT_FLOAT_EQ(final_value(10, 0x1), 0.3f);
+    EXPECT_FLOAT_EQ(final_value(10, 0x2), 0.4f);
+}
+
+TEST_F(SushiWriteQueueTestCase, OverlappingLayersAppliedInOrder)
+{
+    // Write to layers 1+2, then layer 1, then layers 1+2 again - the last write must
+    // not be coalesced with the first, as it would then be overwritten by the layer 1
+    // write, so both layers must end with the last value
+    EXPECT_FALSE(push(10, 0x3, 0.1f));
+    EXPECT_FALSE(push(10, 0x1, 0.2f));
+    EXPECT_FALSE(push(10, 0x3, 0.3f));
+    EXPECT_FLOAT_EQ(final_value(10, 0x1), 0.3f);
+    EXPECT_FLOAT_EQ(final_value(10, 0x2), 0.3f);
+}
+
+TEST_F(SushiWriteQueueTestCase, CoalesceAfterOverlappingWrite)
+{
+    // Once a write has been queued after an overlapping write, later writes for the
+    // same layers are coalesced with it
+    EXPECT_FALSE(push(10, 0x3, 0.1f));
+    EXPECT_FALSE(push(10, 0x1, 0.2f));
+    EXPECT_FALSE(push(10, 0x3, 0.3f));
+    EXPECT_TRUE(push(10, 0x3, 0.4f));
+    EXPECT_FALSE(push(10, 0x1, 0.5f));
+    EXPECT_EQ(queue.size(), 4u);
+    EXPECT_FLOAT_EQ(final_value(10, 0x1), 0.5f);
+    EXPECT_FLOAT_EQ(final_value(10, 0x2), 0.4f);
+}
+
+TEST_F(SushiWriteQueueTestCase, TakeClearsQueue)
+{
+    // Once taken, a write for a param already taken is queued again
+    EXPECT_FALSE(push(10, 0x1, 0.1f));
+    EXPECT_FLOAT_EQ(final_value(10, 0x1), 0.1f);
+    EXPECT_TRUE(queue.empty());
+    param_values.clear();
+    trace_ids.clear();
+    EXPECT_FALSE(push(10, 0x1, 0.2f));
+    EXPECT_FLOAT_EQ(final_value(10, 0x1), 0.2f);
+}